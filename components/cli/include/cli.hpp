@@ -0,0 +1,330 @@
+/*
+ * CLI
+ * 
+ * UART受信リングから逐次解析するコマンドラインインタフェース
+ * 固定長の行バッファとコンパイル時に整列を検証したコマンド表（二分探索）で、文字列の確保をしない
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef CLI_HPP
+#define CLI_HPP
+
+#include "uart_hal.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace cli {
+
+class Cli;
+
+/**
+ * @brief コマンド引数（行バッファ内をその場で区切った文字列、先頭はコマンド名）
+ */
+struct CliArgs {
+    static constexpr size_t MAX_ARGS = 8;       // コマンド名を含む最大個数
+    size_t count;                               // 個数
+    const char* items[MAX_ARGS];                // 各引数（行バッファ内、NUL終端）
+    
+    const char* operator[](size_t index) const { return index < count ? items[index] : ""; }
+};
+
+/**
+ * @brief コマンド処理関数型
+ * @param cli 出力先
+ * @param args 引数
+ * @param context コマンド表の context
+ * @return esp_err_t 結果（ESP_ERR_INVALID_ARGで使い方を表示）
+ */
+using CliHandler = esp_err_t (*)(Cli& cli, const CliArgs& args, void* context);
+
+/**
+ * @brief コマンド表の要素
+ */
+struct CliCommand {
+    const char* name;           // コマンド名（表は名前の昇順に並べる）
+    const char* usage;          // 使い方（helpで表示）
+    CliHandler handler;         // 処理関数
+    void* context;              // 処理関数の引数（静的なオブジェクトのアドレス）
+};
+
+/**
+ * @brief 文字列比較（constexpr、strcmpと同じ符号）
+ */
+constexpr int compareName(const char* a, const char* b) {
+    while (*a != '\0' && *a == *b) {
+        a++;
+        b++;
+    }
+    return static_cast<int>(static_cast<unsigned char>(*a)) - static_cast<int>(static_cast<unsigned char>(*b));
+}
+
+/**
+ * @brief コマンド表が名前の昇順（重複なし）か確認（static_assert用）
+ */
+template<size_t N>
+constexpr bool isSortedTable(const CliCommand (&table)[N]) {
+    for (size_t i = 1; i < N; i++) {
+        if (compareName(table[i - 1].name, table[i].name) >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief 逐次行バッファ
+ * 
+ * 受信バイトを1つずつ投入し、改行で1行を確定する。CR・LF・CRLFのいずれも1行とし、
+ * バックスペース（BS・DEL）で1文字消す、Ctrl-Cで行を捨てる。
+ * 行長を超えた分は捨て、その行は改行まで無視する（途中で切れたコマンドを実行しない）
+ */
+class CliLineBuffer {
+public:
+    static constexpr size_t CAPACITY = 128;     // 1行の最大長（NUL含む）
+    
+    /**
+     * @brief 投入結果
+     */
+    enum class Result : uint8_t {
+        NONE,           // 行の途中（文字を追加した）
+        IGNORED,        // 行に入れなかった（制御文字・CRLFのLF・行長超過中）
+        LINE,           // 1行確定（line()で取得）
+        ERASE,          // 1文字消した（エコー用）
+        CANCEL,         // 行を捨てた（Ctrl-C）
+        OVERFLOW        // 行長超過で捨てた（改行まで無視）
+    };
+    
+    CliLineBuffer() { clear(); }
+    
+    /**
+     * @brief 1バイト投入
+     * @param c 受信バイト
+     * @return Result 投入結果
+     */
+    Result push(char c);
+    
+    /**
+     * @brief 確定した行（次のpush()まで有効、in-placeで区切ってよい）
+     */
+    char* line() { return buffer_; }
+    
+    /**
+     * @brief 確定した行の長さ
+     */
+    size_t length() const { return line_length_; }
+    
+    /**
+     * @brief 行バッファを空にする
+     */
+    void clear();
+    
+    /**
+     * @brief 行をその場で空白区切りにする（区切りをNULで置き換える）
+     * @param line 行（NUL終端）
+     * @param args 格納先（MAX_ARGSを超えた分は区切らずに最後の引数に残る）
+     */
+    static void tokenize(char* line, CliArgs& args);
+    
+private:
+    char buffer_[CAPACITY];         // 行バッファ
+    size_t length_;                 // 入力中の長さ
+    size_t line_length_;            // 確定した行の長さ
+    bool discarding_;               // 行長超過で改行まで無視中
+    bool last_cr_;                  // 直前がCR（CRLFのLFを無視する）
+};
+
+/**
+ * @brief CLIクラス
+ * 
+ * CLIタスク（既定で app_main.h の CLI_TASK_PRIORITY・CLI_TASK_CORE_ID と同じ優先度3・コア0）が
+ * UartHalのゼロコピー受信リングを周期的に読み、1行毎にコマンド表を二分探索して実行する。
+ * 受信待ちでロックを取らず、コマンドもロックなしで読める値（ParamRegistryのatomic値、
+ * 各クラスのStats・dump()）だけを扱うため、飛行中に実行しても制御タスクを待たせない。
+ * ESP_LOGの出力（dump()）はコンソールへ出るため、CLIはコンソールと同じUARTで使う。
+ * 
+ * 使用例:
+ *   constexpr cli::CliCommand COMMANDS[] = {
+ *       {"blackbox", "blackbox", cli::dumpHandler<storage::Blackbox>, &blackbox},
+ *       {"help", "help", cli::helpHandler, nullptr},
+ *       {"param", "param get|set|list|save ...", cli::paramHandler, &params},
+ *   };
+ *   static_assert(cli::isSortedTable(COMMANDS), "コマンド表は名前の昇順");
+ *   static cli::Cli console(COMMANDS);
+ *   console.start(uart);
+ */
+class Cli {
+public:
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        size_t rx_ring_size = 256;                  // 受信リング容量（2のべき乗、有効化済みなら使わない）
+        uint32_t poll_ms = 20;                      // 受信リングの確認周期（ms）
+        bool echo = true;                           // 入力のエコーバック
+        const char* prompt = "> ";                  // プロンプト（nullptrで表示しない）
+        UBaseType_t priority = 3;                   // CLIタスクの優先度（CLI_TASK_PRIORITY）
+        uint32_t stack_size = 4096;                 // CLIタスクのスタックサイズ（CLI_TASK_STACK_SIZE）
+        int core = 0;                               // CLIタスクのコア（CLI_TASK_CORE_ID）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t lines;             // 実行した行数
+        uint32_t unknown;           // 見つからないコマンド数
+        uint32_t errors;            // エラーを返したコマンド数
+        uint32_t overflows;         // 行長超過で捨てた行数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param table コマンド表（名前の昇順、isSortedTable()で検証しておく）
+     * @param count 要素数
+     */
+    Cli(const CliCommand* table, size_t count);
+    
+    /**
+     * @brief コンストラクタ（配列から要素数を求める）
+     */
+    template<size_t N>
+    explicit Cli(const CliCommand (&table)[N]) : Cli(table, N) {}
+    
+    ~Cli();
+    
+    Cli(const Cli&) = delete;
+    Cli& operator=(const Cli&) = delete;
+    
+    /**
+     * @brief CLIタスク開始
+     * @param uart 入出力に使うUART（初期化・開始済み）
+     * @param config 設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(hal::UartHal& uart, const Config& config);
+    
+    /**
+     * @brief CLIタスク開始（既定の設定）
+     */
+    esp_err_t start(hal::UartHal& uart) { return start(uart, Config{}); }
+    
+    /**
+     * @brief CLIタスク停止
+     * @return esp_err_t 停止を確認できない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 1行の実行（CLIタスク以外の入力経路・テスト用）
+     * @param line 行（NUL終端、その場で区切る）
+     * @return esp_err_t コマンドの結果（見つからない場合ESP_ERR_NOT_FOUND）
+     */
+    esp_err_t execute(char* line);
+    
+    /**
+     * @brief コマンド検索（二分探索）
+     * @param name コマンド名
+     * @return const CliCommand* 見つからない場合nullptr
+     */
+    const CliCommand* find(const char* name) const;
+    
+    /**
+     * @brief 書式付き出力（固定長バッファ、長すぎる分は切り捨て）
+     */
+    void print(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    
+    /**
+     * @brief 出力（コマンド処理関数から呼ぶ）
+     * @param data データ
+     * @param length 長さ
+     */
+    void write(const char* data, size_t length);
+    
+    /**
+     * @brief コマンド表取得（help用）
+     */
+    const CliCommand* table() const { return table_; }
+    
+    /**
+     * @brief コマンド数取得
+     */
+    size_t size() const { return count_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力
+     */
+    void dump() const;
+    
+private:
+    static constexpr size_t OUTPUT_SIZE = 192;      // print()の1回の最大長
+    
+    /**
+     * @brief CLIタスク
+     */
+    static void taskEntry(void* arg);
+    
+    /**
+     * @brief 受信リングの処理
+     */
+    void service();
+    
+    /**
+     * @brief プロンプト表示
+     */
+    void prompt();
+    
+    const CliCommand* table_;                       // コマンド表
+    size_t count_;                                  // コマンド数
+    Config config_;                                 // 設定
+    hal::UartHal* uart_;                            // 入出力UART（nullptrは出力なし）
+    CliLineBuffer line_;                            // 行バッファ（CLIタスクのみ）
+    char output_[OUTPUT_SIZE];                      // print()の作業領域（CLIタスクのみ）
+    
+    TaskHandle_t task_;                             // CLIタスク
+    std::atomic<bool> running_;                     // CLIタスク動作中フラグ
+    
+    std::atomic<uint32_t> stat_lines_;
+    std::atomic<uint32_t> stat_unknown_;
+    std::atomic<uint32_t> stat_errors_;
+    std::atomic<uint32_t> stat_overflows_;
+};
+
+/**
+ * @brief help: コマンド一覧
+ */
+esp_err_t helpHandler(Cli& cli, const CliArgs& args, void* context);
+
+/**
+ * @brief param get|set|list|save|reset（context: params::ParamRegistry*）
+ */
+esp_err_t paramHandler(Cli& cli, const CliArgs& args, void* context);
+
+/**
+ * @brief dump()を持つクラスの状態表示（context: T*）
+ * @tparam T dump() constを持つクラス
+ */
+template<typename T>
+esp_err_t dumpHandler(Cli& cli, const CliArgs& args, void* context) {
+    (void)cli;
+    (void)args;
+    static_cast<const T*>(context)->dump();
+    return ESP_OK;
+}
+
+} // namespace cli
+
+#endif // CLI_HPP
@@ -0,0 +1,321 @@
+/*
+ * CLI Implementation
+ * 
+ * UART受信リングから逐次解析するコマンドラインインタフェース実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "cli.hpp"
+#include "esp_log.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace cli {
+
+static const char* TAG = "cli::Cli";
+
+namespace {
+
+constexpr char CTRL_C = 0x03;
+constexpr char BACKSPACE = 0x08;
+constexpr char DEL = 0x7F;
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t';
+}
+
+} // namespace
+
+CliLineBuffer::Result CliLineBuffer::push(char c) {
+    const bool after_cr = last_cr_;
+    last_cr_ = (c == '\r');
+    
+    if (c == '\r' || c == '\n') {
+        if (c == '\n' && after_cr) {
+            return Result::IGNORED;
+        }
+        if (discarding_) {
+            clear();
+            return Result::OVERFLOW;
+        }
+        buffer_[length_] = '\0';
+        line_length_ = length_;
+        length_ = 0;
+        return Result::LINE;
+    }
+    if (c == CTRL_C) {
+        clear();
+        return Result::CANCEL;
+    }
+    if (discarding_) {
+        return Result::IGNORED;
+    }
+    if (c == BACKSPACE || c == DEL) {
+        if (length_ == 0) {
+            return Result::IGNORED;
+        }
+        length_--;
+        return Result::ERASE;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+        // その他の制御文字（エスケープシーケンスの先頭など）は行に入れない
+        return Result::IGNORED;
+    }
+    if (length_ >= CAPACITY - 1) {
+        discarding_ = true;
+        return Result::IGNORED;
+    }
+    buffer_[length_++] = c;
+    return Result::NONE;
+}
+
+void CliLineBuffer::clear() {
+    buffer_[0] = '\0';
+    length_ = 0;
+    line_length_ = 0;
+    discarding_ = false;
+}
+
+void CliLineBuffer::tokenize(char* line, CliArgs& args) {
+    args.count = 0;
+    char* p = line;
+    while (*p != '\0') {
+        while (isSpace(*p)) {
+            *p++ = '\0';
+        }
+        if (*p == '\0') {
+            break;
+        }
+        args.items[args.count++] = p;
+        if (args.count == CliArgs::MAX_ARGS) {
+            // 残りは区切らずに最後の引数へ残す
+            break;
+        }
+        while (*p != '\0' && !isSpace(*p)) {
+            p++;
+        }
+    }
+}
+
+Cli::Cli(const CliCommand* table, size_t count)
+    : table_(table)
+    , count_(count)
+    , config_()
+    , uart_(nullptr)
+    , line_()
+    , output_{}
+    , task_(nullptr)
+    , running_(false)
+    , stat_lines_(0)
+    , stat_unknown_(0)
+    , stat_errors_(0)
+    , stat_overflows_(0) {
+}
+
+Cli::~Cli() {
+    stop();
+}
+
+esp_err_t Cli::start(hal::UartHal& uart, const Config& config) {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    config_ = config;
+    uart_ = &uart;
+    line_.clear();
+    
+    // コンソールと共有する場合など、既に有効な受信リングはそのまま使う
+    esp_err_t ret = uart.enableRxRing(config_.rx_ring_size);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        running_.store(false, std::memory_order_release);
+        return ret;
+    }
+    
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "cli", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        ESP_LOGE(TAG, "CLIタスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t Cli::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // CLIタスクは1周期以内（実行中のコマンドが戻った後）にtask_を消して自分を削除する
+    for (uint32_t waited = 0; waited <= config_.poll_ms + 500 && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return task_ != nullptr ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+const CliCommand* Cli::find(const char* name) const {
+    size_t low = 0;
+    size_t high = count_;
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        const int order = compareName(table_[mid].name, name);
+        if (order == 0) {
+            return &table_[mid];
+        }
+        if (order < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return nullptr;
+}
+
+esp_err_t Cli::execute(char* line) {
+    CliArgs args;
+    CliLineBuffer::tokenize(line, args);
+    if (args.count == 0) {
+        return ESP_OK;
+    }
+    stat_lines_.fetch_add(1, std::memory_order_relaxed);
+    
+    const CliCommand* command = find(args.items[0]);
+    if (command == nullptr) {
+        stat_unknown_.fetch_add(1, std::memory_order_relaxed);
+        print("不明なコマンド: %s（help で一覧）\r\n", args.items[0]);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    esp_err_t ret = command->handler(*this, args, command->context);
+    if (ret == ESP_ERR_INVALID_ARG) {
+        print("使い方: %s\r\n", command->usage);
+    } else if (ret != ESP_OK) {
+        print("エラー: %s\r\n", esp_err_to_name(ret));
+    }
+    if (ret != ESP_OK) {
+        stat_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ret;
+}
+
+void Cli::print(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(output_, sizeof(output_), format, args);
+    va_end(args);
+    if (length <= 0) {
+        return;
+    }
+    write(output_, std::min(static_cast<size_t>(length), sizeof(output_) - 1));
+}
+
+void Cli::write(const char* data, size_t length) {
+    if (uart_ != nullptr) {
+        uart_->write(data, length);
+    }
+}
+
+void Cli::prompt() {
+    if (config_.prompt != nullptr) {
+        write(config_.prompt, strlen(config_.prompt));
+    }
+}
+
+void Cli::service() {
+    for (;;) {
+        const hal::UartHal::RxRegion region = uart_->peekRx();
+        if (region.length == 0) {
+            return;
+        }
+        
+        size_t used = 0;
+        size_t echo_start = 0;
+        while (used < region.length) {
+            const char c = static_cast<char>(region.data[used++]);
+            const CliLineBuffer::Result result = line_.push(c);
+            if (result == CliLineBuffer::Result::NONE) {
+                continue;
+            }
+            
+            // 行に入った文字は区切りごとにまとめてエコーする（1バイト毎に書かない）
+            const size_t echo_length = used - 1 - echo_start;
+            if (config_.echo && echo_length > 0) {
+                write(reinterpret_cast<const char*>(region.data) + echo_start, echo_length);
+            }
+            echo_start = used;
+            
+            switch (result) {
+            case CliLineBuffer::Result::LINE:
+                if (config_.echo) {
+                    write("\r\n", 2);
+                }
+                execute(line_.line());
+                prompt();
+                break;
+            case CliLineBuffer::Result::ERASE:
+                if (config_.echo) {
+                    write("\b \b", 3);
+                }
+                break;
+            case CliLineBuffer::Result::CANCEL:
+                write("^C\r\n", 4);
+                prompt();
+                break;
+            case CliLineBuffer::Result::OVERFLOW:
+                stat_overflows_.fetch_add(1, std::memory_order_relaxed);
+                print("\r\n行が長すぎます（%u文字まで）\r\n", static_cast<unsigned>(CliLineBuffer::CAPACITY - 1));
+                prompt();
+                break;
+            default:
+                break;
+            }
+        }
+        if (config_.echo && region.length > echo_start) {
+            write(reinterpret_cast<const char*>(region.data) + echo_start, region.length - echo_start);
+        }
+        uart_->consumeRx(region.length);
+    }
+}
+
+void Cli::taskEntry(void* arg) {
+    Cli* self = static_cast<Cli*>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->config_.poll_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    self->prompt();
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->service();
+        vTaskDelayUntil(&last_wake, period);
+    }
+    
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+Cli::Stats Cli::getStats() const {
+    Stats stats;
+    stats.lines = stat_lines_.load(std::memory_order_relaxed);
+    stats.unknown = stat_unknown_.load(std::memory_order_relaxed);
+    stats.errors = stat_errors_.load(std::memory_order_relaxed);
+    stats.overflows = stat_overflows_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Cli::dump() const {
+    const Stats stats = getStats();
+    ESP_LOGI(TAG, "%s コマンド %u 実行 %lu 不明 %lu エラー %lu 行長超過 %lu", 
+             running_.load(std::memory_order_relaxed) ? "動作中" : "停止", static_cast<unsigned>(count_), 
+             static_cast<unsigned long>(stats.lines), static_cast<unsigned long>(stats.unknown), 
+             static_cast<unsigned long>(stats.errors), static_cast<unsigned long>(stats.overflows));
+}
+
+} // namespace cli
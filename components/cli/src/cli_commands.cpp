@@ -0,0 +1,116 @@
+/*
+ * CLI Commands Implementation
+ * 
+ * コマンド表で共通に使うコマンド処理関数（help・param）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "cli.hpp"
+#include "param_registry.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace cli {
+
+namespace {
+
+/**
+ * @brief 数値の解析（全体が数値であること）
+ */
+bool parseFloat(const char* text, float& value) {
+    char* end = nullptr;
+    value = strtof(text, &end);
+    return end != text && *end == '\0';
+}
+
+bool parseInt(const char* text, int32_t& value) {
+    char* end = nullptr;
+    const long parsed = strtol(text, &end, 0);
+    if (end == text || *end != '\0' || parsed < INT32_MIN || parsed > INT32_MAX) {
+        return false;
+    }
+    value = static_cast<int32_t>(parsed);
+    return true;
+}
+
+void printParam(Cli& cli, const params::ParamRegistry& registry, params::ParamId id) {
+    const params::ParamInfo& info = params::ParamRegistry::getInfo(id);
+    if (info.type == params::ParamType::FLOAT) {
+        cli.print("%-16s %.6g\r\n", info.name, registry.getFloat(id));
+    } else {
+        cli.print("%-16s %ld\r\n", info.name, static_cast<long>(registry.getInt(id)));
+    }
+}
+
+} // namespace
+
+esp_err_t helpHandler(Cli& cli, const CliArgs& args, void* context) {
+    (void)args;
+    (void)context;
+    for (size_t i = 0; i < cli.size(); i++) {
+        cli.print("  %s\r\n", cli.table()[i].usage);
+    }
+    return ESP_OK;
+}
+
+esp_err_t paramHandler(Cli& cli, const CliArgs& args, void* context) {
+    params::ParamRegistry& registry = *static_cast<params::ParamRegistry*>(context);
+    const char* action = args[1];
+    
+    if (strcmp(action, "list") == 0 && args.count == 2) {
+        for (size_t i = 0; i < params::ParamRegistry::COUNT; i++) {
+            printParam(cli, registry, static_cast<params::ParamId>(i));
+        }
+        cli.print("未保存: %s\r\n", registry.isDirty() ? "あり" : "なし");
+        return ESP_OK;
+    }
+    if (strcmp(action, "save") == 0 && args.count == 2) {
+        // 自動サスペンドなしのビルドではアーム中に断られる（ESP_ERR_NOT_ALLOWED）
+        esp_err_t ret = registry.flush();
+        if (ret == ESP_ERR_NOT_ALLOWED) {
+            cli.print("制御中のため保存を後回しにしました（解除後に自動保存）\r\n");
+            return ESP_OK;
+        }
+        return ret;
+    }
+    if (strcmp(action, "reset") == 0 && args.count == 2) {
+        registry.resetToDefaults();
+        return ESP_OK;
+    }
+    
+    const bool get = strcmp(action, "get") == 0 && args.count == 3;
+    const bool set = strcmp(action, "set") == 0 && args.count == 4;
+    if (!get && !set) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    params::ParamId id;
+    if (params::ParamRegistry::findByName(args[2], id) != ESP_OK) {
+        cli.print("不明なパラメータ: %s\r\n", args[2]);
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (set) {
+        // 値は原子的に入れ替わり、制御ループは次の読み出しから使う（保存は遅延実行）
+        const params::ParamInfo& info = params::ParamRegistry::getInfo(id);
+        esp_err_t ret;
+        if (info.type == params::ParamType::FLOAT) {
+            float value;
+            ret = parseFloat(args[3], value) ? registry.setFloat(id, value) : ESP_ERR_INVALID_ARG;
+        } else {
+            int32_t value;
+            ret = parseInt(args[3], value) ? registry.setInt(id, value) : ESP_ERR_INVALID_ARG;
+        }
+        if (ret != ESP_OK) {
+            cli.print("設定できません: %s（%g〜%g）\r\n", info.name, info.min_value, info.max_value);
+            return ESP_FAIL;
+        }
+    }
+    printParam(cli, registry, id);
+    return ESP_OK;
+}
+
+} // namespace cli
@@ -0,0 +1,29 @@
+# Flight Build Profile
+# 
+# 飛行用ビルドプロファイル（速度優先）
+# sdkconfig.defaults は全体をサイズ優先（-Os）でビルドするため、制御周期毎に動く
+# コンポーネント（common・control・estimation・hal）だけを -O2 にする。
+# CLI・Wi-Fi・ESP-IDF本体はサイズ優先のまま残る。
+# ホットなオブジェクトのIRAM配置は各コンポーネントの realtime.lf でプロファイルに関係なく常に行う。
+# 
+#   idf.py -DSTAMPFLY_FLIGHT_PROFILE=ON build
+# 
+# 作成者: Kouhei Ito
+# ライセンス: MIT License
+# 
+# Copyright (c) 2025 Kouhei Ito
+
+set(STAMPFLY_FLIGHT_PROFILE OFF CACHE BOOL "制御・推定・フィルタ・HALを-O2でビルド")
+
+# 最適化の切り替え（idf_component_register()の後で呼ぶ）
+# 引数なし: コンポーネント全体、引数あり: 指定したソースのみ（ヘッダーオンリーの制御器を使う側）
+function(stampfly_flight_profile)
+    if(NOT STAMPFLY_FLIGHT_PROFILE)
+        return()
+    endif()
+    if(ARGN)
+        set_source_files_properties(${ARGN} PROPERTIES COMPILE_OPTIONS "-O2")
+    else()
+        target_compile_options(${COMPONENT_LIB} PRIVATE "-O2")
+    endif()
+endfunction()
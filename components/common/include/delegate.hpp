@@ -0,0 +1,147 @@
+/*
+ * Delegate
+ * 
+ * ヒープ確保なしの固定サイズ呼び出しオブジェクト（ヘッダーオンリー）
+ * キャプチャは内部バッファへ直接格納し、呼び出しは1段の関数ポインタ経由で行う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef DELEGATE_HPP
+#define DELEGATE_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(ESP_PLATFORM)
+#include "esp_attr.h"
+#define DELEGATE_THUNK_ATTR IRAM_ATTR
+#else
+#define DELEGATE_THUNK_ATTR
+#endif
+
+namespace common {
+
+template<typename Signature, size_t N = 16>
+class Delegate;
+
+/**
+ * @brief 固定サイズデリゲート
+ * 
+ * std::functionの代替。格納できる呼び出し可能オブジェクトは
+ * サイズN以下・トリビアルコピー可能・トリビアル破棄可能なもの（関数ポインタ、
+ * ポインタや整数のみをキャプチャするラムダ）に限り、条件はコンパイル時に検査する。
+ * そのため登録時のヒープ確保・コピー時のコンストラクタ呼び出し・破棄処理はない。
+ * 
+ * 呼び出しサンクはIRAMに配置されるため、ISRから呼び出せる。
+ * ラムダ本体は通常サンク内へインライン展開されるが、本体から呼ぶ関数はIRAM配置が必要
+ * @tparam R 戻り値型
+ * @tparam Args 引数型
+ * @tparam N キャプチャ格納バッファのサイズ（バイト）
+ */
+template<typename R, typename... Args, size_t N>
+class Delegate<R(Args...), N> {
+public:
+    static constexpr size_t STORAGE_SIZE = N;
+    
+    /**
+     * @brief 空のデリゲート
+     */
+    Delegate() : storage_{}, invoke_(nullptr) {}
+    
+    /**
+     * @brief 空のデリゲート（nullptrから）
+     */
+    Delegate(std::nullptr_t) : storage_{}, invoke_(nullptr) {}
+    
+    /**
+     * @brief 呼び出し可能オブジェクトから構築
+     * @param callable 関数ポインタまたはラムダ
+     */
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Delegate> &&
+                                                     !std::is_same_v<std::decay_t<F>, std::nullptr_t>>>
+    Delegate(F&& callable) : storage_{}, invoke_(nullptr) {
+        assign(std::forward<F>(callable));
+    }
+    
+    Delegate(const Delegate& other) = default;
+    Delegate& operator=(const Delegate& other) = default;
+    
+    /**
+     * @brief 空にする
+     */
+    Delegate& operator=(std::nullptr_t) {
+        invoke_ = nullptr;
+        return *this;
+    }
+    
+    /**
+     * @brief 関数ポインタとコンテキストから構築（ISRハンドラ形式の登録用）
+     * @param function 関数ポインタ（第1引数にコンテキスト）
+     * @param context コンテキスト
+     * @return Delegate デリゲート
+     */
+    static Delegate fromFunction(R (*function)(void*, Args...), void* context) {
+        return Delegate([function, context](Args... args) -> R {
+            return function(context, args...);
+        });
+    }
+    
+    /**
+     * @brief 呼び出し
+     * @param args 引数
+     * @return R 戻り値（空の場合は呼び出し不可、operator boolで確認すること）
+     */
+    R operator()(Args... args) const {
+        return invoke_(storage_, args...);
+    }
+    
+    /**
+     * @brief 設定済み判定
+     */
+    explicit operator bool() const { return invoke_ != nullptr; }
+    
+    bool operator==(std::nullptr_t) const { return invoke_ == nullptr; }
+    bool operator!=(std::nullptr_t) const { return invoke_ != nullptr; }
+    
+private:
+    using Invoker = R (*)(const void* storage, Args... args);
+    
+    template<typename F>
+    void assign(F&& callable) {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= N, "キャプチャがデリゲートの格納サイズを超えています");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "キャプチャのアライメントが大きすぎます");
+        static_assert(std::is_trivially_copyable_v<Callable>, "キャプチャはトリビアルコピー可能であること");
+        static_assert(std::is_trivially_destructible_v<Callable>, "キャプチャはトリビアル破棄可能であること");
+        static_assert(std::is_invocable_r_v<R, const Callable&, Args...>, "シグネチャが一致しません");
+        
+        if constexpr (std::is_pointer_v<Callable>) {
+            Callable pointer = callable;
+            if (pointer == nullptr) {
+                invoke_ = nullptr;
+                return;
+            }
+        }
+        ::new (static_cast<void*>(storage_)) Callable(std::forward<F>(callable));
+        invoke_ = &thunk<Callable>;
+    }
+    
+    template<typename Callable>
+    static DELEGATE_THUNK_ATTR R thunk(const void* storage, Args... args) {
+        return (*std::launder(reinterpret_cast<const Callable*>(storage)))(args...);
+    }
+    
+    alignas(std::max_align_t) unsigned char storage_[N];    // キャプチャ格納領域
+    Invoker invoke_;                                        // 呼び出しサンク（nullptrは空）
+};
+
+} // namespace common
+
+#endif // DELEGATE_HPP
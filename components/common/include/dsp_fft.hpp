@@ -0,0 +1,49 @@
+/*
+ * DSP FFT
+ * 
+ * 基数2 FFT（複素数インタリーブ配列、インプレース）
+ * 実機ではesp-dspのESP32-S3最適化ルーチン（dsps_fft2r_fc32）で処理し、
+ * 検証用に同じ並びを返すスカラー参照実装を併せて提供する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef DSP_FFT_HPP
+#define DSP_FFT_HPP
+
+#include <cstddef>
+
+namespace common {
+namespace dsp {
+
+/**
+ * @brief FFTの初期化（回転因子表の作成、最初のfft()より前に1回呼び出す）
+ * @param max_size 使用する最大点数（2のべき乗）
+ * @return bool 初期化できた場合true
+ */
+bool fftInitialize(size_t max_size);
+
+/**
+ * @brief 複素FFT（自然順の結果を返す）
+ * @param data 複素数列 {re0, im0, re1, im1, ...}（2*size要素）
+ * @param size 点数（2のべき乗、fftInitialize()の最大点数以下）
+ */
+void fft(float* data, size_t size);
+
+/**
+ * @brief 複素FFTのスカラー参照実装（回転因子は都度計算）
+ */
+void fftReference(float* data, size_t size);
+
+/**
+ * @brief 2のべき乗判定
+ */
+constexpr bool isPowerOfTwo(size_t value) { return value >= 2 && (value & (value - 1)) == 0; }
+
+} // namespace dsp
+} // namespace common
+
+#endif // DSP_FFT_HPP
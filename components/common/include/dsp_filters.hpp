@@ -0,0 +1,258 @@
+/*
+ * DSP Filters
+ * 
+ * ブロック処理のディジタルフィルタ（双2次カスケード・FIR・ノッチ・内積）
+ * 実機ではesp-dspのESP32-S3最適化ルーチン（dsps_biquad_f32_aes3等）で処理し、
+ * 検証用に同じ演算順のスカラー参照実装を併せて提供する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef DSP_FILTERS_HPP
+#define DSP_FILTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace common {
+
+/**
+ * @brief 双2次フィルタ係数構造体
+ * 
+ * メンバの並びはesp-dspの係数配列（b0, b1, b2, a1, a2、a0で正規化済み）と同じ
+ */
+struct BiquadCoefficients {
+    float b0;       // 分子係数
+    float b1;
+    float b2;
+    float a1;       // 分母係数（a0 = 1）
+    float a2;
+    
+    /**
+     * @brief 素通し（y = x）
+     */
+    static BiquadCoefficients passthrough() { return {1.0f, 0.0f, 0.0f, 0.0f, 0.0f}; }
+    
+    /**
+     * @brief 2次ローパス（RBJ Audio EQ Cookbook）
+     * @param cutoff_hz 遮断周波数（Hz）
+     * @param sample_hz サンプリング周波数（Hz）
+     * @param q Q値（0.7071でバターワース）
+     * @return BiquadCoefficients 係数（遮断周波数がナイキスト以上の場合は素通し）
+     */
+    static BiquadCoefficients lowpass(float cutoff_hz, float sample_hz, float q = 0.70710678f);
+    
+    /**
+     * @brief ノッチ（RBJ Audio EQ Cookbook）
+     * @param center_hz 中心周波数（Hz）
+     * @param sample_hz サンプリング周波数（Hz）
+     * @param q Q値（大きいほど狭帯域）
+     * @return BiquadCoefficients 係数（中心周波数がナイキスト以上の場合は素通し）
+     */
+    static BiquadCoefficients notch(float center_hz, float sample_hz, float q);
+};
+
+static_assert(sizeof(BiquadCoefficients) == 5 * sizeof(float), "esp-dspの係数配列と同じ配置");
+
+namespace dsp {
+
+/**
+ * @brief 双2次フィルタのブロック処理（直接形II、esp-dsp）
+ * @param input 入力（outputと同じでもよい）
+ * @param output 出力
+ * @param length サンプル数
+ * @param coefficients 係数
+ * @param state 状態（float[2]）
+ */
+void biquad(const float* input, float* output, size_t length, const BiquadCoefficients& coefficients, float* state);
+
+/**
+ * @brief 双2次フィルタのスカラー参照実装（biquad()と同じ演算順）
+ */
+void biquadReference(const float* input, float* output, size_t length, const BiquadCoefficients& coefficients, 
+                     float* state);
+
+/**
+ * @brief 内積（esp-dsp）
+ * @param a 入力1
+ * @param b 入力2
+ * @param length 要素数
+ * @return float 内積
+ */
+float dotProduct(const float* a, const float* b, size_t length);
+
+/**
+ * @brief 内積のスカラー参照実装
+ */
+float dotProductReference(const float* a, const float* b, size_t length);
+
+} // namespace dsp
+
+/**
+ * @brief 双2次フィルタ多段カスケード
+ * 
+ * 係数は全チャンネル共通、状態はチャンネル毎に持つ（ジャイロ3軸で1つのインスタンス）。
+ * 1段ずつブロック全体を処理するため、サンプル毎の関数呼び出しが発生しない
+ * @tparam STAGES 段数
+ * @tparam CHANNELS チャンネル数
+ */
+template<size_t STAGES, size_t CHANNELS = 1>
+class BiquadCascade {
+    static_assert(STAGES > 0 && CHANNELS > 0, "段数・チャンネル数は1以上");
+    
+public:
+    static constexpr size_t STAGE_COUNT = STAGES;           // 段数
+    static constexpr size_t CHANNEL_COUNT = CHANNELS;       // チャンネル数
+    
+    /**
+     * @brief コンストラクタ（全段素通し）
+     */
+    BiquadCascade() {
+        for (size_t s = 0; s < STAGES; s++) {
+            coefficients_[s] = BiquadCoefficients::passthrough();
+        }
+        reset();
+    }
+    
+    /**
+     * @brief 段の係数設定（状態は保持する）
+     * @param stage 段番号
+     * @param coefficients 係数
+     */
+    void setStage(size_t stage, const BiquadCoefficients& coefficients) {
+        if (stage < STAGES) {
+            coefficients_[stage] = coefficients;
+        }
+    }
+    
+    /**
+     * @brief 段の係数取得
+     */
+    const BiquadCoefficients& getStage(size_t stage) const { return coefficients_[stage]; }
+    
+    /**
+     * @brief 全チャンネルの状態をクリア
+     */
+    void reset() { memset(state_, 0, sizeof(state_)); }
+    
+    /**
+     * @brief ブロック処理（esp-dsp）
+     * @param channel チャンネル番号
+     * @param input 入力（outputと同じでもよい）
+     * @param output 出力
+     * @param length サンプル数
+     */
+    void process(size_t channel, const float* input, float* output, size_t length) {
+        const float* source = input;
+        for (size_t s = 0; s < STAGES; s++) {
+            dsp::biquad(source, output, length, coefficients_[s], state_[channel][s]);
+            source = output;
+        }
+    }
+    
+    /**
+     * @brief ブロック処理（スカラー参照実装、検証用）
+     */
+    void processReference(size_t channel, const float* input, float* output, size_t length) {
+        const float* source = input;
+        for (size_t s = 0; s < STAGES; s++) {
+            dsp::biquadReference(source, output, length, coefficients_[s], state_[channel][s]);
+            source = output;
+        }
+    }
+    
+private:
+    BiquadCoefficients coefficients_[STAGES];       // 段毎の係数
+    float state_[CHANNELS][STAGES][2];              // チャンネル×段の状態（直接形IIの遅延）
+};
+
+/**
+ * @brief FIRフィルタ
+ * 
+ * 遅延線を2倍長の環状バッファとし、同じサンプルを2箇所に書くことで
+ * 直近TAPS個のサンプルが常に連続領域に並ぶ。各出力は係数（逆順）との内積1回で求める
+ * @tparam TAPS タップ数
+ * @tparam CHANNELS チャンネル数
+ */
+template<size_t TAPS, size_t CHANNELS = 1>
+class FirFilter {
+    static_assert(TAPS > 0 && CHANNELS > 0, "タップ数・チャンネル数は1以上");
+    
+public:
+    static constexpr size_t TAP_COUNT = TAPS;       // タップ数
+    
+    /**
+     * @brief コンストラクタ
+     * @param taps 係数（h[0]が最新サンプルに掛かる）
+     */
+    explicit FirFilter(const float (&taps)[TAPS]) {
+        setTaps(taps);
+        reset();
+    }
+    
+    /**
+     * @brief 係数設定（状態は保持する）
+     * @param taps 係数
+     */
+    void setTaps(const float (&taps)[TAPS]) {
+        for (size_t k = 0; k < TAPS; k++) {
+            reversed_[k] = taps[TAPS - 1 - k];
+        }
+    }
+    
+    /**
+     * @brief 全チャンネルの状態をクリア
+     */
+    void reset() {
+        memset(delay_, 0, sizeof(delay_));
+        memset(head_, 0, sizeof(head_));
+    }
+    
+    /**
+     * @brief ブロック処理（esp-dspの内積）
+     * @param channel チャンネル番号
+     * @param input 入力（outputと同じでもよい）
+     * @param output 出力
+     * @param length サンプル数
+     */
+    void process(size_t channel, const float* input, float* output, size_t length) {
+        for (size_t n = 0; n < length; n++) {
+            output[n] = dsp::dotProduct(reversed_, push(channel, input[n]), TAPS);
+        }
+    }
+    
+    /**
+     * @brief ブロック処理（スカラー参照実装、検証用）
+     */
+    void processReference(size_t channel, const float* input, float* output, size_t length) {
+        for (size_t n = 0; n < length; n++) {
+            output[n] = dsp::dotProductReference(reversed_, push(channel, input[n]), TAPS);
+        }
+    }
+    
+private:
+    alignas(16) float reversed_[TAPS];                  // 逆順の係数（古いサンプルから順に掛ける）
+    alignas(16) float delay_[CHANNELS][2 * TAPS];       // チャンネル毎の2倍長遅延線
+    size_t head_[CHANNELS];                             // 次に書き込む位置
+    
+    /**
+     * @brief サンプル追加
+     * @return const float* 古い順に並んだ直近TAPS個のサンプル
+     */
+    const float* push(size_t channel, float sample) {
+        size_t head = head_[channel];
+        float* line = delay_[channel];
+        line[head] = sample;
+        line[head + TAPS] = sample;
+        head_[channel] = head + 1 < TAPS ? head + 1 : 0;
+        return line + head + 1;
+    }
+};
+
+} // namespace common
+
+#endif // DSP_FILTERS_HPP
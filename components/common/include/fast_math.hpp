@@ -0,0 +1,73 @@
+/*
+ * Fast Math
+ * 
+ * 推定・制御ループ用の高速数学関数（ヘッダーオンリー）
+ * 逆平方根は精度と速度の異なる方式をポリシー型として提供し、
+ * 呼び出し側のテンプレート引数で選択する（実行時の分岐なし）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef FAST_MATH_HPP
+#define FAST_MATH_HPP
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace common {
+
+/**
+ * @brief 逆平方根（標準ライブラリ、1.0f / sqrtf）
+ * 
+ * 相対誤差は丸め誤差程度。比較の基準とする
+ */
+struct InvSqrtLibm {
+    static constexpr const char* NAME = "1/sqrtf";
+    static inline float apply(float x) { return 1.0f / sqrtf(x); }
+};
+
+/**
+ * @brief 逆平方根（ビット演算の初期値 + ニュートン法1回）
+ * 
+ * 定数はMorozらの改良値で、相対誤差は最大約6.5e-4。
+ * クォータニオン正規化は毎サンプル行うため誤差は蓄積せず、姿勢推定には十分な精度
+ */
+struct InvSqrtFast {
+    static constexpr const char* NAME = "fast(NR1)";
+    static inline float apply(float x) {
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        bits = 0x5F1FFFF9u - (bits >> 1);
+        float y;
+        memcpy(&y, &bits, sizeof(y));
+        return y * 0.703952253f * (2.38924456f - x * y * y);
+    }
+};
+
+/**
+ * @brief 逆平方根（ビット演算の初期値 + ニュートン法2回）
+ * 
+ * 相対誤差は最大約5e-6
+ */
+struct InvSqrtFastPrecise {
+    static constexpr const char* NAME = "fast(NR2)";
+    static inline float apply(float x) {
+        uint32_t bits;
+        memcpy(&bits, &x, sizeof(bits));
+        bits = 0x5F375A86u - (bits >> 1);
+        float y;
+        memcpy(&y, &bits, sizeof(y));
+        const float half_x = 0.5f * x;
+        y = y * (1.5f - half_x * y * y);
+        y = y * (1.5f - half_x * y * y);
+        return y;
+    }
+};
+
+} // namespace common
+
+#endif // FAST_MATH_HPP
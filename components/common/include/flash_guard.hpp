@@ -0,0 +1,152 @@
+/*
+ * Flash Guard
+ * 
+ * 制御中のフラッシュ書き込み・消去の抑止（ヘッダーオンリー）
+ * フラッシュの書き込み・消去中はキャッシュが無効になり、IRAM安全な割り込み以外は
+ * 両コアとも止まる（制御タスクも起床できない）。フラッシュの自動サスペンド
+ * （CONFIG_SPI_FLASH_AUTO_SUSPEND）が無効なビルドでは、アーム中の書き込みを
+ * 書き込み側で断って制御ティックを止めないようにする
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef FLASH_GUARD_HPP
+#define FLASH_GUARD_HPP
+
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief フラッシュ書き込み抑止クラス
+ * 
+ * 書き込み側（PartitionLog・ParamRegistry等）は書き込み・消去の前後を beginWrite()・endWrite()（またはScope）で囲み、
+ * 許可されなければ書き込まずに後回しにする。アーム時の runtime::PowerManager::enterFlightMode() が
+ * enterRealtime() で抑止を始め、実行中の書き込みが終わるのを待ってから戻る（判定と計数の順序で取りこぼしはない）。
+ * 自動サスペンドが有効なビルドでは書き込み中もキャッシュミスで書き込みが中断されるため抑止しない
+ * 
+ * 消去済みセクタへのページ書き込みはキャッシュの停止が1ページ（256バイト）毎の短い区間に分かれるため、
+ * ブラックボックスのように飛行中も書かなければ意味のない書き込みは exempt を指定して抑止中も書ける
+ * （セクタ消去は数十msキャッシュが止まるため、常に抑止に従う）
+ */
+class FlashGuard {
+public:
+#if defined(CONFIG_SPI_FLASH_AUTO_SUSPEND) && CONFIG_SPI_FLASH_AUTO_SUSPEND
+    static constexpr bool AUTO_SUSPEND = true;      // 自動サスペンド有効（抑止不要）
+#else
+    static constexpr bool AUTO_SUSPEND = false;     // 自動サスペンド無効
+#endif
+    
+    /**
+     * @brief 書き込み区間（構築時にbeginWrite()、許可されていれば破棄時にendWrite()）
+     */
+    class Scope {
+    public:
+        explicit Scope(FlashGuard& guard, bool exempt = false)
+            : guard_(guard)
+            , allowed_(guard.beginWrite(exempt)) {}
+        
+        ~Scope() {
+            if (allowed_) {
+                guard_.endWrite();
+            }
+        }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+        /**
+         * @brief 書き込んでよいか
+         */
+        bool allowed() const { return allowed_; }
+        
+    private:
+        FlashGuard& guard_;     // 抑止
+        bool allowed_;          // 書き込み許可
+    };
+    
+    FlashGuard()
+        : realtime_(false)
+        , writers_(0)
+        , blocked_(0) {}
+    
+    FlashGuard(const FlashGuard&) = delete;
+    FlashGuard& operator=(const FlashGuard&) = delete;
+    
+    /**
+     * @brief 書き込みの開始（書き込み側）
+     * @param exempt 抑止中も書く場合true（消去済みセクタへの書き込みのみ、消去には使わない）
+     * @return bool 書き込んでよい場合true（trueの場合のみendWrite()を呼ぶ）
+     */
+    bool beginWrite(bool exempt = false) {
+        writers_.fetch_add(1, std::memory_order_seq_cst);
+        if (!AUTO_SUSPEND && !exempt && realtime_.load(std::memory_order_seq_cst)) {
+            writers_.fetch_sub(1, std::memory_order_seq_cst);
+            blocked_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief 書き込みの終了（書き込み側）
+     */
+    void endWrite() { writers_.fetch_sub(1, std::memory_order_seq_cst); }
+    
+    /**
+     * @brief 抑止の開始（アーム時）
+     * @param timeout 実行中の書き込みの終了を待つ時間
+     * @return bool 実行中の書き込みがなくなった場合true
+     */
+    bool enterRealtime(TickType_t timeout) {
+        realtime_.store(true, std::memory_order_seq_cst);
+        TickType_t start = xTaskGetTickCount();
+        while (writers_.load(std::memory_order_seq_cst) != 0) {
+            if (xTaskGetTickCount() - start >= timeout) {
+                return false;
+            }
+            vTaskDelay(1);
+        }
+        return true;
+    }
+    
+    /**
+     * @brief 抑止の終了（ディスアーム時、後回しにした書き込みは書き込み側の次の周期で行われる）
+     */
+    void exitRealtime() { realtime_.store(false, std::memory_order_seq_cst); }
+    
+    /**
+     * @brief 抑止中か（自動サスペンド有効時も抑止の開始から終了までtrue）
+     */
+    bool isRealtime() const { return realtime_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 断った書き込みの回数
+     */
+    uint32_t getBlockedCount() const { return blocked_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief システム共通インスタンス取得
+     * @return FlashGuard& フラッシュ書き込み抑止
+     */
+    static FlashGuard& instance() {
+        static FlashGuard guard;
+        return guard;
+    }
+    
+private:
+    std::atomic<bool> realtime_;        // 抑止中
+    std::atomic<uint32_t> writers_;     // 実行中の書き込み数
+    std::atomic<uint32_t> blocked_;     // 断った書き込みの回数
+};
+
+} // namespace common
+
+#endif // FLASH_GUARD_HPP
@@ -0,0 +1,199 @@
+/*
+ * Flight State
+ * 
+ * コア間共有の機体状態スナップショット（ヘッダーオンリー）
+ * 単一の書き込みタスクが更新し、テレメトリ・CLI等の複数タスクが待ちなしで読み出す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef FLIGHT_STATE_HPP
+#define FLIGHT_STATE_HPP
+
+#include "mailbox.hpp"
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief 飛行モード列挙型（app_main.hのsystem_state_tと同じ値）
+ */
+enum class FlightMode : uint8_t {
+    INIT = 0,           // システム初期化中
+    CALIBRATION,        // キャリブレーション中
+    READY,              // 準備完了
+    ARMED,              // アーム済み
+    FLIGHT,             // 飛行中
+    EMERGENCY,          // 緊急状態
+    SHUTDOWN            // シャットダウン中
+};
+
+/**
+ * @brief 3次元ベクトル（共有状態用の最小構造体）
+ */
+struct Vector3f {
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * @brief 機体状態
+ */
+struct FlightState {
+    int64_t timestamp_us;       // 更新時刻（μs）
+    uint32_t update_count;      // 公開回数
+    
+    // 姿勢
+    float roll;                 // ロール角（rad）
+    float pitch;                // ピッチ角（rad）
+    float yaw;                  // ヨー角（rad）
+    Vector3f rates;             // 角速度（rad/s、機体座標）
+    
+    // 位置・速度
+    Vector3f position;          // 位置（m、NED）
+    Vector3f velocity;          // 速度（m/s、NED）
+    float altitude;             // 高度（m）
+    
+    // 電源
+    float battery_voltage;      // バッテリー電圧（V）
+    float battery_current;      // バッテリー電流（A）
+    
+    // 状態
+    FlightMode mode;            // 飛行モード
+    bool armed;                 // アーム状態
+    bool rc_failsafe;           // リモコンフェイルセーフ中
+    uint8_t reserved;           // 予約
+    uint32_t error_flags;       // エラーフラグ
+};
+
+/**
+ * @brief 共有機体状態
+ * 
+ * 書き込みタスクはedit()で作業用コピーを更新しpublish()で公開する。
+ * 読み出しはシーケンスロックで、書き込み中に重なった場合のみ再試行するため
+ * 読み出し側が書き込みタスク（制御ループ）を待たせることはない
+ */
+class SharedFlightState {
+public:
+    SharedFlightState()
+        : working_{} {}
+    
+    SharedFlightState(const SharedFlightState&) = delete;
+    SharedFlightState& operator=(const SharedFlightState&) = delete;
+    
+    /**
+     * @brief 作業用コピー取得（書き込みタスク専用）
+     * @return FlightState& 作業用コピー
+     */
+    FlightState& edit() { return working_; }
+    
+    /**
+     * @brief 作業用コピーを公開（書き込みタスク専用）
+     * @param timestamp_us 更新時刻（μs）
+     */
+    void publish(int64_t timestamp_us) {
+        working_.timestamp_us = timestamp_us;
+        working_.update_count++;
+        mailbox_.write(working_);
+    }
+    
+    /**
+     * @brief 最新スナップショット取得（任意のタスク）
+     * @param state 格納先
+     * @return bool 取得できた場合true（未公開・競合で再試行上限時はfalse）
+     */
+    bool snapshot(FlightState& state) const { return mailbox_.read(state); }
+    
+    /**
+     * @brief 最新スナップショットと版数取得（任意のタスク）
+     * @param state 格納先
+     * @param version 版数（前回と同じなら未更新）
+     * @return bool 取得できた場合true
+     */
+    bool snapshot(FlightState& state, uint32_t& version) const { return mailbox_.read(state, version); }
+    
+    /**
+     * @brief 現在の版数取得
+     * @return uint32_t 版数（0は未公開）
+     */
+    uint32_t getVersion() const { return mailbox_.getVersion(); }
+    
+    /**
+     * @brief システム共通インスタンス取得
+     * @return SharedFlightState& 共有機体状態
+     */
+    static SharedFlightState& instance() {
+        static SharedFlightState shared;
+        return shared;
+    }
+    
+private:
+    FlightState working_;               // 書き込みタスクの作業用コピー
+    Mailbox<FlightState> mailbox_;      // 公開済みスナップショット
+};
+
+/**
+ * @brief 姿勢ループへの目標値（位置制御の出力）
+ */
+struct AttitudeSetpoint {
+    int64_t timestamp_us;       // 生成時刻（μs）
+    uint32_t update_count;      // 公開回数
+    float roll;                 // 目標ロール角（rad）
+    float pitch;                // 目標ピッチ角（rad）
+    float yaw;                  // 目標ヨー角（rad）
+    float thrust;               // 目標推力（0〜1、ミキサーのスロットル）
+    bool valid;                 // 位置制御が有効（falseの間はリモコンの目標を使う）
+};
+
+/**
+ * @brief 共有姿勢目標値
+ * 
+ * 位置制御（分周したレートグループ）が publish() し、姿勢ループが毎周期 snapshot() で最新値を読む。
+ * SharedFlightState と同じく書き込みは単一のタスクのみ
+ */
+class SharedAttitudeSetpoint {
+public:
+    SharedAttitudeSetpoint()
+        : update_count_(0) {}
+    
+    SharedAttitudeSetpoint(const SharedAttitudeSetpoint&) = delete;
+    SharedAttitudeSetpoint& operator=(const SharedAttitudeSetpoint&) = delete;
+    
+    /**
+     * @brief 目標値を公開（書き込みタスク専用）
+     * @param setpoint 目標値（update_countは上書きする）
+     */
+    void publish(const AttitudeSetpoint& setpoint) {
+        AttitudeSetpoint value = setpoint;
+        value.update_count = ++update_count_;
+        mailbox_.write(value);
+    }
+    
+    /**
+     * @brief 最新の目標値取得（任意のタスク）
+     * @param setpoint 格納先
+     * @return bool 取得できた場合true
+     */
+    bool snapshot(AttitudeSetpoint& setpoint) const { return mailbox_.read(setpoint); }
+    
+    /**
+     * @brief システム共通インスタンス取得
+     * @return SharedAttitudeSetpoint& 共有姿勢目標値
+     */
+    static SharedAttitudeSetpoint& instance() {
+        static SharedAttitudeSetpoint shared;
+        return shared;
+    }
+    
+private:
+    uint32_t update_count_;                 // 公開回数（書き込みタスクのみ更新）
+    Mailbox<AttitudeSetpoint> mailbox_;     // 公開済みの目標値
+};
+
+} // namespace common
+
+#endif // FLIGHT_STATE_HPP
@@ -0,0 +1,84 @@
+/*
+ * ISR Time
+ * 
+ * 割り込みハンドラの実行時間のコア別積算（ヘッダーオンリー）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ISR_TIME_HPP
+#define ISR_TIME_HPP
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief 割り込みハンドラの実行時間積算
+ * 
+ * 計測したいハンドラの先頭に IsrTime::Scope を置くと、抜けるまでのCPUサイクルを
+ * 実行中のコアの積算値へ加える。FreeRTOSの実行時間統計では割り込み時間は割り込まれた
+ * タスクに含まれるため、CpuProfilerはこの積算値の差分でコア毎の割り込み負荷を求める。
+ * 積算値は32bitで240MHzでは約17秒で一周するので、読み出し側はそれより短い間隔で差分を取る。
+ * 多重割り込みでは内側のハンドラの時間が外側にも含まれる
+ */
+class IsrTime {
+public:
+    static constexpr size_t CORE_COUNT = 2;     // コア数
+    
+    /**
+     * @brief 計測区間（ハンドラのスコープ）
+     */
+    class Scope {
+    public:
+        IRAM_ATTR Scope()
+            : start_(static_cast<uint32_t>(esp_cpu_get_cycle_count())) {}
+        
+        IRAM_ATTR ~Scope() {
+            add(static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_);
+        }
+        
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+        
+    private:
+        uint32_t start_;        // 入口のサイクルカウント
+    };
+    
+    /**
+     * @brief 実行サイクルの加算（実行中のコアへ）
+     * @param cycles CPUサイクル数
+     */
+    static IRAM_ATTR void add(uint32_t cycles) {
+        size_t core = static_cast<size_t>(esp_cpu_get_core_id()) % CORE_COUNT;
+        cycles_[core].fetch_add(cycles, std::memory_order_relaxed);
+        count_[core].fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief 積算サイクル数（一周する）
+     * @param core コア番号
+     */
+    static uint32_t cycles(size_t core) { return cycles_[core % CORE_COUNT].load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 積算回数（一周する）
+     * @param core コア番号
+     */
+    static uint32_t count(size_t core) { return count_[core % CORE_COUNT].load(std::memory_order_relaxed); }
+    
+private:
+    static inline std::atomic<uint32_t> cycles_[CORE_COUNT] = {};     // コア別の積算サイクル数
+    static inline std::atomic<uint32_t> count_[CORE_COUNT] = {};      // コア別の積算回数
+};
+
+} // namespace common
+
+#endif // ISR_TIME_HPP
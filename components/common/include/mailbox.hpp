@@ -0,0 +1,111 @@
+/*
+ * Mailbox
+ * 
+ * 最新値メールボックス（シーケンスロック、ヘッダーオンリー）
+ * 書き込み側は待たず、読み出し側は常に最新の1件を取得する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace common {
+
+/**
+ * @brief 最新値メールボックス
+ * 
+ * 書き込みは単一のタスク（またはISR）から行うこと。読み出しは複数タスクから可能。
+ * 版数が奇数の間は書き込み中で、読み出し側は版数が前後で一致するまで再試行する
+ * @tparam T 値の型（トリビアルコピー可能であること）
+ */
+template<typename T>
+class Mailbox {
+    static_assert(std::is_trivially_copyable<T>::value, "値の型はトリビアルコピー可能であること");
+    
+public:
+    static constexpr int DEFAULT_READ_RETRIES = 8;     // 読み出し再試行回数の既定値
+    
+    Mailbox()
+        : sequence_(0)
+        , value_{} {}
+    
+    Mailbox(const Mailbox&) = delete;
+    Mailbox& operator=(const Mailbox&) = delete;
+    
+    /**
+     * @brief 値書き込み（単一の書き込み側のみ）
+     * @param value 値
+     */
+    void write(const T& value) {
+        const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value_, &value, sizeof(T));
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+    
+    /**
+     * @brief 最新値読み出し
+     * @param value 格納先
+     * @param retries 書き込みと競合した場合の再試行回数
+     * @return bool 一貫した値を取得できた場合true（未書き込み時はfalse）
+     */
+    bool read(T& value, int retries = DEFAULT_READ_RETRIES) const {
+        uint32_t version = 0;
+        return read(value, version, retries);
+    }
+    
+    /**
+     * @brief 最新値と版数の読み出し
+     * 
+     * 版数は書き込みごとに2ずつ増えるため、前回と比較して新しい値かどうかを判定できる
+     * @param value 格納先
+     * @param version 取得した値の版数
+     * @param retries 書き込みと競合した場合の再試行回数
+     * @return bool 一貫した値を取得できた場合true（未書き込み時はfalse）
+     */
+    bool read(T& value, uint32_t& version, int retries = DEFAULT_READ_RETRIES) const {
+        for (int attempt = 0; attempt < retries; attempt++) {
+            const uint32_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            memcpy(&value, &value_, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                version = before;
+                return before != 0;
+            }
+        }
+        return false;
+    }
+    
+    /**
+     * @brief 現在の版数取得（0は未書き込み）
+     * @return uint32_t 版数
+     */
+    uint32_t getVersion() const { return sequence_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 書き込み済み判定
+     * @return bool 一度でも書き込まれていればtrue
+     */
+    bool hasValue() const { return getVersion() != 0; }
+    
+private:
+    std::atomic<uint32_t> sequence_;    // 版数（奇数=書き込み中）
+    T value_;                           // 値本体
+};
+
+} // namespace common
+
+#endif // MAILBOX_HPP
@@ -0,0 +1,539 @@
+/*
+ * Matrix
+ * 
+ * コンパイル時サイズの小行列ライブラリ（ヘッダーオンリー）
+ * 記憶域はスタック上の固定長配列でヒープを使わない。A*B + C はまとめて1回で計算し、
+ * 3x3・4x4は展開済みのカーネルで計算する（-Os時もループ制御を残さない）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+namespace common {
+
+template<size_t R, size_t C, typename T>
+class Matrix;
+
+template<size_t R, size_t K, size_t C, typename T>
+class MatMul;
+
+namespace detail {
+
+/**
+ * @brief 行列積の展開済みカーネル（out = base + sign * A * B）
+ * 
+ * 3x3x3・4x4x4・3x3x1・4x4x1は展開し、それ以外はコンパイル時サイズのループで計算する。
+ * outはA・B・baseと重ならないこと
+ * @tparam R Aの行数
+ * @tparam K Aの列数（Bの行数）
+ * @tparam C Bの列数
+ * @tparam SIGN 積の符号（+1または-1）
+ * @tparam ADD baseを加算する（falseの場合baseは参照しない）
+ */
+template<size_t R, size_t K, size_t C, int SIGN, bool ADD, typename T>
+inline void multiplyKernel(T* out, const T* a, const T* b, const T* base) {
+    static_assert(SIGN == 1 || SIGN == -1, "符号は+1または-1");
+    
+    if constexpr (K == 3 && (C == 3 || C == 1)) {
+        // 3列のAの1行 × B（Bの列数は3または1）
+        for (size_t i = 0; i < R; i++) {
+            const T a0 = a[i * 3 + 0];
+            const T a1 = a[i * 3 + 1];
+            const T a2 = a[i * 3 + 2];
+            T* o = out + i * C;
+            const T* c = ADD ? base + i * C : nullptr;
+            o[0] = (ADD ? c[0] : T(0)) + SIGN * (a0 * b[0] + a1 * b[C] + a2 * b[2 * C]);
+            if constexpr (C == 3) {
+                o[1] = (ADD ? c[1] : T(0)) + SIGN * (a0 * b[1] + a1 * b[4] + a2 * b[7]);
+                o[2] = (ADD ? c[2] : T(0)) + SIGN * (a0 * b[2] + a1 * b[5] + a2 * b[8]);
+            }
+        }
+    } else if constexpr (K == 4 && (C == 4 || C == 1)) {
+        for (size_t i = 0; i < R; i++) {
+            const T a0 = a[i * 4 + 0];
+            const T a1 = a[i * 4 + 1];
+            const T a2 = a[i * 4 + 2];
+            const T a3 = a[i * 4 + 3];
+            T* o = out + i * C;
+            const T* c = ADD ? base + i * C : nullptr;
+            o[0] = (ADD ? c[0] : T(0)) + SIGN * (a0 * b[0] + a1 * b[C] + a2 * b[2 * C] + a3 * b[3 * C]);
+            if constexpr (C == 4) {
+                o[1] = (ADD ? c[1] : T(0)) + SIGN * (a0 * b[1] + a1 * b[5] + a2 * b[9] + a3 * b[13]);
+                o[2] = (ADD ? c[2] : T(0)) + SIGN * (a0 * b[2] + a1 * b[6] + a2 * b[10] + a3 * b[14]);
+                o[3] = (ADD ? c[3] : T(0)) + SIGN * (a0 * b[3] + a1 * b[7] + a2 * b[11] + a3 * b[15]);
+            }
+        }
+    } else {
+        // 汎用：出力1要素ずつ内積を累積（アキュムレータはレジスタに保持される）
+        for (size_t i = 0; i < R; i++) {
+            for (size_t j = 0; j < C; j++) {
+                T sum = T(0);
+                for (size_t k = 0; k < K; k++) {
+                    sum += a[i * K + k] * b[k * C + j];
+                }
+                out[i * C + j] = (ADD ? base[i * C + j] : T(0)) + SIGN * sum;
+            }
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief 固定サイズ行列クラス
+ * 
+ * 行優先で R*C 要素をメンバ配列に保持する。サイズはすべてテンプレート引数で決まり、
+ * 次元の合わない演算はコンパイルエラーになる。
+ * 行列積 A*B は式オブジェクト（MatMul）を返し、代入時または + C / - C と組み合わせた時に評価する
+ * @tparam R 行数
+ * @tparam C 列数
+ * @tparam T 要素型
+ */
+template<size_t R, size_t C, typename T = float>
+class Matrix {
+    static_assert(R > 0 && C > 0, "行数・列数は1以上");
+    static_assert(std::is_floating_point<T>::value, "要素型は浮動小数点型");
+    
+public:
+    static constexpr size_t ROWS = R;           // 行数
+    static constexpr size_t COLS = C;           // 列数
+    static constexpr size_t SIZE = R * C;       // 要素数
+    
+    /**
+     * @brief コンストラクタ（ゼロ初期化）
+     */
+    constexpr Matrix() : data_{} {}
+    
+    /**
+     * @brief コンストラクタ（行優先で全要素を指定）
+     * @param values 要素（R*C個）
+     */
+    template<typename... Args,
+             typename = std::enable_if_t<sizeof...(Args) == SIZE && (SIZE > 1 || (std::is_arithmetic_v<Args> && ...))>>
+    constexpr Matrix(Args... values) : data_{static_cast<T>(values)...} {}
+    
+    /**
+     * @brief 行列積の式から構築（評価）
+     */
+    template<size_t K>
+    Matrix(const MatMul<R, K, C, T>& expr) { expr.evaluateTo(data_); }
+    
+    /**
+     * @brief 行列積の式を代入（評価、右辺が自分自身を含んでもよい）
+     */
+    template<size_t K>
+    Matrix& operator=(const MatMul<R, K, C, T>& expr) {
+        Matrix result(expr);
+        *this = result;
+        return *this;
+    }
+    
+    Matrix(const Matrix&) = default;
+    Matrix& operator=(const Matrix&) = default;
+    
+    /**
+     * @brief 零行列
+     */
+    static constexpr Matrix zeros() { return Matrix(); }
+    
+    /**
+     * @brief 単位行列（正方行列のみ）
+     */
+    static constexpr Matrix identity() {
+        static_assert(R == C, "単位行列は正方行列のみ");
+        Matrix m;
+        for (size_t i = 0; i < R; i++) {
+            m.data_[i * C + i] = T(1);
+        }
+        return m;
+    }
+    
+    /**
+     * @brief 対角行列（正方行列のみ）
+     * @param diagonal 対角要素
+     */
+    static constexpr Matrix diagonal(const Matrix<R, 1, T>& diagonal) {
+        static_assert(R == C, "対角行列は正方行列のみ");
+        Matrix m;
+        for (size_t i = 0; i < R; i++) {
+            m.data_[i * C + i] = diagonal[i];
+        }
+        return m;
+    }
+    
+    /**
+     * @brief 要素参照
+     * @param row 行
+     * @param col 列
+     */
+    constexpr T& operator()(size_t row, size_t col) { return data_[row * C + col]; }
+    constexpr const T& operator()(size_t row, size_t col) const { return data_[row * C + col]; }
+    
+    /**
+     * @brief 行優先の通し番号で要素参照（ベクトル用）
+     * @param index 番号
+     */
+    constexpr T& operator[](size_t index) { return data_[index]; }
+    constexpr const T& operator[](size_t index) const { return data_[index]; }
+    
+    /**
+     * @brief 要素配列（esp-dsp等の行優先API用）
+     */
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    
+    /**
+     * @brief 全要素を同じ値に設定
+     * @param value 値
+     */
+    constexpr void fill(T value) {
+        for (size_t i = 0; i < SIZE; i++) {
+            data_[i] = value;
+        }
+    }
+    
+    constexpr Matrix& operator+=(const Matrix& other) {
+        for (size_t i = 0; i < SIZE; i++) {
+            data_[i] += other.data_[i];
+        }
+        return *this;
+    }
+    
+    constexpr Matrix& operator-=(const Matrix& other) {
+        for (size_t i = 0; i < SIZE; i++) {
+            data_[i] -= other.data_[i];
+        }
+        return *this;
+    }
+    
+    constexpr Matrix& operator*=(T scalar) {
+        for (size_t i = 0; i < SIZE; i++) {
+            data_[i] *= scalar;
+        }
+        return *this;
+    }
+    
+    /**
+     * @brief 行列積の式を加算（this += A*B、積の一時行列を作らない）
+     */
+    template<size_t K>
+    Matrix& operator+=(const MatMul<R, K, C, T>& expr) {
+        Matrix result;
+        detail::multiplyKernel<R, K, C, 1, true>(result.data_, expr.lhs().data(), expr.rhs().data(), data_);
+        return *this = result;
+    }
+    
+    /**
+     * @brief 行列積の式を減算（this -= A*B、積の一時行列を作らない）
+     */
+    template<size_t K>
+    Matrix& operator-=(const MatMul<R, K, C, T>& expr) {
+        Matrix result;
+        detail::multiplyKernel<R, K, C, -1, true>(result.data_, expr.lhs().data(), expr.rhs().data(), data_);
+        return *this = result;
+    }
+    
+    constexpr Matrix operator+(const Matrix& other) const { return Matrix(*this) += other; }
+    constexpr Matrix operator-(const Matrix& other) const { return Matrix(*this) -= other; }
+    constexpr Matrix operator*(T scalar) const { return Matrix(*this) *= scalar; }
+    constexpr Matrix operator/(T scalar) const { return Matrix(*this) *= (T(1) / scalar); }
+    constexpr Matrix operator-() const { return Matrix(*this) *= T(-1); }
+    
+    /**
+     * @brief 転置
+     */
+    constexpr Matrix<C, R, T> transpose() const {
+        Matrix<C, R, T> m;
+        for (size_t i = 0; i < R; i++) {
+            for (size_t j = 0; j < C; j++) {
+                m(j, i) = data_[i * C + j];
+            }
+        }
+        return m;
+    }
+    
+    /**
+     * @brief 部分行列の取り出し
+     * @tparam BR 部分行列の行数
+     * @tparam BC 部分行列の列数
+     * @param row 開始行
+     * @param col 開始列
+     */
+    template<size_t BR, size_t BC>
+    constexpr Matrix<BR, BC, T> block(size_t row, size_t col) const {
+        static_assert(BR <= R && BC <= C, "部分行列が大きすぎます");
+        Matrix<BR, BC, T> m;
+        for (size_t i = 0; i < BR; i++) {
+            for (size_t j = 0; j < BC; j++) {
+                m(i, j) = data_[(row + i) * C + col + j];
+            }
+        }
+        return m;
+    }
+    
+    /**
+     * @brief 部分行列の書き込み
+     * @param row 開始行
+     * @param col 開始列
+     * @param value 部分行列
+     */
+    template<size_t BR, size_t BC>
+    constexpr void setBlock(size_t row, size_t col, const Matrix<BR, BC, T>& value) {
+        static_assert(BR <= R && BC <= C, "部分行列が大きすぎます");
+        for (size_t i = 0; i < BR; i++) {
+            for (size_t j = 0; j < BC; j++) {
+                data_[(row + i) * C + col + j] = value(i, j);
+            }
+        }
+    }
+    
+    /**
+     * @brief トレース（正方行列のみ）
+     */
+    constexpr T trace() const {
+        static_assert(R == C, "トレースは正方行列のみ");
+        T sum = T(0);
+        for (size_t i = 0; i < R; i++) {
+            sum += data_[i * C + i];
+        }
+        return sum;
+    }
+    
+    /**
+     * @brief 内積（ベクトルのみ）
+     */
+    constexpr T dot(const Matrix& other) const {
+        static_assert(C == 1, "内積は列ベクトルのみ");
+        T sum = T(0);
+        for (size_t i = 0; i < R; i++) {
+            sum += data_[i] * other.data_[i];
+        }
+        return sum;
+    }
+    
+    /**
+     * @brief 外積（3次元ベクトルのみ）
+     */
+    constexpr Matrix cross(const Matrix& other) const {
+        static_assert(R == 3 && C == 1, "外積は3次元列ベクトルのみ");
+        return Matrix(data_[1] * other.data_[2] - data_[2] * other.data_[1], 
+                      data_[2] * other.data_[0] - data_[0] * other.data_[2], 
+                      data_[0] * other.data_[1] - data_[1] * other.data_[0]);
+    }
+    
+    /**
+     * @brief 全要素の二乗和
+     */
+    constexpr T squaredNorm() const {
+        T sum = T(0);
+        for (size_t i = 0; i < SIZE; i++) {
+            sum += data_[i] * data_[i];
+        }
+        return sum;
+    }
+    
+    /**
+     * @brief フロベニウスノルム（ベクトルはユークリッドノルム）
+     */
+    T norm() const { return std::sqrt(squaredNorm()); }
+    
+    /**
+     * @brief 対称化（(A + A^T) / 2、共分散の数値誤差除去用）
+     */
+    constexpr void symmetrize() {
+        static_assert(R == C, "対称化は正方行列のみ");
+        for (size_t i = 0; i < R; i++) {
+            for (size_t j = i + 1; j < C; j++) {
+                T mean = (data_[i * C + j] + data_[j * C + i]) * T(0.5);
+                data_[i * C + j] = mean;
+                data_[j * C + i] = mean;
+            }
+        }
+    }
+    
+    /**
+     * @brief 逆行列（2x2・3x3のみ、余因子展開）
+     * @param inverse 逆行列の格納先
+     * @param epsilon 特異と判定する行列式の絶対値
+     * @return bool 特異行列の場合false（inverseは変更しない）
+     */
+    bool invert(Matrix& inverse, T epsilon = T(1e-12)) const {
+        static_assert(R == C && (R == 2 || R == 3), "逆行列は2x2・3x3のみ");
+        const T* m = data_;
+        if constexpr (R == 2) {
+            T det = m[0] * m[3] - m[1] * m[2];
+            if (std::fabs(det) <= epsilon) {
+                return false;
+            }
+            T inv = T(1) / det;
+            inverse = Matrix(m[3] * inv, -m[1] * inv, -m[2] * inv, m[0] * inv);
+        } else {
+            T c00 = m[4] * m[8] - m[5] * m[7];
+            T c01 = m[5] * m[6] - m[3] * m[8];
+            T c02 = m[3] * m[7] - m[4] * m[6];
+            T det = m[0] * c00 + m[1] * c01 + m[2] * c02;
+            if (std::fabs(det) <= epsilon) {
+                return false;
+            }
+            T inv = T(1) / det;
+            inverse = Matrix(c00 * inv, (m[2] * m[7] - m[1] * m[8]) * inv, (m[1] * m[5] - m[2] * m[4]) * inv, 
+                             c01 * inv, (m[0] * m[8] - m[2] * m[6]) * inv, (m[2] * m[3] - m[0] * m[5]) * inv, 
+                             c02 * inv, (m[1] * m[6] - m[0] * m[7]) * inv, (m[0] * m[4] - m[1] * m[3]) * inv);
+        }
+        return true;
+    }
+    
+    constexpr bool operator==(const Matrix& other) const {
+        for (size_t i = 0; i < SIZE; i++) {
+            if (data_[i] != other.data_[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    constexpr bool operator!=(const Matrix& other) const { return !(*this == other); }
+    
+private:
+    T data_[SIZE];      // 要素（行優先）
+};
+
+/**
+ * @brief 行列積の式クラス（A*B の評価を遅延する）
+ * 
+ * 両辺への参照だけを持つ。+ C / - C と組み合わせると1回のカーネル呼び出しで評価し、
+ * 積の一時行列を作らない。参照を保持するため auto で受けて式の外へ持ち出さないこと
+ */
+template<size_t R, size_t K, size_t C, typename T>
+class MatMul {
+public:
+    MatMul(const Matrix<R, K, T>& lhs, const Matrix<K, C, T>& rhs) : lhs_(lhs), rhs_(rhs) {}
+    
+    const Matrix<R, K, T>& lhs() const { return lhs_; }
+    const Matrix<K, C, T>& rhs() const { return rhs_; }
+    
+    /**
+     * @brief 評価
+     */
+    Matrix<R, C, T> eval() const { return Matrix<R, C, T>(*this); }
+    
+    /**
+     * @brief 配列へ評価（T[R*C]、両辺と重ならないこと）
+     */
+    void evaluateTo(T* out) const {
+        detail::multiplyKernel<R, K, C, 1, false>(out, lhs_.data(), rhs_.data(), static_cast<const T*>(nullptr));
+    }
+    
+private:
+    const Matrix<R, K, T>& lhs_;    // 左辺
+    const Matrix<K, C, T>& rhs_;    // 右辺
+};
+
+/**
+ * @brief 行列積（式を返す）
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline MatMul<R, K, C, T> operator*(const Matrix<R, K, T>& lhs, const Matrix<K, C, T>& rhs) {
+    return MatMul<R, K, C, T>(lhs, rhs);
+}
+
+/**
+ * @brief 積の連鎖（(A*B)*C、左側を先に評価）
+ */
+template<size_t R, size_t K, size_t M, size_t C, typename T>
+inline Matrix<R, C, T> operator*(const MatMul<R, K, M, T>& lhs, const Matrix<M, C, T>& rhs) {
+    Matrix<R, M, T> left(lhs);
+    return Matrix<R, C, T>(left * rhs);
+}
+
+/**
+ * @brief 積の連鎖（A*(B*C)、右側を先に評価）
+ */
+template<size_t R, size_t M, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> operator*(const Matrix<R, M, T>& lhs, const MatMul<M, K, C, T>& rhs) {
+    Matrix<M, C, T> right(rhs);
+    return Matrix<R, C, T>(lhs * right);
+}
+
+/**
+ * @brief A*B + C（1回のカーネルで評価）
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> operator+(const MatMul<R, K, C, T>& product, const Matrix<R, C, T>& addend) {
+    Matrix<R, C, T> result;
+    detail::multiplyKernel<R, K, C, 1, true>(result.data(), product.lhs().data(), product.rhs().data(), addend.data());
+    return result;
+}
+
+/**
+ * @brief C + A*B（1回のカーネルで評価）
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> operator+(const Matrix<R, C, T>& addend, const MatMul<R, K, C, T>& product) {
+    return product + addend;
+}
+
+/**
+ * @brief C - A*B（1回のカーネルで評価、I - K*H 等）
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> operator-(const Matrix<R, C, T>& minuend, const MatMul<R, K, C, T>& product) {
+    Matrix<R, C, T> result;
+    detail::multiplyKernel<R, K, C, -1, true>(result.data(), product.lhs().data(), product.rhs().data(), minuend.data());
+    return result;
+}
+
+/**
+ * @brief A*B - C
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> operator-(const MatMul<R, K, C, T>& product, const Matrix<R, C, T>& subtrahend) {
+    return product + (-subtrahend);
+}
+
+/**
+ * @brief スカラー倍（左側スカラー）
+ */
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> operator*(T scalar, const Matrix<R, C, T>& m) {
+    return m * scalar;
+}
+
+/**
+ * @brief A * B^T（転置行列を作らずに計算、P*F^T 等）
+ */
+template<size_t R, size_t K, size_t C, typename T>
+inline Matrix<R, C, T> multiplyTransposed(const Matrix<R, K, T>& a, const Matrix<C, K, T>& b) {
+    Matrix<R, C, T> result;
+    for (size_t i = 0; i < R; i++) {
+        for (size_t j = 0; j < C; j++) {
+            T sum = T(0);
+            for (size_t k = 0; k < K; k++) {
+                sum += a(i, k) * b(j, k);
+            }
+            result(i, j) = sum;
+        }
+    }
+    return result;
+}
+
+template<size_t N, typename T = float>
+using Vector = Matrix<N, 1, T>;
+
+using Matrix3f = Matrix<3, 3, float>;
+using Matrix4f = Matrix<4, 4, float>;
+using Vector3f = Vector<3, float>;
+using Vector4f = Vector<4, float>;
+
+} // namespace common
+
+#endif // MATRIX_HPP
@@ -0,0 +1,213 @@
+/*
+ * RPM Notch Bank
+ * 
+ * モーター回転数に追従する動的ノッチフィルタバンク（ヘッダーオンリー）
+ * 中心周波数は回転数推定（FFTピーク検出等）から設定し、
+ * 閾値を超えて変化したノッチだけ係数を再計算する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef NOTCH_BANK_HPP
+#define NOTCH_BANK_HPP
+
+#include "dsp_filters.hpp"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace common {
+
+/**
+ * @brief 回転数追従ノッチフィルタバンク
+ * 
+ * 周波数源（モーター等）×高調波の数だけノッチを持ち、ノッチ k の中心は 基本周波数 ×(k+1)。
+ * setFrequency()は別タスク（FFT解析等）から呼び出してよく、目標周波数を書くだけで係数は計算しない。
+ * update()とprocess()はフィルタを通すタスク（IMU処理）から呼び出す。
+ * update()は目標との差が閾値を超えたノッチのみ、1回あたりの上限数まで巡回順に再計算するため、
+ * 周波数が一斉に変わっても1回の処理時間は一定以下に収まる。
+ * 範囲外（最低周波数未満・ナイキスト付近）のノッチは処理を省き、再有効化時は状態を消してから使う
+ * @tparam SOURCES 周波数源の数
+ * @tparam HARMONICS 周波数源あたりの高調波数（1で基本波のみ）
+ * @tparam CHANNELS チャンネル数（ジャイロ3軸）
+ */
+template<size_t SOURCES, size_t HARMONICS = 1, size_t CHANNELS = 3>
+class RpmNotchBank {
+    static_assert(SOURCES > 0 && HARMONICS > 0 && CHANNELS > 0, "周波数源・高調波・チャンネル数は1以上");
+    
+public:
+    static constexpr size_t NOTCH_COUNT = SOURCES * HARMONICS;  // ノッチ数
+    
+    /**
+     * @brief バンク設定構造体
+     */
+    struct Config {
+        float sample_hz = 1000.0f;              // サンプリング周波数（Hz）
+        float q = 3.0f;                         // ノッチのQ値
+        float min_hz = 60.0f;                   // これ未満のノッチは無効（停止・アイドル中のモーター）
+        float max_ratio = 0.45f;                // サンプリング周波数に対する上限比（ナイキスト付近は無効）
+        float threshold_hz = 2.0f;              // 係数を再計算する中心周波数の変化量（Hz）
+        size_t max_updates_per_call = 2;        // update()1回あたりの再計算上限
+    };
+    
+    /**
+     * @brief コンストラクタ（全ノッチ無効）
+     */
+    RpmNotchBank() {
+        for (size_t n = 0; n < NOTCH_COUNT; n++) {
+            notches_[n].coefficients = BiquadCoefficients::passthrough();
+            notches_[n].center_hz = 0.0f;
+            notches_[n].active = false;
+        }
+        for (size_t s = 0; s < SOURCES; s++) {
+            targets_[s].store(0.0f, std::memory_order_relaxed);
+        }
+        memset(state_, 0, sizeof(state_));
+    }
+    
+    /**
+     * @brief 設定（次回のupdate()で全ノッチを再計算する）
+     * @param config バンク設定
+     */
+    void setConfig(const Config& config) {
+        config_ = config;
+        for (size_t n = 0; n < NOTCH_COUNT; n++) {
+            notches_[n].center_hz = -1.0f;
+        }
+    }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 基本周波数の設定（他タスクから呼び出し可、係数計算は行わない）
+     * @param source 周波数源番号
+     * @param fundamental_hz 基本周波数（Hz、0以下で無効）
+     */
+    void setFrequency(size_t source, float fundamental_hz) {
+        if (source < SOURCES) {
+            targets_[source].store(fundamental_hz, std::memory_order_relaxed);
+        }
+    }
+    
+    /**
+     * @brief 係数の増分更新
+     * @return size_t 再計算したノッチ数
+     */
+    size_t update() {
+        const float limit_hz = config_.sample_hz * config_.max_ratio;
+        size_t updated = 0;
+        
+        for (size_t i = 0; i < NOTCH_COUNT && updated < config_.max_updates_per_call; i++) {
+            size_t n = cursor_;
+            cursor_ = cursor_ + 1 < NOTCH_COUNT ? cursor_ + 1 : 0;
+            
+            Notch& notch = notches_[n];
+            float target = targets_[n / HARMONICS].load(std::memory_order_relaxed) * static_cast<float>(n % HARMONICS + 1);
+            bool in_range = target >= config_.min_hz && target < limit_hz;
+            
+            if (!in_range) {
+                if (notch.active) {
+                    notch.active = false;
+                    notch.center_hz = 0.0f;
+                    updated++;
+                }
+                continue;
+            }
+            if (notch.active && fabsf(target - notch.center_hz) <= config_.threshold_hz) {
+                continue;
+            }
+            
+            if (!notch.active) {
+                // 無効中の古い状態で過渡応答が出ないようにする
+                for (size_t ch = 0; ch < CHANNELS; ch++) {
+                    state_[ch][n][0] = 0.0f;
+                    state_[ch][n][1] = 0.0f;
+                }
+            }
+            notch.coefficients = BiquadCoefficients::notch(target, config_.sample_hz, config_.q);
+            notch.center_hz = target;
+            notch.active = true;
+            updated++;
+        }
+        
+        recompute_count_ += updated;
+        return updated;
+    }
+    
+    /**
+     * @brief ブロック処理（有効なノッチのみ順に適用）
+     * @param channel チャンネル番号
+     * @param input 入力（outputと同じでもよい）
+     * @param output 出力
+     * @param length サンプル数
+     */
+    void process(size_t channel, const float* input, float* output, size_t length) {
+        const float* source = input;
+        for (size_t n = 0; n < NOTCH_COUNT; n++) {
+            if (notches_[n].active) {
+                dsp::biquad(source, output, length, notches_[n].coefficients, state_[channel][n]);
+                source = output;
+            }
+        }
+        if (source != output) {
+            memmove(output, input, length * sizeof(float));
+        }
+    }
+    
+    /**
+     * @brief 全チャンネルの状態をクリア
+     */
+    void reset() { memset(state_, 0, sizeof(state_)); }
+    
+    /**
+     * @brief ノッチの中心周波数取得
+     * @param notch ノッチ番号（周波数源 × HARMONICS + 高調波番号）
+     * @return float 中心周波数（Hz、無効時は0）
+     */
+    float getCenter(size_t notch) const { return notches_[notch].active ? notches_[notch].center_hz : 0.0f; }
+    
+    /**
+     * @brief 有効なノッチ数取得
+     */
+    size_t getActiveCount() const {
+        size_t count = 0;
+        for (size_t n = 0; n < NOTCH_COUNT; n++) {
+            count += notches_[n].active ? 1 : 0;
+        }
+        return count;
+    }
+    
+    /**
+     * @brief 累計の再計算回数取得（閾値調整用）
+     */
+    uint32_t getRecomputeCount() const { return recompute_count_; }
+    
+private:
+    /**
+     * @brief ノッチ
+     */
+    struct Notch {
+        BiquadCoefficients coefficients;    // 係数
+        float center_hz;                    // 係数計算時の中心周波数
+        bool active;                        // 有効
+    };
+    
+    Config config_;                                 // 設定
+    Notch notches_[NOTCH_COUNT];                    // ノッチ
+    std::atomic<float> targets_[SOURCES];           // 目標基本周波数（他タスクから書き込み）
+    float state_[CHANNELS][NOTCH_COUNT][2];         // チャンネル×ノッチの状態
+    size_t cursor_ = 0;                             // 次に確認するノッチ
+    uint32_t recompute_count_ = 0;                  // 累計再計算回数
+};
+
+} // namespace common
+
+#endif // NOTCH_BANK_HPP
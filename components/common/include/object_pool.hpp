@@ -0,0 +1,190 @@
+/*
+ * Object Pool
+ * 
+ * 固定長ブロックのオブジェクトプール（ヘッダーオンリー）
+ * タスク間で受け渡すメッセージをヒープを使わずに確保・返却する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace common {
+
+/**
+ * @brief 固定長ブロックのオブジェクトプール
+ * 
+ * 静的領域に N 個分のブロックを持ち、空きブロックは版数付きのロックフリーなスタックで管理する。
+ * 確保・返却はCASのみで、タスク・ISR・別コアのどこからでも呼び出せる（待ちなし）。
+ * 確保したポインタはFreeRTOSキュー等でそのまま別タスクへ渡し、受け取った側が返却する。
+ * 枯渇時は確保失敗（nullptr）を返し、回数を統計に残す
+ * @tparam T 要素の型
+ * @tparam N ブロック数（65535以下）
+ */
+template<typename T, size_t N>
+class ObjectPool {
+    static_assert(N > 0 && N < 0xFFFF, "ブロック数は1以上65535未満");
+    
+public:
+    /**
+     * @brief 統計構造体
+     */
+    struct Stats {
+        uint32_t in_use;            // 使用中のブロック数
+        uint32_t high_water;        // 使用中ブロック数の最大
+        uint32_t acquired;          // 確保回数
+        uint32_t exhausted;         // 枯渇で確保できなかった回数
+    };
+    
+    /**
+     * @brief Ptrの返却関数
+     */
+    struct Deleter {
+        ObjectPool* pool;
+        void operator()(T* object) const { pool->release(object); }
+    };
+    
+    using Ptr = std::unique_ptr<T, Deleter>;    // スコープを抜けると返却するポインタ
+    
+    static constexpr size_t CAPACITY = N;       // ブロック数
+    
+public:
+    ObjectPool()
+        : stats_{} {
+        for (size_t i = 0; i < N; i++) {
+            next_[i].store(static_cast<uint16_t>(i + 1 < N ? i + 1 : NIL), std::memory_order_relaxed);
+        }
+        head_.store(0, std::memory_order_release);
+    }
+    
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+    
+    /**
+     * @brief 確保（コンストラクタを呼ぶ）
+     * @param args コンストラクタ引数
+     * @return T* 枯渇時はnullptr
+     */
+    template<typename... Args>
+    T* acquire(Args&&... args) {
+        uint32_t head = head_.load(std::memory_order_acquire);
+        uint16_t index;
+        do {
+            index = static_cast<uint16_t>(head & 0xFFFF);
+            if (index == NIL) {
+                stats_.exhausted.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            uint32_t next = next_[index].load(std::memory_order_relaxed);
+            // 版数を進めてABA（取り出し・返却の間に同じ先頭へ戻る）を防ぐ
+            uint32_t replaced = (((head >> 16) + 1) << 16) | next;
+            if (head_.compare_exchange_weak(head, replaced, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                break;
+            }
+        } while (true);
+        
+        uint32_t in_use = stats_.in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+        uint32_t high_water = stats_.high_water.load(std::memory_order_relaxed);
+        while (in_use > high_water
+               && !stats_.high_water.compare_exchange_weak(high_water, in_use, std::memory_order_relaxed)) {
+        }
+        stats_.acquired.fetch_add(1, std::memory_order_relaxed);
+        return new (&blocks_[index].storage) T(std::forward<Args>(args)...);
+    }
+    
+    /**
+     * @brief 確保（スコープを抜けると返却）
+     * @param args コンストラクタ引数
+     * @return Ptr 枯渇時は空
+     */
+    template<typename... Args>
+    Ptr make(Args&&... args) {
+        return Ptr(acquire(std::forward<Args>(args)...), Deleter{this});
+    }
+    
+    /**
+     * @brief 返却（デストラクタを呼ぶ）
+     * @param object acquire()で確保したポインタ（nullptrは無視）
+     */
+    void release(T* object) {
+        if (object == nullptr) {
+            return;
+        }
+        uint16_t index = indexOf(object);
+        object->~T();
+        
+        uint32_t head = head_.load(std::memory_order_relaxed);
+        do {
+            next_[index].store(static_cast<uint16_t>(head & 0xFFFF), std::memory_order_relaxed);
+        } while (!head_.compare_exchange_weak(head, (((head >> 16) + 1) << 16) | index, 
+                                              std::memory_order_release, std::memory_order_relaxed));
+        stats_.in_use.fetch_sub(1, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief プールのブロックか
+     */
+    bool owns(const T* object) const {
+        const uint8_t* address = reinterpret_cast<const uint8_t*>(object);
+        const uint8_t* first = reinterpret_cast<const uint8_t*>(&blocks_[0]);
+        return address >= first && address < first + sizeof(blocks_)
+               && (address - first) % sizeof(Block) == 0;
+    }
+    
+    /**
+     * @brief 空きブロック数
+     */
+    size_t available() const { return N - stats_.in_use.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const {
+        Stats stats;
+        stats.in_use = stats_.in_use.load(std::memory_order_relaxed);
+        stats.high_water = stats_.high_water.load(std::memory_order_relaxed);
+        stats.acquired = stats_.acquired.load(std::memory_order_relaxed);
+        stats.exhausted = stats_.exhausted.load(std::memory_order_relaxed);
+        return stats;
+    }
+    
+private:
+    static constexpr uint16_t NIL = 0xFFFF;     // 空きなし
+    
+    struct Block {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    
+    struct AtomicStats {
+        std::atomic<uint32_t> in_use;
+        std::atomic<uint32_t> high_water;
+        std::atomic<uint32_t> acquired;
+        std::atomic<uint32_t> exhausted;
+    };
+    
+    Block blocks_[N];                           // ブロック領域
+    std::atomic<uint16_t> next_[N];             // 空きスタックの次のブロック
+    std::atomic<uint32_t> head_;                // 上位16bit: 版数、下位16bit: 先頭ブロック
+    AtomicStats stats_;                         // 統計
+    
+    uint16_t indexOf(const T* object) const {
+        const uint8_t* address = reinterpret_cast<const uint8_t*>(object);
+        const uint8_t* first = reinterpret_cast<const uint8_t*>(&blocks_[0]);
+        return static_cast<uint16_t>((address - first) / sizeof(Block));
+    }
+};
+
+} // namespace common
+
+#endif // OBJECT_POOL_HPP
@@ -0,0 +1,454 @@
+/*
+ * Online Statistics
+ * 
+ * 逐次統計量（ヘッダーオンリー）
+ * サンプルを保持せずO(1)のメモリで平均・分散・最小最大・ヒストグラム・分位点を更新する
+ * （キャリブレーション・振動指標・遅延分布・ADC平均用）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ONLINE_STATS_HPP
+#define ONLINE_STATS_HPP
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace common {
+
+/**
+ * @brief 最小値・最大値
+ * @tparam T 値の型（算術型）
+ */
+template<typename T>
+class MinMax {
+    static_assert(std::is_arithmetic<T>::value, "値の型は算術型");
+    
+public:
+    MinMax() { reset(); }
+    
+    void reset() {
+        count_ = 0;
+        min_ = std::numeric_limits<T>::max();
+        max_ = std::numeric_limits<T>::lowest();
+    }
+    
+    void add(T value) {
+        if (value < min_) {
+            min_ = value;
+        }
+        if (value > max_) {
+            max_ = value;
+        }
+        count_++;
+    }
+    
+    void merge(const MinMax& other) {
+        if (other.min_ < min_) {
+            min_ = other.min_;
+        }
+        if (other.max_ > max_) {
+            max_ = other.max_;
+        }
+        count_ += other.count_;
+    }
+    
+    uint32_t count() const { return count_; }
+    
+    /**
+     * @brief 最小値（サンプルなしは0）
+     */
+    T min() const { return count_ > 0 ? min_ : T(0); }
+    
+    /**
+     * @brief 最大値（サンプルなしは0）
+     */
+    T max() const { return count_ > 0 ? max_ : T(0); }
+    
+    /**
+     * @brief 最大値 - 最小値
+     */
+    T range() const { return count_ > 0 ? static_cast<T>(max_ - min_) : T(0); }
+    
+private:
+    uint32_t count_;
+    T min_;
+    T max_;
+};
+
+/**
+ * @brief 平均・分散（Welford法）
+ * 
+ * 二乗和から分散を求める方法と異なり、平均が大きくばらつきが小さい量（静止中の加速度9.8m/s²の雑音等）でも
+ * 桁落ちしない。merge()は別々に集計した結果を合わせる（Chanの並列アルゴリズム）
+ * @tparam T 計算の型（浮動小数点型）
+ */
+template<typename T = float>
+class RunningStats {
+    static_assert(std::is_floating_point<T>::value, "計算の型は浮動小数点型");
+    
+public:
+    RunningStats() { reset(); }
+    
+    void reset() {
+        count_ = 0;
+        mean_ = T(0);
+        m2_ = T(0);
+        range_.reset();
+    }
+    
+    /**
+     * @brief サンプル追加
+     */
+    void add(T value) {
+        count_++;
+        const T delta = value - mean_;
+        mean_ += delta / static_cast<T>(count_);
+        m2_ += delta * (value - mean_);
+        range_.add(value);
+    }
+    
+    /**
+     * @brief 別の集計結果を合わせる
+     */
+    void merge(const RunningStats& other) {
+        if (other.count_ == 0) {
+            return;
+        }
+        if (count_ == 0) {
+            *this = other;
+            return;
+        }
+        const T n_a = static_cast<T>(count_);
+        const T n_b = static_cast<T>(other.count_);
+        const T n = n_a + n_b;
+        const T delta = other.mean_ - mean_;
+        mean_ += delta * n_b / n;
+        m2_ += other.m2_ + delta * delta * n_a * n_b / n;
+        count_ += other.count_;
+        range_.merge(other.range_);
+    }
+    
+    uint32_t count() const { return count_; }
+    T mean() const { return mean_; }
+    
+    /**
+     * @brief 標本分散（n - 1 で割る、2サンプル未満は0）
+     */
+    T variance() const { return count_ > 1 ? m2_ / static_cast<T>(count_ - 1) : T(0); }
+    
+    /**
+     * @brief 母分散（n で割る）
+     */
+    T populationVariance() const { return count_ > 0 ? m2_ / static_cast<T>(count_) : T(0); }
+    
+    T stddev() const { return std::sqrt(variance()); }
+    T min() const { return range_.min(); }
+    T max() const { return range_.max(); }
+    
+private:
+    uint32_t count_;        // サンプル数
+    T mean_;                // 平均
+    T m2_;                  // 平均からの偏差の二乗和
+    MinMax<T> range_;       // 最小・最大
+};
+
+/**
+ * @brief 指数重み付き平均・分散
+ * 
+ * 重み alpha で新しいサンプルを重視する（時定数 ≒ サンプル周期 / alpha）。
+ * 飛行中の振動の大きさ等、直近の窓の統計をバッファなしで追う。最初のサンプルで平均を初期化する
+ * @tparam T 計算の型（浮動小数点型）
+ */
+template<typename T = float>
+class EwmaStats {
+    static_assert(std::is_floating_point<T>::value, "計算の型は浮動小数点型");
+    
+public:
+    /**
+     * @param alpha 新しいサンプルの重み（0 < alpha ≤ 1）
+     */
+    explicit EwmaStats(T alpha = T(0.01))
+        : alpha_(alpha) { reset(); }
+    
+    /**
+     * @brief 時定数から重みを設定
+     * @param time_constant 時定数（秒）
+     * @param dt サンプル周期（秒）
+     */
+    void setTimeConstant(T time_constant, T dt) {
+        alpha_ = time_constant > T(0) ? T(1) - std::exp(-dt / time_constant) : T(1);
+    }
+    
+    void setAlpha(T alpha) { alpha_ = alpha; }
+    
+    void reset() {
+        initialized_ = false;
+        mean_ = T(0);
+        variance_ = T(0);
+    }
+    
+    /**
+     * @brief サンプル追加
+     */
+    void add(T value) {
+        if (!initialized_) {
+            mean_ = value;
+            variance_ = T(0);
+            initialized_ = true;
+            return;
+        }
+        const T delta = value - mean_;
+        const T increment = alpha_ * delta;
+        mean_ += increment;
+        variance_ = (T(1) - alpha_) * (variance_ + delta * increment);
+    }
+    
+    bool initialized() const { return initialized_; }
+    T alpha() const { return alpha_; }
+    T mean() const { return mean_; }
+    T variance() const { return variance_; }
+    T stddev() const { return std::sqrt(variance_); }
+    
+private:
+    T alpha_;               // 新しいサンプルの重み
+    bool initialized_;      // 最初のサンプルを受けた
+    T mean_;                // 平均
+    T variance_;            // 分散
+};
+
+/**
+ * @brief 等幅ヒストグラム
+ * 
+ * [lower, upper) を N 個の等幅ビンに分け、範囲外は下側・上側の溢れとして数える。
+ * quantile() はビン内を一様分布とみなした線形補間の推定値
+ * @tparam N ビン数
+ * @tparam T 値の型（浮動小数点型）
+ */
+template<size_t N, typename T = float>
+class Histogram {
+    static_assert(N >= 1, "ビン数は1以上");
+    static_assert(std::is_floating_point<T>::value, "値の型は浮動小数点型");
+    
+public:
+    /**
+     * @param lower 範囲の下限
+     * @param upper 範囲の上限（lower より大きいこと）
+     */
+    Histogram(T lower, T upper)
+        : lower_(lower)
+        , upper_(upper)
+        , scale_(static_cast<T>(N) / (upper - lower)) { reset(); }
+    
+    void reset() {
+        for (size_t i = 0; i < N; i++) {
+            bins_[i] = 0;
+        }
+        underflow_ = 0;
+        overflow_ = 0;
+        count_ = 0;
+    }
+    
+    /**
+     * @brief サンプル追加
+     */
+    void add(T value) {
+        count_++;
+        if (!(value >= lower_)) {
+            underflow_++;   // NaNも下側に数える
+            return;
+        }
+        const T position = (value - lower_) * scale_;
+        if (position >= static_cast<T>(N)) {
+            overflow_++;
+            return;
+        }
+        bins_[static_cast<size_t>(position)]++;
+    }
+    
+    /**
+     * @brief 分位点の推定
+     * @param q 分位（0〜1）
+     * @return T 推定値（溢れに入る分位は範囲の端を返す）
+     */
+    T quantile(T q) const {
+        if (count_ == 0) {
+            return lower_;
+        }
+        const T target = q * static_cast<T>(count_);
+        T cumulative = static_cast<T>(underflow_);
+        if (target <= cumulative) {
+            return lower_;
+        }
+        const T width = (upper_ - lower_) / static_cast<T>(N);
+        for (size_t i = 0; i < N; i++) {
+            const T next = cumulative + static_cast<T>(bins_[i]);
+            if (target <= next && bins_[i] > 0) {
+                return lower_ + width * (static_cast<T>(i) + (target - cumulative) / static_cast<T>(bins_[i]));
+            }
+            cumulative = next;
+        }
+        return upper_;
+    }
+    
+    static constexpr size_t binCount() { return N; }
+    uint32_t bin(size_t index) const { return bins_[index]; }
+    
+    /**
+     * @brief ビンの下端
+     */
+    T binLower(size_t index) const { return lower_ + (upper_ - lower_) * static_cast<T>(index) / static_cast<T>(N); }
+    
+    uint32_t underflow() const { return underflow_; }
+    uint32_t overflow() const { return overflow_; }
+    uint32_t count() const { return count_; }
+    
+private:
+    T lower_;               // 範囲の下限
+    T upper_;               // 範囲の上限
+    T scale_;               // ビン数 / 範囲の幅
+    uint32_t bins_[N];      // 度数
+    uint32_t underflow_;    // lower 未満の数
+    uint32_t overflow_;     // upper 以上の数
+    uint32_t count_;        // 総サンプル数
+};
+
+/**
+ * @brief 分位点の逐次推定（P²アルゴリズム、Jain & Chlamtac）
+ * 
+ * 5つのマーカー（最小・p/2・p・(1+p)/2・最大）の高さを放物線補間で更新し、
+ * ヒストグラムの範囲を決めずに1つの分位点（p99の遅延等）を推定する。5サンプル未満は並べ替えた値から返す
+ * @tparam T 値の型（浮動小数点型）
+ */
+template<typename T = float>
+class P2Quantile {
+    static_assert(std::is_floating_point<T>::value, "値の型は浮動小数点型");
+    
+public:
+    /**
+     * @param p 推定する分位（0 < p < 1）
+     */
+    explicit P2Quantile(T p = T(0.5))
+        : p_(p) { reset(); }
+    
+    void reset() {
+        count_ = 0;
+        for (int i = 0; i < 5; i++) {
+            height_[i] = T(0);
+            position_[i] = static_cast<T>(i + 1);
+        }
+        desired_[0] = T(1);
+        desired_[1] = T(1) + T(2) * p_;
+        desired_[2] = T(1) + T(4) * p_;
+        desired_[3] = T(3) + T(2) * p_;
+        desired_[4] = T(5);
+        increment_[0] = T(0);
+        increment_[1] = p_ / T(2);
+        increment_[2] = p_;
+        increment_[3] = (T(1) + p_) / T(2);
+        increment_[4] = T(1);
+    }
+    
+    /**
+     * @brief サンプル追加
+     */
+    void add(T value) {
+        if (count_ < 5) {
+            // 最初の5サンプルは挿入ソートで並べる
+            int i = static_cast<int>(count_);
+            while (i > 0 && height_[i - 1] > value) {
+                height_[i] = height_[i - 1];
+                i--;
+            }
+            height_[i] = value;
+            count_++;
+            return;
+        }
+        
+        int cell;
+        if (value < height_[0]) {
+            height_[0] = value;
+            cell = 0;
+        } else if (value >= height_[4]) {
+            if (value > height_[4]) {
+                height_[4] = value;
+            }
+            cell = 3;
+        } else {
+            cell = 0;
+            while (cell < 3 && value >= height_[cell + 1]) {
+                cell++;
+            }
+        }
+        for (int i = cell + 1; i < 5; i++) {
+            position_[i] += T(1);
+        }
+        for (int i = 0; i < 5; i++) {
+            desired_[i] += increment_[i];
+        }
+        
+        for (int i = 1; i < 4; i++) {
+            const T d = desired_[i] - position_[i];
+            if ((d >= T(1) && position_[i + 1] - position_[i] > T(1)) ||
+                (d <= T(-1) && position_[i - 1] - position_[i] < T(-1))) {
+                const T sign = d >= T(0) ? T(1) : T(-1);
+                T height = parabolic(i, sign);
+                if (!(height_[i - 1] < height && height < height_[i + 1])) {
+                    height = linear(i, sign);
+                }
+                height_[i] = height;
+                position_[i] += sign;
+            }
+        }
+        count_++;
+    }
+    
+    /**
+     * @brief 分位点の推定値（サンプルなしは0）
+     */
+    T value() const {
+        if (count_ >= 5) {
+            return height_[2];
+        }
+        if (count_ == 0) {
+            return T(0);
+        }
+        const size_t index = static_cast<size_t>(p_ * static_cast<T>(count_ - 1) + T(0.5));
+        return height_[index];
+    }
+    
+    T probability() const { return p_; }
+    uint32_t count() const { return count_; }
+    
+private:
+    T parabolic(int i, T sign) const {
+        const T n_prev = position_[i - 1];
+        const T n = position_[i];
+        const T n_next = position_[i + 1];
+        return height_[i] + sign / (n_next - n_prev) *
+            ((n - n_prev + sign) * (height_[i + 1] - height_[i]) / (n_next - n) +
+             (n_next - n - sign) * (height_[i] - height_[i - 1]) / (n - n_prev));
+    }
+    
+    T linear(int i, T sign) const {
+        const int j = i + static_cast<int>(sign);
+        return height_[i] + sign * (height_[j] - height_[i]) / (position_[j] - position_[i]);
+    }
+    
+    T p_;                   // 推定する分位
+    uint32_t count_;        // サンプル数
+    T height_[5];           // マーカーの高さ
+    T position_[5];         // マーカーの位置（1始まり）
+    T desired_[5];          // マーカーの目標位置
+    T increment_[5];        // サンプル毎の目標位置の増分
+};
+
+} // namespace common
+
+#endif // ONLINE_STATS_HPP
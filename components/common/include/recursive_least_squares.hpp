@@ -0,0 +1,146 @@
+/*
+ * Recursive Least Squares
+ * 
+ * 忘却係数付きの逐次最小二乗法（ヘッダーオンリー）
+ * 1サンプル毎に回帰係数と共分散を更新し、過去のデータを保持しない。
+ * 共分散は SymmetricMatrix の上三角パック形式で持ち、更新は上三角のみ計算する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef RECURSIVE_LEAST_SQUARES_HPP
+#define RECURSIVE_LEAST_SQUARES_HPP
+
+#include "symmetric_matrix.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief 逐次最小二乗推定器テンプレート（y = θ^T φ + e）
+ * 
+ * 忘却係数 λ（1以下）で古いサンプルの重みを指数的に下げる。励起が弱い間も P / λ で
+ * 共分散が膨らみ続ける（ワインドアップ）のを防ぐため、トレースが上限を超えたら忘却を止める。
+ * 1回の更新の演算は N^2 + 3N(N+1)/2 + 3N 回程度で、入力の値によらず一定
+ * @tparam N 回帰係数の数
+ * @tparam T 要素型
+ */
+template<size_t N, typename T = float>
+class RecursiveLeastSquares {
+    static_assert(N > 0, "回帰係数の数は1以上");
+    
+public:
+    static constexpr T DEFAULT_COVARIANCE = T(1000);    // 初期共分散（対角）
+    static constexpr T MIN_COVARIANCE = T(1e-9);        // 共分散の対角の下限（正定値性の維持）
+    
+    RecursiveLeastSquares() : theta_{}, covariance_(), max_trace_(DEFAULT_COVARIANCE * T(N)), updates_(0) {
+        reset();
+    }
+    
+    /**
+     * @brief 初期化（係数を0、共分散を対角に戻す）
+     * @param initial_covariance 初期共分散（対角、大きいほど初期の収束が速い）
+     */
+    void reset(T initial_covariance = DEFAULT_COVARIANCE) {
+        T diagonal[N];
+        for (size_t i = 0; i < N; i++) {
+            theta_[i] = T(0);
+            diagonal[i] = initial_covariance;
+        }
+        covariance_.setDiagonal(diagonal);
+        max_trace_ = initial_covariance * T(N);
+        updates_ = 0;
+    }
+    
+    /**
+     * @brief 共分散のトレースの上限（これを超えている間は忘却しない）
+     */
+    void setMaxTrace(T max_trace) { max_trace_ = max_trace; }
+    
+    /**
+     * @brief 1サンプルの更新
+     * @param phi 回帰ベクトル（N要素）
+     * @param y 観測値
+     * @param forgetting 忘却係数（0より大きく1以下、1で通常の最小二乗）
+     * @return T 更新前の係数による予測誤差（y - θ^T φ）
+     */
+    T update(const T* phi, T y, T forgetting = T(1)) {
+        T p_phi[N];
+        T quadratic = T(0);
+        T prediction = T(0);
+        for (size_t i = 0; i < N; i++) {
+            T sum = T(0);
+            for (size_t j = 0; j < N; j++) {
+                sum += covariance_(i, j) * phi[j];
+            }
+            p_phi[i] = sum;
+            quadratic += phi[i] * sum;
+            prediction += theta_[i] * phi[i];
+        }
+        const T error = y - prediction;
+        const T inv_denominator = T(1) / (forgetting + quadratic);
+        for (size_t i = 0; i < N; i++) {
+            theta_[i] += p_phi[i] * inv_denominator * error;
+        }
+        
+        // P = (P - Pφ φ^T P / (λ + φ^T P φ)) / λ
+        covariance_.rankOneUpdate(p_phi, -inv_denominator);
+        T trace = T(0);
+        for (size_t i = 0; i < N; i++) {
+            trace += covariance_.diagonal(i);
+        }
+        if (forgetting < T(1) && trace < max_trace_) {
+            const T scale = T(1) / forgetting;
+            T* p = covariance_.data();
+            for (size_t i = 0; i < SymmetricMatrix<N, T>::PACKED_SIZE; i++) {
+                p[i] *= scale;
+            }
+        }
+        covariance_.clampDiagonal(MIN_COVARIANCE);
+        updates_++;
+        return error;
+    }
+    
+    /**
+     * @brief 係数による予測（θ^T φ）
+     * @param phi 回帰ベクトル（N要素）
+     */
+    T predict(const T* phi) const {
+        T sum = T(0);
+        for (size_t i = 0; i < N; i++) {
+            sum += theta_[i] * phi[i];
+        }
+        return sum;
+    }
+    
+    /**
+     * @brief 回帰係数
+     * @param index 番号
+     */
+    T parameter(size_t index) const { return theta_[index]; }
+    const T* parameters() const { return theta_; }
+    
+    /**
+     * @brief 共分散（係数の不確かさ）
+     */
+    const SymmetricMatrix<N, T>& covariance() const { return covariance_; }
+    
+    /**
+     * @brief 更新回数
+     */
+    uint32_t updates() const { return updates_; }
+    
+private:
+    T theta_[N];                        // 回帰係数
+    SymmetricMatrix<N, T> covariance_;  // 共分散
+    T max_trace_;                       // 忘却を止める共分散のトレース
+    uint32_t updates_;                  // 更新回数
+};
+
+} // namespace common
+
+#endif // RECURSIVE_LEAST_SQUARES_HPP
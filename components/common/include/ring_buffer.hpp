@@ -0,0 +1,155 @@
+/*
+ * Ring Buffer
+ * 
+ * ロックフリー単一生産者/単一消費者リングバッファ（ヘッダーオンリー）
+ * FreeRTOSキューと異なりカーネル呼び出しなしでコア間の受け渡しができる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef RING_BUFFER_HPP
+#define RING_BUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace common {
+
+/**
+ * @brief キャッシュライン長（ESP32-S3のデータキャッシュライン長）
+ * 
+ * 生産者と消費者が別コアで更新するインデックスを別ラインに置き、偽共有を避ける
+ */
+static constexpr size_t CACHE_LINE_SIZE = 32;
+
+/**
+ * @brief 単一生産者/単一消費者リングバッファ
+ * 
+ * push()は1つのタスク（またはISR）から、pop()は1つのタスクからのみ呼び出すこと。
+ * インデックスは単調増加させ、容量の剰余で位置を求める（満杯と空を区別するための空きスロット不要）
+ * @tparam T 要素型（トリビアルコピー可能であること）
+ * @tparam N 容量（2のべき乗）
+ */
+template<typename T, size_t N>
+class RingBuffer {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "容量は2のべき乗");
+    static_assert(std::is_trivially_copyable<T>::value, "要素型はトリビアルコピー可能であること");
+    
+public:
+    RingBuffer()
+        : head_(0)
+        , dropped_(0)
+        , tail_(0) {}
+    
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    
+    /**
+     * @brief 要素追加（生産者側）
+     * @param value 要素
+     * @return bool 満杯で追加できなかった場合false
+     */
+    bool push(const T& value) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= N) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer_[head & MASK] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief 要素取り出し（消費者側）
+     * @param value 格納先
+     * @return bool 空の場合false
+     */
+    bool pop(T& value) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = buffer_[tail & MASK];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    
+    /**
+     * @brief 先頭要素参照（消費者側、取り出さない）
+     * @return const T* 先頭要素（空の場合nullptr）
+     */
+    const T* peek() const {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &buffer_[tail & MASK];
+    }
+    
+    /**
+     * @brief 先頭要素破棄（消費者側、peek()と組み合わせて使用）
+     */
+    void discard() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail != head_.load(std::memory_order_acquire)) {
+            tail_.store(tail + 1, std::memory_order_release);
+        }
+    }
+    
+    /**
+     * @brief 全要素破棄（消費者側）
+     */
+    void clear() {
+        tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    
+    /**
+     * @brief 格納要素数（呼び出し時点の概数）
+     * @return size_t 要素数
+     */
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief 空判定
+     * @return bool 空の場合true
+     */
+    bool empty() const { return size() == 0; }
+    
+    /**
+     * @brief 満杯判定
+     * @return bool 満杯の場合true
+     */
+    bool full() const { return size() >= N; }
+    
+    /**
+     * @brief 容量取得
+     * @return size_t 容量
+     */
+    static constexpr size_t capacity() { return N; }
+    
+    /**
+     * @brief 満杯による破棄数
+     * @return uint32_t 破棄数
+     */
+    uint32_t getDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+    
+private:
+    static constexpr size_t MASK = N - 1;
+    
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_;     // 書き込み位置（生産者のみ更新）
+    std::atomic<uint32_t> dropped_;                         // 満杯による破棄数（生産者のみ更新）
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_;     // 読み出し位置（消費者のみ更新）
+    alignas(CACHE_LINE_SIZE) T buffer_[N];                  // 要素バッファ
+};
+
+} // namespace common
+
+#endif // RING_BUFFER_HPP
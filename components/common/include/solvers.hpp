@@ -0,0 +1,643 @@
+/*
+ * Solvers
+ * 
+ * 実時間用の数値解法（ヘッダーオンリー）
+ * 小さな対称正定値系のCholesky・LDL^T分解、一般の正方系のLU分解、反復回数固定のNewton法・
+ * Gauss-Newton法、箱型制約付き二次計画の射影勾配法をまとめる。
+ * 次元と反復回数はテンプレート引数で、最悪の演算回数はコンパイル時の定数（*_OPS）で分かる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SOLVERS_HPP
+#define SOLVERS_HPP
+
+#include "matrix.hpp"
+#include "symmetric_matrix.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief Cholesky分解（A = L L^T、対称正定値行列）
+ * 
+ * 下三角（i >= j の要素）だけを参照する。対角の逆数を保持し、代入では除算しない。
+ * 演算回数は入力の値によらず一定（*_OPSは乗算・乗加算の回数、平方根・除算は各N回）
+ * @tparam N 次元
+ * @tparam T 要素型
+ */
+template<size_t N, typename T = float>
+class Cholesky {
+public:
+    static constexpr size_t FACTOR_OPS = N * (N - 1) * (N + 1) / 6 + N * (N - 1) / 2;  // 分解
+    static constexpr size_t SOLVE_OPS = N * (N + 1);                                   // 右辺1列の代入
+    
+    Cholesky() : l_(), inv_diag_{}, valid_(false) {}
+    
+    /**
+     * @brief 分解
+     * @param a 対称正定値行列
+     * @param epsilon 正定値と判定するピボットの下限
+     * @return bool ピボットがepsilon以下（正定値でない・NaN）の場合false
+     */
+    bool factor(const Matrix<N, N, T>& a, T epsilon = T(1e-9)) { return factorFrom(a, epsilon); }
+    bool factor(const SymmetricMatrix<N, T>& a, T epsilon = T(1e-9)) { return factorFrom(a, epsilon); }
+    
+    /**
+     * @brief 分解済みか（直前のfactor()が成功した）
+     */
+    bool isValid() const { return valid_; }
+    
+    /**
+     * @brief A X = B を解く（分解済みであること）
+     * @param b 右辺（C列）
+     */
+    template<size_t C>
+    Matrix<N, C, T> solve(const Matrix<N, C, T>& b) const {
+        Matrix<N, C, T> x = b;
+        for (size_t c = 0; c < C; c++) {
+            // L y = b
+            for (size_t i = 0; i < N; i++) {
+                T sum = x(i, c);
+                for (size_t k = 0; k < i; k++) {
+                    sum -= l_(i, k) * x(k, c);
+                }
+                x(i, c) = sum * inv_diag_[i];
+            }
+            // L^T x = y
+            for (size_t i = N; i-- > 0;) {
+                T sum = x(i, c);
+                for (size_t k = i + 1; k < N; k++) {
+                    sum -= l_(k, i) * x(k, c);
+                }
+                x(i, c) = sum * inv_diag_[i];
+            }
+        }
+        return x;
+    }
+    
+    /**
+     * @brief 下三角因子 L
+     */
+    const Matrix<N, N, T>& lower() const { return l_; }
+    
+    /**
+     * @brief log det(A)（尤度の計算用）
+     */
+    T logDeterminant() const {
+        T sum = T(0);
+        for (size_t i = 0; i < N; i++) {
+            sum -= std::log(inv_diag_[i]);
+        }
+        return sum * T(2);
+    }
+    
+private:
+    Matrix<N, N, T> l_;     // 下三角因子（上三角は0）
+    T inv_diag_[N];         // 対角の逆数
+    bool valid_;            // 分解済み
+    
+    template<typename M>
+    bool factorFrom(const M& a, T epsilon) {
+        valid_ = false;
+        for (size_t j = 0; j < N; j++) {
+            T diag = a(j, j);
+            for (size_t k = 0; k < j; k++) {
+                diag -= l_(j, k) * l_(j, k);
+            }
+            // NaNもここで弾く
+            if (!(diag > epsilon)) {
+                return false;
+            }
+            const T root = std::sqrt(diag);
+            l_(j, j) = root;
+            inv_diag_[j] = T(1) / root;
+            for (size_t i = j + 1; i < N; i++) {
+                T sum = a(i, j);
+                for (size_t k = 0; k < j; k++) {
+                    sum -= l_(i, k) * l_(j, k);
+                }
+                l_(i, j) = sum * inv_diag_[j];
+            }
+        }
+        valid_ = true;
+        return true;
+    }
+};
+
+/**
+ * @brief LDL^T分解（A = L D L^T、Lは単位下三角、平方根なし）
+ * 
+ * 下三角だけを参照する。factorRegularized() は小さい・負のピボットを下限に置き換えて必ず分解を終える
+ * （修正Cholesky、Newton法のヘッセ行列が正定値でない場合でも降下方向が得られる）
+ * @tparam N 次元
+ * @tparam T 要素型
+ */
+template<size_t N, typename T = float>
+class Ldlt {
+public:
+    static constexpr size_t FACTOR_OPS = N * (N - 1) * (N + 1) / 6 + N * (N - 1);     // 分解
+    static constexpr size_t SOLVE_OPS = N * N;                                         // 右辺1列の代入
+    
+    Ldlt() : l_(Matrix<N, N, T>::identity()), d_{}, inv_d_{}, valid_(false) {}
+    
+    /**
+     * @brief 分解
+     * @param a 対称行列（ピボットが0に近くなければ不定値でもよい）
+     * @param epsilon ピボットの絶対値の下限
+     * @return bool ピボットの絶対値がepsilon以下の場合false
+     */
+    bool factor(const Matrix<N, N, T>& a, T epsilon = T(1e-9)) {
+        valid_ = factorFrom(a, epsilon, false) == 0;
+        return valid_;
+    }
+    
+    /**
+     * @brief 正則化付き分解（常に成功）
+     * @param a 対称行列
+     * @param min_pivot ピボットの下限（これ未満・負のピボットを置き換える、0より大きいこと）
+     * @return size_t 置き換えたピボットの数（0なら正定値）
+     */
+    size_t factorRegularized(const Matrix<N, N, T>& a, T min_pivot) {
+        const size_t replaced = factorFrom(a, min_pivot, true);
+        valid_ = true;
+        return replaced;
+    }
+    
+    bool isValid() const { return valid_; }
+    
+    /**
+     * @brief A X = B を解く（分解済みであること）
+     * @param b 右辺（C列）
+     */
+    template<size_t C>
+    Matrix<N, C, T> solve(const Matrix<N, C, T>& b) const {
+        Matrix<N, C, T> x = b;
+        for (size_t c = 0; c < C; c++) {
+            for (size_t i = 0; i < N; i++) {
+                T sum = x(i, c);
+                for (size_t k = 0; k < i; k++) {
+                    sum -= l_(i, k) * x(k, c);
+                }
+                x(i, c) = sum;
+            }
+            for (size_t i = N; i-- > 0;) {
+                T sum = x(i, c) * inv_d_[i];
+                for (size_t k = i + 1; k < N; k++) {
+                    sum -= l_(k, i) * x(k, c);
+                }
+                x(i, c) = sum;
+            }
+        }
+        return x;
+    }
+    
+    /**
+     * @brief 単位下三角因子 L
+     */
+    const Matrix<N, N, T>& lower() const { return l_; }
+    
+    /**
+     * @brief 対角因子 D の要素
+     * @param index 番号
+     */
+    T pivot(size_t index) const { return d_[index]; }
+    
+    /**
+     * @brief 負のピボットの数（慣性、正則化しない分解の場合の負の固有値の数）
+     */
+    size_t negativePivots() const {
+        size_t count = 0;
+        for (size_t i = 0; i < N; i++) {
+            count += d_[i] < T(0) ? 1 : 0;
+        }
+        return count;
+    }
+    
+private:
+    Matrix<N, N, T> l_;     // 単位下三角因子
+    T d_[N];                // 対角因子
+    T inv_d_[N];            // 対角因子の逆数
+    bool valid_;            // 分解済み
+    
+    /**
+     * @return size_t 正則化した場合は置き換えたピボット数、しない場合は失敗で1
+     */
+    size_t factorFrom(const Matrix<N, N, T>& a, T epsilon, bool regularize) {
+        size_t replaced = 0;
+        T scaled[N];    // L(j, k) d(k)
+        for (size_t j = 0; j < N; j++) {
+            T diag = a(j, j);
+            for (size_t k = 0; k < j; k++) {
+                scaled[k] = l_(j, k) * d_[k];
+                diag -= l_(j, k) * scaled[k];
+            }
+            if (regularize) {
+                if (!(diag >= epsilon)) {
+                    diag = epsilon;
+                    replaced++;
+                }
+            } else if (!(std::fabs(diag) > epsilon)) {
+                return 1;
+            }
+            d_[j] = diag;
+            inv_d_[j] = T(1) / diag;
+            for (size_t i = j + 1; i < N; i++) {
+                T sum = a(i, j);
+                for (size_t k = 0; k < j; k++) {
+                    sum -= l_(i, k) * scaled[k];
+                }
+                l_(i, j) = sum * inv_d_[j];
+            }
+        }
+        return replaced;
+    }
+};
+
+/**
+ * @brief LU分解（部分ピボット選択付き、P A = L U、一般の正方行列）
+ * 
+ * Newton法のヤコビ行列のような非対称な系に使う。行の入れ替えは番号表で持ち、演算回数は一定
+ * @tparam N 次元
+ * @tparam T 要素型
+ */
+template<size_t N, typename T = float>
+class Lu {
+public:
+    static constexpr size_t FACTOR_OPS = N * (N - 1) * (2 * N - 1) / 6 + N * (N - 1) / 2;  // 分解
+    static constexpr size_t SOLVE_OPS = N * N;                                             // 右辺1列の代入
+    
+    Lu() : lu_(), inv_diag_{}, perm_{}, valid_(false) {}
+    
+    /**
+     * @brief 分解
+     * @param a 正方行列
+     * @param epsilon 特異と判定するピボットの絶対値
+     * @return bool 特異（ピボットの絶対値がepsilon以下・NaN）の場合false
+     */
+    bool factor(const Matrix<N, N, T>& a, T epsilon = T(1e-9)) {
+        valid_ = false;
+        lu_ = a;
+        for (size_t i = 0; i < N; i++) {
+            perm_[i] = i;
+        }
+        for (size_t k = 0; k < N; k++) {
+            size_t pivot = k;
+            T largest = std::fabs(lu_(k, k));
+            for (size_t i = k + 1; i < N; i++) {
+                const T value = std::fabs(lu_(i, k));
+                if (value > largest) {
+                    largest = value;
+                    pivot = i;
+                }
+            }
+            if (!(largest > epsilon)) {
+                return false;
+            }
+            if (pivot != k) {
+                for (size_t j = 0; j < N; j++) {
+                    const T swap = lu_(k, j);
+                    lu_(k, j) = lu_(pivot, j);
+                    lu_(pivot, j) = swap;
+                }
+                const size_t swap = perm_[k];
+                perm_[k] = perm_[pivot];
+                perm_[pivot] = swap;
+            }
+            inv_diag_[k] = T(1) / lu_(k, k);
+            for (size_t i = k + 1; i < N; i++) {
+                const T factor = lu_(i, k) * inv_diag_[k];
+                lu_(i, k) = factor;
+                for (size_t j = k + 1; j < N; j++) {
+                    lu_(i, j) -= factor * lu_(k, j);
+                }
+            }
+        }
+        valid_ = true;
+        return true;
+    }
+    
+    bool isValid() const { return valid_; }
+    
+    /**
+     * @brief A X = B を解く（分解済みであること）
+     * @param b 右辺（C列）
+     */
+    template<size_t C>
+    Matrix<N, C, T> solve(const Matrix<N, C, T>& b) const {
+        Matrix<N, C, T> x;
+        for (size_t c = 0; c < C; c++) {
+            for (size_t i = 0; i < N; i++) {
+                T sum = b(perm_[i], c);
+                for (size_t k = 0; k < i; k++) {
+                    sum -= lu_(i, k) * x(k, c);
+                }
+                x(i, c) = sum;
+            }
+            for (size_t i = N; i-- > 0;) {
+                T sum = x(i, c);
+                for (size_t k = i + 1; k < N; k++) {
+                    sum -= lu_(i, k) * x(k, c);
+                }
+                x(i, c) = sum * inv_diag_[i];
+            }
+        }
+        return x;
+    }
+    
+private:
+    Matrix<N, N, T> lu_;    // L（対角を除く下三角）とU（上三角）
+    T inv_diag_[N];         // Uの対角の逆数
+    size_t perm_[N];        // 分解後のi行目に対応する元の行
+    bool valid_;            // 分解済み
+};
+
+/**
+ * @brief 反復解法の結果
+ */
+template<typename T>
+struct SolverResult {
+    uint32_t iterations;    // 実行した反復回数
+    T residual;             // 最後の残差のノルム（Newton: |f|、QP: 最後の更新量）
+    bool converged;         // 許容値に入った
+    bool singular;          // 線形系が解けずに打ち切った
+};
+
+/**
+ * @brief 反復回数固定のNewton法（f(x) = 0、N方程式N変数）
+ * 
+ * 系は void(const Vector<N>& x, Vector<N>& f, Matrix<N, N>& jacobian) の呼び出し可能オブジェクトで渡す。
+ * 系の評価は最大 MAX_ITERATIONS + 1 回、線形代数の演算は最大 LINEAR_OPS 回（系の評価を除く）。
+ * 1回の更新量は max_step で頭打ちにする（初期値が遠い場合の発散を防ぐ）
+ * @tparam N 次元
+ * @tparam MAX_ITERATIONS 最大反復回数
+ * @tparam T 要素型
+ */
+template<size_t N, size_t MAX_ITERATIONS, typename T = float>
+class NewtonSolver {
+    static_assert(MAX_ITERATIONS > 0, "反復回数は1以上");
+    
+public:
+    static constexpr size_t LINEAR_OPS = MAX_ITERATIONS * (Lu<N, T>::FACTOR_OPS + Lu<N, T>::SOLVE_OPS + 3 * N);
+    
+    /**
+     * @brief 求解
+     * @param x 初期値（解で上書き）
+     * @param system 系
+     * @param tolerance 収束とする |f| の上限
+     * @param max_step 1回の更新量の上限（|dx|、0以下で制限なし）
+     * @return SolverResult<T> 結果
+     */
+    template<typename System>
+    static SolverResult<T> solve(Vector<N, T>& x, System&& system, T tolerance, T max_step = T(0)) {
+        SolverResult<T> result = {};
+        Vector<N, T> f;
+        Matrix<N, N, T> jacobian;
+        Lu<N, T> lu;
+        for (;;) {
+            system(static_cast<const Vector<N, T>&>(x), f, jacobian);
+            const T norm2 = f.squaredNorm();
+            result.residual = std::sqrt(norm2);
+            if (norm2 <= tolerance * tolerance) {
+                result.converged = true;
+                break;
+            }
+            if (result.iterations == MAX_ITERATIONS) {
+                break;
+            }
+            if (!lu.factor(jacobian)) {
+                result.singular = true;
+                break;
+            }
+            Vector<N, T> step = lu.solve(f);
+            limitStep(step, max_step);
+            x -= step;
+            result.iterations++;
+        }
+        return result;
+    }
+    
+private:
+    static void limitStep(Vector<N, T>& step, T max_step) {
+        if (max_step <= T(0)) {
+            return;
+        }
+        const T norm2 = step.squaredNorm();
+        if (norm2 > max_step * max_step) {
+            step *= max_step / std::sqrt(norm2);
+        }
+    }
+    
+};
+
+/**
+ * @brief 反復回数固定のGauss-Newton法（残差 r(x) の二乗和最小化、M残差N変数、オンライン同定用）
+ * 
+ * 系は void(const Vector<N>& x, Vector<M>& r, Matrix<M, N>& jacobian) の呼び出し可能オブジェクトで渡す。
+ * 正規方程式 (J^T J + λI) dx = J^T r をCholesky分解で解く（λ=damping、Levenberg型の減衰）。
+ * 系の評価は最大 MAX_ITERATIONS + 1 回
+ * @tparam M 残差の数
+ * @tparam N 変数の数
+ * @tparam MAX_ITERATIONS 最大反復回数
+ * @tparam T 要素型
+ */
+template<size_t M, size_t N, size_t MAX_ITERATIONS, typename T = float>
+class GaussNewtonSolver {
+    static_assert(MAX_ITERATIONS > 0, "反復回数は1以上");
+    static_assert(M >= N, "残差の数は変数の数以上");
+    
+public:
+    static constexpr size_t NORMAL_OPS = M * N * (N + 1) / 2 + M * N;  // J^T J（下三角）と J^T r
+    static constexpr size_t LINEAR_OPS =
+        MAX_ITERATIONS * (NORMAL_OPS + Cholesky<N, T>::FACTOR_OPS + Cholesky<N, T>::SOLVE_OPS);
+    
+    /**
+     * @brief 求解
+     * @param x 初期値（解で上書き）
+     * @param system 系
+     * @param tolerance 収束とする勾配 |J^T r| の上限
+     * @param damping 正規方程式の対角に加える値（0以上）
+     * @return SolverResult<T> 結果（residualは最後の |r|）
+     */
+    template<typename System>
+    static SolverResult<T> solve(Vector<N, T>& x, System&& system, T tolerance, T damping = T(0)) {
+        SolverResult<T> result = {};
+        Vector<M, T> r;
+        Matrix<M, N, T> jacobian;
+        Matrix<N, N, T> normal;
+        Vector<N, T> gradient;
+        Cholesky<N, T> cholesky;
+        for (;;) {
+            system(static_cast<const Vector<N, T>&>(x), r, jacobian);
+            result.residual = r.norm();
+            for (size_t i = 0; i < N; i++) {
+                T sum = T(0);
+                for (size_t k = 0; k < M; k++) {
+                    sum += jacobian(k, i) * r[k];
+                }
+                gradient[i] = sum;
+            }
+            if (gradient.squaredNorm() <= tolerance * tolerance) {
+                result.converged = true;
+                break;
+            }
+            if (result.iterations == MAX_ITERATIONS) {
+                break;
+            }
+            for (size_t i = 0; i < N; i++) {
+                for (size_t j = 0; j <= i; j++) {
+                    T sum = T(0);
+                    for (size_t k = 0; k < M; k++) {
+                        sum += jacobian(k, i) * jacobian(k, j);
+                    }
+                    normal(i, j) = sum;
+                }
+                normal(i, i) += damping;
+            }
+            if (!cholesky.factor(normal)) {
+                result.singular = true;
+                break;
+            }
+            x -= cholesky.solve(gradient);
+            result.iterations++;
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 箱型制約付き凸二次計画（min 1/2 x^T H x + g^T x、lower <= x <= upper）
+ * 
+ * 加速射影勾配法（Nesterov、目的関数が増える向きの更新で慣性をリセット）を MAX_ITERATIONS 回まで回す。
+ * 刻み幅は 1/L（LはGershgorinの円板によるHの最大固有値の上界）で、setup() で1回だけ求める。
+ * MPCのように H が一定で g だけが周期毎に変わる場合は setLinear() で g を差し替え、
+ * 前回の解を初期値に渡す（ウォームスタート）
+ * @tparam N 次元
+ * @tparam MAX_ITERATIONS 最大反復回数
+ * @tparam T 要素型
+ */
+template<size_t N, size_t MAX_ITERATIONS, typename T = float>
+class BoxQp {
+    static_assert(MAX_ITERATIONS > 0, "反復回数は1以上");
+    
+public:
+    static constexpr size_t ITERATION_OPS = N * N + 6 * N;                 // 1反復
+    static constexpr size_t MAX_OPS = MAX_ITERATIONS * ITERATION_OPS;      // 最悪値
+    
+    BoxQp() : h_(), g_(), lower_(), upper_(), step_(T(0)) {}
+    
+    /**
+     * @brief 問題の設定
+     * @param h ヘッセ行列（対称半正定値）
+     * @param g 一次の係数
+     * @param lower 下限
+     * @param upper 上限
+     * @return bool Hが0・下限が上限を超える場合false
+     */
+    bool setup(const Matrix<N, N, T>& h, const Vector<N, T>& g, const Vector<N, T>& lower, 
+               const Vector<N, T>& upper) {
+        step_ = T(0);
+        T bound = T(0);
+        for (size_t i = 0; i < N; i++) {
+            if (!(lower[i] <= upper[i])) {
+                return false;
+            }
+            T row = T(0);
+            for (size_t j = 0; j < N; j++) {
+                row += std::fabs(h(i, j));
+            }
+            bound = row > bound ? row : bound;
+        }
+        if (!(bound > T(0))) {
+            return false;
+        }
+        h_ = h;
+        g_ = g;
+        lower_ = lower;
+        upper_ = upper;
+        step_ = T(1) / bound;
+        return true;
+    }
+    
+    /**
+     * @brief 一次の係数の差し替え（Hと制約はそのまま）
+     */
+    void setLinear(const Vector<N, T>& g) { g_ = g; }
+    
+    /**
+     * @brief 設定済みか
+     */
+    bool isReady() const { return step_ > T(0); }
+    
+    /**
+     * @brief 求解
+     * @param x 初期値（制約内へ射影してから始める、解で上書き）
+     * @param tolerance 収束とする1回の更新量 |Δx| の上限（0で常にMAX_ITERATIONS回）
+     * @return SolverResult<T> 結果（residualは最後の |Δx|）
+     */
+    SolverResult<T> solve(Vector<N, T>& x, T tolerance = T(0)) const {
+        SolverResult<T> result = {};
+        if (!isReady()) {
+            result.singular = true;
+            return result;
+        }
+        project(x);
+        Vector<N, T> y = x;
+        Vector<N, T> gradient;
+        T momentum = T(1);
+        const T limit = tolerance * tolerance;
+        while (result.iterations < MAX_ITERATIONS) {
+            gradient = h_ * y + g_;
+            Vector<N, T> next = y - gradient * step_;
+            project(next);
+            Vector<N, T> delta = next - x;
+            result.iterations++;
+            
+            // 勾配と更新の向きが揃う（目的関数が増える）なら慣性を捨てる
+            const T next_momentum = (T(1) + std::sqrt(T(1) + T(4) * momentum * momentum)) * T(0.5);
+            T beta = (momentum - T(1)) / next_momentum;
+            momentum = next_momentum;
+            if (gradient.dot(delta) > T(0)) {
+                beta = T(0);
+                momentum = T(1);
+            }
+            x = next;
+            y = next + delta * beta;
+            
+            const T delta2 = delta.squaredNorm();
+            result.residual = std::sqrt(delta2);
+            if (delta2 <= limit) {
+                result.converged = true;
+                break;
+            }
+        }
+        return result;
+    }
+    
+    /**
+     * @brief 目的関数の値
+     */
+    T objective(const Vector<N, T>& x) const { return x.dot(h_ * x) * T(0.5) + g_.dot(x); }
+    
+private:
+    Matrix<N, N, T> h_;     // ヘッセ行列
+    Vector<N, T> g_;        // 一次の係数
+    Vector<N, T> lower_;    // 下限
+    Vector<N, T> upper_;    // 上限
+    T step_;                // 刻み幅（1/L、0は未設定）
+    
+    void project(Vector<N, T>& x) const {
+        for (size_t i = 0; i < N; i++) {
+            x[i] = x[i] < lower_[i] ? lower_[i] : (x[i] > upper_[i] ? upper_[i] : x[i]);
+        }
+    }
+};
+
+} // namespace common
+
+#endif // SOLVERS_HPP
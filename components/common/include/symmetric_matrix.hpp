@@ -0,0 +1,157 @@
+/*
+ * Symmetric Matrix
+ * 
+ * 上三角パック形式の対称行列（ヘッダーオンリー）
+ * 共分散行列のように対称性が保証される行列を N(N+1)/2 要素で保持し、
+ * 更新も上三角のみ計算することで記憶域と演算量をほぼ半分にする
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SYMMETRIC_MATRIX_HPP
+#define SYMMETRIC_MATRIX_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+namespace common {
+
+/**
+ * @brief 上三角パック形式の対称行列テンプレート
+ * 
+ * 行優先で上三角（対角を含む）を詰めて保持する。行rowの(row, row)〜(row, N-1)は連続する。
+ * (i, j)と(j, i)は同じ要素を参照する
+ * @tparam N 次元
+ * @tparam T 要素型
+ */
+template<size_t N, typename T = float>
+class SymmetricMatrix {
+    static_assert(N > 0, "次元は1以上");
+    static_assert(std::is_floating_point<T>::value, "要素型は浮動小数点型");
+    
+public:
+    static constexpr size_t DIM = N;                        // 次元
+    static constexpr size_t PACKED_SIZE = N * (N + 1) / 2;  // 要素数
+    
+    /**
+     * @brief コンストラクタ（ゼロ初期化）
+     */
+    constexpr SymmetricMatrix() : data_{} {}
+    
+    /**
+     * @brief 行の先頭（対角要素）の通し番号
+     * @param row 行
+     */
+    static constexpr size_t rowOffset(size_t row) { return row * N - row * (row - 1) / 2; }
+    
+    /**
+     * @brief 要素の通し番号（row <= col）
+     * @param row 行
+     * @param col 列
+     */
+    static constexpr size_t upperIndex(size_t row, size_t col) { return rowOffset(row) + (col - row); }
+    
+    /**
+     * @brief 要素参照（上下どちらの三角を指定してもよい）
+     * @param row 行
+     * @param col 列
+     */
+    constexpr T& operator()(size_t row, size_t col) {
+        return row <= col ? data_[upperIndex(row, col)] : data_[upperIndex(col, row)];
+    }
+    constexpr const T& operator()(size_t row, size_t col) const {
+        return row <= col ? data_[upperIndex(row, col)] : data_[upperIndex(col, row)];
+    }
+    
+    /**
+     * @brief 行の上三角部分（(row, row)〜(row, N-1)）
+     * @param row 行
+     */
+    T* upperRow(size_t row) { return &data_[rowOffset(row)]; }
+    const T* upperRow(size_t row) const { return &data_[rowOffset(row)]; }
+    
+    /**
+     * @brief パック配列
+     */
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    
+    /**
+     * @brief 全要素を0に設定
+     */
+    constexpr void setZero() {
+        for (size_t i = 0; i < PACKED_SIZE; i++) {
+            data_[i] = T(0);
+        }
+    }
+    
+    /**
+     * @brief 対角行列に設定
+     * @param diagonal 対角要素（N個）
+     */
+    constexpr void setDiagonal(const T* diagonal) {
+        setZero();
+        for (size_t i = 0; i < N; i++) {
+            data_[rowOffset(i)] = diagonal[i];
+        }
+    }
+    
+    /**
+     * @brief 対角要素取得
+     * @param index 番号
+     */
+    constexpr T diagonal(size_t index) const { return data_[rowOffset(index)]; }
+    
+    /**
+     * @brief 密な行列（行優先N x N）へ展開
+     * @param dense 出力先（N*N要素）
+     */
+    void toDense(T* dense) const {
+        const T* src = data_;
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i; j < N; j++) {
+                T value = *src++;
+                dense[i * N + j] = value;
+                dense[j * N + i] = value;
+            }
+        }
+    }
+    
+    /**
+     * @brief 対称ランク1更新（this += alpha * u * u^T、上三角のみ計算）
+     * @param u ベクトル（N要素）
+     * @param alpha 係数
+     */
+    void rankOneUpdate(const T* u, T alpha) {
+        T* dst = data_;
+        for (size_t i = 0; i < N; i++) {
+            T scaled = alpha * u[i];
+            for (size_t j = i; j < N; j++) {
+                *dst++ += scaled * u[j];
+            }
+        }
+    }
+    
+    /**
+     * @brief 対角要素の下限処理（数値誤差による正定値性の喪失を防ぐ）
+     * @param minimum 下限値
+     */
+    void clampDiagonal(T minimum) {
+        for (size_t i = 0; i < N; i++) {
+            T& value = data_[rowOffset(i)];
+            if (value < minimum) {
+                value = minimum;
+            }
+        }
+    }
+    
+private:
+    T data_[PACKED_SIZE];       // 上三角パック配列
+};
+
+} // namespace common
+
+#endif // SYMMETRIC_MATRIX_HPP
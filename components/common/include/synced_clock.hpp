@@ -0,0 +1,130 @@
+/*
+ * Synced Clock
+ * 
+ * 地上局と共有する時刻（同期時刻）への変換（ヘッダーオンリー）
+ * 時刻同期（communication::TimeSync）が推定した時刻差・ドリフトを公開し、
+ * テレメトリ・ブラックボックスの時刻をどのタスクからでも同期時刻へ変換できるようにする
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SYNCED_CLOCK_HPP
+#define SYNCED_CLOCK_HPP
+
+#include "mailbox.hpp"
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief 時刻モデル
+ * 
+ * 同期時刻 = 自機の時刻 + offset_us + drift_ppb × (自機の時刻 - reference_us) / 10^9
+ * 自機の時刻は esp_timer_get_time()（起動からのμs）
+ */
+struct ClockModel {
+    int64_t reference_us;       // 推定の基準時刻（自機の時刻、μs）
+    int64_t offset_us;          // 基準時刻での時刻差（同期時刻 - 自機の時刻、μs）
+    int32_t drift_ppb;          // 時刻差の変化率（ppb、地上の時計が速いと正）
+    uint32_t update_count;      // 更新回数
+    bool valid;                 // 同期済み
+    
+    /**
+     * @brief 自機の時刻から同期時刻への変換（未同期時はそのまま返す）
+     * @param local_us 自機の時刻（μs）
+     * @return int64_t 同期時刻（μs）
+     */
+    int64_t toSynced(int64_t local_us) const {
+        if (!valid) {
+            return local_us;
+        }
+        const int64_t elapsed = local_us - reference_us;
+        return local_us + offset_us + elapsed * drift_ppb / 1000000000;
+    }
+    
+    /**
+     * @brief 同期時刻から自機の時刻への変換（toSynced()の逆、未同期時はそのまま返す）
+     * @param synced_us 同期時刻（μs）
+     * @return int64_t 自機の時刻（μs）
+     */
+    int64_t toLocal(int64_t synced_us) const {
+        if (!valid) {
+            return synced_us;
+        }
+        // ドリフト項は小さいため、ドリフトなしの近似値で評価すれば十分
+        const int64_t approx = synced_us - offset_us;
+        return approx - (approx - reference_us) * drift_ppb / 1000000000;
+    }
+};
+
+/**
+ * @brief 同期時刻
+ * 
+ * 更新は時刻同期の受信処理（単一タスク）のみ。変換はシーケンスロックの読み出しで、
+ * 制御ループ・テレメトリ・記録のどのタスクからも待たずに呼べる
+ */
+class SyncedClock {
+public:
+    SyncedClock() = default;
+    
+    SyncedClock(const SyncedClock&) = delete;
+    SyncedClock& operator=(const SyncedClock&) = delete;
+    
+    /**
+     * @brief 時刻モデルの公開（時刻同期のタスク専用）
+     * @param model 時刻モデル
+     */
+    void publish(const ClockModel& model) { mailbox_.write(model); }
+    
+    /**
+     * @brief 最新の時刻モデル取得
+     * @param model 格納先
+     * @return bool 同期済みのモデルを取得できた場合true
+     */
+    bool snapshot(ClockModel& model) const { return mailbox_.read(model) && model.valid; }
+    
+    /**
+     * @brief 自機の時刻から同期時刻への変換（未同期時はそのまま返す）
+     * @param local_us 自機の時刻（μs）
+     * @return int64_t 同期時刻（μs）
+     */
+    int64_t toSynced(int64_t local_us) const {
+        ClockModel model;
+        return snapshot(model) ? model.toSynced(local_us) : local_us;
+    }
+    
+    /**
+     * @brief 32bitの時刻フィールド用の変換（テレメトリのtime_us等）
+     * 
+     * 上位ビットはモデルの基準時刻から補う（基準時刻の前後35分以内の時刻に使う）
+     * @param local_us 自機の時刻の下位32bit（μs）
+     * @return uint32_t 同期時刻の下位32bit
+     */
+    uint32_t stamp(uint32_t local_us) const {
+        ClockModel model;
+        if (!snapshot(model)) {
+            return local_us;
+        }
+        const int64_t full = model.reference_us + static_cast<int32_t>(local_us - static_cast<uint32_t>(model.reference_us));
+        return static_cast<uint32_t>(model.toSynced(full));
+    }
+    
+    /**
+     * @brief システム共通インスタンス取得
+     * @return SyncedClock& 同期時刻
+     */
+    static SyncedClock& instance() {
+        static SyncedClock clock;
+        return clock;
+    }
+    
+private:
+    Mailbox<ClockModel> mailbox_;       // 公開済みの時刻モデル
+};
+
+} // namespace common
+
+#endif // SYNCED_CLOCK_HPP
@@ -0,0 +1,296 @@
+/*
+ * Timebase
+ * 
+ * CPUサイクルカウンタの時刻基盤
+ * 64bitに拡張したコア別のサイクル数、固定小数点の乗算によるμs・ns換算、
+ * 計測区間のRAIIヘルパー、スケジューラ向けの期限型をまとめる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TIMEBASE_HPP
+#define TIMEBASE_HPP
+
+#include "esp_attr.h"
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "sdkconfig.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace common {
+
+/**
+ * @brief CPUサイクルの時刻基盤（全体で1つ）
+ * 
+ * CCOUNT（32bit、240MHzで約17.9秒で一周）はコア毎の独立したカウンタで、コア間で値を比べられない。
+ * cycles64() はコア別の上位語で64bitへ拡張する。一周の前に必ず拡張されるよう、initialize() で
+ * 各コアのFreeRTOSティックフックに拡張処理を登録する。
+ * 
+ * 換算は 2^32 / (サイクル/μs) を前もって求めておき、32×32→64bitの乗算とシフトだけで行う（除算なし）。
+ * 周波数は initialize() 時点のCPU周波数で、動的周波数制御（PowerManager）で下がっている間の換算はずれる
+ * （飛行中はCPU_FREQ_MAXのロックで一定）。コア間・タスク間で比べる時刻は Deadline（esp_timer）を使う
+ */
+class Timebase {
+public:
+    /**
+     * @brief 初期化（換算係数の計算と両コアのティックフック登録）
+     * @return esp_err_t 初期化結果
+     */
+    static esp_err_t initialize();
+    
+    /**
+     * @brief サイクルカウント（32bit、区間計測用）
+     */
+    static IRAM_ATTR inline uint32_t cycles() { return static_cast<uint32_t>(esp_cpu_get_cycle_count()); }
+    
+    /**
+     * @brief 64bitサイクルカウント（実行中のコアのカウンタ、ISRからも呼べる）
+     */
+    static IRAM_ATTR inline uint64_t cycles64() {
+        // 割り込みを止めて読み出しと上位語の更新を分けない（タスクのコア移動も起きない）
+        const UBaseType_t state = portSET_INTERRUPT_MASK_FROM_ISR();
+        Extension& e = extension_[static_cast<size_t>(esp_cpu_get_core_id()) % CORE_COUNT];
+        const uint32_t now = cycles();
+        if (now < e.last) {
+            e.high++;
+        }
+        e.last = now;
+        const uint64_t result = (static_cast<uint64_t>(e.high) << 32) | now;
+        portCLEAR_INTERRUPT_MASK_FROM_ISR(state);
+        return result;
+    }
+    
+    /**
+     * @brief サイクル数からμsへ（32bit区間、約17.9秒まで）
+     */
+    static IRAM_ATTR inline uint32_t toUs(uint32_t cycles) {
+        return static_cast<uint32_t>((static_cast<uint64_t>(cycles) * us_multiplier_) >> 32);
+    }
+    
+    /**
+     * @brief サイクル数からμsへ（64bit）
+     */
+    static IRAM_ATTR inline uint64_t toUs64(uint64_t cycles) {
+        const uint64_t high = cycles >> 32;
+        const uint64_t low = cycles & 0xFFFFFFFFu;
+        return high * us_multiplier_ + ((low * us_multiplier_) >> 32);
+    }
+    
+    /**
+     * @brief サイクル数からnsへ（32bit区間）
+     */
+    static IRAM_ATTR inline uint64_t toNs(uint32_t cycles) {
+        return (static_cast<uint64_t>(cycles) * ns_multiplier_) >> NS_SHIFT;
+    }
+    
+    /**
+     * @brief μsからサイクル数へ（約17.9秒まで）
+     */
+    static IRAM_ATTR inline uint32_t fromUs(uint32_t us) { return us * cycles_per_us_; }
+    
+    /**
+     * @brief 換算に使うCPU周波数（MHz）
+     */
+    static uint32_t cpuMhz() { return cycles_per_us_; }
+    
+    /**
+     * @brief CPU周波数の変更（周波数を固定し直した後に呼ぶ）
+     * @param mhz CPU周波数（MHz）
+     */
+    static void setCpuMhz(uint32_t mhz);
+    
+    /**
+     * @brief 指定サイクル数の空回り（ティック未満の短い待ち、サイクル精度）
+     */
+    static IRAM_ATTR inline void spinCycles(uint32_t count) {
+        const uint32_t start = cycles();
+        while (cycles() - start < count) {
+        }
+    }
+    
+private:
+    static constexpr size_t CORE_COUNT = 2;             // コア数
+    static constexpr uint32_t NS_SHIFT = 24;            // ns換算の固定小数点のビット数
+    
+    /**
+     * @brief コア別の64bit拡張
+     */
+    struct Extension {
+        uint32_t last;          // 前回読んだ下位語
+        uint32_t high;          // 上位語（下位語の一周回数）
+    };
+    
+    /**
+     * @brief ティックフック（各コアのティック割り込みで拡張を進める）
+     */
+    static IRAM_ATTR void onTick() { cycles64(); }
+    
+    static inline Extension extension_[CORE_COUNT] = {};                     // コア別の拡張
+    static inline uint32_t cycles_per_us_ = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;    // サイクル/μs
+    static inline uint32_t us_multiplier_ =                                     // 2^32 / (サイクル/μs)
+        static_cast<uint32_t>(((1ull << 32) + CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 2) / CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    static inline uint32_t ns_multiplier_ =                                     // 2^24 × 1000 / (サイクル/μs)
+        static_cast<uint32_t>(((1000ull << NS_SHIFT) + CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 2) /
+                              CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    static inline bool initialized_ = false;                                    // 初期化済み
+};
+
+/**
+ * @brief 計測区間（サイクル数を記録先へ渡す）
+ * 
+ * 記録先は add(uint32_t) を持つ型（common::Histogram・common::RunningStats 等）。
+ * 構築から破棄までのサイクル数を1回加える
+ * @tparam Sink 記録先の型
+ */
+template<typename Sink>
+class ScopedCycles {
+public:
+    IRAM_ATTR explicit ScopedCycles(Sink& sink)
+        : sink_(sink)
+        , start_(Timebase::cycles()) {}
+    
+    IRAM_ATTR ~ScopedCycles() { sink_.add(Timebase::cycles() - start_); }
+    
+    ScopedCycles(const ScopedCycles&) = delete;
+    ScopedCycles& operator=(const ScopedCycles&) = delete;
+    
+    /**
+     * @brief 構築からの経過サイクル数
+     */
+    uint32_t elapsed() const { return Timebase::cycles() - start_; }
+    
+private:
+    Sink& sink_;            // 記録先
+    uint32_t start_;        // 開始サイクル
+};
+
+/**
+ * @brief 計測区間（μsを記録先へ渡す、sensors::LatencyHistogram 等）
+ * @tparam Sink 記録先の型（add(uint32_t) を持つ）
+ */
+template<typename Sink>
+class ScopedMicros {
+public:
+    IRAM_ATTR explicit ScopedMicros(Sink& sink)
+        : sink_(sink)
+        , start_(Timebase::cycles()) {}
+    
+    IRAM_ATTR ~ScopedMicros() { sink_.add(Timebase::toUs(Timebase::cycles() - start_)); }
+    
+    ScopedMicros(const ScopedMicros&) = delete;
+    ScopedMicros& operator=(const ScopedMicros&) = delete;
+    
+private:
+    Sink& sink_;            // 記録先
+    uint32_t start_;        // 開始サイクル
+};
+
+/**
+ * @brief 期限（esp_timerの時刻、コア間で比べられる）
+ * 
+ * 周期処理では advance() で次の期限へ進める。期限を過ぎていた周期は詰めて実行せずに飛ばし、
+ * 飛ばした数を返す（遅れを取り戻すための連続実行で後段を詰まらせない）
+ */
+class Deadline {
+public:
+    /**
+     * @brief 期限なし（expired()は常にfalse）
+     */
+    constexpr Deadline()
+        : at_us_(NEVER) {}
+    
+    /**
+     * @brief 絶対時刻の期限
+     * @param at_us 期限（esp_timer_get_time()の時刻、μs）
+     */
+    static constexpr Deadline at(int64_t at_us) { return Deadline(at_us); }
+    
+    /**
+     * @brief 現在から指定時間後の期限
+     * @param us 時間（μs）
+     */
+    static IRAM_ATTR inline Deadline after(int64_t us) { return Deadline(esp_timer_get_time() + us); }
+    
+    /**
+     * @brief 期限なし
+     */
+    static constexpr Deadline never() { return Deadline(); }
+    
+    bool isNever() const { return at_us_ == NEVER; }
+    int64_t timeUs() const { return at_us_; }
+    
+    /**
+     * @brief 期限切れか
+     * @param now_us 現在時刻（μs）
+     */
+    IRAM_ATTR bool expired(int64_t now_us) const { return at_us_ != NEVER && now_us >= at_us_; }
+    IRAM_ATTR bool expired() const { return expired(esp_timer_get_time()); }
+    
+    /**
+     * @brief 期限までの時間（期限切れは0、期限なしはINT64_MAX）
+     * @param now_us 現在時刻（μs）
+     */
+    int64_t remainingUs(int64_t now_us) const {
+        if (at_us_ == NEVER) {
+            return NEVER;
+        }
+        return at_us_ > now_us ? at_us_ - now_us : 0;
+    }
+    int64_t remainingUs() const { return remainingUs(esp_timer_get_time()); }
+    
+    /**
+     * @brief 期限までのティック数（切り上げ、待ち関数のタイムアウト用、期限なしはportMAX_DELAY）
+     */
+    TickType_t remainingTicks() const {
+        if (at_us_ == NEVER) {
+            return portMAX_DELAY;
+        }
+        const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+        const int64_t ticks = (remainingUs() + tick_us - 1) / tick_us;
+        return ticks >= static_cast<int64_t>(portMAX_DELAY) ? portMAX_DELAY - 1 : static_cast<TickType_t>(ticks);
+    }
+    
+    /**
+     * @brief 次の周期へ進める
+     * @param period_us 周期（μs、1以上）
+     * @param now_us 現在時刻（μs）
+     * @return uint32_t 期限を過ぎて飛ばした周期の数
+     */
+    IRAM_ATTR uint32_t advance(int64_t period_us, int64_t now_us) {
+        at_us_ += period_us;
+        if (now_us < at_us_) {
+            return 0;
+        }
+        const int64_t skipped = (now_us - at_us_) / period_us + 1;
+        at_us_ += skipped * period_us;
+        return static_cast<uint32_t>(skipped);
+    }
+    IRAM_ATTR uint32_t advance(int64_t period_us) { return advance(period_us, esp_timer_get_time()); }
+    
+    /**
+     * @brief 期限まで待つ
+     * 
+     * ティック単位はタスクを眠らせ、ティック未満の残りは空回りで詰める（μs精度）。
+     * ISR・スケジューラ停止中は全て空回りになるため、長い待ちに使わないこと
+     */
+    void sleep() const;
+    
+private:
+    static constexpr int64_t NEVER = INT64_MAX;     // 期限なし
+    
+    constexpr explicit Deadline(int64_t at_us)
+        : at_us_(at_us) {}
+    
+    int64_t at_us_;         // 期限（μs）
+};
+
+} // namespace common
+
+#endif // TIMEBASE_HPP
@@ -0,0 +1,220 @@
+/*
+ * Timestamped Ring
+ * 
+ * 時刻付きサンプルの固定長リングバッファ（ヘッダーオンリー）
+ * 任意の時刻の値を二分探索と前後サンプルの線形補間で求める（センサー毎の時刻合わせ用）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TIMESTAMPED_RING_HPP
+#define TIMESTAMPED_RING_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace common {
+
+/**
+ * @brief 値の線形補間（a + (b - a) * alpha）
+ * 
+ * 算術型とfloat配列を扱う。その他の型は特殊化で追加する
+ * @tparam T 値の型
+ */
+template<typename T>
+struct Interpolator {
+    static_assert(std::is_arithmetic<T>::value, "算術型以外はInterpolatorを特殊化すること");
+    
+    static T apply(const T& a, const T& b, float alpha) {
+        return static_cast<T>(a + (b - a) * alpha);
+    }
+};
+
+template<size_t M>
+struct Interpolator<std::array<float, M>> {
+    static std::array<float, M> apply(const std::array<float, M>& a, const std::array<float, M>& b, float alpha) {
+        std::array<float, M> result;
+        for (size_t i = 0; i < M; i++) {
+            result[i] = a[i] + (b[i] - a[i]) * alpha;
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 時刻付きリングバッファ
+ * 
+ * 時刻が単調増加するサンプルを保持し、満杯時は最古のサンプルを上書きする。
+ * sample() は O(log N) の二分探索で前後のサンプルを見つけて線形補間する。
+ * 排他しないため、push()とsample()は同じタスクから呼び出すこと
+ * （別タスクのセンサー値は RingBuffer 等で受け渡してからこのバッファへ積む）
+ * @tparam T 値の型（Interpolator<T>が定義されていること）
+ * @tparam N 容量（2のべき乗）
+ */
+template<typename T, size_t N>
+class TimestampedRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "容量は2のべき乗");
+    static_assert(std::is_trivially_copyable<T>::value, "値の型はトリビアルコピー可能であること");
+    
+public:
+    TimestampedRing()
+        : head_(0)
+        , count_(0)
+        , rejected_(0) {}
+    
+    /**
+     * @brief サンプル追加
+     * @param timestamp_us サンプル時刻（μs）
+     * @param value 値
+     * @return bool 時刻が最新のサンプル以前で追加しなかった場合false
+     */
+    bool push(int64_t timestamp_us, const T& value) {
+        if (count_ > 0 && timestamp_us <= time_[(head_ - 1) & MASK]) {
+            rejected_++;
+            return false;
+        }
+        time_[head_ & MASK] = timestamp_us;
+        value_[head_ & MASK] = value;
+        head_++;
+        if (count_ < N) {
+            count_++;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief 任意時刻の値（前後のサンプルの線形補間）
+     * @param timestamp_us 問い合わせ時刻（μs）
+     * @param value 格納先
+     * @param max_gap_us 前後のサンプルの最大間隔（超える場合は欠測とみなす、0で無制限）
+     * @return bool 最古〜最新のサンプルの範囲外・欠測の場合false
+     */
+    bool sample(int64_t timestamp_us, T& value, int64_t max_gap_us = 0) const {
+        size_t upper = 0;
+        if (!findUpper(timestamp_us, upper)) {
+            return false;
+        }
+        const size_t hi = at(upper);
+        if (time_[hi] == timestamp_us) {
+            value = value_[hi];
+            return true;
+        }
+        const size_t lo = at(upper - 1);
+        const int64_t gap = time_[hi] - time_[lo];
+        if (max_gap_us > 0 && gap > max_gap_us) {
+            return false;
+        }
+        const float alpha = static_cast<float>(timestamp_us - time_[lo]) / static_cast<float>(gap);
+        value = Interpolator<T>::apply(value_[lo], value_[hi], alpha);
+        return true;
+    }
+    
+    /**
+     * @brief 問い合わせ時刻以降で最初のサンプルの時刻（補間の上側）
+     * @param timestamp_us 問い合わせ時刻（μs）
+     * @param upper_us 上側のサンプル時刻の格納先
+     * @return bool 範囲外の場合false
+     */
+    bool upperTime(int64_t timestamp_us, int64_t& upper_us) const {
+        size_t upper = 0;
+        if (!findUpper(timestamp_us, upper)) {
+            return false;
+        }
+        upper_us = time_[at(upper)];
+        return true;
+    }
+    
+    /**
+     * @brief 最新のサンプル
+     * @return bool 空の場合false
+     */
+    bool latest(int64_t& timestamp_us, T& value) const {
+        if (count_ == 0) {
+            return false;
+        }
+        const size_t index = (head_ - 1) & MASK;
+        timestamp_us = time_[index];
+        value = value_[index];
+        return true;
+    }
+    
+    /**
+     * @brief 最古のサンプル時刻（空の場合0）
+     */
+    int64_t oldestTime() const { return count_ ? time_[at(0)] : 0; }
+    
+    /**
+     * @brief 最新のサンプル時刻（空の場合0）
+     */
+    int64_t newestTime() const { return count_ ? time_[(head_ - 1) & MASK] : 0; }
+    
+    /**
+     * @brief 全サンプル破棄
+     */
+    void clear() { count_ = 0; }
+    
+    /**
+     * @brief 格納サンプル数
+     */
+    size_t size() const { return count_; }
+    
+    /**
+     * @brief 空判定
+     */
+    bool empty() const { return count_ == 0; }
+    
+    /**
+     * @brief 容量取得
+     */
+    static constexpr size_t capacity() { return N; }
+    
+    /**
+     * @brief 時刻が戻って追加しなかったサンプル数
+     */
+    uint32_t getRejectedCount() const { return rejected_; }
+    
+private:
+    static constexpr size_t MASK = N - 1;
+    
+    size_t head_;               // 次の書き込み位置（単調増加）
+    size_t count_;              // 格納サンプル数
+    uint32_t rejected_;         // 時刻が戻って追加しなかったサンプル数
+    int64_t time_[N];           // サンプル時刻（μs、探索で連続アクセスするため値と分ける）
+    T value_[N];                // 値
+    
+    /**
+     * @brief 古い順の番号から配列の位置
+     */
+    size_t at(size_t order) const { return (head_ - count_ + order) & MASK; }
+    
+    /**
+     * @brief 時刻以上で最初のサンプルの番号（古い順）を二分探索
+     * @return bool 範囲外の場合false
+     */
+    bool findUpper(int64_t timestamp_us, size_t& upper) const {
+        if (count_ == 0 || timestamp_us < time_[at(0)] || timestamp_us > time_[(head_ - 1) & MASK]) {
+            return false;
+        }
+        size_t lo = 0;
+        size_t hi = count_ - 1;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (time_[at(mid)] < timestamp_us) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        upper = lo;
+        return true;
+    }
+};
+
+} // namespace common
+
+#endif // TIMESTAMPED_RING_HPP
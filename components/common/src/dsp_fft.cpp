@@ -0,0 +1,83 @@
+/*
+ * DSP FFT Implementation
+ * 
+ * 基数2 FFT実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "dsp_fft.hpp"
+#include <cmath>
+#include <utility>
+
+#ifdef ESP_PLATFORM
+#include "dsps_fft2r.h"
+#endif
+
+namespace common {
+namespace dsp {
+
+bool fftInitialize(size_t max_size) {
+    if (!isPowerOfTwo(max_size)) {
+        return false;
+    }
+#ifdef ESP_PLATFORM
+    // 回転因子表はesp-dsp内部で確保（CONFIG_DSP_MAX_FFT_SIZEまで）
+    if (max_size > CONFIG_DSP_MAX_FFT_SIZE) {
+        return false;
+    }
+    esp_err_t ret = dsps_fft2r_init_fc32(nullptr, CONFIG_DSP_MAX_FFT_SIZE);
+    return ret == ESP_OK || ret == ESP_ERR_DSP_REINITIALIZED;
+#else
+    return true;
+#endif
+}
+
+void fft(float* data, size_t size) {
+#ifdef ESP_PLATFORM
+    dsps_fft2r_fc32(data, static_cast<int>(size));
+    dsps_bit_rev_fc32(data, static_cast<int>(size));
+#else
+    fftReference(data, size);
+#endif
+}
+
+void fftReference(float* data, size_t size) {
+    // ビット反転並べ替え
+    for (size_t i = 1, j = 0; i < size; i++) {
+        size_t bit = size >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            std::swap(data[2 * i], data[2 * j]);
+            std::swap(data[2 * i + 1], data[2 * j + 1]);
+        }
+    }
+    
+    // バタフライ（時間間引き、X[k] = Σ x[n] e^{-j2πkn/N}）
+    for (size_t length = 2; length <= size; length <<= 1) {
+        float angle = -2.0f * 3.14159265358979f / static_cast<float>(length);
+        for (size_t start = 0; start < size; start += length) {
+            for (size_t k = 0; k < length / 2; k++) {
+                float wr = cosf(angle * static_cast<float>(k));
+                float wi = sinf(angle * static_cast<float>(k));
+                float* a = data + 2 * (start + k);
+                float* b = data + 2 * (start + k + length / 2);
+                float tr = b[0] * wr - b[1] * wi;
+                float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+}
+
+} // namespace dsp
+} // namespace common
@@ -0,0 +1,113 @@
+/*
+ * DSP Filters Implementation
+ * 
+ * ブロック処理のディジタルフィルタ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "dsp_filters.hpp"
+#include <cmath>
+
+#ifdef ESP_PLATFORM
+#include "dsps_biquad.h"
+#include "dsps_dotprod.h"
+#endif
+
+namespace common {
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+} // namespace
+
+BiquadCoefficients BiquadCoefficients::lowpass(float cutoff_hz, float sample_hz, float q) {
+    if (cutoff_hz <= 0.0f || sample_hz <= 0.0f || cutoff_hz >= sample_hz * 0.5f || q <= 0.0f) {
+        return passthrough();
+    }
+    
+    float w0 = 2.0f * PI * cutoff_hz / sample_hz;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float inv_a0 = 1.0f / (1.0f + alpha);
+    
+    BiquadCoefficients c;
+    c.b0 = (1.0f - cos_w0) * 0.5f * inv_a0;
+    c.b1 = (1.0f - cos_w0) * inv_a0;
+    c.b2 = c.b0;
+    c.a1 = -2.0f * cos_w0 * inv_a0;
+    c.a2 = (1.0f - alpha) * inv_a0;
+    return c;
+}
+
+BiquadCoefficients BiquadCoefficients::notch(float center_hz, float sample_hz, float q) {
+    if (center_hz <= 0.0f || sample_hz <= 0.0f || center_hz >= sample_hz * 0.5f || q <= 0.0f) {
+        return passthrough();
+    }
+    
+    float w0 = 2.0f * PI * center_hz / sample_hz;
+    float cos_w0 = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float inv_a0 = 1.0f / (1.0f + alpha);
+    
+    BiquadCoefficients c;
+    c.b0 = inv_a0;
+    c.b1 = -2.0f * cos_w0 * inv_a0;
+    c.b2 = inv_a0;
+    c.a1 = c.b1;
+    c.a2 = (1.0f - alpha) * inv_a0;
+    return c;
+}
+
+namespace dsp {
+
+void biquad(const float* input, float* output, size_t length, const BiquadCoefficients& coefficients, float* state) {
+#ifdef ESP_PLATFORM
+    // ESP32-S3ではdsps_biquad_f32はdsps_biquad_f32_aes3に展開される（係数は書き換えられない）
+    dsps_biquad_f32(input, output, static_cast<int>(length), 
+                    const_cast<float*>(&coefficients.b0), state);
+#else
+    biquadReference(input, output, length, coefficients, state);
+#endif
+}
+
+void biquadReference(const float* input, float* output, size_t length, const BiquadCoefficients& coefficients, 
+                     float* state) {
+    const BiquadCoefficients& c = coefficients;
+    float w0 = state[0];
+    float w1 = state[1];
+    for (size_t i = 0; i < length; i++) {
+        float d0 = input[i] - c.a1 * w0 - c.a2 * w1;
+        output[i] = c.b0 * d0 + c.b1 * w0 + c.b2 * w1;
+        w1 = w0;
+        w0 = d0;
+    }
+    state[0] = w0;
+    state[1] = w1;
+}
+
+float dotProduct(const float* a, const float* b, size_t length) {
+#ifdef ESP_PLATFORM
+    float result = 0.0f;
+    dsps_dotprod_f32(a, b, &result, static_cast<int>(length));
+    return result;
+#else
+    return dotProductReference(a, b, length);
+#endif
+}
+
+float dotProductReference(const float* a, const float* b, size_t length) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < length; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+} // namespace dsp
+
+} // namespace common
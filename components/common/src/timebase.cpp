@@ -0,0 +1,70 @@
+/*
+ * Timebase Implementation
+ * 
+ * CPUサイクルカウンタの時刻基盤実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "timebase.hpp"
+#include "esp_freertos_hooks.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+
+namespace common {
+
+static const char* TAG = "common::Timebase";
+
+esp_err_t Timebase::initialize() {
+    if (initialized_) {
+        return ESP_OK;
+    }
+    setCpuMhz(esp_rom_get_cpu_ticks_per_us());
+    
+    for (BaseType_t core = 0; core < static_cast<BaseType_t>(CORE_COUNT); core++) {
+        esp_err_t ret = esp_register_freertos_tick_hook_for_cpu(&Timebase::onTick, core);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "コア%dのティックフック登録失敗: %s", static_cast<int>(core), esp_err_to_name(ret));
+            for (BaseType_t registered = 0; registered < core; registered++) {
+                esp_deregister_freertos_tick_hook_for_cpu(&Timebase::onTick, registered);
+            }
+            return ret;
+        }
+    }
+    initialized_ = true;
+    
+    ESP_LOGI(TAG, "初期化 %luMHz μs係数 %lu ns係数 %lu", static_cast<unsigned long>(cycles_per_us_), 
+             static_cast<unsigned long>(us_multiplier_), static_cast<unsigned long>(ns_multiplier_));
+    return ESP_OK;
+}
+
+void Timebase::setCpuMhz(uint32_t mhz) {
+    if (mhz == 0) {
+        return;
+    }
+    cycles_per_us_ = mhz;
+    us_multiplier_ = static_cast<uint32_t>(((1ull << 32) + mhz / 2) / mhz);
+    ns_multiplier_ = static_cast<uint32_t>(((1000ull << NS_SHIFT) + mhz / 2) / mhz);
+}
+
+void Deadline::sleep() const {
+    if (at_us_ == NEVER) {
+        return;
+    }
+    const bool can_block = !xPortInIsrContext() && xTaskGetSchedulerState() == taskSCHEDULER_RUNNING;
+    if (can_block) {
+        // ティックの境界からの起床になるため、1ティック分を残して眠る
+        const int64_t tick_us = 1000000 / configTICK_RATE_HZ;
+        const int64_t remaining = remainingUs();
+        if (remaining > 2 * tick_us) {
+            vTaskDelay(static_cast<TickType_t>(remaining / tick_us - 1));
+        }
+    }
+    while (!expired()) {
+    }
+}
+
+} // namespace common
@@ -0,0 +1,230 @@
+/*
+ * ESP-NOW RC Receiver
+ * 
+ * ESP-NOWによる低遅延リモコン受信
+ * Wi-Fiコールバック内でスティックパケットをデコードし、
+ * ロックフリーの単一スロットメールボックス経由で制御タスクへ渡す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ESPNOW_RC_HPP
+#define ESPNOW_RC_HPP
+
+#include "mailbox.hpp"
+#include "esp_err.h"
+#include "esp_now.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace communication {
+
+/**
+ * @brief ESP-NOWリモコン受信クラス
+ * 
+ * ESP-NOWの受信コールバックは1つしか登録できないため、同時に有効なインスタンスは1つ。
+ * メールボックスはシーケンスロックで、書き込み側（Wi-Fiタスク）は待たず、
+ * 読み出し側（制御タスク）は常に最新の1パケットを取得する
+ */
+class EspNowRc {
+public:
+    static constexpr uint8_t PACKET_MAGIC = 0x5F;       // パケット識別子
+    static constexpr int16_t STICK_SCALE = 1000;        // スティック値のフルスケール
+    
+    /**
+     * @brief スティックパケット（送信機と共通の無線フォーマット）
+     */
+#pragma pack(push, 1)
+    struct StickPacket {
+        uint8_t magic;              // PACKET_MAGIC
+        uint8_t sequence;           // シーケンス番号
+        int16_t throttle;           // スロットル（0〜STICK_SCALE）
+        int16_t roll;               // ロール（-STICK_SCALE〜STICK_SCALE）
+        int16_t pitch;              // ピッチ（-STICK_SCALE〜STICK_SCALE）
+        int16_t yaw;                // ヨー（-STICK_SCALE〜STICK_SCALE）
+        uint16_t buttons;           // ボタンビット
+        uint16_t crc;               // magicからbuttonsまでのCRC16
+    };
+#pragma pack(pop)
+    
+    /**
+     * @brief デコード済みリモコン指令
+     */
+    struct RcCommand {
+        float throttle;             // スロットル（0.0〜1.0）
+        float roll;                 // ロール（-1.0〜1.0）
+        float pitch;                // ピッチ（-1.0〜1.0）
+        float yaw;                  // ヨー（-1.0〜1.0）
+        uint16_t buttons;           // ボタンビット
+        uint8_t sequence;           // シーケンス番号
+        int8_t rssi;                // 受信強度（dBm）
+        int64_t receive_time_us;    // 受信時刻（μs）
+    };
+    
+    /**
+     * @brief 受信設定構造体
+     */
+    struct Config {
+        uint8_t channel;                // Wi-Fiチャンネル
+        uint32_t failsafe_timeout_us;   // フェイルセーフ判定時間（μs）
+        bool init_wifi;                 // Wi-Fi（STA、省電力無効）を本クラスで初期化する
+        bool bind_first_sender;         // 最初の送信元にバインドし他を無視する
+        
+        Config()
+            : channel(1)
+            , failsafe_timeout_us(200000)   // 200ms
+            , init_wifi(true)
+            , bind_first_sender(true) {}
+    };
+    
+    /**
+     * @brief リンク統計構造体
+     */
+    struct LinkStats {
+        uint32_t received;              // 正常受信数
+        uint32_t invalid;               // 不正パケット数（長さ・CRC・識別子）
+        uint32_t foreign;               // バインド外送信元からの受信数
+        uint32_t lost;                  // シーケンス欠落数
+        uint32_t failsafe_events;       // フェイルセーフ突入回数
+        uint32_t max_interval_us;       // 最大受信間隔（μs）
+        uint32_t max_latency_us;        // 受信から読み出しまでの最大遅延（μs）
+        uint32_t avg_latency_us;        // 受信から読み出しまでの平均遅延（μs、指数移動平均）
+        int8_t rssi;                    // 最新の受信強度（dBm）
+    };
+    
+    /**
+     * @brief コンストラクタ
+     * @param config 受信設定
+     */
+    explicit EspNowRc(const Config& config = Config());
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~EspNowRc();
+    
+    /**
+     * @brief 受信開始
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t begin();
+    
+    /**
+     * @brief 受信停止
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t end();
+    
+    /**
+     * @brief 受信時に通知するタスク設定
+     * 
+     * 受信ごとにxTaskNotifyGive()するため、制御タスクは周期待ちせず即座に起床できる
+     * @param task 通知先タスク（nullptrで通知なし）
+     */
+    void setNotifyTask(TaskHandle_t task) { notify_task_.store(task, std::memory_order_release); }
+    
+    /**
+     * @brief 最新指令取得（制御タスクから呼び出す）
+     * @param command 格納先
+     * @param now_us 現在時刻（μs）
+     * @return esp_err_t ESP_OK、ESP_ERR_NOT_FOUND（未受信）、ESP_ERR_TIMEOUT（フェイルセーフ、指令は中立値）
+     */
+    esp_err_t read(RcCommand& command, int64_t now_us);
+    
+    /**
+     * @brief フェイルセーフ状態確認
+     * @param now_us 現在時刻（μs）
+     * @return bool フェイルセーフ中ならtrue
+     */
+    bool isFailsafe(int64_t now_us) const;
+    
+    /**
+     * @brief リンク統計取得
+     * @return LinkStats リンク統計
+     */
+    LinkStats getStats() const;
+    
+    /**
+     * @brief リンク統計リセット
+     */
+    void resetStats();
+    
+    /**
+     * @brief スティックパケット作成（送信機側・テスト用）
+     * @param packet 格納先
+     * @param sequence シーケンス番号
+     * @param throttle スロットル（0.0〜1.0）
+     * @param roll ロール（-1.0〜1.0）
+     * @param pitch ピッチ（-1.0〜1.0）
+     * @param yaw ヨー（-1.0〜1.0）
+     * @param buttons ボタンビット
+     */
+    static void encodePacket(StickPacket& packet, uint8_t sequence, float throttle, float roll,  
+                             float pitch, float yaw, uint16_t buttons);
+    
+private:
+    /**
+     * @brief ESP-NOW受信コールバック（Wi-Fiタスクで実行）
+     */
+    static void onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int length);
+    
+    /**
+     * @brief 受信パケット処理
+     * @param info 受信情報
+     * @param data 受信データ
+     * @param length データ長
+     */
+    void handlePacket(const esp_now_recv_info_t* info, const uint8_t* data, int length);
+    
+    /**
+     * @brief スティック値変換
+     */
+    static float normalize(int16_t value, float min_value);
+    
+    /**
+     * @brief Wi-Fi初期化
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t initWifi();
+    
+    static std::atomic<EspNowRc*> instance_;        // 受信コールバックの配送先
+    
+    Config config_;                                 // 受信設定
+    bool started_;                                  // 受信開始済みフラグ
+    bool wifi_initialized_;                         // 本クラスでWi-Fiを初期化したか
+    
+    common::Mailbox<RcCommand> mailbox_;            // 最新指令（書き込みはWi-Fiタスクのみ）
+    
+    std::atomic<TaskHandle_t> notify_task_;         // 受信通知先タスク
+    std::atomic<int64_t> last_receive_us_;          // 最終受信時刻（μs、0=未受信）
+    
+    // Wi-Fiタスク側のみが更新する状態
+    std::array<uint8_t, ESP_NOW_ETH_ALEN> bound_mac_;   // バインド済み送信元
+    bool bound_;                                        // バインド済みフラグ
+    uint8_t last_sequence_;                             // 前回シーケンス番号
+    
+    // 統計（読み出しは任意タスク）
+    std::atomic<uint32_t> stat_received_;
+    std::atomic<uint32_t> stat_invalid_;
+    std::atomic<uint32_t> stat_foreign_;
+    std::atomic<uint32_t> stat_lost_;
+    std::atomic<uint32_t> stat_failsafe_events_;
+    std::atomic<uint32_t> stat_max_interval_us_;
+    std::atomic<uint32_t> stat_max_latency_us_;
+    std::atomic<uint32_t> stat_avg_latency_us_;
+    std::atomic<int8_t> stat_rssi_;
+    
+    // 制御タスク側のみが更新する状態
+    uint32_t consumed_sequence_;                    // 前回読み出したメールボックス版数
+    bool in_failsafe_;                              // フェイルセーフ中フラグ
+};
+
+} // namespace communication
+
+#endif // ESPNOW_RC_HPP
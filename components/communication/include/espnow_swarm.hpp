@@ -0,0 +1,286 @@
+/*
+ * ESP-NOW Swarm
+ * 
+ * ESP-NOWブロードキャストによる複数機体の同時制御
+ * 地上ノードは全機体の目標値を1パケットに詰めて毎周期1回だけ送信し、
+ * 各機体は自機のスロットだけを取り出す。時刻同期ビーコンで地上の時刻に合わせて動作する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ESPNOW_SWARM_HPP
+#define ESPNOW_SWARM_HPP
+
+#include "mailbox.hpp"
+#include "swarm_protocol.hpp"
+#include "esp_err.h"
+#include "esp_now.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace communication {
+
+/**
+ * @brief スウォーム受信クラス（機体側）
+ * 
+ * ESP-NOWの受信コールバックは1つしか登録できないため、EspNowRcとは同時に使えない。
+ * 受信コールバック（Wi-Fiタスク）ではヘッダ検証と自機スロットの展開だけを行い、
+ * メールボックス経由で制御タスクへ渡す。
+ * 時刻同期は直近のビーコンの「受信時刻 - 送信時刻」の最小値（伝送遅延が最も小さいもの）を
+ * 地上との時刻差とする
+ */
+class SwarmReceiver {
+public:
+    static constexpr size_t SYNC_WINDOW = 8;        // 時刻差の最小値をとるビーコン数
+    
+    /**
+     * @brief デコード済みスウォーム指令
+     */
+    struct SwarmCommand {
+        SwarmSetpoint setpoint;     // 自機の目標値
+        int64_t apply_time_us;      // 適用時刻（自機の時刻、μs、0=即時）
+        int64_t receive_time_us;    // 受信時刻（μs）
+        uint8_t sequence;           // シーケンス番号
+        bool synchronized;          // 時刻同期済み（apply_time_usが有効）
+    };
+    
+    /**
+     * @brief 受信設定構造体
+     */
+    struct Config {
+        uint8_t slot;                   // 自機のスロット番号
+        uint8_t channel;                // Wi-Fiチャンネル
+        uint32_t failsafe_timeout_us;   // フェイルセーフ判定時間（μs）
+        uint32_t sync_timeout_us;       // ビーコン途絶で同期を無効にする時間（μs）
+        bool init_wifi;                 // Wi-Fi（STA、省電力無効）を本クラスで初期化する
+        
+        Config()
+            : slot(0)
+            , channel(1)
+            , failsafe_timeout_us(300000)   // 300ms
+            , sync_timeout_us(3000000)      // 3s
+            , init_wifi(true) {}
+    };
+    
+    /**
+     * @brief リンク統計構造体
+     */
+    struct LinkStats {
+        uint32_t received;          // 自機宛て目標値の受信数
+        uint32_t unaddressed;       // 自機のスロットを含まないフレーム数
+        uint32_t invalid;           // 不正フレーム数（長さ・CRC・識別子）
+        uint32_t lost;              // シーケンス欠落数
+        uint32_t beacons;           // ビーコン受信数
+        int32_t clock_offset_us;    // 地上との時刻差（自機 - 地上、下位32bit）
+    };
+    
+    /**
+     * @brief コンストラクタ
+     * @param config 受信設定
+     */
+    explicit SwarmReceiver(const Config& config = Config());
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~SwarmReceiver();
+    
+    /**
+     * @brief 受信開始
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t begin();
+    
+    /**
+     * @brief 受信停止
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t end();
+    
+    /**
+     * @brief 受信時に通知するタスク設定
+     * @param task 通知先タスク（nullptrで通知なし）
+     */
+    void setNotifyTask(TaskHandle_t task) { notify_task_.store(task, std::memory_order_release); }
+    
+    /**
+     * @brief 最新指令取得（制御タスクから呼び出す）
+     * @param command 格納先
+     * @param now_us 現在時刻（μs）
+     * @return esp_err_t ESP_OK、ESP_ERR_NOT_FOUND（未受信）、ESP_ERR_TIMEOUT（フェイルセーフ、指令はHOLD）
+     */
+    esp_err_t read(SwarmCommand& command, int64_t now_us);
+    
+    /**
+     * @brief 時刻同期状態の確認
+     * @param now_us 現在時刻（μs）
+     * @return bool 有効な時刻差がある場合true
+     */
+    bool isSynchronized(int64_t now_us) const;
+    
+    /**
+     * @brief 地上の時刻（下位32bit）を自機の時刻へ変換
+     * @param ground_time_us 地上の時刻（下位32bit）
+     * @param now_us 現在時刻（μs、32bitの折り返しの判定に使う）
+     * @return int64_t 自機の時刻（μs）
+     */
+    int64_t toLocalTime(uint32_t ground_time_us, int64_t now_us) const;
+    
+    /**
+     * @brief リンク統計取得
+     * @return LinkStats リンク統計
+     */
+    LinkStats getStats() const;
+    
+    /**
+     * @brief 受信フレームの処理（受信コールバックから呼ばれる、リプレイ・テスト用に公開）
+     * @param data 受信データ
+     * @param length データ長
+     * @param now_us 受信時刻（μs）
+     */
+    void handleFrame(const uint8_t* data, int length, int64_t now_us);
+    
+private:
+    /**
+     * @brief ESP-NOW受信コールバック（Wi-Fiタスクで実行）
+     */
+    static void onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int length);
+    
+    /**
+     * @brief ビーコンによる時刻差の更新
+     */
+    void updateSync(uint32_t send_time_us, int64_t now_us);
+    
+    static std::atomic<SwarmReceiver*> instance_;   // 受信コールバックの配送先
+    
+    Config config_;                                 // 受信設定
+    bool started_;                                  // 受信開始済みフラグ
+    bool wifi_initialized_;                         // 本クラスでWi-Fiを初期化したか
+    
+    common::Mailbox<SwarmCommand> mailbox_;         // 最新指令（書き込みはWi-Fiタスクのみ）
+    
+    std::atomic<TaskHandle_t> notify_task_;         // 受信通知先タスク
+    std::atomic<int64_t> last_receive_us_;          // 最終受信時刻（μs、0=未受信）
+    std::atomic<int64_t> last_beacon_us_;           // 最終ビーコン受信時刻（μs、0=未受信）
+    std::atomic<int32_t> clock_offset_us_;          // 地上との時刻差（自機 - 地上、下位32bit）
+    
+    // Wi-Fiタスク側のみが更新する状態
+    std::array<int32_t, SYNC_WINDOW> sync_samples_; // ビーコン毎の時刻差
+    size_t sync_index_;                             // 次に書き込む位置
+    size_t sync_count_;                             // 有効な時刻差の数
+    uint8_t last_sequence_;                         // 前回シーケンス番号
+    bool sequence_valid_;                           // 前回シーケンス番号が有効
+    
+    // 統計（読み出しは任意タスク）
+    std::atomic<uint32_t> stat_received_;
+    std::atomic<uint32_t> stat_unaddressed_;
+    std::atomic<uint32_t> stat_invalid_;
+    std::atomic<uint32_t> stat_lost_;
+    std::atomic<uint32_t> stat_beacons_;
+};
+
+/**
+ * @brief スウォーム送信クラス（地上ノード側）
+ * 
+ * 目標値はスロット毎に保持し、sendSetpoints() で使用中の最大スロットまでを
+ * 1フレーム（SWARM_SLOTS_PER_FRAMEを超える場合は必要な数だけ）にまとめてブロードキャストする。
+ * 機体数Nに対し、ユニキャストN回の代わりに毎周期1回の送信で済む
+ */
+class SwarmBroadcaster {
+public:
+    static constexpr size_t MAX_SLOTS = 64;         // 保持できるスロット数
+    
+    /**
+     * @brief 送信設定構造体
+     */
+    struct Config {
+        uint8_t channel;                // Wi-Fiチャンネル
+        bool init_wifi;                 // Wi-Fi（STA、省電力無効）を本クラスで初期化する
+        
+        Config()
+            : channel(1)
+            , init_wifi(true) {}
+    };
+    
+    /**
+     * @brief 送信統計構造体
+     */
+    struct Stats {
+        uint32_t frames;            // 送信フレーム数
+        uint32_t beacons;           // 送信ビーコン数
+        uint32_t errors;            // 送信失敗数
+    };
+    
+    /**
+     * @brief コンストラクタ
+     * @param config 送信設定
+     */
+    explicit SwarmBroadcaster(const Config& config = Config());
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~SwarmBroadcaster();
+    
+    /**
+     * @brief 送信開始（ブロードキャストピアの登録）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t begin();
+    
+    /**
+     * @brief 送信停止
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t end();
+    
+    /**
+     * @brief スロットの目標値設定（次のsendSetpoints()で送信）
+     * @param slot スロット番号
+     * @param setpoint 目標値（action=NONEでスロット未使用）
+     * @return esp_err_t ESP_OK、ESP_ERR_INVALID_ARG（スロット番号超過）
+     */
+    esp_err_t setSetpoint(uint8_t slot, const SwarmSetpoint& setpoint);
+    
+    /**
+     * @brief 全スロットの目標値の送信（毎周期1回）
+     * @param apply_time_us 適用時刻（地上の時刻、0で受信時に即適用）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t sendSetpoints(uint32_t apply_time_us = 0);
+    
+    /**
+     * @brief 時刻同期ビーコンの送信（目標値より低い周期で良い）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t sendBeacon();
+    
+    /**
+     * @brief 送信統計取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+private:
+    /**
+     * @brief フレームのブロードキャスト
+     */
+    esp_err_t broadcast(const uint8_t* frame, size_t length);
+    
+    Config config_;                                 // 送信設定
+    bool started_;                                  // 送信開始済みフラグ
+    bool wifi_initialized_;                         // 本クラスでWi-Fiを初期化したか
+    std::array<SwarmSetpoint, MAX_SLOTS> slots_;    // スロット毎の目標値
+    size_t slot_end_;                               // 使用中スロットの末尾+1
+    uint8_t sequence_;                              // シーケンス番号
+    Stats stats_;                                   // 送信統計
+};
+
+} // namespace communication
+
+#endif // ESPNOW_SWARM_HPP
@@ -0,0 +1,128 @@
+/*
+ * Log Download
+ * 
+ * ブラックボックスログ（logsパーティション）のストリーミングダウンロード
+ * パーティションを小さなチャンクで読みながら送信路へ直接流し、ログ全体をRAMに置かない
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef LOG_DOWNLOAD_HPP
+#define LOG_DOWNLOAD_HPP
+
+#include "partition_log.hpp"
+#include "tcp_transport.hpp"
+#include "telemetry_link.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+#pragma pack(push, 1)
+
+/**
+ * @brief ダウンロード要求（ホスト → 機体）
+ */
+struct LogDownloadRequest {
+    static constexpr uint32_t MAGIC = 0x51584242;   // "BBXQ"
+    
+    uint32_t magic;             // MAGIC
+    uint32_t start_sequence;    // この通し番号以降のレコードを送る（再開時は前回の next_sequence）
+    uint32_t session;           // セッション番号（0で全セッション）
+    uint32_t max_records;       // 送る最大レコード数（0で制限なし）
+};
+
+/**
+ * @brief レコードの前に付けるチャンクヘッダ（機体 → ホスト）
+ * 
+ * length バイトのレコード（PartitionLogHeader + ペイロード）が続く。
+ * ホストはPartitionLogHeaderのCRCで検証し、壊れていれば sequence から再要求する
+ */
+struct LogDownloadChunk {
+    static constexpr uint32_t MAGIC = 0x44584242;   // "BBXD"
+    static constexpr uint16_t FLAG_END = 1 << 0;    // 終端（length=0、sequenceは次に要求する通し番号）
+    
+    uint32_t magic;             // MAGIC
+    uint32_t sequence;          // レコードの通し番号
+    uint16_t length;            // 続くレコードのバイト数
+    uint16_t flags;             // フラグ
+};
+
+#pragma pack(pop)
+
+/**
+ * @brief ログダウンロードクラス
+ * 
+ * 古いレコードから順に、チャンクヘッダ + レコードを CHUNK_SIZE ずつ読んでは送る。
+ * 送信路のsend()がブロックする（UARTの送信リング・TCPのウィンドウ）ことで流量制御され、
+ * 使うRAMはチャンクバッファのみ。記録中でも読めるが、書き込み位置付近のレコードは
+ * 消去と重なると送られない（終端のnext_sequenceから再要求すれば取りこぼさない）。
+ * UARTで使う場合はTelemetryLinkの周期送信を止めておく
+ */
+class LogDownload {
+public:
+    static constexpr size_t CHUNK_SIZE = 1024;      // 1回の読み出し・送信サイズ
+    static constexpr uint16_t DEFAULT_TCP_PORT = 3334;  // TCPの既定ポート
+    
+    /**
+     * @brief 転送統計構造体
+     */
+    struct Stats {
+        uint32_t records;               // 送ったレコード数
+        uint32_t bytes;                 // 送ったバイト数（ヘッダ含む）
+        uint32_t skipped;               // 読めなかったセクタ数（空き・途切れ）
+        uint32_t elapsed_ms;            // 転送時間（ms）
+        uint32_t next_sequence;         // 再開時に要求する通し番号
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param log 開いた追記ログ
+     */
+    explicit LogDownload(const storage::PartitionLog& log);
+    
+    /**
+     * @brief 転送（呼び出し側のタスクで最後まで送る）
+     * @param transport 送信路
+     * @param request 要求
+     * @return esp_err_t 送信失敗の場合そのエラー（統計のnext_sequenceから再開できる）
+     */
+    esp_err_t run(Transport& transport, const LogDownloadRequest& request);
+    
+    /**
+     * @brief TCPで1回分の要求を受け付けて転送
+     * @param tcp 待ち受け中のTCP送信路
+     * @param timeout 接続・要求の待ち時間
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t serveTcp(TcpTransport& tcp, TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 前回の転送統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 前回の転送統計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    const storage::PartitionLog& log_;      // 追記ログ
+    Stats stats_;                           // 転送統計
+    uint8_t chunk_[CHUNK_SIZE];             // チャンクバッファ
+    
+    /**
+     * @brief 1レコード分の送信
+     */
+    esp_err_t sendRecord(Transport& transport, uint32_t sector, const storage::PartitionLogHeader& header);
+};
+
+} // namespace communication
+
+#endif // LOG_DOWNLOAD_HPP
@@ -0,0 +1,164 @@
+/*
+ * Mocap Receiver
+ * 
+ * Wi-Fi UDPによるモーションキャプチャの外部姿勢入力
+ * 撮像時刻を時刻同期で自機の時刻へ変換し、確保済みのキューで推定タスクへ渡す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MOCAP_RECEIVER_HPP
+#define MOCAP_RECEIVER_HPP
+
+#include "ring_buffer.hpp"
+#include "synced_clock.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_err.h"
+#include "lwip/ip_addr.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct pbuf;
+struct udp_pcb;
+
+namespace communication {
+
+/**
+ * @brief 受信した外部姿勢（自機の時刻）
+ */
+struct MocapPose {
+    int64_t timestamp_us;       // 撮像時刻（自機の時刻、μs）
+    float position[3];          // 位置 X, Y, Z（m、EKFの基準座標）
+    float yaw;                  // ヨー角（rad）
+    bool has_yaw;               // yawが有効
+    bool synchronized;          // 時刻同期で撮像時刻を変換した（falseは受信時刻 - 既定遅延）
+    uint32_t sequence;          // 送信番号
+};
+
+/**
+ * @brief モーションキャプチャ受信クラス
+ * 
+ * 受信コールバック（tcpipスレッド）はpbufのチェーンをそのままFrameParserへ流し、
+ * 姿勢メッセージを単一生産者/単一消費者のキューへ積むだけで、メモリ確保もロックもしない。
+ * 推定タスクは毎周期 pop() で全て取り出し、MeasurementAligner へ積む
+ * （バーストで届いても全サンプルを時刻順に補間に使える。キューが満杯なら新しい方を捨てる）。
+ * 撮像時刻は common::SyncedClock で自機の時刻へ戻す。未同期・撮像時刻なしの場合は
+ * 受信時刻から既定の遅延を引く。
+ * UARTのテレメトリリンクで受ける場合は handleFrame() を受信タスクから呼ぶ（UDPと同時には使わない）
+ */
+class MocapReceiver {
+public:
+    static constexpr size_t QUEUE_SIZE = 16;        // 受信キューの容量（240Hzで66ms）
+    
+    /**
+     * @brief 受信設定構造体
+     */
+    struct Config {
+        uint16_t port = 14561;                      // 待ち受けポート
+        uint32_t default_latency_us = 15000;        // 撮像時刻が使えない場合の遅延（μs）
+        uint32_t max_age_us = 200000;               // これより古い撮像時刻の姿勢は捨てる（μs）
+    };
+    
+    /**
+     * @brief 受信統計構造体
+     */
+    struct Stats {
+        uint32_t poses;             // キューへ積んだ姿勢数
+        uint32_t unsynchronized;    // 既定遅延で時刻を付けた姿勢数
+        uint32_t stale;             // 古すぎる・未来の撮像時刻で捨てた姿勢数
+        uint32_t overflows;         // キュー満杯で捨てた姿勢数
+        uint32_t lost;              // 送信番号の欠落数
+        uint32_t crc_errors;        // 受信フレームのCRCエラー数
+        int32_t last_latency_us;    // 直近の撮像から受信までの遅延（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param clock 撮像時刻の変換に使う同期時刻
+     */
+    explicit MocapReceiver(const common::SyncedClock& clock = common::SyncedClock::instance());
+    ~MocapReceiver();
+    
+    MocapReceiver(const MocapReceiver&) = delete;
+    MocapReceiver& operator=(const MocapReceiver&) = delete;
+    
+    /**
+     * @brief UDP受信開始
+     * @param config 受信設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief UDP受信開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief UDP受信停止
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 受信フレームの処理（UARTのテレメトリリンク用、姿勢以外は無視）
+     * @param frame 受信フレーム
+     * @param now_us 受信時刻（μs）
+     * @return bool 姿勢をキューへ積んだ場合true
+     */
+    bool handleFrame(const Frame& frame, int64_t now_us);
+    
+    /**
+     * @brief 姿勢の取り出し（推定タスク、待たない）
+     * @param pose 格納先
+     * @return bool 取り出せた場合true
+     */
+    bool pop(MocapPose& pose) { return queue_.pop(pose); }
+    
+    /**
+     * @brief 受信統計取得
+     * @return Stats 受信統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 受信コールバック（tcpipスレッド）
+     */
+    static void onReceive(void* arg, udp_pcb* pcb, pbuf* packet, const ip_addr_t* address, uint16_t port);
+    
+    /**
+     * @brief FrameParserのコールバック
+     */
+    static void onFrame(const Frame& frame, void* context);
+    
+    const common::SyncedClock& clock_;              // 撮像時刻の変換
+    Config config_;                                 // 受信設定
+    FrameParser parser_;                            // フレーム分割（生産者側のみ）
+    common::RingBuffer<MocapPose, QUEUE_SIZE> queue_;   // 推定タスクへのキュー
+    udp_pcb* pcb_;                                  // UDP制御ブロック（tcpipスレッドで操作）
+    int64_t receive_time_us_;                       // 処理中のデータグラムの受信時刻
+    uint32_t last_sequence_;                        // 前回の送信番号
+    bool sequence_valid_;                           // 前回の送信番号が有効
+    
+    std::atomic<uint32_t> stat_poses_;
+    std::atomic<uint32_t> stat_unsynchronized_;
+    std::atomic<uint32_t> stat_stale_;
+    std::atomic<uint32_t> stat_overflows_;
+    std::atomic<uint32_t> stat_lost_;
+    std::atomic<int32_t> stat_latency_us_;
+};
+
+} // namespace communication
+
+#endif // MOCAP_RECEIVER_HPP
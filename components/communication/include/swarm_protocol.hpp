@@ -0,0 +1,124 @@
+/*
+ * Swarm Protocol
+ * 
+ * 複数機体の目標値を1つのESP-NOWブロードキャストに詰めるスウォームフレーム定義
+ * 機体毎のスロットは7バイトのビットパックで、受信側は自機のスロットだけを取り出す
+ * 
+ * フレーム形式:
+ *   [MAGIC 0x5E][TYPE][SEQ][FIRST_SLOT][SLOT_COUNT][TIME_US (4 bytes)][SLOTS (7 bytes x SLOT_COUNT)][CRC16 L][CRC16 H]
+ *   CRCはMAGICからSLOTS末尾までのCRC-16/CCITT-FALSE
+ *   TIME_USはSETPOINTでは目標の適用時刻、BEACONでは送信時刻（どちらも地上の時刻、下位32bit）
+ * 
+ * スロットのビット配置（LSBから）:
+ *   north 14bit（符号付き、cm）/ east 14bit（符号付き、cm）/ altitude 12bit（上向き、cm）/
+ *   yaw 8bit（2π/256 rad）/ action 4bit / 予約 4bit
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SWARM_PROTOCOL_HPP
+#define SWARM_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+static constexpr uint8_t SWARM_MAGIC = 0x5E;                // フレーム識別子
+static constexpr size_t SWARM_HEADER_SIZE = 9;              // MAGIC + TYPE + SEQ + FIRST_SLOT + SLOT_COUNT + TIME_US
+static constexpr size_t SWARM_CRC_SIZE = 2;                 // CRC16
+static constexpr size_t SWARM_SLOT_SIZE = 7;                // 1機分のスロット長（56bit）
+static constexpr size_t SWARM_MAX_FRAME_SIZE = 250;         // ESP-NOWの最大ペイロード長
+static constexpr size_t SWARM_SLOTS_PER_FRAME = (SWARM_MAX_FRAME_SIZE - SWARM_HEADER_SIZE - SWARM_CRC_SIZE) / SWARM_SLOT_SIZE;
+
+/**
+ * @brief スウォームフレーム種別
+ */
+enum class SwarmFrameType : uint8_t {
+    SETPOINT = 0x01,            // 機体毎の目標値
+    BEACON = 0x02               // 時刻同期ビーコン（スロットなし）
+};
+
+/**
+ * @brief 機体への動作指令（4bit）
+ */
+enum class SwarmAction : uint8_t {
+    NONE = 0,                   // 指令なし（スロット未使用、受信側は無視する）
+    HOLD,                       // 現在位置で位置保持
+    GOTO,                       // 目標位置へ移動
+    TAKEOFF,                    // 目標高度へ離陸
+    LAND,                       // 着陸
+    DISARM                      // 緊急停止
+};
+
+/**
+ * @brief 1機分の目標値（座標はNED、m）
+ */
+struct SwarmSetpoint {
+    float north;                // 北（m、±81.91）
+    float east;                 // 東（m、±81.91）
+    float altitude;             // 高度（m、上向き、0〜40.95）
+    float yaw;                  // ヨー角（rad）
+    SwarmAction action;         // 動作指令
+};
+
+/**
+ * @brief 受信フレームのヘッダ
+ */
+struct SwarmHeader {
+    SwarmFrameType type;        // フレーム種別
+    uint8_t sequence;           // シーケンス番号
+    uint8_t first_slot;         // 先頭スロット番号
+    uint8_t slot_count;         // スロット数
+    uint32_t time_us;           // 適用時刻（SETPOINT）・送信時刻（BEACON）、地上の時刻の下位32bit
+};
+
+/**
+ * @brief 目標値フレームのエンコード
+ * @param buffer 出力先（SWARM_MAX_FRAME_SIZE以上を推奨）
+ * @param capacity 出力先サイズ
+ * @param sequence シーケンス番号
+ * @param first_slot 先頭スロット番号
+ * @param setpoints first_slotからの目標値
+ * @param count 目標値の数（SWARM_SLOTS_PER_FRAME以下）
+ * @param apply_time_us 適用時刻（地上の時刻、0で受信時に即適用）
+ * @return size_t フレーム長（容量不足・数超過時は0）
+ */
+size_t encodeSwarmSetpoints(uint8_t* buffer, size_t capacity, uint8_t sequence, uint8_t first_slot, 
+                            const SwarmSetpoint* setpoints, size_t count, uint32_t apply_time_us);
+
+/**
+ * @brief 時刻同期ビーコンのエンコード
+ * @param buffer 出力先
+ * @param capacity 出力先サイズ
+ * @param sequence シーケンス番号
+ * @param send_time_us 送信時刻（地上の時刻）
+ * @return size_t フレーム長（容量不足時は0）
+ */
+size_t encodeSwarmBeacon(uint8_t* buffer, size_t capacity, uint8_t sequence, uint32_t send_time_us);
+
+/**
+ * @brief フレームの検証とヘッダのデコード（識別子・長さ・CRC）
+ * @param data 受信データ
+ * @param length データ長
+ * @param header ヘッダの格納先
+ * @return bool 正しいフレームの場合true
+ */
+bool decodeSwarmHeader(const uint8_t* data, size_t length, SwarmHeader& header);
+
+/**
+ * @brief 自機のスロットの取り出し（decodeSwarmHeader()で検証済みのフレームに使う）
+ * @param data 受信データ
+ * @param header デコード済みヘッダ
+ * @param slot 自機のスロット番号
+ * @param setpoint 目標値の格納先
+ * @return bool フレームが自機のスロットを含み、指令がNONEでない場合true
+ */
+bool extractSwarmSlot(const uint8_t* data, const SwarmHeader& header, uint8_t slot, SwarmSetpoint& setpoint);
+
+} // namespace communication
+
+#endif // SWARM_PROTOCOL_HPP
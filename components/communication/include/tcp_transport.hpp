@@ -0,0 +1,92 @@
+/*
+ * TCP Transport
+ * 
+ * TCP送信路（Wi-Fi経由のログダウンロード等の一括転送用）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TCP_TRANSPORT_HPP
+#define TCP_TRANSPORT_HPP
+
+#include "telemetry_link.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+/**
+ * @brief TCP送信路（1接続のみのサーバー）
+ * 
+ * listen()で待ち受け、accept()で1つの接続を受け付ける。
+ * send()は全バイトを送り終えるまでブロックするため、TCPのウィンドウがそのまま流量制御になる
+ * （送信バッファが空くまで呼び出し側のタスクが待つ）。
+ * Wi-Fi（STAまたはAP）とネットワークインタフェースは呼び出し側で起動しておく
+ */
+class TcpTransport : public Transport {
+public:
+    TcpTransport();
+    ~TcpTransport() override;
+    
+    TcpTransport(const TcpTransport&) = delete;
+    TcpTransport& operator=(const TcpTransport&) = delete;
+    
+    /**
+     * @brief 待ち受け開始
+     * @param port ポート番号
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t listen(uint16_t port);
+    
+    /**
+     * @brief 接続の受け付け（前の接続は閉じる）
+     * @param timeout 待ち時間
+     * @return esp_err_t 接続がなかった場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t accept(TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 送信（全バイトを送るまでブロック）
+     * @param data 送信データ
+     * @param length データ長
+     * @return esp_err_t 切断された場合ESP_ERR_INVALID_STATE
+     */
+    esp_err_t send(const void* data, size_t length) override;
+    
+    /**
+     * @brief 受信（lengthバイト揃うまで、またはタイムアウトまで待つ）
+     * @param buffer 格納先
+     * @param length バイト数
+     * @param timeout 待ち時間
+     * @return esp_err_t 揃わなかった場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t receive(void* buffer, size_t length, TickType_t timeout);
+    
+    /**
+     * @brief 接続を閉じる（待ち受けは続ける）
+     */
+    void disconnect();
+    
+    /**
+     * @brief 待ち受け・接続を閉じる
+     */
+    void close();
+    
+    /**
+     * @brief 接続中か
+     */
+    bool isConnected() const { return client_ >= 0; }
+    
+private:
+    int listener_;          // 待ち受けソケット
+    int client_;            // 接続中のソケット（-1でなし）
+};
+
+} // namespace communication
+
+#endif // TCP_TRANSPORT_HPP
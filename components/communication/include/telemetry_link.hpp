@@ -0,0 +1,255 @@
+/*
+ * Telemetry Link
+ * 
+ * テレメトリリンク（送信レートスケジューリングと受信処理）
+ * 通信路（UART、将来的にESP-NOW）をTransportで抽象化する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TELEMETRY_LINK_HPP
+#define TELEMETRY_LINK_HPP
+
+#include "telemetry_protocol.hpp"
+#include "uart_hal.hpp"
+#include "esp_err.h"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace communication {
+
+/**
+ * @brief 送信路抽象クラス
+ */
+class Transport {
+public:
+    virtual ~Transport() = default;
+    
+    /**
+     * @brief フレーム送信
+     * @param data 送信データ
+     * @param length データ長
+     * @return esp_err_t エラーコード
+     */
+    virtual esp_err_t send(const void* data, size_t length) = 0;
+};
+
+/**
+ * @brief UART送信路
+ */
+class UartTransport : public Transport {
+public:
+    /**
+     * @brief コンストラクタ
+     * @param uart 初期化済みのUART HAL
+     */
+    explicit UartTransport(std::shared_ptr<hal::UartHal> uart);
+    
+    esp_err_t send(const void* data, size_t length) override;
+    
+    /**
+     * @brief UART HAL取得
+     * @return std::shared_ptr<hal::UartHal> UART HAL
+     */
+    std::shared_ptr<hal::UartHal> getUart() const { return uart_; }
+    
+private:
+    std::shared_ptr<hal::UartHal> uart_;    // UART HAL
+};
+
+/**
+ * @brief テレメトリリンククラス
+ * 
+ * 登録したストリームを指定レートで送信する。
+ * 帯域はバイト単位のトークンバケットで管理し、送信可能なストリームのうち
+ * 送信予定時刻が最も古いものから順に送るため、高レートの姿勢メッセージが
+ * 低レートのステータスメッセージを飢餓させない
+ */
+class TelemetryLink {
+public:
+    static constexpr size_t MAX_STREAMS = 8;            // 最大ストリーム数
+    
+    /**
+     * @brief ストリームのペイロード生成関数型
+     * @param buffer ペイロード出力先（MAX_PAYLOAD_SIZE）
+     * @param capacity 出力先サイズ
+     * @param context 登録時の引数
+     * @return size_t ペイロード長（0で今回は送信しない）
+     */
+    using FillFunction = size_t (*)(uint8_t* buffer, size_t capacity, void* context);
+    
+    /**
+     * @brief 受信フレームコールバック関数型
+     */
+    using RxHandler = FrameParser::FrameHandler;
+    
+    /**
+     * @brief リンク設定構造体
+     */
+    struct Config {
+        uint32_t link_bytes_per_sec;    // リンク帯域（バイト/秒、UARTなら baud/10）
+        uint32_t burst_bytes;           // トークンバケット容量（バイト）
+        
+        Config()
+            : link_bytes_per_sec(92160)     // 921600bps
+            , burst_bytes(512) {}
+    };
+    
+    /**
+     * @brief ストリーム統計構造体
+     */
+    struct StreamStats {
+        uint32_t sent;                  // 送信数
+        uint32_t skipped;               // 帯域不足で周期を飛ばした回数
+        uint32_t send_errors;           // 送信エラー数
+    };
+    
+    /**
+     * @brief コンストラクタ
+     * @param transport 送信路
+     * @param config リンク設定
+     */
+    explicit TelemetryLink(std::shared_ptr<Transport> transport, const Config& config = Config());
+    
+    /**
+     * @brief メッセージ即時送信
+     * @tparam T メッセージ構造体
+     * @param message メッセージ
+     * @return esp_err_t エラーコード
+     */
+    template<typename T>
+    esp_err_t send(const T& message) {
+        static_assert(sizeof(T) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+        return sendRaw(T::ID, &message, sizeof(T));
+    }
+    
+    /**
+     * @brief ペイロード即時送信
+     * @param id メッセージID
+     * @param payload ペイロード
+     * @param length ペイロード長
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t sendRaw(MessageId id, const void* payload, size_t length);
+    
+    /**
+     * @brief 周期送信ストリーム登録
+     * @param id メッセージID
+     * @param rate_hz 送信レート（Hz）
+     * @param fill ペイロード生成関数
+     * @param context 生成関数の引数
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t registerStream(MessageId id, float rate_hz, FillFunction fill, void* context);
+    
+    /**
+     * @brief ストリームの送信レート変更
+     * @param id メッセージID
+     * @param rate_hz 送信レート（Hz、0で停止）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t setStreamRate(MessageId id, float rate_hz);
+    
+    /**
+     * @brief 周期送信処理（送信タスクから定期的に呼び出す）
+     * @param now_us 現在時刻（μs）
+     * @return size_t 今回送信したフレーム数
+     */
+    size_t update(int64_t now_us);
+    
+    /**
+     * @brief 受信コールバック設定
+     * @param handler 受信フレームコールバック
+     * @param context コールバック引数
+     */
+    void setRxHandler(RxHandler handler, void* context);
+    
+    /**
+     * @brief 受信データ処理
+     * @param data 受信データ
+     * @param length データ長
+     */
+    void processRx(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief UART受信リングから受信処理（コピーなし）
+     * @param uart enableRxRing()済みのUART HAL
+     * @return size_t 処理したバイト数
+     */
+    size_t processRx(hal::UartHal& uart);
+    
+    /**
+     * @brief ストリーム統計取得
+     * @param id メッセージID
+     * @param stats 統計格納先
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t getStreamStats(MessageId id, StreamStats& stats) const;
+    
+    /**
+     * @brief 受信統計取得
+     * @return FrameParser::Stats 受信統計
+     */
+    FrameParser::Stats getRxStats() const { return parser_.getStats(); }
+    
+private:
+    /**
+     * @brief ストリーム情報構造体
+     */
+    struct Stream {
+        MessageId id;                   // メッセージID
+        uint32_t period_us;             // 送信周期（μs、0で停止）
+        int64_t next_due_us;            // 次回送信予定時刻（μs）
+        FillFunction fill;              // ペイロード生成関数
+        void* context;                  // 生成関数の引数
+        StreamStats stats;              // ストリーム統計
+        bool active;                    // 登録済みフラグ
+    };
+    
+    /**
+     * @brief 受信フレーム中継
+     */
+    static void onFrame(const Frame& frame, void* context);
+    
+    /**
+     * @brief トークン補充
+     * @param now_us 現在時刻（μs）
+     */
+    void refillTokens(int64_t now_us);
+    
+    /**
+     * @brief ストリーム検索
+     * @param id メッセージID
+     * @return Stream* ストリーム（未登録時nullptr）
+     */
+    Stream* findStream(MessageId id);
+    
+    /**
+     * @brief 周期をμsへ変換
+     * @param rate_hz 送信レート（Hz）
+     * @return uint32_t 送信周期（μs、0で停止）
+     */
+    static uint32_t rateToPeriod(float rate_hz);
+    
+    std::shared_ptr<Transport> transport_;      // 送信路
+    Config config_;                             // リンク設定
+    std::array<Stream, MAX_STREAMS> streams_;   // 周期送信ストリーム
+    size_t stream_count_;                       // 登録ストリーム数
+    int64_t tokens_;                            // 送信可能バイト数
+    int64_t last_refill_us_;                    // 前回補充時刻（μs）
+    std::atomic<uint8_t> sequence_;             // 送信シーケンス番号
+    mutable std::mutex mutex_;                  // ストリーム表保護
+    
+    FrameParser parser_;                        // 受信パーサー
+    RxHandler rx_handler_;                      // 受信コールバック
+    void* rx_context_;                          // 受信コールバック引数
+};
+
+} // namespace communication
+
+#endif // TELEMETRY_LINK_HPP
@@ -0,0 +1,396 @@
+/*
+ * Telemetry Protocol
+ * 
+ * バイナリテレメトリ/コマンドプロトコル定義
+ * 固定長のパック構造体メッセージ、シーケンス番号、CRC16付きフレーム
+ * 
+ * フレーム形式:
+ *   [STX 0xA5][LEN][SEQ][MSG_ID][PAYLOAD (LEN bytes)][CRC16 L][CRC16 H]
+ *   CRCはLENからPAYLOAD末尾までのCRC-16/CCITT-FALSE
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TELEMETRY_PROTOCOL_HPP
+#define TELEMETRY_PROTOCOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+static constexpr uint8_t FRAME_STX = 0xA5;              // フレーム開始バイト
+static constexpr size_t FRAME_HEADER_SIZE = 4;          // STX + LEN + SEQ + MSG_ID
+static constexpr size_t FRAME_CRC_SIZE = 2;             // CRC16
+static constexpr size_t FRAME_OVERHEAD = FRAME_HEADER_SIZE + FRAME_CRC_SIZE;
+static constexpr size_t MAX_PAYLOAD_SIZE = 64;          // 最大ペイロード長
+static constexpr size_t MAX_FRAME_SIZE = FRAME_OVERHEAD + MAX_PAYLOAD_SIZE;
+
+/**
+ * @brief メッセージID列挙型
+ * 
+ * 0x00-0x3F: 機体→地上（テレメトリ）、0x40-0x7F: 地上→機体（コマンド）
+ */
+enum class MessageId : uint8_t {
+    HEARTBEAT = 0x00,
+    ATTITUDE = 0x01,
+    IMU_RAW = 0x02,
+    MOTOR_OUTPUT = 0x03,
+    STATUS = 0x04,
+    GYRO_SPECTRUM = 0x05,
+    RESOURCE = 0x06,
+    REPLAY_OUTPUT = 0x07,
+    TIME_SYNC_REQUEST = 0x08,
+    COMMAND = 0x40,
+    PARAM_SET = 0x41,
+    REPLAY_FRAME = 0x42,
+    TIME_SYNC_RESPONSE = 0x43,
+    MOCAP_POSE = 0x44
+};
+
+#pragma pack(push, 1)
+
+/**
+ * @brief ハートビートメッセージ（1Hz程度）
+ */
+struct HeartbeatMessage {
+    static constexpr MessageId ID = MessageId::HEARTBEAT;
+    uint32_t uptime_ms;         // 起動からの経過時間（ms）
+    uint8_t system_state;       // システム状態
+    uint8_t protocol_version;   // プロトコルバージョン
+};
+
+/**
+ * @brief 姿勢メッセージ（高レート）
+ */
+struct AttitudeMessage {
+    static constexpr MessageId ID = MessageId::ATTITUDE;
+    uint32_t time_us;           // タイムスタンプ（μs、下位32bit）
+    float roll;                 // ロール角（rad）
+    float pitch;                // ピッチ角（rad）
+    float yaw;                  // ヨー角（rad）
+    float roll_rate;            // ロール角速度（rad/s）
+    float pitch_rate;           // ピッチ角速度（rad/s）
+    float yaw_rate;             // ヨー角速度（rad/s）
+};
+
+/**
+ * @brief IMU生データメッセージ
+ */
+struct ImuRawMessage {
+    static constexpr MessageId ID = MessageId::IMU_RAW;
+    uint32_t time_us;           // タイムスタンプ（μs、下位32bit）
+    float accel[3];             // 加速度（m/s^2）
+    float gyro[3];              // 角速度（rad/s）
+};
+
+/**
+ * @brief モーター出力メッセージ
+ */
+struct MotorOutputMessage {
+    static constexpr MessageId ID = MessageId::MOTOR_OUTPUT;
+    uint32_t time_us;           // タイムスタンプ（μs、下位32bit）
+    float duty[4];              // デューティ（0.0-1.0、FL/FR/RL/RR）
+};
+
+/**
+ * @brief ステータスメッセージ（低レート）
+ */
+struct StatusMessage {
+    static constexpr MessageId ID = MessageId::STATUS;
+    uint32_t time_us;           // タイムスタンプ（μs、下位32bit）
+    uint16_t battery_mv;        // バッテリー電圧（mV）
+    uint8_t flight_mode;        // 飛行モード
+    uint8_t flags;              // 状態フラグ
+    uint16_t cpu_load_permille; // CPU負荷（‰）
+    uint16_t error_count;       // エラー数
+};
+
+/**
+ * @brief ジャイロスペクトルメッセージ（解析窓毎、数Hz）
+ */
+struct GyroSpectrumMessage {
+    static constexpr MessageId ID = MessageId::GYRO_SPECTRUM;
+    static constexpr size_t PEAKS = 3;      // 軸あたりのピーク数
+    static constexpr size_t BANDS = 4;      // 軸あたりの帯域数
+    uint32_t time_us;                   // 解析窓の終端時刻（μs、下位32bit）
+    uint16_t bin_hz_x100;               // 周波数分解能（0.01Hz単位）
+    uint16_t peak_hz[3][PEAKS];         // ピーク周波数（Hz、X/Y/Z、0はピークなし）
+    int8_t peak_db[3][PEAKS];           // ピークの大きさ（dB、(rad/s)^2基準）
+    int8_t band_db[3][BANDS];           // 帯域エネルギー（dB、(rad/s)^2基準）
+};
+
+/**
+ * @brief リソースメッセージのタスク項目
+ */
+struct ResourceTaskEntry {
+    static constexpr size_t NAME_SIZE = 8;  // タスク名（終端なしで切り詰め）
+    char name[NAME_SIZE];               // タスク名
+    uint16_t stack_free;                // スタック残りの最小（バイト）
+    uint16_t stack_size;                // スタックサイズ（バイト、0は不明）
+};
+
+/**
+ * @brief リソースメッセージ（低レート、タスクは TASKS 件ずつ巡回）
+ */
+struct ResourceMessage {
+    static constexpr MessageId ID = MessageId::RESOURCE;
+    static constexpr size_t TASKS = 2;      // 1メッセージのタスク数
+    uint32_t time_us;                   // 計測時刻（μs、下位32bit）
+    uint32_t internal_free;             // 内部RAMの空き（バイト）
+    uint32_t internal_min_free;         // 内部RAMの空きの最小（バイト）
+    uint32_t internal_largest;          // 内部RAMの最大空きブロック（バイト）
+    uint32_t dma_free;                  // DMA可能RAMの空き（バイト）
+    uint32_t dma_min_free;              // DMA可能RAMの空きの最小（バイト）
+    uint32_t dma_largest;               // DMA可能RAMの最大空きブロック（バイト）
+    uint16_t internal_fragmentation;    // 内部RAMの断片化（‰）
+    uint16_t dma_fragmentation;         // DMA可能RAMの断片化（‰）
+    uint8_t task_index;                 // 先頭タスクの番号
+    uint8_t task_count;                 // 全タスク数
+    ResourceTaskEntry task[TASKS];      // タスク
+};
+
+/**
+ * @brief コマンドメッセージ
+ */
+struct CommandMessage {
+    static constexpr MessageId ID = MessageId::COMMAND;
+    uint8_t command;            // コマンド番号
+    uint8_t reserved[3];        // 予約
+    float param[4];             // パラメータ
+};
+
+/**
+ * @brief パラメータ設定メッセージ
+ */
+struct ParamSetMessage {
+    static constexpr MessageId ID = MessageId::PARAM_SET;
+    char name[16];              // パラメータ名（NUL終端、16文字ちょうどの場合は終端なし）
+    float value;                // 設定値
+};
+
+/**
+ * @brief リプレイ出力メッセージ（リプレイ1フレーム毎の推定・制御結果、ビット一致の比較用）
+ */
+struct ReplayOutputMessage {
+    static constexpr MessageId ID = MessageId::REPLAY_OUTPUT;
+    uint32_t time_us;                   // 入力フレームの時刻
+    float quaternion[4];                // 推定姿勢 w, x, y, z
+    float duty[4];                      // モーター出力
+    uint32_t estimate_cycles;           // 推定の処理サイクル数
+    uint32_t control_cycles;            // 制御・ミキシングの処理サイクル数
+    uint32_t output_hash;               // 先頭からの出力のハッシュ（FNV-1a）
+};
+
+/**
+ * @brief リプレイ入力メッセージ（地上→機体、記録済みセンサー値1フレーム）
+ */
+struct ReplayFrameMessage {
+    static constexpr MessageId ID = MessageId::REPLAY_FRAME;
+    static constexpr uint8_t FLAG_RANGE = 0x01;     // rangeが有効
+    static constexpr uint8_t FLAG_FLOW = 0x02;      // flowが有効
+    static constexpr uint8_t FLAG_END = 0x04;       // 最終フレーム（他のフィールドは無視）
+    uint32_t time_us;                   // 記録時刻（μs）
+    float gyro[3];                      // 角速度（rad/s）
+    float accel[3];                     // 加速度（m/s^2）
+    float setpoint[4];                  // 指令 ロール, ピッチ, ヨー, 推力
+    float range;                        // ToF距離（m）
+    float flow[2];                      // 並進フロー X, Y（rad/s）
+    uint8_t flags;                      // FLAG_*
+};
+
+/**
+ * @brief 時刻同期要求メッセージ（機体→地上、1Hz程度）
+ * 
+ * 地上局は受信したらすぐに TimeSyncResponseMessage を返す
+ */
+struct TimeSyncRequestMessage {
+    static constexpr MessageId ID = MessageId::TIME_SYNC_REQUEST;
+    uint32_t exchange;                  // 交換番号（応答で返す）
+    int64_t request_time_us;            // 要求の送信時刻 t1（機体の時刻、μs）
+};
+
+/**
+ * @brief 時刻同期応答メッセージ（地上→機体）
+ */
+struct TimeSyncResponseMessage {
+    static constexpr MessageId ID = MessageId::TIME_SYNC_RESPONSE;
+    uint32_t exchange;                  // 要求の交換番号
+    int64_t request_time_us;            // 要求の送信時刻 t1（要求の値をそのまま返す）
+    int64_t receive_time_us;            // 要求の受信時刻 t2（地上の時刻、μs）
+    int64_t transmit_time_us;           // 応答の送信時刻 t3（地上の時刻、μs）
+};
+
+/**
+ * @brief モーションキャプチャ姿勢メッセージ（地上→機体、100-240Hz）
+ * 
+ * 座標はEKFの基準座標（Z上向き、m）。モーションキャプチャ座標からの変換は地上側で行う
+ */
+struct MocapPoseMessage {
+    static constexpr MessageId ID = MessageId::MOCAP_POSE;
+    static constexpr uint8_t FLAG_YAW = 0x01;       // yawが有効
+    uint32_t sequence;                  // 送信番号
+    int64_t capture_time_us;            // 撮像時刻（同期時刻、μs、0で不明）
+    float position[3];                  // 位置 X, Y, Z（m）
+    float yaw;                          // ヨー角（rad、Z軸回り）
+    uint8_t flags;                      // FLAG_*
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(MocapPoseMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(TimeSyncResponseMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(AttitudeMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(ImuRawMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(ParamSetMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(GyroSpectrumMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(ResourceMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(ReplayOutputMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+static_assert(sizeof(ReplayFrameMessage) <= MAX_PAYLOAD_SIZE, "ペイロード長超過");
+
+/**
+ * @brief CRC-16/CCITT-FALSE計算
+ * @param data データ
+ * @param length データ長
+ * @param crc 初期値（連続計算時は前回の結果）
+ * @return uint16_t CRC値
+ */
+uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief フレームエンコード
+ * @param buffer 出力先（MAX_FRAME_SIZE以上）
+ * @param capacity 出力先サイズ
+ * @param id メッセージID
+ * @param sequence シーケンス番号
+ * @param payload ペイロード
+ * @param payload_length ペイロード長
+ * @return size_t フレーム長（容量不足・長さ超過時は0）
+ */
+size_t encodeFrame(uint8_t* buffer, size_t capacity, MessageId id, uint8_t sequence, 
+                   const void* payload, size_t payload_length);
+
+/**
+ * @brief ペイロード配置済みバッファのフレーム化（コピーなし）
+ * 
+ * buffer + FRAME_HEADER_SIZE に書き込み済みのペイロードの前後へヘッダとCRCを書き込む。
+ * 送信バッファ（pbuf等）へ直接ペイロードを生成する場合に使う
+ * @param buffer フレーム先頭（FRAME_OVERHEAD + payload_length以上）
+ * @param id メッセージID
+ * @param sequence シーケンス番号
+ * @param payload_length ペイロード長（MAX_PAYLOAD_SIZE以下）
+ * @return size_t フレーム長（長さ超過時は0）
+ */
+size_t sealFrame(uint8_t* buffer, MessageId id, uint8_t sequence, size_t payload_length);
+
+/**
+ * @brief 受信フレームのデコード結果
+ */
+struct Frame {
+    MessageId id;               // メッセージID
+    uint8_t sequence;           // シーケンス番号
+    uint8_t length;             // ペイロード長
+    const uint8_t* payload;     // ペイロード（パーサー内部バッファを参照）
+    
+    /**
+     * @brief ペイロードを型付きで取得
+     * @tparam T メッセージ構造体
+     * @param message 格納先
+     * @return bool IDと長さが一致した場合true
+     */
+    template<typename T>
+    bool as(T& message) const;
+};
+
+/**
+ * @brief ストリーミングフレームパーサー
+ * 
+ * 受信バイト列を逐次投入し、CRCが一致したフレームをコールバックへ渡す。
+ * 同期外れ時はSTXを探して再同期する
+ */
+class FrameParser {
+public:
+    /**
+     * @brief フレーム受信コールバック関数型
+     */
+    using FrameHandler = void (*)(const Frame& frame, void* context);
+    
+    /**
+     * @brief 受信統計構造体
+     */
+    struct Stats {
+        uint32_t frames;            // 正常受信フレーム数
+        uint32_t crc_errors;        // CRCエラー数
+        uint32_t length_errors;     // 長さ異常数
+        uint32_t sequence_gaps;     // シーケンス番号の欠落数
+    };
+    
+    /**
+     * @brief コンストラクタ
+     * @param handler フレーム受信コールバック
+     * @param context コールバック引数
+     */
+    FrameParser(FrameHandler handler, void* context);
+    
+    /**
+     * @brief 受信データ投入
+     * @param data 受信データ
+     * @param length データ長
+     */
+    void push(const uint8_t* data, size_t length);
+    
+    /**
+     * @brief パーサー状態リセット
+     */
+    void reset();
+    
+    /**
+     * @brief 受信統計取得
+     * @return const Stats& 受信統計
+     */
+    const Stats& getStats() const { return stats_; }
+    
+private:
+    /**
+     * @brief パーサー状態列挙型
+     */
+    enum class State : uint8_t {
+        WAIT_STX,
+        LENGTH,
+        SEQUENCE,
+        MESSAGE_ID,
+        PAYLOAD,
+        CRC_LOW,
+        CRC_HIGH
+    };
+    
+    FrameHandler handler_;          // フレーム受信コールバック
+    void* context_;                 // コールバック引数
+    State state_;                   // パーサー状態
+    uint8_t buffer_[FRAME_HEADER_SIZE - 1 + MAX_PAYLOAD_SIZE];  // LEN/SEQ/MSG_ID + ペイロード
+    size_t index_;                  // バッファ書き込み位置
+    uint8_t crc_low_;               // 受信CRC下位バイト
+    uint8_t last_sequence_;         // 前回のシーケンス番号
+    bool sequence_valid_;           // シーケンス番号受信済みフラグ
+    Stats stats_;                   // 受信統計
+};
+
+template<typename T>
+bool Frame::as(T& message) const {
+    if (id != T::ID || length != sizeof(T)) {
+        return false;
+    }
+    const uint8_t* src = payload;
+    uint8_t* dst = reinterpret_cast<uint8_t*>(&message);
+    for (size_t i = 0; i < sizeof(T); i++) {
+        dst[i] = src[i];
+    }
+    return true;
+}
+
+} // namespace communication
+
+#endif // TELEMETRY_PROTOCOL_HPP
@@ -0,0 +1,175 @@
+/*
+ * Time Sync
+ * 
+ * テレメトリリンク上の往復時刻交換（NTP方式）による地上局との時刻同期
+ * 時刻差とドリフトを推定し、common::SyncedClockへ公開する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TIME_SYNC_HPP
+#define TIME_SYNC_HPP
+
+#include "synced_clock.hpp"
+#include "telemetry_protocol.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+/**
+ * @brief 時刻同期クラス
+ * 
+ * 1回の交換で t1（機体の送信）・t2（地上の受信）・t3（地上の送信）・t4（機体の受信）が揃い、
+ *   時刻差 = ((t2 - t1) + (t3 - t4)) / 2、往復遅延 = (t4 - t1) - (t3 - t2)
+ * となる。時刻差は窓内で往復遅延が最小の交換（キューイングが最も少なく、非対称の誤差も小さいもの）を使い、
+ * ドリフトは基準の交換（アンカー）からの時刻差の変化で求める。基線が長いほどドリフトの誤差は小さく、
+ * 基線が上限を超えたらアンカーを最新の最良の交換へ移す。
+ * 
+ * 使用例:
+ *   link.registerStream(MessageId::TIME_SYNC_REQUEST, 1.0f, TimeSync::fillRequest, &time_sync);
+ *   （受信コールバックで）time_sync.handleFrame(frame, esp_timer_get_time());
+ * 
+ * fillRequest()は送信タスク、handleFrame()は受信タスクから呼ぶ（それぞれ単一のタスク）
+ */
+class TimeSync {
+public:
+    static constexpr size_t WINDOW = 16;            // 推定に使う交換の数
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        uint32_t max_round_trip_us = 50000;         // これより遅い交換は使わない（μs）
+        uint32_t quiet_margin_us = 1000;            // 最小往復遅延からこの範囲の交換だけで飛びを判定（μs）
+        int64_t min_drift_span_us = 20000000;       // ドリフトを推定する最短の基線（μs）
+        int64_t max_drift_span_us = 600000000;      // アンカーを移す基線（μs、温度によるドリフトの変化に追従）
+        int32_t max_drift_ppb = 500000;             // ドリフトの上限（ppb、水晶の誤差程度）
+        uint32_t step_threshold_us = 20000;         // 地上の時計の飛びとみなす予測誤差（μs）
+        uint32_t step_count = 3;                    // 飛びとみなして推定をやり直す連続回数
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t requests;          // 送信した要求数
+        uint32_t responses;         // 受信した応答数
+        uint32_t rejected;          // 使わなかった応答数（遅い・不正・古い）
+        uint32_t resets;            // 地上の時計の飛びで推定をやり直した回数
+        uint32_t last_round_trip_us;    // 直近の往復遅延（μs）
+        uint32_t min_round_trip_us;     // 窓内の最小往復遅延（μs）
+        int32_t last_residual_us;       // 直近の交換の予測誤差（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param clock 推定結果の公開先
+     */
+    explicit TimeSync(common::SyncedClock& clock = common::SyncedClock::instance());
+    
+    /**
+     * @brief 設定
+     * @param config 設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 要求メッセージの作成（t1を記録する）
+     * @param message 格納先
+     * @param now_us 送信時刻（μs）
+     */
+    void makeRequest(TimeSyncRequestMessage& message, int64_t now_us);
+    
+    /**
+     * @brief 要求ストリームの生成関数（TelemetryLink・UdpTelemetryへ登録する）
+     * @param buffer ペイロード出力先
+     * @param capacity 出力先サイズ
+     * @param context TimeSync*
+     * @return size_t ペイロード長
+     */
+    static size_t fillRequest(uint8_t* buffer, size_t capacity, void* context);
+    
+    /**
+     * @brief 応答の処理
+     * @param response 応答メッセージ
+     * @param now_us 受信時刻 t4（μs）
+     * @return bool 推定に使った場合true
+     */
+    bool handleResponse(const TimeSyncResponseMessage& response, int64_t now_us);
+    
+    /**
+     * @brief 受信フレームの処理（応答以外は無視）
+     * @param frame 受信フレーム
+     * @param now_us 受信時刻（μs）
+     * @return bool 応答を推定に使った場合true
+     */
+    bool handleFrame(const Frame& frame, int64_t now_us);
+    
+    /**
+     * @brief 推定のやり直し（未同期に戻す）
+     */
+    void reset();
+    
+    /**
+     * @brief 現在の時刻モデル
+     */
+    const common::ClockModel& getModel() const { return model_; }
+    
+    /**
+     * @brief 統計情報取得
+     * @return Stats 統計情報
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 1回の交換の結果
+     */
+    struct Sample {
+        int64_t local_us;           // 交換の中点（自機の時刻）
+        int64_t offset_us;          // 時刻差
+        uint32_t round_trip_us;     // 往復遅延
+    };
+    
+    /**
+     * @brief 窓内の交換から時刻モデルを求めて公開
+     */
+    void estimate();
+    
+    /**
+     * @brief 窓内で往復遅延が最小の交換
+     */
+    const Sample& bestSample() const;
+    
+    common::SyncedClock& clock_;                    // 公開先
+    Config config_;                                 // 設定
+    std::atomic<uint32_t> next_exchange_;           // 次の交換番号（送信タスク）
+    std::atomic<uint32_t> stat_requests_;           // 送信した要求数（送信タスク）
+    
+    // 受信タスクのみが更新する状態
+    std::array<Sample, WINDOW> samples_;            // 直近の交換
+    size_t sample_index_;                           // 次に書き込む位置
+    size_t sample_count_;                           // 有効な交換の数
+    uint32_t last_exchange_;                        // 前回処理した交換番号
+    uint32_t step_run_;                             // 予測誤差が大きい交換の連続回数
+    Sample anchor_;                                 // ドリフト推定の基準の交換
+    bool anchor_valid_;                             // アンカー設定済み
+    common::ClockModel model_;                      // 現在の時刻モデル
+    Stats stats_;                                   // 統計情報
+};
+
+} // namespace communication
+
+#endif // TIME_SYNC_HPP
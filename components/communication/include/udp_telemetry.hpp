@@ -0,0 +1,184 @@
+/*
+ * UDP Telemetry
+ * 
+ * Wi-Fi UDPによる高レートテレメトリ送信（地上局での調整用）
+ * バイナリテレメトリのフレームをlwIPのpbufへ直接生成し、MTUまで複数メッセージを1データグラムにまとめる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef UDP_TELEMETRY_HPP
+#define UDP_TELEMETRY_HPP
+
+#include "telemetry_link.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/ip_addr.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct pbuf;
+struct udp_pcb;
+
+namespace communication {
+
+/**
+ * @brief UDPテレメトリ送信クラス
+ * 
+ * 制御ループはこのクラスを呼ばない。制御ループはSharedFlightState等のメールボックスへ公開するだけで、
+ * 送信タスク（既定でコア0・低優先度）が各ストリームの生成関数でメールボックスの最新値を読み、
+ * pbufのペイロード位置へ直接書き込む（中間バッファへのコピーなし）。
+ * 送信はtcpipスレッドへ待たずに依頼し、前のデータグラムが未送信・依頼キューが満杯の場合は
+ * 古いデータグラムを破棄する（キューに溜めない）。
+ * 送信先は設定のホストで、follow_senderが有効なら最後にデータグラムを送ってきた地上局へ切り替える。
+ * Wi-Fi（STAまたはAP）とネットワークインタフェースは呼び出し側で起動しておく
+ */
+class UdpTelemetry {
+public:
+    static constexpr size_t MAX_STREAMS = 8;            // 最大ストリーム数
+    
+    /**
+     * @brief ストリームのペイロード生成関数型（TelemetryLinkと共通）
+     */
+    using FillFunction = TelemetryLink::FillFunction;
+    
+    /**
+     * @brief 送信設定構造体
+     */
+    struct Config {
+        const char* host = "192.168.4.2";           // 送信先（SoftAPの最初のクライアント）
+        uint16_t port = 14560;                      // 送信先・待ち受けポート
+        bool follow_sender = true;                  // 受信したデータグラムの送信元を送信先にする
+        uint16_t datagram_size = 1400;              // 1データグラムの最大長（MTU - IP/UDPヘッダ）
+        uint32_t period_ms = 10;                    // 送信タスクの周期（ms）
+        UBaseType_t priority = 2;                   // 送信タスクの優先度（制御より低く）
+        uint32_t stack_size = 3072;                 // 送信タスクのスタックサイズ
+        int core = 0;                               // 送信タスクのコア（Wi-Fi・lwIPと同じコア0）
+    };
+    
+    /**
+     * @brief 送信統計構造体
+     */
+    struct Stats {
+        uint32_t datagrams;         // 送信依頼したデータグラム数
+        uint32_t messages;          // データグラムに詰めたメッセージ数
+        uint32_t dropped;           // 未送信のまま破棄したデータグラム数
+        uint32_t alloc_failures;    // pbuf確保失敗数
+        uint32_t send_errors;       // udp_sendto()の失敗数
+    };
+    
+public:
+    UdpTelemetry();
+    ~UdpTelemetry();
+    
+    UdpTelemetry(const UdpTelemetry&) = delete;
+    UdpTelemetry& operator=(const UdpTelemetry&) = delete;
+    
+    /**
+     * @brief 周期送信ストリーム登録（start()前に行う）
+     * @param id メッセージID
+     * @param rate_hz 送信レート（Hz、送信タスクの周波数で頭打ち）
+     * @param fill ペイロード生成関数（送信タスクで呼ばれる、待たないこと）
+     * @param context 生成関数の引数
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t registerStream(MessageId id, float rate_hz, FillFunction fill, void* context);
+    
+    /**
+     * @brief 送信開始（UDPの待ち受けと送信タスクの作成）
+     * @param config 送信設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 送信開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 送信停止
+     * @return esp_err_t 停止を確認できない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 送信統計取得
+     * @return Stats 送信統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief ストリーム情報構造体
+     */
+    struct Stream {
+        MessageId id;                   // メッセージID
+        uint32_t period_us;             // 送信周期（μs）
+        int64_t next_due_us;            // 次回送信予定時刻（μs）
+        FillFunction fill;              // ペイロード生成関数
+        void* context;                  // 生成関数の引数
+    };
+    
+    /**
+     * @brief 送信タスク
+     */
+    static void taskEntry(void* arg);
+    
+    /**
+     * @brief 1周期分のデータグラムの生成と送信依頼
+     * @param now_us 現在時刻（μs）
+     */
+    void service(int64_t now_us);
+    
+    /**
+     * @brief データグラムの送信依頼（tcpipスレッドへ、待たない）
+     * @param packet 送信するpbuf（所有権を渡す）
+     */
+    void submit(pbuf* packet);
+    
+    /**
+     * @brief tcpipスレッドでの送信
+     */
+    static void sendInTcpip(void* context);
+    
+    /**
+     * @brief 受信コールバック（tcpipスレッド、送信元の追従）
+     */
+    static void onReceive(void* arg, udp_pcb* pcb, pbuf* packet, const ip_addr_t* address, uint16_t port);
+    
+    Config config_;                                 // 送信設定
+    std::array<Stream, MAX_STREAMS> streams_;       // 周期送信ストリーム
+    size_t stream_count_;                           // 登録ストリーム数
+    uint8_t sequence_;                              // 送信シーケンス番号（送信タスクのみ）
+    
+    udp_pcb* pcb_;                                  // UDP制御ブロック（tcpipスレッドで操作）
+    ip_addr_t destination_;                         // 送信先アドレス（tcpipスレッドで操作）
+    uint16_t destination_port_;                     // 送信先ポート（tcpipスレッドで操作）
+    std::atomic<pbuf*> pending_;                    // 送信依頼中のデータグラム（1つのみ）
+    
+    TaskHandle_t task_;                             // 送信タスク
+    std::atomic<bool> running_;                     // 送信タスク動作中フラグ
+    
+    std::atomic<uint32_t> stat_datagrams_;
+    std::atomic<uint32_t> stat_messages_;
+    std::atomic<uint32_t> stat_dropped_;
+    std::atomic<uint32_t> stat_alloc_failures_;
+    std::atomic<uint32_t> stat_send_errors_;
+};
+
+} // namespace communication
+
+#endif // UDP_TELEMETRY_HPP
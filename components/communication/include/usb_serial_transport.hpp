@@ -0,0 +1,125 @@
+/*
+ * USB Serial Transport
+ * 
+ * USB Serial/JTAG送信路（ケーブル接続での調整用の高レートテレメトリ）
+ * UART0（115200bps）より桁違いに速く、ホストが読んでいない間はフレーム単位で破棄する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef USB_SERIAL_TRANSPORT_HPP
+#define USB_SERIAL_TRANSPORT_HPP
+
+#include "telemetry_link.hpp"
+#include "esp_err.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace communication {
+
+/**
+ * @brief USB Serial/JTAG送信路
+ * 
+ * ESP32-S3内蔵のUSB Serial/JTAG（フルスピードのバルク転送、CDC-ACMとして見える）で
+ * TelemetryLinkと同じバイナリフレームを送る。コンソールはCONFIG_ESP_CONSOLE_NONEで外してあるため占有できる。
+ * 
+ * send()は待たない。ドライバの送信リングへはフレーム全体が入るか全く入らないかのどちらかで、
+ * 入らない場合（ホストが読んでいない・帯域超過）とホスト未接続の場合はそのフレームを破棄して数える。
+ * 途中まで書かれたフレームは出ないため、受信側のFrameParserが同期を失わない。
+ * 受信（地上局からのコマンド）はpoll()でTelemetryLinkへ渡す
+ */
+class UsbSerialTransport : public Transport {
+public:
+    static constexpr uint32_t LINK_BYTES_PER_SEC = 500000;     // TelemetryLink::Configの目安の帯域（実測の半分程度）
+    
+    /**
+     * @brief 送信路設定構造体
+     */
+    struct Config {
+        uint32_t tx_buffer_size = 8192;         // ドライバ送信リングのサイズ（ホストの読み出し遅れを吸収する）
+        uint32_t rx_buffer_size = 512;          // ドライバ受信リングのサイズ
+    };
+    
+    /**
+     * @brief 送信統計構造体
+     */
+    struct Stats {
+        uint32_t frames;            // 送信リングへ入れたフレーム数
+        uint32_t bytes;             // 送信リングへ入れたバイト数
+        uint32_t dropped;           // 送信リング満杯で破棄したフレーム数
+        uint32_t disconnected;      // ホスト未接続で破棄したフレーム数
+        uint32_t rx_bytes;          // 受信バイト数
+    };
+    
+public:
+    UsbSerialTransport();
+    ~UsbSerialTransport() override;
+    
+    UsbSerialTransport(const UsbSerialTransport&) = delete;
+    UsbSerialTransport& operator=(const UsbSerialTransport&) = delete;
+    
+    /**
+     * @brief 開始（USB Serial/JTAGドライバのインストール）
+     * @param config 送信路設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 停止（ドライバのアンインストール）
+     */
+    void stop();
+    
+    /**
+     * @brief 送信（待たない、入らないフレームは破棄）
+     * @param data 送信データ
+     * @param length データ長
+     * @return esp_err_t 送信リング満杯でESP_ERR_TIMEOUT、ホスト未接続でESP_ERR_INVALID_STATE
+     */
+    esp_err_t send(const void* data, size_t length) override;
+    
+    /**
+     * @brief 受信データをリンクへ渡す（待たない）
+     * @param link テレメトリリンク
+     * @return size_t 処理したバイト数
+     */
+    size_t poll(TelemetryLink& link);
+    
+    /**
+     * @brief ホスト接続中か（直近のSOFの有無）
+     */
+    bool isConnected() const;
+    
+    /**
+     * @brief 送信統計取得
+     * @return Stats 送信統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    bool installed_;                            // ドライバインストール済み
+    
+    std::atomic<uint32_t> stat_frames_;
+    std::atomic<uint32_t> stat_bytes_;
+    std::atomic<uint32_t> stat_dropped_;
+    std::atomic<uint32_t> stat_disconnected_;
+    std::atomic<uint32_t> stat_rx_bytes_;
+};
+
+} // namespace communication
+
+#endif // USB_SERIAL_TRANSPORT_HPP
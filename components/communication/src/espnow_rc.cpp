@@ -0,0 +1,310 @@
+/*
+ * ESP-NOW RC Receiver Implementation
+ * 
+ * ESP-NOWによる低遅延リモコン受信実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "espnow_rc.hpp"
+#include "interrupt_plan.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include <cstddef>
+#include <cstring>
+
+namespace communication {
+
+static const char* TAG = "communication::EspNowRc";
+
+std::atomic<EspNowRc*> EspNowRc::instance_{nullptr};
+
+EspNowRc::EspNowRc(const Config& config)
+    : config_(config)
+    , started_(false)
+    , wifi_initialized_(false)
+    , mailbox_()
+    , notify_task_(nullptr)
+    , last_receive_us_(0)
+    , bound_mac_{}
+    , bound_(false)
+    , last_sequence_(0)
+    , stat_received_(0)
+    , stat_invalid_(0)
+    , stat_foreign_(0)
+    , stat_lost_(0)
+    , stat_failsafe_events_(0)
+    , stat_max_interval_us_(0)
+    , stat_max_latency_us_(0)
+    , stat_avg_latency_us_(0)
+    , stat_rssi_(0)
+    , consumed_sequence_(0)
+    , in_failsafe_(false) {
+}
+
+EspNowRc::~EspNowRc() {
+    end();
+}
+
+esp_err_t EspNowRc::begin() {
+    if (started_) {
+        return ESP_OK;
+    }
+    
+    EspNowRc* expected = nullptr;
+    if (!instance_.compare_exchange_strong(expected, this)) {
+        ESP_LOGE(TAG, "ESP-NOW受信は既に別インスタンスが使用中");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (config_.init_wifi) {
+        // 無線の割り込みは配置表のコア（制御コア以外）に確保する
+        ret = hal::InterruptPlan::install(hal::InterruptPlan::Source::RADIO, [this]() { return initWifi(); });
+    }
+    if (ret == ESP_OK) {
+        ret = esp_now_init();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_now_register_recv_cb(onReceive);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ESP-NOW初期化失敗: %s", esp_err_to_name(ret));
+        instance_.store(nullptr);
+        return ret;
+    }
+    
+    started_ = true;
+    ESP_LOGI(TAG, "ESP-NOW受信開始 チャンネル:%u フェイルセーフ:%lums", config_.channel,  
+             static_cast<unsigned long>(config_.failsafe_timeout_us / 1000));
+    return ESP_OK;
+}
+
+esp_err_t EspNowRc::end() {
+    if (!started_) {
+        return ESP_OK;
+    }
+    
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    if (wifi_initialized_) {
+        esp_wifi_stop();
+        esp_wifi_deinit();
+        wifi_initialized_ = false;
+    }
+    
+    instance_.store(nullptr);
+    started_ = false;
+    ESP_LOGI(TAG, "ESP-NOW受信停止");
+    return ESP_OK;
+}
+
+esp_err_t EspNowRc::initWifi() {
+    // 既定イベントループ（作成済みならそのまま使用）
+    esp_err_t ret = esp_event_loop_create_default();
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    
+    wifi_init_config_t wifi_config = WIFI_INIT_CONFIG_DEFAULT();
+    wifi_config.nvs_enable = 0;     // 設定はRAMのみ（NVS不要）
+    ret = esp_wifi_init(&wifi_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    wifi_initialized_ = true;
+    
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_start();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_wifi_set_channel(config_.channel, WIFI_SECOND_CHAN_NONE);
+    }
+    if (ret == ESP_OK) {
+        // モデムスリープは受信を最大でビーコン間隔だけ遅らせるため無効化
+        ret = esp_wifi_set_ps(WIFI_PS_NONE);
+    }
+    return ret;
+}
+
+void EspNowRc::onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int length) {
+    EspNowRc* self = instance_.load(std::memory_order_acquire);
+    if (self != nullptr) {
+        self->handlePacket(info, data, length);
+    }
+}
+
+void EspNowRc::handlePacket(const esp_now_recv_info_t* info, const uint8_t* data, int length) {
+    if (data == nullptr || length != static_cast<int>(sizeof(StickPacket))) {
+        stat_invalid_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    StickPacket packet;
+    memcpy(&packet, data, sizeof(packet));
+    if (packet.magic != PACKET_MAGIC ||
+        crc16(data, offsetof(StickPacket, crc)) != packet.crc) {
+        stat_invalid_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // 送信元バインド
+    if (config_.bind_first_sender && info != nullptr && info->src_addr != nullptr) {
+        if (!bound_) {
+            memcpy(bound_mac_.data(), info->src_addr, ESP_NOW_ETH_ALEN);
+            bound_ = true;
+            ESP_LOGI(TAG, "送信機バインド %02x:%02x:%02x:%02x:%02x:%02x",  
+                     bound_mac_[0], bound_mac_[1], bound_mac_[2], bound_mac_[3], bound_mac_[4], bound_mac_[5]);
+        } else if (memcmp(bound_mac_.data(), info->src_addr, ESP_NOW_ETH_ALEN) != 0) {
+            stat_foreign_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    
+    int64_t now_us = esp_timer_get_time();
+    int64_t previous_us = last_receive_us_.load(std::memory_order_relaxed);
+    
+    // 受信間隔・欠落
+    if (previous_us != 0) {
+        uint32_t interval = static_cast<uint32_t>(now_us - previous_us);
+        if (interval > stat_max_interval_us_.load(std::memory_order_relaxed)) {
+            stat_max_interval_us_.store(interval, std::memory_order_relaxed);
+        }
+        stat_lost_.fetch_add(static_cast<uint8_t>(packet.sequence - last_sequence_ - 1), std::memory_order_relaxed);
+    }
+    last_sequence_ = packet.sequence;
+    
+    RcCommand command;
+    command.throttle = normalize(packet.throttle, 0.0f);
+    command.roll = normalize(packet.roll, -1.0f);
+    command.pitch = normalize(packet.pitch, -1.0f);
+    command.yaw = normalize(packet.yaw, -1.0f);
+    command.buttons = packet.buttons;
+    command.sequence = packet.sequence;
+    command.rssi = (info != nullptr && info->rx_ctrl != nullptr) ? static_cast<int8_t>(info->rx_ctrl->rssi) : 0;
+    command.receive_time_us = now_us;
+    
+    mailbox_.write(command);
+    last_receive_us_.store(now_us, std::memory_order_release);
+    stat_received_.fetch_add(1, std::memory_order_relaxed);
+    stat_rssi_.store(command.rssi, std::memory_order_relaxed);
+    
+    TaskHandle_t task = notify_task_.load(std::memory_order_acquire);
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+esp_err_t EspNowRc::read(RcCommand& command, int64_t now_us) {
+    if (!mailbox_.hasValue()) {
+        command = {};
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    if (isFailsafe(now_us)) {
+        if (!in_failsafe_) {
+            in_failsafe_ = true;
+            stat_failsafe_events_.fetch_add(1, std::memory_order_relaxed);
+            ESP_LOGW(TAG, "リモコン信号途絶 フェイルセーフ");
+        }
+        // 中立値（スロットル0）
+        command = {};
+        command.receive_time_us = last_receive_us_.load(std::memory_order_relaxed);
+        return ESP_ERR_TIMEOUT;
+    }
+    in_failsafe_ = false;
+    
+    uint32_t sequence = 0;
+    if (!mailbox_.read(command, sequence)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // 新しいパケットを初めて読んだ時点で遅延を計測
+    if (sequence != consumed_sequence_) {
+        consumed_sequence_ = sequence;
+        int64_t elapsed_us = now_us - command.receive_time_us;
+        uint32_t latency = (elapsed_us > 0) ? static_cast<uint32_t>(elapsed_us) : 0;
+        if (latency > stat_max_latency_us_.load(std::memory_order_relaxed)) {
+            stat_max_latency_us_.store(latency, std::memory_order_relaxed);
+        }
+        uint32_t average = stat_avg_latency_us_.load(std::memory_order_relaxed);
+        average = (average == 0) ? latency : average + (static_cast<int32_t>(latency - average) >> 3);
+        stat_avg_latency_us_.store(average, std::memory_order_relaxed);
+    }
+    return ESP_OK;
+}
+
+bool EspNowRc::isFailsafe(int64_t now_us) const {
+    int64_t last_us = last_receive_us_.load(std::memory_order_acquire);
+    if (last_us == 0) {
+        return true;
+    }
+    return (now_us - last_us) > static_cast<int64_t>(config_.failsafe_timeout_us);
+}
+
+EspNowRc::LinkStats EspNowRc::getStats() const {
+    LinkStats stats;
+    stats.received = stat_received_.load(std::memory_order_relaxed);
+    stats.invalid = stat_invalid_.load(std::memory_order_relaxed);
+    stats.foreign = stat_foreign_.load(std::memory_order_relaxed);
+    stats.lost = stat_lost_.load(std::memory_order_relaxed);
+    stats.failsafe_events = stat_failsafe_events_.load(std::memory_order_relaxed);
+    stats.max_interval_us = stat_max_interval_us_.load(std::memory_order_relaxed);
+    stats.max_latency_us = stat_max_latency_us_.load(std::memory_order_relaxed);
+    stats.avg_latency_us = stat_avg_latency_us_.load(std::memory_order_relaxed);
+    stats.rssi = stat_rssi_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void EspNowRc::resetStats() {
+    stat_received_.store(0, std::memory_order_relaxed);
+    stat_invalid_.store(0, std::memory_order_relaxed);
+    stat_foreign_.store(0, std::memory_order_relaxed);
+    stat_lost_.store(0, std::memory_order_relaxed);
+    stat_failsafe_events_.store(0, std::memory_order_relaxed);
+    stat_max_interval_us_.store(0, std::memory_order_relaxed);
+    stat_max_latency_us_.store(0, std::memory_order_relaxed);
+    stat_avg_latency_us_.store(0, std::memory_order_relaxed);
+}
+
+void EspNowRc::encodePacket(StickPacket& packet, uint8_t sequence, float throttle, float roll,  
+                            float pitch, float yaw, uint16_t buttons) {
+    auto toRaw = [](float value, float min_value) -> int16_t {
+        if (value < min_value) {
+            value = min_value;
+        } else if (value > 1.0f) {
+            value = 1.0f;
+        }
+        return static_cast<int16_t>(value * STICK_SCALE);
+    };
+    
+    packet.magic = PACKET_MAGIC;
+    packet.sequence = sequence;
+    packet.throttle = toRaw(throttle, 0.0f);
+    packet.roll = toRaw(roll, -1.0f);
+    packet.pitch = toRaw(pitch, -1.0f);
+    packet.yaw = toRaw(yaw, -1.0f);
+    packet.buttons = buttons;
+    packet.crc = crc16(reinterpret_cast<const uint8_t*>(&packet), offsetof(StickPacket, crc));
+}
+
+float EspNowRc::normalize(int16_t value, float min_value) {
+    float normalized = static_cast<float>(value) / STICK_SCALE;
+    if (normalized < min_value) {
+        return min_value;
+    }
+    if (normalized > 1.0f) {
+        return 1.0f;
+    }
+    return normalized;
+}
+
+} // namespace communication
@@ -0,0 +1,398 @@
+/*
+ * ESP-NOW Swarm Implementation
+ * 
+ * ESP-NOWブロードキャストによる複数機体の同時制御実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "espnow_swarm.hpp"
+#include "interrupt_plan.hpp"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include <algorithm>
+#include <cstring>
+
+namespace communication {
+
+static const char* TAG = "communication::EspNowSwarm";
+
+namespace {
+
+const uint8_t BROADCAST_MAC[ESP_NOW_ETH_ALEN] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+/**
+ * @brief Wi-Fi初期化（STA、RAMのみ、省電力無効）
+ */
+esp_err_t initWifi(uint8_t channel) {
+    esp_err_t ret = esp_event_loop_create_default();
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        return ret;
+    }
+    
+    wifi_init_config_t wifi_config = WIFI_INIT_CONFIG_DEFAULT();
+    wifi_config.nvs_enable = 0;
+    ret = esp_wifi_init(&wifi_config);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    esp_wifi_set_storage(WIFI_STORAGE_RAM);
+    ret = esp_wifi_set_mode(WIFI_MODE_STA);
+    if (ret == ESP_OK) {
+        ret = esp_wifi_start();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+    }
+    if (ret == ESP_OK) {
+        // モデムスリープは受信を最大でビーコン間隔だけ遅らせるため無効化
+        ret = esp_wifi_set_ps(WIFI_PS_NONE);
+    }
+    if (ret != ESP_OK) {
+        esp_wifi_deinit();
+    }
+    return ret;
+}
+
+void deinitWifi() {
+    esp_wifi_stop();
+    esp_wifi_deinit();
+}
+
+} // namespace
+
+// ========== SwarmReceiver ==========
+
+std::atomic<SwarmReceiver*> SwarmReceiver::instance_{nullptr};
+
+SwarmReceiver::SwarmReceiver(const Config& config)
+    : config_(config)
+    , started_(false)
+    , wifi_initialized_(false)
+    , mailbox_()
+    , notify_task_(nullptr)
+    , last_receive_us_(0)
+    , last_beacon_us_(0)
+    , clock_offset_us_(0)
+    , sync_samples_{}
+    , sync_index_(0)
+    , sync_count_(0)
+    , last_sequence_(0)
+    , sequence_valid_(false)
+    , stat_received_(0)
+    , stat_unaddressed_(0)
+    , stat_invalid_(0)
+    , stat_lost_(0)
+    , stat_beacons_(0) {
+}
+
+SwarmReceiver::~SwarmReceiver() {
+    end();
+}
+
+esp_err_t SwarmReceiver::begin() {
+    if (started_) {
+        return ESP_OK;
+    }
+    
+    SwarmReceiver* expected = nullptr;
+    if (!instance_.compare_exchange_strong(expected, this)) {
+        ESP_LOGE(TAG, "スウォーム受信は既に別インスタンスが使用中");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (config_.init_wifi) {
+        // 無線の割り込みは配置表のコア（制御コア以外）に確保する
+        ret = hal::InterruptPlan::install(hal::InterruptPlan::Source::RADIO, [this]() { return initWifi(config_.channel); });
+        wifi_initialized_ = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_now_init();
+    }
+    if (ret == ESP_OK) {
+        ret = esp_now_register_recv_cb(onReceive);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ESP-NOW初期化失敗: %s", esp_err_to_name(ret));
+        if (wifi_initialized_) {
+            deinitWifi();
+            wifi_initialized_ = false;
+        }
+        instance_.store(nullptr);
+        return ret;
+    }
+    
+    started_ = true;
+    ESP_LOGI(TAG, "スウォーム受信開始 スロット:%u チャンネル:%u", config_.slot, config_.channel);
+    return ESP_OK;
+}
+
+esp_err_t SwarmReceiver::end() {
+    if (!started_) {
+        return ESP_OK;
+    }
+    
+    esp_now_unregister_recv_cb();
+    esp_now_deinit();
+    if (wifi_initialized_) {
+        deinitWifi();
+        wifi_initialized_ = false;
+    }
+    
+    instance_.store(nullptr);
+    started_ = false;
+    ESP_LOGI(TAG, "スウォーム受信停止");
+    return ESP_OK;
+}
+
+void SwarmReceiver::onReceive(const esp_now_recv_info_t* info, const uint8_t* data, int length) {
+    (void)info;
+    SwarmReceiver* self = instance_.load(std::memory_order_acquire);
+    if (self != nullptr) {
+        self->handleFrame(data, length, esp_timer_get_time());
+    }
+}
+
+void SwarmReceiver::handleFrame(const uint8_t* data, int length, int64_t now_us) {
+    SwarmHeader header;
+    if (length <= 0 || !decodeSwarmHeader(data, static_cast<size_t>(length), header)) {
+        stat_invalid_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    // 送信側のシーケンスはSETPOINT・BEACON共通
+    if (sequence_valid_) {
+        stat_lost_.fetch_add(static_cast<uint8_t>(header.sequence - last_sequence_ - 1), std::memory_order_relaxed);
+    }
+    last_sequence_ = header.sequence;
+    sequence_valid_ = true;
+    
+    if (header.type == SwarmFrameType::BEACON) {
+        updateSync(header.time_us, now_us);
+        stat_beacons_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    SwarmCommand command;
+    if (!extractSwarmSlot(data, header, config_.slot, command.setpoint)) {
+        stat_unaddressed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    command.synchronized = isSynchronized(now_us);
+    command.apply_time_us = (header.time_us != 0 && command.synchronized) ? toLocalTime(header.time_us, now_us) : 0;
+    command.receive_time_us = now_us;
+    command.sequence = header.sequence;
+    
+    mailbox_.write(command);
+    last_receive_us_.store(now_us, std::memory_order_release);
+    stat_received_.fetch_add(1, std::memory_order_relaxed);
+    
+    TaskHandle_t task = notify_task_.load(std::memory_order_acquire);
+    if (task != nullptr) {
+        xTaskNotifyGive(task);
+    }
+}
+
+void SwarmReceiver::updateSync(uint32_t send_time_us, int64_t now_us) {
+    // 受信時刻 - 送信時刻 = 時刻差 + 伝送遅延（遅延は正のみ）→ 窓内の最小値が最も真の時刻差に近い
+    sync_samples_[sync_index_] = static_cast<int32_t>(static_cast<uint32_t>(now_us) - send_time_us);
+    sync_index_ = (sync_index_ + 1) % SYNC_WINDOW;
+    if (sync_count_ < SYNC_WINDOW) {
+        sync_count_++;
+    }
+    
+    // 折り返しに備え、最新の値からの差で最小値を探す
+    const int32_t latest = sync_samples_[(sync_index_ + SYNC_WINDOW - 1) % SYNC_WINDOW];
+    int32_t min_delta = 0;
+    for (size_t i = 0; i < sync_count_; i++) {
+        min_delta = std::min(min_delta, static_cast<int32_t>(static_cast<uint32_t>(sync_samples_[i]) - static_cast<uint32_t>(latest)));
+    }
+    clock_offset_us_.store(static_cast<int32_t>(static_cast<uint32_t>(latest) + static_cast<uint32_t>(min_delta)), 
+                           std::memory_order_relaxed);
+    last_beacon_us_.store(now_us, std::memory_order_release);
+}
+
+bool SwarmReceiver::isSynchronized(int64_t now_us) const {
+    const int64_t last_us = last_beacon_us_.load(std::memory_order_acquire);
+    return last_us != 0 && (now_us - last_us) <= static_cast<int64_t>(config_.sync_timeout_us);
+}
+
+int64_t SwarmReceiver::toLocalTime(uint32_t ground_time_us, int64_t now_us) const {
+    // 現在の地上の時刻（下位32bit）との差を符号付きで求め、折り返しを吸収する
+    const uint32_t offset = static_cast<uint32_t>(clock_offset_us_.load(std::memory_order_relaxed));
+    const uint32_t ground_now = static_cast<uint32_t>(now_us) - offset;
+    return now_us + static_cast<int32_t>(ground_time_us - ground_now);
+}
+
+esp_err_t SwarmReceiver::read(SwarmCommand& command, int64_t now_us) {
+    if (!mailbox_.hasValue()) {
+        command = {};
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    const int64_t last_us = last_receive_us_.load(std::memory_order_acquire);
+    if ((now_us - last_us) > static_cast<int64_t>(config_.failsafe_timeout_us)) {
+        // 通信途絶時はその場で位置保持
+        command = {};
+        command.setpoint.action = SwarmAction::HOLD;
+        command.receive_time_us = last_us;
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    uint32_t sequence = 0;
+    if (!mailbox_.read(command, sequence)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+SwarmReceiver::LinkStats SwarmReceiver::getStats() const {
+    LinkStats stats;
+    stats.received = stat_received_.load(std::memory_order_relaxed);
+    stats.unaddressed = stat_unaddressed_.load(std::memory_order_relaxed);
+    stats.invalid = stat_invalid_.load(std::memory_order_relaxed);
+    stats.lost = stat_lost_.load(std::memory_order_relaxed);
+    stats.beacons = stat_beacons_.load(std::memory_order_relaxed);
+    stats.clock_offset_us = clock_offset_us_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+// ========== SwarmBroadcaster ==========
+
+SwarmBroadcaster::SwarmBroadcaster(const Config& config)
+    : config_(config)
+    , started_(false)
+    , wifi_initialized_(false)
+    , slots_{}
+    , slot_end_(0)
+    , sequence_(0)
+    , stats_{} {
+}
+
+SwarmBroadcaster::~SwarmBroadcaster() {
+    end();
+}
+
+esp_err_t SwarmBroadcaster::begin() {
+    if (started_) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    if (config_.init_wifi) {
+        // 無線の割り込みは配置表のコア（制御コア以外）に確保する
+        ret = hal::InterruptPlan::install(hal::InterruptPlan::Source::RADIO, [this]() { return initWifi(config_.channel); });
+        wifi_initialized_ = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_now_init();
+    }
+    if (ret == ESP_OK) {
+        esp_now_peer_info_t peer = {};
+        memcpy(peer.peer_addr, BROADCAST_MAC, ESP_NOW_ETH_ALEN);
+        peer.channel = config_.channel;
+        peer.ifidx = WIFI_IF_STA;
+        peer.encrypt = false;
+        ret = esp_now_add_peer(&peer);
+        if (ret == ESP_ERR_ESPNOW_EXIST) {
+            ret = ESP_OK;
+        }
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ESP-NOW初期化失敗: %s", esp_err_to_name(ret));
+        if (wifi_initialized_) {
+            deinitWifi();
+            wifi_initialized_ = false;
+        }
+        return ret;
+    }
+    
+    started_ = true;
+    ESP_LOGI(TAG, "スウォーム送信開始 チャンネル:%u", config_.channel);
+    return ESP_OK;
+}
+
+esp_err_t SwarmBroadcaster::end() {
+    if (!started_) {
+        return ESP_OK;
+    }
+    
+    esp_now_del_peer(BROADCAST_MAC);
+    esp_now_deinit();
+    if (wifi_initialized_) {
+        deinitWifi();
+        wifi_initialized_ = false;
+    }
+    started_ = false;
+    return ESP_OK;
+}
+
+esp_err_t SwarmBroadcaster::setSetpoint(uint8_t slot, const SwarmSetpoint& setpoint) {
+    if (slot >= MAX_SLOTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    slots_[slot] = setpoint;
+    if (setpoint.action != SwarmAction::NONE) {
+        slot_end_ = std::max(slot_end_, static_cast<size_t>(slot) + 1);
+    } else {
+        while (slot_end_ > 0 && slots_[slot_end_ - 1].action == SwarmAction::NONE) {
+            slot_end_--;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t SwarmBroadcaster::sendSetpoints(uint32_t apply_time_us) {
+    if (!started_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    uint8_t frame[SWARM_MAX_FRAME_SIZE];
+    esp_err_t result = ESP_OK;
+    for (size_t first = 0; first < slot_end_; first += SWARM_SLOTS_PER_FRAME) {
+        const size_t count = std::min(SWARM_SLOTS_PER_FRAME, slot_end_ - first);
+        const size_t length = encodeSwarmSetpoints(frame, sizeof(frame), sequence_++, static_cast<uint8_t>(first), 
+                                                   &slots_[first], count, apply_time_us);
+        esp_err_t ret = broadcast(frame, length);
+        if (ret != ESP_OK) {
+            result = ret;
+        } else {
+            stats_.frames++;
+        }
+    }
+    return result;
+}
+
+esp_err_t SwarmBroadcaster::sendBeacon() {
+    if (!started_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    uint8_t frame[SWARM_HEADER_SIZE + SWARM_CRC_SIZE];
+    // 送信時刻は送信直前に取得する（時刻差の推定誤差を減らす）
+    const size_t length = encodeSwarmBeacon(frame, sizeof(frame), sequence_++,  
+                                            static_cast<uint32_t>(esp_timer_get_time()));
+    esp_err_t ret = broadcast(frame, length);
+    if (ret == ESP_OK) {
+        stats_.beacons++;
+    }
+    return ret;
+}
+
+esp_err_t SwarmBroadcaster::broadcast(const uint8_t* frame, size_t length) {
+    esp_err_t ret = esp_now_send(BROADCAST_MAC, frame, length);
+    if (ret != ESP_OK) {
+        stats_.errors++;
+        ESP_LOGD(TAG, "送信失敗: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+} // namespace communication
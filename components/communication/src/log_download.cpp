@@ -0,0 +1,131 @@
+/*
+ * Log Download Implementation
+ * 
+ * ブラックボックスログのストリーミングダウンロード実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "log_download.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace communication {
+
+static const char* TAG = "communication::LogDownload";
+
+LogDownload::LogDownload(const storage::PartitionLog& log)
+    : log_(log)
+    , stats_{} {}
+
+esp_err_t LogDownload::run(Transport& transport, const LogDownloadRequest& request) {
+    stats_ = Stats{};
+    stats_.next_sequence = request.start_sequence;
+    if (!log_.isOpen()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (request.magic != LogDownloadRequest::MAGIC) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = ESP_OK;
+    
+    // 書き込み位置の次（最古側）から一周すると通し番号順になる
+    uint32_t count = log_.sectorCount();
+    uint32_t first = log_.writeSector();
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t sector = (first + i) % count;
+        storage::PartitionLogHeader header;
+        if (log_.readHeader(sector, header) != ESP_OK) {
+            stats_.skipped++;
+            continue;
+        }
+        if (header.sequence < request.start_sequence
+            || (request.session != 0 && header.session != request.session)) {
+            continue;
+        }
+        ret = sendRecord(transport, sector, header);
+        if (ret != ESP_OK) {
+            break;
+        }
+        stats_.records++;
+        stats_.next_sequence = header.sequence + 1;
+        if (request.max_records != 0 && stats_.records >= request.max_records) {
+            break;
+        }
+    }
+    
+    if (ret == ESP_OK) {
+        LogDownloadChunk end = {};
+        end.magic = LogDownloadChunk::MAGIC;
+        end.sequence = stats_.next_sequence;
+        end.flags = LogDownloadChunk::FLAG_END;
+        ret = transport.send(&end, sizeof(end));
+        if (ret == ESP_OK) {
+            stats_.bytes += sizeof(end);
+        }
+    }
+    
+    stats_.elapsed_ms = static_cast<uint32_t>((esp_timer_get_time() - start_us) / 1000);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "転送中断 %s（%lu から再開可）", esp_err_to_name(ret), 
+                 static_cast<unsigned long>(stats_.next_sequence));
+    }
+    return ret;
+}
+
+esp_err_t LogDownload::sendRecord(Transport& transport, uint32_t sector, const storage::PartitionLogHeader& header) {
+    LogDownloadChunk chunk = {};
+    chunk.magic = LogDownloadChunk::MAGIC;
+    chunk.sequence = header.sequence;
+    chunk.length = static_cast<uint16_t>(storage::PartitionLog::HEADER_SIZE + header.payload_size);
+    esp_err_t ret = transport.send(&chunk, sizeof(chunk));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    stats_.bytes += sizeof(chunk);
+    
+    // フラッシュ → チャンクバッファ → 送信路（UARTの送信リング・TCPの送信バッファ）
+    for (size_t offset = 0; offset < chunk.length; offset += CHUNK_SIZE) {
+        size_t length = chunk.length - offset < CHUNK_SIZE ? chunk.length - offset : CHUNK_SIZE;
+        ret = log_.read(sector, offset, chunk_, length);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ret = transport.send(chunk_, length);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        stats_.bytes += static_cast<uint32_t>(length);
+    }
+    return ESP_OK;
+}
+
+esp_err_t LogDownload::serveTcp(TcpTransport& tcp, TickType_t timeout) {
+    esp_err_t ret = tcp.accept(timeout);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    LogDownloadRequest request;
+    ret = tcp.receive(&request, sizeof(request), timeout);
+    if (ret == ESP_OK) {
+        ret = run(tcp, request);
+        dump();
+    }
+    tcp.disconnect();
+    return ret;
+}
+
+void LogDownload::dump() const {
+    float seconds = stats_.elapsed_ms / 1000.0f;
+    ESP_LOGI(TAG, "レコード %lu %lu バイト %.1fs（%.1f KB/s） 読めないセクタ %lu 次の通し番号 %lu", 
+             static_cast<unsigned long>(stats_.records), static_cast<unsigned long>(stats_.bytes), seconds, 
+             seconds > 0.0f ? stats_.bytes / 1024.0f / seconds : 0.0f, static_cast<unsigned long>(stats_.skipped), 
+             static_cast<unsigned long>(stats_.next_sequence));
+}
+
+} // namespace communication
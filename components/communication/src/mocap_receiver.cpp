@@ -0,0 +1,210 @@
+/*
+ * Mocap Receiver Implementation
+ * 
+ * Wi-Fi UDPによるモーションキャプチャの外部姿勢入力実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "mocap_receiver.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/pbuf.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+
+namespace communication {
+
+static const char* TAG = "communication::MocapReceiver";
+
+namespace {
+
+/**
+ * @brief tcpipスレッドでのUDP制御ブロック操作の引数
+ */
+struct PcbCall {
+    tcpip_api_call_data base;   // lwIPの呼び出しデータ（先頭に置く）
+    udp_pcb** pcb;              // 操作する制御ブロック
+    uint16_t port;              // 待ち受けポート（開く場合）
+    udp_recv_fn receive;        // 受信コールバック
+    void* receive_arg;          // 受信コールバック引数
+};
+
+err_t openInTcpip(tcpip_api_call_data* data) {
+    PcbCall* call = reinterpret_cast<PcbCall*>(data);
+    udp_pcb* pcb = udp_new();
+    if (pcb == nullptr) {
+        return ERR_MEM;
+    }
+    err_t err = udp_bind(pcb, IP_ADDR_ANY, call->port);
+    if (err != ERR_OK) {
+        udp_remove(pcb);
+        return err;
+    }
+    udp_recv(pcb, call->receive, call->receive_arg);
+    *call->pcb = pcb;
+    return ERR_OK;
+}
+
+err_t closeInTcpip(tcpip_api_call_data* data) {
+    PcbCall* call = reinterpret_cast<PcbCall*>(data);
+    if (*call->pcb != nullptr) {
+        udp_remove(*call->pcb);
+        *call->pcb = nullptr;
+    }
+    return ERR_OK;
+}
+
+} // namespace
+
+MocapReceiver::MocapReceiver(const common::SyncedClock& clock)
+    : clock_(clock)
+    , config_()
+    , parser_(onFrame, this)
+    , queue_()
+    , pcb_(nullptr)
+    , receive_time_us_(0)
+    , last_sequence_(0)
+    , sequence_valid_(false)
+    , stat_poses_(0)
+    , stat_unsynchronized_(0)
+    , stat_stale_(0)
+    , stat_overflows_(0)
+    , stat_lost_(0)
+    , stat_latency_us_(0) {
+}
+
+MocapReceiver::~MocapReceiver() {
+    stop();
+}
+
+esp_err_t MocapReceiver::start(const Config& config) {
+    if (pcb_ != nullptr) {
+        return ESP_OK;
+    }
+    config_ = config;
+    parser_.reset();
+    sequence_valid_ = false;
+    
+    PcbCall call = {};
+    call.pcb = &pcb_;
+    call.port = config_.port;
+    call.receive = onReceive;
+    call.receive_arg = this;
+    err_t err = tcpip_api_call(openInTcpip, &call.base);
+    if (err != ERR_OK) {
+        ESP_LOGE(TAG, "UDP待ち受け失敗 ポート %u (%d)", config_.port, static_cast<int>(err));
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "モーションキャプチャ受信開始 ポート %u", config_.port);
+    return ESP_OK;
+}
+
+esp_err_t MocapReceiver::stop() {
+    if (pcb_ == nullptr) {
+        return ESP_OK;
+    }
+    // tcpipスレッドで外すため、戻った時点で受信コールバックは実行中でない
+    PcbCall call = {};
+    call.pcb = &pcb_;
+    tcpip_api_call(closeInTcpip, &call.base);
+    return ESP_OK;
+}
+
+void MocapReceiver::onReceive(void* arg, udp_pcb* pcb, pbuf* packet, const ip_addr_t* address, uint16_t port) {
+    (void)pcb;
+    (void)address;
+    (void)port;
+    MocapReceiver* self = static_cast<MocapReceiver*>(arg);
+    if (packet == nullptr) {
+        return;
+    }
+    // チェーンの各pbufをそのままパーサーへ流す（コピー・確保なし）
+    self->receive_time_us_ = esp_timer_get_time();
+    for (const pbuf* q = packet; q != nullptr; q = q->next) {
+        self->parser_.push(static_cast<const uint8_t*>(q->payload), q->len);
+    }
+    pbuf_free(packet);
+}
+
+void MocapReceiver::onFrame(const Frame& frame, void* context) {
+    MocapReceiver* self = static_cast<MocapReceiver*>(context);
+    self->handleFrame(frame, self->receive_time_us_);
+}
+
+bool MocapReceiver::handleFrame(const Frame& frame, int64_t now_us) {
+    MocapPoseMessage message;
+    if (!frame.as(message)) {
+        return false;
+    }
+    
+    if (sequence_valid_ && message.sequence != last_sequence_ + 1) {
+        const uint32_t gap = message.sequence - last_sequence_ - 1;
+        if (gap < 0x80000000u) {
+            stat_lost_.fetch_add(gap, std::memory_order_relaxed);
+        }
+    }
+    last_sequence_ = message.sequence;
+    sequence_valid_ = true;
+    
+    MocapPose pose;
+    pose.timestamp_us = now_us - config_.default_latency_us;
+    pose.synchronized = false;
+    common::ClockModel model;
+    if (message.capture_time_us != 0 && clock_.snapshot(model)) {
+        const int64_t capture_us = model.toLocal(message.capture_time_us);
+        const int64_t latency_us = now_us - capture_us;
+        if (latency_us < 0 || latency_us > static_cast<int64_t>(config_.max_age_us)) {
+            // 地上の時計の飛び・古い再送（同期が戻るまで融合を歪めないよう捨てる）
+            stat_stale_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        pose.timestamp_us = capture_us;
+        pose.synchronized = true;
+        stat_latency_us_.store(static_cast<int32_t>(latency_us), std::memory_order_relaxed);
+    } else {
+        stat_unsynchronized_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pose.position[0] = message.position[0];
+    pose.position[1] = message.position[1];
+    pose.position[2] = message.position[2];
+    pose.yaw = message.yaw;
+    pose.has_yaw = (message.flags & MocapPoseMessage::FLAG_YAW) != 0;
+    pose.sequence = message.sequence;
+    
+    if (!queue_.push(pose)) {
+        stat_overflows_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    stat_poses_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+MocapReceiver::Stats MocapReceiver::getStats() const {
+    Stats stats;
+    stats.poses = stat_poses_.load(std::memory_order_relaxed);
+    stats.unsynchronized = stat_unsynchronized_.load(std::memory_order_relaxed);
+    stats.stale = stat_stale_.load(std::memory_order_relaxed);
+    stats.overflows = stat_overflows_.load(std::memory_order_relaxed);
+    stats.lost = stat_lost_.load(std::memory_order_relaxed);
+    stats.crc_errors = parser_.getStats().crc_errors;
+    stats.last_latency_us = stat_latency_us_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MocapReceiver::dump() const {
+    const Stats stats = getStats();
+    ESP_LOGI(TAG, "%s ポート %u キュー %u/%u", pcb_ != nullptr ? "受信中" : "停止", config_.port, 
+             static_cast<unsigned>(queue_.size()), static_cast<unsigned>(QUEUE_SIZE));
+    ESP_LOGI(TAG, "姿勢 %lu 未同期 %lu 古い %lu 溢れ %lu 欠落 %lu CRC %lu 遅延 %ldμs", 
+             static_cast<unsigned long>(stats.poses), static_cast<unsigned long>(stats.unsynchronized), 
+             static_cast<unsigned long>(stats.stale), static_cast<unsigned long>(stats.overflows), 
+             static_cast<unsigned long>(stats.lost), static_cast<unsigned long>(stats.crc_errors), 
+             static_cast<long>(stats.last_latency_us));
+}
+
+} // namespace communication
@@ -0,0 +1,172 @@
+/*
+ * Swarm Protocol Implementation
+ * 
+ * スウォームフレーム実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "swarm_protocol.hpp"
+#include "telemetry_protocol.hpp"
+#include <cmath>
+
+namespace communication {
+
+namespace {
+
+constexpr float TWO_PI = 6.28318531f;
+constexpr float CM_PER_M = 100.0f;
+constexpr float YAW_LSB = TWO_PI / 256.0f;
+
+// ビット幅
+constexpr int NORTH_BITS = 14;
+constexpr int EAST_BITS = 14;
+constexpr int ALTITUDE_BITS = 12;
+constexpr int YAW_BITS = 8;
+constexpr int ACTION_BITS = 4;
+
+constexpr int NORTH_SHIFT = 0;
+constexpr int EAST_SHIFT = NORTH_SHIFT + NORTH_BITS;
+constexpr int ALTITUDE_SHIFT = EAST_SHIFT + EAST_BITS;
+constexpr int YAW_SHIFT = ALTITUDE_SHIFT + ALTITUDE_BITS;
+constexpr int ACTION_SHIFT = YAW_SHIFT + YAW_BITS;
+static_assert(ACTION_SHIFT + ACTION_BITS <= static_cast<int>(SWARM_SLOT_SIZE * 8), "スロット長超過");
+
+constexpr uint64_t mask(int bits) {
+    return (static_cast<uint64_t>(1) << bits) - 1;
+}
+
+// 符号付きの値を丸めて範囲内に収める
+inline int32_t quantize(float value, float scale, int bits, bool is_signed) {
+    const int32_t max_value = is_signed ? static_cast<int32_t>(mask(bits - 1)) : static_cast<int32_t>(mask(bits));
+    const int32_t min_value = is_signed ? -max_value : 0;
+    int32_t raw = static_cast<int32_t>(std::lround(value * scale));
+    if (raw > max_value) {
+        raw = max_value;
+    } else if (raw < min_value) {
+        raw = min_value;
+    }
+    return raw;
+}
+
+inline int32_t signExtend(uint64_t raw, int bits) {
+    const uint64_t sign = static_cast<uint64_t>(1) << (bits - 1);
+    return static_cast<int32_t>(static_cast<int64_t>((raw ^ sign) - sign));
+}
+
+inline void putU32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | 
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void packSlot(uint8_t* p, const SwarmSetpoint& setpoint) {
+    const uint32_t yaw_raw = static_cast<uint32_t>(std::lround(setpoint.yaw / YAW_LSB)) & mask(YAW_BITS);
+    uint64_t bits = 0;
+    bits |= (static_cast<uint64_t>(quantize(setpoint.north, CM_PER_M, NORTH_BITS, true)) & mask(NORTH_BITS)) << NORTH_SHIFT;
+    bits |= (static_cast<uint64_t>(quantize(setpoint.east, CM_PER_M, EAST_BITS, true)) & mask(EAST_BITS)) << EAST_SHIFT;
+    bits |= static_cast<uint64_t>(quantize(setpoint.altitude, CM_PER_M, ALTITUDE_BITS, false)) << ALTITUDE_SHIFT;
+    bits |= static_cast<uint64_t>(yaw_raw) << YAW_SHIFT;
+    bits |= (static_cast<uint64_t>(setpoint.action) & mask(ACTION_BITS)) << ACTION_SHIFT;
+    for (size_t i = 0; i < SWARM_SLOT_SIZE; i++) {
+        p[i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+}
+
+void unpackSlot(const uint8_t* p, SwarmSetpoint& setpoint) {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < SWARM_SLOT_SIZE; i++) {
+        bits |= static_cast<uint64_t>(p[i]) << (8 * i);
+    }
+    setpoint.north = static_cast<float>(signExtend((bits >> NORTH_SHIFT) & mask(NORTH_BITS), NORTH_BITS)) / CM_PER_M;
+    setpoint.east = static_cast<float>(signExtend((bits >> EAST_SHIFT) & mask(EAST_BITS), EAST_BITS)) / CM_PER_M;
+    setpoint.altitude = static_cast<float>((bits >> ALTITUDE_SHIFT) & mask(ALTITUDE_BITS)) / CM_PER_M;
+    // ヨーは -π〜π に正規化
+    const int32_t yaw_raw = signExtend((bits >> YAW_SHIFT) & mask(YAW_BITS), YAW_BITS);
+    setpoint.yaw = static_cast<float>(yaw_raw) * YAW_LSB;
+    setpoint.action = static_cast<SwarmAction>((bits >> ACTION_SHIFT) & mask(ACTION_BITS));
+}
+
+size_t writeHeader(uint8_t* buffer, SwarmFrameType type, uint8_t sequence, uint8_t first_slot,  
+                   uint8_t count, uint32_t time_us) {
+    buffer[0] = SWARM_MAGIC;
+    buffer[1] = static_cast<uint8_t>(type);
+    buffer[2] = sequence;
+    buffer[3] = first_slot;
+    buffer[4] = count;
+    putU32(buffer + 5, time_us);
+    return SWARM_HEADER_SIZE;
+}
+
+size_t writeCrc(uint8_t* buffer, size_t length) {
+    const uint16_t crc = crc16(buffer, length);
+    buffer[length] = static_cast<uint8_t>(crc & 0xFF);
+    buffer[length + 1] = static_cast<uint8_t>(crc >> 8);
+    return length + SWARM_CRC_SIZE;
+}
+
+} // namespace
+
+size_t encodeSwarmSetpoints(uint8_t* buffer, size_t capacity, uint8_t sequence, uint8_t first_slot, 
+                            const SwarmSetpoint* setpoints, size_t count, uint32_t apply_time_us) {
+    const size_t length = SWARM_HEADER_SIZE + count * SWARM_SLOT_SIZE;
+    if (count > SWARM_SLOTS_PER_FRAME || first_slot + count > 256 || capacity < length + SWARM_CRC_SIZE) {
+        return 0;
+    }
+    
+    writeHeader(buffer, SwarmFrameType::SETPOINT, sequence, first_slot, static_cast<uint8_t>(count), apply_time_us);
+    for (size_t i = 0; i < count; i++) {
+        packSlot(buffer + SWARM_HEADER_SIZE + i * SWARM_SLOT_SIZE, setpoints[i]);
+    }
+    return writeCrc(buffer, length);
+}
+
+size_t encodeSwarmBeacon(uint8_t* buffer, size_t capacity, uint8_t sequence, uint32_t send_time_us) {
+    if (capacity < SWARM_HEADER_SIZE + SWARM_CRC_SIZE) {
+        return 0;
+    }
+    writeHeader(buffer, SwarmFrameType::BEACON, sequence, 0, 0, send_time_us);
+    return writeCrc(buffer, SWARM_HEADER_SIZE);
+}
+
+bool decodeSwarmHeader(const uint8_t* data, size_t length, SwarmHeader& header) {
+    if (data == nullptr || length < SWARM_HEADER_SIZE + SWARM_CRC_SIZE || data[0] != SWARM_MAGIC) {
+        return false;
+    }
+    const size_t body = SWARM_HEADER_SIZE + static_cast<size_t>(data[4]) * SWARM_SLOT_SIZE;
+    if (length != body + SWARM_CRC_SIZE) {
+        return false;
+    }
+    const uint16_t crc = static_cast<uint16_t>(data[body]) | (static_cast<uint16_t>(data[body + 1]) << 8);
+    if (crc16(data, body) != crc) {
+        return false;
+    }
+    
+    header.type = static_cast<SwarmFrameType>(data[1]);
+    header.sequence = data[2];
+    header.first_slot = data[3];
+    header.slot_count = data[4];
+    header.time_us = getU32(data + 5);
+    return header.type == SwarmFrameType::SETPOINT || header.type == SwarmFrameType::BEACON;
+}
+
+bool extractSwarmSlot(const uint8_t* data, const SwarmHeader& header, uint8_t slot, SwarmSetpoint& setpoint) {
+    if (header.type != SwarmFrameType::SETPOINT || slot < header.first_slot || 
+        slot - header.first_slot >= header.slot_count) {
+        return false;
+    }
+    // 自機のスロットだけを展開する
+    unpackSlot(data + SWARM_HEADER_SIZE + (slot - header.first_slot) * SWARM_SLOT_SIZE, setpoint);
+    return setpoint.action != SwarmAction::NONE;
+}
+
+} // namespace communication
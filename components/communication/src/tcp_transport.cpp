@@ -0,0 +1,147 @@
+/*
+ * TCP Transport Implementation
+ * 
+ * TCP送信路実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "tcp_transport.hpp"
+#include "esp_log.h"
+#include "lwip/sockets.h"
+#include <cerrno>
+
+namespace communication {
+
+static const char* TAG = "communication::TcpTransport";
+
+static timeval toTimeval(TickType_t ticks) {
+    uint32_t ms = ticks * portTICK_PERIOD_MS;
+    timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    return tv;
+}
+
+TcpTransport::TcpTransport()
+    : listener_(-1)
+    , client_(-1) {}
+
+TcpTransport::~TcpTransport() {
+    close();
+}
+
+esp_err_t TcpTransport::listen(uint16_t port) {
+    close();
+    listener_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener_ < 0) {
+        ESP_LOGE(TAG, "ソケット作成失敗 errno %d", errno);
+        return ESP_FAIL;
+    }
+    int reuse = 1;
+    setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(listener_, 1) != 0) {
+        ESP_LOGE(TAG, "待ち受け失敗 ポート %u errno %d", static_cast<unsigned>(port), errno);
+        close();
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "待ち受け開始 ポート %u", static_cast<unsigned>(port));
+    return ESP_OK;
+}
+
+esp_err_t TcpTransport::accept(TickType_t timeout) {
+    if (listener_ < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    disconnect();
+    
+    if (timeout != portMAX_DELAY) {
+        fd_set readable;
+        FD_ZERO(&readable);
+        FD_SET(listener_, &readable);
+        timeval tv = toTimeval(timeout);
+        if (select(listener_ + 1, &readable, nullptr, nullptr, &tv) <= 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+    
+    sockaddr_in peer = {};
+    socklen_t peer_length = sizeof(peer);
+    client_ = ::accept(listener_, reinterpret_cast<sockaddr*>(&peer), &peer_length);
+    if (client_ < 0) {
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "接続 %s:%u", inet_ntoa(peer.sin_addr), static_cast<unsigned>(ntohs(peer.sin_port)));
+    return ESP_OK;
+}
+
+esp_err_t TcpTransport::send(const void* data, size_t length) {
+    if (client_ < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (length > 0) {
+        int sent = ::send(client_, bytes, length, 0);
+        if (sent < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            ESP_LOGW(TAG, "送信失敗 errno %d（切断）", errno);
+            disconnect();
+            return ESP_ERR_INVALID_STATE;
+        }
+        bytes += sent;
+        length -= static_cast<size_t>(sent);
+    }
+    return ESP_OK;
+}
+
+esp_err_t TcpTransport::receive(void* buffer, size_t length, TickType_t timeout) {
+    if (client_ < 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timeval tv = toTimeval(timeout);
+    setsockopt(client_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    
+    uint8_t* bytes = static_cast<uint8_t*>(buffer);
+    while (length > 0) {
+        int received = recv(client_, bytes, length, 0);
+        if (received == 0) {
+            disconnect();
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK ? ESP_ERR_TIMEOUT : ESP_FAIL;
+        }
+        bytes += received;
+        length -= static_cast<size_t>(received);
+    }
+    return ESP_OK;
+}
+
+void TcpTransport::disconnect() {
+    if (client_ >= 0) {
+        shutdown(client_, SHUT_RDWR);
+        ::close(client_);
+        client_ = -1;
+    }
+}
+
+void TcpTransport::close() {
+    disconnect();
+    if (listener_ >= 0) {
+        ::close(listener_);
+        listener_ = -1;
+    }
+}
+
+} // namespace communication
@@ -0,0 +1,259 @@
+/*
+ * Telemetry Link Implementation
+ * 
+ * テレメトリリンク実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "telemetry_link.hpp"
+#include "esp_log.h"
+
+namespace communication {
+
+static const char* TAG = "communication::TelemetryLink";
+
+UartTransport::UartTransport(std::shared_ptr<hal::UartHal> uart)
+    : uart_(std::move(uart)) {
+}
+
+esp_err_t UartTransport::send(const void* data, size_t length) {
+    if (!uart_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 周期送信を詰まらせないため送信バッファ待ちはしない
+    return uart_->write(data, length, 0);
+}
+
+TelemetryLink::TelemetryLink(std::shared_ptr<Transport> transport, const Config& config)
+    : transport_(std::move(transport))
+    , config_(config)
+    , streams_{}
+    , stream_count_(0)
+    , tokens_(config.burst_bytes)
+    , last_refill_us_(0)
+    , sequence_(0)
+    , parser_(onFrame, this)
+    , rx_handler_(nullptr)
+    , rx_context_(nullptr) {
+}
+
+esp_err_t TelemetryLink::sendRaw(MessageId id, const void* payload, size_t length) {
+    if (!transport_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    uint8_t frame[MAX_FRAME_SIZE];
+    size_t frame_length = encodeFrame(frame, sizeof(frame), id, sequence_.fetch_add(1, std::memory_order_relaxed), 
+                                      payload, length);
+    if (frame_length == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    esp_err_t ret = transport_->send(frame, frame_length);
+    if (ret == ESP_OK) {
+        // 即時送信分も帯域として計上（周期送信側で吸収する）
+        std::lock_guard<std::mutex> lock(mutex_);
+        tokens_ -= static_cast<int64_t>(frame_length);
+    }
+    return ret;
+}
+
+esp_err_t TelemetryLink::registerStream(MessageId id, float rate_hz, FillFunction fill, void* context) {
+    if (fill == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Stream* stream = findStream(id);
+    if (stream == nullptr) {
+        if (stream_count_ >= MAX_STREAMS) {
+            ESP_LOGE(TAG, "ストリーム登録数上限");
+            return ESP_ERR_NO_MEM;
+        }
+        stream = &streams_[stream_count_++];
+    }
+    
+    stream->id = id;
+    stream->period_us = rateToPeriod(rate_hz);
+    stream->next_due_us = 0;
+    stream->fill = fill;
+    stream->context = context;
+    stream->stats = {};
+    stream->active = true;
+    
+    ESP_LOGI(TAG, "ストリーム登録 ID:0x%02X レート:%.1fHz", static_cast<unsigned>(id), rate_hz);
+    return ESP_OK;
+}
+
+esp_err_t TelemetryLink::setStreamRate(MessageId id, float rate_hz) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    Stream* stream = findStream(id);
+    if (stream == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    stream->period_us = rateToPeriod(rate_hz);
+    stream->next_due_us = 0;
+    return ESP_OK;
+}
+
+size_t TelemetryLink::update(int64_t now_us) {
+    if (!transport_) {
+        return 0;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    refillTokens(now_us);
+    
+    size_t sent = 0;
+    uint8_t payload[MAX_PAYLOAD_SIZE];
+    uint8_t frame[MAX_FRAME_SIZE];
+    
+    while (true) {
+        // 送信時刻を過ぎたストリームのうち最も古いものを選ぶ
+        Stream* due = nullptr;
+        for (size_t i = 0; i < stream_count_; i++) {
+            Stream& stream = streams_[i];
+            if (!stream.active || stream.period_us == 0 || stream.next_due_us > now_us) {
+                continue;
+            }
+            if (due == nullptr || stream.next_due_us < due->next_due_us) {
+                due = &stream;
+            }
+        }
+        if (due == nullptr) {
+            break;
+        }
+        
+        size_t length = due->fill(payload, sizeof(payload), due->context);
+        if (length > MAX_PAYLOAD_SIZE) {
+            length = 0;
+        }
+        if (length == 0) {
+            // 送るデータなし（次周期へ）
+            due->next_due_us = now_us + due->period_us;
+            continue;
+        }
+        
+        // 帯域が尽きたら終了（最古のストリームが次回先頭になる）
+        if (tokens_ < static_cast<int64_t>(FRAME_OVERHEAD + length)) {
+            break;
+        }
+        
+        size_t frame_length = encodeFrame(frame, sizeof(frame), due->id, 
+                                          sequence_.fetch_add(1, std::memory_order_relaxed), payload, length);
+        esp_err_t ret = transport_->send(frame, frame_length);
+        if (ret == ESP_OK) {
+            tokens_ -= static_cast<int64_t>(frame_length);
+            due->stats.sent++;
+            sent++;
+        } else {
+            due->stats.send_errors++;
+        }
+        
+        // 周期を維持し、1周期以上遅れた場合は追いつかずに飛ばす
+        due->next_due_us = (due->next_due_us == 0) ? now_us + due->period_us : due->next_due_us + due->period_us;
+        if (due->next_due_us <= now_us) {
+            due->stats.skipped++;
+            due->next_due_us = now_us + due->period_us;
+        }
+        
+        if (ret != ESP_OK) {
+            break;
+        }
+    }
+    
+    return sent;
+}
+
+void TelemetryLink::setRxHandler(RxHandler handler, void* context) {
+    rx_handler_ = handler;
+    rx_context_ = context;
+}
+
+void TelemetryLink::processRx(const uint8_t* data, size_t length) {
+    parser_.push(data, length);
+}
+
+size_t TelemetryLink::processRx(hal::UartHal& uart) {
+    size_t total = 0;
+    
+    // 折り返し時は2回に分かれる
+    for (int i = 0; i < 2; i++) {
+        hal::UartHal::RxRegion region = uart.peekRx();
+        if (region.length == 0) {
+            break;
+        }
+        parser_.push(region.data, region.length);
+        uart.consumeRx(region.length);
+        total += region.length;
+    }
+    return total;
+}
+
+esp_err_t TelemetryLink::getStreamStats(MessageId id, StreamStats& stats) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (size_t i = 0; i < stream_count_; i++) {
+        if (streams_[i].active && streams_[i].id == id) {
+            stats = streams_[i].stats;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void TelemetryLink::onFrame(const Frame& frame, void* context) {
+    TelemetryLink* self = static_cast<TelemetryLink*>(context);
+    if (self->rx_handler_) {
+        self->rx_handler_(frame, self->rx_context_);
+    }
+}
+
+void TelemetryLink::refillTokens(int64_t now_us) {
+    if (config_.link_bytes_per_sec == 0) {
+        // 帯域制限なし
+        tokens_ = config_.burst_bytes;
+        return;
+    }
+    if (last_refill_us_ == 0 || now_us < last_refill_us_) {
+        last_refill_us_ = now_us;
+        return;
+    }
+    
+    int64_t elapsed_us = now_us - last_refill_us_;
+    int64_t added = elapsed_us * config_.link_bytes_per_sec / 1000000;
+    if (added <= 0) {
+        return;
+    }
+    
+    // 端数を失わないよう補充分に相当する時間だけ進める
+    last_refill_us_ += added * 1000000 / config_.link_bytes_per_sec;
+    tokens_ += added;
+    if (tokens_ > static_cast<int64_t>(config_.burst_bytes)) {
+        tokens_ = config_.burst_bytes;
+    }
+}
+
+TelemetryLink::Stream* TelemetryLink::findStream(MessageId id) {
+    for (size_t i = 0; i < stream_count_; i++) {
+        if (streams_[i].id == id) {
+            return &streams_[i];
+        }
+    }
+    return nullptr;
+}
+
+uint32_t TelemetryLink::rateToPeriod(float rate_hz) {
+    if (!(rate_hz > 0.0f)) {
+        return 0;
+    }
+    return static_cast<uint32_t>(1000000.0f / rate_hz);
+}
+
+} // namespace communication
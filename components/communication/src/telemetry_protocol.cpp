@@ -0,0 +1,150 @@
+/*
+ * Telemetry Protocol Implementation
+ * 
+ * バイナリテレメトリ/コマンドプロトコル実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "telemetry_protocol.hpp"
+#include <cstring>
+
+namespace communication {
+
+uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc) {
+    for (size_t i = 0; i < length; i++) {
+        crc ^= static_cast<uint16_t>(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t encodeFrame(uint8_t* buffer, size_t capacity, MessageId id, uint8_t sequence, 
+                   const void* payload, size_t payload_length) {
+    if (payload_length > MAX_PAYLOAD_SIZE || capacity < FRAME_OVERHEAD + payload_length) {
+        return 0;
+    }
+    if (payload_length > 0) {
+        memcpy(buffer + FRAME_HEADER_SIZE, payload, payload_length);
+    }
+    return sealFrame(buffer, id, sequence, payload_length);
+}
+
+size_t sealFrame(uint8_t* buffer, MessageId id, uint8_t sequence, size_t payload_length) {
+    if (payload_length > MAX_PAYLOAD_SIZE) {
+        return 0;
+    }
+    
+    buffer[0] = FRAME_STX;
+    buffer[1] = static_cast<uint8_t>(payload_length);
+    buffer[2] = sequence;
+    buffer[3] = static_cast<uint8_t>(id);
+    
+    // LENからペイロード末尾までを対象にCRC計算
+    uint16_t crc = crc16(buffer + 1, FRAME_HEADER_SIZE - 1 + payload_length);
+    buffer[FRAME_HEADER_SIZE + payload_length] = static_cast<uint8_t>(crc & 0xFF);
+    buffer[FRAME_HEADER_SIZE + payload_length + 1] = static_cast<uint8_t>(crc >> 8);
+    
+    return FRAME_OVERHEAD + payload_length;
+}
+
+FrameParser::FrameParser(FrameHandler handler, void* context)
+    : handler_(handler)
+    , context_(context)
+    , state_(State::WAIT_STX)
+    , buffer_{}
+    , index_(0)
+    , crc_low_(0)
+    , last_sequence_(0)
+    , sequence_valid_(false)
+    , stats_{} {
+}
+
+void FrameParser::reset() {
+    state_ = State::WAIT_STX;
+    index_ = 0;
+    sequence_valid_ = false;
+}
+
+void FrameParser::push(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        
+        switch (state_) {
+        case State::WAIT_STX:
+            if (byte == FRAME_STX) {
+                index_ = 0;
+                state_ = State::LENGTH;
+            }
+            break;
+            
+        case State::LENGTH:
+            if (byte > MAX_PAYLOAD_SIZE) {
+                stats_.length_errors++;
+                state_ = (byte == FRAME_STX) ? State::LENGTH : State::WAIT_STX;
+                break;
+            }
+            buffer_[index_++] = byte;
+            state_ = State::SEQUENCE;
+            break;
+            
+        case State::SEQUENCE:
+            buffer_[index_++] = byte;
+            state_ = State::MESSAGE_ID;
+            break;
+            
+        case State::MESSAGE_ID:
+            buffer_[index_++] = byte;
+            state_ = (buffer_[0] == 0) ? State::CRC_LOW : State::PAYLOAD;
+            break;
+            
+        case State::PAYLOAD:
+            buffer_[index_++] = byte;
+            if (index_ >= FRAME_HEADER_SIZE - 1 + buffer_[0]) {
+                state_ = State::CRC_LOW;
+            }
+            break;
+            
+        case State::CRC_LOW:
+            crc_low_ = byte;
+            state_ = State::CRC_HIGH;
+            break;
+            
+        case State::CRC_HIGH: {
+            state_ = State::WAIT_STX;
+                
+            uint16_t received = static_cast<uint16_t>(crc_low_) | (static_cast<uint16_t>(byte) << 8);
+            if (crc16(buffer_, index_) != received) {
+                stats_.crc_errors++;
+                break;
+            }
+                
+            Frame frame;
+            frame.length = buffer_[0];
+            frame.sequence = buffer_[1];
+            frame.id = static_cast<MessageId>(buffer_[2]);
+            frame.payload = buffer_ + FRAME_HEADER_SIZE - 1;
+                
+            // シーケンス番号の欠落を計数（8bitで巡回）
+            if (sequence_valid_) {
+                stats_.sequence_gaps += static_cast<uint8_t>(frame.sequence - last_sequence_ - 1);
+            }
+            last_sequence_ = frame.sequence;
+            sequence_valid_ = true;
+            stats_.frames++;
+                
+            if (handler_) {
+                handler_(frame, context_);
+            }
+            break;
+        }
+        }
+    }
+}
+
+} // namespace communication
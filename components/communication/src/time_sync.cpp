@@ -0,0 +1,191 @@
+/*
+ * Time Sync Implementation
+ * 
+ * 地上局との時刻同期実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "time_sync.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstring>
+
+namespace communication {
+
+static const char* TAG = "communication::TimeSync";
+
+TimeSync::TimeSync(common::SyncedClock& clock)
+    : clock_(clock)
+    , config_()
+    , next_exchange_(1)
+    , stat_requests_(0)
+    , samples_{}
+    , sample_index_(0)
+    , sample_count_(0)
+    , last_exchange_(0)
+    , step_run_(0)
+    , anchor_{}
+    , anchor_valid_(false)
+    , model_{}
+    , stats_{} {
+}
+
+void TimeSync::makeRequest(TimeSyncRequestMessage& message, int64_t now_us) {
+    message.exchange = next_exchange_.fetch_add(1, std::memory_order_relaxed);
+    message.request_time_us = now_us;
+    stat_requests_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t TimeSync::fillRequest(uint8_t* buffer, size_t capacity, void* context) {
+    if (context == nullptr || capacity < sizeof(TimeSyncRequestMessage)) {
+        return 0;
+    }
+    TimeSyncRequestMessage message;
+    // t1はフレームを作る直前に取る（送信までの遅れは往復遅延に含まれ、対称性だけが崩れる）
+    static_cast<TimeSync*>(context)->makeRequest(message, esp_timer_get_time());
+    memcpy(buffer, &message, sizeof(message));
+    return sizeof(message);
+}
+
+bool TimeSync::handleFrame(const Frame& frame, int64_t now_us) {
+    TimeSyncResponseMessage response;
+    if (!frame.as(response)) {
+        return false;
+    }
+    return handleResponse(response, now_us);
+}
+
+bool TimeSync::handleResponse(const TimeSyncResponseMessage& response, int64_t now_us) {
+    stats_.responses++;
+    
+    // 重複・順序の入れ替わった応答、送っていない時刻の応答は使わない
+    const int64_t t1 = response.request_time_us;
+    const int64_t t2 = response.receive_time_us;
+    const int64_t t3 = response.transmit_time_us;
+    const int64_t t4 = now_us;
+    const bool stale = sample_count_ > 0 && static_cast<int32_t>(response.exchange - last_exchange_) <= 0;
+    if (stale || t1 > t4 || t3 < t2 || t4 - t1 > static_cast<int64_t>(config_.max_round_trip_us)) {
+        stats_.rejected++;
+        return false;
+    }
+    const int64_t round_trip = (t4 - t1) - (t3 - t2);
+    if (round_trip > static_cast<int64_t>(config_.max_round_trip_us)) {
+        stats_.rejected++;
+        return false;
+    }
+    last_exchange_ = response.exchange;
+    
+    Sample sample;
+    sample.local_us = t1 + (t4 - t1) / 2;
+    sample.offset_us = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.round_trip_us = static_cast<uint32_t>(round_trip > 0 ? round_trip : 0);
+    stats_.last_round_trip_us = sample.round_trip_us;
+    
+    // 予測から大きく外れた低遅延の交換が続く場合は地上の時計が飛んだとみなす
+    if (model_.valid) {
+        const int64_t residual = sample.offset_us - (model_.toSynced(sample.local_us) - sample.local_us);
+        stats_.last_residual_us = static_cast<int32_t>(residual);
+        const bool quiet = sample.round_trip_us <= stats_.min_round_trip_us + config_.quiet_margin_us;
+        if (quiet && (residual > config_.step_threshold_us || -residual > config_.step_threshold_us)) {
+            if (++step_run_ < config_.step_count) {
+                stats_.rejected++;
+                return false;
+            }
+            ESP_LOGW(TAG, "地上の時計の飛び %lldus 推定をやり直す", static_cast<long long>(residual));
+            reset();
+            stats_.resets++;
+            last_exchange_ = response.exchange;
+        } else {
+            step_run_ = 0;
+        }
+    }
+    
+    samples_[sample_index_] = sample;
+    sample_index_ = (sample_index_ + 1) % WINDOW;
+    if (sample_count_ < WINDOW) {
+        sample_count_++;
+    }
+    estimate();
+    return true;
+}
+
+const TimeSync::Sample& TimeSync::bestSample() const {
+    size_t best = 0;
+    for (size_t i = 1; i < sample_count_; i++) {
+        if (samples_[i].round_trip_us < samples_[best].round_trip_us) {
+            best = i;
+        }
+    }
+    return samples_[best];
+}
+
+void TimeSync::estimate() {
+    const Sample& best = bestSample();
+    stats_.min_round_trip_us = best.round_trip_us;
+    
+    // ドリフト: アンカーから窓内の最良の交換までの時刻差の変化（基線が短い間は前回の値）
+    double drift = static_cast<double>(model_.drift_ppb) * 1e-9;
+    if (!anchor_valid_) {
+        if (sample_count_ >= WINDOW / 2) {
+            anchor_ = best;
+            anchor_valid_ = true;
+        }
+    } else {
+        const int64_t span = best.local_us - anchor_.local_us;
+        if (span >= config_.min_drift_span_us) {
+            drift = static_cast<double>(best.offset_us - anchor_.offset_us) / static_cast<double>(span);
+            const double max_drift = static_cast<double>(config_.max_drift_ppb) * 1e-9;
+            drift = (drift > max_drift) ? max_drift : ((drift < -max_drift) ? -max_drift : drift);
+        }
+        if (span >= config_.max_drift_span_us) {
+            anchor_ = best;
+        }
+    }
+    
+    // 時刻差: 最良の交換を最新の交換の時刻まで延ばす
+    const int64_t reference = samples_[(sample_index_ + WINDOW - 1) % WINDOW].local_us;
+    model_.reference_us = reference;
+    model_.offset_us = best.offset_us + static_cast<int64_t>(drift * static_cast<double>(reference - best.local_us));
+    model_.drift_ppb = static_cast<int32_t>(drift * 1e9);
+    model_.update_count++;
+    model_.valid = true;
+    clock_.publish(model_);
+}
+
+void TimeSync::reset() {
+    sample_index_ = 0;
+    sample_count_ = 0;
+    step_run_ = 0;
+    anchor_valid_ = false;
+    model_ = common::ClockModel{};
+    stats_.min_round_trip_us = 0;
+    clock_.publish(model_);
+}
+
+TimeSync::Stats TimeSync::getStats() const {
+    Stats stats = stats_;
+    stats.requests = stat_requests_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void TimeSync::dump() const {
+    const Stats stats = getStats();
+    if (!model_.valid) {
+        ESP_LOGI(TAG, "未同期 要求 %lu 応答 %lu", static_cast<unsigned long>(stats.requests), 
+                 static_cast<unsigned long>(stats.responses));
+        return;
+    }
+    ESP_LOGI(TAG, "時刻差 %lldus ドリフト %.3fppm 更新 %lu", static_cast<long long>(model_.offset_us), 
+             model_.drift_ppb * 1e-3f, static_cast<unsigned long>(model_.update_count));
+    ESP_LOGI(TAG, "要求 %lu 応答 %lu 不採用 %lu やり直し %lu 往復 %luus（最小 %luus）予測誤差 %ldus", 
+             static_cast<unsigned long>(stats.requests), static_cast<unsigned long>(stats.responses), 
+             static_cast<unsigned long>(stats.rejected), static_cast<unsigned long>(stats.resets), 
+             static_cast<unsigned long>(stats.last_round_trip_us), static_cast<unsigned long>(stats.min_round_trip_us), 
+             static_cast<long>(stats.last_residual_us));
+}
+
+} // namespace communication
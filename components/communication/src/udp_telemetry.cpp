@@ -0,0 +1,304 @@
+/*
+ * UDP Telemetry Implementation
+ * 
+ * Wi-Fi UDPによる高レートテレメトリ送信実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "udp_telemetry.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lwip/pbuf.h"
+#include "lwip/priv/tcpip_priv.h"
+#include "lwip/tcpip.h"
+#include "lwip/udp.h"
+
+namespace communication {
+
+static const char* TAG = "communication::UdpTelemetry";
+
+namespace {
+
+/**
+ * @brief tcpipスレッドでのUDP制御ブロック操作の引数
+ */
+struct PcbCall {
+    tcpip_api_call_data base;   // lwIPの呼び出しデータ（先頭に置く）
+    udp_pcb** pcb;              // 操作する制御ブロック
+    const char* host;           // 送信先ホスト（開く場合）
+    uint16_t port;              // ポート（開く場合）
+    ip_addr_t* destination;     // 送信先アドレスの格納先
+    uint16_t* destination_port; // 送信先ポートの格納先
+    udp_recv_fn receive;        // 受信コールバック（nullptrで受信しない）
+    void* receive_arg;          // 受信コールバック引数
+};
+
+err_t openInTcpip(tcpip_api_call_data* data) {
+    PcbCall* call = reinterpret_cast<PcbCall*>(data);
+    if (ipaddr_aton(call->host, call->destination) == 0) {
+        return ERR_VAL;
+    }
+    *call->destination_port = call->port;
+    
+    udp_pcb* pcb = udp_new();
+    if (pcb == nullptr) {
+        return ERR_MEM;
+    }
+    err_t err = udp_bind(pcb, IP_ADDR_ANY, call->port);
+    if (err != ERR_OK) {
+        udp_remove(pcb);
+        return err;
+    }
+    ip_set_option(pcb, SOF_BROADCAST);
+    if (call->receive != nullptr) {
+        udp_recv(pcb, call->receive, call->receive_arg);
+    }
+    *call->pcb = pcb;
+    return ERR_OK;
+}
+
+err_t closeInTcpip(tcpip_api_call_data* data) {
+    PcbCall* call = reinterpret_cast<PcbCall*>(data);
+    if (*call->pcb != nullptr) {
+        udp_remove(*call->pcb);
+        *call->pcb = nullptr;
+    }
+    return ERR_OK;
+}
+
+} // namespace
+
+UdpTelemetry::UdpTelemetry()
+    : config_()
+    , streams_{}
+    , stream_count_(0)
+    , sequence_(0)
+    , pcb_(nullptr)
+    , destination_{}
+    , destination_port_(0)
+    , pending_(nullptr)
+    , task_(nullptr)
+    , running_(false)
+    , stat_datagrams_(0)
+    , stat_messages_(0)
+    , stat_dropped_(0)
+    , stat_alloc_failures_(0)
+    , stat_send_errors_(0) {
+}
+
+UdpTelemetry::~UdpTelemetry() {
+    stop();
+}
+
+esp_err_t UdpTelemetry::registerStream(MessageId id, float rate_hz, FillFunction fill, void* context) {
+    if (fill == nullptr || rate_hz <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (stream_count_ >= MAX_STREAMS) {
+        return ESP_ERR_NO_MEM;
+    }
+    streams_[stream_count_++] = Stream{id, static_cast<uint32_t>(1000000.0f / rate_hz), 0, fill, context};
+    return ESP_OK;
+}
+
+esp_err_t UdpTelemetry::start(const Config& config) {
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_OK;
+    }
+    if (config.datagram_size < FRAME_OVERHEAD + MAX_PAYLOAD_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config_ = config;
+    
+    PcbCall call = {};
+    call.pcb = &pcb_;
+    call.host = config_.host;
+    call.port = config_.port;
+    call.destination = &destination_;
+    call.destination_port = &destination_port_;
+    call.receive = config_.follow_sender ? onReceive : nullptr;
+    call.receive_arg = this;
+    err_t err = tcpip_api_call(openInTcpip, &call.base);
+    if (err != ERR_OK) {
+        ESP_LOGE(TAG, "UDP待ち受け失敗 %s:%u (%d)", config_.host, config_.port, static_cast<int>(err));
+        return (err == ERR_VAL) ? ESP_ERR_INVALID_ARG : ESP_FAIL;
+    }
+    
+    running_.store(true, std::memory_order_release);
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "udp_tlm", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        tcpip_api_call(closeInTcpip, &call.base);
+        ESP_LOGE(TAG, "送信タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "UDPテレメトリ開始 %s:%u ストリーム %u", config_.host, config_.port, 
+             static_cast<unsigned>(stream_count_));
+    return ESP_OK;
+}
+
+esp_err_t UdpTelemetry::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 送信タスクは1周期以内にtask_を消して自分を削除する
+    for (uint32_t waited = 0; waited <= config_.period_ms + 100 && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (task_ != nullptr) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    // tcpipスレッドは依頼を順に処理するため、戻った時点で依頼済みの送信は全て実行されている
+    PcbCall call = {};
+    call.pcb = &pcb_;
+    tcpip_api_call(closeInTcpip, &call.base);
+    
+    // 送信依頼に失敗して取り残したものがあれば破棄
+    pbuf* packet = pending_.exchange(nullptr, std::memory_order_acq_rel);
+    if (packet != nullptr) {
+        pbuf_free(packet);
+    }
+    return ESP_OK;
+}
+
+void UdpTelemetry::taskEntry(void* arg) {
+    UdpTelemetry* self = static_cast<UdpTelemetry*>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->config_.period_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->service(esp_timer_get_time());
+        vTaskDelayUntil(&last_wake, period);
+    }
+    
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void UdpTelemetry::service(int64_t now_us) {
+    pbuf* packet = nullptr;
+    uint8_t* payload = nullptr;
+    size_t used = 0;
+    uint32_t messages = 0;
+    
+    for (size_t i = 0; i < stream_count_; i++) {
+        Stream& stream = streams_[i];
+        if (now_us < stream.next_due_us) {
+            continue;
+        }
+        if (packet == nullptr) {
+            packet = pbuf_alloc(PBUF_TRANSPORT, config_.datagram_size, PBUF_RAM);
+            if (packet == nullptr) {
+                stat_alloc_failures_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            payload = static_cast<uint8_t*>(packet->payload);
+        }
+        // 1周期1データグラム、入りきらないストリームは次の周期へ回す
+        if (used + FRAME_OVERHEAD + MAX_PAYLOAD_SIZE > config_.datagram_size) {
+            break;
+        }
+        
+        // ペイロードはpbufの中へ直接生成し、その前後にヘッダとCRCを書く
+        const size_t length = stream.fill(payload + used + FRAME_HEADER_SIZE, MAX_PAYLOAD_SIZE, stream.context);
+        if (length > 0) {
+            used += sealFrame(payload + used, stream.id, sequence_++, length);
+            messages++;
+        }
+        stream.next_due_us += stream.period_us;
+        if (stream.next_due_us <= now_us) {
+            stream.next_due_us = now_us + stream.period_us;
+        }
+    }
+    
+    if (packet == nullptr) {
+        return;
+    }
+    if (used == 0) {
+        pbuf_free(packet);
+        return;
+    }
+    pbuf_realloc(packet, static_cast<uint16_t>(used));
+    stat_messages_.fetch_add(messages, std::memory_order_relaxed);
+    submit(packet);
+}
+
+void UdpTelemetry::submit(pbuf* packet) {
+    stat_datagrams_.fetch_add(1, std::memory_order_relaxed);
+    pbuf* previous = pending_.exchange(packet, std::memory_order_acq_rel);
+    if (previous != nullptr) {
+        // 前の依頼はまだ実行されていない: その依頼で新しい方を送らせ、古い方は捨てる
+        pbuf_free(previous);
+        stat_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (tcpip_try_callback(sendInTcpip, this) != ERR_OK) {
+        // 依頼キューが満杯（tcpipスレッドが詰まっている）: 待たずに捨てる
+        pbuf* unsent = pending_.exchange(nullptr, std::memory_order_acq_rel);
+        if (unsent != nullptr) {
+            pbuf_free(unsent);
+            stat_dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void UdpTelemetry::sendInTcpip(void* context) {
+    UdpTelemetry* self = static_cast<UdpTelemetry*>(context);
+    pbuf* packet = self->pending_.exchange(nullptr, std::memory_order_acq_rel);
+    if (packet == nullptr) {
+        return;
+    }
+    if (self->pcb_ == nullptr ||
+        udp_sendto(self->pcb_, packet, &self->destination_, self->destination_port_) != ERR_OK) {
+        self->stat_send_errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    pbuf_free(packet);
+}
+
+void UdpTelemetry::onReceive(void* arg, udp_pcb* pcb, pbuf* packet, const ip_addr_t* address, uint16_t port) {
+    (void)pcb;
+    UdpTelemetry* self = static_cast<UdpTelemetry*>(arg);
+    // 地上局は任意のデータグラムを送ることで送信先を自分に切り替えられる
+    if (address != nullptr) {
+        ip_addr_copy(self->destination_, *address);
+        self->destination_port_ = port;
+    }
+    if (packet != nullptr) {
+        pbuf_free(packet);
+    }
+}
+
+UdpTelemetry::Stats UdpTelemetry::getStats() const {
+    Stats stats;
+    stats.datagrams = stat_datagrams_.load(std::memory_order_relaxed);
+    stats.messages = stat_messages_.load(std::memory_order_relaxed);
+    stats.dropped = stat_dropped_.load(std::memory_order_relaxed);
+    stats.alloc_failures = stat_alloc_failures_.load(std::memory_order_relaxed);
+    stats.send_errors = stat_send_errors_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UdpTelemetry::dump() const {
+    const Stats stats = getStats();
+    ESP_LOGI(TAG, "%s ポート %u ストリーム %u", running_.load(std::memory_order_relaxed) ? "送信中" : "停止", 
+             config_.port, static_cast<unsigned>(stream_count_));
+    ESP_LOGI(TAG, "データグラム %lu メッセージ %lu 破棄 %lu 確保失敗 %lu 送信失敗 %lu", 
+             static_cast<unsigned long>(stats.datagrams), static_cast<unsigned long>(stats.messages), 
+             static_cast<unsigned long>(stats.dropped), static_cast<unsigned long>(stats.alloc_failures), 
+             static_cast<unsigned long>(stats.send_errors));
+}
+
+} // namespace communication
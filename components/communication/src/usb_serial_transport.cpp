@@ -0,0 +1,130 @@
+/*
+ * USB Serial Transport Implementation
+ * 
+ * USB Serial/JTAG送信路実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "usb_serial_transport.hpp"
+#include "driver/usb_serial_jtag.h"
+#include "esp_log.h"
+
+namespace communication {
+
+static const char* TAG = "communication::UsbSerialTransport";
+
+namespace {
+
+constexpr size_t RX_CHUNK_SIZE = 128;               // poll()の1回の読み出し量
+constexpr int MAX_RX_CHUNKS = 4;                    // poll()1回あたりの読み出し回数の上限
+
+} // namespace
+
+UsbSerialTransport::UsbSerialTransport()
+    : installed_(false)
+    , stat_frames_(0)
+    , stat_bytes_(0)
+    , stat_dropped_(0)
+    , stat_disconnected_(0)
+    , stat_rx_bytes_(0) {}
+
+UsbSerialTransport::~UsbSerialTransport() {
+    stop();
+}
+
+esp_err_t UsbSerialTransport::start(const Config& config) {
+    if (installed_) {
+        return ESP_OK;
+    }
+    
+    usb_serial_jtag_driver_config_t driver_config = USB_SERIAL_JTAG_DRIVER_CONFIG_DEFAULT();
+    driver_config.tx_buffer_size = config.tx_buffer_size;
+    driver_config.rx_buffer_size = config.rx_buffer_size;
+    esp_err_t ret = usb_serial_jtag_driver_install(&driver_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ドライバインストール失敗（コンソール設定を確認）: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    installed_ = true;
+    
+    ESP_LOGI(TAG, "開始 送信リング %luB 受信リング %luB ホスト%s", static_cast<unsigned long>(config.tx_buffer_size), 
+             static_cast<unsigned long>(config.rx_buffer_size), isConnected() ? "接続中" : "未接続");
+    return ESP_OK;
+}
+
+void UsbSerialTransport::stop() {
+    if (!installed_) {
+        return;
+    }
+    usb_serial_jtag_driver_uninstall();
+    installed_ = false;
+}
+
+esp_err_t UsbSerialTransport::send(const void* data, size_t length) {
+    if (!installed_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 未接続のまま送信リングを埋めると、接続直後に古いフレームがまとめて届くため入れない
+    if (!usb_serial_jtag_is_connected()) {
+        stat_disconnected_.fetch_add(1, std::memory_order_relaxed);
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 送信リングはバイトバッファ型で、入る場合は全体、入らない場合は0を返す
+    int written = usb_serial_jtag_write_bytes(data, length, 0);
+    if (written != static_cast<int>(length)) {
+        stat_dropped_.fetch_add(1, std::memory_order_relaxed);
+        return ESP_ERR_TIMEOUT;
+    }
+    stat_frames_.fetch_add(1, std::memory_order_relaxed);
+    stat_bytes_.fetch_add(static_cast<uint32_t>(length), std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+size_t UsbSerialTransport::poll(TelemetryLink& link) {
+    if (!installed_) {
+        return 0;
+    }
+    uint8_t buffer[RX_CHUNK_SIZE];
+    size_t total = 0;
+    for (int i = 0; i < MAX_RX_CHUNKS; i++) {
+        int length = usb_serial_jtag_read_bytes(buffer, sizeof(buffer), 0);
+        if (length <= 0) {
+            break;
+        }
+        link.processRx(buffer, static_cast<size_t>(length));
+        total += static_cast<size_t>(length);
+        if (static_cast<size_t>(length) < sizeof(buffer)) {
+            break;
+        }
+    }
+    stat_rx_bytes_.fetch_add(static_cast<uint32_t>(total), std::memory_order_relaxed);
+    return total;
+}
+
+bool UsbSerialTransport::isConnected() const {
+    return installed_ && usb_serial_jtag_is_connected();
+}
+
+UsbSerialTransport::Stats UsbSerialTransport::getStats() const {
+    Stats stats = {};
+    stats.frames = stat_frames_.load(std::memory_order_relaxed);
+    stats.bytes = stat_bytes_.load(std::memory_order_relaxed);
+    stats.dropped = stat_dropped_.load(std::memory_order_relaxed);
+    stats.disconnected = stat_disconnected_.load(std::memory_order_relaxed);
+    stats.rx_bytes = stat_rx_bytes_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UsbSerialTransport::dump() const {
+    const Stats s = getStats();
+    ESP_LOGI(TAG, "ホスト%s 送信 %lu フレーム / %lu バイト 破棄 %lu（満杯） %lu（未接続） 受信 %lu バイト", 
+             isConnected() ? "接続中" : "未接続", static_cast<unsigned long>(s.frames), 
+             static_cast<unsigned long>(s.bytes), static_cast<unsigned long>(s.dropped), 
+             static_cast<unsigned long>(s.disconnected), static_cast<unsigned long>(s.rx_bytes));
+}
+
+} // namespace communication
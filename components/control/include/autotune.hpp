@@ -0,0 +1,293 @@
+/*
+ * Autotune
+ * 
+ * 飛行中の角速度ループの系同定とPIDゲインの提案
+ * 各軸の制御出力へチャープまたはPRBSの励起を加え、逐次最小二乗法で機体モデルを推定し、
+ * 推定したモデルから角速度PIDのゲインを求めてパラメータレジストリへ書き込む
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef AUTOTUNE_HPP
+#define AUTOTUNE_HPP
+
+#include "online_stats.hpp"
+#include "param_registry.hpp"
+#include "recursive_least_squares.hpp"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace control {
+
+/**
+ * @brief オートチューンクラス（ロール・ピッチ・ヨーの3軸）
+ * 
+ * 角速度ループの機体モデルを「角加速度が一次遅れで出力に従う」積分系 ω/u = K / (s (τs + 1)) e^{-sL} とし、
+ * 角速度の差分から求めた角加速度 a[k] = (ω[k] - ω[k-1]) / T と振幅Aで正規化した入力 v = u / A について
+ *   a[k] = p a[k-1] + g0 v[k-1-d] + g1 v[k-2-d] + c    （p = e^{-T/τ}、g0 + g1 = K A (1 - p)、cは外乱の偏り）
+ * の4係数を軸毎に RecursiveLeastSquares で推定する。むだ時間 d（0〜MAX_DELAY-1サンプル）は
+ * 候補毎に推定器を並べ、予測誤差の分散が最小のものを採る。サンプルは保存しない。
+ * 差分は測定雑音を強めて係数を偏らせるため、角速度と入力の両方へ同じローパスを掛けてから回帰する
+ * （同じ線形フィルタを通した信号の間でもモデルは変わらない）。
+ * 
+ * ゲインはSIMC則（積分系 + 一次遅れ）で求める（L = (d + 0.5)T、τc = max(response_s, L)）:
+ *   Kc = 1 / (K (τc + L))、Ti = 4 (τc + L)、Td = τ を並列形 kp = Kc (1 + Td / Ti)、ki = Kc / Ti、kd = Kc Td へ直す。
+ * 
+ * 使用例（姿勢制御タスク、角速度ループの直後）:
+ *   pid.computeRate(rate_target, rate, output);
+ *   autotune.update(rate, output);      // 励起の加算と推定（集計中のみ）
+ *   mixer.mix(..., output, ...);
+ * 軸は1つずつ、整定（励起なし）→ 励起 の順に進む。角速度の上限超過・abort() で止め、ゲインは変えない。
+ * 全軸が終わったら着陸後に apply() で提案ゲインをレジストリへ書き込む（保存はレジストリの遅延保存）。
+ * update() はログを出さないため、結果はCLIの dump() で確認する
+ */
+class Autotune {
+public:
+    static constexpr size_t AXES = 3;           // 軸数（ロール・ピッチ・ヨー）
+    static constexpr size_t MAX_DELAY = 4;      // むだ時間の候補数（0〜MAX_DELAY-1サンプル）
+    static constexpr size_t HISTORY = MAX_DELAY + 1;    // 入力の履歴の長さ
+    static constexpr size_t MODEL_SIZE = 4;     // 推定する係数の数（p, g0, g1, c）
+    
+    /**
+     * @brief 励起信号の種類
+     */
+    enum class Signal : uint8_t {
+        CHIRP = 0,          // 指数掃引の正弦波
+        PRBS                // 最大長系列（M系列）の±振幅
+    };
+    
+    /**
+     * @brief 状態列挙型
+     */
+    enum class State : uint8_t {
+        IDLE = 0,           // 未開始
+        SETTLING,           // 励起前の整定待ち
+        EXCITING,           // 励起・推定中
+        DONE,               // 全軸終了（提案ゲインあり）
+        ABORTED             // 中断
+    };
+    
+    /**
+     * @brief 中断理由
+     */
+    enum class AbortReason : uint8_t {
+        NONE = 0,
+        RATE_LIMIT,         // 角速度が上限を超えた
+        REQUESTED           // abort()（スティック操作・モード変更等）
+    };
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        float sample_hz = 400.0f;                       // 角速度ループの周波数（Hz）
+        uint8_t axis_mask = 0x07;                       // 対象軸（bit0: ロール、bit1: ピッチ、bit2: ヨー）
+        Signal signal = Signal::CHIRP;                  // 励起信号
+        float amplitude[AXES] = {0.08f, 0.08f, 0.15f};  // 励起の振幅（制御出力の単位、ヨーは効きが弱いため大きく）
+        float chirp_start_hz = 1.0f;                    // チャープの開始周波数（Hz）
+        float chirp_end_hz = 40.0f;                     // チャープの終了周波数（Hz）
+        uint8_t prbs_order = 9;                         // PRBSのシフトレジスタ長（5〜15、周期 2^n - 1）
+        uint8_t prbs_hold = 2;                          // PRBSの1ビットを保持するサンプル数
+        float settle_s = 1.0f;                          // 各軸の励起前の整定時間（s）
+        float excite_s = 8.0f;                          // 各軸の励起時間（s）
+        float forgetting = 0.999f;                      // 逐次最小二乗の忘却係数
+        float prefilter_hz = 10.0f;                     // 角速度・入力に同じく掛けるローパス（Hz、0でなし）
+        float max_rate_rad_s = 6.0f;                    // 中断する角速度（rad/s、全軸）
+        float min_fit = 0.5f;                           // 採用するモデルの説明率（1 - 誤差分散 / 角加速度の分散）
+        float response_s = 0.04f;                       // 目標の閉ループ時定数 τc（s、小さいほど強いゲイン）
+    };
+    
+    /**
+     * @brief 推定した軸のモデル
+     */
+    struct Model {
+        float gain;             // K（rad/s^2 / 出力）
+        float tau_s;            // τ（s）
+        uint8_t delay;          // むだ時間 d（サンプル）
+        uint8_t valid;          // 採用した（係数が物理的で説明率が min_fit 以上）
+        float fit;              // 説明率
+        uint32_t samples;       // 推定に使ったサンプル数
+    };
+    
+    /**
+     * @brief 提案ゲイン（CascadedPid::AxisConfig の rate_kp・rate_ki・rate_kd）
+     */
+    struct Gains {
+        float kp;
+        float ki;
+        float kd;
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t runs;          // start()の回数
+        uint32_t completed;     // 全軸終えた回数
+        uint32_t aborted;       // 中断した回数
+        uint32_t rejected;      // モデルを採用しなかった軸数
+        uint32_t applied;       // apply()で書き込んだ軸数
+    };
+    
+public:
+    Autotune();
+    
+    /**
+     * @brief 開始（対象軸の最初から、前回の結果は消える）
+     * @param config 設定
+     * @return esp_err_t 周波数・対象軸・PRBSの長さが不正な場合ESP_ERR_INVALID_ARG
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 開始（既定設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 中断（励起を止める、提案ゲインは作らない）
+     */
+    void abort() { stop(AbortReason::REQUESTED); }
+    
+    /**
+     * @brief 1周期の処理（角速度ループの出力へ励起を加え、推定を進める、IRAM配置）
+     * @param rate 角速度（rad/s、AXES要素）
+     * @param output 角速度ループの出力（AXES要素、励起を加えて±1で制限する）
+     * @return bool 励起を加えた場合true
+     */
+    bool IRAM_ATTR update(const float* rate, float* output);
+    
+    /**
+     * @brief 実行中か（整定・励起中）
+     */
+    bool isActive() const { return state_ == State::SETTLING || state_ == State::EXCITING; }
+    
+    /**
+     * @brief 状態取得
+     */
+    State getState() const { return state_; }
+    
+    /**
+     * @brief 実行中の軸
+     */
+    size_t getAxis() const { return axis_; }
+    
+    /**
+     * @brief 推定したモデル
+     * @param axis 軸
+     */
+    const Model& getModel(size_t axis) const { return models_[axis]; }
+    
+    /**
+     * @brief 提案ゲイン（モデルを採用した軸のみ有効）
+     * @param axis 軸
+     */
+    const Gains& getProposal(size_t axis) const { return proposals_[axis]; }
+    
+    /**
+     * @brief 提案ゲインのレジストリへの書き込み（採用した軸のみ、パラメータの範囲で制限する）
+     * @param registry パラメータレジストリ
+     * @return esp_err_t 終了前はESP_ERR_INVALID_STATE、採用した軸がない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t apply(params::ParamRegistry& registry);
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態名
+     */
+    static const char* stateName(State state);
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief むだ時間の候補毎の推定器
+     */
+    struct Candidate {
+        common::RecursiveLeastSquares<MODEL_SIZE> rls;  // 係数 p, g0, g1, c
+        common::RunningStats<float> error;              // 予測誤差（rad/s^2）
+    };
+    
+    Config config_;                         // 設定
+    State state_;                           // 状態
+    AbortReason abort_reason_;              // 中断理由
+    size_t axis_;                           // 実行中の軸
+    uint32_t sample_;                       // 状態内のサンプル番号
+    uint32_t settle_samples_;               // 整定のサンプル数
+    uint32_t excite_samples_;               // 励起のサンプル数
+    float dt_;                              // 周期（s）
+    
+    // 励起信号
+    float phase_;                           // チャープの位相（rad）
+    float phase_step_;                      // チャープの1サンプルの位相の進み（rad）
+    float phase_growth_;                    // チャープの周波数の1サンプル毎の倍率
+    uint32_t lfsr_;                         // PRBSのシフトレジスタ
+    uint32_t lfsr_taps_;                    // PRBSの帰還（Galois形式）
+    float prbs_level_;                      // PRBSの現在値（±1）
+    
+    // 推定
+    Candidate candidates_[MAX_DELAY];       // むだ時間の候補
+    common::RunningStats<float> response_;  // 角加速度（rad/s^2）
+    float prefilter_alpha_;                 // 前置ローパス係数
+    float filtered_rate_;                   // ローパス後の角速度
+    float filtered_input_;                  // ローパス後の入力
+    float input_history_[HISTORY];          // 過去の入力（ローパス・正規化後、[0]が1サンプル前）
+    float last_rate_;                       // 前回の角速度（ローパス後）
+    float last_accel_;                      // 前回の角加速度（rad/s^2）
+    float input_scale_;                     // 入力の正規化（1 / 振幅）
+    bool primed_;                           // 前回値あり
+    
+    Model models_[AXES];                    // 推定結果
+    Gains proposals_[AXES];                 // 提案ゲイン
+    Stats stats_;                           // 統計情報
+    
+    /**
+     * @brief 次の対象軸の整定を始める（なければ終了）
+     * @param first 最初の軸から探す
+     */
+    void nextAxis(bool first);
+    
+    /**
+     * @brief 励起の開始（推定器・信号の初期化）
+     */
+    void beginExcitation();
+    
+    /**
+     * @brief 励起信号の1サンプル（±1に正規化）
+     */
+    float IRAM_ATTR excitation();
+    
+    /**
+     * @brief 推定の1サンプル
+     * @param rate 角速度（rad/s）
+     * @param input 加えた出力
+     * @param learn 推定器を更新する（falseは履歴のみ進める）
+     */
+    void IRAM_ATTR identify(float rate, float input, bool learn);
+    
+    /**
+     * @brief 軸の推定結果の確定とゲインの計算
+     */
+    void finishAxis();
+    
+    /**
+     * @brief 停止
+     */
+    void stop(AbortReason reason);
+};
+
+} // namespace control
+
+#endif // AUTOTUNE_HPP
@@ -0,0 +1,203 @@
+/*
+ * Battery Model
+ * 
+ * 内部抵抗のオンライン推定による電圧降下補償（ヘッダーオンリー）
+ * 端子電圧 = 開放電圧 - 内部抵抗 × 電流 を再帰最小二乗でO(1)推定し、
+ * 電圧に比例して落ちる推力をモーター指令の倍率で補う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BATTERY_MODEL_HPP
+#define BATTERY_MODEL_HPP
+
+#include "esp_attr.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace control {
+
+/**
+ * @brief バッテリーモデルクラス
+ * 
+ * 低レートのグループ（AdcHalで電圧を読む周期）で update() を呼び、
+ * 開放電圧と内部抵抗を忘却係数付きの2変数再帰最小二乗で推定する（1回あたり固定の数十演算）。
+ * 内部抵抗は放電・温度（低温で増える）で変わるため、再チューニングなしで追従させる。
+ * 
+ * プロペラの推力はおおよそ (指令 × 電圧)² に比例するため、補償倍率は
+ * 基準電圧 / 推定した負荷時の電圧 とし、制御タスクが毎周期 compensate() でミキサー出力に掛ける。
+ * 倍率はアトミックに公開するため、推定と補償は別タスクでよい。
+ * 電流センサーがない機体は modelCurrent() でモーター出力から電流を見積もって渡す
+ * （抵抗の絶対値は見積もりの係数を含むが、補償倍率は電圧の比なので同じ効果になる）
+ */
+class BatteryModel {
+public:
+    /**
+     * @brief バッテリーモデル設定構造体
+     */
+    struct Config {
+        float reference_v = 3.8f;           // 補償の基準電圧（V、この電圧で調整したゲインを保つ）
+        float initial_ocv_v = 4.2f;         // 開放電圧の初期値（V）
+        float initial_resistance = 0.15f;   // 内部抵抗の初期値（Ω）
+        float resistance_min = 0.02f;       // 内部抵抗の下限（Ω）
+        float resistance_max = 1.0f;        // 内部抵抗の上限（Ω）
+        float forgetting = 0.995f;          // 忘却係数（1に近いほど長い履歴）
+        float covariance_limit = 100.0f;    // 共分散の上限（電流が一定で励起がない間の発散を防ぐ）
+        float min_voltage_v = 3.0f;         // 補償に使う電圧の下限（V）
+        float max_scale = 1.3f;             // 補償倍率の上限
+        float motor_current_a = 2.5f;       // 電流の見積もり: 出力1.0でのモーター1個の電流（A）
+    };
+    
+    /**
+     * @brief 推定状態
+     */
+    struct Estimate {
+        float ocv_v;                        // 開放電圧（V）
+        float resistance;                   // 内部抵抗（Ω）
+        float loaded_v;                     // 直近の電流での推定端子電圧（V）
+        float scale;                        // 補償倍率
+        uint32_t updates;                   // 更新回数
+    };
+    
+public:
+    BatteryModel() {
+        setConfig(Config{});
+    }
+    
+    /**
+     * @brief 設定（推定を初期値へ戻す）
+     * @param config バッテリーモデル設定
+     */
+    void setConfig(const Config& config) {
+        config_ = config;
+        reset();
+    }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 推定を初期値へ戻す（バッテリー交換時）
+     */
+    void reset() {
+        ocv_ = config_.initial_ocv_v;
+        resistance_ = config_.initial_resistance;
+        loaded_v_ = config_.initial_ocv_v;
+        // 開放電圧は初期値を大きく外れうるため大きめ、抵抗は初期値をある程度信じる
+        p00_ = 1.0f;
+        p01_ = 0.0f;
+        p11_ = 0.1f;
+        updates_ = 0;
+        scale_.store(1.0f, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief 電圧・電流サンプルで推定を更新（低レートのグループから呼ぶ）
+     * @param voltage_v 端子電圧（V）
+     * @param current_a 放電電流（A）
+     */
+    void update(float voltage_v, float current_a) {
+        // 回帰: v = ocv - R·i（φ = [1, -i]、θ = [ocv, R]）
+        const float phi1 = -current_a;
+        const float p_phi0 = p00_ + p01_ * phi1;
+        const float p_phi1 = p01_ + p11_ * phi1;
+        // 共分散が上限に達している間は忘却しない（一定電流のホバリング中の発散を防ぐ）
+        const float lambda = (p00_ + p11_ > config_.covariance_limit) ? 1.0f : config_.forgetting;
+        const float denom = lambda + p_phi0 + phi1 * p_phi1;
+        const float k0 = p_phi0 / denom;
+        const float k1 = p_phi1 / denom;
+        const float error = voltage_v - (ocv_ + phi1 * resistance_);
+        
+        ocv_ += k0 * error;
+        resistance_ += k1 * error;
+        if (resistance_ < config_.resistance_min) {
+            resistance_ = config_.resistance_min;
+        } else if (resistance_ > config_.resistance_max) {
+            resistance_ = config_.resistance_max;
+        }
+        
+        const float inv_lambda = 1.0f / lambda;
+        p00_ = (p00_ - k0 * p_phi0) * inv_lambda;
+        p01_ = (p01_ - k0 * p_phi1) * inv_lambda;
+        p11_ = (p11_ - k1 * p_phi1) * inv_lambda;
+        updates_++;
+        
+        // 測定雑音を含まない負荷時の電圧で倍率を決める
+        loaded_v_ = ocv_ - resistance_ * current_a;
+        float loaded = loaded_v_ > config_.min_voltage_v ? loaded_v_ : config_.min_voltage_v;
+        float scale = config_.reference_v / loaded;
+        if (scale > config_.max_scale) {
+            scale = config_.max_scale;
+        }
+        scale_.store(scale, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief モーター出力からの電流の見積もり（電流センサーがない場合）
+     * 
+     * モーター電流は出力のおよそ1.5乗に比例する
+     * @param outputs モーター出力（0.0-1.0）
+     * @param count モーター数
+     * @return float 見積もった電流（A）
+     */
+    float modelCurrent(const float* outputs, size_t count) const {
+        float sum = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            const float u = outputs[i] > 0.0f ? outputs[i] : 0.0f;
+            sum += u * __builtin_sqrtf(u);
+        }
+        return config_.motor_current_a * sum;
+    }
+    
+    /**
+     * @brief 補償倍率取得（制御タスクから呼べる）
+     */
+    float getScale() const { return scale_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief ミキサー出力へ補償倍率を掛ける（制御タスク、IRAM配置）
+     * @param outputs モーター出力（0.0-1.0、上書き）
+     * @param count モーター数
+     * @param output_max 出力上限
+     */
+    void IRAM_ATTR compensate(float* outputs, size_t count, float output_max = 1.0f) const {
+        const float scale = scale_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; i++) {
+            const float out = outputs[i] * scale;
+            outputs[i] = out < output_max ? out : output_max;
+        }
+    }
+    
+    /**
+     * @brief 推定状態取得（低レートのグループ・CLIから）
+     * @return Estimate 推定状態
+     */
+    Estimate getEstimate() const {
+        Estimate estimate;
+        estimate.ocv_v = ocv_;
+        estimate.resistance = resistance_;
+        estimate.loaded_v = loaded_v_;
+        estimate.scale = getScale();
+        estimate.updates = updates_;
+        return estimate;
+    }
+    
+private:
+    Config config_;                     // 設定
+    float ocv_;                         // 開放電圧の推定（V）
+    float resistance_;                  // 内部抵抗の推定（Ω）
+    float loaded_v_;                    // 推定端子電圧（V）
+    float p00_, p01_, p11_;             // 共分散（対称2×2）
+    uint32_t updates_;                  // 更新回数
+    std::atomic<float> scale_;          // 補償倍率（制御タスクへ公開）
+};
+
+} // namespace control
+
+#endif // BATTERY_MODEL_HPP
@@ -0,0 +1,219 @@
+/*
+ * Cascaded PID Controller
+ * 
+ * 角度→角速度の2段カスケードPID（ヘッダーオンリー）
+ * 軸毎の状態を配列（SoA）で持ち、全軸を1回の呼び出しで計算する。
+ * 仮想関数・動的確保を使わず、軸数はコンパイル時に決まる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef CASCADED_PID_HPP
+#define CASCADED_PID_HPP
+
+#include "esp_attr.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace control {
+
+/**
+ * @brief カスケードPID制御器テンプレート
+ * 
+ * 外側の角度ループ（P）が目標角速度を作り、内側の角速度ループ（PID + フィードフォワード）が出力を作る。
+ * 微分項は測定値の微分（目標変化によるキックなし）で、微分前に1次ローパスを通す。
+ * 積分は出力飽和中に飽和を深める向きには積まず（条件付き積分）、さらに上限で制限する。
+ * サンプリング周期は設定で固定し、係数はsetConfig()で前計算しておく
+ * @tparam AXES 軸数（ロール・ピッチ・ヨーで3）
+ */
+template<size_t AXES>
+class CascadedPid {
+    static_assert(AXES > 0, "軸数は1以上");
+    
+public:
+    /**
+     * @brief 軸毎のゲイン設定構造体
+     */
+    struct AxisConfig {
+        float angle_kp = 6.0f;              // 角度ループ比例ゲイン（1/s）
+        float rate_limit = 4.0f;            // 角度ループが出す目標角速度の上限（rad/s）
+        float rate_kp = 0.6f;               // 角速度ループ比例ゲイン
+        float rate_ki = 0.4f;               // 角速度ループ積分ゲイン
+        float rate_kd = 0.008f;             // 角速度ループ微分ゲイン
+        float rate_ff = 0.0f;               // 目標角速度のフィードフォワードゲイン
+        float integral_limit = 0.3f;        // 積分項の上限（出力単位）
+        float output_limit = 1.0f;          // 出力の上限（対称）
+        float d_cutoff_hz = 80.0f;          // 微分前ローパスのカットオフ（Hz、0でフィルタなし）
+    };
+    
+    /**
+     * @brief 制御器設定構造体
+     */
+    struct Config {
+        float sample_hz = 400.0f;           // 制御周波数（Hz）
+        AxisConfig axis[AXES];              // 軸毎の設定
+    };
+    
+public:
+    CascadedPid() {
+        setConfig(Config{});
+    }
+    
+    /**
+     * @brief 設定（係数を前計算し、状態をクリアする）
+     * @param config 制御器設定
+     */
+    void setConfig(const Config& config) {
+        reset();
+        setGains(config);
+    }
+    
+    /**
+     * @brief 飛行中のゲイン変更（係数だけを前計算し直し、積分項・微分フィルタは保つ）
+     * 
+     * 積分項は出力単位で持つため、積分ゲインを変えても出力は跳ばない。
+     * 制御周期の境界（compute()の前）で呼ぶ
+     * @param config 制御器設定
+     */
+    void setGains(const Config& config) {
+        config_ = config;
+        dt_ = 1.0f / config.sample_hz;
+        for (size_t a = 0; a < AXES; a++) {
+            const AxisConfig& c = config.axis[a];
+            angle_kp_[a] = c.angle_kp;
+            rate_limit_[a] = c.rate_limit;
+            kp_[a] = c.rate_kp;
+            ki_dt_[a] = c.rate_ki * dt_;
+            kd_fs_[a] = c.rate_kd * config.sample_hz;
+            kff_[a] = c.rate_ff;
+            integral_limit_[a] = c.integral_limit;
+            output_limit_[a] = c.output_limit;
+            if (c.d_cutoff_hz > 0.0f) {
+                float rc = 1.0f / (2.0f * static_cast<float>(M_PI) * c.d_cutoff_hz);
+                d_alpha_[a] = dt_ / (rc + dt_);
+            } else {
+                d_alpha_[a] = 1.0f;
+            }
+            // 上限を下げた場合も次の計算から範囲内に収める
+            integral_[a] = clamp(integral_[a], integral_limit_[a]);
+        }
+    }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 状態クリア（積分項・微分フィルタ、次回の計算で微分フィルタを測定値で初期化）
+     */
+    void reset() {
+        for (size_t a = 0; a < AXES; a++) {
+            integral_[a] = 0.0f;
+            filtered_rate_[a] = 0.0f;
+            rate_target_[a] = 0.0f;
+        }
+        primed_ = false;
+    }
+    
+    /**
+     * @brief 角度モードの計算（角度ループ + 角速度ループ、IRAM配置）
+     * @param angle_target 目標角度（rad、AXES要素）
+     * @param angle 現在角度（rad、AXES要素）
+     * @param rate 現在角速度（rad/s、AXES要素）
+     * @param output 出力（AXES要素）
+     * @param rate_feedforward 目標角速度への加算値（rad/s、目標角度の微分等、nullptrで0）
+     */
+    void IRAM_ATTR compute(const float* angle_target, const float* angle, const float* rate, float* output, 
+                           const float* rate_feedforward = nullptr) {
+        float rate_target[AXES];
+        for (size_t a = 0; a < AXES; a++) {
+            float target = angle_kp_[a] * (angle_target[a] - angle[a]);
+            if (rate_feedforward != nullptr) {
+                target += rate_feedforward[a];
+            }
+            rate_target[a] = clamp(target, rate_limit_[a]);
+        }
+        computeRate(rate_target, rate, output);
+    }
+    
+    /**
+     * @brief 角速度モードの計算（角速度ループのみ、IRAM配置）
+     * @param rate_target 目標角速度（rad/s、AXES要素）
+     * @param rate 現在角速度（rad/s、AXES要素）
+     * @param output 出力（AXES要素）
+     */
+    void IRAM_ATTR computeRate(const float* rate_target, const float* rate, float* output) {
+        if (!primed_) {
+            for (size_t a = 0; a < AXES; a++) {
+                filtered_rate_[a] = rate[a];
+            }
+            primed_ = true;
+        }
+        
+        for (size_t a = 0; a < AXES; a++) {
+            float error = rate_target[a] - rate[a];
+            
+            // 測定値の微分（ローパス後）
+            float previous = filtered_rate_[a];
+            float filtered = previous + d_alpha_[a] * (rate[a] - previous);
+            filtered_rate_[a] = filtered;
+            float derivative = -kd_fs_[a] * (filtered - previous);
+            
+            float unsaturated = kp_[a] * error + integral_[a] + derivative + kff_[a] * rate_target[a];
+            float limited = clamp(unsaturated, output_limit_[a]);
+            output[a] = limited;
+            
+            // 条件付き積分: 飽和していない、または誤差が飽和を戻す向きの場合のみ積む
+            if (limited == unsaturated || error * unsaturated < 0.0f) {
+                integral_[a] = clamp(integral_[a] + ki_dt_[a] * error, integral_limit_[a]);
+            }
+            rate_target_[a] = rate_target[a];
+        }
+    }
+    
+    /**
+     * @brief 前回の目標角速度取得（ログ用）
+     * @param axis 軸
+     */
+    float getRateTarget(size_t axis) const { return rate_target_[axis]; }
+    
+    /**
+     * @brief 積分項取得（ログ用）
+     * @param axis 軸
+     */
+    float getIntegral(size_t axis) const { return integral_[axis]; }
+    
+private:
+    Config config_;                     // 設定
+    float dt_;                          // 制御周期（s）
+    bool primed_;                       // 微分フィルタ初期化済み
+    
+    // 前計算した係数（軸毎の配列）
+    float angle_kp_[AXES];              // 角度ループ比例ゲイン
+    float rate_limit_[AXES];            // 目標角速度の上限
+    float kp_[AXES];                    // 比例ゲイン
+    float ki_dt_[AXES];                 // 積分ゲイン×周期
+    float kd_fs_[AXES];                 // 微分ゲイン×周波数
+    float kff_[AXES];                   // フィードフォワードゲイン
+    float integral_limit_[AXES];        // 積分上限
+    float output_limit_[AXES];          // 出力上限
+    float d_alpha_[AXES];               // 微分ローパス係数
+    
+    // 状態（軸毎の配列）
+    float integral_[AXES];              // 積分項
+    float filtered_rate_[AXES];         // ローパス後の角速度
+    float rate_target_[AXES];           // 前回の目標角速度
+    
+    static inline float clamp(float value, float limit) {
+        return value > limit ? limit : (value < -limit ? -limit : value);
+    }
+};
+
+} // namespace control
+
+#endif // CASCADED_PID_HPP
@@ -0,0 +1,52 @@
+/*
+ * Control Benchmark
+ * 
+ * 制御演算の1周期あたりのサイクル数計測
+ * CLI・起動時診断から呼び出し、結果をログへ出力する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef CONTROL_BENCHMARK_HPP
+#define CONTROL_BENCHMARK_HPP
+
+#include <stddef.h>
+
+namespace control {
+
+/**
+ * @brief 制御演算ベンチマーク結果構造体
+ */
+struct ControlBenchmark {
+    const char* name;           // 計測対象
+    float cycles_per_step;      // 1制御周期あたりの平均サイクル数
+    float max_cycles;           // 1制御周期の最大サイクル数
+};
+
+/**
+ * @brief 3軸カスケードPIDのベンチマーク（結果をログ出力）
+ * @param iterations 反復回数
+ * @return ControlBenchmark 計測結果
+ */
+ControlBenchmark benchmarkCascadedPid(size_t iterations = 4096);
+
+/**
+ * @brief 陽的MPCのベンチマーク（二重積分系の3領域テーブル、結果をログ出力）
+ * @param iterations 反復回数
+ * @return ControlBenchmark 計測結果
+ */
+ControlBenchmark benchmarkExplicitMpc(size_t iterations = 4096);
+
+/**
+ * @brief クアッドXミキサーのベンチマーク（飽和あり・なしを交互に、結果をログ出力）
+ * @param iterations 反復回数
+ * @return ControlBenchmark 計測結果
+ */
+ControlBenchmark benchmarkMixer(size_t iterations = 4096);
+
+} // namespace control
+
+#endif // CONTROL_BENCHMARK_HPP
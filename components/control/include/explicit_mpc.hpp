@@ -0,0 +1,257 @@
+/*
+ * Explicit MPC
+ * 
+ * 陽的モデル予測制御（オフラインで求めた区分アフィン則の実行）
+ * 状態空間を分割した領域ごとのアフィン制御則と、領域を探索する二分木を
+ * フラッシュ上のテーブルから直接参照し、1制御周期あたり木の深さ分の内積だけで入力を求める
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef EXPLICIT_MPC_HPP
+#define EXPLICIT_MPC_HPP
+
+#include "esp_cpu.h"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace control {
+
+/**
+ * @brief 陽的MPCテーブルのヘッダ（リトルエンディアン、4バイト境界）
+ * 
+ * テーブルは ヘッダ → ノード配列 → 領域配列 の順に隙間なく並ぶ。
+ * const配列（.rodata、フラッシュ）またはマップしたパーティションをそのまま渡す
+ */
+struct ExplicitMpcHeader {
+    static constexpr uint32_t MAGIC = 0x43504D45;   // "EMPC"
+    static constexpr uint16_t VERSION = 1;          // 形式の版
+    
+    uint32_t magic;             // MAGIC
+    uint16_t version;           // VERSION
+    uint8_t state_dim;          // 状態の次元
+    uint8_t input_dim;          // 入力の次元
+    uint32_t node_count;        // 木のノード数（1以上）
+    uint32_t region_count;      // 領域数（1以上）
+    uint32_t max_depth;         // 木の最大深さ（生成側で記録、統計用）
+};
+
+/**
+ * @brief 陽的MPC評価クラステンプレート
+ * 
+ * 木のノードは超平面 normal・x <= offset を判定し、真なら left、偽なら right へ進む。
+ * 子の値が0以上ならノード番号、負なら領域番号の補数（~region）を表す。
+ * 子のノード番号は親より大きいこと（load()で検証し、探索が必ず終わることを保証する）。
+ * 入力は u = gain x + bias を求めた後、入力上下限で制限する
+ * @tparam NX 状態の次元
+ * @tparam NU 入力の次元
+ */
+template<size_t NX, size_t NU>
+class ExplicitMpc {
+    static_assert(NX > 0 && NX <= 255 && NU > 0 && NU <= 255, "次元は1〜255");
+    
+public:
+    /**
+     * @brief 木のノード（テーブル上の配置）
+     */
+    struct Node {
+        float normal[NX];       // 超平面の法線
+        float offset;           // 超平面のオフセット
+        int32_t left;           // normal・x <= offset の場合の子
+        int32_t right;          // それ以外の場合の子
+    };
+    
+    /**
+     * @brief 領域のアフィン制御則（テーブル上の配置）
+     */
+    struct Region {
+        float gain[NU][NX];     // 状態フィードバックゲイン
+        float bias[NU];         // オフセット
+    };
+    
+    /**
+     * @brief 計測統計構造体
+     */
+    struct Stats {
+        uint32_t solves;        // 評価回数
+        uint32_t last_cycles;   // 前回の評価サイクル数
+        uint32_t max_cycles;    // 最大評価サイクル数
+        uint32_t max_depth;     // 実際に辿った最大の深さ
+        uint32_t saturated;     // 入力制限がかかった評価回数
+    };
+    
+public:
+    ExplicitMpc() : nodes_(nullptr), regions_(nullptr), node_count_(0), region_count_(0), stats_{} {
+        for (size_t i = 0; i < NU; i++) {
+            u_min_[i] = -1.0f;
+            u_max_[i] = 1.0f;
+        }
+    }
+    
+    /**
+     * @brief テーブルの読み込み（検証のみでコピーしない、テーブルは破棄しないこと）
+     * @param table テーブル先頭（4バイト境界）
+     * @param size テーブルサイズ（バイト）
+     * @return esp_err_t 形式・次元・サイズ・木構造が不正な場合ESP_ERR_INVALID_ARG等
+     */
+    esp_err_t load(const void* table, size_t size) {
+        nodes_ = nullptr;
+        regions_ = nullptr;
+        if (table == nullptr || (reinterpret_cast<uintptr_t>(table) & 3) != 0 || size < sizeof(ExplicitMpcHeader)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        const ExplicitMpcHeader* header = static_cast<const ExplicitMpcHeader*>(table);
+        if (header->magic != ExplicitMpcHeader::MAGIC || header->version != ExplicitMpcHeader::VERSION) {
+            return ESP_ERR_INVALID_VERSION;
+        }
+        if (header->state_dim != NX || header->input_dim != NU) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (header->node_count == 0 || header->region_count == 0) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        size_t expected = sizeof(ExplicitMpcHeader) + header->node_count * sizeof(Node)
+                        + header->region_count * sizeof(Region);
+        if (size < expected) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        
+        const uint8_t* base = static_cast<const uint8_t*>(table);
+        const Node* nodes = reinterpret_cast<const Node*>(base + sizeof(ExplicitMpcHeader));
+        const Region* regions = reinterpret_cast<const Region*>(base + sizeof(ExplicitMpcHeader)
+                                                                + header->node_count * sizeof(Node));
+        for (uint32_t n = 0; n < header->node_count; n++) {
+            if (!validChild(nodes[n].left, n, header->node_count, header->region_count)
+                || !validChild(nodes[n].right, n, header->node_count, header->region_count)) {
+                return ESP_ERR_INVALID_STATE;
+            }
+        }
+        
+        nodes_ = nodes;
+        regions_ = regions;
+        node_count_ = header->node_count;
+        region_count_ = header->region_count;
+        return ESP_OK;
+    }
+    
+    /**
+     * @brief テーブル読み込み済みか
+     */
+    bool isLoaded() const { return nodes_ != nullptr; }
+    
+    /**
+     * @brief 入力上下限の設定
+     * @param u_min 下限（NU要素）
+     * @param u_max 上限（NU要素）
+     */
+    void setInputLimits(const float* u_min, const float* u_max) {
+        for (size_t i = 0; i < NU; i++) {
+            u_min_[i] = u_min[i];
+            u_max_[i] = u_max[i];
+        }
+    }
+    
+    /**
+     * @brief 制御入力の計算（木の探索 + アフィン則）
+     * @param x 状態（NX要素、テーブル生成時と同じ座標・スケール）
+     * @param u 入力（NU要素）
+     * @return int32_t 領域番号（未読み込みの場合-1、uは0）
+     */
+    int32_t compute(const float* x, float* u) {
+        if (nodes_ == nullptr) {
+            for (size_t i = 0; i < NU; i++) {
+                u[i] = 0.0f;
+            }
+            return -1;
+        }
+        
+        uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+        
+        int32_t child = 0;
+        uint32_t depth = 0;
+        do {
+            const Node& node = nodes_[child];
+            float dot = 0.0f;
+            for (size_t k = 0; k < NX; k++) {
+                dot += node.normal[k] * x[k];
+            }
+            child = dot <= node.offset ? node.left : node.right;
+            depth++;
+        } while (child >= 0);
+        
+        int32_t region = ~child;
+        const Region& law = regions_[region];
+        bool saturated = false;
+        for (size_t i = 0; i < NU; i++) {
+            float value = law.bias[i];
+            for (size_t k = 0; k < NX; k++) {
+                value += law.gain[i][k] * x[k];
+            }
+            if (value > u_max_[i]) {
+                value = u_max_[i];
+                saturated = true;
+            } else if (value < u_min_[i]) {
+                value = u_min_[i];
+                saturated = true;
+            }
+            u[i] = value;
+        }
+        
+        uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+        stats_.solves++;
+        stats_.last_cycles = cycles;
+        if (cycles > stats_.max_cycles) {
+            stats_.max_cycles = cycles;
+        }
+        if (depth > stats_.max_depth) {
+            stats_.max_depth = depth;
+        }
+        if (saturated) {
+            stats_.saturated++;
+        }
+        return region;
+    }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 統計クリア
+     */
+    void resetStats() { stats_ = Stats{}; }
+    
+    /**
+     * @brief テーブルのバイト数（生成・埋め込み用）
+     * @param node_count ノード数
+     * @param region_count 領域数
+     */
+    static constexpr size_t tableSize(size_t node_count, size_t region_count) {
+        return sizeof(ExplicitMpcHeader) + node_count * sizeof(Node) + region_count * sizeof(Region);
+    }
+    
+private:
+    const Node* nodes_;         // ノード配列（テーブル内）
+    const Region* regions_;     // 領域配列（テーブル内）
+    uint32_t node_count_;       // ノード数
+    uint32_t region_count_;     // 領域数
+    float u_min_[NU];           // 入力下限
+    float u_max_[NU];           // 入力上限
+    Stats stats_;               // 計測統計
+    
+    static bool validChild(int32_t child, uint32_t parent, uint32_t node_count, uint32_t region_count) {
+        if (child >= 0) {
+            return static_cast<uint32_t>(child) > parent && static_cast<uint32_t>(child) < node_count;
+        }
+        return static_cast<uint32_t>(~child) < region_count;
+    }
+};
+
+} // namespace control
+
+#endif // EXPLICIT_MPC_HPP
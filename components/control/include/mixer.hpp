@@ -0,0 +1,261 @@
+/*
+ * Motor Mixer
+ * 
+ * 機体形状をコンパイル時定数として受け取るモーターミキサー（ヘッダーオンリー）
+ * ロール・ピッチ・ヨーのトルク指令と推力指令から各モーターのデューティを求め、
+ * 飽和時はロール・ピッチを優先してヨーを削る（エアモード対応）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MIXER_HPP
+#define MIXER_HPP
+
+#include "esp_attr.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace control {
+
+/**
+ * @brief モーター配置（機体座標、X前・Y左・Z上）
+ */
+struct MotorGeometry {
+    float x;                // 前方向の位置（任意単位、比のみ使用）
+    float y;                // 左方向の位置
+    int8_t spin;            // 上から見た回転方向（+1: 反時計回り、-1: 時計回り）
+};
+
+/**
+ * @brief クアッドX（StampFly、MotorHal::Motorと同じ順: FL, FR, RL, RR）
+ * 
+ * FL・RRが時計回り、FR・RLが反時計回り。回転方向が逆の機体はspinを反転したフレームを定義する
+ */
+struct QuadXFrame {
+    static constexpr std::array<MotorGeometry, 4> MOTORS = {{
+        { 1.0f,  1.0f, -1},     // FRONT_LEFT
+        { 1.0f, -1.0f,  1},     // FRONT_RIGHT
+        {-1.0f,  1.0f,  1},     // REAR_LEFT
+        {-1.0f, -1.0f, -1},     // REAR_RIGHT
+    }};
+};
+
+/**
+ * @brief クアッド+（順: FRONT, LEFT, REAR, RIGHT）
+ */
+struct QuadPlusFrame {
+    static constexpr std::array<MotorGeometry, 4> MOTORS = {{
+        { 1.0f,  0.0f, -1},     // FRONT
+        { 0.0f,  1.0f,  1},     // LEFT
+        {-1.0f,  0.0f, -1},     // REAR
+        { 0.0f, -1.0f,  1},     // RIGHT
+    }};
+};
+
+namespace detail {
+
+constexpr float absolute(float value) { return value < 0.0f ? -value : value; }
+
+/**
+ * @brief 配置表から1軸分の係数を求める（最大絶対値が1になるよう正規化）
+ */
+template<typename Frame, typename Getter>
+constexpr std::array<float, Frame::MOTORS.size()> normalizedFactors(Getter getter) {
+    std::array<float, Frame::MOTORS.size()> factors{};
+    float max_abs = 0.0f;
+    for (size_t i = 0; i < factors.size(); i++) {
+        factors[i] = getter(Frame::MOTORS[i]);
+        max_abs = absolute(factors[i]) > max_abs ? absolute(factors[i]) : max_abs;
+    }
+    for (size_t i = 0; i < factors.size(); i++) {
+        factors[i] = max_abs > 0.0f ? factors[i] / max_abs : 0.0f;
+    }
+    return factors;
+}
+
+/**
+ * @brief 機体形状のミキシング係数（コンパイル時計算）
+ * 
+ * 推力T（Z上向き）の位置(x, y)から τ = r × F = (y T, -x T, 0)、ヨーはプロペラ回転の反作用
+ */
+template<typename Frame>
+struct MixerFactors {
+    static constexpr auto ROLL = normalizedFactors<Frame>([](const MotorGeometry& m) { return m.y; });
+    static constexpr auto PITCH = normalizedFactors<Frame>([](const MotorGeometry& m) { return -m.x; });
+    static constexpr auto YAW = normalizedFactors<Frame>([](const MotorGeometry& m) { return -static_cast<float>(m.spin); });
+};
+
+} // namespace detail
+
+/**
+ * @brief 姿勢・推力指令構造体
+ */
+struct MixerCommand {
+    float roll;             // X軸トルク指令（正規化、±1程度）
+    float pitch;            // Y軸トルク指令
+    float yaw;              // Z軸トルク指令
+    float thrust;           // 推力指令（0.0-1.0）
+};
+
+/**
+ * @brief ミキサーテンプレート
+ * 
+ * 配置表から各軸の係数をコンパイル時に求め（各軸の最大絶対値が1になるよう正規化）、
+ * モーター数分の計算は展開済みのコードになる（係数は即値、0の項は消える）。
+ * 飽和処理の順序:
+ * 1. ロール・ピッチの差が出力範囲を超える場合はロール・ピッチを比例縮小
+ * 2. エアモード時は推力をずらしてロール・ピッチ（収まればヨーも）を範囲内に収める（低推力でも姿勢制御を保つ）
+ * 3. 残りの余裕にヨーが収まらない場合はヨーのみ縮小
+ * @tparam Frame 機体形状（static constexpr MOTORS を持つ型）
+ */
+template<typename Frame>
+class Mixer {
+public:
+    static constexpr size_t MOTOR_COUNT = Frame::MOTORS.size();    // モーター数
+    
+    using Output = std::array<float, MOTOR_COUNT>;                  // デューティ（MotorHal::DutyArrayと互換）
+    
+    /**
+     * @brief 飽和フラグ
+     */
+    enum Saturation : uint8_t {
+        SATURATION_NONE = 0,
+        SATURATION_ROLL_PITCH = 1 << 0,       // ロール・ピッチを縮小した
+        SATURATION_YAW = 1 << 1,         // ヨーを縮小した
+        SATURATION_THRUST = 1 << 2        // 推力をずらした
+    };
+    
+    /**
+     * @brief ミキサー設定構造体
+     */
+    struct Config {
+        float output_min = 0.05f;   // 出力下限（アイドル、motor_idle）
+        float output_max = 1.0f;    // 出力上限
+        bool airmode = true;        // エアモード（推力をずらしてトルクを優先）
+    };
+    
+private:
+    static constexpr const auto& ROLL = detail::MixerFactors<Frame>::ROLL;    // ロール係数
+    static constexpr const auto& PITCH = detail::MixerFactors<Frame>::PITCH;  // ピッチ係数
+    static constexpr const auto& YAW = detail::MixerFactors<Frame>::YAW;      // ヨー係数
+    
+public:
+    /**
+     * @brief 設定
+     * @param config ミキサー設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief ミキシング（IRAM配置、フラッシュキャッシュ停止中も呼び出せる）
+     * @param command 姿勢・推力指令
+     * @param output 出力デューティ（output_min〜output_max）
+     * @return uint8_t 飽和フラグ（Saturationの論理和）
+     */
+    uint8_t IRAM_ATTR mix(const MixerCommand& command, Output& output) const {
+        return mixImpl(command, output, std::make_index_sequence<MOTOR_COUNT>{});
+    }
+    
+    /**
+     * @brief 係数取得（確認用）
+     * @param motor モーター番号
+     * @param axis 軸（0: ロール、1: ピッチ、2: ヨー）
+     */
+    static constexpr float factor(size_t motor, size_t axis) {
+        return axis == 0 ? ROLL[motor] : (axis == 1 ? PITCH[motor] : YAW[motor]);
+    }
+    
+private:
+    Config config_;         // 設定
+    
+    template<size_t... I>
+    uint8_t IRAM_ATTR mixImpl(const MixerCommand& command, Output& output, std::index_sequence<I...>) const {
+        const float out_min = config_.output_min;
+        const float out_max = config_.output_max;
+        const float range = out_max - out_min;
+        uint8_t saturation = SATURATION_NONE;
+        
+        // 1. ロール・ピッチ
+        float rp[MOTOR_COUNT] = {(ROLL[I] * command.roll + PITCH[I] * command.pitch)...};
+        float rp_min = rp[0];
+        float rp_max = rp[0];
+        ((rp_min = rp[I] < rp_min ? rp[I] : rp_min), ...);
+        ((rp_max = rp[I] > rp_max ? rp[I] : rp_max), ...);
+        float spread = rp_max - rp_min;
+        if (spread > range) {
+            float scale = range / spread;
+            ((rp[I] *= scale), ...);
+            rp_min *= scale;
+            rp_max *= scale;
+            saturation |= SATURATION_ROLL_PITCH;
+        }
+        
+        // 2. 推力（エアモード時は範囲内へずらす、ヨー込みで収まればヨーも削らない）
+        float thrust = out_min + command.thrust * range;
+        float yaw_scale = 1.0f;
+        if (config_.airmode) {
+            float lower = out_min - rp_min;
+            float upper = out_max - rp_max;
+            float full[MOTOR_COUNT] = {(rp[I] + YAW[I] * command.yaw)...};
+            float full_min = full[0];
+            float full_max = full[0];
+            ((full_min = full[I] < full_min ? full[I] : full_min), ...);
+            ((full_max = full[I] > full_max ? full[I] : full_max), ...);
+            if (full_max - full_min <= range) {
+                lower = out_min - full_min;
+                upper = out_max - full_max;
+            }
+            if (thrust < lower) {
+                thrust = lower;
+                saturation |= SATURATION_THRUST;
+            } else if (thrust > upper) {
+                thrust = upper;
+                saturation |= SATURATION_THRUST;
+            }
+        }
+        
+        // 3. ヨー（残りの余裕に収まる倍率）
+        (limitYaw(YAW[I] * command.yaw, thrust + rp[I], out_min, out_max, yaw_scale), ...);
+        if (yaw_scale < 1.0f) {
+            saturation |= SATURATION_YAW;
+        }
+        float yaw = command.yaw * yaw_scale;
+        
+        ((output[I] = clamp(thrust + rp[I] + YAW[I] * yaw, out_min, out_max)), ...);
+        return saturation;
+    }
+    
+    static inline void limitYaw(float yaw_term, float base, float out_min, float out_max, float& scale) {
+        float limit = 1.0f;
+        if (yaw_term > 0.0f) {
+            limit = (out_max - base) / yaw_term;
+        } else if (yaw_term < 0.0f) {
+            limit = (out_min - base) / yaw_term;
+        }
+        limit = limit < 0.0f ? 0.0f : limit;
+        scale = limit < scale ? limit : scale;
+    }
+    
+    static inline float clamp(float value, float min_value, float max_value) {
+        return value < min_value ? min_value : (value > max_value ? max_value : value);
+    }
+};
+
+/**
+ * @brief StampFlyのミキサー
+ */
+using QuadXMixer = Mixer<QuadXFrame>;
+
+} // namespace control
+
+#endif // MIXER_HPP
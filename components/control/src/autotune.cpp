@@ -0,0 +1,357 @@
+/*
+ * Autotune Implementation
+ * 
+ * 飛行中の角速度ループの系同定とPIDゲインの提案実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "autotune.hpp"
+#include "esp_log.h"
+#include <cmath>
+
+namespace control {
+
+static const char* TAG = "control::Autotune";
+
+namespace {
+
+constexpr float TWO_PI = 2.0f * static_cast<float>(M_PI);
+constexpr const char* AXIS_NAMES[Autotune::AXES] = {"ロール", "ピッチ", "ヨー"};
+
+// 最大長系列の帰還（Galois形式、シフトレジスタ長5〜15）
+constexpr uint32_t PRBS_MIN_ORDER = 5;
+constexpr uint32_t PRBS_MAX_ORDER = 15;
+constexpr uint32_t PRBS_TAPS[PRBS_MAX_ORDER - PRBS_MIN_ORDER + 1] = {
+    0x12, 0x21, 0x41, 0x8E, 0x108, 0x204, 0x402, 0x829, 0x100D, 0x2015, 0x4001
+};
+
+// 書き込み先（軸毎の rate_kp・rate_ki・rate_kd）
+constexpr params::ParamId GAIN_PARAMS[Autotune::AXES][3] = {
+    {params::ParamId::RATE_ROLL_KP, params::ParamId::RATE_ROLL_KI, params::ParamId::RATE_ROLL_KD},
+    {params::ParamId::RATE_PITCH_KP, params::ParamId::RATE_PITCH_KI, params::ParamId::RATE_PITCH_KD},
+    {params::ParamId::RATE_YAW_KP, params::ParamId::RATE_YAW_KI, params::ParamId::RATE_YAW_KD},
+};
+
+inline float clampUnit(float value) {
+    return value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+}
+
+/**
+ * @brief パラメータの範囲へ制限
+ */
+float clampToParam(params::ParamId id, float value) {
+    const params::ParamInfo& info = params::PARAM_TABLE[static_cast<size_t>(id)];
+    const float min_value = static_cast<float>(info.min_value);
+    const float max_value = static_cast<float>(info.max_value);
+    return value < min_value ? min_value : (value > max_value ? max_value : value);
+}
+
+} // namespace
+
+Autotune::Autotune()
+    : config_{}
+    , state_(State::IDLE)
+    , abort_reason_(AbortReason::NONE)
+    , axis_(0)
+    , sample_(0)
+    , settle_samples_(0)
+    , excite_samples_(0)
+    , dt_(1.0f / config_.sample_hz)
+    , phase_(0.0f)
+    , phase_step_(0.0f)
+    , phase_growth_(1.0f)
+    , lfsr_(1)
+    , lfsr_taps_(PRBS_TAPS[0])
+    , prbs_level_(1.0f)
+    , prefilter_alpha_(1.0f)
+    , filtered_rate_(0.0f)
+    , filtered_input_(0.0f)
+    , input_history_{}
+    , last_rate_(0.0f)
+    , last_accel_(0.0f)
+    , input_scale_(1.0f)
+    , primed_(false)
+    , models_{}
+    , proposals_{}
+    , stats_{} {}
+
+esp_err_t Autotune::start(const Config& config) {
+    if (!(config.sample_hz > 0.0f) || (config.axis_mask & 0x07) == 0 || config.excite_s <= 0.0f) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config.signal == Signal::CHIRP &&
+        !(config.chirp_start_hz > 0.0f && config.chirp_end_hz > config.chirp_start_hz &&
+          config.chirp_end_hz < 0.5f * config.sample_hz)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config.signal == Signal::PRBS &&
+        (config.prbs_order < PRBS_MIN_ORDER || config.prbs_order > PRBS_MAX_ORDER || config.prbs_hold == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!(config.forgetting > 0.0f && config.forgetting <= 1.0f)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    config_ = config;
+    dt_ = 1.0f / config.sample_hz;
+    settle_samples_ = static_cast<uint32_t>(config.settle_s * config.sample_hz);
+    excite_samples_ = static_cast<uint32_t>(config.excite_s * config.sample_hz);
+    prefilter_alpha_ = 1.0f;
+    if (config.prefilter_hz > 0.0f) {
+        const float rc = 1.0f / (TWO_PI * config.prefilter_hz);
+        prefilter_alpha_ = dt_ / (rc + dt_);
+    }
+    if (config.signal == Signal::PRBS) {
+        lfsr_taps_ = PRBS_TAPS[config.prbs_order - PRBS_MIN_ORDER];
+    }
+    for (size_t a = 0; a < AXES; a++) {
+        models_[a] = Model{};
+        proposals_[a] = Gains{};
+    }
+    abort_reason_ = AbortReason::NONE;
+    stats_.runs++;
+    nextAxis(true);
+    ESP_LOGI(TAG, "開始 %s 軸:0x%02x 励起%.1fs/軸", config.signal == Signal::CHIRP ? "チャープ" : "PRBS", 
+             config.axis_mask & 0x07, static_cast<double>(config.excite_s));
+    return ESP_OK;
+}
+
+void Autotune::nextAxis(bool first) {
+    size_t axis = first ? 0 : axis_ + 1;
+    while (axis < AXES && (config_.axis_mask & (1u << axis)) == 0) {
+        axis++;
+    }
+    if (axis >= AXES) {
+        state_ = State::DONE;
+        stats_.completed++;
+        return;
+    }
+    axis_ = axis;
+    state_ = State::SETTLING;
+    sample_ = 0;
+    primed_ = false;
+    last_accel_ = 0.0f;
+    input_scale_ = config_.amplitude[axis] > 0.0f ? 1.0f / config_.amplitude[axis] : 1.0f;
+    for (size_t i = 0; i < HISTORY; i++) {
+        input_history_[i] = 0.0f;
+    }
+}
+
+void Autotune::beginExcitation() {
+    state_ = State::EXCITING;
+    sample_ = 0;
+    phase_ = 0.0f;
+    phase_step_ = TWO_PI * config_.chirp_start_hz * dt_;
+    phase_growth_ = powf(config_.chirp_end_hz / config_.chirp_start_hz, 1.0f / static_cast<float>(excite_samples_));
+    lfsr_ = 1;
+    prbs_level_ = 1.0f;
+    for (size_t d = 0; d < MAX_DELAY; d++) {
+        candidates_[d].rls.reset();
+        candidates_[d].error.reset();
+    }
+    response_.reset();
+}
+
+bool IRAM_ATTR Autotune::update(const float* rate, float* output) {
+    if (!isActive()) {
+        return false;
+    }
+    for (size_t a = 0; a < AXES; a++) {
+        if (fabsf(rate[a]) > config_.max_rate_rad_s) {
+            stop(AbortReason::RATE_LIMIT);
+            return false;
+        }
+    }
+    
+    if (state_ == State::SETTLING) {
+        // 励起前も入力・角速度の履歴は進めておく（最初の回帰ベクトルを実際の値で埋める）
+        identify(rate[axis_], output[axis_], false);
+        if (++sample_ >= settle_samples_) {
+            beginExcitation();
+        }
+        return false;
+    }
+    
+    const float input = clampUnit(output[axis_] + config_.amplitude[axis_] * excitation());
+    output[axis_] = input;
+    identify(rate[axis_], input, true);
+    if (++sample_ >= excite_samples_) {
+        finishAxis();
+        nextAxis(false);
+    }
+    return true;
+}
+
+float IRAM_ATTR Autotune::excitation() {
+    if (config_.signal == Signal::CHIRP) {
+        const float value = sinf(phase_);
+        phase_ += phase_step_;
+        if (phase_ >= TWO_PI) {
+            phase_ -= TWO_PI;
+        }
+        phase_step_ *= phase_growth_;
+        return value;
+    }
+    if (sample_ % config_.prbs_hold == 0) {
+        const uint32_t bit = lfsr_ & 1u;
+        lfsr_ >>= 1;
+        if (bit != 0) {
+            lfsr_ ^= lfsr_taps_;
+        }
+        prbs_level_ = bit != 0 ? 1.0f : -1.0f;
+    }
+    return prbs_level_;
+}
+
+void IRAM_ATTR Autotune::identify(float rate, float input, bool learn) {
+    if (!primed_) {
+        filtered_rate_ = rate;
+        filtered_input_ = input;
+    }
+    filtered_rate_ += prefilter_alpha_ * (rate - filtered_rate_);
+    filtered_input_ += prefilter_alpha_ * (input - filtered_input_);
+    rate = filtered_rate_;
+    // 回帰は角加速度と振幅で正規化した入力で行う（floatでの桁落ちを避ける、ヨーは1e-4程度になる）
+    input = filtered_input_ * input_scale_;
+    
+    if (primed_) {
+        const float accel = (rate - last_rate_) * config_.sample_hz;
+        if (learn) {
+            // 推定器が落ち着くまでの予測誤差は説明率に入れない
+            const bool settled = sample_ >= excite_samples_ / 8;
+            for (size_t d = 0; d < MAX_DELAY; d++) {
+                const float phi[MODEL_SIZE] = {last_accel_, input_history_[d], input_history_[d + 1], 1.0f};
+                const float error = candidates_[d].rls.update(phi, accel, config_.forgetting);
+                if (settled) {
+                    candidates_[d].error.add(error);
+                }
+            }
+            if (settled) {
+                response_.add(accel);
+            }
+        }
+        last_accel_ = accel;
+    }
+    last_rate_ = rate;
+    primed_ = true;
+    for (size_t i = HISTORY - 1; i > 0; i--) {
+        input_history_[i] = input_history_[i - 1];
+    }
+    input_history_[0] = input;
+}
+
+void Autotune::finishAxis() {
+    size_t best = 0;
+    for (size_t d = 1; d < MAX_DELAY; d++) {
+        if (candidates_[d].error.variance() < candidates_[best].error.variance()) {
+            best = d;
+        }
+    }
+    const Candidate& candidate = candidates_[best];
+    const float p = candidate.rls.parameter(0);
+    const float g = candidate.rls.parameter(1) + candidate.rls.parameter(2);    // 正規化した入力1あたり
+    const float response_variance = response_.variance();
+    
+    Model& model = models_[axis_];
+    model = Model{};
+    model.delay = static_cast<uint8_t>(best);
+    model.samples = candidate.rls.updates();
+    model.fit = response_variance > 0.0f ? 1.0f - candidate.error.variance() / response_variance : 0.0f;
+    
+    // 極が単位円内の正の実数、入力の符号が正（軸の向き・モーター順の誤りは採用しない）
+    if (p > 0.0f && p < 1.0f && g > 0.0f && model.fit >= config_.min_fit) {
+        model.tau_s = -dt_ / logf(p);
+        model.gain = g / (config_.amplitude[axis_] * (1.0f - p));
+        model.valid = 1;
+        
+        const float delay_s = (static_cast<float>(best) + 0.5f) * dt_;
+        const float response_s = fmaxf(config_.response_s, delay_s);
+        const float kc = 1.0f / (model.gain * (response_s + delay_s));
+        const float ti = 4.0f * (response_s + delay_s);
+        const float td = model.tau_s;
+        proposals_[axis_].kp = kc * (1.0f + td / ti);
+        proposals_[axis_].ki = kc / ti;
+        proposals_[axis_].kd = kc * td;
+    } else {
+        stats_.rejected++;
+    }
+}
+
+void Autotune::stop(AbortReason reason) {
+    if (!isActive()) {
+        return;
+    }
+    state_ = State::ABORTED;
+    abort_reason_ = reason;
+    stats_.aborted++;
+}
+
+esp_err_t Autotune::apply(params::ParamRegistry& registry) {
+    if (state_ != State::DONE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size_t written = 0;
+    for (size_t a = 0; a < AXES; a++) {
+        if (!models_[a].valid) {
+            continue;
+        }
+        const float values[3] = {proposals_[a].kp, proposals_[a].ki, proposals_[a].kd};
+        for (size_t i = 0; i < 3; i++) {
+            esp_err_t ret = registry.setFloat(GAIN_PARAMS[a][i], clampToParam(GAIN_PARAMS[a][i], values[i]));
+            if (ret != ESP_OK) {
+                return ret;
+            }
+        }
+        written++;
+        stats_.applied++;
+        ESP_LOGI(TAG, "%s 書き込み kp:%.4f ki:%.4f kd:%.5f", AXIS_NAMES[a], static_cast<double>(values[0]), 
+                 static_cast<double>(values[1]), static_cast<double>(values[2]));
+    }
+    return written > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+const char* Autotune::stateName(State state) {
+    switch (state) {
+    case State::IDLE:
+        return "未開始";
+    case State::SETTLING:
+        return "整定中";
+    case State::EXCITING:
+        return "励起中";
+    case State::DONE:
+        return "終了";
+    case State::ABORTED:
+        return "中断";
+    }
+    return "不明";
+}
+
+void Autotune::dump() const {
+    ESP_LOGI(TAG, "状態 %s 軸 %s %lu/%lu%s", stateName(state_), AXIS_NAMES[axis_], 
+             static_cast<unsigned long>(sample_), 
+             static_cast<unsigned long>(state_ == State::SETTLING ? settle_samples_ : excite_samples_), 
+             abort_reason_ == AbortReason::RATE_LIMIT ? "（角速度上限で中断）" :
+             abort_reason_ == AbortReason::REQUESTED ? "（要求で中断）" : "");
+    for (size_t a = 0; a < AXES; a++) {
+        const Model& m = models_[a];
+        if (m.samples == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%s K:%.1f τ:%.1fms 遅れ:%u 説明率:%.2f %luサンプル %s", AXIS_NAMES[a], 
+                 static_cast<double>(m.gain), static_cast<double>(m.tau_s * 1000.0f), static_cast<unsigned>(m.delay), 
+                 static_cast<double>(m.fit), static_cast<unsigned long>(m.samples), m.valid ? "採用" : "不採用");
+        if (m.valid) {
+            ESP_LOGI(TAG, "%s 提案 kp:%.4f ki:%.4f kd:%.5f", AXIS_NAMES[a], static_cast<double>(proposals_[a].kp), 
+                     static_cast<double>(proposals_[a].ki), static_cast<double>(proposals_[a].kd));
+        }
+    }
+    ESP_LOGI(TAG, "開始 %lu 終了 %lu 中断 %lu 不採用 %lu 書き込み %lu", static_cast<unsigned long>(stats_.runs), 
+             static_cast<unsigned long>(stats_.completed), static_cast<unsigned long>(stats_.aborted), 
+             static_cast<unsigned long>(stats_.rejected), static_cast<unsigned long>(stats_.applied));
+}
+
+} // namespace control
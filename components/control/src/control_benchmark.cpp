@@ -0,0 +1,138 @@
+/*
+ * Control Benchmark Implementation
+ * 
+ * 制御演算の1周期あたりのサイクル数計測実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "control_benchmark.hpp"
+#include "cascaded_pid.hpp"
+#include "explicit_mpc.hpp"
+#include "mixer.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include <string.h>
+
+namespace control {
+
+static const char* TAG = "control::Benchmark";
+
+namespace {
+
+/**
+ * @brief 1周期毎に計測して平均・最大を求める
+ */
+template<typename Step>
+ControlBenchmark measure(const char* name, size_t iterations, Step&& step) {
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    uint32_t total = 0;
+    uint32_t worst = 0;
+    for (size_t i = 0; i < iterations; i++) {
+        uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+        step(i);
+        uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+        total += cycles;
+        worst = cycles > worst ? cycles : worst;
+    }
+
+    ControlBenchmark result;
+    result.name = name;
+    result.cycles_per_step = static_cast<float>(total) / static_cast<float>(iterations);
+    result.max_cycles = static_cast<float>(worst);
+    ESP_LOGI(TAG, "%s 平均 %.1f 最大 %.0f サイクル/周期", name, result.cycles_per_step, result.max_cycles);
+    return result;
+}
+
+/**
+ * @brief 二重積分系の陽的MPCテーブル（u = clamp(-K x)を3領域で表したもの）
+ */
+struct DoubleIntegratorTable {
+    ExplicitMpcHeader header;
+    ExplicitMpc<2, 1>::Node nodes[2];
+    ExplicitMpc<2, 1>::Region regions[3];
+};
+
+void buildDoubleIntegratorTable(DoubleIntegratorTable& table) {
+    const float k[2] = {3.0f, 2.5f};
+    const float u_max = 1.0f;
+    memset(&table, 0, sizeof(table));
+    table.header.magic = ExplicitMpcHeader::MAGIC;
+    table.header.version = ExplicitMpcHeader::VERSION;
+    table.header.state_dim = 2;
+    table.header.input_dim = 1;
+    table.header.node_count = 2;
+    table.header.region_count = 3;
+    table.header.max_depth = 2;
+
+    // K x <= -u_max → 上限飽和、K x <= u_max → 線形、それ以外 → 下限飽和
+    table.nodes[0] = {{k[0], k[1]}, -u_max, ~0, 1};
+    table.nodes[1] = {{k[0], k[1]}, u_max, ~1, ~2};
+    table.regions[0] = {{{0.0f, 0.0f}}, {u_max}};
+    table.regions[1] = {{{-k[0], -k[1]}}, {0.0f}};
+    table.regions[2] = {{{0.0f, 0.0f}}, {-u_max}};
+}
+
+} // namespace
+
+ControlBenchmark benchmarkCascadedPid(size_t iterations) {
+    CascadedPid<3> pid;
+    float angle_target[3] = {0.1f, -0.05f, 0.0f};
+    float angle[3] = {0.0f, 0.0f, 0.0f};
+    float rate[3] = {0.0f, 0.0f, 0.0f};
+    float output[3];
+
+    return measure("CascadedPid<3>", iterations, [&](size_t) {
+        pid.compute(angle_target, angle, rate, output);
+        // 出力を入力へ戻して、毎回異なる値で計算させる
+        rate[0] += 0.001f * output[0];
+        rate[1] += 0.001f * output[1];
+        rate[2] += 0.001f * output[2];
+    });
+}
+
+ControlBenchmark benchmarkExplicitMpc(size_t iterations) {
+    static DoubleIntegratorTable table;
+    buildDoubleIntegratorTable(table);
+
+    ExplicitMpc<2, 1> mpc;
+    if (mpc.load(&table, sizeof(table)) != ESP_OK) {
+        ESP_LOGE(TAG, "ベンチマーク用テーブルの読み込み失敗");
+        return ControlBenchmark{"ExplicitMpc<2,1>", 0.0f, 0.0f};
+    }
+
+    // 状態を掃引して全領域を通す
+    float x[2];
+    float u;
+    ControlBenchmark result = measure("ExplicitMpc<2,1>", iterations, [&](size_t i) {
+        x[0] = -1.0f + 2.0f * static_cast<float>(i % 64) / 64.0f;
+        x[1] = -0.5f + static_cast<float>((i / 64) % 16) / 16.0f;
+        mpc.compute(x, &u);
+    });
+    auto stats = mpc.getStats();
+    ESP_LOGI(TAG, "ExplicitMpc<2,1> 内部計測 最大 %lu サイクル 深さ %lu 飽和 %lu/%lu",
+             static_cast<unsigned long>(stats.max_cycles), static_cast<unsigned long>(stats.max_depth),
+             static_cast<unsigned long>(stats.saturated), static_cast<unsigned long>(stats.solves));
+    return result;
+}
+
+ControlBenchmark benchmarkMixer(size_t iterations) {
+    QuadXMixer mixer;
+    QuadXMixer::Output output;
+    MixerCommand command = {0.0f, 0.0f, 0.0f, 0.5f};
+
+    return measure("QuadXMixer", iterations, [&](size_t i) {
+        float phase = static_cast<float>(i % 32) / 32.0f;
+        command.roll = (i & 1) ? 0.9f * phase : 0.1f * phase;
+        command.pitch = -0.5f * phase;
+        command.yaw = 0.6f - phase;
+        mixer.mix(command, output);
+    });
+}
+
+} // namespace control
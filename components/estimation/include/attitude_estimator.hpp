@@ -0,0 +1,194 @@
+/*
+ * Attitude Estimator
+ * 
+ * クォータニオン相補フィルタによる姿勢推定（Mahony / Madgwick）
+ * IMU FIFOから読み出した複数サンプルを1回の呼び出しでまとめて処理し、
+ * 1サンプルあたりのサイクル数を計測して予算超過を記録する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ATTITUDE_ESTIMATOR_HPP
+#define ATTITUDE_ESTIMATOR_HPP
+
+#include "fast_math.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace estimation {
+
+/**
+ * @brief クォータニオン構造体（w + xi + yj + zk、機体座標→基準座標の回転）
+ */
+struct Quaternion {
+    float w;
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * @brief オイラー角構造体（ZYX順、rad）
+ */
+struct EulerAngles {
+    float roll;
+    float pitch;
+    float yaw;
+};
+
+/**
+ * @brief 姿勢推定アルゴリズム列挙型
+ */
+enum class AttitudeAlgorithm : uint8_t {
+    MAHONY,         // 重力方向の誤差をPI補正（軽量）
+    MADGWICK        // 勾配降下による補正
+};
+
+/**
+ * @brief クォータニオン姿勢推定クラス
+ * 
+ * 加速度で重力方向を観測してロール・ピッチのドリフトを補正する（磁気なしのためヨーは積分のみ）。
+ * 加速度の大きさが重力から外れたサンプルは補正に使わず、角速度のみで更新する。
+ * update()はSoA配列を受け取り、全サンプルを1つのループで処理する（アルゴリズムの分岐はループ外）。
+ * 逆平方根の方式はテンプレート引数で選択する（InvSqrtLibm / InvSqrtFast / InvSqrtFastPrecise）
+ * @tparam InvSqrt 逆平方根ポリシー
+ */
+template<typename InvSqrt = common::InvSqrtFast>
+class QuaternionEstimator {
+public:
+    static constexpr float GRAVITY = 9.80665f;     // 標準重力加速度（m/s^2）
+    
+    /**
+     * @brief 推定器設定構造体
+     */
+    struct Config {
+        AttitudeAlgorithm algorithm = AttitudeAlgorithm::MAHONY;   // アルゴリズム
+        float mahony_kp = 1.0f;             // Mahony比例ゲイン
+        float mahony_ki = 0.02f;            // Mahony積分ゲイン（ジャイロバイアス推定）
+        float madgwick_beta = 0.05f;        // Madgwick勾配ステップ
+        float accel_tolerance = 0.15f;      // 補正に使う加速度の大きさの許容範囲（重力比）
+        uint32_t cycle_budget = 1500;       // 1サンプルあたりのサイクル予算
+    };
+    
+    /**
+     * @brief 計測統計構造体
+     */
+    struct Stats {
+        uint32_t calls;                     // update()呼び出し回数
+        uint32_t samples;                   // 処理サンプル数
+        uint32_t accel_rejected;            // 加速度補正を省いたサンプル数
+        uint32_t last_cycles_per_sample;    // 前回呼び出しの1サンプルあたりサイクル数
+        uint32_t max_cycles_per_sample;     // 最大の1サンプルあたりサイクル数
+        uint32_t budget_overruns;           // 予算を超えた呼び出し回数
+    };
+    
+public:
+    QuaternionEstimator();
+    
+    /**
+     * @brief 設定
+     * @param config 推定器設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 状態の初期化（単位クォータニオン、積分項クリア）
+     */
+    void reset();
+    
+    /**
+     * @brief 加速度から初期姿勢を設定（静止時、ヨーは0）
+     * @param ax 加速度X（m/s^2）
+     * @param ay 加速度Y（m/s^2）
+     * @param az 加速度Z（m/s^2）
+     * @return bool 加速度の大きさが許容範囲内で設定できた場合true
+     */
+    bool alignToGravity(float ax, float ay, float az);
+    
+    /**
+     * @brief 複数サンプルの一括更新
+     * @param gx 角速度X（rad/s）
+     * @param gy 角速度Y（rad/s）
+     * @param gz 角速度Z（rad/s）
+     * @param ax 加速度X（m/s^2）
+     * @param ay 加速度Y（m/s^2）
+     * @param az 加速度Z（m/s^2）
+     * @param count サンプル数
+     * @param dt サンプル間隔（s）
+     */
+    void update(const float* gx, const float* gy, const float* gz, 
+                const float* ax, const float* ay, const float* az, size_t count, float dt);
+    
+    /**
+     * @brief 姿勢取得
+     */
+    const Quaternion& getQuaternion() const { return q_; }
+    
+    /**
+     * @brief オイラー角取得
+     */
+    EulerAngles getEulerAngles() const;
+    
+    /**
+     * @brief 推定ジャイロバイアス取得（Mahonyの積分項、rad/s）
+     */
+    void getGyroBias(float& bx, float& by, float& bz) const;
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 統計クリア
+     */
+    void resetStats();
+    
+private:
+    Config config_;             // 設定
+    Quaternion q_;              // 姿勢
+    float integral_[3];         // Mahony積分項（-ジャイロバイアス）
+    Stats stats_;               // 計測統計
+    
+    /**
+     * @brief 一括更新の本体（アルゴリズム毎に展開）
+     * @return uint32_t 加速度補正を省いたサンプル数
+     */
+    template<AttitudeAlgorithm ALGORITHM>
+    uint32_t updateBatch(const float* gx, const float* gy, const float* gz, 
+                         const float* ax, const float* ay, const float* az, size_t count, float dt);
+};
+
+/**
+ * @brief 逆平方根ベンチマーク結果構造体
+ */
+struct InvSqrtBenchmark {
+    const char* name;           // 方式名
+    float cycles_per_call;      // 1回あたりのサイクル数
+    float max_relative_error;   // 最大相対誤差（1/sqrtと比較）
+};
+
+/**
+ * @brief 逆平方根方式のベンチマーク（結果をログ出力）
+ * @param results 結果格納先（3方式分）
+ * @param iterations 反復回数
+ */
+void benchmarkInvSqrt(InvSqrtBenchmark (&results)[3], size_t iterations = 4096);
+
+extern template class QuaternionEstimator<common::InvSqrtLibm>;
+extern template class QuaternionEstimator<common::InvSqrtFast>;
+extern template class QuaternionEstimator<common::InvSqrtFastPrecise>;
+
+using AttitudeEstimator = QuaternionEstimator<common::InvSqrtFast>;
+
+} // namespace estimation
+
+#endif // ATTITUDE_ESTIMATOR_HPP
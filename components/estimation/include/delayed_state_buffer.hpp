@@ -0,0 +1,174 @@
+/*
+ * Delayed State Buffer
+ * 
+ * 遅れて届く観測の融合のための融合地平（fusion horizon）と出力予測器
+ * EKFはセンサー遅延分だけ過去の時刻で予測・融合し、その間のIMUサンプルで現在時刻の状態を前方へ伝播する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef DELAYED_STATE_BUFFER_HPP
+#define DELAYED_STATE_BUFFER_HPP
+
+#include "error_state_ekf.hpp"
+#include "measurement_aligner.hpp"
+#include "matrix.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace estimation {
+
+/**
+ * @brief 遅延状態バッファクラス
+ * 
+ * IMUサンプル（バイアス補正前）と、そのサンプルまで伝播した出力状態を固定長のリングに保持する。
+ * 最古のサンプルが融合地平（現在時刻 - 遅延）に達するとEKFで予測し、地平の時刻で観測を融合する。
+ * 融合後のEKFの状態と同じ時刻の出力状態の差を、リングに残る出力状態と現在の出力状態に加える
+ * （同じIMUサンプルで伝播しているため、差を足すだけで前方伝播をやり直さずに済む）。
+ * 制御器は現在時刻の出力状態（getPosition()等）を使う。
+ * 1周期の計算量はEKFの予測1回 + リング長の加算で、EKFの周期は変えない。
+ * update()はEKFと同じタスクから呼び出すこと
+ */
+class DelayedStateBuffer {
+public:
+    static constexpr size_t CAPACITY = 64;      // 保持するIMUサンプル数（400Hzで160ms）
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        int64_t delay_us = 40000;           // 融合地平の遅延（μs、ToF・フローの最大遅延以上）
+        float correction_tau = 0.0f;        // 出力状態の補正の時定数（s、0で毎回全量を補正）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t pushed;                    // 追加したIMUサンプル数
+        uint32_t predicted;                 // EKFで予測したサンプル数
+        uint32_t overruns;                  // 満杯で地平より前に予測したサンプル数（遅延が長すぎる）
+        uint32_t fused;                     // 地平の時刻で融合した観測の数
+        float last_position_error;          // 直近のEKFと出力状態の位置の差（m）
+        float max_position_error;           // 最大の位置の差（m）
+    };
+    
+public:
+    DelayedStateBuffer();
+    
+    /**
+     * @brief 設定
+     * @param config 設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 初期化（出力状態をEKFの状態に合わせ、リングを空にする）
+     * @param ekf EKF（reset済み）
+     */
+    void reset(const ErrorStateEkf& ekf);
+    
+    /**
+     * @brief IMUサンプルの追加と地平までの予測・融合
+     * @param ekf EKF
+     * @param aligner 観測の時刻合わせ（地平の時刻で融合する）
+     * @param gx 角速度X（rad/s）
+     * @param gy 角速度Y（rad/s）
+     * @param gz 角速度Z（rad/s）
+     * @param ax 加速度X（m/s^2）
+     * @param ay 加速度Y（m/s^2）
+     * @param az 加速度Z（m/s^2）
+     * @param dt サンプル間隔（s）
+     * @param timestamp_us サンプル時刻（μs、区間の終わり）
+     * @return size_t EKFで予測したサンプル数
+     */
+    size_t update(ErrorStateEkf& ekf, MeasurementAligner& aligner, 
+                  float gx, float gy, float gz, float ax, float ay, float az, float dt, int64_t timestamp_us);
+    
+    /**
+     * @brief 現在時刻の位置（m）
+     */
+    const common::Vector3f& getPosition() const { return output_.position; }
+    
+    /**
+     * @brief 現在時刻の速度（m/s）
+     */
+    const common::Vector3f& getVelocity() const { return output_.velocity; }
+    
+    /**
+     * @brief 現在時刻の姿勢
+     */
+    const Quaternion& getQuaternion() const { return output_.attitude; }
+    
+    /**
+     * @brief 融合地平の時刻（EKFが予測済みの時刻、μs）
+     */
+    int64_t getHorizonTime() const { return horizon_us_; }
+    
+    /**
+     * @brief 保持中のサンプル数
+     */
+    size_t size() const { return count_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 出力状態
+     */
+    struct OutputState {
+        Quaternion attitude;                // 姿勢（機体→基準）
+        common::Vector3f velocity;          // 速度（m/s）
+        common::Vector3f position;          // 位置（m）
+    };
+    
+    /**
+     * @brief リングの要素（IMUサンプルとそのサンプルまで伝播した出力状態）
+     */
+    struct Entry {
+        int64_t timestamp_us;               // サンプル時刻（μs）
+        float gyro[3];                      // 角速度（rad/s、バイアス補正前）
+        float accel[3];                     // 加速度（m/s^2、バイアス補正前）
+        float dt;                           // サンプル間隔（s）
+        OutputState output;                 // 伝播後の出力状態
+    };
+    
+    Config config_;                         // 設定
+    Entry entries_[CAPACITY];               // リング
+    size_t head_;                           // 次の書き込み位置（単調増加）
+    size_t count_;                          // 保持中のサンプル数
+    OutputState output_;                    // 現在時刻の出力状態
+    int64_t horizon_us_;                    // 融合地平の時刻
+    Stats stats_;                           // 統計情報
+    
+    /**
+     * @brief 出力状態の伝播（EKFの公称状態と同じ式、バイアスはEKFの推定値）
+     */
+    static void propagate(OutputState& state, const ErrorStateEkf& ekf, const float gyro[3], 
+                          const float accel[3], float dt);
+    
+    /**
+     * @brief 最古のサンプルで予測・融合し、出力状態を補正
+     */
+    void advanceHorizon(ErrorStateEkf& ekf, MeasurementAligner& aligner);
+};
+
+} // namespace estimation
+
+#endif // DELAYED_STATE_BUFFER_HPP
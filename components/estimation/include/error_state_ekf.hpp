@@ -0,0 +1,297 @@
+/*
+ * Error-State EKF
+ * 
+ * 誤差状態拡張カルマンフィルタによる位置・速度・姿勢推定
+ * IMUで公称状態を伝播し、ToF距離・オプティカルフロー・気圧高度・外部姿勢（モーションキャプチャ）で誤差状態を補正する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef ERROR_STATE_EKF_HPP
+#define ERROR_STATE_EKF_HPP
+
+#include "attitude_estimator.hpp"
+#include "matrix.hpp"
+#include "symmetric_matrix.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace estimation {
+
+/**
+ * @brief 誤差状態EKFクラス
+ * 
+ * 座標系は基準座標がZ上向き（高度 = 位置Z）、姿勢誤差は機体座標の微小回転で表す。
+ * 誤差状態は位置・速度・姿勢・加速度バイアス・ジャイロバイアス・気圧バイアスの16次元。
+ * 共分散は上三角パック形式で保持し、予測では状態遷移行列Fの非零要素のみで
+ * F P F^T を計算する（密な計算の約1/7の積和）。
+ * 観測は全てスカラー観測の逐次更新で、観測ヤコビアンの非零要素のみを使うため逆行列は不要。
+ * predict()・fuse*()は同一タスクから呼び出すこと（内部で排他しない）
+ */
+class ErrorStateEkf {
+public:
+    static constexpr float GRAVITY = 9.80665f;     // 標準重力加速度（m/s^2）
+    
+    /**
+     * @brief 誤差状態の要素番号
+     */
+    enum StateIndex : uint8_t {
+        POS = 0,                // 位置（m、3要素）
+        VEL = 3,                // 速度（m/s、3要素）
+        ATT = 6,                // 姿勢誤差（rad、3要素）
+        ACCEL_BIAS = 9,         // 加速度バイアス（m/s^2、3要素）
+        GYRO_BIAS = 12,         // ジャイロバイアス（rad/s、3要素）
+        BARO_BIAS = 15,         // 気圧高度バイアス（m）
+        STATE_DIM = 16          // 誤差状態の次元
+    };
+    
+    /**
+     * @brief 観測の種類
+     */
+    enum Measurement : uint8_t {
+        TOF = 0,                // ToF距離
+        FLOW,                   // オプティカルフロー
+        BARO,                   // 気圧高度
+        EXT_POSITION,           // 外部位置（モーションキャプチャ）
+        EXT_YAW,                // 外部ヨー角（モーションキャプチャ）
+        MEASUREMENT_COUNT
+    };
+    
+    /**
+     * @brief フィルタ設定構造体
+     */
+    struct Config {
+        float accel_noise = 0.35f;          // 加速度ノイズ密度（m/s^2/√Hz、振動込み）
+        float gyro_noise = 0.01f;           // 角速度ノイズ密度（rad/s/√Hz）
+        float accel_bias_walk = 0.002f;     // 加速度バイアスのランダムウォーク（m/s^2/√s）
+        float gyro_bias_walk = 0.0002f;     // ジャイロバイアスのランダムウォーク（rad/s/√s）
+        float baro_bias_walk = 0.05f;       // 気圧バイアスのランダムウォーク（m/√s）
+        float tof_noise = 0.02f;            // ToF距離の標準偏差（m）
+        float tof_max_range = 4.0f;         // ToFの有効距離上限（m）
+        float flow_noise = 0.15f;           // フローの標準偏差（rad/s）
+        float flow_min_height = 0.08f;      // フローを使う最低高度（m、これ未満は地面に近すぎる）
+        float baro_noise = 0.5f;            // 気圧高度の標準偏差（m）
+        float ext_position_noise = 0.01f;   // 外部位置の標準偏差（m）
+        float ext_yaw_noise = 0.05f;        // 外部ヨー角の標準偏差（rad）
+        uint32_t ext_reset_count = 10;      // 外部位置が連続で棄却されたら位置を合わせ直す回数
+        float innovation_gate = 9.0f;       // イノベーション棄却の閾値（正規化二乗、3σ）
+        float max_tilt_cos = 0.7f;          // ToF・フローを使う傾きの下限（機体Z軸の鉛直成分）
+        float initial_position_sigma = 0.1f;        // 初期位置の標準偏差（m）
+        float initial_velocity_sigma = 0.1f;        // 初期速度の標準偏差（m/s）
+        float initial_attitude_sigma = 0.05f;       // 初期姿勢の標準偏差（rad）
+        float initial_accel_bias_sigma = 0.2f;      // 初期加速度バイアスの標準偏差（m/s^2）
+        float initial_gyro_bias_sigma = 0.02f;      // 初期ジャイロバイアスの標準偏差（rad/s）
+        float initial_baro_bias_sigma = 2.0f;       // 初期気圧バイアスの標準偏差（m）
+        uint32_t predict_cycle_budget = 36000;      // 予測1回のサイクル予算（240MHzで150μs）
+    };
+    
+    /**
+     * @brief 計測統計構造体
+     */
+    struct Stats {
+        uint32_t predicts;                          // 予測回数
+        uint32_t last_predict_cycles;               // 前回の予測サイクル数
+        uint32_t max_predict_cycles;                // 最大予測サイクル数
+        uint32_t predict_overruns;                  // 予算を超えた予測回数
+        uint32_t accepted[MEASUREMENT_COUNT];       // 採用したスカラー観測数
+        uint32_t rejected[MEASUREMENT_COUNT];       // 棄却したスカラー観測数
+        uint32_t last_update_cycles;                // 前回のスカラー更新サイクル数
+    };
+    
+public:
+    ErrorStateEkf();
+    
+    /**
+     * @brief 設定（reset()前に呼び出す）
+     * @param config フィルタ設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 状態の初期化
+     * @param attitude 初期姿勢（QuaternionEstimator::alignToGravity等で求める）
+     * @param altitude 初期高度（m）
+     */
+    void reset(const Quaternion& attitude, float altitude = 0.0f);
+    
+    /**
+     * @brief IMUによる予測（公称状態の伝播と共分散の伝播）
+     * @param gx 角速度X（rad/s）
+     * @param gy 角速度Y（rad/s）
+     * @param gz 角速度Z（rad/s）
+     * @param ax 加速度X（m/s^2）
+     * @param ay 加速度Y（m/s^2）
+     * @param az 加速度Z（m/s^2）
+     * @param dt サンプル間隔（s）
+     */
+    void predict(float gx, float gy, float gz, float ax, float ay, float az, float dt);
+    
+    /**
+     * @brief ToF距離（機体下向き）による更新
+     * @param range 距離（m）
+     * @return bool 採用した場合true
+     */
+    bool fuseTofRange(float range);
+    
+    /**
+     * @brief オプティカルフロー（機体下向き）による更新
+     * 
+     * 入力は回転成分を除いた並進フロー（rad/s）で、機体X/Y方向の対地速度 / 距離に等しいものとする
+     * @param flow_x 並進フローX（rad/s）
+     * @param flow_y 並進フローY（rad/s）
+     * @return bool 両軸とも採用した場合true
+     */
+    bool fuseOpticalFlow(float flow_x, float flow_y);
+    
+    /**
+     * @brief 気圧高度による更新
+     * 
+     * reset()後の最初の観測は気圧バイアスの初期化に使う（現在高度との差をバイアスとする）
+     * @param altitude 気圧高度（m、基準は任意、差はバイアスとして推定）
+     * @return bool 採用した場合true
+     */
+    bool fuseBaroAltitude(float altitude);
+    
+    /**
+     * @brief 外部位置（モーションキャプチャ）による更新
+     * 
+     * 最初の観測と、連続で棄却が続いた後の観測は位置をそのまま合わせる
+     * （モーションキャプチャの原点と推定の原点の差・見失った後の復帰）
+     * @param position 位置（m、基準座標）
+     * @return bool 3軸とも採用した場合true
+     */
+    bool fuseExternalPosition(const common::Vector3f& position);
+    
+    /**
+     * @brief 外部ヨー角（モーションキャプチャ）による更新
+     * 
+     * 最初の観測は姿勢を鉛直軸回りに回してヨー角を合わせる
+     * @param yaw ヨー角（rad、基準座標のZ軸回り）
+     * @return bool 採用した場合true
+     */
+    bool fuseExternalYaw(float yaw);
+    
+    /**
+     * @brief 位置取得（m）
+     */
+    const common::Vector3f& getPosition() const { return position_; }
+    
+    /**
+     * @brief 速度取得（m/s）
+     */
+    const common::Vector3f& getVelocity() const { return velocity_; }
+    
+    /**
+     * @brief 姿勢取得
+     */
+    const Quaternion& getQuaternion() const { return attitude_; }
+    
+    /**
+     * @brief 加速度バイアス取得（m/s^2）
+     */
+    const common::Vector3f& getAccelBias() const { return accel_bias_; }
+    
+    /**
+     * @brief ジャイロバイアス取得（rad/s）
+     */
+    const common::Vector3f& getGyroBias() const { return gyro_bias_; }
+    
+    /**
+     * @brief 気圧バイアス取得（m）
+     */
+    float getBaroBias() const { return baro_bias_; }
+    
+    /**
+     * @brief 誤差状態の分散取得
+     * @param index 要素番号（StateIndex基準）
+     */
+    float getVariance(size_t index) const { return covariance_.diagonal(index); }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 統計クリア
+     */
+    void resetStats();
+    
+    /**
+     * @brief 状態と統計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr size_t MAX_ROW_NONZEROS = 7;   // Fの1行あたりの最大非零要素数
+    static constexpr size_t MAX_H_NONZEROS = 8;     // 観測ヤコビアンの最大非零要素数
+    
+    /**
+     * @brief 疎な行（Fの1行・観測ヤコビアン）
+     */
+    template<size_t CAPACITY>
+    struct SparseRow {
+        uint8_t count;              // 非零要素数
+        uint8_t col[CAPACITY];      // 列番号
+        float value[CAPACITY];      // 値
+        
+        void clear() { count = 0; }
+        void add(uint8_t column, float v) { col[count] = column; value[count] = v; count++; }
+    };
+    
+    using TransitionRow = SparseRow<MAX_ROW_NONZEROS>;
+    using ObservationRow = SparseRow<MAX_H_NONZEROS>;
+    
+    Config config_;                                 // 設定
+    common::Vector3f position_;                     // 位置
+    common::Vector3f velocity_;                     // 速度
+    Quaternion attitude_;                           // 姿勢（機体→基準）
+    common::Matrix3f rotation_;                     // 姿勢の回転行列（機体→基準）
+    common::Vector3f accel_bias_;                   // 加速度バイアス
+    common::Vector3f gyro_bias_;                    // ジャイロバイアス
+    float baro_bias_;                               // 気圧高度バイアス
+    bool baro_initialized_;                         // 気圧バイアス初期化済み
+    bool ext_position_initialized_;                 // 外部位置で位置を合わせ済み
+    bool ext_yaw_initialized_;                      // 外部ヨー角でヨー角を合わせ済み
+    uint32_t ext_reject_run_;                       // 外部位置の連続棄却回数
+    
+    common::SymmetricMatrix<STATE_DIM> covariance_; // 誤差状態の共分散（上三角）
+    TransitionRow transition_[STATE_DIM];           // 状態遷移行列F（疎な行）
+    float dense_[STATE_DIM * STATE_DIM];            // 予測作業領域（Pの展開）
+    float product_[STATE_DIM * STATE_DIM];          // 予測作業領域（F P）
+    
+    Stats stats_;                                   // 計測統計
+    
+    /**
+     * @brief クォータニオンから回転行列を更新
+     */
+    void updateRotation();
+    
+    /**
+     * @brief スカラー観測の逐次更新
+     * @param h 観測ヤコビアン（疎な行）
+     * @param residual 観測残差（観測値 - 予測値）
+     * @param variance 観測ノイズ分散
+     * @param kind 観測の種類（統計用）
+     * @return bool 採用した場合true（ゲートで棄却した場合false）
+     */
+    bool scalarUpdate(const ObservationRow& h, float residual, float variance, Measurement kind);
+    
+    /**
+     * @brief 誤差状態を公称状態へ反映
+     * @param dx 誤差状態（STATE_DIM要素）
+     */
+    void inject(const float* dx);
+};
+
+} // namespace estimation
+
+#endif // ERROR_STATE_EKF_HPP
@@ -0,0 +1,156 @@
+/*
+ * Measurement Aligner
+ * 
+ * ToF・フロー・気圧・外部姿勢の観測をIMU時刻に合わせてEKFへ融合する
+ * センサー毎の時刻付きリングから融合時刻の値を補間で求め、状態の履歴を持たずに時刻を合わせる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MEASUREMENT_ALIGNER_HPP
+#define MEASUREMENT_ALIGNER_HPP
+
+#include "error_state_ekf.hpp"
+#include "timestamped_ring.hpp"
+#include <array>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace estimation {
+
+/**
+ * @brief 観測の時刻合わせクラス
+ * 
+ * センサーの値は計測時刻（ドライバのtimestamp_us）で push*() し、EKFの予測の後に
+ * 予測した時刻で fuse() を呼ぶ。融合時刻を挟む2サンプルが揃った観測だけを補間して融合し、
+ * 同じサンプルの組は1回しか使わない（IMU周期で同じ情報を繰り返し融合しない）。
+ * 融合時刻は「現在時刻 - センサー遅延」とし、遅延分の状態の巻き戻しは DelayedStateBuffer で行う。
+ * push*()・fuse()はEKFと同じタスクから呼び出すこと
+ */
+class MeasurementAligner {
+public:
+    static constexpr size_t RING_SIZE = 16;     // センサー毎の保持サンプル数（フロー100Hzで160ms）
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        int64_t tof_max_gap_us = 100000;        // ToFの補間に使う前後サンプルの最大間隔（30Hzの3周期）
+        int64_t flow_max_gap_us = 40000;        // フローの補間に使う前後サンプルの最大間隔（100Hzの4周期）
+        int64_t baro_max_gap_us = 100000;       // 気圧の補間に使う前後サンプルの最大間隔
+        int64_t ext_max_gap_us = 50000;         // 外部姿勢の補間に使う前後サンプルの最大間隔（100Hzの5周期）
+    };
+    
+    /**
+     * @brief 統計情報構造体（要素はErrorStateEkf::Measurement順）
+     */
+    struct Stats {
+        uint32_t pushed[ErrorStateEkf::MEASUREMENT_COUNT];      // 追加したサンプル数
+        uint32_t fused[ErrorStateEkf::MEASUREMENT_COUNT];       // 補間して融合した回数
+        uint32_t gaps[ErrorStateEkf::MEASUREMENT_COUNT];        // 前後の間隔が長く（欠測）捨てた回数
+        uint32_t late[ErrorStateEkf::MEASUREMENT_COUNT];        // 融合時刻を過ぎてから届いたサンプル数
+    };
+    
+public:
+    MeasurementAligner();
+    
+    /**
+     * @brief 設定
+     * @param config 設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 全サンプル・統計の破棄（EKFのreset()と合わせて呼ぶ）
+     */
+    void reset();
+    
+    /**
+     * @brief ToF距離の追加（範囲外の距離は補間を歪めるため追加しないこと）
+     * @param timestamp_us 計測時刻（μs）
+     * @param range 距離（m）
+     * @return bool 追加した場合true（時刻が戻った場合false）
+     */
+    bool pushTof(int64_t timestamp_us, float range);
+    
+    /**
+     * @brief 並進フローの追加
+     * @param timestamp_us 計測時刻（μs、積算区間の中央）
+     * @param flow_x 並進フローX（rad/s）
+     * @param flow_y 並進フローY（rad/s）
+     * @return bool 追加した場合true
+     */
+    bool pushFlow(int64_t timestamp_us, float flow_x, float flow_y);
+    
+    /**
+     * @brief 気圧高度の追加
+     * @param timestamp_us 計測時刻（μs）
+     * @param altitude 気圧高度（m）
+     * @return bool 追加した場合true
+     */
+    bool pushBaro(int64_t timestamp_us, float altitude);
+    
+    /**
+     * @brief 外部姿勢（モーションキャプチャ）の追加
+     * 
+     * ヨー角は±πの折り返しで補間が壊れないよう、前回値から連続になるように積む
+     * @param timestamp_us 撮像時刻（μs、自機の時刻）
+     * @param position 位置（m、基準座標）
+     * @param yaw ヨー角（rad）
+     * @param has_yaw ヨー角が有効
+     * @return bool 追加した場合true
+     */
+    bool pushExternalPose(int64_t timestamp_us, const common::Vector3f& position, float yaw, bool has_yaw);
+    
+    /**
+     * @brief 融合時刻の観測をEKFへ融合
+     * @param ekf EKF（融合時刻まで予測済み）
+     * @param fusion_time_us 融合時刻（μs、単調増加）
+     * @return size_t 融合した観測の数
+     */
+    size_t fuse(ErrorStateEkf& ekf, int64_t fusion_time_us);
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    using FlowValue = std::array<float, 2>;
+    using PositionValue = std::array<float, 3>;
+    
+    Config config_;                                             // 設定
+    common::TimestampedRing<float, RING_SIZE> tof_;             // ToF距離
+    common::TimestampedRing<FlowValue, RING_SIZE> flow_;        // 並進フロー
+    common::TimestampedRing<float, RING_SIZE> baro_;            // 気圧高度
+    common::TimestampedRing<PositionValue, RING_SIZE> ext_position_;    // 外部位置
+    common::TimestampedRing<float, RING_SIZE> ext_yaw_;         // 外部ヨー角（連続化済み）
+    float last_ext_yaw_;                                        // 前回積んだ外部ヨー角（連続化済み）
+    int64_t used_upper_us_[ErrorStateEkf::MEASUREMENT_COUNT];   // 融合に使った上側サンプルの時刻
+    int64_t last_fusion_us_;                                    // 前回の融合時刻
+    Stats stats_;                                               // 統計情報
+    
+    /**
+     * @brief 融合時刻を挟むサンプルの組が新しいか確認し、使用済みにする
+     * @return bool 補間に進む場合true
+     */
+    template<typename Ring>
+    bool claim(const Ring& ring, ErrorStateEkf::Measurement kind, int64_t fusion_time_us);
+    
+    /**
+     * @brief 追加時の統計更新
+     */
+    void countPush(ErrorStateEkf::Measurement kind, int64_t timestamp_us);
+};
+
+} // namespace estimation
+
+#endif // MEASUREMENT_ALIGNER_HPP
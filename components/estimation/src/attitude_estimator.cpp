@@ -0,0 +1,274 @@
+/*
+ * Attitude Estimator Implementation
+ * 
+ * クォータニオン相補フィルタによる姿勢推定実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "attitude_estimator.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include <math.h>
+
+namespace estimation {
+
+static const char* TAG = "estimation::QuaternionEstimator";
+
+template<typename InvSqrt>
+QuaternionEstimator<InvSqrt>::QuaternionEstimator() {
+    reset();
+    resetStats();
+}
+
+template<typename InvSqrt>
+void QuaternionEstimator<InvSqrt>::reset() {
+    q_ = {1.0f, 0.0f, 0.0f, 0.0f};
+    integral_[0] = 0.0f;
+    integral_[1] = 0.0f;
+    integral_[2] = 0.0f;
+}
+
+template<typename InvSqrt>
+bool QuaternionEstimator<InvSqrt>::alignToGravity(float ax, float ay, float az) {
+    float norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (fabsf(norm - GRAVITY) > config_.accel_tolerance * GRAVITY) {
+        return false;
+    }
+    
+    // ヨー0のZYX順オイラー角からクォータニオンを作る
+    float roll = atan2f(ay, az);
+    float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+    float cr = cosf(roll * 0.5f);
+    float sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f);
+    float sp = sinf(pitch * 0.5f);
+    q_ = {cr * cp, sr * cp, cr * sp, -sr * sp};
+    integral_[0] = 0.0f;
+    integral_[1] = 0.0f;
+    integral_[2] = 0.0f;
+    return true;
+}
+
+template<typename InvSqrt>
+void QuaternionEstimator<InvSqrt>::update(const float* gx, const float* gy, const float* gz, 
+                                          const float* ax, const float* ay, const float* az, size_t count, float dt) {
+    if (count == 0) {
+        return;
+    }
+    
+    uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    uint32_t rejected = config_.algorithm == AttitudeAlgorithm::MAHONY
+        ? updateBatch<AttitudeAlgorithm::MAHONY>(gx, gy, gz, ax, ay, az, count, dt)
+        : updateBatch<AttitudeAlgorithm::MADGWICK>(gx, gy, gz, ax, ay, az, count, dt);
+    uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    
+    uint32_t per_sample = cycles / static_cast<uint32_t>(count);
+    stats_.calls++;
+    stats_.samples += static_cast<uint32_t>(count);
+    stats_.accel_rejected += rejected;
+    stats_.last_cycles_per_sample = per_sample;
+    if (per_sample > stats_.max_cycles_per_sample) {
+        stats_.max_cycles_per_sample = per_sample;
+    }
+    if (per_sample > config_.cycle_budget) {
+        stats_.budget_overruns++;
+    }
+}
+
+template<typename InvSqrt>
+template<AttitudeAlgorithm ALGORITHM>
+uint32_t QuaternionEstimator<InvSqrt>::updateBatch(const float* gx, const float* gy, const float* gz, 
+                                                   const float* ax, const float* ay, const float* az, 
+                                                   size_t count, float dt) {
+    // 状態はループ中レジスタに置き、最後に書き戻す
+    float q0 = q_.w;
+    float q1 = q_.x;
+    float q2 = q_.y;
+    float q3 = q_.z;
+    float ix = integral_[0];
+    float iy = integral_[1];
+    float iz = integral_[2];
+    
+    const float half_dt = 0.5f * dt;
+    const float min_norm_sq = (1.0f - config_.accel_tolerance) * (1.0f - config_.accel_tolerance) * GRAVITY * GRAVITY;
+    const float max_norm_sq = (1.0f + config_.accel_tolerance) * (1.0f + config_.accel_tolerance) * GRAVITY * GRAVITY;
+    uint32_t rejected = 0;
+    
+    for (size_t n = 0; n < count; n++) {
+        float wx = gx[n];
+        float wy = gy[n];
+        float wz = gz[n];
+        float fx = ax[n];
+        float fy = ay[n];
+        float fz = az[n];
+        float norm_sq = fx * fx + fy * fy + fz * fz;
+        bool accel_valid = norm_sq >= min_norm_sq && norm_sq <= max_norm_sq;
+        rejected += accel_valid ? 0 : 1;
+        
+        if constexpr (ALGORITHM == AttitudeAlgorithm::MAHONY) {
+            if (accel_valid) {
+                float inv_norm = InvSqrt::apply(norm_sq);
+                fx *= inv_norm;
+                fy *= inv_norm;
+                fz *= inv_norm;
+                
+                // 推定重力方向（の1/2）と観測の外積が誤差
+                float vx = q1 * q3 - q0 * q2;
+                float vy = q0 * q1 + q2 * q3;
+                float vz = q0 * q0 - 0.5f + q3 * q3;
+                float ex = fy * vz - fz * vy;
+                float ey = fz * vx - fx * vz;
+                float ez = fx * vy - fy * vx;
+                
+                if (config_.mahony_ki > 0.0f) {
+                    ix += 2.0f * config_.mahony_ki * ex * dt;
+                    iy += 2.0f * config_.mahony_ki * ey * dt;
+                    iz += 2.0f * config_.mahony_ki * ez * dt;
+                }
+                wx += 2.0f * config_.mahony_kp * ex;
+                wy += 2.0f * config_.mahony_kp * ey;
+                wz += 2.0f * config_.mahony_kp * ez;
+            }
+            wx += ix;
+            wy += iy;
+            wz += iz;
+            
+            float a = q0;
+            float b = q1;
+            float c = q2;
+            q0 += (-b * wx - c * wy - q3 * wz) * half_dt;
+            q1 += (a * wx + c * wz - q3 * wy) * half_dt;
+            q2 += (a * wy - b * wz + q3 * wx) * half_dt;
+            q3 += (a * wz + b * wy - c * wx) * half_dt;
+        } else {
+            float dq0 = 0.5f * (-q1 * wx - q2 * wy - q3 * wz);
+            float dq1 = 0.5f * (q0 * wx + q2 * wz - q3 * wy);
+            float dq2 = 0.5f * (q0 * wy - q1 * wz + q3 * wx);
+            float dq3 = 0.5f * (q0 * wz + q1 * wy - q2 * wx);
+            
+            if (accel_valid) {
+                float inv_norm = InvSqrt::apply(norm_sq);
+                fx *= inv_norm;
+                fy *= inv_norm;
+                fz *= inv_norm;
+                
+                // 目的関数 f = q* g q - a の勾配
+                float q0q0 = q0 * q0;
+                float q1q1 = q1 * q1;
+                float q2q2 = q2 * q2;
+                float q3q3 = q3 * q3;
+                float s0 = 4.0f * q0 * q2q2 + 2.0f * q2 * fx + 4.0f * q0 * q1q1 - 2.0f * q1 * fy;
+                float s1 = 4.0f * q1 * q3q3 - 2.0f * q3 * fx + 4.0f * q0q0 * q1 - 2.0f * q0 * fy - 4.0f * q1
+                         + 8.0f * q1 * q1q1 + 8.0f * q1 * q2q2 + 4.0f * q1 * fz;
+                float s2 = 4.0f * q0q0 * q2 + 2.0f * q0 * fx + 4.0f * q2 * q3q3 - 2.0f * q3 * fy - 4.0f * q2
+                         + 8.0f * q2 * q1q1 + 8.0f * q2 * q2q2 + 4.0f * q2 * fz;
+                float s3 = 4.0f * q1q1 * q3 - 2.0f * q1 * fx + 4.0f * q2q2 * q3 - 2.0f * q2 * fy;
+                float s_norm_sq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+                if (s_norm_sq > 1e-12f) {
+                    float step = config_.madgwick_beta * InvSqrt::apply(s_norm_sq);
+                    dq0 -= step * s0;
+                    dq1 -= step * s1;
+                    dq2 -= step * s2;
+                    dq3 -= step * s3;
+                }
+            }
+            
+            q0 += dq0 * dt;
+            q1 += dq1 * dt;
+            q2 += dq2 * dt;
+            q3 += dq3 * dt;
+        }
+        
+        // 毎サンプル正規化するため、逆平方根の近似誤差は蓄積しない
+        float inv_q = InvSqrt::apply(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+        q0 *= inv_q;
+        q1 *= inv_q;
+        q2 *= inv_q;
+        q3 *= inv_q;
+    }
+    
+    q_ = {q0, q1, q2, q3};
+    integral_[0] = ix;
+    integral_[1] = iy;
+    integral_[2] = iz;
+    return rejected;
+}
+
+template<typename InvSqrt>
+EulerAngles QuaternionEstimator<InvSqrt>::getEulerAngles() const {
+    const Quaternion& q = q_;
+    EulerAngles e;
+    e.roll = atan2f(2.0f * (q.w * q.x + q.y * q.z), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+    float sin_pitch = 2.0f * (q.w * q.y - q.z * q.x);
+    sin_pitch = sin_pitch > 1.0f ? 1.0f : (sin_pitch < -1.0f ? -1.0f : sin_pitch);
+    e.pitch = asinf(sin_pitch);
+    e.yaw = atan2f(2.0f * (q.w * q.z + q.x * q.y), 1.0f - 2.0f * (q.y * q.y + q.z * q.z));
+    return e;
+}
+
+template<typename InvSqrt>
+void QuaternionEstimator<InvSqrt>::getGyroBias(float& bx, float& by, float& bz) const {
+    bx = -integral_[0];
+    by = -integral_[1];
+    bz = -integral_[2];
+}
+
+template<typename InvSqrt>
+void QuaternionEstimator<InvSqrt>::resetStats() {
+    stats_ = Stats{};
+}
+
+template class QuaternionEstimator<common::InvSqrtLibm>;
+template class QuaternionEstimator<common::InvSqrtFast>;
+template class QuaternionEstimator<common::InvSqrtFastPrecise>;
+
+namespace {
+
+template<typename InvSqrt>
+InvSqrtBenchmark measureInvSqrt(size_t iterations) {
+    // 正規化で現れる範囲（0.5〜2.0）と加速度の二乗ノルム付近（〜100）を掃引する
+    volatile float sink = 0.0f;
+    float x = 0.5f;
+    const float step = 1.5f / static_cast<float>(iterations);
+    uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    for (size_t i = 0; i < iterations; i++) {
+        sink = sink + InvSqrt::apply(x);
+        x += step;
+    }
+    uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    
+    float max_error = 0.0f;
+    for (size_t i = 0; i < iterations; i++) {
+        float value = 0.5f + 100.0f * static_cast<float>(i) / static_cast<float>(iterations);
+        double exact = 1.0 / sqrt(static_cast<double>(value));
+        float error = static_cast<float>(fabs((InvSqrt::apply(value) - exact) / exact));
+        max_error = error > max_error ? error : max_error;
+    }
+    
+    InvSqrtBenchmark result;
+    result.name = InvSqrt::NAME;
+    result.cycles_per_call = static_cast<float>(cycles) / static_cast<float>(iterations);
+    result.max_relative_error = max_error;
+    return result;
+}
+
+} // namespace
+
+void benchmarkInvSqrt(InvSqrtBenchmark (&results)[3], size_t iterations) {
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    results[0] = measureInvSqrt<common::InvSqrtLibm>(iterations);
+    results[1] = measureInvSqrt<common::InvSqrtFast>(iterations);
+    results[2] = measureInvSqrt<common::InvSqrtFastPrecise>(iterations);
+    for (const auto& result : results) {
+        ESP_LOGI(TAG, "逆平方根 %-10s %6.1fサイクル/回 最大相対誤差 %.2e", 
+                 result.name, result.cycles_per_call, result.max_relative_error);
+    }
+}
+
+} // namespace estimation
@@ -0,0 +1,181 @@
+/*
+ * Delayed State Buffer Implementation
+ * 
+ * 融合地平と出力予測器の実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "delayed_state_buffer.hpp"
+#include "esp_log.h"
+#include <math.h>
+
+namespace estimation {
+
+static const char* TAG = "estimation::DelayedStateBuffer";
+
+namespace {
+
+inline Quaternion multiply(const Quaternion& a, const Quaternion& b) {
+    return Quaternion{
+        a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+        a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+        a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+        a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w
+    };
+}
+
+inline void normalize(Quaternion& q) {
+    float inv_norm = common::InvSqrtFastPrecise::apply(q.w * q.w + q.x * q.x + q.y * q.y + q.z * q.z);
+    q.w *= inv_norm;
+    q.x *= inv_norm;
+    q.y *= inv_norm;
+    q.z *= inv_norm;
+}
+
+} // namespace
+
+DelayedStateBuffer::DelayedStateBuffer()
+    : config_()
+    , head_(0)
+    , count_(0)
+    , output_{}
+    , horizon_us_(0)
+    , stats_{} {
+    output_.attitude = Quaternion{1.0f, 0.0f, 0.0f, 0.0f};
+}
+
+void DelayedStateBuffer::reset(const ErrorStateEkf& ekf) {
+    head_ = 0;
+    count_ = 0;
+    output_.attitude = ekf.getQuaternion();
+    output_.velocity = ekf.getVelocity();
+    output_.position = ekf.getPosition();
+    horizon_us_ = 0;
+    stats_ = Stats{};
+}
+
+void DelayedStateBuffer::propagate(OutputState& state, const ErrorStateEkf& ekf, const float gyro[3], 
+                                   const float accel[3], float dt) {
+    const common::Vector3f& accel_bias = ekf.getAccelBias();
+    const common::Vector3f& gyro_bias = ekf.getGyroBias();
+    const float ax = accel[0] - accel_bias[0];
+    const float ay = accel[1] - accel_bias[1];
+    const float az = accel[2] - accel_bias[2];
+    
+    // 伝播前の姿勢で加速度を基準座標へ回す（EKFの予測と同じ順序）
+    const Quaternion& q = state.attitude;
+    const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+    const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+    const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+    common::Vector3f accel_world(
+        (1.0f - 2.0f * (yy + zz)) * ax + 2.0f * (xy - wz) * ay + 2.0f * (xz + wy) * az, 
+        2.0f * (xy + wz) * ax + (1.0f - 2.0f * (xx + zz)) * ay + 2.0f * (yz - wx) * az, 
+        2.0f * (xz - wy) * ax + 2.0f * (yz + wx) * ay + (1.0f - 2.0f * (xx + yy)) * az);
+    accel_world[2] -= ErrorStateEkf::GRAVITY;
+    state.position += state.velocity * dt + accel_world * (0.5f * dt * dt);
+    state.velocity += accel_world * dt;
+    
+    const float hx = 0.5f * (gyro[0] - gyro_bias[0]) * dt;
+    const float hy = 0.5f * (gyro[1] - gyro_bias[1]) * dt;
+    const float hz = 0.5f * (gyro[2] - gyro_bias[2]) * dt;
+    state.attitude = multiply(q, Quaternion{1.0f, hx, hy, hz});
+    normalize(state.attitude);
+}
+
+size_t DelayedStateBuffer::update(ErrorStateEkf& ekf, MeasurementAligner& aligner, 
+                                  float gx, float gy, float gz, float ax, float ay, float az, float dt, 
+                                  int64_t timestamp_us) {
+    size_t predicted = 0;
+    if (count_ == CAPACITY) {
+        // 遅延がリング長を超えている（地平を待たずに最古のサンプルを使う）
+        stats_.overruns++;
+        advanceHorizon(ekf, aligner);
+        predicted++;
+    }
+    
+    Entry& entry = entries_[head_ % CAPACITY];
+    entry.timestamp_us = timestamp_us;
+    entry.gyro[0] = gx;
+    entry.gyro[1] = gy;
+    entry.gyro[2] = gz;
+    entry.accel[0] = ax;
+    entry.accel[1] = ay;
+    entry.accel[2] = az;
+    entry.dt = dt;
+    propagate(output_, ekf, entry.gyro, entry.accel, dt);
+    entry.output = output_;
+    head_++;
+    count_++;
+    stats_.pushed++;
+    
+    const int64_t horizon_us = timestamp_us - config_.delay_us;
+    while (count_ > 0 && entries_[(head_ - count_) % CAPACITY].timestamp_us <= horizon_us) {
+        advanceHorizon(ekf, aligner);
+        predicted++;
+    }
+    return predicted;
+}
+
+void DelayedStateBuffer::advanceHorizon(ErrorStateEkf& ekf, MeasurementAligner& aligner) {
+    const size_t oldest = head_ - count_;
+    const Entry& entry = entries_[oldest % CAPACITY];
+    ekf.predict(entry.gyro[0], entry.gyro[1], entry.gyro[2], entry.accel[0], entry.accel[1], entry.accel[2], entry.dt);
+    horizon_us_ = entry.timestamp_us;
+    stats_.fused += aligner.fuse(ekf, horizon_us_);
+    stats_.predicted++;
+    
+    // 地平でのEKFと出力状態の差（位置・速度は加算、姿勢は基準座標側の回転）
+    const OutputState& past = entry.output;
+    common::Vector3f dp = ekf.getPosition() - past.position;
+    common::Vector3f dv = ekf.getVelocity() - past.velocity;
+    const Quaternion& q_ekf = ekf.getQuaternion();
+    Quaternion q_err = multiply(q_ekf, Quaternion{past.attitude.w, -past.attitude.x, -past.attitude.y, -past.attitude.z});
+    if (q_err.w < 0.0f) {
+        q_err = Quaternion{-q_err.w, -q_err.x, -q_err.y, -q_err.z};
+    }
+    count_--;
+    
+    float gain = 1.0f;
+    if (config_.correction_tau > 0.0f) {
+        gain = fminf(entry.dt / config_.correction_tau, 1.0f);
+        dp *= gain;
+        dv *= gain;
+        q_err = Quaternion{1.0f, q_err.x * gain, q_err.y * gain, q_err.z * gain};
+        normalize(q_err);
+    }
+    
+    const float position_error = sqrtf(dp[0] * dp[0] + dp[1] * dp[1] + dp[2] * dp[2]) / gain;
+    stats_.last_position_error = position_error;
+    if (position_error > stats_.max_position_error) {
+        stats_.max_position_error = position_error;
+    }
+    
+    // 残りのリングの出力状態と現在の出力状態に同じ補正を加える
+    for (size_t i = head_ - count_; i != head_; i++) {
+        OutputState& state = entries_[i % CAPACITY].output;
+        state.position += dp;
+        state.velocity += dv;
+        state.attitude = multiply(q_err, state.attitude);
+        normalize(state.attitude);
+    }
+    output_.position += dp;
+    output_.velocity += dv;
+    output_.attitude = multiply(q_err, output_.attitude);
+    normalize(output_.attitude);
+}
+
+void DelayedStateBuffer::dump() const {
+    ESP_LOGI(TAG, "遅延 %ldμs 保持 %u/%u 地平 %lldμs", 
+             static_cast<long>(config_.delay_us), static_cast<unsigned>(count_), static_cast<unsigned>(CAPACITY), 
+             static_cast<long long>(horizon_us_));
+    ESP_LOGI(TAG, "追加 %lu 予測 %lu 満杯 %lu 融合 %lu 位置差 直近 %.4f 最大 %.4f m", 
+             static_cast<unsigned long>(stats_.pushed), static_cast<unsigned long>(stats_.predicted), 
+             static_cast<unsigned long>(stats_.overruns), static_cast<unsigned long>(stats_.fused), 
+             stats_.last_position_error, stats_.max_position_error);
+}
+
+} // namespace estimation
@@ -0,0 +1,431 @@
+/*
+ * Error-State EKF Implementation
+ * 
+ * 誤差状態拡張カルマンフィルタ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "error_state_ekf.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include <math.h>
+
+namespace estimation {
+
+static const char* TAG = "estimation::ErrorStateEkf";
+
+static constexpr float MIN_VARIANCE = 1e-9f;       // 分散の下限
+
+ErrorStateEkf::ErrorStateEkf() {
+    reset(Quaternion{1.0f, 0.0f, 0.0f, 0.0f});
+    resetStats();
+}
+
+void ErrorStateEkf::reset(const Quaternion& attitude, float altitude) {
+    position_ = common::Vector3f(0.0f, 0.0f, altitude);
+    velocity_ = common::Vector3f::zeros();
+    attitude_ = attitude;
+    accel_bias_ = common::Vector3f::zeros();
+    gyro_bias_ = common::Vector3f::zeros();
+    baro_bias_ = 0.0f;
+    baro_initialized_ = false;
+    ext_position_initialized_ = false;
+    ext_yaw_initialized_ = false;
+    ext_reject_run_ = 0;
+    updateRotation();
+    
+    float variance[STATE_DIM];
+    for (size_t i = 0; i < 3; i++) {
+        variance[POS + i] = config_.initial_position_sigma * config_.initial_position_sigma;
+        variance[VEL + i] = config_.initial_velocity_sigma * config_.initial_velocity_sigma;
+        variance[ATT + i] = config_.initial_attitude_sigma * config_.initial_attitude_sigma;
+        variance[ACCEL_BIAS + i] = config_.initial_accel_bias_sigma * config_.initial_accel_bias_sigma;
+        variance[GYRO_BIAS + i] = config_.initial_gyro_bias_sigma * config_.initial_gyro_bias_sigma;
+    }
+    variance[BARO_BIAS] = config_.initial_baro_bias_sigma * config_.initial_baro_bias_sigma;
+    covariance_.setDiagonal(variance);
+    
+    // 単位行列の行（位置以外のバイアス）は予測中に変化しないため一度だけ作る
+    for (uint8_t i = ACCEL_BIAS; i < STATE_DIM; i++) {
+        transition_[i].clear();
+        transition_[i].add(i, 1.0f);
+    }
+}
+
+void ErrorStateEkf::updateRotation() {
+    const Quaternion& q = attitude_;
+    float xx = q.x * q.x;
+    float yy = q.y * q.y;
+    float zz = q.z * q.z;
+    float xy = q.x * q.y;
+    float xz = q.x * q.z;
+    float yz = q.y * q.z;
+    float wx = q.w * q.x;
+    float wy = q.w * q.y;
+    float wz = q.w * q.z;
+    rotation_ = common::Matrix3f(1.0f - 2.0f * (yy + zz), 2.0f * (xy - wz), 2.0f * (xz + wy), 
+                                 2.0f * (xy + wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz - wx), 
+                                 2.0f * (xz - wy), 2.0f * (yz + wx), 1.0f - 2.0f * (xx + yy));
+}
+
+void ErrorStateEkf::predict(float gx, float gy, float gz, float ax, float ay, float az, float dt) {
+    uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    
+    // 公称状態の伝播（バイアス補正後のIMU値を使用）
+    common::Vector3f accel(ax - accel_bias_[0], ay - accel_bias_[1], az - accel_bias_[2]);
+    float wx = gx - gyro_bias_[0];
+    float wy = gy - gyro_bias_[1];
+    float wz = gz - gyro_bias_[2];
+    
+    common::Vector3f accel_world = rotation_ * accel;
+    accel_world[2] -= GRAVITY;
+    position_ += velocity_ * dt + accel_world * (0.5f * dt * dt);
+    velocity_ += accel_world * dt;
+    
+    float hx = 0.5f * wx * dt;
+    float hy = 0.5f * wy * dt;
+    float hz = 0.5f * wz * dt;
+    Quaternion q = attitude_;
+    attitude_.w = q.w - q.x * hx - q.y * hy - q.z * hz;
+    attitude_.x = q.x + q.w * hx + q.y * hz - q.z * hy;
+    attitude_.y = q.y + q.w * hy - q.x * hz + q.z * hx;
+    attitude_.z = q.z + q.w * hz + q.x * hy - q.y * hx;
+    float inv_norm = common::InvSqrtFastPrecise::apply(attitude_.w * attitude_.w + attitude_.x * attitude_.x
+                                                       + attitude_.y * attitude_.y + attitude_.z * attitude_.z);
+    attitude_.w *= inv_norm;
+    attitude_.x *= inv_norm;
+    attitude_.y *= inv_norm;
+    attitude_.z *= inv_norm;
+    
+    // 状態遷移行列Fの非零要素（1次近似、Rは伝播前の姿勢）
+    // δv' = δv - R[a]x δθ dt - R δba dt、δθ' = (I - [ω]x dt) δθ - δbg dt
+    const common::Matrix3f& r = rotation_;
+    float skew_a[3][3] = {{0.0f, -accel[2], accel[1]}, {accel[2], 0.0f, -accel[0]}, {-accel[1], accel[0], 0.0f}};
+    for (uint8_t i = 0; i < 3; i++) {
+        TransitionRow& pos_row = transition_[POS + i];
+        pos_row.clear();
+        pos_row.add(POS + i, 1.0f);
+        pos_row.add(VEL + i, dt);
+        
+        TransitionRow& vel_row = transition_[VEL + i];
+        vel_row.clear();
+        vel_row.add(VEL + i, 1.0f);
+        for (uint8_t k = 0; k < 3; k++) {
+            float r_skew = r(i, 0) * skew_a[0][k] + r(i, 1) * skew_a[1][k] + r(i, 2) * skew_a[2][k];
+            vel_row.add(ATT + k, -r_skew * dt);
+        }
+        for (uint8_t k = 0; k < 3; k++) {
+            vel_row.add(ACCEL_BIAS + k, -r(i, k) * dt);
+        }
+    }
+    float wdt[3] = {wx * dt, wy * dt, wz * dt};
+    TransitionRow& att_x = transition_[ATT + 0];
+    att_x.clear();
+    att_x.add(ATT + 0, 1.0f);
+    att_x.add(ATT + 1, wdt[2]);
+    att_x.add(ATT + 2, -wdt[1]);
+    att_x.add(GYRO_BIAS + 0, -dt);
+    TransitionRow& att_y = transition_[ATT + 1];
+    att_y.clear();
+    att_y.add(ATT + 0, -wdt[2]);
+    att_y.add(ATT + 1, 1.0f);
+    att_y.add(ATT + 2, wdt[0]);
+    att_y.add(GYRO_BIAS + 1, -dt);
+    TransitionRow& att_z = transition_[ATT + 2];
+    att_z.clear();
+    att_z.add(ATT + 0, wdt[1]);
+    att_z.add(ATT + 1, -wdt[0]);
+    att_z.add(ATT + 2, 1.0f);
+    att_z.add(GYRO_BIAS + 2, -dt);
+    
+    // F P（Pを展開し、Fの非零要素のみ積和）
+    covariance_.toDense(dense_);
+    for (size_t i = 0; i < STATE_DIM; i++) {
+        const TransitionRow& row = transition_[i];
+        float* out = &product_[i * STATE_DIM];
+        const float* src = &dense_[row.col[0] * STATE_DIM];
+        float f = row.value[0];
+        for (size_t j = 0; j < STATE_DIM; j++) {
+            out[j] = f * src[j];
+        }
+        for (size_t n = 1; n < row.count; n++) {
+            src = &dense_[row.col[n] * STATE_DIM];
+            f = row.value[n];
+            for (size_t j = 0; j < STATE_DIM; j++) {
+                out[j] += f * src[j];
+            }
+        }
+    }
+    
+    // (F P) F^T の上三角のみ計算してパック形式へ書き戻す
+    float* dst = covariance_.data();
+    for (size_t i = 0; i < STATE_DIM; i++) {
+        const float* fp = &product_[i * STATE_DIM];
+        for (size_t j = i; j < STATE_DIM; j++) {
+            const TransitionRow& row = transition_[j];
+            float sum = 0.0f;
+            for (size_t n = 0; n < row.count; n++) {
+                sum += fp[row.col[n]] * row.value[n];
+            }
+            *dst++ = sum;
+        }
+    }
+    
+    // プロセスノイズ（対角、加速度ノイズは等方的なので回転を省略）
+    float* p = covariance_.data();
+    float q_vel = config_.accel_noise * config_.accel_noise * dt;
+    float q_att = config_.gyro_noise * config_.gyro_noise * dt;
+    float q_accel_bias = config_.accel_bias_walk * config_.accel_bias_walk * dt;
+    float q_gyro_bias = config_.gyro_bias_walk * config_.gyro_bias_walk * dt;
+    for (size_t i = 0; i < 3; i++) {
+        p[common::SymmetricMatrix<STATE_DIM>::rowOffset(VEL + i)] += q_vel;
+        p[common::SymmetricMatrix<STATE_DIM>::rowOffset(ATT + i)] += q_att;
+        p[common::SymmetricMatrix<STATE_DIM>::rowOffset(ACCEL_BIAS + i)] += q_accel_bias;
+        p[common::SymmetricMatrix<STATE_DIM>::rowOffset(GYRO_BIAS + i)] += q_gyro_bias;
+    }
+    p[common::SymmetricMatrix<STATE_DIM>::rowOffset(BARO_BIAS)] += config_.baro_bias_walk * config_.baro_bias_walk * dt;
+    
+    updateRotation();
+    
+    uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    stats_.predicts++;
+    stats_.last_predict_cycles = cycles;
+    if (cycles > stats_.max_predict_cycles) {
+        stats_.max_predict_cycles = cycles;
+    }
+    if (cycles > config_.predict_cycle_budget) {
+        stats_.predict_overruns++;
+    }
+}
+
+bool ErrorStateEkf::scalarUpdate(const ObservationRow& h, float residual, float variance, Measurement kind) {
+    uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    
+    // P h^T（hの非零列のみ参照）
+    float pht[STATE_DIM];
+    for (size_t i = 0; i < STATE_DIM; i++) {
+        float sum = 0.0f;
+        for (size_t n = 0; n < h.count; n++) {
+            sum += covariance_(i, h.col[n]) * h.value[n];
+        }
+        pht[i] = sum;
+    }
+    float innovation_variance = variance;
+    for (size_t n = 0; n < h.count; n++) {
+        innovation_variance += h.value[n] * pht[h.col[n]];
+    }
+    
+    if (residual * residual > config_.innovation_gate * innovation_variance) {
+        stats_.rejected[kind]++;
+        return false;
+    }
+    
+    // K = P h^T / s、P -= K s K^T = (P h^T)(P h^T)^T / s
+    float inv_s = 1.0f / innovation_variance;
+    float dx[STATE_DIM];
+    for (size_t i = 0; i < STATE_DIM; i++) {
+        dx[i] = pht[i] * inv_s * residual;
+    }
+    covariance_.rankOneUpdate(pht, -inv_s);
+    covariance_.clampDiagonal(MIN_VARIANCE);
+    
+    inject(dx);
+    
+    stats_.accepted[kind]++;
+    stats_.last_update_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    return true;
+}
+
+void ErrorStateEkf::inject(const float* dx) {
+    for (size_t i = 0; i < 3; i++) {
+        position_[i] += dx[POS + i];
+        velocity_[i] += dx[VEL + i];
+        accel_bias_[i] += dx[ACCEL_BIAS + i];
+        gyro_bias_[i] += dx[GYRO_BIAS + i];
+    }
+    baro_bias_ += dx[BARO_BIAS];
+    
+    // q = q ⊗ [1, δθ/2]（誤差状態は注入後0に戻る、リセットのヤコビアンは単位行列で近似）
+    float hx = 0.5f * dx[ATT + 0];
+    float hy = 0.5f * dx[ATT + 1];
+    float hz = 0.5f * dx[ATT + 2];
+    Quaternion q = attitude_;
+    attitude_.w = q.w - q.x * hx - q.y * hy - q.z * hz;
+    attitude_.x = q.x + q.w * hx + q.y * hz - q.z * hy;
+    attitude_.y = q.y + q.w * hy - q.x * hz + q.z * hx;
+    attitude_.z = q.z + q.w * hz + q.x * hy - q.y * hx;
+    float inv_norm = common::InvSqrtFastPrecise::apply(attitude_.w * attitude_.w + attitude_.x * attitude_.x
+                                                       + attitude_.y * attitude_.y + attitude_.z * attitude_.z);
+    attitude_.w *= inv_norm;
+    attitude_.x *= inv_norm;
+    attitude_.y *= inv_norm;
+    attitude_.z *= inv_norm;
+    updateRotation();
+}
+
+bool ErrorStateEkf::fuseTofRange(float range) {
+    // 平坦な地面を仮定: range = pz / R22（R22は機体Z軸の鉛直成分）
+    float r22 = rotation_(2, 2);
+    float height = position_[2];
+    if (range <= 0.0f || range > config_.tof_max_range || r22 < config_.max_tilt_cos || height <= 0.0f) {
+        stats_.rejected[TOF]++;
+        return false;
+    }
+    
+    float inv_r22 = 1.0f / r22;
+    float predicted = height * inv_r22;
+    float tilt_gain = height * inv_r22 * inv_r22;
+    
+    ObservationRow h;
+    h.clear();
+    h.add(POS + 2, inv_r22);
+    h.add(ATT + 0, tilt_gain * rotation_(2, 1));
+    h.add(ATT + 1, -tilt_gain * rotation_(2, 0));
+    return scalarUpdate(h, range - predicted, config_.tof_noise * config_.tof_noise, TOF);
+}
+
+bool ErrorStateEkf::fuseOpticalFlow(float flow_x, float flow_y) {
+    // flow = v_body_xy / d、d = pz / R22（機体Z軸方向の地面までの距離）
+    float r22 = rotation_(2, 2);
+    float height = position_[2];
+    if (r22 < config_.max_tilt_cos || height < config_.flow_min_height) {
+        stats_.rejected[FLOW] += 2;
+        return false;
+    }
+    
+    bool accepted = true;
+    for (uint8_t axis = 0; axis < 2; axis++) {
+        // 1軸目の注入で状態が変わるため、軸毎に線形化し直す
+        const common::Matrix3f& r = rotation_;
+        float v_body[3];
+        for (size_t k = 0; k < 3; k++) {
+            v_body[k] = r(0, k) * velocity_[0] + r(1, k) * velocity_[1] + r(2, k) * velocity_[2];
+        }
+        float distance = position_[2] / r(2, 2);
+        float inv_d = 1.0f / distance;
+        float predicted = v_body[axis] * inv_d;
+        
+        ObservationRow h;
+        h.clear();
+        for (uint8_t k = 0; k < 3; k++) {
+            h.add(VEL + k, r(k, axis) * inv_d);
+        }
+        h.add(POS + 2, -predicted * inv_d / r(2, 2));
+        // ∂v_body/∂δθ = [v_body]x
+        if (axis == 0) {
+            h.add(ATT + 1, -v_body[2] * inv_d);
+            h.add(ATT + 2, v_body[1] * inv_d);
+        } else {
+            h.add(ATT + 0, v_body[2] * inv_d);
+            h.add(ATT + 2, -v_body[0] * inv_d);
+        }
+        float measured = axis == 0 ? flow_x : flow_y;
+        accepted &= scalarUpdate(h, measured - predicted, config_.flow_noise * config_.flow_noise, FLOW);
+    }
+    return accepted;
+}
+
+bool ErrorStateEkf::fuseBaroAltitude(float altitude) {
+    if (!baro_initialized_) {
+        baro_bias_ = altitude - position_[2];
+        baro_initialized_ = true;
+        stats_.accepted[BARO]++;
+        return true;
+    }
+    
+    ObservationRow h;
+    h.clear();
+    h.add(POS + 2, 1.0f);
+    h.add(BARO_BIAS, 1.0f);
+    float predicted = position_[2] + baro_bias_;
+    return scalarUpdate(h, altitude - predicted, config_.baro_noise * config_.baro_noise, BARO);
+}
+
+bool ErrorStateEkf::fuseExternalPosition(const common::Vector3f& position) {
+    if (!ext_position_initialized_ || ext_reject_run_ >= config_.ext_reset_count) {
+        position_ = position;
+        ext_position_initialized_ = true;
+        ext_reject_run_ = 0;
+        stats_.accepted[EXT_POSITION] += 3;
+        return true;
+    }
+    
+    bool accepted = true;
+    const float variance = config_.ext_position_noise * config_.ext_position_noise;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        ObservationRow h;
+        h.clear();
+        h.add(POS + axis, 1.0f);
+        accepted &= scalarUpdate(h, position[axis] - position_[axis], variance, EXT_POSITION);
+    }
+    ext_reject_run_ = accepted ? 0 : ext_reject_run_ + 1;
+    return accepted;
+}
+
+bool ErrorStateEkf::fuseExternalYaw(float yaw) {
+    // 傾きが大きいとヨー角の線形化が悪くなる（ToF・フローと同じ下限）
+    const common::Matrix3f& r = rotation_;
+    const float norm = r(0, 0) * r(0, 0) + r(1, 0) * r(1, 0);
+    if (r(2, 2) < config_.max_tilt_cos || norm < 1e-6f) {
+        stats_.rejected[EXT_YAW]++;
+        return false;
+    }
+    float residual = yaw - atan2f(r(1, 0), r(0, 0));
+    residual = remainderf(residual, 2.0f * static_cast<float>(M_PI));
+    
+    if (!ext_yaw_initialized_) {
+        // 基準座標のZ軸回りに回す: q = q_z(Δψ) ⊗ q
+        const float c = cosf(0.5f * residual);
+        const float s = sinf(0.5f * residual);
+        const Quaternion q = attitude_;
+        attitude_ = Quaternion{c * q.w - s * q.z, c * q.x - s * q.y, c * q.y + s * q.x, c * q.z + s * q.w};
+        updateRotation();
+        ext_yaw_initialized_ = true;
+        stats_.accepted[EXT_YAW]++;
+        return true;
+    }
+    
+    // ψ = atan2(R10, R00)、R ← R (I + [δθ]x) より ∂ψ/∂δθ（δθxは寄与しない）
+    const float inv_norm = 1.0f / norm;
+    ObservationRow h;
+    h.clear();
+    h.add(ATT + 1, (r(1, 0) * r(0, 2) - r(0, 0) * r(1, 2)) * inv_norm);
+    h.add(ATT + 2, (r(0, 0) * r(1, 1) - r(1, 0) * r(0, 1)) * inv_norm);
+    return scalarUpdate(h, residual, config_.ext_yaw_noise * config_.ext_yaw_noise, EXT_YAW);
+}
+
+void ErrorStateEkf::resetStats() {
+    stats_ = Stats{};
+}
+
+void ErrorStateEkf::dump() const {
+    EulerAngles euler;
+    float sin_pitch = -rotation_(2, 0);
+    sin_pitch = sin_pitch > 1.0f ? 1.0f : (sin_pitch < -1.0f ? -1.0f : sin_pitch);
+    euler.roll = atan2f(rotation_(2, 1), rotation_(2, 2));
+    euler.pitch = asinf(sin_pitch);
+    euler.yaw = atan2f(rotation_(1, 0), rotation_(0, 0));
+    
+    ESP_LOGI(TAG, "位置 %.3f %.3f %.3f m 速度 %.3f %.3f %.3f m/s", 
+             position_[0], position_[1], position_[2], velocity_[0], velocity_[1], velocity_[2]);
+    ESP_LOGI(TAG, "姿勢 roll %.2f pitch %.2f yaw %.2f deg 気圧バイアス %.2f m", 
+             euler.roll * 57.2958f, euler.pitch * 57.2958f, euler.yaw * 57.2958f, baro_bias_);
+    ESP_LOGI(TAG, "σ 高度 %.3f m 速度XY %.3f %.3f m/s", 
+             sqrtf(getVariance(POS + 2)), sqrtf(getVariance(VEL + 0)), sqrtf(getVariance(VEL + 1)));
+    ESP_LOGI(TAG, "予測 %lu回 前回 %lu 最大 %lu サイクル 予算超過 %lu", 
+             static_cast<unsigned long>(stats_.predicts), static_cast<unsigned long>(stats_.last_predict_cycles), 
+             static_cast<unsigned long>(stats_.max_predict_cycles), static_cast<unsigned long>(stats_.predict_overruns));
+    ESP_LOGI(TAG, "観測 採用/棄却 ToF %lu/%lu フロー %lu/%lu 気圧 %lu/%lu 外部位置 %lu/%lu 外部ヨー %lu/%lu", 
+             static_cast<unsigned long>(stats_.accepted[TOF]), static_cast<unsigned long>(stats_.rejected[TOF]), 
+             static_cast<unsigned long>(stats_.accepted[FLOW]), static_cast<unsigned long>(stats_.rejected[FLOW]), 
+             static_cast<unsigned long>(stats_.accepted[BARO]), static_cast<unsigned long>(stats_.rejected[BARO]), 
+             static_cast<unsigned long>(stats_.accepted[EXT_POSITION]), 
+             static_cast<unsigned long>(stats_.rejected[EXT_POSITION]), 
+             static_cast<unsigned long>(stats_.accepted[EXT_YAW]), static_cast<unsigned long>(stats_.rejected[EXT_YAW]));
+}
+
+} // namespace estimation
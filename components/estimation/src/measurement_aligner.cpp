@@ -0,0 +1,167 @@
+/*
+ * Measurement Aligner Implementation
+ * 
+ * 観測の時刻合わせ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "measurement_aligner.hpp"
+#include "esp_log.h"
+#include <math.h>
+
+namespace estimation {
+
+static const char* TAG = "estimation::MeasurementAligner";
+
+MeasurementAligner::MeasurementAligner() {
+    reset();
+}
+
+void MeasurementAligner::reset() {
+    tof_.clear();
+    flow_.clear();
+    baro_.clear();
+    ext_position_.clear();
+    ext_yaw_.clear();
+    last_ext_yaw_ = 0.0f;
+    for (size_t i = 0; i < ErrorStateEkf::MEASUREMENT_COUNT; i++) {
+        used_upper_us_[i] = INT64_MIN;
+    }
+    last_fusion_us_ = INT64_MIN;
+    stats_ = Stats{};
+}
+
+void MeasurementAligner::countPush(ErrorStateEkf::Measurement kind, int64_t timestamp_us) {
+    stats_.pushed[kind]++;
+    if (timestamp_us < last_fusion_us_) {
+        // 融合時刻より前の区間はもう融合しない（遅延の設定が短すぎる）
+        stats_.late[kind]++;
+    }
+}
+
+bool MeasurementAligner::pushTof(int64_t timestamp_us, float range) {
+    if (!tof_.push(timestamp_us, range)) {
+        return false;
+    }
+    countPush(ErrorStateEkf::TOF, timestamp_us);
+    return true;
+}
+
+bool MeasurementAligner::pushFlow(int64_t timestamp_us, float flow_x, float flow_y) {
+    if (!flow_.push(timestamp_us, FlowValue{flow_x, flow_y})) {
+        return false;
+    }
+    countPush(ErrorStateEkf::FLOW, timestamp_us);
+    return true;
+}
+
+bool MeasurementAligner::pushBaro(int64_t timestamp_us, float altitude) {
+    if (!baro_.push(timestamp_us, altitude)) {
+        return false;
+    }
+    countPush(ErrorStateEkf::BARO, timestamp_us);
+    return true;
+}
+
+bool MeasurementAligner::pushExternalPose(int64_t timestamp_us, const common::Vector3f& position, float yaw, 
+                                          bool has_yaw) {
+    if (!ext_position_.push(timestamp_us, PositionValue{position[0], position[1], position[2]})) {
+        return false;
+    }
+    countPush(ErrorStateEkf::EXT_POSITION, timestamp_us);
+    if (has_yaw) {
+        const float unwrapped = ext_yaw_.empty() 
+            ? yaw : last_ext_yaw_ + remainderf(yaw - last_ext_yaw_, 2.0f * static_cast<float>(M_PI));
+        if (ext_yaw_.push(timestamp_us, unwrapped)) {
+            last_ext_yaw_ = unwrapped;
+            countPush(ErrorStateEkf::EXT_YAW, timestamp_us);
+        }
+    }
+    return true;
+}
+
+template<typename Ring>
+bool MeasurementAligner::claim(const Ring& ring, ErrorStateEkf::Measurement kind, int64_t fusion_time_us) {
+    int64_t upper_us = 0;
+    if (!ring.upperTime(fusion_time_us, upper_us) || upper_us <= used_upper_us_[kind]) {
+        return false;
+    }
+    used_upper_us_[kind] = upper_us;
+    return true;
+}
+
+size_t MeasurementAligner::fuse(ErrorStateEkf& ekf, int64_t fusion_time_us) {
+    last_fusion_us_ = fusion_time_us;
+    size_t fused = 0;
+    
+    if (claim(tof_, ErrorStateEkf::TOF, fusion_time_us)) {
+        float range = 0.0f;
+        if (tof_.sample(fusion_time_us, range, config_.tof_max_gap_us)) {
+            ekf.fuseTofRange(range);
+            stats_.fused[ErrorStateEkf::TOF]++;
+            fused++;
+        } else {
+            stats_.gaps[ErrorStateEkf::TOF]++;
+        }
+    }
+    
+    if (claim(flow_, ErrorStateEkf::FLOW, fusion_time_us)) {
+        FlowValue flow{};
+        if (flow_.sample(fusion_time_us, flow, config_.flow_max_gap_us)) {
+            ekf.fuseOpticalFlow(flow[0], flow[1]);
+            stats_.fused[ErrorStateEkf::FLOW]++;
+            fused++;
+        } else {
+            stats_.gaps[ErrorStateEkf::FLOW]++;
+        }
+    }
+    
+    if (claim(baro_, ErrorStateEkf::BARO, fusion_time_us)) {
+        float altitude = 0.0f;
+        if (baro_.sample(fusion_time_us, altitude, config_.baro_max_gap_us)) {
+            ekf.fuseBaroAltitude(altitude);
+            stats_.fused[ErrorStateEkf::BARO]++;
+            fused++;
+        } else {
+            stats_.gaps[ErrorStateEkf::BARO]++;
+        }
+    }
+    
+    if (claim(ext_position_, ErrorStateEkf::EXT_POSITION, fusion_time_us)) {
+        PositionValue position{};
+        if (ext_position_.sample(fusion_time_us, position, config_.ext_max_gap_us)) {
+            ekf.fuseExternalPosition(common::Vector3f(position[0], position[1], position[2]));
+            stats_.fused[ErrorStateEkf::EXT_POSITION]++;
+            fused++;
+        } else {
+            stats_.gaps[ErrorStateEkf::EXT_POSITION]++;
+        }
+    }
+    
+    if (claim(ext_yaw_, ErrorStateEkf::EXT_YAW, fusion_time_us)) {
+        float yaw = 0.0f;
+        if (ext_yaw_.sample(fusion_time_us, yaw, config_.ext_max_gap_us)) {
+            ekf.fuseExternalYaw(yaw);
+            stats_.fused[ErrorStateEkf::EXT_YAW]++;
+            fused++;
+        } else {
+            stats_.gaps[ErrorStateEkf::EXT_YAW]++;
+        }
+    }
+    return fused;
+}
+
+void MeasurementAligner::dump() const {
+    static const char* const NAMES[ErrorStateEkf::MEASUREMENT_COUNT] = {"ToF", "フロー", "気圧", "外部位置", "外部ヨー"};
+    for (size_t i = 0; i < ErrorStateEkf::MEASUREMENT_COUNT; i++) {
+        ESP_LOGI(TAG, "%s 追加 %lu 融合 %lu 欠測 %lu 遅着 %lu", NAMES[i], 
+                 static_cast<unsigned long>(stats_.pushed[i]), static_cast<unsigned long>(stats_.fused[i]), 
+                 static_cast<unsigned long>(stats_.gaps[i]), static_cast<unsigned long>(stats_.late[i]));
+    }
+}
+
+} // namespace estimation
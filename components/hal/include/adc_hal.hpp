@@ -17,9 +17,14 @@
 #include "esp_adc/adc_oneshot.h"
 #include "esp_adc/adc_cali.h"
 #include "esp_adc/adc_cali_scheme.h"
+#include "esp_adc/adc_continuous.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
 #include <memory>
 #include <mutex>
 #include <map>
+#include <vector>
 
 namespace hal {
 
@@ -87,6 +92,25 @@ public:
         int voltage_mv;             // 電圧値（mV）
         bool calibrated;            // キャリブレーション済みフラグ
     };
+    
+    /**
+     * @brief 連続変換（DMA）設定構造体
+     */
+    struct ContinuousConfig {
+        uint32_t sample_freq_hz;    // 全チャンネル合計のサンプリング周波数（Hz）
+        uint32_t frame_size;        // 変換フレームサイズ（バイト、このサンプル群の平均を最新値とする）
+        uint32_t buffer_size;       // DMAリングバッファサイズ（バイト）
+        UBaseType_t task_priority;  // フレーム処理タスク優先度
+    };
+    
+    static constexpr size_t MAX_CHANNELS = 10;  // ユニットあたりの最大チャンネル数
+    
+    /**
+     * @brief トレースポイント番号（HalBase::getTraceStats()の引数）
+     */
+    enum TracePoint : size_t {
+        TRACE_READ = 0      // ワンショット変換
+    };
 
 public:
     /**
@@ -186,6 +210,43 @@ public:
      */
     esp_err_t readFiltered(adc_channel_t channel, float alpha, ReadResult& result);
 
+    /**
+     * @brief 連続変換（DMA）開始
+     * 
+     * configureChannel()で設定済みの全チャンネルを一定周期でDMAリングへ変換し、
+     * フレーム毎のチャンネル平均を最新値として保持する。
+     * 動作中はread()/readAverage()も最新値を返す（ブロックしない）
+     * @param config 連続変換設定
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t startContinuous(const ContinuousConfig& config);
+    
+    /**
+     * @brief 連続変換（DMA）停止
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stopContinuous();
+    
+    /**
+     * @brief 連続変換の動作状態取得
+     * @return bool 動作中の場合true
+     */
+    bool isContinuousRunning() const { return continuous_running_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 連続変換の最新値取得（ノンブロッキング）
+     * @param channel チャンネル番号
+     * @param result 最新値格納先
+     * @return esp_err_t 取得結果（未変換の場合ESP_ERR_NOT_FOUND）
+     */
+    esp_err_t getLatest(adc_channel_t channel, ReadResult& result);
+    
+    /**
+     * @brief 連続変換のプールオーバーフロー回数取得
+     * @return uint32_t オーバーフロー回数
+     */
+    uint32_t getContinuousOverflowCount() const { return continuous_overflow_count_.load(std::memory_order_relaxed); }
+    
     /**
      * @brief チャンネル減衰設定
      * @param channel チャンネル番号
@@ -241,8 +302,49 @@ private:
     std::mutex mutex_;                                  // スレッドセーフ用ミューテックス
     adc_oneshot_unit_handle_t adc_handle_;             // ADCハンドル
     std::map<adc_channel_t, ChannelConfig> channels_; // チャンネル設定管理
-    std::map<adc_channel_t, adc_cali_handle_t> calibration_handles_; // キャリブレーションハンドル
-    std::map<adc_channel_t, float> filter_values_;    // フィルタ値管理
+    adc_cali_handle_t calibration_handles_[MAX_CHANNELS];  // キャリブレーションハンドル（チャンネル番号で参照）
+    std::atomic<float> filter_values_[MAX_CHANNELS];       // フィルタ値（NaN=未初期化）
+    
+    /**
+     * @brief 連続変換のチャンネル毎最新値
+     */
+    struct ContinuousChannel {
+        std::atomic<int32_t> raw_value;     // 最新フレームの平均値
+        std::atomic<uint32_t> sequence;     // 更新回数（0=未変換）
+    };
+    
+    adc_continuous_handle_t continuous_handle_;        // 連続変換ハンドル
+    TaskHandle_t continuous_task_;                     // フレーム処理タスク
+    std::atomic<bool> continuous_running_;             // 連続変換動作フラグ
+    std::atomic<bool> continuous_stop_request_;        // 処理タスク停止要求
+    std::atomic<uint32_t> continuous_overflow_count_;  // プールオーバーフロー回数
+    std::vector<uint8_t> continuous_frame_;            // フレーム読み出しバッファ
+    ContinuousChannel continuous_channels_[MAX_CHANNELS];  // チャンネル毎最新値
+    
+    /**
+     * @brief 変換フレーム完了コールバック（ISRコンテキスト）
+     */
+    static bool IRAM_ATTR onConversionDone(adc_continuous_handle_t handle,  
+                                           const adc_continuous_evt_data_t* edata, void* user_data);
+    
+    /**
+     * @brief プールオーバーフローコールバック（ISRコンテキスト）
+     */
+    static bool IRAM_ATTR onPoolOverflow(adc_continuous_handle_t handle,  
+                                         const adc_continuous_evt_data_t* edata, void* user_data);
+    
+    /**
+     * @brief フレーム処理タスク
+     * @param arg AdcHalインスタンス
+     */
+    static void continuousTask(void* arg);
+    
+    /**
+     * @brief 変換フレームをチャンネル毎に平均して最新値を更新
+     * @param data フレームデータ
+     * @param length フレーム長（バイト）
+     */
+    void processFrame(const uint8_t* data, uint32_t length);
     
     /**
      * @brief キャリブレーションハンドル作成
@@ -257,6 +359,22 @@ private:
      * @param channel チャンネル番号
      */
     void destroyCalibrationHandle(adc_channel_t channel);
+    
+    /**
+     * @brief 生値から電圧値へ変換（キャリブレーション無し時は推定値）
+     * @param channel チャンネル番号（範囲確認済みであること）
+     * @param raw_value 生のADC値
+     * @param voltage_mv 電圧値格納先（mV）
+     * @return bool キャリブレーション値を使用した場合true
+     */
+    bool rawToVoltage(adc_channel_t channel, int raw_value, int& voltage_mv) const;
+    
+    /**
+     * @brief チャンネル番号がテーブル範囲内か確認
+     */
+    static bool inTableRange(adc_channel_t channel) {
+        return channel >= 0 && static_cast<size_t>(channel) < MAX_CHANNELS;
+    }
 };
 
 } // namespace hal
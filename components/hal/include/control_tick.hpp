@@ -0,0 +1,278 @@
+/*
+ * Control Tick
+ * 
+ * GPTimerアラームによる制御ループのハードウェアタイミング源
+ * アラームISR（IRAM）から制御タスクへ直接タスク通知し、毎ティックの
+ * アラーム→ISR→タスク実行までの遅延をタイマーカウントで記録する。
+ * MCPWMキャプチャでIMUのINTエッジをハードウェア時刻記録し、同じ時間軸へ換算する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef CONTROL_TICK_HPP
+#define CONTROL_TICK_HPP
+
+#include "hal_base.hpp"
+#include "mailbox.hpp"
+#include "driver/gptimer.h"
+#include "driver/mcpwm_prelude.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+
+namespace hal {
+
+/**
+ * @brief 制御ティッククラス
+ * 
+ * GPTimerはフリーランで、アラームISRが次のアラーム値（前回値+周期+位相補正）を再設定する。
+ * そのためティック時刻・キャプチャ時刻はすべて単調増加する1本のカウント軸で比較できる。
+ * 
+ * キャプチャタイマー（APB 80MHz）とGPTimerは同じ水晶から分周されるためドリフトせず、
+ * キャプチャISRで読んだGPTimerカウントとの差の最小値（ISR遅延が最小のサンプル）を
+ * 両時間軸のオフセットとする。換算後のエッジ時刻は割り込み遅延のばらつきを含まない
+ * 
+ * タイマーは start()〜stop() の間だけ有効化する。有効化中は各ドライバが電源管理ロック
+ * （APB最大周波数）を持つため、停止中はディスアーム時の周波数低下・ライトスリープを妨げない
+ */
+class ControlTick : public HalBase {
+public:
+    static constexpr uint32_t DEFAULT_RESOLUTION_HZ = 10000000;     // 既定のカウント分解能（0.1μs）
+    static constexpr uint32_t OFFSET_WINDOW = 64;                   // オフセット推定の更新間隔（キャプチャ数）
+    
+    /**
+     * @brief 制御ティック設定構造体
+     */
+    struct Config {
+        uint32_t resolution_hz;     // GPTimerの分解能（Hz、キャプチャタイマー分解能を割り切れる値）
+        uint32_t period_us;         // ティック周期（μs）
+        gpio_num_t capture_gpio;    // IMU INTピン（GPIO_NUM_NCでキャプチャなし）
+        bool capture_rising_edge;   // 立ち上がりエッジでキャプチャ（falseで立ち下がり）
+        int capture_group;          // キャプチャに使うMCPWMグループ（MotorHalと別グループ推奨）
+    };
+    
+    /**
+     * @brief ティック情報構造体（waitForTick()の結果）
+     * 
+     * カウントはすべてConfig::resolution_hz単位
+     */
+    struct TickInfo {
+        uint32_t tick;              // ティック番号
+        uint32_t missed;            // 前回のwaitForTick()以降に取りこぼしたティック数
+        uint64_t alarm_count;       // 予定アラーム時刻
+        uint32_t isr_latency;       // アラーム→ISR入口
+        uint32_t wake_latency;      // ISR入口→タスク実行再開
+        bool capture_valid;         // キャプチャ時刻が有効
+        uint64_t capture_count;     // 直近のIMU INTエッジ時刻
+        int64_t capture_phase;      // alarm_count - capture_count（エッジからティックまで）
+    };
+    
+    /**
+     * @brief 遅延統計構造体（カウント単位）
+     */
+    struct Stats {
+        uint32_t ticks;             // 処理したティック数
+        uint32_t missed;            // 取りこぼしたティック数
+        uint32_t max_isr_latency;   // 最大ISR遅延
+        uint32_t avg_isr_latency;   // 平均ISR遅延
+        uint32_t max_wake_latency;  // 最大タスク起床遅延
+        uint32_t avg_wake_latency;  // 平均タスク起床遅延
+        uint32_t captures;          // キャプチャ回数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     */
+    ControlTick();
+    
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~ControlTick();
+    
+    /**
+     * @brief 設定
+     * @param config 制御ティック設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 通知先タスク設定（start()前に設定）
+     * @param task 制御タスク
+     */
+    void setNotifyTask(TaskHandle_t task) { notify_task_ = task; }
+    
+    /**
+     * @brief 初期化（GPTimerとキャプチャチャネルを作成）
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize() override;
+    
+    /**
+     * @brief 設定変更
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t configure() override;
+    
+    /**
+     * @brief 開始
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start() override;
+    
+    /**
+     * @brief 停止
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop() override;
+    
+    /**
+     * @brief リセット（統計とオフセット推定を消去）
+     * @return esp_err_t リセット結果
+     */
+    esp_err_t reset() override;
+    
+    /**
+     * @brief 次のティックを待つ（制御タスク専用）
+     * @param info ティック情報格納先
+     * @param timeout 待ち時間
+     * @return esp_err_t ESP_OK、タイムアウト時ESP_ERR_TIMEOUT
+     */
+    esp_err_t waitForTick(TickInfo& info, TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief ティック位相補正（次のアラームに一度だけ加算）
+     * @param counts 補正量（カウント、正で遅らせる）
+     */
+    void adjustPhase(int32_t counts) { phase_adjust_.fetch_add(counts, std::memory_order_relaxed); }
+    
+    /**
+     * @brief IMU INTエッジへのティック位相合わせ
+     * 
+     * エッジからoffset_us後にティックが来るよう位相を補正する。
+     * 1回の補正量は周期の1/4までに制限するため、数ティックで収束する
+     * @param info 直近のティック情報
+     * @param offset_us エッジからティックまでの目標時間（μs）
+     * @return int32_t 適用した補正量（カウント）
+     */
+    int32_t alignToCapture(const TickInfo& info, uint32_t offset_us);
+    
+    /**
+     * @brief 遅延統計取得
+     * @param stats 統計格納先
+     */
+    void getStats(Stats& stats) const;
+    
+    /**
+     * @brief 遅延統計のログ出力
+     */
+    void dumpStats() const;
+    
+    /**
+     * @brief 現在のカウント値取得
+     * @param count カウント格納先
+     * @return esp_err_t 取得結果
+     */
+    esp_err_t getCount(uint64_t& count) const;
+    
+    /**
+     * @brief カウントをμsへ換算
+     * @param counts カウント
+     * @return uint32_t μs
+     */
+    uint32_t countsToUs(uint64_t counts) const {
+        return static_cast<uint32_t>(counts / (config_.resolution_hz / 1000000));
+    }
+    
+private:
+    /**
+     * @brief ISRからタスクへ渡すティック記録
+     */
+    struct TickSample {
+        uint32_t tick;              // ティック番号
+        uint64_t alarm_count;       // アラーム値
+        uint64_t isr_count;         // ISR入口のカウント
+    };
+    
+    /**
+     * @brief キャプチャ記録（GPTimer軸へ換算済み）
+     */
+    struct CaptureSample {
+        uint64_t edge_count;        // エッジ時刻
+    };
+    
+    Config config_;                             // 設定
+    TaskHandle_t notify_task_;                  // 通知先タスク
+    gptimer_handle_t timer_;                    // GPTimer
+    mcpwm_cap_timer_handle_t cap_timer_;        // キャプチャタイマー
+    mcpwm_cap_channel_handle_t cap_channel_;    // キャプチャチャネル
+    uint64_t period_counts_;                    // 周期（カウント）
+    uint32_t capture_divider_;                  // キャプチャ分解能 / GPTimer分解能
+    bool timer_enabled_;                        // GPTimer有効化済み（電源管理ロック保持中）
+    bool cap_enabled_;                          // キャプチャタイマー有効化済み
+    
+    // アラームISRのみ更新
+    uint32_t tick_count_;                       // ティック番号
+    std::atomic<int32_t> phase_adjust_;         // 未適用の位相補正
+    common::Mailbox<TickSample> tick_sample_;   // 直近のティック記録
+    
+    // キャプチャISRのみ更新
+    uint32_t last_cap_value_;                   // 前回のキャプチャ値（32bit巻き戻り検出）
+    uint64_t cap_extended_;                     // 64bitへ拡張したキャプチャ値
+    bool offset_valid_;                         // オフセット推定済み
+    int64_t offset_;                            // 使用中のオフセット（GPTimer - キャプチャ換算値）
+    int64_t window_min_offset_;                 // 推定窓内の最小オフセット
+    uint32_t window_samples_;                   // 推定窓内のサンプル数
+    std::atomic<uint32_t> capture_count_;       // キャプチャ回数
+    common::Mailbox<CaptureSample> capture_sample_;     // 直近のキャプチャ記録
+    
+    // 制御タスクのみ更新
+    uint32_t last_tick_;                        // 前回処理したティック番号
+    std::atomic<uint32_t> stat_ticks_;          // 処理ティック数
+    std::atomic<uint32_t> stat_missed_;         // 取りこぼし数
+    std::atomic<uint32_t> stat_max_isr_;        // 最大ISR遅延
+    std::atomic<uint32_t> stat_max_wake_;       // 最大起床遅延
+    uint64_t stat_total_isr_;                   // ISR遅延合計
+    uint64_t stat_total_wake_;                  // 起床遅延合計
+    std::atomic<uint32_t> stat_avg_isr_;        // 平均ISR遅延
+    std::atomic<uint32_t> stat_avg_wake_;       // 平均起床遅延
+    
+    /**
+     * @brief GPTimerアラームコールバック
+     */
+    static bool IRAM_ATTR alarmCallback(gptimer_handle_t timer, 
+                                        const gptimer_alarm_event_data_t* edata, 
+                                        void* user_data);
+    
+    /**
+     * @brief MCPWMキャプチャコールバック
+     */
+    static bool IRAM_ATTR captureCallback(mcpwm_cap_channel_handle_t channel, 
+                                          const mcpwm_capture_event_data_t* edata, 
+                                          void* user_data);
+    
+    /**
+     * @brief キャプチャの作成
+     * @return esp_err_t 作成結果
+     */
+    esp_err_t initializeCapture();
+    
+    /**
+     * @brief タイマーの無効化（電源管理ロックの解放）
+     */
+    void disableTimers();
+    
+    /**
+     * @brief ハンドルの解放
+     */
+    void release();
+};
+
+} // namespace hal
+
+#endif // CONTROL_TICK_HPP
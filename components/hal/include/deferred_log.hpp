@@ -0,0 +1,171 @@
+/*
+ * Deferred Log
+ * 
+ * 遅延フォーマットのバイナリログリング
+ * 呼び出し側はフォーマット文字列のポインタと生の引数を記録するだけで、
+ * 文字列化と出力は低優先度タスクが行う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef DEFERRED_LOG_HPP
+#define DEFERRED_LOG_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace hal {
+
+/**
+ * @brief 遅延ログクラス（全体で1つのリングを共有）
+ * 
+ * フォーマット文字列・タグ・%s引数は静的領域（文字列リテラル等）を指すこと。
+ * 引数は32bit以下の整数・列挙型・ポインタ・floatのみ（%lld等の64bit引数は不可）。
+ * 記録はスピンロック区間での数回のストアのみで、タスク・ISRのどちらからも呼び出せる
+ */
+class DeferredLog {
+public:
+    static constexpr size_t MAX_ARGS = 4;               // 1レコードの最大引数数
+    static constexpr size_t RING_SIZE = 64;             // リングのレコード数（2のべき乗）
+    static constexpr uint32_t DEFAULT_TASK_STACK_SIZE = 3072;
+    static constexpr UBaseType_t DEFAULT_TASK_PRIORITY = 1;
+    
+    static_assert((RING_SIZE & (RING_SIZE - 1)) == 0, "リングサイズは2のべき乗");
+    
+    /**
+     * @brief ログレコード
+     */
+    struct Record {
+        uint32_t timestamp_ms;          // 記録時刻（ms）
+        const char* tag;                // タグ
+        const char* format;             // フォーマット文字列
+        uintptr_t args[MAX_ARGS];       // 生の引数
+        uint8_t level;                  // ログレベル
+        uint8_t arg_count;              // 引数数
+        uint8_t float_mask;             // float引数のビットマスク
+    };
+    
+    /**
+     * @brief 出力タスク開始
+     * @param priority タスク優先度
+     * @param stack_size スタックサイズ
+     * @return esp_err_t エラーコード
+     */
+    static esp_err_t start(UBaseType_t priority = DEFAULT_TASK_PRIORITY, 
+                           uint32_t stack_size = DEFAULT_TASK_STACK_SIZE);
+    
+    /**
+     * @brief 出力タスク停止（残りのレコードは出力してから停止）
+     */
+    static void stop();
+    
+    /**
+     * @brief 出力タスク動作確認
+     * @return bool 動作中ならtrue
+     */
+    static bool isRunning() { return task_handle_ != nullptr; }
+    
+    /**
+     * @brief ログ記録
+     * @param level ログレベル
+     * @param tag タグ（静的文字列）
+     * @param format フォーマット文字列（静的文字列）
+     * @param args 引数（最大MAX_ARGS個）
+     */
+    template<typename... Args>
+    static void log(esp_log_level_t level, const char* tag, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "遅延ログの引数は最大4個");
+        
+        Record record;
+        record.tag = tag;
+        record.format = format;
+        record.level = static_cast<uint8_t>(level);
+        record.arg_count = static_cast<uint8_t>(sizeof...(Args));
+        record.float_mask = 0;
+        
+        size_t index = 0;
+        (packArg(record, index++, args), ...);
+        (void)index;
+        submit(record);
+    }
+    
+    /**
+     * @brief 残りのレコードを即時出力（呼び出し元タスクで実行）
+     * @return size_t 出力したレコード数
+     */
+    static size_t flush();
+    
+    /**
+     * @brief リング満杯による破棄数
+     * @return uint32_t 破棄数
+     */
+    static uint32_t getDroppedCount() { return dropped_count_.load(std::memory_order_relaxed); }
+    
+private:
+    /**
+     * @brief 引数格納
+     */
+    template<typename T>
+    static void packArg(Record& record, size_t index, T value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_floating_point_v<U>) {
+            float f = static_cast<float>(value);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            record.args[index] = bits;
+            record.float_mask |= static_cast<uint8_t>(1u << index);
+        } else if constexpr (std::is_pointer_v<U>) {
+            record.args[index] = reinterpret_cast<uintptr_t>(value);
+        } else {
+            static_assert(std::is_integral_v<U> || std::is_enum_v<U>, "遅延ログの引数は整数・列挙型・ポインタ・floatのみ");
+            static_assert(sizeof(U) <= sizeof(uint32_t), "遅延ログの引数は32bit以下");
+            record.args[index] = static_cast<uintptr_t>(static_cast<uint32_t>(value));
+        }
+    }
+    
+    /**
+     * @brief レコード投入
+     * @param record レコード
+     */
+    static void submit(const Record& record);
+    
+    /**
+     * @brief レコード取り出し
+     * @param record 格納先
+     * @return bool 取り出せた場合true
+     */
+    static bool take(Record& record);
+    
+    /**
+     * @brief レコード文字列化と出力
+     * @param record レコード
+     */
+    static void emit(const Record& record);
+    
+    /**
+     * @brief 出力タスク
+     */
+    static void drainTask(void* arg);
+    
+    static Record ring_[RING_SIZE];                     // レコードリング
+    static size_t head_;                                // 書き込み位置（spinlock_保護）
+    static size_t tail_;                                // 読み出し位置（spinlock_保護）
+    static portMUX_TYPE spinlock_;                      // リング保護
+    static std::atomic<uint32_t> dropped_count_;        // 破棄数
+    static TaskHandle_t task_handle_;                   // 出力タスク
+    static std::atomic<bool> stop_requested_;           // 停止要求
+};
+
+} // namespace hal
+
+#endif // DEFERRED_LOG_HPP
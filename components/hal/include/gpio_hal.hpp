@@ -14,9 +14,13 @@
 #define GPIO_HAL_HPP
 
 #include "hal_base.hpp"
+#include "delegate.hpp"
 #include "driver/gpio.h"
-#include <functional>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
 #include <map>
+#include <mutex>
 
 namespace hal {
 
@@ -72,12 +76,50 @@ public:
 
     /**
      * @brief 割り込みコールバック関数型
+     * 
+     * ヒープ確保なしの固定サイズデリゲート。遅延実行タスクから呼び出される
      */
-    using InterruptCallback = std::function<void(gpio_num_t pin, bool level)>;
+    using InterruptCallback = common::Delegate<void(gpio_num_t pin, bool level)>;
 
+    /**
+     * @brief ISRハンドラ関数型
+     * 
+     * 直接呼び出し時はISRコンテキストで実行されるため、IRAM_ATTRを付与し
+     * FromISR系APIのみ使用すること
+     */
+    using IsrHandler = void (*)(gpio_num_t pin, bool level, void* context);
+    
+    static constexpr size_t DEFER_QUEUE_SIZE = 32;          // 遅延実行キュー長（2のべき乗）
+    static constexpr uint32_t DEFER_TASK_STACK_SIZE = 4096; // 遅延実行タスクのスタックサイズ
+    static constexpr UBaseType_t DEFER_TASK_PRIORITY = configMAX_PRIORITIES - 2;  // 遅延実行タスクの優先度
+    
 private:
-    static std::map<gpio_num_t, GpioHal*> pin_map_;  // ピン番号とインスタンスの対応
-    static bool isr_service_installed_;              // ISRサービス初期化フラグ
+    /**
+     * @brief ピン毎のISRディスパッチ情報（DRAM常駐）
+     */
+    struct IsrEntry {
+        IsrHandler handler;         // ハンドラ
+        void* context;              // ハンドラ引数
+        GpioHal* owner;             // 登録したインスタンス
+        bool invert;                // 論理反転
+        bool deferred;              // タスクへ遅延実行する場合true
+    };
+    
+    /**
+     * @brief 遅延実行イベント
+     */
+    struct DeferredEvent {
+        uint8_t pin;                // ピン番号
+        uint8_t level;              // 割り込み時のピンレベル
+    };
+    
+    static IsrEntry isr_entries_[GPIO_NUM_MAX];             // ピン番号で直接引くディスパッチ表
+    static DeferredEvent defer_queue_[DEFER_QUEUE_SIZE];    // ISR→タスクのSPSCリングバッファ
+    static std::atomic<uint32_t> defer_head_;               // 書き込み位置（ISRのみ更新）
+    static std::atomic<uint32_t> defer_tail_;               // 読み出し位置（遅延実行タスクのみ更新）
+    static std::atomic<uint32_t> defer_overflow_count_;     // キュー満杯で破棄したイベント数
+    static TaskHandle_t defer_task_;                        // 遅延実行タスク
+    static bool isr_service_installed_;                     // ISRサービス初期化フラグ
 
 public:
     /**
@@ -168,6 +210,22 @@ public:
      */
     esp_err_t setInterrupt(gpio_num_t pin, InterruptType type, InterruptCallback callback);
 
+    /**
+     * @brief ISRハンドラ直接登録による割り込み設定
+     * 
+     * ピン番号で引く固定配列にハンドラとコンテキストを登録する。
+     * deferred=falseの場合はISR内で直接呼び出し、trueの場合はロックフリーキュー経由で
+     * 高優先度の遅延実行タスクから呼び出す
+     * @param pin ピン番号
+     * @param type 割り込みタイプ
+     * @param handler ハンドラ関数
+     * @param context ハンドラ引数
+     * @param deferred タスクへ遅延実行する場合true
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setInterruptIsr(gpio_num_t pin, InterruptType type, IsrHandler handler,  
+                              void* context, bool deferred = false);
+    
     /**
      * @brief 割り込み無効化
      * @param pin ピン番号
@@ -182,9 +240,16 @@ public:
      */
     static bool isValidPin(gpio_num_t pin);
 
+    /**
+     * @brief 遅延実行キューのオーバーフロー数取得
+     * @return uint32_t 破棄したイベント数
+     */
+    static uint32_t getDeferredOverflowCount() { return defer_overflow_count_.load(std::memory_order_relaxed); }
+    
 private:
     std::map<gpio_num_t, Config> pin_configs_;      // ピン設定管理
-    std::map<gpio_num_t, InterruptCallback> callbacks_;  // コールバック管理
+    InterruptCallback callbacks_[GPIO_NUM_MAX];     // コールバック管理（ピン番号で索引）
+    std::mutex callback_mutex_;                     // コールバック管理の排他制御
 
     /**
      * @brief ISRサービス初期化
@@ -192,11 +257,37 @@ private:
      */
     static esp_err_t installIsrService();
 
+    /**
+     * @brief 遅延実行タスク起動（初回のみ）
+     * @return esp_err_t 起動結果
+     */
+    static esp_err_t startDeferTask();
+    
+    /**
+     * @brief ディスパッチ表のエントリ解除
+     * @param pin ピン番号
+     */
+    void clearIsrEntry(gpio_num_t pin);
+    
     /**
      * @brief GPIO割り込みハンドラ
-     * @param arg 引数（未使用）
+     * @param arg ピン番号
      */
     static void IRAM_ATTR gpioIsrHandler(void* arg);
+    
+    /**
+     * @brief 遅延実行タスク本体
+     * @param arg 引数（未使用）
+     */
+    static void deferTask(void* arg);
+    
+    /**
+     * @brief デリゲートコールバック呼び出し（遅延実行タスクコンテキスト）
+     * @param pin ピン番号
+     * @param level ピンレベル
+     * @param context GpioHalインスタンス
+     */
+    static void callbackTrampoline(gpio_num_t pin, bool level, void* context);
 };
 
 } // namespace hal
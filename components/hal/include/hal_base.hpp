@@ -17,6 +17,14 @@
 #include <stdbool.h>
 #include "esp_err.h"
 #include "esp_log.h"
+#include "deferred_log.hpp"
+#include "esp_cpu.h"
+#include "freertos/FreeRTOS.h"
+
+// トレース計測のコンパイル時有効化（CMakeのHAL_TRACEで設定）
+#ifndef HAL_TRACE_ENABLED
+#define HAL_TRACE_ENABLED 1
+#endif
 
 namespace hal {
 
@@ -49,6 +57,34 @@ public:
         HIGH = 2,       // 高優先度
         CRITICAL = 3    // クリティカル優先度
     };
+    
+    static constexpr size_t MAX_TRACE_POINTS = 4;           // インスタンスあたりのトレースポイント数
+    static constexpr size_t TRACE_HISTOGRAM_BUCKETS = 12;   // ヒストグラムのビン数
+    static constexpr uint32_t TRACE_HISTOGRAM_SHIFT = 9;    // ビン0の上限（2^9サイクル）
+    static constexpr size_t MAX_INSTANCES = 16;             // トレース一覧に登録できるインスタンス数
+    
+    /**
+     * @brief トレース統計構造体
+     * 
+     * histogram[i]は 2^(SHIFT+i-1) 以上 2^(SHIFT+i) 未満のサイクル数（ビン0は2^SHIFT未満、最終ビンは上限なし）
+     */
+    struct TraceStats {
+        const char* name;                           // トレースポイント名（未登録はnullptr）
+        uint32_t count;                             // 計測回数
+        uint32_t errors;                            // エラー回数
+        uint32_t min_cycles;                        // 最小サイクル数
+        uint32_t max_cycles;                        // 最大サイクル数
+        uint64_t total_cycles;                      // 合計サイクル数
+        uint32_t histogram[TRACE_HISTOGRAM_BUCKETS];    // 所要サイクルのヒストグラム
+        
+        /**
+         * @brief 平均サイクル数
+         * @return uint32_t 平均サイクル数
+         */
+        uint32_t averageCycles() const {
+            return count > 0 ? static_cast<uint32_t>(total_cycles / count) : 0;
+        }
+    };
 
 protected:
     /**
@@ -137,6 +173,76 @@ public:
      */
     const char* getComponentName() const { return component_name_; }
 
+    /**
+     * @brief ログレベル設定
+     * 
+     * ログ出力前の判定はこの値との比較のみで行う（タグ検索なし）
+     * @param level ログレベル
+     */
+    void setLogLevel(esp_log_level_t level);
+    
+    /**
+     * @brief ログレベル取得
+     * @return esp_log_level_t 現在のログレベル
+     */
+    esp_log_level_t getLogLevel() const { return log_level_; }
+    
+    /**
+     * @brief トレース計測の有効/無効設定
+     * @param enabled 有効にする場合true
+     */
+    void setTraceEnabled(bool enabled) { trace_enabled_ = enabled; }
+    
+    /**
+     * @brief トレース計測の有効確認
+     * @return bool 有効な場合true
+     */
+    bool isTraceEnabled() const { return trace_enabled_; }
+    
+    /**
+     * @brief トレース統計取得
+     * @param index トレースポイント番号
+     * @param stats 統計格納先
+     * @return esp_err_t エラーコード（未登録の場合ESP_ERR_NOT_FOUND）
+     */
+    esp_err_t getTraceStats(size_t index, TraceStats& stats) const;
+    
+    /**
+     * @brief トレース統計リセット
+     */
+    void resetTrace();
+    
+    /**
+     * @brief トレース統計のログ出力
+     */
+    void dumpTrace() const;
+    
+    /**
+     * @brief 全インスタンスのトレース計測の有効/無効設定
+     * @param enabled 有効にする場合true
+     */
+    static void setAllTraceEnabled(bool enabled);
+    
+    /**
+     * @brief 全インスタンスのトレース統計のログ出力
+     */
+    static void dumpAllTraces();
+    
+    /**
+     * @brief 登録インスタンス数取得
+     * @return size_t インスタンス数
+     */
+    static size_t getInstanceCount();
+    
+    /**
+     * @brief 登録インスタンス取得（CLI・テレメトリからの列挙用）
+     * 
+     * 0〜MAX_INSTANCES-1のスロットを順に参照する。空きスロットはnullptr
+     * @param index スロット番号
+     * @return HalBase* インスタンス（空き・範囲外の場合nullptr）
+     */
+    static HalBase* getInstance(size_t index);
+    
 protected:
     /**
      * @brief 状態変更
@@ -144,38 +250,148 @@ protected:
      */
     void setState(State new_state);
 
+    /**
+     * @brief ログ出力が有効か判定
+     * 
+     * CONFIG_LOG_MAXIMUM_LEVEL未満のレベルはコンパイル時に除去され、
+     * それ以外は実行時レベルとの比較のみでフォーマット前に判定する
+     * @tparam LEVEL ログレベル
+     * @return bool 出力する場合true
+     */
+    template<esp_log_level_t LEVEL>
+    bool isLogEnabled() const {
+        if constexpr (LEVEL > LOG_LOCAL_LEVEL) {
+            return false;
+        } else {
+            return log_level_ >= LEVEL;
+        }
+    }
+    
     /**
      * @brief エラーログ出力
      * @param format フォーマット文字列
-     * @param ... 可変引数
+     * @param args 可変引数
      */
-    void logError(const char* format, ...);
+    template<typename... Args>
+    void logError(const char* format, Args... args) const {
+        if (isLogEnabled<ESP_LOG_ERROR>()) {
+            logWrite(ESP_LOG_ERROR, format, args...);
+        }
+    }
 
     /**
      * @brief 警告ログ出力
      * @param format フォーマット文字列
-     * @param ... 可変引数
+     * @param args 可変引数
      */
-    void logWarning(const char* format, ...);
+    template<typename... Args>
+    void logWarning(const char* format, Args... args) const {
+        if (isLogEnabled<ESP_LOG_WARN>()) {
+            logWrite(ESP_LOG_WARN, format, args...);
+        }
+    }
 
     /**
      * @brief 情報ログ出力
      * @param format フォーマット文字列
-     * @param ... 可変引数
+     * @param args 可変引数
      */
-    void logInfo(const char* format, ...);
+    template<typename... Args>
+    void logInfo(const char* format, Args... args) const {
+        if (isLogEnabled<ESP_LOG_INFO>()) {
+            logWrite(ESP_LOG_INFO, format, args...);
+        }
+    }
 
     /**
      * @brief デバッグログ出力
      * @param format フォーマット文字列
+     * @param args 可変引数
+     */
+    template<typename... Args>
+    void logDebug(const char* format, Args... args) const {
+        if (isLogEnabled<ESP_LOG_DEBUG>()) {
+            logWrite(ESP_LOG_DEBUG, format, args...);
+        }
+    }
+    
+    /**
+     * @brief 遅延ログ出力（ホットパス・ISR用）
+     * 
+     * フォーマットは行わずDeferredLogのリングへ記録する。
+     * formatは文字列リテラルであること（引数の制約はDeferredLog参照）
+     * @tparam LEVEL ログレベル
+     * @param format フォーマット文字列
+     * @param args 可変引数（最大4個）
+     */
+    template<esp_log_level_t LEVEL, typename... Args>
+    void logDeferred(const char* format, Args... args) const {
+        if (isLogEnabled<LEVEL>()) {
+            DeferredLog::log(LEVEL, component_name_, format, args...);
+        }
+    }
+    
+    /**
+     * @brief フォーマットしてログ出力（レベル判定済みの呼び出し用）
+     * @param level ログレベル
+     * @param format フォーマット文字列
      * @param ... 可変引数
      */
-    void logDebug(const char* format, ...);
+    void logWrite(esp_log_level_t level, const char* format, ...) const;
 
+    /**
+     * @brief トレースポイント登録（派生クラスのコンストラクタで呼び出す）
+     * @param index トレースポイント番号（MAX_TRACE_POINTS未満）
+     * @param name トレースポイント名（静的文字列）
+     */
+    void registerTracePoint(size_t index, const char* name);
+    
+    /**
+     * @brief トレース計測開始
+     * @return uint32_t 開始サイクル数（無効時は0）
+     */
+    uint32_t traceBegin() const {
+#if HAL_TRACE_ENABLED
+        return trace_enabled_ ? static_cast<uint32_t>(esp_cpu_get_cycle_count()) : 0;
+#else
+        return 0;
+#endif
+    }
+    
+    /**
+     * @brief トレース計測終了
+     * @param index トレースポイント番号
+     * @param start_cycles traceBegin()の戻り値
+     * @param result 処理結果（ESP_OK以外はエラーとして計数）
+     */
+    void traceEnd(size_t index, uint32_t start_cycles, esp_err_t result) {
+#if HAL_TRACE_ENABLED
+        if (trace_enabled_ && start_cycles != 0) {
+            recordTrace(index, static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles, result);
+        }
+#endif
+    }
+    
 private:
     const char* component_name_;    // コンポーネント名
     State state_;                   // 現在の状態
     Priority priority_;             // 優先度
+    esp_log_level_t log_level_;     // ログレベル（実行時判定用キャッシュ）
+    
+    /**
+     * @brief トレース記録
+     * @param index トレースポイント番号
+     * @param cycles 所要サイクル数
+     * @param result 処理結果
+     */
+    void recordTrace(size_t index, uint32_t cycles, esp_err_t result);
+    
+    bool trace_enabled_;                            // トレース計測有効フラグ
+    TraceStats trace_stats_[MAX_TRACE_POINTS];      // トレース統計
+    mutable portMUX_TYPE trace_lock_;               // トレース統計保護
+    
+    static HalBase* instances_[MAX_INSTANCES];      // トレース一覧用インスタンス登録
+    static portMUX_TYPE instances_lock_;            // インスタンス登録保護
     
     // コピー禁止
     HalBase(const HalBase&) = delete;
@@ -14,11 +14,30 @@
 #define I2C_HAL_HPP
 
 #include "hal_base.hpp"
-#include "driver/i2c.h"
+#include "freertos/FreeRTOS.h"
 #include <vector>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <mutex>
 
+/*
+ * I2Cドライババックエンド選択
+ * 1: ESP-IDF 5.x i2c_master バス/デバイスドライバ（非同期転送対応）
+ * 0: レガシー driver/i2c.h コマンドリンクAPI
+ * 両ドライバは同一ファームウェア内に共存できないため、ビルド時に選択する
+ * （components/hal/CMakeLists.txt の HAL_I2C_MASTER_DRIVER オプション）
+ */
+#ifndef HAL_I2C_USE_MASTER_DRIVER
+#define HAL_I2C_USE_MASTER_DRIVER 1
+#endif
+
+#if HAL_I2C_USE_MASTER_DRIVER
+#include "driver/i2c_master.h"
+#else
+#include "driver/i2c.h"
+#endif
+
 namespace hal {
 
 /**
@@ -49,7 +68,23 @@ public:
         bool sda_pullup_enable;     // SDAプルアップ有効
         bool scl_pullup_enable;     // SCLプルアップ有効
         uint8_t slave_address;      // スレーブアドレス（スレーブモード時のみ）
+        bool use_static_cmd_link;   // 静的コマンドリンクバッファ使用（レガシードライバのみ）
+        size_t async_queue_depth;   // 非同期転送キュー深さ（i2c_masterドライバのみ、既定0で非同期無効。1以上でバス全体の転送が非同期になる）
     };
+    
+    /**
+     * @brief 非同期転送完了コールバック関数型
+     * 
+     * i2c_masterドライバ使用時はISRコンテキストから呼び出されるため、IRAM配置とし
+     * ブロッキングAPIを呼ばないこと
+     * @param result 転送結果（ESP_OK / ESP_FAIL:NACK / ESP_ERR_TIMEOUT）
+     * @param user_arg 登録時のユーザー引数
+     * @return bool 高優先度タスクを起床させた場合true（ポートyield要求）
+     */
+    using AsyncCallback = bool (*)(esp_err_t result, void* user_arg);
+    
+    static constexpr size_t MAX_ASYNC_DEVICES = 4;          // 非同期転送を同時に使用できるデバイス数
+    static constexpr size_t MAX_REGISTER_WRITE_SIZE = 32;   // i2c_masterドライバでのレジスタ書き込み最大長
 
     /**
      * @brief I2Cトランザクション構造体
@@ -60,6 +95,19 @@ public:
         std::vector<uint8_t> data;  // データ
         bool use_register_address;  // レジスタアドレス使用フラグ
         TickType_t timeout;         // タイムアウト時間
+        bool is_read;               // 読み取りフラグ（読み取り時は data を読み取りサイズに確保しておく）
+        esp_err_t result;           // 実行結果（バッチ実行後に設定）
+    };
+
+    static constexpr size_t MAX_BATCH_TRANSACTIONS = 8;     // レガシードライバで1コマンドリンクに連結する最大トランザクション数
+    
+    /**
+     * @brief トレースポイント番号（HalBase::getTraceStats()の引数）
+     */
+    enum TracePoint : size_t {
+        TRACE_WRITE = 0,    // 書き込み（レジスタ書き込み含む）
+        TRACE_READ,         // 読み取り（レジスタ読み取り含む）
+        TRACE_BATCH         // バッチ実行（レガシードライバの連結コマンド）
     };
 
 public:
@@ -157,6 +205,89 @@ public:
                           std::vector<uint8_t>& data, size_t length, 
                           TickType_t timeout = pdMS_TO_TICKS(1000));
 
+    /**
+     * @brief データ書き込み（呼び出し側バッファ）
+     * @param device_address デバイスアドレス
+     * @param data 書き込みデータ
+     * @param length 書き込みデータ長
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 書き込み結果
+     * 
+     * ヒープ確保を行わない。制御ループ内での使用を想定
+     */
+    esp_err_t write(uint8_t device_address, const uint8_t* data, size_t length, 
+                    TickType_t timeout = pdMS_TO_TICKS(1000));
+
+    /**
+     * @brief データ読み取り（呼び出し側バッファ）
+     * @param device_address デバイスアドレス
+     * @param data 読み取りデータ格納先（length バイト以上）
+     * @param length 読み取りデータ長
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 読み取り結果
+     */
+    esp_err_t read(uint8_t device_address, uint8_t* data, size_t length, 
+                   TickType_t timeout = pdMS_TO_TICKS(1000));
+
+    /**
+     * @brief レジスタ書き込み（呼び出し側バッファ）
+     * @param device_address デバイスアドレス
+     * @param register_address レジスタアドレス
+     * @param data 書き込みデータ（length が0の場合はnullptr可）
+     * @param length 書き込みデータ長
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 書き込み結果
+     */
+    esp_err_t writeRegister(uint8_t device_address, uint8_t register_address, 
+                           const uint8_t* data, size_t length, 
+                           TickType_t timeout = pdMS_TO_TICKS(1000));
+
+    /**
+     * @brief レジスタ読み取り（呼び出し側バッファ）
+     * @param device_address デバイスアドレス
+     * @param register_address レジスタアドレス
+     * @param data 読み取りデータ格納先（length バイト以上）
+     * @param length 読み取りデータ長
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 読み取り結果
+     */
+    esp_err_t readRegister(uint8_t device_address, uint8_t register_address, 
+                          uint8_t* data, size_t length, 
+                          TickType_t timeout = pdMS_TO_TICKS(1000));
+
+    /**
+     * @brief レジスタ書き込み（固定長配列）
+     * @tparam N データ長
+     * @param device_address デバイスアドレス
+     * @param register_address レジスタアドレス
+     * @param data 書き込みデータ
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 書き込み結果
+     */
+    template<size_t N>
+    esp_err_t writeRegister(uint8_t device_address, uint8_t register_address, 
+                           const std::array<uint8_t, N>& data, 
+                           TickType_t timeout = pdMS_TO_TICKS(1000)) {
+        return writeRegister(device_address, register_address, data.data(), N, timeout);
+    }
+
+    /**
+     * @brief レジスタ読み取り（固定長配列）
+     * @tparam N 読み取りデータ長
+     * @param device_address デバイスアドレス
+     * @param register_address レジスタアドレス
+     * @param data 読み取りデータ格納先
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 読み取り結果
+     */
+    template<size_t N>
+    esp_err_t readRegister(uint8_t device_address, uint8_t register_address, 
+                          std::array<uint8_t, N>& data, 
+                          TickType_t timeout = pdMS_TO_TICKS(1000)) {
+        static_assert(N > 0, "読み取りサイズは1以上");
+        return readRegister(device_address, register_address, data.data(), N, timeout);
+    }
+
     /**
      * @brief 8bit値書き込み
      * @param device_address デバイスアドレス
@@ -220,6 +351,74 @@ public:
      */
     esp_err_t scanBus(std::vector<uint8_t>& found_devices);
 
+    /**
+     * @brief デバイス事前登録
+     * @param device_address デバイスアドレス
+     * @param scl_speed_hz デバイス毎のSCL周波数（0でバス周波数）
+     * @return esp_err_t 登録結果
+     * 
+     * i2c_masterドライバではデバイスハンドルを初回アクセス時に作成するため、
+     * 初期化時に呼び出してハンドル作成を制御ループ外に移すこと。
+     * レガシードライバでは何もしない
+     */
+    esp_err_t addDevice(uint8_t device_address, uint32_t scl_speed_hz = 0);
+    
+    /**
+     * @brief 非同期レジスタ読み取り
+     * @param device_address デバイスアドレス
+     * @param register_address レジスタアドレス
+     * @param data 読み取りデータ格納先（完了コールバックまで有効であること）
+     * @param length 読み取りデータ長
+     * @param callback 完了コールバック（nullptr可）
+     * @param user_arg コールバック引数
+     * @return esp_err_t 転送開始結果（ESP_ERR_INVALID_STATE: 同一デバイスの転送が未完了）
+     * 
+     * 転送をキューに投入して即座に戻る。完了はコールバックまたは isAsyncBusy() で確認する。
+     * レガシードライバ・async_queue_depth = 0 では同期読み取りを行い、戻る前にコールバックを呼び出す
+     */
+    esp_err_t readRegisterAsync(uint8_t device_address, uint8_t register_address, 
+                                uint8_t* data, size_t length, 
+                                AsyncCallback callback, void* user_arg = nullptr);
+    
+    /**
+     * @brief 非同期転送実行中確認
+     * @param device_address デバイスアドレス
+     * @return bool 転送が未完了の場合true
+     */
+    bool isAsyncBusy(uint8_t device_address) const;
+    
+    /**
+     * @brief 全非同期転送の完了待ち
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 待機結果
+     */
+    esp_err_t waitAllDone(TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief トランザクション一括実行
+     * @param transactions トランザクション配列（各要素の result に実行結果を設定）
+     * @param count トランザクション数
+     * @return esp_err_t 全て成功した場合ESP_OK、それ以外は最初に失敗したトランザクションの結果
+     * 
+     * レガシードライバでは MAX_BATCH_TRANSACTIONS 件ずつリピートスタートで1コマンドリンクに連結し、
+     * ロック1回で実行する。連結した転送がバス上で失敗した場合はどこまで完了したか分からないため、
+     * 再実行せずにその連結の全要素を失敗とする（書き込みの重複・読み取りクリアのレジスタの読み直しを避ける）。
+     * コマンドリンクの構築に失敗した場合のみ個別実行する。
+     * i2c_masterドライバは公開APIでバスを保持できないため、要素毎の個別転送を順に行うだけで、
+     * 要素間のリピートスタート連結・バスの連続保持はない（間に他タスクの転送が入り得る）。
+     * 失敗した要素の後も続けて実行し、要素毎の結果を設定する
+     */
+    esp_err_t executeBatch(Transaction* transactions, size_t count);
+
+    /**
+     * @brief トランザクション一括実行（vector版）
+     * @param transactions トランザクション列
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t executeBatch(std::vector<Transaction>& transactions) {
+        return executeBatch(transactions.data(), transactions.size());
+    }
+    
     /**
      * @brief I2Cポート番号取得
      * @return i2c_port_t I2Cポート番号
@@ -227,17 +426,135 @@ public:
     i2c_port_t getPort() const { return config_.port; }
 
 private:
+#if HAL_I2C_USE_MASTER_DRIVER
+    static constexpr size_t MAX_DEVICE_ADDRESS = 128;   // 7bitアドレス空間
+    
+    /**
+     * @brief 非同期転送スロット
+     * 
+     * 完了コールバックを登録するため、同期転送とは別の専用ハンドルを持つ。
+     * trans_queue_depth が1以上のバスでは同期用ハンドルの転送もキュー投入で即座に戻るため、
+     * 同期APIは waitSyncDone() でバス上の全転送の完了を待ってから戻る（スタック上のバッファを渡したまま戻らない）
+     */
+    struct AsyncSlot {
+        I2cHal* owner;                      // 所有インスタンス
+        i2c_master_dev_handle_t handle;     // 非同期専用デバイスハンドル
+        uint8_t device_address;             // デバイスアドレス
+        uint8_t register_address;           // 送信レジスタアドレス（転送完了まで保持）
+        AsyncCallback callback;             // 完了コールバック
+        void* user_arg;                     // コールバック引数
+        std::atomic<bool> assigned;         // デバイス割当済みフラグ（割当後は不変）
+        std::atomic<bool> busy;             // 転送実行中フラグ
+    };
+    
+    Config config_;                 // I2C設定
+    std::mutex mutex_;              // スレッドセーフ用ミューテックス（ハンドル作成時のみ）
+    bool driver_installed_;         // バス作成状態
+    i2c_master_bus_handle_t bus_handle_;    // I2Cバスハンドル
+    std::atomic<i2c_master_dev_handle_t> device_handles_[MAX_DEVICE_ADDRESS];  // 同期転送用デバイスハンドル
+    AsyncSlot async_slots_[MAX_ASYNC_DEVICES];  // 非同期転送スロット
+    
+    /**
+     * @brief 同期転送用デバイスハンドル取得（未登録なら作成）
+     * @param device_address デバイスアドレス
+     * @param scl_speed_hz SCL周波数（0でバス周波数）
+     * @return i2c_master_dev_handle_t デバイスハンドル（失敗時nullptr）
+     */
+    i2c_master_dev_handle_t getDeviceHandle(uint8_t device_address, uint32_t scl_speed_hz = 0);
+    
+    /**
+     * @brief 非同期転送スロット取得（未割当なら割当）
+     * @param device_address デバイスアドレス
+     * @return AsyncSlot* スロット（空きなし時nullptr）
+     */
+    AsyncSlot* getAsyncSlot(uint8_t device_address);
+    
+    /**
+     * @brief 同期APIの完了待ち（非同期キュー有効時のみ、バス上の全転送の完了を待つ）
+     * 
+     * 非同期キュー有効時はNACKが転送の戻り値に現れず、完了待ちのタイムアウトのみ検出できる
+     * @param ret 転送APIの戻り値
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 転送結果
+     */
+    esp_err_t waitSyncDone(esp_err_t ret, TickType_t timeout);
+    
+    /**
+     * @brief バスと全デバイスハンドルの解放
+     */
+    void releaseBus();
+    
+    /**
+     * @brief タイムアウトをi2c_masterドライバ形式（ms、-1で無限）に変換
+     * @param timeout タイムアウト時間
+     * @return int タイムアウト（ms）
+     */
+    static int toTimeoutMs(TickType_t timeout);
+    
+    /**
+     * @brief 非同期転送完了ISRハンドラ
+     */
+    static bool asyncDoneHandler(i2c_master_dev_handle_t dev, 
+                                 const i2c_master_event_data_t* edata, void* user_data);
+#else
+    /**
+     * @brief 静的コマンドリンクバッファサイズ
+     * 
+     * readRegister（書き込み + リピートスタート読み取り）の2フェーズに余裕を持たせたサイズ
+     */
+    static constexpr size_t CMD_LINK_BUFFER_SIZE = I2C_LINK_RECOMMENDED_SIZE(3);
+
+    /**
+     * @brief バッチ用静的コマンドリンクバッファサイズ
+     * 
+     * レジスタ読み取り（2フェーズ）を MAX_BATCH_TRANSACTIONS 件連結できるサイズ
+     */
+    static constexpr size_t BATCH_CMD_LINK_BUFFER_SIZE = I2C_LINK_RECOMMENDED_SIZE(2 * MAX_BATCH_TRANSACTIONS);
+
     Config config_;                 // I2C設定
     std::mutex mutex_;              // スレッドセーフ用ミューテックス
     bool driver_installed_;         // ドライバインストール状態
+    alignas(4) uint8_t cmd_link_buffer_[CMD_LINK_BUFFER_SIZE];  // 静的コマンドリンクバッファ（mutex_で保護）
+    alignas(4) uint8_t batch_cmd_link_buffer_[BATCH_CMD_LINK_BUFFER_SIZE];  // バッチ用静的コマンドリンクバッファ（mutex_で保護）
 
     /**
-     * @brief トランザクション実行
+     * @brief コマンドリンク作成
+     * 
+     * 静的モード時はインスタンス所有バッファ上に作成し、ヒープを使用しない。
+     * mutex_ 取得中に呼び出すこと
+     * @param batch バッチ用バッファを使用する場合true
+     * @return i2c_cmd_handle_t コマンドリンク（失敗時nullptr）
+     */
+    i2c_cmd_handle_t createCommandLink(bool batch = false);
+
+    /**
+     * @brief コマンドリンク削除
+     * @param cmd createCommandLink() で作成したコマンドリンク
+     */
+    void deleteCommandLink(i2c_cmd_handle_t cmd);
+
+    /**
+     * @brief コマンドリンクへトランザクション追加
+     * 
+     * 開始コンディションから追加し、ストップコンディションは追加しない。
+     * 連結時の2件目以降の開始コンディションはリピートスタートとなる
+     * @param cmd コマンドリンク
      * @param transaction トランザクション情報
      * @param is_read 読み取りトランザクションの場合true
+     * @return esp_err_t 追加結果
+     */
+    esp_err_t appendTransaction(i2c_cmd_handle_t cmd, Transaction& transaction, bool is_read);
+#endif
+
+    /**
+     * @brief トランザクション実行
+     * 
+     * レガシードライバでは mutex_ 取得中に呼び出すこと
+     * @param transaction トランザクション情報（読み取り時は data に結果を格納）
+     * @param is_read 読み取りトランザクションの場合true
      * @return esp_err_t 実行結果
      */
-    esp_err_t executeTransaction(const Transaction& transaction, bool is_read);
+    esp_err_t executeTransaction(Transaction& transaction, bool is_read);
 };
 
 } // namespace hal
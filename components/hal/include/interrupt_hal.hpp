@@ -14,9 +14,11 @@
 #define INTERRUPT_HAL_HPP
 
 #include "hal_base.hpp"
+#include "delegate.hpp"
+#include "esp_attr.h"
 #include "esp_intr_alloc.h"
 #include "esp_timer.h"
-#include <functional>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -31,6 +33,15 @@ namespace hal {
  */
 class InterruptHal : public HalBase {
 public:
+    static constexpr size_t MAX_SOURCES = 16;                   // 統計を保持できるタイマー・割り込みの合計数
+    /**
+     * @brief 遅延ヒストグラムのビン数
+     * 
+     * ビンの上限は 1, 2, 5, 10, 20, 50, 100, 200, 500μs（ビン0は1μs未満、最終ビンは500μs以上）。
+     * 上限表はIRAMの割り込み経路から読むため、.cpp側でDRAM_ATTRのサイクル数として持つ
+     */
+    static constexpr size_t LATENCY_HISTOGRAM_BUCKETS = 10;
+    
     /**
      * @brief 割り込み優先度列挙型
      */
@@ -62,7 +73,7 @@ public:
         uint64_t period_us;         // 周期（マイクロ秒）
         bool auto_reload;           // 自動リロード
         Priority priority;          // 割り込み優先度
-        bool run_in_isr;           // ISR内で実行
+        bool run_in_isr;           // ISR内で実行（ESP_TIMER_ISRディスパッチ）
     };
 
     /**
@@ -72,26 +83,47 @@ public:
         int source;                 // 割り込みソース番号
         Priority priority;          // 優先度
         uint32_t flags;            // フラグ
+        uint32_t budget_us;         // ハンドラ実行時間の上限（超過で超過回数に計上、0で判定なし）
     };
 
     /**
      * @brief 割り込みハンドラ関数型
+     * 
+     * ヒープ確保なしの固定サイズデリゲート（呼び出しサンクはIRAM配置）
      */
-    using InterruptHandler = std::function<void(void)>;
+    using InterruptHandler = common::Delegate<void(void)>;
     
     /**
      * @brief タイマーコールバック関数型
+     * 
+     * run_in_isr指定時はISRから呼ばれるため、処理本体もIRAM配置であること
+     */
+    using TimerCallback = common::Delegate<void(void)>;
+    
+    /**
+     * @brief ISRタイマーコールバック関数型（IRAM配置の関数であること）
      */
-    using TimerCallback = std::function<void(void)>;
+    using IsrTimerCallback = void (*)(void* context);
 
     /**
      * @brief 割り込み統計情報構造体
+     * 
+     * 遅延はタイマーでは予定発火時刻からコールバック入口まで（esp_timer基準、1μs分解能）、
+     * 割り込みではmarkInterruptTrigger()からハンドラ入口まで（CPUサイクル精度）
      */
     struct Statistics {
         uint64_t total_count;       // 総割り込み回数
-        uint64_t missed_count;      // 取りこぼし回数
+        uint64_t missed_count;      // 取りこぼし回数（次周期の予定時刻を過ぎてから入った回数）
         uint64_t max_latency_us;    // 最大遅延時間
         uint64_t avg_latency_us;    // 平均遅延時間
+        uint64_t overrun_count;     // 実行時間超過回数（タイマーは周期、割り込みはbudget_us）
+        uint64_t latency_samples;   // 遅延計測回数
+        uint32_t min_latency_cycles;    // 最小遅延サイクル
+        uint32_t max_latency_cycles;    // 最大遅延サイクル
+        uint32_t avg_latency_cycles;    // 平均遅延サイクル
+        uint32_t max_exec_cycles;       // 最大ハンドラ実行サイクル
+        uint32_t avg_exec_cycles;       // 平均ハンドラ実行サイクル
+        uint32_t histogram[LATENCY_HISTOGRAM_BUCKETS];  // 遅延ヒストグラム
     };
 
 public:
@@ -140,9 +172,24 @@ public:
      * @param timer_id タイマーID
      * @param config タイマー設定
      * @param callback コールバック関数
-     * @return esp_err_t 作成結果
+     * @return esp_err_t 作成結果（ISRディスパッチ非対応の設定の場合ESP_ERR_NOT_SUPPORTED）
      */
     esp_err_t createHighResTimer(uint32_t timer_id, const TimerConfig& config, TimerCallback callback);
+    
+    /**
+     * @brief 高精度タイマー作成（関数ポインタコールバック）
+     * 
+     * コンテキスト付き関数ポインタをデリゲートへ包んで登録する。
+     * config.run_in_isrがtrueの場合はESP_TIMER_ISRディスパッチとなり、
+     * esp_timerタスクを経由せずタイマー割り込みから直接呼び出される
+     * @param timer_id タイマーID
+     * @param config タイマー設定
+     * @param callback コールバック関数
+     * @param context コールバックに渡すコンテキスト
+     * @return esp_err_t 作成結果（ISRディスパッチ非対応の設定の場合ESP_ERR_NOT_SUPPORTED）
+     */
+    esp_err_t createHighResTimer(uint32_t timer_id, const TimerConfig& config,  
+                                 IsrTimerCallback callback, void* context);
 
     /**
      * @brief タイマー開始
@@ -216,7 +263,7 @@ public:
     void restoreInterrupts(uint32_t state);
 
     /**
-     * @brief 割り込み優先度設定
+     * @brief 割り込み優先度設定（解放・再確保するため起動時に呼ぶ）
      * @param interrupt_id 割り込みID
      * @param priority 新しい優先度
      * @return esp_err_t 設定結果
@@ -224,27 +271,45 @@ public:
     esp_err_t setPriority(uint32_t interrupt_id, Priority priority);
 
     /**
-     * @brief CPU親和性設定
+     * @brief CPU親和性設定（対象コアで解放・再確保するため起動時に呼ぶ）
      * @param interrupt_id 割り込みID
-     * @param cpu_mask CPUマスク（ビット0: CPU0, ビット1: CPU1）
-     * @return esp_err_t 設定結果
+     * @param cpu_mask CPUマスク（ビット0: CPU0, ビット1: CPU1、1ビットのみ）
+     * @return esp_err_t 設定結果（複数コア指定時ESP_ERR_INVALID_ARG）
      */
     esp_err_t setCpuAffinity(uint32_t interrupt_id, uint32_t cpu_mask);
 
     /**
      * @brief 統計情報取得
+     * 
+     * mutex_を取らずに読み出すため、制御タスクやISR計測中でも呼び出せる
      * @param interrupt_id 割り込みID
      * @param stats 統計情報格納先
-     * @return esp_err_t 取得結果
+     * @return esp_err_t 取得結果（更新と競合し続けた場合ESP_ERR_INVALID_STATE）
      */
-    esp_err_t getStatistics(uint32_t interrupt_id, Statistics& stats);
+    esp_err_t getStatistics(uint32_t interrupt_id, Statistics& stats) const;
 
     /**
      * @brief 統計情報リセット
+     * 
+     * 統計はハンドラ側のみが更新するため、リセットは次回のハンドラ入口で反映される
      * @param interrupt_id 割り込みID
      * @return esp_err_t リセット結果
      */
     esp_err_t resetStatistics(uint32_t interrupt_id);
+    
+    /**
+     * @brief 割り込み発生要因の時刻記録（遅延計測用）
+     * 
+     * ソフトウェア割り込みの発行時やペリフェラルの発火時刻が既知の場合に呼び出すと、
+     * 次のハンドラ入口までのサイクル数を遅延として計上する（同一コアの場合のみ）
+     * @param interrupt_id 割り込みID
+     */
+    void IRAM_ATTR markInterruptTrigger(uint32_t interrupt_id);
+    
+    /**
+     * @brief 全タイマー・割り込みの統計をログ出力
+     */
+    void dumpStatistics() const;
 
     /**
      * @brief 現在のCPU取得
@@ -271,6 +336,37 @@ public:
     void exitCriticalSection(portMUX_TYPE* mux);
 
 private:
+    /**
+     * @brief 遅延計測スロット
+     * 
+     * 統計はハンドラ（単一の書き込み側）のみが更新し、sequenceによるシーケンスロックで
+     * 読み出し側は待ちなしで一貫したコピーを得る
+     */
+    struct LatencySlot {
+        std::atomic<uint32_t> sequence;         // 版数（奇数=更新中）
+        std::atomic<bool> in_use;               // 使用中フラグ
+        std::atomic<bool> reset_requested;      // リセット要求（次回のハンドラ入口で反映）
+        std::atomic<uint32_t> probe_cycles;     // markInterruptTrigger()の記録サイクル（0=未記録）
+        std::atomic<int> probe_core;            // 記録したコア
+        uint32_t id;                            // タイマー・割り込みID
+        bool is_timer;                          // タイマーの場合true
+        uint64_t period_us;                     // タイマー周期
+        int64_t next_expected_us;               // 次の予定発火時刻（タイマー停止中に設定）
+        uint32_t budget_cycles;                 // 割り込みハンドラ実行時間の上限
+        
+        // 以下はsequenceで保護
+        uint32_t total_count;
+        uint32_t missed_count;
+        uint32_t overrun_count;
+        uint32_t latency_samples;
+        uint32_t min_latency_cycles;
+        uint32_t max_latency_cycles;
+        uint64_t total_latency_cycles;
+        uint32_t max_exec_cycles;
+        uint64_t total_exec_cycles;
+        uint32_t histogram[LATENCY_HISTOGRAM_BUCKETS];
+    };
+    
     /**
      * @brief タイマー情報構造体
      */
@@ -278,7 +374,7 @@ private:
         esp_timer_handle_t handle;
         TimerConfig config;
         TimerCallback callback;
-        Statistics stats;
+        LatencySlot* latency;       // 遅延計測スロット
     };
 
     /**
@@ -288,23 +384,63 @@ private:
         intr_handle_t handle;
         SourceConfig config;
         InterruptHandler handler;
-        Statistics stats;
+        LatencySlot* latency;       // 遅延計測スロット
     };
 
     std::mutex mutex_;                              // スレッドセーフ用ミューテックス
-    std::map<uint32_t, TimerInfo> timers_;        // タイマー管理
-    std::map<uint32_t, InterruptInfo> interrupts_; // 割り込み管理
+    std::map<uint32_t, TimerInfo> timers_;        // タイマー管理（ノードのアドレスをコールバック引数に使用）
+    std::map<uint32_t, InterruptInfo> interrupts_; // 割り込み管理（同上）
     portMUX_TYPE critical_mux_;                    // クリティカルセクション用
+    LatencySlot latency_slots_[MAX_SOURCES];        // 遅延計測スロット
+    
+    /**
+     * @brief 遅延計測スロット確保（mutex_保持中に呼び出す）
+     * @param id タイマー・割り込みID
+     * @param is_timer タイマーの場合true
+     * @return LatencySlot* スロット（空きなしの場合nullptr）
+     */
+    LatencySlot* acquireLatencySlot(uint32_t id, bool is_timer);
+    
+    /**
+     * @brief 遅延計測スロット解放
+     * @param slot スロット
+     */
+    void releaseLatencySlot(LatencySlot* slot);
+    
+    /**
+     * @brief 遅延計測スロット検索（ロックなし）
+     * @param id タイマー・割り込みID
+     * @return LatencySlot* スロット（見つからない場合nullptr）
+     */
+    LatencySlot* findLatencySlot(uint32_t id) const;
+    
+    /**
+     * @brief 遅延計測の記録（ハンドラ出口で呼び出す）
+     * @param slot スロット
+     * @param latency_cycles 遅延サイクル（計測なしはUINT32_MAX）
+     * @param exec_cycles ハンドラ実行サイクル
+     * @param missed 取りこぼし判定
+     * @param overrun 実行時間超過判定
+     */
+    static void IRAM_ATTR recordLatency(LatencySlot* slot, uint32_t latency_cycles, uint32_t exec_cycles,  
+                                        bool missed, bool overrun);
+    
+    /**
+     * @brief スロットのタイマー予定時刻設定（タイマー停止中に呼び出す）
+     * @param info タイマー情報
+     * @param period_us 周期
+     */
+    static void armTimerLatency(TimerInfo& info, uint64_t period_us);
     
     /**
      * @brief ESPタイマーコールバック
-     * @param arg 引数（タイマーID）
+     * @param arg 引数（TimerInfoのポインタ）
      */
-    static void espTimerCallback(void* arg);
+    static void IRAM_ATTR espTimerCallback(void* arg);
     
     /**
      * @brief 割り込みハンドララッパー
-     * @param arg 引数（割り込みID）
+     * @param arg 引数（InterruptInfoのポインタ）
      */
     static void IRAM_ATTR interruptHandlerWrapper(void* arg);
 };
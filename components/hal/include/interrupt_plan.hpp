@@ -0,0 +1,161 @@
+/*
+ * Interrupt Plan
+ * 
+ * HAL割り込みのコア・レベル・IRAMフラグの配置表
+ * 割り込みは確保したコアに固定されるため、各ドライバの確保処理を表のコアで1回だけ実行し、結果を一覧で報告する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef INTERRUPT_PLAN_HPP
+#define INTERRUPT_PLAN_HPP
+
+#include "delegate.hpp"
+#include "esp_err.h"
+#include "esp_intr_alloc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace hal {
+
+/**
+ * @brief 割り込み配置クラス（全体で1つ）
+ * 
+ * ESP-IDFのドライバは esp_intr_alloc を呼んだタスクのコアへ割り込みを確保する
+ * （SPI: spi_bus_initialize、I2C: i2c_new_master_bus、GPIO: gpio_install_isr_service、
+ * UART: uart_driver_install、GPTimer・MCPWM: コールバック登録、Wi-Fi: esp_wifi_init）。
+ * 各HALは確保処理を install() に渡し、表のコアで実行させる（別のコアなら一時タスクで実行する）。
+ * レベル・IRAMフラグは flags()（intr_alloc_flags形式）・priority()（intr_priority形式）で表から取る。
+ * 
+ * 制御ループのコア（既定はコア1）には制御ティックだけを置き、無線・UART・I2C・GPIOはコア0へ集める。
+ * 起動後に checkIsolation() で制御コアに他の割り込みがないことを確かめ、dump() で一覧を出す
+ */
+class InterruptPlan {
+public:
+    /**
+     * @brief 割り込み源列挙型
+     */
+    enum class Source : uint8_t {
+        SPI_BUS = 0,        // SPIバス（IMU、DMA完了）
+        I2C_BUS,            // I2Cバス（気圧・地磁気・ToF）
+        GPIO,               // GPIO割り込みサービス
+        UART,               // UART（CLI・外部機器）
+        CONTROL_TIMER,      // 制御ティックのGPTimerアラーム・MCPWMキャプチャ
+        RADIO,              // Wi-Fi・ESP-NOW
+        COUNT
+    };
+    
+    /**
+     * @brief 表の1行
+     */
+    struct Entry {
+        const char* name;           // 名前
+        BaseType_t core;            // 確保するコア
+        int level;                  // 割り込みレベル（1〜3、0でドライバ既定）
+        bool iram;                  // ハンドラをIRAMに置く（フラッシュ操作中も動作）
+        bool realtime;              // 制御コアに置いてよい
+    };
+    
+    /**
+     * @brief 配置表（Sourceの順）
+     */
+    static constexpr Entry TABLE[] = {
+        {"spi",           0, 2, true,  false},
+        {"i2c",           0, 1, false, false},
+        {"gpio",          0, 1, true,  false},
+        {"uart",          0, 1, false, false},
+        {"control_timer", 1, 3, true,  true},
+        {"radio",         0, 0, false, false},
+    };
+    static_assert(sizeof(TABLE) / sizeof(TABLE[0]) == static_cast<size_t>(Source::COUNT), "配置表はSourceと同数");
+    
+    /**
+     * @brief 確保処理の関数型
+     */
+    using Installer = common::Delegate<esp_err_t()>;
+    
+    /**
+     * @brief 確保結果
+     */
+    struct Record {
+        bool installed;             // 確保処理を実行した
+        BaseType_t core;            // 実行したコア
+        esp_err_t result;           // 確保処理の結果
+        uint32_t elapsed_us;        // 確保処理の所要時間（μs）
+    };
+    
+    /**
+     * @brief 表の行取得
+     */
+    static constexpr const Entry& entry(Source s) { return TABLE[static_cast<size_t>(s)]; }
+    
+    /**
+     * @brief esp_intr_alloc形式のフラグ（レベル・IRAM）
+     * @param s 割り込み源
+     * @return int フラグ
+     */
+    static constexpr int flags(Source s) {
+        const Entry& e = entry(s);
+        return (e.level > 0 ? (ESP_INTR_FLAG_LEVEL1 << (e.level - 1)) : 0) | (e.iram ? ESP_INTR_FLAG_IRAM : 0);
+    }
+    
+    /**
+     * @brief intr_priority形式の優先度（0でドライバ既定）
+     * @param s 割り込み源
+     * @return int 優先度
+     */
+    static constexpr int priority(Source s) { return entry(s).level; }
+    
+    /**
+     * @brief 確保処理を表のコアで実行（起動時、HALの初期化から呼ぶ）
+     * @param s 割り込み源
+     * @param installer 確保処理
+     * @return esp_err_t 確保処理の結果（一時タスク作成失敗時ESP_ERR_NO_MEM）
+     */
+    static esp_err_t install(Source s, Installer installer);
+    
+    /**
+     * @brief 処理を指定コアで実行（現在のコアならそのまま、別のコアなら一時タスクで実行して待つ）
+     * @param core コア（tskNO_AFFINITYで現在のコア）
+     * @param installer 処理
+     * @param ran_core 実行したコアの格納先（nullptr可）
+     * @return esp_err_t 処理の結果（一時タスク作成失敗時ESP_ERR_NO_MEM）
+     */
+    static esp_err_t runOnCore(BaseType_t core, Installer installer, BaseType_t* ran_core = nullptr);
+    
+    /**
+     * @brief 確保結果取得
+     * @param s 割り込み源
+     * @return const Record& 確保結果
+     */
+    static const Record& getRecord(Source s) { return records_[static_cast<size_t>(s)]; }
+    
+    /**
+     * @brief 制御コアの確認（制御コアに置けない割り込みが確保されていないか）
+     * @param control_core 制御ループのコア
+     * @return size_t 制御コアにある制御以外の割り込みの数（警告としてログに出す）
+     */
+    static size_t checkIsolation(BaseType_t control_core = 1);
+    
+    /**
+     * @brief 割り込み源の名前
+     */
+    static const char* sourceName(Source s) { return entry(s).name; }
+    
+    /**
+     * @brief 配置と確保結果のログ出力（CLI用、全割り込みの一覧も出す）
+     */
+    static void dump();
+    
+private:
+    static Record records_[static_cast<size_t>(Source::COUNT)];     // 確保結果
+};
+
+} // namespace hal
+
+#endif // INTERRUPT_PLAN_HPP
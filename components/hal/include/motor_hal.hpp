@@ -0,0 +1,171 @@
+/*
+ * Motor HAL Class
+ * 
+ * モーター出力用のハードウェア抽象化レイヤー
+ * ESP-IDF MCPWM APIで4モーターを同一タイマーから同期出力する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MOTOR_HAL_HPP
+#define MOTOR_HAL_HPP
+
+#include "hal_base.hpp"
+#include "driver/mcpwm_prelude.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include <array>
+
+namespace hal {
+
+/**
+ * @brief モーターHALクラス
+ * 
+ * MCPWMの1タイマーに2オペレータ（各2ジェネレータ）を接続して4出力を生成する。
+ * コンパレータはタイマーゼロ（TEZ）でシャドウレジスタからラッチされるため、
+ * setAll()で書き込んだ4チャンネルのデューティは通常は同じPWM周期から反映される。
+ * 4回の書き込みの途中でタイマーゼロを跨いだ場合は、最悪で1周期の境界の前後に分かれて反映される
+ * （書き込みは数μsで、跨ぐのは周期の境界に重なった呼び出しだけ）。
+ * StampFlyのブラシDCモーター（MOSFETドライブ）を前提とする
+ */
+class MotorHal : public HalBase {
+public:
+    static constexpr size_t MOTOR_COUNT = 4;        // モーター数
+    
+    /**
+     * @brief モーター位置列挙型
+     */
+    enum class Motor : uint8_t {
+        FRONT_LEFT = 0,
+        FRONT_RIGHT = 1,
+        REAR_LEFT = 2,
+        REAR_RIGHT = 3
+    };
+    
+    /**
+     * @brief モーター出力設定構造体
+     */
+    struct Config {
+        std::array<gpio_num_t, MOTOR_COUNT> pins;   // 出力ピン（Motor順）
+        int group_id;               // MCPWMグループ番号
+        uint32_t resolution_hz;     // タイマー分解能（Hz）
+        uint32_t frequency_hz;      // PWM周波数（Hz）
+    };
+    
+    using DutyArray = std::array<float, MOTOR_COUNT>;   // デューティ配列（0.0-1.0、Motor順）
+    
+public:
+    /**
+     * @brief コンストラクタ
+     */
+    MotorHal();
+    
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~MotorHal();
+    
+    /**
+     * @brief 初期化（MCPWMタイマー・オペレータ・コンパレータ・ジェネレータ作成）
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize() override;
+    
+    /**
+     * @brief 設定変更
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t configure() override;
+    
+    /**
+     * @brief 開始（全モーター0%でタイマー起動）
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start() override;
+    
+    /**
+     * @brief 停止（全モーター0%にしてタイマー停止）
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop() override;
+    
+    /**
+     * @brief リセット
+     * @return esp_err_t リセット結果
+     */
+    esp_err_t reset() override;
+    
+    /**
+     * @brief モーター出力設定
+     * @param config モーター出力設定（initialize()前に呼び出すこと）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setConfig(const Config& config);
+    
+    /**
+     * @brief 全モーター同時出力
+     * 
+     * 4チャンネルのコンパレータを連続して書き込み、通常は次のタイマーゼロで一斉に反映する
+     * （書き込み中にタイマーゼロを跨いだ場合は、先に書いたチャンネルだけ1周期早く反映される）。
+     * ミューテックスを使用しないため制御ループから毎周期呼び出せる
+     * @param duty デューティ（0.0-1.0、範囲外は飽和）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setAll(const DutyArray& duty);
+    
+    /**
+     * @brief 単一モーター出力
+     * @param motor モーター位置
+     * @param duty デューティ（0.0-1.0）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setMotor(Motor motor, float duty);
+    
+    /**
+     * @brief 全モーター停止（0%出力）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t stopAll();
+    
+    /**
+     * @brief 現在のデューティ取得
+     * @return const DutyArray& 最後に設定したデューティ
+     */
+    const DutyArray& getDuty() const { return duty_; }
+    
+    /**
+     * @brief PWM周期取得
+     * @return uint32_t 周期（タイマーティック数）
+     */
+    uint32_t getPeriodTicks() const { return period_ticks_; }
+    
+private:
+    Config config_;                                     // モーター出力設定
+    mcpwm_timer_handle_t timer_;                        // 共有タイマー
+    std::array<mcpwm_oper_handle_t, 2> operators_;      // オペレータ（各2出力）
+    std::array<mcpwm_cmpr_handle_t, MOTOR_COUNT> comparators_;  // コンパレータ
+    std::array<mcpwm_gen_handle_t, MOTOR_COUNT> generators_;    // ジェネレータ
+    DutyArray duty_;                                    // 最後に設定したデューティ
+    uint32_t period_ticks_;                             // PWM周期（ティック）
+    portMUX_TYPE spinlock_;                             // コンパレータ一括書き込み用スピンロック
+    bool timer_enabled_;                                // タイマー有効化済みフラグ
+    
+    /**
+     * @brief デューティからコンパレータ値へ変換
+     * @param duty デューティ（0.0-1.0）
+     * @return uint32_t コンパレータ値
+     */
+    uint32_t dutyToTicks(float duty) const;
+    
+    /**
+     * @brief MCPWMリソース解放
+     */
+    void releaseResources();
+};
+
+} // namespace hal
+
+#endif // MOTOR_HAL_HPP
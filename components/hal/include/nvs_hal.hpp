@@ -16,7 +16,10 @@
 #include "hal_base.hpp"
 #include "nvs_flash.h"
 #include "nvs.h"
+#include <cstring>
+#include <map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <mutex>
@@ -28,6 +31,7 @@ namespace hal {
  * 
  * NVS操作の抽象化レイヤー
  * ESP-IDF NVS APIのC++ラッパー
+ * 書き込みは common::FlashGuard を確認しないため飛行中は使わない（飛行中の保存は ParamRegistry 経由）
  */
 class NvsHal : public HalBase {
 public:
@@ -120,6 +124,17 @@ public:
      * @return esp_err_t クローズ結果
      */
     esp_err_t closeAllNamespaces();
+    
+    /**
+     * @brief 名前空間ハンドル取得（未オープンなら読み書きで開く）
+     * 
+     * 連続アクセス時にハンドルを保持して名前空間の検索を省くために使用する。
+     * ハンドルはcloseNamespace()・closeAllNamespaces()・reset()まで有効
+     * @param namespace_name 名前空間名
+     * @param handle ハンドル格納先
+     * @return esp_err_t 取得結果
+     */
+    esp_err_t getHandle(std::string_view namespace_name, nvs_handle_t& handle);
 
     // 整数型の読み書き
     esp_err_t writeInt8(const std::string& namespace_name, const std::string& key, int8_t value);
@@ -256,7 +271,7 @@ public:
 private:
     std::string partition_label_;                           // パーティションラベル
     std::mutex mutex_;                                      // スレッドセーフ用ミューテックス
-    std::map<std::string, nvs_handle_t> namespace_handles_; // 名前空間ハンドル管理
+    std::map<std::string, nvs_handle_t, std::less<>> namespace_handles_;   // 名前空間ハンドル管理
     bool nvs_initialized_;                                  // NVS初期化状態
     
     /**
@@ -265,7 +280,16 @@ private:
      * @param handle ハンドル格納先
      * @return esp_err_t 取得結果
      */
-    esp_err_t getNamespaceHandle(const std::string& namespace_name, nvs_handle_t& handle);
+    esp_err_t getNamespaceHandle(std::string_view namespace_name, nvs_handle_t& handle);
+    
+    /**
+     * @brief 名前空間を開く（パーティションラベル指定時はそのパーティション）
+     * @param namespace_name 名前空間名
+     * @param mode アクセスモード
+     * @param handle ハンドル格納先
+     * @return esp_err_t オープン結果
+     */
+    esp_err_t openHandle(const char* namespace_name, nvs_open_mode_t mode, nvs_handle_t& handle);
 };
 
 } // namespace hal
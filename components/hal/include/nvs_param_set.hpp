@@ -0,0 +1,223 @@
+/*
+ * NVS Parameter Set
+ * 
+ * NVS名前空間単位の型付きパラメータセット
+ * 名前空間ハンドルを一度だけ解決し、書き込みをRAMへ溜めて1回のコミットで反映する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef NVS_PARAM_SET_HPP
+#define NVS_PARAM_SET_HPP
+
+#include "nvs_hal.hpp"
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace hal {
+
+/**
+ * @brief NVSパラメータセットクラス
+ * 
+ * set()は値をRAMの書き込み待ちリストへ登録するだけでフラッシュには触れない。
+ * commit()で書き込み待ちの全キーをnvs_set_*し、名前空間ごとに1回だけnvs_commit()する。
+ * get()は書き込み待ちの値を優先し、なければ保持済みハンドルからNVSを読む。
+ * 
+ * 書き込み待ちリストは構築時に容量を確保し、以降は再確保しない。
+ * ハンドルはNvsHal::closeNamespace()等で無効になるため、その後はopen()し直すこと
+ */
+class NvsParamSet {
+public:
+    static constexpr size_t KEY_SIZE = NVS_KEY_NAME_MAX_SIZE;   // キー格納サイズ（NUL終端を含む）
+    static constexpr size_t DEFAULT_CAPACITY = 64;              // 既定の書き込み待ち容量
+    
+    /**
+     * @brief 値の型列挙型
+     */
+    enum class Type : uint8_t {
+        INT8,
+        UINT8,
+        INT16,
+        UINT16,
+        INT32,
+        UINT32,
+        INT64,
+        UINT64,
+        FLOAT,      // uint32として保存（NvsHal::writeFloatと互換）
+        DOUBLE      // uint64として保存（NvsHal::writeDoubleと互換）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param nvs NVS HAL（動作中であること）
+     * @param namespace_name 名前空間名
+     * @param capacity 書き込み待ちにできるキー数
+     */
+    NvsParamSet(NvsHal& nvs, std::string_view namespace_name, size_t capacity = DEFAULT_CAPACITY);
+    
+    /**
+     * @brief 名前空間ハンドルの解決
+     * @return esp_err_t 解決結果
+     */
+    esp_err_t open();
+    
+    /**
+     * @brief ハンドル解決済み判定
+     * @return bool 解決済みの場合true
+     */
+    bool isOpen() const { return handle_valid_; }
+    
+    /**
+     * @brief 値の書き込み予約（commit()まで反映しない）
+     * @tparam T 値の型（整数・float・double）
+     * @param key キー名（15文字以下）
+     * @param value 値
+     * @return esp_err_t 予約結果（キーが長すぎる場合ESP_ERR_NVS_KEY_TOO_LONG、容量超過時ESP_ERR_NO_MEM）
+     */
+    template<typename T>
+    esp_err_t set(std::string_view key, T value) {
+        return stage(key, typeOf<T>(), toBits(value));
+    }
+    
+    /**
+     * @brief 値の読み取り（書き込み待ちの値を優先）
+     * @tparam T 値の型（整数・float・double）
+     * @param key キー名
+     * @param value 値格納先
+     * @return esp_err_t 読み取り結果（未保存の場合ESP_ERR_NVS_NOT_FOUND）
+     */
+    template<typename T>
+    esp_err_t get(std::string_view key, T& value) {
+        uint64_t bits = 0;
+        esp_err_t ret = load(key, typeOf<T>(), bits);
+        if (ret == ESP_OK) {
+            value = fromBits<T>(bits);
+        }
+        return ret;
+    }
+    
+    /**
+     * @brief 値の読み取り（未保存の場合は既定値）
+     * @tparam T 値の型
+     * @param key キー名
+     * @param value 値格納先
+     * @param default_value 既定値
+     * @return esp_err_t 読み取り結果（未保存はESP_OKとして既定値を返す）
+     */
+    template<typename T>
+    esp_err_t get(std::string_view key, T& value, T default_value) {
+        esp_err_t ret = get(key, value);
+        if (ret == ESP_ERR_NVS_NOT_FOUND) {
+            value = default_value;
+            return ESP_OK;
+        }
+        return ret;
+    }
+    
+    /**
+     * @brief 書き込み待ちの全キーを書き込み、1回だけコミット
+     * 
+     * 失敗時は書き込み待ちリストを残すため、再度commit()できる
+     * @return esp_err_t コミット結果
+     */
+    esp_err_t commit();
+    
+    /**
+     * @brief 書き込み待ちの破棄
+     */
+    void discard();
+    
+    /**
+     * @brief 書き込み待ちのキー数取得
+     * @return size_t キー数
+     */
+    size_t getPendingCount() const;
+    
+    /**
+     * @brief 名前空間名取得
+     * @return const std::string& 名前空間名
+     */
+    const std::string& getNamespace() const { return namespace_name_; }
+    
+private:
+    /**
+     * @brief 書き込み待ちエントリ
+     */
+    struct Entry {
+        char key[KEY_SIZE];         // キー名（NUL終端）
+        Type type;                  // 値の型
+        uint64_t bits;              // 値（ビット表現）
+    };
+    
+    NvsHal& nvs_;                   // NVS HAL
+    std::string namespace_name_;    // 名前空間名
+    nvs_handle_t handle_;           // 解決済みハンドル
+    bool handle_valid_;             // ハンドル解決済み
+    size_t capacity_;               // 書き込み待ち容量
+    std::vector<Entry> pending_;    // 書き込み待ちリスト
+    mutable std::mutex mutex_;      // 書き込み待ちリストの排他制御
+    
+    template<typename T>
+    static constexpr Type typeOf() {
+        // int32_tがlongになる環境でもint/longをそのまま渡せるよう、サイズと符号で判定する
+        if constexpr (std::is_same_v<T, float>) {
+            return Type::FLOAT;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return Type::DOUBLE;
+        } else {
+            static_assert(std::is_integral_v<T> && sizeof(T) <= 8, "NvsParamSetで扱えない型です");
+            constexpr bool is_signed = std::is_signed_v<T>;
+            if constexpr (sizeof(T) == 1) return is_signed ? Type::INT8 : Type::UINT8;
+            else if constexpr (sizeof(T) == 2) return is_signed ? Type::INT16 : Type::UINT16;
+            else if constexpr (sizeof(T) == 4) return is_signed ? Type::INT32 : Type::UINT32;
+            else return is_signed ? Type::INT64 : Type::UINT64;
+        }
+    }
+    
+    template<typename T>
+    static uint64_t toBits(T value) {
+        uint64_t bits = 0;
+        memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+    
+    template<typename T>
+    static T fromBits(uint64_t bits) {
+        T value;
+        memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+    
+    /**
+     * @brief 書き込み待ちへ登録（同じキーは上書き）
+     */
+    esp_err_t stage(std::string_view key, Type type, uint64_t bits);
+    
+    /**
+     * @brief 書き込み待ちまたはNVSから読み取り
+     */
+    esp_err_t load(std::string_view key, Type type, uint64_t& bits);
+    
+    /**
+     * @brief 1エントリをNVSへ書き込み（コミットは行わない）
+     */
+    esp_err_t writeEntry(const Entry& entry);
+    
+    /**
+     * @brief キーをNUL終端バッファへコピー
+     * @return bool キー長が有効な場合true
+     */
+    static bool copyKey(std::string_view key, char (&buffer)[KEY_SIZE]);
+};
+
+} // namespace hal
+
+#endif // NVS_PARAM_SET_HPP
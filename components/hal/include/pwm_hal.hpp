@@ -15,8 +15,11 @@
 
 #include "hal_base.hpp"
 #include "driver/ledc.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 
 namespace hal {
 
@@ -237,6 +240,35 @@ public:
      */
     esp_err_t resumeOutput(ledc_channel_t channel, SpeedMode speed_mode);
 
+    /**
+     * @brief デューティ比の予約（即時反映しない）
+     * 
+     * commit()で予約済みの全チャンネルをまとめて反映する
+     * @param channel チャンネル番号
+     * @param duty デューティ値
+     * @return esp_err_t 予約結果（startFade()を使ったチャンネルはESP_ERR_INVALID_STATE）
+     */
+    esp_err_t stageDuty(ledc_channel_t channel, uint32_t duty);
+    
+    /**
+     * @brief パーセンテージでデューティ比を予約
+     * @param channel チャンネル番号
+     * @param percentage パーセンテージ（0.0-100.0、範囲外は飽和）
+     * @return esp_err_t 予約結果（startFade()を使ったチャンネルはESP_ERR_INVALID_STATE）
+     */
+    esp_err_t stageDutyPercentage(ledc_channel_t channel, float percentage);
+    
+    /**
+     * @brief 予約済みデューティ比の一括反映
+     * 
+     * 全チャンネルのデューティを書き込んでから、更新要求を連続で発行する。
+     * LEDCは更新要求をタイマーオーバーフローでラッチするため、同じタイマーを共有するチャンネルは
+     * 通常同一周期から新しいデューティになる。IDFのLEDC APIはクリティカルセクション内で呼べないため
+     * 更新要求の間の割り込み・タスク切替は止めず、その場合は1周期の境界をまたいで分かれることがある
+     * @return esp_err_t 反映結果
+     */
+    esp_err_t commit();
+    
     /**
      * @brief 最大デューティ値取得
      * @param resolution 分解能
@@ -261,9 +293,32 @@ public:
     static float dutyToPercentage(uint32_t duty, Resolution resolution);
 
 private:
+    /**
+     * @brief チャンネル毎の更新用状態（チャンネル番号で参照）
+     */
+    struct ChannelState {
+        ledc_mode_t speed_mode;     // スピードモード
+        ledc_timer_t timer_sel;     // 使用するタイマー
+        uint32_t max_duty;          // 最大デューティ値
+        float percent_to_duty;      // パーセンテージ→デューティ換算係数（事前計算）
+        uint32_t duty;              // 現在のデューティ値
+        uint32_t staged_duty;       // 予約中のデューティ値
+        bool configured;            // 設定済みフラグ
+        bool fade_used;             // startFade()を使った（予約反映の対象外）
+    };
+    
     std::map<ledc_timer_t, TimerConfig> timer_configs_;     // タイマー設定管理
     std::map<ledc_channel_t, ChannelConfig> channel_configs_; // チャンネル設定管理
     bool fade_service_installed_;                           // フェードサービス初期化フラグ
+    std::mutex mutex_;                                      // スレッドセーフ用ミューテックス
+    ChannelState channel_state_[LEDC_CHANNEL_MAX];          // チャンネル毎の更新用状態
+    std::atomic<uint32_t> staged_mask_;                     // 予約中チャンネルのビットマスク
+    
+    /**
+     * @brief チャンネルの換算係数を更新
+     * @param channel チャンネル番号
+     */
+    void updateDutyScale(ledc_channel_t channel);
 
     /**
      * @brief フェードサービス初期化
@@ -0,0 +1,213 @@
+/*
+ * Rate Scheduler
+ * 
+ * 制御ループ用のレートグループスケジューラ
+ * ISRディスパッチのesp_timerを基本ティックとし、各レートグループのタスクへ
+ * 位相をずらしてタスク通知を送ることで、グループ同士の起床が重ならないようにする
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef RATE_SCHEDULER_HPP
+#define RATE_SCHEDULER_HPP
+
+#include "hal_base.hpp"
+#include "timer_hal.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+
+namespace hal {
+
+/**
+ * @brief レートグループスケジューラクラス
+ * 
+ * 基本ティック（既定4kHz）をグループごとの分周比で間引き、位相（ティック単位）を
+ * 自動割り当てして通知タイミングを分散する。例えば1kHz/500Hz/100Hz/10Hzの各グループは
+ * 位相0/1/2/3となり、同じティックで2つのタスクが起床することはない。
+ * 通知はタスク通知インデックス0へのインクリメントで、タスク側はwaitForTick()で待つ
+ */
+class RateScheduler : public HalBase {
+public:
+    static constexpr size_t MAX_GROUPS = 8;                     // 登録できるレートグループ数
+    static constexpr uint32_t DEFAULT_TICK_RATE_HZ = 4000;      // 基本ティック周波数
+    
+    /**
+     * @brief スケジューラ設定構造体
+     */
+    struct Config {
+        uint32_t tick_rate_hz;      // 基本ティック周波数（Hz、1MHzを割り切れる値）
+    };
+    
+    /**
+     * @brief レートグループ統計構造体
+     */
+    struct GroupStats {
+        uint32_t rate_hz;           // 実レート（Hz）
+        uint32_t divider;           // 基本ティックに対する分周比
+        uint32_t phase_ticks;       // 位相（ティック）
+        uint32_t notify_count;      // 通知回数
+        uint32_t overrun_count;     // 前回の通知が未処理のまま次の通知をした回数
+        uint32_t min_interval_us;   // 最小通知間隔（μs）
+        uint32_t max_interval_us;   // 最大通知間隔（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     */
+    RateScheduler();
+    
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~RateScheduler();
+    
+    /**
+     * @brief 設定
+     * @param config スケジューラ設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief 初期化（基本ティックのタイマーを作成）
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize() override;
+    
+    /**
+     * @brief 設定変更
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t configure() override;
+    
+    /**
+     * @brief 開始（基本ティック開始）
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start() override;
+    
+    /**
+     * @brief 停止
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop() override;
+    
+    /**
+     * @brief リセット（グループ登録と統計を消去）
+     * @return esp_err_t リセット結果
+     */
+    esp_err_t reset() override;
+    
+    /**
+     * @brief レートグループ登録（位相は自動割り当て）
+     * 
+     * 既存グループと同じティックにならない最小の位相を割り当てる
+     * @param rate_hz レート（Hz、基本ティック周波数を割り切れる値）
+     * @param task 通知先タスク
+     * @param group_index 登録したグループ番号の格納先（nullptr可）
+     * @return esp_err_t 登録結果（重ならない位相がない場合ESP_ERR_NOT_FOUND）
+     */
+    esp_err_t addGroup(uint32_t rate_hz, TaskHandle_t task, size_t* group_index = nullptr);
+    
+    /**
+     * @brief レートグループ登録（位相指定）
+     * @param rate_hz レート（Hz、基本ティック周波数を割り切れる値）
+     * @param task 通知先タスク
+     * @param phase_ticks 位相（ティック、分周比未満）
+     * @param group_index 登録したグループ番号の格納先（nullptr可）
+     * @return esp_err_t 登録結果
+     */
+    esp_err_t addGroup(uint32_t rate_hz, TaskHandle_t task, uint32_t phase_ticks, size_t* group_index);
+    
+    /**
+     * @brief レートグループ数取得
+     * @return size_t グループ数
+     */
+    size_t getGroupCount() const { return group_count_; }
+    
+    /**
+     * @brief レートグループ統計取得
+     * @param index グループ番号
+     * @param stats 統計格納先
+     * @return esp_err_t 取得結果
+     */
+    esp_err_t getGroupStats(size_t index, GroupStats& stats) const;
+    
+    /**
+     * @brief 統計リセット（次のティックで反映）
+     */
+    void resetStats();
+    
+    /**
+     * @brief 全グループの統計をログ出力
+     */
+    void dumpStats() const;
+    
+    /**
+     * @brief レートグループのタスクで次の通知を待つ
+     * @param timeout 待ち時間
+     * @return uint32_t 前回呼び出し以降の通知数（0はタイムアウト、2以上は周期落ち）
+     */
+    static uint32_t waitForTick(TickType_t timeout = portMAX_DELAY) {
+        return ulTaskNotifyTake(pdTRUE, timeout);
+    }
+    
+private:
+    /**
+     * @brief レートグループ
+     */
+    struct Group {
+        TaskHandle_t task;                      // 通知先タスク
+        uint32_t divider;                       // 分周比
+        uint32_t phase;                         // 位相
+        uint32_t countdown;                     // 次の通知までのティック数（ISRのみ更新）
+        int64_t last_notify_us;                 // 前回の通知時刻（ISRのみ更新）
+        std::atomic<uint32_t> notify_count;     // 通知回数
+        std::atomic<uint32_t> overrun_count;    // 未処理通知の上書き回数
+        std::atomic<uint32_t> min_interval_us;  // 最小通知間隔
+        std::atomic<uint32_t> max_interval_us;  // 最大通知間隔
+    };
+    
+    Config config_;                         // スケジューラ設定
+    TimerHal timer_;                        // 基本ティックタイマー（ISRディスパッチ）
+    Group groups_[MAX_GROUPS];              // レートグループ
+    size_t group_count_;                    // 登録グループ数（停止中のみ変更）
+    std::atomic<bool> reset_requested_;     // 統計リセット要求
+    
+    /**
+     * @brief 既存グループと重ならない位相を探索
+     * @param divider 分周比
+     * @param phase 位相格納先
+     * @return bool 見つかった場合true
+     */
+    bool findPhase(uint32_t divider, uint32_t& phase) const;
+    
+    /**
+     * @brief 位相が既存グループと重なるか判定
+     * @param divider 分周比
+     * @param phase 位相
+     * @return bool 重なる場合true
+     */
+    bool collides(uint32_t divider, uint32_t phase) const;
+    
+    /**
+     * @brief 統計の初期化
+     * @param group グループ
+     */
+    static void clearStats(Group& group);
+    
+    /**
+     * @brief 基本ティックのコールバック（esp_timer ISR）
+     * @param context RateSchedulerインスタンス
+     * @return bool コンテキストスイッチが必要な場合true
+     */
+    static bool IRAM_ATTR tickCallback(void* context);
+};
+
+} // namespace hal
+
+#endif // RATE_SCHEDULER_HPP
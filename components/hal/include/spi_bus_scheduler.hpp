@@ -0,0 +1,225 @@
+/*
+ * SPI Bus Scheduler
+ * 
+ * 共有SPIバスの優先度付き調停
+ * IMUのFIFO読み出しのような周期・期限つきの転送を最優先とし、
+ * オプティカルフロー等の通常の転送はその窓を避けて投入する。デバイス毎のバス使用率を集計する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SPI_BUS_SCHEDULER_HPP
+#define SPI_BUS_SCHEDULER_HPP
+
+#include "spi_hal.hpp"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace hal {
+
+/**
+ * @brief 共有SPIバススケジューラクラス
+ * 
+ * SpiHal::acquireBus() は先着順のため、低優先度のデバイスがバスを占有している間は
+ * IMUの読み出しがその転送の終わりまで待たされる。本クラスはバスの占有を次のように調停する:
+ *   - CRITICAL: 待たずに acquireBus() する。周期 period_us から次の要求時刻を予測し、
+ *     要求から解放までが deadline_us を超えたら期限超過として数える
+ *   - NORMAL: 占有の見積もり（budget_us）が次のCRITICALの要求時刻 - guard_us までに収まる場合だけ占有する。
+ *     収まらない・CRITICALが待っている場合は、その窓が終わるまで common::Deadline で待つ
+ *     （ティック未満の残りは空回りのため、CRITICALのタスクより低い優先度で呼ぶこと）
+ * 長い転送は transferChunked() で max_chunk_bytes 毎の別々のCS区間に分け、チャンク毎に調停する。
+ * PMW3901のモーションバーストのようにCSを上げると打ち切られる転送は分割できないため、
+ * バースト全体を1回の占有とし、見積もりで窓の前に収まるかを判定する
+ * 
+ * 調停はバスを共有する全デバイスが本クラスを通す前提（直接 transmitPolling() したデバイスとは
+ * 従来どおり先着順になる）。NORMALが判定してから占有するまでの間にCRITICALが要求した場合、
+ * CRITICALは最大でその見積もり分待たされる
+ * 
+ * 使用例:
+ *   scheduler.addClient(imu_device, {"imu", SpiBusScheduler::Priority::CRITICAL, 2500, 500}, imu_client);
+ *   scheduler.addClient(flow_device, {"flow", SpiBusScheduler::Priority::NORMAL, 0, 0, 150}, flow_client);
+ *   imu.attachScheduler(scheduler_ptr, imu_client);
+ *   flow.attachScheduler(scheduler_ptr, flow_client);
+ */
+class SpiBusScheduler {
+public:
+    static constexpr size_t MAX_CLIENTS = 4;        // 登録できるデバイス数
+    
+    /**
+     * @brief 優先度
+     */
+    enum class Priority : uint8_t {
+        CRITICAL = 0,       // 周期・期限つき（IMU FIFO等）、待たずに占有する
+        NORMAL              // CRITICALの窓を避けて占有する
+    };
+    
+    /**
+     * @brief スケジューラ設定構造体
+     */
+    struct Config {
+        uint32_t guard_us = 50;             // CRITICALの予測要求時刻の前に空けておく時間（μs、起床の揺らぎ分）
+        uint32_t max_defer_us = 20000;      // NORMALを待たせる上限（μs、超えたら窓を無視して占有する）
+    };
+    
+    /**
+     * @brief デバイス設定構造体
+     */
+    struct ClientConfig {
+        const char* name = "spi";           // 名前（dump()用）
+        Priority priority = Priority::NORMAL;   // 優先度
+        uint32_t period_us = 0;             // CRITICAL: 要求の周期（μs、0で非周期・窓を作らない）
+        uint32_t deadline_us = 0;           // CRITICAL: 要求から解放までの期限（μs、0で周期と同じ）
+        uint32_t budget_us = 100;           // NORMAL: 1回の占有の見積もり（μs、transferChunked()は1チャンク分）
+        size_t max_chunk_bytes = 64;        // NORMAL: transferChunked() の1チャンクの最大長（バイト）
+    };
+    
+    /**
+     * @brief デバイス毎の統計情報構造体
+     */
+    struct ClientStats {
+        uint32_t transfers;         // 占有回数
+        uint32_t chunks;            // transferChunked() で分けたチャンク数
+        uint64_t bytes;             // 転送バイト数（release()の申告分）
+        uint64_t busy_us;           // 占有時間の合計（μs）
+        uint32_t max_hold_us;       // 最大の占有時間（μs）
+        uint32_t max_wait_us;       // 要求から占有までの最大の待ち（μs）
+        uint32_t deferrals;         // NORMAL: 窓を避けて待った回数
+        uint32_t forced;            // NORMAL: 待ちの上限で窓を無視した回数
+        uint32_t overruns;          // NORMAL: 占有が見積もりを超えた回数
+        uint32_t deadline_misses;   // CRITICAL: 期限超過の回数
+        uint32_t errors;            // 占有・転送の失敗回数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param spi 共有するSPI HAL
+     */
+    explicit SpiBusScheduler(std::shared_ptr<SpiHal> spi);
+    
+    SpiBusScheduler(const SpiBusScheduler&) = delete;
+    SpiBusScheduler& operator=(const SpiBusScheduler&) = delete;
+    
+    /**
+     * @brief 開始（設定の反映と統計のやり直し）
+     * @param config 設定
+     * @return esp_err_t 待ちの上限が0の場合ESP_ERR_INVALID_ARG
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 開始（既定設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief デバイス登録（転送を始める前に全て登録する）
+     * @param device SpiHal::addDevice() のデバイスハンドル
+     * @param config デバイス設定
+     * @param client 登録番号格納先
+     * @return esp_err_t 登録数の超過はESP_ERR_NO_MEM、見積もり・チャンク長が0の場合ESP_ERR_INVALID_ARG
+     */
+    esp_err_t addClient(spi_device_handle_t device, const ClientConfig& config, size_t& client);
+    
+    /**
+     * @brief バス占有（優先度に応じて調停する、IRAM配置）
+     * @param client 登録番号
+     * @param budget_us 今回の占有の見積もり（μs、0で登録時の budget_us、NORMALのみ使う）
+     * @return esp_err_t 登録番号が不正な場合ESP_ERR_INVALID_ARG
+     */
+    esp_err_t IRAM_ATTR acquire(size_t client, uint32_t budget_us = 0);
+    
+    /**
+     * @brief バス占有解除（占有時間の集計、IRAM配置）
+     * @param client acquire() した登録番号
+     * @param bytes 占有中に転送したバイト数（統計用）
+     */
+    void IRAM_ATTR release(size_t client, size_t bytes = 0);
+    
+    /**
+     * @brief 分割転送（max_chunk_bytes 毎に別々のCS区間のポーリング転送、チャンク毎に調停する）
+     * 
+     * 連続レジスタの書き込み・データポートの繰り返し読み出し等、CSを上げても続きから再開できる転送用
+     * @param client 登録番号
+     * @param tx_data 送信データ（nullptrで0送信）
+     * @param rx_data 受信データ格納先（nullptrで受信なし）
+     * @param length 転送データ長（バイト）
+     * @return esp_err_t 転送結果（失敗したチャンクで止める）
+     */
+    esp_err_t transferChunked(size_t client, const uint8_t* tx_data, uint8_t* rx_data, size_t length);
+    
+    /**
+     * @brief 登録数
+     */
+    size_t clientCount() const { return client_count_; }
+    
+    /**
+     * @brief デバイス毎の統計情報取得
+     * @param client 登録番号
+     */
+    const ClientStats& getStats(size_t client) const { return clients_[client].stats; }
+    
+    /**
+     * @brief バス使用率（統計をやり直してからの占有時間の割合、0〜1）
+     * @param client 登録番号
+     */
+    float utilization(size_t client) const;
+    
+    /**
+     * @brief 統計のやり直し
+     */
+    void resetStats();
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 登録デバイス
+     */
+    struct Client {
+        spi_device_handle_t device;     // デバイスハンドル
+        ClientConfig config;            // 設定
+        ClientStats stats;              // 統計情報
+        int64_t request_us;             // 今回の acquire() の呼び出し時刻
+        int64_t grant_us;               // 今回の占有開始時刻
+        uint32_t budget_us;             // 今回の占有の見積もり
+        int64_t next_request_us;        // CRITICAL: 次の要求の予測時刻（0で未定、spinlock_で保護）
+        uint32_t last_hold_us;          // CRITICAL: 前回の占有時間（spinlock_で保護）
+    };
+    
+    std::shared_ptr<SpiHal> spi_;           // SPI HAL
+    Config config_;                         // 設定
+    Client clients_[MAX_CLIENTS];           // 登録デバイス
+    size_t client_count_;                   // 登録数
+    std::atomic<uint32_t> critical_waiting_;    // 占有を待っているCRITICALの数
+    int64_t stats_start_us_;                // 統計の開始時刻
+    mutable portMUX_TYPE spinlock_;         // CRITICALの予測時刻の保護
+    
+    /**
+     * @brief NORMALの占有判定
+     * @param now_us 現在時刻（μs）
+     * @param budget_us 占有の見積もり（μs）
+     * @return int64_t 占有してよい場合0、待つ場合は次に判定する時刻（μs）
+     */
+    int64_t IRAM_ATTR admission(int64_t now_us, uint32_t budget_us) const;
+    
+    /**
+     * @brief 優先度名
+     */
+    static const char* priorityName(Priority priority);
+};
+
+} // namespace hal
+
+#endif // SPI_BUS_SCHEDULER_HPP
@@ -51,6 +51,8 @@ public:
         int max_transfer_size;      // 最大転送サイズ
         int dma_channel;            // DMAチャンネル
         int queue_size;             // キューサイズ
+        size_t dma_pool_size;       // DMA転送ディスクリプタのプール数
+        size_t dma_buffer_size;     // ディスクリプタ毎のDMAバッファサイズ（バイト）
     };
 
     /**
@@ -65,6 +67,7 @@ public:
         int address_bits;          // アドレスビット数
         int dummy_bits;            // ダミービット数
         uint32_t flags;            // 追加フラグ
+        bool use_polling;          // ポーリング転送を使用（短いレジスタ読み取り向け、falseで割り込み転送）
     };
 
     /**
@@ -79,6 +82,43 @@ public:
         uint32_t flags;                    // トランザクションフラグ
     };
 
+    /**
+     * @brief DMA転送ディスクリプタ
+     * 
+     * SpiHalが所有する事前確保済みディスクリプタ。送受信バッファはMALLOC_CAP_DMAで確保され、
+     * acquireTransaction() から releaseTransaction() まで呼び出し側が占有する
+     */
+    struct DmaTransaction {
+        spi_transaction_t trans;            // ESP-IDFトランザクション（trans.user は自身を指す）
+        uint8_t* tx_buffer;                 // DMA対応送信バッファ
+        uint8_t* rx_buffer;                 // DMA対応受信バッファ
+        size_t buffer_size;                 // バッファサイズ（バイト）
+        spi_device_handle_t device;         // 投入先デバイス
+        bool in_use;                        // 使用中フラグ
+        bool in_flight;                     // 転送キュー投入中フラグ
+    };
+    
+    /**
+     * @brief ポーリング転送用のデバイス毎DMAバッファ
+     * 
+     * addDevice() で MALLOC_CAP_DMA から確保し、removeDevice() で解放する。
+     * transmitPolling() は呼び出し側のバッファがDMA非対応・4バイト境界でない場合にこれを経由し、
+     * ドライバが転送毎にバウンスバッファを確保しないようにする
+     */
+    struct PollingScratch {
+        spi_device_handle_t device;         // デバイス
+        uint8_t* tx_buffer;                 // DMA対応送信バッファ（POLLING_SCRATCH_SIZE バイト）
+        uint8_t* rx_buffer;                 // DMA対応受信バッファ（POLLING_SCRATCH_SIZE バイト）
+    };
+    
+    /**
+     * @brief トレースポイント番号（HalBase::getTraceStats()の引数）
+     */
+    enum TracePoint : size_t {
+        TRACE_TRANSFER = 0, // 同期転送（割り込み/ポーリング）
+        TRACE_REGISTER      // ポーリングレジスタアクセス
+    };
+
 public:
     /**
      * @brief コンストラクタ
@@ -207,17 +247,173 @@ public:
      */
     esp_err_t readRegister8(spi_device_handle_t device_handle, uint8_t address, uint8_t& value);
 
+    /**
+     * @brief レジスタ読み取り（呼び出し側バッファ）
+     * @param device_handle デバイスハンドル
+     * @param address レジスタアドレス
+     * @param data 読み取りデータ格納先（length バイト以上）
+     * @param length 読み取りデータ長（dma_buffer_size - 1 以下）
+     * @return esp_err_t 読み取り結果
+     * 
+     * DMAディスクリプタプールを使用し、ヒープ確保を行わない
+     */
+    esp_err_t readRegister(spi_device_handle_t device_handle, uint8_t address, 
+                          uint8_t* data, size_t length);
+
+    /**
+     * @brief DMA転送ディスクリプタ取得
+     * @return DmaTransaction* ディスクリプタ（空きなし時nullptr）
+     */
+    DmaTransaction* acquireTransaction();
+
+    /**
+     * @brief DMA転送ディスクリプタ返却
+     * @param transaction acquireTransaction() で取得したディスクリプタ
+     */
+    void releaseTransaction(DmaTransaction* transaction);
+
+    /**
+     * @brief DMA転送キュー投入
+     * @param device_handle デバイスハンドル
+     * @param transaction ディスクリプタ（tx_buffer に送信データを設定済みであること）
+     * @param tx_length 送信データ長（バイト）
+     * @param rx_length 受信データ長（バイト、0で受信なし）
+     * @param timeout キュー投入タイムアウト
+     * @param flags トランザクションフラグ（SPI_TRANS_CS_KEEP_ACTIVE等）
+     * @return esp_err_t 投入結果
+     * 
+     * 投入後すぐに戻る。結果は getTransactionResult() で回収すること
+     */
+    esp_err_t queueTransaction(spi_device_handle_t device_handle, DmaTransaction* transaction, 
+                               size_t tx_length, size_t rx_length, 
+                               TickType_t timeout = portMAX_DELAY, uint32_t flags = 0);
+
+    /**
+     * @brief レジスタ読み取りのキュー投入
+     * @param device_handle デバイスハンドル
+     * @param address レジスタアドレス
+     * @param length 読み取りデータ長
+     * @param transaction 使用したディスクリプタ格納先（完了後 rx_buffer + 1 から読み取りデータ）
+     * @param timeout キュー投入タイムアウト
+     * @return esp_err_t 投入結果
+     */
+    esp_err_t queueReadRegister(spi_device_handle_t device_handle, uint8_t address, size_t length, 
+                                DmaTransaction*& transaction, 
+                                TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief キュー投入済み転送の結果取得
+     * @param device_handle デバイスハンドル
+     * @param transaction 完了したディスクリプタ格納先（投入順に返る）
+     * @param timeout 完了待ちタイムアウト
+     * @return esp_err_t 取得結果
+     */
+    esp_err_t getTransactionResult(spi_device_handle_t device_handle, DmaTransaction*& transaction, 
+                                   TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief SPIバス占有
+     * @param device_handle デバイスハンドル
+     * @param timeout タイムアウト時間（portMAX_DELAYのみ対応）
+     * @return esp_err_t 占有結果
+     * 
+     * 連続したポーリング転送の間、他デバイスへのバス切替を抑止する。
+     * 占有中は他デバイスの転送がブロックされるため、バースト終了後に必ず releaseBus() を呼ぶこと
+     */
+    esp_err_t acquireBus(spi_device_handle_t device_handle, TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief SPIバス占有解除
+     * @param device_handle acquireBus() で占有したデバイスハンドル
+     */
+    void releaseBus(spi_device_handle_t device_handle);
+
+    /**
+     * @brief ポーリング送受信（全二重）
+     * @param device_handle デバイスハンドル
+     * @param tx_data 送信データ（nullptrで0送信）
+     * @param rx_data 受信データ格納先（nullptrで受信なし）
+     * @param length 転送データ長（バイト）
+     * @param flags 追加のトランザクションフラグ（SPI_TRANS_CS_KEEP_ACTIVE等、バス占有中のみ）
+     * @return esp_err_t 送受信結果
+     * 
+     * 割り込み・タスク切替を伴わない高速経路。mutex_ を取得しないため、
+     * 同一デバイスを複数タスクから同時に使用しないこと。
+     * 5バイト以上でバッファがDMA非対応・4バイト境界でない場合、POLLING_SCRATCH_SIZE 以下の転送は
+     * デバイス毎のDMAバッファへコピーして転送する（それより長い転送はドライバのバウンスバッファになる）
+     */
+    esp_err_t transmitPolling(spi_device_handle_t device_handle, const uint8_t* tx_data, 
+                              uint8_t* rx_data, size_t length, uint32_t flags = 0);
+
+    /**
+     * @brief ポーリングレジスタ読み取り
+     * @param device_handle デバイスハンドル
+     * @param address レジスタアドレス
+     * @param data 読み取りデータ格納先（length バイト以上）
+     * @param length 読み取りデータ長（MAX_POLLING_TRANSFER_SIZE 以下）
+     * @return esp_err_t 読み取り結果
+     */
+    esp_err_t readRegisterPolling(spi_device_handle_t device_handle, uint8_t address, 
+                                  uint8_t* data, size_t length);
+
+    /**
+     * @brief ポーリングレジスタ書き込み
+     * @param device_handle デバイスハンドル
+     * @param address レジスタアドレス
+     * @param data 書き込みデータ
+     * @param length 書き込みデータ長（MAX_POLLING_TRANSFER_SIZE 以下）
+     * @return esp_err_t 書き込み結果
+     */
+    esp_err_t writeRegisterPolling(spi_device_handle_t device_handle, uint8_t address, 
+                                   const uint8_t* data, size_t length);
+
     /**
      * @brief SPIホスト取得
      * @return spi_host_device_t SPIホスト
      */
     spi_host_device_t getHost() const { return config_.host; }
 
+    static constexpr size_t MAX_POLLING_TRANSFER_SIZE = 32;    // ポーリングレジスタアクセスの最大データ長
+    static constexpr size_t POLLING_SCRATCH_SIZE = MAX_POLLING_TRANSFER_SIZE + 4;  // デバイス毎DMAバッファ（4の倍数）
+
 private:
     Config config_;                     // SPI設定
     std::mutex mutex_;                  // スレッドセーフ用ミューテックス
     bool bus_initialized_;              // バス初期化状態
     std::vector<spi_device_handle_t> devices_;  // デバイスハンドル管理
+    std::vector<DmaTransaction> dma_pool_;      // DMA転送ディスクリプタプール（configure時に確保）
+    std::vector<spi_device_handle_t> polling_devices_;  // ポーリング転送を使用するデバイス
+    std::vector<PollingScratch> scratch_;       // ポーリング転送用のデバイス毎DMAバッファ
+
+    /**
+     * @brief DMAディスクリプタプール確保
+     * @return esp_err_t 確保結果
+     */
+    esp_err_t allocateDmaPool();
+
+    /**
+     * @brief DMAディスクリプタプール解放
+     */
+    void freeDmaPool();
+
+    /**
+     * @brief デバイス毎DMAバッファ解放（全デバイス分）
+     */
+    void freeScratch();
+    
+    /**
+     * @brief デバイス毎DMAバッファ検索
+     * @param device_handle デバイスハンドル
+     * @return PollingScratch* バッファ（本HALで追加したデバイスでない場合nullptr）
+     */
+    PollingScratch* findScratch(spi_device_handle_t device_handle);
+    
+    /**
+     * @brief ポーリング転送デバイス判定（mutex_ 取得中に呼び出すこと）
+     * @param device_handle デバイスハンドル
+     * @return bool ポーリング転送デバイスの場合true
+     */
+    bool isPollingDevice(spi_device_handle_t device_handle) const;
 
     /**
      * @brief SPIモードをESP-IDFフラグに変換
@@ -14,9 +14,9 @@
 #define TIMER_HAL_HPP
 
 #include "hal_base.hpp"
+#include "delegate.hpp"
 #include "driver/gptimer.h"
 #include "esp_timer.h"
-#include <functional>
 #include <memory>
 
 namespace hal {
@@ -44,6 +44,7 @@ public:
         uint64_t period_us;         // 周期（マイクロ秒）
         bool auto_reload;           // 自動リロード
         const char* name;           // タイマー名
+        bool dispatch_isr;          // ESP_TIMER_ISRディスパッチ（configureHighResolutionIsr()で設定）
     };
 
     /**
@@ -59,8 +60,16 @@ public:
 
     /**
      * @brief タイマーコールバック関数型
+     * 
+     * ヒープ確保なしの固定サイズデリゲート。汎用タイマーとISRディスパッチでは
+     * ISRから呼ばれるため、処理本体もIRAM配置であること
      */
-    using TimerCallback = std::function<bool(void)>;  // 戻り値: 高優先度タスクを起動するかどうか
+    using TimerCallback = common::Delegate<bool(void)>;  // 戻り値: 高優先度タスクを起動するかどうか
+    
+    /**
+     * @brief ISRタイマーコールバック関数型（IRAM配置の関数であること）
+     */
+    using IsrCallback = bool (*)(void* context);     // 戻り値: 高優先度タスクを起動するかどうか
 
 public:
     /**
@@ -111,6 +120,33 @@ public:
      * @return esp_err_t 設定結果
      */
     esp_err_t configureHighResolution(const HighResConfig& config, TimerCallback callback);
+    
+    /**
+     * @brief 高分解能タイマー設定（ISRディスパッチ）
+     * 
+     * esp_timerタスクを経由せずタイマー割り込みから直接コールバックを呼び出す。
+     * コールバックがtrueを返すとISR出口でコンテキストスイッチを要求する
+     * @param config 高分解能タイマー設定（dispatch_isrは無視され常にISR）
+     * @param callback コールバック関数
+     * @param context コールバックに渡すコンテキスト
+     * @return esp_err_t 設定結果（CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD無効時ESP_ERR_NOT_SUPPORTED）
+     */
+    esp_err_t configureHighResolutionIsr(const HighResConfig& config, TimerCallback callback);
+    
+    /**
+     * @brief 高分解能タイマー設定（ISRディスパッチ、関数ポインタコールバック）
+     * @param config 高分解能タイマー設定（dispatch_isrは無視され常にISR）
+     * @param callback コールバック関数
+     * @param context コールバックに渡すコンテキスト
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t configureHighResolutionIsr(const HighResConfig& config, IsrCallback callback, void* context);
+    
+    /**
+     * @brief 高分解能タイマー開始（設定済みの周期・自動リロードで開始）
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t startHighResolution();
 
     /**
      * @brief 汎用タイマー設定
@@ -156,6 +192,8 @@ public:
 
     /**
      * @brief 遅延実行（高分解能タイマーのみ）
+     *
+     * ティック単位はタスクを眠らせ、ティック未満の残りだけ空回りする（common::Deadline::sleep()）
      * @param delay_us 遅延時間（マイクロ秒）
      */
     void delay(uint32_t delay_us);
@@ -194,12 +232,25 @@ private:
     
     TimerCallback callback_;            // コールバック関数
     bool active_;                       // アクティブ状態
+    
+    /**
+     * @brief esp_timer作成の共通処理
+     * @param config 高分解能タイマー設定
+     * @return esp_err_t 作成結果
+     */
+    esp_err_t createEspTimer(const HighResConfig& config);
 
     /**
      * @brief 高分解能タイマーコールバック
      * @param arg 引数（TimerHalインスタンス）
      */
     static void espTimerCallback(void* arg);
+    
+    /**
+     * @brief 高分解能タイマーコールバック（ISRディスパッチ）
+     * @param arg 引数（TimerHalインスタンス）
+     */
+    static void IRAM_ATTR espTimerIsrCallback(void* arg);
 
     /**
      * @brief 汎用タイマーコールバック
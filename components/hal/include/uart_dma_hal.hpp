@@ -0,0 +1,258 @@
+/*
+ * UART DMA HAL Class
+ * 
+ * UHCI（GDMA）によるUARTの大容量転送用ハードウェア抽象化レイヤー
+ * ログのダンプやコンパニオンコンピュータとの高速リンク向けに、DMAバッファを直接受け渡す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef UART_DMA_HAL_HPP
+#define UART_DMA_HAL_HPP
+
+#include "hal_base.hpp"
+#include "uart_hal.hpp"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if HAL_UART_UHCI_ENABLED
+#include "driver/uhci.h"
+#endif
+
+namespace hal {
+
+/**
+ * @brief UART DMA HALクラス
+ * 
+ * UARTドライバ（uart_driver_install）の代わりにUHCIコントローラでUARTとGDMAをつなぎ、
+ * 送受信ともDMAバッファを利用側へ直接渡す（バイト単位のリングやイベントタスクを経由しない）。
+ * 回線設定（ボーレート・ピン・フロー制御）はUartHal::Configを使い、バッファ・キュー関係の項目は使わない。
+ * 
+ * 送信: acquireTxBuffer()で空きバッファを取り、書き込んでsubmitTx()で渡す。
+ * 送信完了の割り込みでバッファは空きに戻る。
+ * 受信: receive()で受信済みブロック（DMAバッファ内を直接参照）を取り、使い終えたらreleaseRx()で返す。
+ * 1つのバッファは回線のアイドルまたは満杯で区切られ、途中経過も複数のブロックとして届く。
+ * 受信の再開（次のバッファの登録）はreceive()・releaseRx()の中で行うため、読み出しは1つのタスクから行う。
+ * 
+ * 同じポートをUartHalと同時に使うことはできない。ESP-IDF v5.5未満（UHCIドライバなし）では
+ * configure()がESP_ERR_NOT_SUPPORTEDを返す
+ */
+class UartDmaHal : public HalBase {
+public:
+    /**
+     * @brief DMA設定構造体
+     */
+    struct DmaConfig {
+        size_t tx_buffer_size = 4096;       // 送信バッファ1つのサイズ（1回の転送の上限）
+        size_t tx_buffer_count = 4;         // 送信バッファ数（同時に送信待ちにできる数）
+        size_t rx_buffer_size = 4096;       // 受信バッファ1つのサイズ
+        size_t rx_buffer_count = 4;         // 受信バッファ数
+        size_t dma_burst_size = 32;         // DMAバースト長（バイト）
+        bool rx_idle_eof = true;            // 回線のアイドルで受信バッファを区切る
+    };
+    
+    /**
+     * @brief 受信ブロック
+     */
+    struct RxBlock {
+        const uint8_t* data;                // 受信データ（DMAバッファ内を直接参照）
+        size_t length;                      // 受信バイト数
+        uint8_t* buffer;                    // 属するDMAバッファ
+        bool last;                          // バッファの最後のブロック
+    };
+    
+    /**
+     * @brief 転送統計構造体
+     */
+    struct Stats {
+        uint32_t tx_bytes;                  // 送信バイト数
+        uint32_t tx_transfers;              // 送信転送数
+        uint32_t tx_errors;                 // 送信登録失敗数
+        uint32_t rx_bytes;                  // 受信バイト数
+        uint32_t rx_blocks;                 // 受信ブロック数
+        uint32_t rx_dropped;                // 受信済みキュー満杯で捨てたブロック数
+        uint32_t rx_starved;                // 受信再開時に空きバッファがなかった回数
+    };
+    
+    /**
+     * @brief トレースポイント番号（HalBase::getTraceStats()の引数）
+     */
+    enum TracePoint : size_t {
+        TRACE_SUBMIT = 0,   // 送信の登録
+        TRACE_ARM           // 受信バッファの登録
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param port UARTポート番号
+     */
+    explicit UartDmaHal(uart_port_t port = UART_NUM_1);
+    
+    /**
+     * @brief デストラクタ
+     */
+    virtual ~UartDmaHal();
+    
+    /**
+     * @brief 初期化
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize() override;
+    
+    /**
+     * @brief 設定変更（UART設定・UHCIコントローラ作成・DMAバッファ確保）
+     * @return esp_err_t 設定結果（UHCIドライバがない場合ESP_ERR_NOT_SUPPORTED）
+     */
+    esp_err_t configure() override;
+    
+    /**
+     * @brief 開始（受信バッファを登録して受信を始める）
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start() override;
+    
+    /**
+     * @brief 停止（送信中の転送は完了まで待つ）
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop() override;
+    
+    /**
+     * @brief リセット
+     * @return esp_err_t リセット結果
+     */
+    esp_err_t reset() override;
+    
+    /**
+     * @brief UART回線設定
+     * @param config UART設定（rx_buffer_size・tx_buffer_size・queue_sizeは使わない）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setConfig(const UartHal::Config& config);
+    
+    /**
+     * @brief DMA設定（configure()の前に呼ぶ）
+     * @param config DMA設定
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setDmaConfig(const DmaConfig& config);
+    
+    /**
+     * @brief 送信バッファ取得
+     * @param timeout 空きを待つ時間
+     * @return uint8_t* DMAバッファ（getTxBufferSize()バイト、空きがない場合nullptr）
+     */
+    uint8_t* acquireTxBuffer(TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 送信（バッファの所有は送信完了まで本クラスへ移る）
+     * @param buffer acquireTxBuffer()で取得したバッファ
+     * @param length 送信長
+     * @return esp_err_t 送信結果（失敗時もバッファは空きに戻る）
+     */
+    esp_err_t submitTx(uint8_t* buffer, size_t length);
+    
+    /**
+     * @brief 送信せずに送信バッファを返す
+     * @param buffer acquireTxBuffer()で取得したバッファ
+     */
+    void releaseTxBuffer(uint8_t* buffer);
+    
+    /**
+     * @brief 送信バッファ1つのサイズ取得
+     * @return size_t サイズ
+     */
+    size_t getTxBufferSize() const { return dma_config_.tx_buffer_size; }
+    
+    /**
+     * @brief 全送信の完了待機
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 待機結果
+     */
+    esp_err_t waitTxDone(TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 受信ブロック取得
+     * @param block 受信ブロック格納先
+     * @param timeout タイムアウト時間
+     * @return bool 取得できた場合true
+     */
+    bool receive(RxBlock& block, TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 受信ブロックの返却（最後のブロックを返すとバッファが空きに戻る）
+     * @param block receive()で取得したブロック
+     */
+    void releaseRx(const RxBlock& block);
+    
+    /**
+     * @brief 転送統計取得
+     * @return Stats 転送統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 転送統計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief UARTポート番号取得
+     * @return uart_port_t UARTポート番号
+     */
+    uart_port_t getPort() const { return config_.port; }
+    
+private:
+#if HAL_UART_UHCI_ENABLED
+    static bool IRAM_ATTR onTxDone(uhci_controller_handle_t controller, const uhci_tx_done_event_data_t* event, 
+                                   void* context);
+    static bool IRAM_ATTR onRxEvent(uhci_controller_handle_t controller, const uhci_rx_event_data_t* event, 
+                                    void* context);
+    
+    uhci_controller_handle_t controller_;   // UHCIコントローラ
+#endif
+    
+    /**
+     * @brief 空きの受信バッファがあり、受信中のバッファがなければ登録する
+     */
+    void armRx();
+    
+    /**
+     * @brief DMAバッファとキューの確保
+     */
+    esp_err_t allocateBuffers();
+    
+    /**
+     * @brief コントローラ・DMAバッファ・キューの解放
+     */
+    void release();
+    
+    UartHal::Config config_;                // UART回線設定
+    DmaConfig dma_config_;                  // DMA設定
+    std::vector<uint8_t*> buffers_;         // DMAバッファ（送信・受信）
+    QueueHandle_t tx_free_;                 // 空きの送信バッファ
+    QueueHandle_t rx_free_;                 // 空きの受信バッファ
+    QueueHandle_t rx_ready_;                // 受信済みブロック
+    std::atomic<uint8_t*> rx_armed_;        // 受信中のバッファ（なしはnullptr）
+    
+    std::atomic<uint32_t> tx_bytes_;
+    std::atomic<uint32_t> tx_transfers_;
+    std::atomic<uint32_t> tx_errors_;
+    std::atomic<uint32_t> rx_bytes_;
+    std::atomic<uint32_t> rx_blocks_;
+    std::atomic<uint32_t> rx_dropped_;
+    std::atomic<uint32_t> rx_starved_;
+};
+
+} // namespace hal
+
+#endif // UART_DMA_HAL_HPP
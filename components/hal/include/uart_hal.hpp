@@ -14,12 +14,13 @@
 #define UART_HAL_HPP
 
 #include "hal_base.hpp"
+#include "delegate.hpp"
 #include "driver/uart.h"
+#include <atomic>
 #include <vector>
 #include <string>
 #include <memory>
 #include <mutex>
-#include <functional>
 
 namespace hal {
 
@@ -28,9 +29,12 @@ namespace hal {
  * 
  * UART通信の抽象化レイヤー
  * ESP-IDF UART APIのC++ラッパー
+ * （ログのダンプ等の大容量の連続転送はDMAバッファを直接受け渡すUartDmaHalを使う）
  */
 class UartHal : public HalBase {
 public:
+    static constexpr uint32_t EVENT_TASK_STACK_SIZE = 2048;    // イベントタスクのスタックサイズ
+    
     /**
      * @brief UARTパリティ列挙型
      */
@@ -93,10 +97,33 @@ public:
     };
 
     /**
-     * @brief イベントコールバック関数型
+     * @brief イベントコールバック関数型（ヒープ確保なしの固定サイズデリゲート）
      */
-    using EventCallback = std::function<void(EventType type, size_t size)>;
+    using EventCallback = common::Delegate<void(EventType type, size_t size)>;
 
+    /**
+     * @brief フレーム受信コールバック関数型（イベントタスクコンテキスト）
+     * 
+     * frameはコールバック中のみ有効（内部フレームバッファを直接参照）
+     */
+    using FrameCallback = void (*)(const uint8_t* frame, size_t length, void* context);
+    
+    /**
+     * @brief 受信リングの連続読み出し領域
+     */
+    struct RxRegion {
+        const uint8_t* data;        // 先頭アドレス（リング内部を直接参照）
+        size_t length;              // 連続して読めるバイト数
+    };
+    
+    /**
+     * @brief トレースポイント番号（HalBase::getTraceStats()の引数）
+     */
+    enum TracePoint : size_t {
+        TRACE_WRITE = 0,    // 送信（ドライババッファへの投入）
+        TRACE_READ          // 受信（待ち時間を含む）
+    };
+    
 public:
     /**
      * @brief コンストラクタ
@@ -153,6 +180,15 @@ public:
      * @return esp_err_t 送信結果
      */
     esp_err_t write(const std::vector<uint8_t>& data, TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief データ送信（コピーなし）
+     * @param data 送信データ
+     * @param length 送信長
+     * @param timeout タイムアウト時間
+     * @return esp_err_t 送信結果
+     */
+    esp_err_t write(const void* data, size_t length, TickType_t timeout = portMAX_DELAY);
 
     /**
      * @brief 文字列送信
@@ -244,6 +280,53 @@ public:
      */
     esp_err_t setEventCallback(EventCallback callback);
 
+    /**
+     * @brief ゼロコピー受信リング有効化
+     * 
+     * イベントタスクがドライバから受信データをリングへ直接読み込み、
+     * 利用側はpeekRx()/consumeRx()でリング内の連続領域をコピーせずに参照する
+     * @param capacity リング容量（2のべき乗）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t enableRxRing(size_t capacity);
+    
+    /**
+     * @brief 受信リングの読み出し可能な連続領域取得
+     * 
+     * リング末尾で折り返す場合は前半のみを返す。consumeRx()後に再度呼び出すと残りを取得できる
+     * @return RxRegion 連続領域（データなしの場合length=0）
+     */
+    RxRegion peekRx() const;
+    
+    /**
+     * @brief 受信リングの読み出し完了通知
+     * 
+     * リングが満杯でドライバに受信データが残っている場合は、イベントタスクへ転送の再開を要求する
+     * @param length 消費したバイト数
+     */
+    void consumeRx(size_t length);
+    
+    /**
+     * @brief 受信リングが満杯だった回数取得
+     * @return uint32_t 回数
+     */
+    uint32_t getRxOverflowCount() const { return rx_overflow_count_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 区切り文字によるフレーム受信コールバック設定
+     * 
+     * パターン検出割り込みで区切り文字の位置を取得し、1フレーム分をまとめて
+     * 内部フレームバッファへ読み出してコールバックへ渡す（区切り文字は含まない）。
+     * 有効中は受信リングへのデータ転送は行わない
+     * @param delimiter 区切り文字
+     * @param callback コールバック関数（nullptrで無効化）
+     * @param context コールバック引数
+     * @param max_frame_size 最大フレーム長（区切り文字含む）
+     * @return esp_err_t 設定結果
+     */
+    esp_err_t setFrameCallback(char delimiter, FrameCallback callback, void* context,  
+                               size_t max_frame_size = 256);
+    
     /**
      * @brief RS485モード設定
      * @param enable RS485モード有効化
@@ -259,6 +342,12 @@ public:
      */
     uart_port_t getPort() const { return config_.port; }
 
+    /**
+     * @brief イベントタスク取得（ResourceMonitorへの登録用）
+     * @return TaskHandle_t イベントタスク（未作成の場合nullptr）
+     */
+    TaskHandle_t getEventTask() const { return event_task_; }
+
 private:
     Config config_;                 // UART設定
     std::mutex mutex_;              // スレッドセーフ用ミューテックス
@@ -267,11 +356,40 @@ private:
     EventCallback event_callback_;  // イベントコールバック
     TaskHandle_t event_task_;       // イベントタスクハンドル
     
+    std::unique_ptr<uint8_t[]> rx_ring_;    // ゼロコピー受信リング
+    size_t rx_ring_capacity_;               // 受信リング容量
+    std::atomic<size_t> rx_head_;           // 書き込み位置（イベントタスクのみ更新）
+    std::atomic<size_t> rx_tail_;           // 読み出し位置（利用側のみ更新）
+    std::atomic<uint32_t> rx_overflow_count_;   // 受信リング満杯回数
+    std::atomic<bool> rx_stalled_;          // 満杯でドライバに受信データを残している（consumeRx()で再開）
+    
+    static constexpr uart_event_type_t RX_RING_RESUME = UART_EVENT_MAX; // 受信リングの転送再開（内部イベント）
+    
+    std::unique_ptr<uint8_t[]> frame_buffer_;   // フレームバッファ
+    size_t frame_buffer_size_;              // フレームバッファサイズ
+    FrameCallback frame_callback_;          // フレーム受信コールバック
+    void* frame_context_;                   // フレーム受信コールバック引数
+    
     /**
      * @brief イベントタスク
      * @param arg 引数（UartHalインスタンス）
      */
     static void eventTask(void* arg);
+    
+    /**
+     * @brief イベントタスクが必要な場合に作成
+     */
+    void ensureEventTask();
+    
+    /**
+     * @brief ドライバの受信データを受信リングへ転送
+     */
+    void fillRxRing();
+    
+    /**
+     * @brief パターン検出位置までを1フレームとして読み出しコールバック実行
+     */
+    void readFrame();
 };
 
 } // namespace hal
@@ -10,31 +10,51 @@
  */
 
 #include "adc_hal.hpp"
+#include "online_stats.hpp"
 #include "esp_log.h"
 #include <algorithm>
-#include <numeric>
+#include <cmath>
+#include <cstring>
 
 namespace hal {
 
 AdcHal::AdcHal(Unit unit) 
     : HalBase("ADC_HAL")
     , adc_handle_(nullptr)
-    , nvs_initialized_(false) {
+    , continuous_handle_(nullptr)
+    , continuous_task_(nullptr)
+    , continuous_running_(false)
+    , continuous_stop_request_(false)
+    , continuous_overflow_count_(0) {
     config_.unit = unit;
     config_.bit_width = BitWidth::WIDTH_DEFAULT;
     config_.default_vref = 1100; // デフォルト1100mV
     
+    for (auto& ch : continuous_channels_) {
+        ch.raw_value.store(0, std::memory_order_relaxed);
+        ch.sequence.store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < MAX_CHANNELS; i++) {
+        calibration_handles_[i] = nullptr;
+        filter_values_[i].store(NAN, std::memory_order_relaxed);
+    }
+    
+    registerTracePoint(TRACE_READ, "read");
+    
     logDebug("ADC HALクラス作成 ユニット:%d", static_cast<int>(unit));
 }
 
 AdcHal::~AdcHal() {
+    // 連続変換を停止
+    stopContinuous();
+    
     // キャリブレーションハンドルを解放
-    for (auto& pair : calibration_handles_) {
-        if (pair.second) {
-            adc_cali_delete_scheme_curve_fitting(pair.second);
+    for (auto& handle : calibration_handles_) {
+        if (handle) {
+            adc_cali_delete_scheme_curve_fitting(handle);
+            handle = nullptr;
         }
     }
-    calibration_handles_.clear();
     
     // ADCハンドルを解放
     if (adc_handle_) {
@@ -97,6 +117,7 @@ esp_err_t AdcHal::start() {
 }
 
 esp_err_t AdcHal::stop() {
+    stopContinuous();
     setState(State::SUSPENDED);
     logInfo("ADC HAL停止");
     return ESP_OK;
@@ -104,7 +125,9 @@ esp_err_t AdcHal::stop() {
 
 esp_err_t AdcHal::reset() {
     // フィルタ値をクリア
-    filter_values_.clear();
+    for (auto& value : filter_values_) {
+        value.store(NAN, std::memory_order_relaxed);
+    }
     
     setState(State::INITIALIZED);
     logInfo("ADC HALリセット完了");
@@ -165,30 +188,29 @@ esp_err_t AdcHal::read(adc_channel_t channel, ReadResult& result) {
         return ESP_ERR_INVALID_STATE;
     }
     
+    if (!inTableRange(channel)) {
+        logError("無効なチャンネル: %d", channel);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 連続変換中は最新値を返す（ワンショット変換はユニットを共有できない）
+    if (isContinuousRunning()) {
+        return getLatest(channel, result);
+    }
+    
     std::lock_guard<std::mutex> lock(mutex_);
     
     // 生のADC値を読み取り
+    uint32_t trace_start = traceBegin();
     esp_err_t ret = adc_oneshot_read(adc_handle_, channel, &result.raw_value);
+    traceEnd(TRACE_READ, trace_start, ret);
     if (ret != ESP_OK) {
         logError("ADC読み取り失敗 チャンネル:%d: %s", channel, esp_err_to_name(ret));
         return ret;
     }
     
     // 電圧値に変換
-    result.calibrated = false;
-    auto cal_it = calibration_handles_.find(channel);
-    if (cal_it != calibration_handles_.end() && cal_it->second) {
-        ret = adc_cali_raw_to_voltage(cal_it->second, result.raw_value, &result.voltage_mv);
-        if (ret == ESP_OK) {
-            result.calibrated = true;
-        } else {
-            // キャリブレーション失敗時は推定値を使用
-            result.voltage_mv = (result.raw_value * config_.default_vref) / 4095;
-        }
-    } else {
-        // キャリブレーションなしの場合は推定値
-        result.voltage_mv = (result.raw_value * config_.default_vref) / 4095;
-    }
+    result.calibrated = rawToVoltage(channel, result.raw_value, result.voltage_mv);
     
     logDebug("ADC読み取り チャンネル:%d 生値:%d 電圧:%dmV キャリブレーション:%s",
              channel, result.raw_value, result.voltage_mv, 
@@ -226,42 +248,44 @@ esp_err_t AdcHal::readAverage(adc_channel_t channel, size_t samples, ReadResult&
         return ESP_ERR_INVALID_ARG;
     }
     
-    std::vector<int> raw_values;
-    raw_values.reserve(samples);
+    if (!inTableRange(channel)) {
+        logError("無効なチャンネル: %d", channel);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 連続変換中はフレーム平均済みの最新値を返す（ブロックしない）
+    if (isContinuousRunning()) {
+        return getLatest(channel, result);
+    }
+    
+    // サンプルは保持せず逐次に平均・ばらつきを集計する
+    common::RunningStats<float> stats;
     
     // 複数サンプル取得
     for (size_t i = 0; i < samples; i++) {
         int raw_value;
+        uint32_t trace_start = traceBegin();
         esp_err_t ret = adc_oneshot_read(adc_handle_, channel, &raw_value);
+        traceEnd(TRACE_READ, trace_start, ret);
         if (ret != ESP_OK) {
             logError("ADC読み取り失敗 サンプル:%zu/%zu", i, samples);
             return ret;
         }
-        raw_values.push_back(raw_value);
+        stats.add(static_cast<float>(raw_value));
         
         // サンプル間の短い遅延
         vTaskDelay(1 / portTICK_PERIOD_MS);
     }
     
     // 平均値計算
-    result.raw_value = std::accumulate(raw_values.begin(), raw_values.end(), 0) / samples;
+    result.raw_value = static_cast<int>(std::lround(stats.mean()));
     
     // 電圧値に変換
-    result.calibrated = false;
-    auto cal_it = calibration_handles_.find(channel);
-    if (cal_it != calibration_handles_.end() && cal_it->second) {
-        esp_err_t ret = adc_cali_raw_to_voltage(cal_it->second, result.raw_value, &result.voltage_mv);
-        if (ret == ESP_OK) {
-            result.calibrated = true;
-        } else {
-            result.voltage_mv = (result.raw_value * config_.default_vref) / 4095;
-        }
-    } else {
-        result.voltage_mv = (result.raw_value * config_.default_vref) / 4095;
-    }
+    result.calibrated = rawToVoltage(channel, result.raw_value, result.voltage_mv);
     
-    logDebug("ADC平均読み取り チャンネル:%d サンプル数:%zu 平均値:%d 電圧:%dmV",
-             channel, samples, result.raw_value, result.voltage_mv);
+    logDebug("ADC平均読み取り チャンネル:%d サンプル数:%zu 平均値:%d 電圧:%dmV 標準偏差:%.1f 範囲:%d〜%d",
+             channel, samples, result.raw_value, result.voltage_mv, static_cast<double>(stats.stddev()), 
+             static_cast<int>(stats.min()), static_cast<int>(stats.max()));
     
     return ESP_OK;
 }
@@ -283,31 +307,249 @@ esp_err_t AdcHal::readFiltered(adc_channel_t channel, float alpha, ReadResult& r
         return ret;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // 指数移動平均フィルタ
-    auto it = filter_values_.find(channel);
-    if (it != filter_values_.end()) {
+    // 指数移動平均フィルタ（チャンネル毎の状態はロックフリー、同一チャンネルは単一タスクから呼び出すこと）
+    std::atomic<float>& state = filter_values_[channel];
+    float previous = state.load(std::memory_order_relaxed);
+    if (!std::isnan(previous)) {
         // フィルタ値更新: new_value = alpha * current + (1 - alpha) * previous
-        float filtered = alpha * result.raw_value + (1.0f - alpha) * it->second;
-        it->second = filtered;
+        float filtered = alpha * result.raw_value + (1.0f - alpha) * previous;
+        state.store(filtered, std::memory_order_relaxed);
         result.raw_value = static_cast<int>(filtered);
         
         // フィルタ後の電圧値を再計算
-        auto cal_it = calibration_handles_.find(channel);
-        if (cal_it != calibration_handles_.end() && cal_it->second) {
-            adc_cali_raw_to_voltage(cal_it->second, result.raw_value, &result.voltage_mv);
-        } else {
-            result.voltage_mv = (result.raw_value * config_.default_vref) / 4095;
-        }
+        result.calibrated = rawToVoltage(channel, result.raw_value, result.voltage_mv);
     } else {
         // 初回はフィルタなし
-        filter_values_[channel] = static_cast<float>(result.raw_value);
+        state.store(static_cast<float>(result.raw_value), std::memory_order_relaxed);
     }
     
     return ESP_OK;
 }
 
+esp_err_t AdcHal::startContinuous(const ContinuousConfig& config) {
+    if (!isInitialized()) {
+        logError("ADC HALが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (isContinuousRunning()) {
+        return ESP_OK;
+    }
+    
+    if (channels_.empty() || channels_.size() > SOC_ADC_PATT_LEN_MAX) {
+        logError("連続変換のチャンネル数が不正: %zu", channels_.size());
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (config.frame_size == 0 || config.frame_size % SOC_ADC_DIGI_RESULT_BYTES != 0 || 
+        config.buffer_size < config.frame_size) {
+        logError("無効な連続変換設定 フレーム:%lu バッファ:%lu",  
+                 static_cast<unsigned long>(config.frame_size),  
+                 static_cast<unsigned long>(config.buffer_size));
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    adc_continuous_handle_cfg_t handle_config = {};
+    handle_config.max_store_buf_size = config.buffer_size;
+    handle_config.conv_frame_size = config.frame_size;
+    
+    esp_err_t ret = adc_continuous_new_handle(&handle_config, &continuous_handle_);
+    if (ret != ESP_OK) {
+        logError("連続変換ハンドル作成失敗: %s", esp_err_to_name(ret));
+        continuous_handle_ = nullptr;
+        return ret;
+    }
+    
+    // 設定済みチャンネルから変換パターンを作成
+    adc_digi_pattern_config_t patterns[SOC_ADC_PATT_LEN_MAX] = {};
+    size_t pattern_count = 0;
+    for (const auto& pair : channels_) {
+        adc_digi_pattern_config_t& pattern = patterns[pattern_count++];
+        pattern.atten = static_cast<uint8_t>(pair.second.attenuation);
+        pattern.channel = static_cast<uint8_t>(pair.first);
+        pattern.unit = static_cast<uint8_t>(config_.unit);
+        pattern.bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    
+    adc_continuous_config_t dig_config = {};
+    dig_config.pattern_num = pattern_count;
+    dig_config.adc_pattern = patterns;
+    dig_config.sample_freq_hz = config.sample_freq_hz;
+    dig_config.conv_mode = (config_.unit == Unit::UNIT_1) ? ADC_CONV_SINGLE_UNIT_1 : ADC_CONV_SINGLE_UNIT_2;
+    dig_config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+    
+    ret = adc_continuous_config(continuous_handle_, &dig_config);
+    if (ret != ESP_OK) {
+        logError("連続変換設定失敗: %s", esp_err_to_name(ret));
+        adc_continuous_deinit(continuous_handle_);
+        continuous_handle_ = nullptr;
+        return ret;
+    }
+    
+    adc_continuous_evt_cbs_t callbacks = {};
+    callbacks.on_conv_done = onConversionDone;
+    callbacks.on_pool_ovf = onPoolOverflow;
+    ret = adc_continuous_register_event_callbacks(continuous_handle_, &callbacks, this);
+    if (ret != ESP_OK) {
+        logError("連続変換コールバック登録失敗: %s", esp_err_to_name(ret));
+        adc_continuous_deinit(continuous_handle_);
+        continuous_handle_ = nullptr;
+        return ret;
+    }
+    
+    // フレーム読み出しバッファは開始時に一度だけ確保
+    continuous_frame_.assign(config.frame_size, 0);
+    for (auto& ch : continuous_channels_) {
+        ch.sequence.store(0, std::memory_order_relaxed);
+    }
+    continuous_overflow_count_.store(0, std::memory_order_relaxed);
+    continuous_stop_request_.store(false, std::memory_order_relaxed);
+    
+    BaseType_t result = xTaskCreate(continuousTask, "adc_cont_task", 3072, this,  
+                                    config.task_priority, &continuous_task_);
+    if (result != pdPASS) {
+        logError("連続変換処理タスク作成失敗");
+        continuous_task_ = nullptr;
+        adc_continuous_deinit(continuous_handle_);
+        continuous_handle_ = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    ret = adc_continuous_start(continuous_handle_);
+    if (ret != ESP_OK) {
+        logError("連続変換開始失敗: %s", esp_err_to_name(ret));
+        continuous_stop_request_.store(true, std::memory_order_release);
+        xTaskNotifyGive(continuous_task_);
+        while (continuous_task_ != nullptr) {
+            vTaskDelay(1);
+        }
+        adc_continuous_deinit(continuous_handle_);
+        continuous_handle_ = nullptr;
+        return ret;
+    }
+    
+    continuous_running_.store(true, std::memory_order_release);
+    logInfo("ADC連続変換開始 チャンネル数:%zu 周波数:%luHz フレーム:%luバイト",  
+            pattern_count, static_cast<unsigned long>(config.sample_freq_hz),  
+            static_cast<unsigned long>(config.frame_size));
+    return ESP_OK;
+}
+
+esp_err_t AdcHal::stopContinuous() {
+    if (continuous_handle_ == nullptr) {
+        return ESP_OK;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    continuous_running_.store(false, std::memory_order_release);
+    esp_err_t ret = adc_continuous_stop(continuous_handle_);
+    if (ret != ESP_OK) {
+        logWarning("連続変換停止警告: %s", esp_err_to_name(ret));
+    }
+    
+    // 処理タスクの終了を待つ（読み出し途中での削除を避ける）
+    if (continuous_task_ != nullptr) {
+        continuous_stop_request_.store(true, std::memory_order_release);
+        xTaskNotifyGive(continuous_task_);
+        while (continuous_task_ != nullptr) {
+            vTaskDelay(1);
+        }
+    }
+    
+    adc_continuous_deinit(continuous_handle_);
+    continuous_handle_ = nullptr;
+    
+    logInfo("ADC連続変換停止");
+    return ret;
+}
+
+esp_err_t AdcHal::getLatest(adc_channel_t channel, ReadResult& result) {
+    if (!inTableRange(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const ContinuousChannel& ch = continuous_channels_[channel];
+    if (ch.sequence.load(std::memory_order_acquire) == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    result.raw_value = ch.raw_value.load(std::memory_order_relaxed);
+    result.calibrated = rawToVoltage(channel, result.raw_value, result.voltage_mv);
+    
+    return ESP_OK;
+}
+
+bool IRAM_ATTR AdcHal::onConversionDone(adc_continuous_handle_t handle,  
+                                        const adc_continuous_evt_data_t* edata, void* user_data) {
+    AdcHal* self = static_cast<AdcHal*>(user_data);
+    TaskHandle_t task = self->continuous_task_;
+    if (task == nullptr) {
+        return false;
+    }
+    
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+    return higher_priority_task_woken == pdTRUE;
+}
+
+bool IRAM_ATTR AdcHal::onPoolOverflow(adc_continuous_handle_t handle,  
+                                      const adc_continuous_evt_data_t* edata, void* user_data) {
+    AdcHal* self = static_cast<AdcHal*>(user_data);
+    self->continuous_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AdcHal::continuousTask(void* arg) {
+    AdcHal* self = static_cast<AdcHal*>(arg);
+    uint8_t* frame = self->continuous_frame_.data();
+    uint32_t frame_size = static_cast<uint32_t>(self->continuous_frame_.size());
+    
+    while (!self->continuous_stop_request_.load(std::memory_order_acquire)) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // 溜まっているフレームを全て処理
+        uint32_t length = 0;
+        while (!self->continuous_stop_request_.load(std::memory_order_acquire) && 
+               adc_continuous_read(self->continuous_handle_, frame, frame_size, &length, 0) == ESP_OK) {
+            self->processFrame(frame, length);
+        }
+    }
+    
+    self->continuous_task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void AdcHal::processFrame(const uint8_t* data, uint32_t length) {
+    uint32_t sums[MAX_CHANNELS] = {};
+    uint16_t counts[MAX_CHANNELS] = {};
+    const uint32_t unit = static_cast<uint32_t>(config_.unit);
+    
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        adc_digi_output_data_t sample;
+        memcpy(&sample, data + i, sizeof(sample));
+        
+        uint32_t channel = sample.type2.channel;
+        if (sample.type2.unit != unit || channel >= MAX_CHANNELS) {
+            continue;
+        }
+        sums[channel] += sample.type2.data;
+        counts[channel]++;
+    }
+    
+    // フレーム内平均（デシメーション）を最新値として公開
+    for (size_t channel = 0; channel < MAX_CHANNELS; channel++) {
+        if (counts[channel] == 0) {
+            continue;
+        }
+        ContinuousChannel& ch = continuous_channels_[channel];
+        ch.raw_value.store(static_cast<int32_t>(sums[channel] / counts[channel]), std::memory_order_relaxed);
+        ch.sequence.fetch_add(1, std::memory_order_release);
+    }
+}
+
 esp_err_t AdcHal::setAttenuation(adc_channel_t channel, Attenuation attenuation) {
     auto it = channels_.find(channel);
     if (it == channels_.end()) {
@@ -354,9 +596,12 @@ esp_err_t AdcHal::calibrateAll() {
 }
 
 esp_err_t AdcHal::convertToVoltage(adc_channel_t channel, int raw_value, int& voltage_mv) {
-    auto cal_it = calibration_handles_.find(channel);
-    if (cal_it != calibration_handles_.end() && cal_it->second) {
-        return adc_cali_raw_to_voltage(cal_it->second, raw_value, &voltage_mv);
+    if (!inTableRange(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (calibration_handles_[channel]) {
+        return adc_cali_raw_to_voltage(calibration_handles_[channel], raw_value, &voltage_mv);
     } else {
         // キャリブレーションなしの場合は推定値
         voltage_mv = (raw_value * config_.default_vref) / 4095;
@@ -374,6 +619,10 @@ bool AdcHal::isValidChannel(adc_channel_t channel) const {
 }
 
 esp_err_t AdcHal::createCalibrationHandle(adc_channel_t channel, Attenuation attenuation) {
+    if (!inTableRange(channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
     // 既存のハンドルを削除
     destroyCalibrationHandle(channel);
     
@@ -398,11 +647,21 @@ esp_err_t AdcHal::createCalibrationHandle(adc_channel_t channel, Attenuation att
 }
 
 void AdcHal::destroyCalibrationHandle(adc_channel_t channel) {
-    auto it = calibration_handles_.find(channel);
-    if (it != calibration_handles_.end() && it->second) {
-        adc_cali_delete_scheme_curve_fitting(it->second);
-        calibration_handles_.erase(it);
+    if (inTableRange(channel) && calibration_handles_[channel]) {
+        adc_cali_delete_scheme_curve_fitting(calibration_handles_[channel]);
+        calibration_handles_[channel] = nullptr;
     }
 }
 
+bool AdcHal::rawToVoltage(adc_channel_t channel, int raw_value, int& voltage_mv) const {
+    adc_cali_handle_t handle = calibration_handles_[channel];
+    if (handle && adc_cali_raw_to_voltage(handle, raw_value, &voltage_mv) == ESP_OK) {
+        return true;
+    }
+    
+    // キャリブレーションなし、または失敗時は推定値
+    voltage_mv = (raw_value * static_cast<int>(config_.default_vref)) / 4095;
+    return false;
+}
+
 } // namespace hal
\ No newline at end of file
@@ -0,0 +1,489 @@
+/*
+ * Control Tick Implementation
+ * 
+ * GPTimerアラームによる制御ループのハードウェアタイミング源の実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "control_tick.hpp"
+#include "interrupt_plan.hpp"
+#include "isr_time.hpp"
+
+namespace hal {
+
+namespace {
+
+constexpr uint64_t MIN_ALARM_MARGIN = 20;   // 再設定するアラームが現在値より先であることを保証するマージン（カウント）
+
+} // namespace
+
+ControlTick::ControlTick()
+    : HalBase("CONTROL_TICK")
+    , notify_task_(nullptr)
+    , timer_(nullptr)
+    , cap_timer_(nullptr)
+    , cap_channel_(nullptr)
+    , period_counts_(0)
+    , capture_divider_(1)
+    , timer_enabled_(false)
+    , cap_enabled_(false)
+    , tick_count_(0)
+    , phase_adjust_(0)
+    , last_cap_value_(0)
+    , cap_extended_(0)
+    , offset_valid_(false)
+    , offset_(0)
+    , window_min_offset_(0)
+    , window_samples_(0)
+    , capture_count_(0)
+    , last_tick_(0)
+    , stat_ticks_(0)
+    , stat_missed_(0)
+    , stat_max_isr_(0)
+    , stat_max_wake_(0)
+    , stat_total_isr_(0)
+    , stat_total_wake_(0)
+    , stat_avg_isr_(0)
+    , stat_avg_wake_(0) {
+    
+    config_.resolution_hz = DEFAULT_RESOLUTION_HZ;
+    config_.period_us = 1000;
+    config_.capture_gpio = GPIO_NUM_NC;
+    config_.capture_rising_edge = true;
+    config_.capture_group = 1;
+    
+    logDebug("Control Tickクラス作成");
+}
+
+ControlTick::~ControlTick() {
+    if (isRunning()) {
+        stop();
+    }
+    release();
+    logDebug("Control Tickクラス破棄");
+}
+
+esp_err_t ControlTick::initialize() {
+    setState(State::INITIALIZING);
+    
+    if (config_.resolution_hz < 1000000 || config_.resolution_hz % 1000000 != 0 || config_.period_us == 0) {
+        logError("設定が不正です 分解能:%luHz 周期:%luus", 
+                 static_cast<unsigned long>(config_.resolution_hz), 
+                 static_cast<unsigned long>(config_.period_us));
+        setState(State::ERROR);
+        return ESP_ERR_INVALID_ARG;
+    }
+    period_counts_ = static_cast<uint64_t>(config_.period_us) * (config_.resolution_hz / 1000000);
+    
+    gptimer_config_t timer_config = {};
+    timer_config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+    timer_config.direction = GPTIMER_COUNT_UP;
+    timer_config.resolution_hz = config_.resolution_hz;
+    timer_config.intr_priority = InterruptPlan::priority(InterruptPlan::Source::CONTROL_TIMER);
+    
+    esp_err_t ret = gptimer_new_timer(&timer_config, &timer_);
+    if (ret != ESP_OK) {
+        logError("GPTimer作成失敗: %s", esp_err_to_name(ret));
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    gptimer_event_callbacks_t cbs = {};
+    cbs.on_alarm = alarmCallback;
+    // 有効化（電源管理ロックの取得）はstart()で行い、停止中は周波数の切替・ライトスリープを妨げない
+    // 割り込みはコールバック登録時に確保されるため、配置表の制御コアで登録する
+    const gptimer_event_callbacks_t* timer_cbs = &cbs;
+    ret = InterruptPlan::install(InterruptPlan::Source::CONTROL_TIMER, [this, timer_cbs]() {
+        return gptimer_register_event_callbacks(timer_, timer_cbs, this);
+    });
+    if (ret != ESP_OK) {
+        logError("GPTimer設定失敗: %s", esp_err_to_name(ret));
+        release();
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    if (config_.capture_gpio != GPIO_NUM_NC) {
+        ret = initializeCapture();
+        if (ret != ESP_OK) {
+            release();
+            setState(State::ERROR);
+            return ret;
+        }
+    }
+    
+    setState(State::INITIALIZED);
+    logInfo("Control Tick初期化完了 周期:%luus 分解能:%luHz キャプチャ:GPIO%d", 
+            static_cast<unsigned long>(config_.period_us), 
+            static_cast<unsigned long>(config_.resolution_hz), 
+            static_cast<int>(config_.capture_gpio));
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::initializeCapture() {
+    mcpwm_capture_timer_config_t cap_timer_config = {};
+    cap_timer_config.group_id = config_.capture_group;
+    cap_timer_config.clk_src = MCPWM_CAPTURE_CLK_SRC_DEFAULT;
+    
+    esp_err_t ret = mcpwm_new_capture_timer(&cap_timer_config, &cap_timer_);
+    if (ret != ESP_OK) {
+        logError("キャプチャタイマー作成失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    uint32_t cap_resolution = 0;
+    ret = mcpwm_capture_timer_get_resolution(cap_timer_, &cap_resolution);
+    if (ret != ESP_OK || cap_resolution % config_.resolution_hz != 0) {
+        logError("キャプチャ分解能%luHzがGPTimer分解能で割り切れません", 
+                 static_cast<unsigned long>(cap_resolution));
+        return ret != ESP_OK ? ret : ESP_ERR_INVALID_ARG;
+    }
+    capture_divider_ = cap_resolution / config_.resolution_hz;
+    
+    mcpwm_capture_channel_config_t channel_config = {};
+    channel_config.gpio_num = config_.capture_gpio;
+    channel_config.prescale = 1;
+    channel_config.flags.pos_edge = config_.capture_rising_edge;
+    channel_config.flags.neg_edge = !config_.capture_rising_edge;
+    channel_config.intr_priority = InterruptPlan::priority(InterruptPlan::Source::CONTROL_TIMER);
+    
+    ret = mcpwm_new_capture_channel(cap_timer_, &channel_config, &cap_channel_);
+    if (ret != ESP_OK) {
+        logError("キャプチャチャネル作成失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    mcpwm_capture_event_callbacks_t cbs = {};
+    cbs.on_cap = captureCallback;
+    const mcpwm_capture_event_callbacks_t* cap_cbs = &cbs;
+    ret = InterruptPlan::install(InterruptPlan::Source::CONTROL_TIMER, [this, cap_cbs]() {
+        return mcpwm_capture_channel_register_event_callbacks(cap_channel_, cap_cbs, this);
+    });
+    if (ret == ESP_OK) {
+        ret = mcpwm_capture_channel_enable(cap_channel_);
+    }
+    if (ret != ESP_OK) {
+        logError("キャプチャ設定失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logInfo("IMU INTキャプチャ設定 GPIO%d 分解能:%luHz", 
+            static_cast<int>(config_.capture_gpio), static_cast<unsigned long>(cap_resolution));
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::configure() {
+    if (!isInitialized()) {
+        logError("Control Tickが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    logInfo("Control Tick設定完了");
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::start() {
+    if (!isInitialized()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (isRunning()) {
+        return ESP_OK;
+    }
+    if (notify_task_ == nullptr) {
+        logError("通知先タスクが設定されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // ISR停止中にのみ状態を初期化する
+    tick_count_ = 0;
+    last_tick_ = 0;
+    phase_adjust_.store(0, std::memory_order_relaxed);
+    offset_valid_ = false;
+    window_samples_ = 0;
+    capture_count_.store(0, std::memory_order_relaxed);
+    
+    // タイマーの有効化で各ドライバが電源管理ロックを取得し、停止まで最大周波数を保つ
+    esp_err_t ret = gptimer_enable(timer_);
+    if (ret != ESP_OK) {
+        logError("Control Tick開始失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    timer_enabled_ = true;
+    if (cap_timer_ != nullptr) {
+        ret = mcpwm_capture_timer_enable(cap_timer_);
+        cap_enabled_ = (ret == ESP_OK);
+    }
+    if (ret == ESP_OK) {
+        ret = gptimer_set_raw_count(timer_, 0);
+    }
+    if (ret == ESP_OK) {
+        gptimer_alarm_config_t alarm_config = {};
+        alarm_config.alarm_count = period_counts_;
+        alarm_config.flags.auto_reload_on_alarm = false;
+        ret = gptimer_set_alarm_action(timer_, &alarm_config);
+    }
+    if (ret == ESP_OK) {
+        ret = gptimer_start(timer_);
+    }
+    if (ret == ESP_OK && cap_timer_ != nullptr) {
+        ret = mcpwm_capture_timer_start(cap_timer_);
+    }
+    if (ret != ESP_OK) {
+        logError("Control Tick開始失敗: %s", esp_err_to_name(ret));
+        gptimer_stop(timer_);
+        disableTimers();
+        return ret;
+    }
+    
+    setState(State::RUNNING);
+    logInfo("Control Tick開始");
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::stop() {
+    if (!isRunning()) {
+        return ESP_OK;
+    }
+    
+    gptimer_stop(timer_);
+    if (cap_timer_ != nullptr) {
+        mcpwm_capture_timer_stop(cap_timer_);
+    }
+    disableTimers();
+    
+    setState(State::INITIALIZED);
+    logInfo("Control Tick停止");
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::reset() {
+    stop();
+    
+    stat_ticks_.store(0, std::memory_order_relaxed);
+    stat_missed_.store(0, std::memory_order_relaxed);
+    stat_max_isr_.store(0, std::memory_order_relaxed);
+    stat_max_wake_.store(0, std::memory_order_relaxed);
+    stat_avg_isr_.store(0, std::memory_order_relaxed);
+    stat_avg_wake_.store(0, std::memory_order_relaxed);
+    stat_total_isr_ = 0;
+    stat_total_wake_ = 0;
+    
+    logInfo("Control Tickリセット完了");
+    return ESP_OK;
+}
+
+esp_err_t ControlTick::waitForTick(TickInfo& info, TickType_t timeout) {
+    if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    uint64_t run_count = 0;
+    gptimer_get_raw_count(timer_, &run_count);
+    
+    TickSample sample;
+    if (!tick_sample_.read(sample)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    info.tick = sample.tick;
+    info.missed = sample.tick - last_tick_ - 1;
+    info.alarm_count = sample.alarm_count;
+    info.isr_latency = static_cast<uint32_t>(sample.isr_count - sample.alarm_count);
+    info.wake_latency = static_cast<uint32_t>(run_count - sample.isr_count);
+    last_tick_ = sample.tick;
+    
+    CaptureSample capture;
+    info.capture_valid = capture_sample_.read(capture);
+    info.capture_count = info.capture_valid ? capture.edge_count : 0;
+    info.capture_phase = info.capture_valid ?
+                         static_cast<int64_t>(sample.alarm_count) - static_cast<int64_t>(capture.edge_count) : 0;
+    
+    // 統計更新（書き込みは制御タスクのみ）
+    uint32_t ticks = stat_ticks_.load(std::memory_order_relaxed) + 1;
+    stat_ticks_.store(ticks, std::memory_order_relaxed);
+    if (info.missed > 0) {
+        stat_missed_.fetch_add(info.missed, std::memory_order_relaxed);
+    }
+    if (info.isr_latency > stat_max_isr_.load(std::memory_order_relaxed)) {
+        stat_max_isr_.store(info.isr_latency, std::memory_order_relaxed);
+    }
+    if (info.wake_latency > stat_max_wake_.load(std::memory_order_relaxed)) {
+        stat_max_wake_.store(info.wake_latency, std::memory_order_relaxed);
+    }
+    stat_total_isr_ += info.isr_latency;
+    stat_total_wake_ += info.wake_latency;
+    stat_avg_isr_.store(static_cast<uint32_t>(stat_total_isr_ / ticks), std::memory_order_relaxed);
+    stat_avg_wake_.store(static_cast<uint32_t>(stat_total_wake_ / ticks), std::memory_order_relaxed);
+    
+    return ESP_OK;
+}
+
+int32_t ControlTick::alignToCapture(const TickInfo& info, uint32_t offset_us) {
+    if (!info.capture_valid || period_counts_ == 0) {
+        return 0;
+    }
+    
+    const int64_t period = static_cast<int64_t>(period_counts_);
+    const int64_t target = static_cast<int64_t>(offset_us) * (config_.resolution_hz / 1000000);
+    
+    // エッジからティックまでの位相を1周期内に正規化し、目標との差を±半周期へ折り返す
+    int64_t phase = info.capture_phase % period;
+    if (phase < 0) {
+        phase += period;
+    }
+    int64_t error = phase - target;
+    if (error > period / 2) {
+        error -= period;
+    } else if (error <= -period / 2) {
+        error += period;
+    }
+    
+    // 位相が目標より大きい（ティックが遅い）場合は次のアラームを早める
+    int64_t adjust = -error;
+    const int64_t limit = period / 4;
+    if (adjust > limit) {
+        adjust = limit;
+    } else if (adjust < -limit) {
+        adjust = -limit;
+    }
+    
+    adjustPhase(static_cast<int32_t>(adjust));
+    return static_cast<int32_t>(adjust);
+}
+
+void ControlTick::getStats(Stats& stats) const {
+    stats.ticks = stat_ticks_.load(std::memory_order_relaxed);
+    stats.missed = stat_missed_.load(std::memory_order_relaxed);
+    stats.max_isr_latency = stat_max_isr_.load(std::memory_order_relaxed);
+    stats.avg_isr_latency = stat_avg_isr_.load(std::memory_order_relaxed);
+    stats.max_wake_latency = stat_max_wake_.load(std::memory_order_relaxed);
+    stats.avg_wake_latency = stat_avg_wake_.load(std::memory_order_relaxed);
+    stats.captures = capture_count_.load(std::memory_order_relaxed);
+}
+
+void ControlTick::dumpStats() const {
+    Stats stats;
+    getStats(stats);
+    
+    const uint32_t counts_per_us = config_.resolution_hz / 1000000;
+    logInfo("ティック:%lu 取りこぼし:%lu キャプチャ:%lu", 
+            static_cast<unsigned long>(stats.ticks), 
+            static_cast<unsigned long>(stats.missed), 
+            static_cast<unsigned long>(stats.captures));
+    logInfo("ISR遅延(平均/最大):%lu/%lu 起床遅延(平均/最大):%lu/%lu（1/%luμs単位）", 
+            static_cast<unsigned long>(stats.avg_isr_latency), 
+            static_cast<unsigned long>(stats.max_isr_latency), 
+            static_cast<unsigned long>(stats.avg_wake_latency), 
+            static_cast<unsigned long>(stats.max_wake_latency), 
+            static_cast<unsigned long>(counts_per_us));
+}
+
+esp_err_t ControlTick::getCount(uint64_t& count) const {
+    if (timer_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return gptimer_get_raw_count(timer_, &count);
+}
+
+void ControlTick::disableTimers() {
+    if (cap_timer_ != nullptr && cap_enabled_) {
+        mcpwm_capture_timer_disable(cap_timer_);
+    }
+    cap_enabled_ = false;
+    if (timer_ != nullptr && timer_enabled_) {
+        gptimer_disable(timer_);
+    }
+    timer_enabled_ = false;
+}
+
+void ControlTick::release() {
+    if (cap_channel_ != nullptr) {
+        mcpwm_capture_channel_disable(cap_channel_);
+        mcpwm_del_capture_channel(cap_channel_);
+        cap_channel_ = nullptr;
+    }
+    if (cap_timer_ != nullptr) {
+        mcpwm_del_capture_timer(cap_timer_);
+        cap_timer_ = nullptr;
+    }
+    if (timer_ != nullptr) {
+        gptimer_del_timer(timer_);
+        timer_ = nullptr;
+    }
+}
+
+bool IRAM_ATTR ControlTick::alarmCallback(gptimer_handle_t timer, 
+                                          const gptimer_alarm_event_data_t* edata, 
+                                          void* user_data) {
+    common::IsrTime::Scope isr_time;
+    ControlTick* self = static_cast<ControlTick*>(user_data);
+    
+    // 次のアラーム = 今回の予定値 + 周期 + 位相補正（遅れている場合は周期単位で先へ送る）
+    int64_t adjust = self->phase_adjust_.exchange(0, std::memory_order_relaxed);
+    uint64_t next = static_cast<uint64_t>(static_cast<int64_t>(edata->alarm_value + self->period_counts_) + adjust);
+    while (next < edata->count_value + MIN_ALARM_MARGIN) {
+        next += self->period_counts_;
+        self->tick_count_++;
+    }
+    
+    gptimer_alarm_config_t alarm_config = {};
+    alarm_config.alarm_count = next;
+    gptimer_set_alarm_action(timer, &alarm_config);
+    
+    self->tick_count_++;
+    TickSample sample;
+    sample.tick = self->tick_count_;
+    sample.alarm_count = edata->alarm_value;
+    sample.isr_count = edata->count_value;
+    self->tick_sample_.write(sample);
+    
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(self->notify_task_, &woken);
+    return woken == pdTRUE;
+}
+
+bool IRAM_ATTR ControlTick::captureCallback(mcpwm_cap_channel_handle_t channel, 
+                                            const mcpwm_capture_event_data_t* edata, 
+                                            void* user_data) {
+    common::IsrTime::Scope isr_time;
+    ControlTick* self = static_cast<ControlTick*>(user_data);
+    
+    uint64_t now = 0;
+    gptimer_get_raw_count(self->timer_, &now);
+    
+    // 32bitキャプチャ値を64bitへ拡張（80MHzで約53秒以内に次のエッジがある前提）
+    if (self->capture_count_.load(std::memory_order_relaxed) == 0) {
+        self->cap_extended_ = edata->cap_value;
+    } else {
+        self->cap_extended_ += static_cast<uint32_t>(edata->cap_value - self->last_cap_value_);
+    }
+    self->last_cap_value_ = edata->cap_value;
+    
+    // 割り込み遅延は差を大きくする方向にしか働かないため、窓内の最小値をオフセットとする
+    int64_t converted = static_cast<int64_t>(self->cap_extended_ / self->capture_divider_);
+    int64_t candidate = static_cast<int64_t>(now) - converted;
+    if (self->window_samples_ == 0 || candidate < self->window_min_offset_) {
+        self->window_min_offset_ = candidate;
+    }
+    self->window_samples_++;
+    if (!self->offset_valid_) {
+        self->offset_ = self->window_min_offset_;
+    }
+    if (self->window_samples_ >= OFFSET_WINDOW) {
+        self->offset_ = self->window_min_offset_;
+        self->offset_valid_ = true;
+        self->window_samples_ = 0;
+    }
+    
+    CaptureSample sample;
+    sample.edge_count = static_cast<uint64_t>(converted + self->offset_);
+    self->capture_sample_.write(sample);
+    self->capture_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+} // namespace hal
@@ -0,0 +1,194 @@
+/*
+ * Deferred Log Implementation
+ * 
+ * 遅延フォーマットのバイナリログリング実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "deferred_log.hpp"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include <cstdio>
+
+namespace hal {
+
+static const char* TAG = "hal::DeferredLog";
+
+DeferredLog::Record DeferredLog::ring_[RING_SIZE];
+size_t DeferredLog::head_ = 0;
+size_t DeferredLog::tail_ = 0;
+portMUX_TYPE DeferredLog::spinlock_ = portMUX_INITIALIZER_UNLOCKED;
+std::atomic<uint32_t> DeferredLog::dropped_count_{0};
+TaskHandle_t DeferredLog::task_handle_ = nullptr;
+std::atomic<bool> DeferredLog::stop_requested_{false};
+
+esp_err_t DeferredLog::start(UBaseType_t priority, uint32_t stack_size) {
+    if (task_handle_ != nullptr) {
+        return ESP_OK;
+    }
+    
+    stop_requested_.store(false);
+    BaseType_t ret = xTaskCreate(drainTask, "deferred_log", stack_size, nullptr, priority, &task_handle_);
+    if (ret != pdPASS) {
+        task_handle_ = nullptr;
+        ESP_LOGE(TAG, "遅延ログタスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void DeferredLog::stop() {
+    if (task_handle_ == nullptr) {
+        return;
+    }
+    
+    stop_requested_.store(true);
+    while (task_handle_ != nullptr) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+void IRAM_ATTR DeferredLog::submit(const Record& record) {
+    uint32_t timestamp_ms = static_cast<uint32_t>(esp_timer_get_time() / 1000);
+    bool stored = false;
+    
+    portENTER_CRITICAL_SAFE(&spinlock_);
+    if (head_ - tail_ < RING_SIZE) {
+        Record& slot = ring_[head_ & (RING_SIZE - 1)];
+        slot = record;
+        slot.timestamp_ms = timestamp_ms;
+        head_++;
+        stored = true;
+    }
+    portEXIT_CRITICAL_SAFE(&spinlock_);
+    
+    if (!stored) {
+        dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool DeferredLog::take(Record& record) {
+    bool taken = false;
+    
+    portENTER_CRITICAL(&spinlock_);
+    if (tail_ != head_) {
+        record = ring_[tail_ & (RING_SIZE - 1)];
+        tail_++;
+        taken = true;
+    }
+    portEXIT_CRITICAL(&spinlock_);
+    
+    return taken;
+}
+
+size_t DeferredLog::flush() {
+    size_t count = 0;
+    Record record;
+    while (take(record)) {
+        emit(record);
+        count++;
+    }
+    return count;
+}
+
+void DeferredLog::emit(const Record& record) {
+    char message[160];
+    size_t length = 0;
+    size_t arg_index = 0;
+    const char* p = record.format;
+    
+    // 変換指定ごとに記録時の型でsnprintfする
+    while (*p != '\0' && length < sizeof(message) - 1) {
+        if (*p != '%') {
+            message[length++] = *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            message[length++] = '%';
+            p += 2;
+            continue;
+        }
+        
+        // 変換指定を切り出す（フラグ・幅・精度・長さ修飾子・変換文字）
+        char spec[16];
+        size_t spec_length = 0;
+        spec[spec_length++] = *p++;
+        bool long_modifier = false;
+        while (*p != '\0' && spec_length < sizeof(spec) - 2 && strchr("-+ #0123456789.hlzt", *p) != nullptr) {
+            if (*p == 'l') {
+                long_modifier = true;
+            }
+            spec[spec_length++] = *p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        char conversion = *p++;
+        spec[spec_length++] = conversion;
+        spec[spec_length] = '\0';
+        
+        char* out = message + length;
+        size_t remaining = sizeof(message) - length;
+        int written = 0;
+        
+        if (arg_index >= record.arg_count) {
+            written = snprintf(out, remaining, "<?>");
+        } else {
+            uintptr_t raw = record.args[arg_index];
+            bool is_float = (record.float_mask & (1u << arg_index)) != 0;
+            arg_index++;
+            
+            if (is_float) {
+                float f;
+                uint32_t bits = static_cast<uint32_t>(raw);
+                memcpy(&f, &bits, sizeof(f));
+                written = snprintf(out, remaining, spec, static_cast<double>(f));
+            } else if (conversion == 's') {
+                written = snprintf(out, remaining, spec, reinterpret_cast<const char*>(raw));
+            } else if (conversion == 'p') {
+                written = snprintf(out, remaining, spec, reinterpret_cast<void*>(raw));
+            } else if (conversion == 'd' || conversion == 'i') {
+                int32_t value = static_cast<int32_t>(static_cast<uint32_t>(raw));
+                written = long_modifier ? snprintf(out, remaining, spec, static_cast<long>(value))
+                                        : snprintf(out, remaining, spec, static_cast<int>(value));
+            } else {
+                uint32_t value = static_cast<uint32_t>(raw);
+                written = long_modifier ? snprintf(out, remaining, spec, static_cast<unsigned long>(value))
+                                        : snprintf(out, remaining, spec, static_cast<unsigned>(value));
+            }
+        }
+        
+        if (written > 0) {
+            length += (static_cast<size_t>(written) < remaining) ? static_cast<size_t>(written) : remaining - 1;
+        }
+    }
+    message[length] = '\0';
+    
+    esp_log_level_t level = static_cast<esp_log_level_t>(record.level);
+    ESP_LOG_LEVEL(level, record.tag, "[%lu] %s", static_cast<unsigned long>(record.timestamp_ms), message);
+}
+
+void DeferredLog::drainTask(void* arg) {
+    ESP_LOGI(TAG, "遅延ログタスク開始");
+    
+    while (!stop_requested_.load()) {
+        if (flush() == 0) {
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+    }
+    flush();
+    
+    uint32_t dropped = dropped_count_.load();
+    if (dropped > 0) {
+        ESP_LOGW(TAG, "遅延ログ破棄数: %lu", static_cast<unsigned long>(dropped));
+    }
+    
+    task_handle_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+} // namespace hal
@@ -11,15 +11,27 @@
  */
 
 #include "gpio_hal.hpp"
+#include "interrupt_plan.hpp"
 #include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 
 namespace hal {
 
-// 静的メンバ変数の初期化
-std::map<gpio_num_t, GpioHal*> GpioHal::pin_map_;
+// 静的メンバ変数の初期化（ISRから参照するためDRAMに配置）
+DRAM_ATTR GpioHal::IsrEntry GpioHal::isr_entries_[GPIO_NUM_MAX] = {};
+DRAM_ATTR GpioHal::DeferredEvent GpioHal::defer_queue_[GpioHal::DEFER_QUEUE_SIZE] = {};
+std::atomic<uint32_t> GpioHal::defer_head_{0};
+std::atomic<uint32_t> GpioHal::defer_tail_{0};
+std::atomic<uint32_t> GpioHal::defer_overflow_count_{0};
+TaskHandle_t GpioHal::defer_task_ = nullptr;
 bool GpioHal::isr_service_installed_ = false;
 
+static_assert((GpioHal::DEFER_QUEUE_SIZE & (GpioHal::DEFER_QUEUE_SIZE - 1)) == 0,  
+              "DEFER_QUEUE_SIZEは2のべき乗であること");
+
 GpioHal::GpioHal() : HalBase("GPIO_HAL") {
     logDebug("GPIO HALクラス作成");
 }
@@ -30,12 +42,11 @@ GpioHal::~GpioHal() {
         disableInterrupt(pair.first);
     }
     
-    // ピンマップから自身を削除
-    for (auto it = pin_map_.begin(); it != pin_map_.end();) {
-        if (it->second == this) {
-            it = pin_map_.erase(it);
-        } else {
-            ++it;
+    // ディスパッチ表から自身の登録を削除
+    for (int pin = 0; pin < GPIO_NUM_MAX; pin++) {
+        if (isr_entries_[pin].owner == this) {
+            gpio_isr_handler_remove(static_cast<gpio_num_t>(pin));
+            clearIsrEntry(static_cast<gpio_num_t>(pin));
         }
     }
     
@@ -102,12 +113,20 @@ esp_err_t GpioHal::stop() {
 esp_err_t GpioHal::reset() {
     // 全てのピン設定をクリア
     for (const auto& pair : pin_configs_) {
+        if (isr_entries_[pair.first].owner == this) {
+            gpio_isr_handler_remove(pair.first);
+            clearIsrEntry(pair.first);
+        }
         gpio_reset_pin(pair.first);
-        pin_map_.erase(pair.first);
     }
     
     pin_configs_.clear();
-    callbacks_.clear();
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        for (auto& callback : callbacks_) {
+            callback = nullptr;
+        }
+    }
     
     setState(State::INITIALIZED);
     logInfo("GPIO HALリセット完了");
@@ -145,7 +164,9 @@ esp_err_t GpioHal::configurePin(const Config& config) {
     
     // 設定を保存
     pin_configs_[config.pin] = config;
-    pin_map_[config.pin] = this;
+    if (isr_entries_[config.pin].owner == this) {
+        isr_entries_[config.pin].invert = config.invert;
+    }
     
     logDebug("GPIO設定完了 ピン%d 方向:%d プル:%d 割り込み:%d", 
              config.pin, static_cast<int>(config.direction), 
@@ -259,6 +280,35 @@ esp_err_t GpioHal::setInterrupt(gpio_num_t pin, InterruptType type, InterruptCal
         return ESP_ERR_INVALID_ARG;
     }
     
+    // コールバックを登録（処理内容を制約しないよう遅延実行タスクから呼び出す）
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callbacks_[pin] = callback;
+    }
+    
+    esp_err_t ret = setInterruptIsr(pin, type, callbackTrampoline, this, true);
+    if (ret != ESP_OK) {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callbacks_[pin] = nullptr;
+        return ret;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t GpioHal::setInterruptIsr(gpio_num_t pin, InterruptType type, IsrHandler handler,  
+                                   void* context, bool deferred) {
+    if (!isValidPin(pin) || handler == nullptr) {
+        logError("無効な引数 ピン%d", pin);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    IsrEntry& entry = isr_entries_[pin];
+    if (entry.owner != nullptr && entry.owner != this) {
+        logError("ピン%dは他のインスタンスが割り込み登録済み", pin);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
     // ISRサービスが初期化されているか確認
     if (!isr_service_installed_) {
         esp_err_t ret = installIsrService();
@@ -267,31 +317,49 @@ esp_err_t GpioHal::setInterrupt(gpio_num_t pin, InterruptType type, InterruptCal
         }
     }
     
+    if (deferred) {
+        esp_err_t ret = startDeferTask();
+        if (ret != ESP_OK) {
+            logError("遅延実行タスク起動失敗: %s", esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    // 更新中にISRが走らないよう一旦無効化してからエントリを書き換える
+    gpio_intr_disable(pin);
+    
+    auto config_it = pin_configs_.find(pin);
+    entry.handler = handler;
+    entry.context = context;
+    entry.owner = this;
+    entry.invert = (config_it != pin_configs_.end()) && config_it->second.invert;
+    entry.deferred = deferred;
+    
     // 割り込みタイプを設定
     esp_err_t ret = gpio_set_intr_type(pin, static_cast<gpio_int_type_t>(type));
     if (ret != ESP_OK) {
         logError("割り込みタイプ設定失敗 ピン%d: %s", pin, esp_err_to_name(ret));
+        clearIsrEntry(pin);
         return ret;
     }
     
-    // コールバックを登録
-    callbacks_[pin] = callback;
-    pin_map_[pin] = this;
-    
-    // 割り込みハンドラを追加
+    // 割り込みハンドラを追加（引数はピン番号のみ、ディスパッチは配列参照）
     ret = gpio_isr_handler_add(pin, gpioIsrHandler, reinterpret_cast<void*>(pin));
     if (ret != ESP_OK) {
         logError("割り込みハンドラ追加失敗 ピン%d: %s", pin, esp_err_to_name(ret));
-        callbacks_.erase(pin);
+        clearIsrEntry(pin);
         return ret;
     }
     
     // ピン設定を更新
-    if (pin_configs_.find(pin) != pin_configs_.end()) {
-        pin_configs_[pin].interrupt = type;
+    if (config_it != pin_configs_.end()) {
+        config_it->second.interrupt = type;
     }
     
-    logDebug("GPIO割り込み設定 ピン%d タイプ:%d", pin, static_cast<int>(type));
+    gpio_intr_enable(pin);
+    
+    logDebug("GPIO割り込み設定 ピン%d タイプ:%d 遅延実行:%s", pin, static_cast<int>(type),  
+             deferred ? "有効" : "無効");
     return ESP_OK;
 }
 
@@ -305,8 +373,14 @@ esp_err_t GpioHal::disableInterrupt(gpio_num_t pin) {
         logWarning("割り込み無効化警告 ピン%d: %s", pin, esp_err_to_name(ret));
     }
     
-    // コールバックを削除
-    callbacks_.erase(pin);
+    // ディスパッチ表とコールバックを削除
+    if (isr_entries_[pin].owner == this) {
+        clearIsrEntry(pin);
+    }
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callbacks_[pin] = nullptr;
+    }
     
     // ピン設定を更新
     if (pin_configs_.find(pin) != pin_configs_.end()) {
@@ -326,7 +400,10 @@ esp_err_t GpioHal::installIsrService() {
         return ESP_OK;
     }
     
-    esp_err_t ret = gpio_install_isr_service(ESP_INTR_FLAG_EDGE | ESP_INTR_FLAG_IRAM);
+    // 割り込みは配置表のコアに確保される
+    esp_err_t ret = InterruptPlan::install(InterruptPlan::Source::GPIO, []() {
+        return gpio_install_isr_service(ESP_INTR_FLAG_EDGE | InterruptPlan::flags(InterruptPlan::Source::GPIO));
+    });
     if (ret != ESP_OK) {
         return ret;
     }
@@ -335,32 +412,100 @@ esp_err_t GpioHal::installIsrService() {
     return ESP_OK;
 }
 
+esp_err_t GpioHal::startDeferTask() {
+    if (defer_task_ != nullptr) {
+        return ESP_OK;
+    }
+    
+    BaseType_t result = xTaskCreate(deferTask, "gpio_defer_task", DEFER_TASK_STACK_SIZE,  
+                                    nullptr, DEFER_TASK_PRIORITY, &defer_task_);
+    if (result != pdPASS) {
+        defer_task_ = nullptr;
+        return ESP_ERR_NO_MEM;
+    }
+    
+    return ESP_OK;
+}
+
+void GpioHal::clearIsrEntry(gpio_num_t pin) {
+    IsrEntry& entry = isr_entries_[pin];
+    entry.handler = nullptr;
+    entry.context = nullptr;
+    entry.owner = nullptr;
+    entry.invert = false;
+    entry.deferred = false;
+}
+
 void IRAM_ATTR GpioHal::gpioIsrHandler(void* arg) {
     gpio_num_t pin = static_cast<gpio_num_t>(reinterpret_cast<intptr_t>(arg));
     
-    // ピンに対応するインスタンスを取得
-    auto it = pin_map_.find(pin);
-    if (it == pin_map_.end()) {
+    // ピン番号で直接ディスパッチ表を参照
+    const IsrEntry& entry = isr_entries_[pin];
+    IsrHandler handler = entry.handler;
+    if (handler == nullptr) {
         return;
     }
     
-    GpioHal* instance = it->second;
-    auto callback_it = instance->callbacks_.find(pin);
-    if (callback_it == instance->callbacks_.end()) {
+    // 現在のピンレベルを取得（gpio_get_levelはIRAM配置が保証されないためLL関数を使用）
+    bool level = (gpio_ll_get_level(&GPIO, pin) != 0) != entry.invert;
+    
+    if (!entry.deferred) {
+        handler(pin, level, entry.context);
         return;
     }
     
-    // 現在のピンレベルを取得
-    bool level = gpio_get_level(pin) != 0;
+    // 遅延実行キューへ投入（GPIO ISRが唯一の書き込み側）
+    uint32_t head = defer_head_.load(std::memory_order_relaxed);
+    uint32_t tail = defer_tail_.load(std::memory_order_acquire);
+    if (head - tail >= DEFER_QUEUE_SIZE) {
+        defer_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
     
-    // 論理反転を考慮
-    auto config_it = instance->pin_configs_.find(pin);
-    if (config_it != instance->pin_configs_.end() && config_it->second.invert) {
-        level = !level;
+    DeferredEvent& event = defer_queue_[head & (DEFER_QUEUE_SIZE - 1)];
+    event.pin = static_cast<uint8_t>(pin);
+    event.level = level ? 1 : 0;
+    defer_head_.store(head + 1, std::memory_order_release);
+    
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(defer_task_, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+void GpioHal::deferTask(void* arg) {
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        
+        // キューが空になるまで処理（通知は複数イベントでまとめられる場合がある）
+        uint32_t tail = defer_tail_.load(std::memory_order_relaxed);
+        while (tail != defer_head_.load(std::memory_order_acquire)) {
+            DeferredEvent event = defer_queue_[tail & (DEFER_QUEUE_SIZE - 1)];
+            tail++;
+            defer_tail_.store(tail, std::memory_order_release);
+            
+            const IsrEntry& entry = isr_entries_[event.pin];
+            IsrHandler handler = entry.handler;
+            if (handler != nullptr) {
+                handler(static_cast<gpio_num_t>(event.pin), event.level != 0, entry.context);
+            }
+        }
+    }
+}
+
+void GpioHal::callbackTrampoline(gpio_num_t pin, bool level, void* context) {
+    GpioHal* instance = static_cast<GpioHal*>(context);
+    
+    InterruptCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(instance->callback_mutex_);
+        callback = instance->callbacks_[pin];
+    }
+    if (!callback) {
+        return;
     }
     
     // コールバック実行
-    callback_it->second(pin, level);
+    callback(pin, level);
 }
 
 } // namespace hal
\ No newline at end of file
@@ -10,20 +10,50 @@
  */
 
 #include "hal_base.hpp"
+#include "esp_attr.h"
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include "sdkconfig.h"
 
 namespace hal {
 
+HalBase* HalBase::instances_[MAX_INSTANCES] = {};
+portMUX_TYPE HalBase::instances_lock_ = portMUX_INITIALIZER_UNLOCKED;
+
 HalBase::HalBase(const char* component_name)
     : component_name_(component_name)
     , state_(State::UNINITIALIZED)
     , priority_(Priority::NORMAL)
+    , log_level_(esp_log_level_get(component_name))
+    , trace_enabled_(false)
+    , trace_stats_{}
 {
+    portMUX_INITIALIZE(&trace_lock_);
+    resetTrace();
+    
+    portENTER_CRITICAL(&instances_lock_);
+    for (auto& instance : instances_) {
+        if (instance == nullptr) {
+            instance = this;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&instances_lock_);
+    
     logDebug("HAL基底クラス作成: %s", component_name_);
 }
 
 HalBase::~HalBase() {
+    portENTER_CRITICAL(&instances_lock_);
+    for (auto& instance : instances_) {
+        if (instance == this) {
+            instance = nullptr;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&instances_lock_);
+    
     logDebug("HAL基底クラス破棄: %s", component_name_);
 }
 
@@ -37,46 +67,159 @@ void HalBase::setState(State new_state) {
             "未初期化", "初期化中", "初期化完了", "動作中", "エラー", "中断"
         };
         
-        logInfo("状態変更: %s -> %s", 
+        logDebug("状態変更: %s -> %s", 
             state_names[static_cast<int>(old_state)],
             state_names[static_cast<int>(new_state)]);
     }
 }
 
-void HalBase::logError(const char* format, ...) {
-    char buffer[256];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    va_end(args);
-    ESP_LOGE(component_name_, "%s", buffer);
+void HalBase::setLogLevel(esp_log_level_t level) {
+    log_level_ = level;
+    esp_log_level_set(component_name_, level);
 }
 
-void HalBase::logWarning(const char* format, ...) {
+void HalBase::logWrite(esp_log_level_t level, const char* format, ...) const {
     char buffer[256];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    ESP_LOGW(component_name_, "%s", buffer);
+    ESP_LOG_LEVEL(level, component_name_, "%s", buffer);
 }
 
-void HalBase::logInfo(const char* format, ...) {
-    char buffer[256];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    va_end(args);
-    ESP_LOGI(component_name_, "%s", buffer);
+void HalBase::registerTracePoint(size_t index, const char* name) {
+    if (index < MAX_TRACE_POINTS) {
+        trace_stats_[index].name = name;
+    }
 }
 
-void HalBase::logDebug(const char* format, ...) {
-    char buffer[256];
-    va_list args;
-    va_start(args, format);
-    vsnprintf(buffer, sizeof(buffer), format, args);
-    va_end(args);
-    ESP_LOGD(component_name_, "%s", buffer);
+void IRAM_ATTR HalBase::recordTrace(size_t index, uint32_t cycles, esp_err_t result) {
+    // 計測中に別コアへ移動した場合は差分が負（巨大値）になるため破棄
+    if (index >= MAX_TRACE_POINTS || cycles > 0x80000000u) {
+        return;
+    }
+    
+    size_t bucket = 0;
+    uint32_t limit = 1u << TRACE_HISTOGRAM_SHIFT;
+    while (bucket < TRACE_HISTOGRAM_BUCKETS - 1 && cycles >= limit) {
+        bucket++;
+        limit <<= 1;
+    }
+    
+    portENTER_CRITICAL_SAFE(&trace_lock_);
+    TraceStats& stats = trace_stats_[index];
+    stats.count++;
+    if (result != ESP_OK) {
+        stats.errors++;
+    }
+    if (cycles < stats.min_cycles) {
+        stats.min_cycles = cycles;
+    }
+    if (cycles > stats.max_cycles) {
+        stats.max_cycles = cycles;
+    }
+    stats.total_cycles += cycles;
+    stats.histogram[bucket]++;
+    portEXIT_CRITICAL_SAFE(&trace_lock_);
+}
+
+esp_err_t HalBase::getTraceStats(size_t index, TraceStats& stats) const {
+    if (index >= MAX_TRACE_POINTS || trace_stats_[index].name == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    portENTER_CRITICAL_SAFE(&trace_lock_);
+    stats = trace_stats_[index];
+    portEXIT_CRITICAL_SAFE(&trace_lock_);
+    return ESP_OK;
+}
+
+void HalBase::resetTrace() {
+    portENTER_CRITICAL_SAFE(&trace_lock_);
+    for (auto& stats : trace_stats_) {
+        const char* name = stats.name;
+        memset(&stats, 0, sizeof(stats));
+        stats.name = name;
+        stats.min_cycles = UINT32_MAX;
+    }
+    portEXIT_CRITICAL_SAFE(&trace_lock_);
+}
+
+void HalBase::dumpTrace() const {
+    constexpr uint32_t cycles_per_us = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+    
+    for (size_t i = 0; i < MAX_TRACE_POINTS; i++) {
+        TraceStats stats;
+        if (getTraceStats(i, stats) != ESP_OK) {
+            continue;
+        }
+        if (stats.count == 0) {
+            ESP_LOGI(component_name_, "トレース %s: 計測なし", stats.name);
+            continue;
+        }
+        
+        ESP_LOGI(component_name_, "トレース %s: 回数:%lu エラー:%lu 最小:%luus 平均:%luus 最大:%luus",  
+                 stats.name,  
+                 static_cast<unsigned long>(stats.count),  
+                 static_cast<unsigned long>(stats.errors),  
+                 static_cast<unsigned long>(stats.min_cycles / cycles_per_us),  
+                 static_cast<unsigned long>(stats.averageCycles() / cycles_per_us),  
+                 static_cast<unsigned long>(stats.max_cycles / cycles_per_us));
+        
+        char line[160];
+        size_t length = 0;
+        for (size_t b = 0; b < TRACE_HISTOGRAM_BUCKETS && length < sizeof(line); b++) {
+            int written = snprintf(line + length, sizeof(line) - length, " %lu",  
+                                   static_cast<unsigned long>(stats.histogram[b]));
+            if (written < 0) {
+                break;
+            }
+            length += static_cast<size_t>(written);
+        }
+        ESP_LOGI(component_name_, "  ヒストグラム(<%luus,x2):%s",  
+                 static_cast<unsigned long>((1u << TRACE_HISTOGRAM_SHIFT) / cycles_per_us), line);
+    }
+}
+
+void HalBase::setAllTraceEnabled(bool enabled) {
+    portENTER_CRITICAL(&instances_lock_);
+    for (auto* instance : instances_) {
+        if (instance != nullptr) {
+            instance->trace_enabled_ = enabled;
+        }
+    }
+    portEXIT_CRITICAL(&instances_lock_);
+}
+
+void HalBase::dumpAllTraces() {
+    for (size_t i = 0; i < MAX_INSTANCES; i++) {
+        HalBase* instance = getInstance(i);
+        if (instance != nullptr && instance->isTraceEnabled()) {
+            instance->dumpTrace();
+        }
+    }
+}
+
+size_t HalBase::getInstanceCount() {
+    size_t count = 0;
+    portENTER_CRITICAL(&instances_lock_);
+    for (auto* instance : instances_) {
+        if (instance != nullptr) {
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&instances_lock_);
+    return count;
+}
+
+HalBase* HalBase::getInstance(size_t index) {
+    if (index >= MAX_INSTANCES) {
+        return nullptr;
+    }
+    portENTER_CRITICAL(&instances_lock_);
+    HalBase* instance = instances_[index];
+    portEXIT_CRITICAL(&instances_lock_);
+    return instance;
 }
 
 } // namespace hal
\ No newline at end of file
@@ -11,14 +11,20 @@
  */
 
 #include "i2c_hal.hpp"
+#include "interrupt_plan.hpp"
 #include "esp_log.h"
+#include <algorithm>
 #include <cstring>
 
 namespace hal {
 
 I2cHal::I2cHal(i2c_port_t port) 
     : HalBase("I2C_HAL")
-    , driver_installed_(false) {
+    , driver_installed_(false)
+#if HAL_I2C_USE_MASTER_DRIVER
+    , bus_handle_(nullptr)
+#endif
+    {
     config_.port = port;
     config_.mode = Mode::MASTER;
     config_.sda_pin = GPIO_NUM_NC;
@@ -27,15 +33,38 @@ I2cHal::I2cHal(i2c_port_t port)
     config_.sda_pullup_enable = true;
     config_.scl_pullup_enable = true;
     config_.slave_address = 0;
+    config_.use_static_cmd_link = true;
+    config_.async_queue_depth = 0;  // 1以上でバス全体が非同期キューになる（readRegisterAsync()用）
+    
+    registerTracePoint(TRACE_WRITE, "write");
+    registerTracePoint(TRACE_READ, "read");
+    registerTracePoint(TRACE_BATCH, "batch");
+    
+#if HAL_I2C_USE_MASTER_DRIVER
+    for (auto& slot : async_slots_) {
+        slot.owner = this;
+        slot.handle = nullptr;
+        slot.device_address = 0;
+        slot.register_address = 0;
+        slot.callback = nullptr;
+        slot.user_arg = nullptr;
+        slot.assigned.store(false, std::memory_order_relaxed);
+        slot.busy.store(false, std::memory_order_relaxed);
+    }
+#endif
     
     logDebug("I2C HALクラス作成 ポート:%d", static_cast<int>(port));
 }
 
 I2cHal::~I2cHal() {
+#if HAL_I2C_USE_MASTER_DRIVER
+    releaseBus();
+#else
     if (driver_installed_) {
         i2c_driver_delete(config_.port);
         logDebug("I2Cドライバ削除 ポート:%d", static_cast<int>(config_.port));
     }
+#endif
     logDebug("I2C HALクラス破棄");
 }
 
@@ -53,6 +82,7 @@ esp_err_t I2cHal::initialize() {
     return ESP_OK;
 }
 
+#if !HAL_I2C_USE_MASTER_DRIVER
 esp_err_t I2cHal::configure() {
     if (!isInitialized()) {
         logError("I2C HALが初期化されていません");
@@ -92,8 +122,11 @@ esp_err_t I2cHal::configure() {
         return ret;
     }
     
-    // I2Cドライバをインストール
-    ret = i2c_driver_install(config_.port, static_cast<i2c_mode_t>(config_.mode), 0, 0, 0);
+    // I2Cドライバをインストール（割り込みは配置表のコアに確保される）
+    ret = InterruptPlan::install(InterruptPlan::Source::I2C_BUS, [this]() {
+        return i2c_driver_install(config_.port, static_cast<i2c_mode_t>(config_.mode), 0, 0, 
+                                  InterruptPlan::flags(InterruptPlan::Source::I2C_BUS));
+    });
     if (ret != ESP_OK) {
         logError("I2Cドライバインストール失敗: %s", esp_err_to_name(ret));
         setState(State::ERROR);
@@ -107,6 +140,7 @@ esp_err_t I2cHal::configure() {
     
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::start() {
     if (!isInitialized()) {
@@ -131,6 +165,7 @@ esp_err_t I2cHal::stop() {
     return ESP_OK;
 }
 
+#if !HAL_I2C_USE_MASTER_DRIVER
 esp_err_t I2cHal::reset() {
     if (driver_installed_) {
         i2c_driver_delete(config_.port);
@@ -141,6 +176,7 @@ esp_err_t I2cHal::reset() {
     logInfo("I2C HALリセット完了");
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::setConfig(const Config& config) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -153,12 +189,17 @@ esp_err_t I2cHal::setConfig(const Config& config) {
 }
 
 esp_err_t I2cHal::write(uint8_t device_address, const std::vector<uint8_t>& data, TickType_t timeout) {
+    return write(device_address, data.data(), data.size(), timeout);
+}
+
+#if !HAL_I2C_USE_MASTER_DRIVER
+esp_err_t I2cHal::write(uint8_t device_address, const uint8_t* data, size_t length, TickType_t timeout) {
     if (!isRunning()) {
         logError("I2C HALが動作していません");
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (data.empty()) {
+    if (data == nullptr || length == 0) {
         logError("書き込みデータが空です");
         return ESP_ERR_INVALID_ARG;
     }
@@ -166,7 +207,7 @@ esp_err_t I2cHal::write(uint8_t device_address, const std::vector<uint8_t>& data
     std::lock_guard<std::mutex> lock(mutex_);
     
     // I2Cコマンドリンクを作成
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = createCommandLink();
     if (cmd == nullptr) {
         logError("I2Cコマンドリンク作成失敗");
         return ESP_ERR_NO_MEM;
@@ -175,30 +216,34 @@ esp_err_t I2cHal::write(uint8_t device_address, const std::vector<uint8_t>& data
     // I2C書き込みシーケンス
     esp_err_t ret = i2c_master_start(cmd);
     ret |= i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_WRITE, true);
-    ret |= i2c_master_write(cmd, data.data(), data.size(), true);
+    ret |= i2c_master_write(cmd, data, length, true);
     ret |= i2c_master_stop(cmd);
     
     if (ret != ESP_OK) {
-        i2c_cmd_link_delete(cmd);
+        deleteCommandLink(cmd);
         logError("I2Cコマンド構築失敗: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // コマンド実行
+    uint32_t trace_start = traceBegin();
     ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
-    i2c_cmd_link_delete(cmd);
+    traceEnd(TRACE_WRITE, trace_start, ret);
+    deleteCommandLink(cmd);
     
     if (ret != ESP_OK) {
         logError("I2C書き込み失敗 アドレス:0x%02X サイズ:%zu エラー:%s", 
-                 device_address, data.size(), esp_err_to_name(ret));
+                 device_address, length, esp_err_to_name(ret));
         return ret;
     }
     
-    logDebug("I2C書き込み成功 アドレス:0x%02X サイズ:%zu", device_address, data.size());
+    logDebug("I2C書き込み成功 アドレス:0x%02X サイズ:%zu", device_address, length);
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::read(uint8_t device_address, std::vector<uint8_t>& data, size_t length, TickType_t timeout) {
+    // 状態・引数を確認してからバッファを確保する（失敗時に呼び出し側のデータを書き換えない）
     if (!isRunning()) {
         logError("I2C HALが動作していません");
         return ESP_ERR_INVALID_STATE;
@@ -209,13 +254,32 @@ esp_err_t I2cHal::read(uint8_t device_address, std::vector<uint8_t>& data, size_
         return ESP_ERR_INVALID_ARG;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     // データバッファを準備
     data.resize(length);
     
+    esp_err_t ret = read(device_address, data.data(), length, timeout);
+    if (ret != ESP_OK) {
+        data.clear();
+    }
+    return ret;
+}
+
+#if !HAL_I2C_USE_MASTER_DRIVER
+esp_err_t I2cHal::read(uint8_t device_address, uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
     // I2Cコマンドリンクを作成
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = createCommandLink();
     if (cmd == nullptr) {
         logError("I2Cコマンドリンク作成失敗");
         return ESP_ERR_NO_MEM;
@@ -226,43 +290,56 @@ esp_err_t I2cHal::read(uint8_t device_address, std::vector<uint8_t>& data, size_
     ret |= i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_READ, true);
     
     if (length > 1) {
-        ret |= i2c_master_read(cmd, data.data(), length - 1, I2C_MASTER_ACK);
+        ret |= i2c_master_read(cmd, data, length - 1, I2C_MASTER_ACK);
     }
     ret |= i2c_master_read_byte(cmd, &data[length - 1], I2C_MASTER_NACK);
     ret |= i2c_master_stop(cmd);
     
     if (ret != ESP_OK) {
-        i2c_cmd_link_delete(cmd);
+        deleteCommandLink(cmd);
         logError("I2Cコマンド構築失敗: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // コマンド実行
+    uint32_t trace_start = traceBegin();
     ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
-    i2c_cmd_link_delete(cmd);
+    traceEnd(TRACE_READ, trace_start, ret);
+    deleteCommandLink(cmd);
     
     if (ret != ESP_OK) {
         logError("I2C読み取り失敗 アドレス:0x%02X サイズ:%zu エラー:%s", 
                  device_address, length, esp_err_to_name(ret));
-        data.clear();
         return ret;
     }
     
     logDebug("I2C読み取り成功 アドレス:0x%02X サイズ:%zu", device_address, length);
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::writeRegister(uint8_t device_address, uint8_t register_address, 
                                const std::vector<uint8_t>& data, TickType_t timeout) {
+    return writeRegister(device_address, register_address, data.data(), data.size(), timeout);
+}
+
+#if !HAL_I2C_USE_MASTER_DRIVER
+esp_err_t I2cHal::writeRegister(uint8_t device_address, uint8_t register_address, 
+                               const uint8_t* data, size_t length, TickType_t timeout) {
     if (!isRunning()) {
         logError("I2C HALが動作していません");
         return ESP_ERR_INVALID_STATE;
     }
     
+    if (data == nullptr && length > 0) {
+        logError("書き込みデータが無効です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
     std::lock_guard<std::mutex> lock(mutex_);
     
     // I2Cコマンドリンクを作成
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = createCommandLink();
     if (cmd == nullptr) {
         logError("I2Cコマンドリンク作成失敗");
         return ESP_ERR_NO_MEM;
@@ -273,21 +350,23 @@ esp_err_t I2cHal::writeRegister(uint8_t device_address, uint8_t register_address
     ret |= i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_WRITE, true);
     ret |= i2c_master_write_byte(cmd, register_address, true);
     
-    if (!data.empty()) {
-        ret |= i2c_master_write(cmd, data.data(), data.size(), true);
+    if (length > 0) {
+        ret |= i2c_master_write(cmd, data, length, true);
     }
     
     ret |= i2c_master_stop(cmd);
     
     if (ret != ESP_OK) {
-        i2c_cmd_link_delete(cmd);
+        deleteCommandLink(cmd);
         logError("I2Cコマンド構築失敗: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // コマンド実行
+    uint32_t trace_start = traceBegin();
     ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
-    i2c_cmd_link_delete(cmd);
+    traceEnd(TRACE_WRITE, trace_start, ret);
+    deleteCommandLink(cmd);
     
     if (ret != ESP_OK) {
         logError("I2Cレジスタ書き込み失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
@@ -296,12 +375,14 @@ esp_err_t I2cHal::writeRegister(uint8_t device_address, uint8_t register_address
     }
     
     logDebug("I2Cレジスタ書き込み成功 アドレス:0x%02X レジスタ:0x%02X サイズ:%zu", 
-             device_address, register_address, data.size());
+             device_address, register_address, length);
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address, 
                               std::vector<uint8_t>& data, size_t length, TickType_t timeout) {
+    // 状態・引数を確認してからバッファを確保する（失敗時に呼び出し側のデータを書き換えない）
     if (!isRunning()) {
         logError("I2C HALが動作していません");
         return ESP_ERR_INVALID_STATE;
@@ -312,13 +393,33 @@ esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address,
         return ESP_ERR_INVALID_ARG;
     }
     
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     // データバッファを準備
     data.resize(length);
     
+    esp_err_t ret = readRegister(device_address, register_address, data.data(), length, timeout);
+    if (ret != ESP_OK) {
+        data.clear();
+    }
+    return ret;
+}
+
+#if !HAL_I2C_USE_MASTER_DRIVER
+esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address, 
+                              uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
     // I2Cコマンドリンクを作成
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = createCommandLink();
     if (cmd == nullptr) {
         logError("I2Cコマンドリンク作成失敗");
         return ESP_ERR_NO_MEM;
@@ -333,25 +434,26 @@ esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address,
     ret |= i2c_master_write_byte(cmd, (device_address << 1) | I2C_MASTER_READ, true);
     
     if (length > 1) {
-        ret |= i2c_master_read(cmd, data.data(), length - 1, I2C_MASTER_ACK);
+        ret |= i2c_master_read(cmd, data, length - 1, I2C_MASTER_ACK);
     }
     ret |= i2c_master_read_byte(cmd, &data[length - 1], I2C_MASTER_NACK);
     ret |= i2c_master_stop(cmd);
     
     if (ret != ESP_OK) {
-        i2c_cmd_link_delete(cmd);
+        deleteCommandLink(cmd);
         logError("I2Cコマンド構築失敗: %s", esp_err_to_name(ret));
         return ret;
     }
     
     // コマンド実行
+    uint32_t trace_start = traceBegin();
     ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
-    i2c_cmd_link_delete(cmd);
+    traceEnd(TRACE_READ, trace_start, ret);
+    deleteCommandLink(cmd);
     
     if (ret != ESP_OK) {
         logError("I2Cレジスタ読み取り失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
                  device_address, register_address, esp_err_to_name(ret));
-        data.clear();
         return ret;
     }
     
@@ -359,26 +461,21 @@ esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address,
              device_address, register_address, length);
     return ESP_OK;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::writeRegister8(uint8_t device_address, uint8_t register_address, 
                                 uint8_t value, TickType_t timeout) {
-    std::vector<uint8_t> data = {value};
-    return writeRegister(device_address, register_address, data, timeout);
+    return writeRegister(device_address, register_address, &value, 1, timeout);
 }
 
 esp_err_t I2cHal::readRegister8(uint8_t device_address, uint8_t register_address, 
                                uint8_t& value, TickType_t timeout) {
-    std::vector<uint8_t> data;
-    esp_err_t ret = readRegister(device_address, register_address, data, 1, timeout);
-    if (ret == ESP_OK && !data.empty()) {
-        value = data[0];
-    }
-    return ret;
+    return readRegister(device_address, register_address, &value, 1, timeout);
 }
 
 esp_err_t I2cHal::writeRegister16(uint8_t device_address, uint8_t register_address, 
                                  uint16_t value, bool big_endian, TickType_t timeout) {
-    std::vector<uint8_t> data(2);
+    std::array<uint8_t, 2> data;
     if (big_endian) {
         data[0] = (value >> 8) & 0xFF;  // 上位バイト
         data[1] = value & 0xFF;         // 下位バイト
@@ -391,9 +488,9 @@ esp_err_t I2cHal::writeRegister16(uint8_t device_address, uint8_t register_addre
 
 esp_err_t I2cHal::readRegister16(uint8_t device_address, uint8_t register_address, 
                                 uint16_t& value, bool big_endian, TickType_t timeout) {
-    std::vector<uint8_t> data;
-    esp_err_t ret = readRegister(device_address, register_address, data, 2, timeout);
-    if (ret == ESP_OK && data.size() >= 2) {
+    std::array<uint8_t, 2> data;
+    esp_err_t ret = readRegister(device_address, register_address, data, timeout);
+    if (ret == ESP_OK) {
         if (big_endian) {
             value = (static_cast<uint16_t>(data[0]) << 8) | data[1];
         } else {
@@ -403,6 +500,25 @@ esp_err_t I2cHal::readRegister16(uint8_t device_address, uint8_t register_addres
     return ret;
 }
 
+#if !HAL_I2C_USE_MASTER_DRIVER
+i2c_cmd_handle_t I2cHal::createCommandLink(bool batch) {
+    if (config_.use_static_cmd_link) {
+        if (batch) {
+            return i2c_cmd_link_create_static(batch_cmd_link_buffer_, sizeof(batch_cmd_link_buffer_));
+        }
+        return i2c_cmd_link_create_static(cmd_link_buffer_, sizeof(cmd_link_buffer_));
+    }
+    return i2c_cmd_link_create();
+}
+
+void I2cHal::deleteCommandLink(i2c_cmd_handle_t cmd) {
+    if (config_.use_static_cmd_link) {
+        i2c_cmd_link_delete_static(cmd);
+    } else {
+        i2c_cmd_link_delete(cmd);
+    }
+}
+
 bool I2cHal::deviceExists(uint8_t device_address, TickType_t timeout) {
     if (!isRunning()) {
         return false;
@@ -411,7 +527,7 @@ bool I2cHal::deviceExists(uint8_t device_address, TickType_t timeout) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     // I2Cコマンドリンクを作成
-    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    i2c_cmd_handle_t cmd = createCommandLink();
     if (cmd == nullptr) {
         return false;
     }
@@ -422,13 +538,13 @@ bool I2cHal::deviceExists(uint8_t device_address, TickType_t timeout) {
     ret |= i2c_master_stop(cmd);
     
     if (ret != ESP_OK) {
-        i2c_cmd_link_delete(cmd);
+        deleteCommandLink(cmd);
         return false;
     }
     
     // コマンド実行
     ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
-    i2c_cmd_link_delete(cmd);
+    deleteCommandLink(cmd);
     
     bool exists = (ret == ESP_OK);
     logDebug("I2Cデバイス存在確認 アドレス:0x%02X 結果:%s", 
@@ -436,6 +552,7 @@ bool I2cHal::deviceExists(uint8_t device_address, TickType_t timeout) {
     
     return exists;
 }
+#endif // !HAL_I2C_USE_MASTER_DRIVER
 
 esp_err_t I2cHal::scanBus(std::vector<uint8_t>& found_devices) {
     if (!isRunning()) {
@@ -460,4 +577,176 @@ esp_err_t I2cHal::scanBus(std::vector<uint8_t>& found_devices) {
     return ESP_OK;
 }
 
+#if !HAL_I2C_USE_MASTER_DRIVER
+esp_err_t I2cHal::addDevice(uint8_t device_address, uint32_t scl_speed_hz) {
+    // レガシードライバはアドレスをコマンドリンク毎に指定するため登録不要
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::readRegisterAsync(uint8_t device_address, uint8_t register_address, 
+                                   uint8_t* data, size_t length, 
+                                   AsyncCallback callback, void* user_arg) {
+    // レガシードライバは非同期転送をサポートしないため同期実行して即座に完了通知
+    esp_err_t ret = readRegister(device_address, register_address, data, length);
+    if (callback != nullptr) {
+        callback(ret, user_arg);
+    }
+    return ret;
+}
+
+bool I2cHal::isAsyncBusy(uint8_t device_address) const {
+    return false;
+}
+
+esp_err_t I2cHal::waitAllDone(TickType_t timeout) {
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::appendTransaction(i2c_cmd_handle_t cmd, Transaction& transaction, bool is_read) {
+    const uint8_t address = transaction.device_address;
+    std::vector<uint8_t>& data = transaction.data;
+    
+    if (is_read && data.empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!is_read && !transaction.use_register_address && data.empty()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = i2c_master_start(cmd);
+    
+    if (transaction.use_register_address) {
+        ret |= i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+        ret |= i2c_master_write_byte(cmd, transaction.register_address, true);
+        if (!is_read) {
+            if (!data.empty()) {
+                ret |= i2c_master_write(cmd, data.data(), data.size(), true);
+            }
+            return ret;
+        }
+        ret |= i2c_master_start(cmd); // リピートスタート
+    } else if (!is_read) {
+        ret |= i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+        ret |= i2c_master_write(cmd, data.data(), data.size(), true);
+        return ret;
+    }
+    
+    ret |= i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
+    if (data.size() > 1) {
+        ret |= i2c_master_read(cmd, data.data(), data.size() - 1, I2C_MASTER_ACK);
+    }
+    ret |= i2c_master_read_byte(cmd, &data[data.size() - 1], I2C_MASTER_NACK);
+    return ret;
+}
+
+esp_err_t I2cHal::executeTransaction(Transaction& transaction, bool is_read) {
+    i2c_cmd_handle_t cmd = createCommandLink();
+    if (cmd == nullptr) {
+        logError("I2Cコマンドリンク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    esp_err_t ret = appendTransaction(cmd, transaction, is_read);
+    ret |= i2c_master_stop(cmd);
+    
+    if (ret != ESP_OK) {
+        deleteCommandLink(cmd);
+        logError("I2Cコマンド構築失敗 アドレス:0x%02X", transaction.device_address);
+        return ret;
+    }
+    
+    uint32_t trace_start = traceBegin();
+    ret = i2c_master_cmd_begin(config_.port, cmd, transaction.timeout);
+    traceEnd(is_read ? TRACE_READ : TRACE_WRITE, trace_start, ret);
+    deleteCommandLink(cmd);
+    
+    if (ret != ESP_OK) {
+        logError("I2Cトランザクション失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
+                 transaction.device_address, transaction.register_address, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t I2cHal::executeBatch(Transaction* transactions, size_t count) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (transactions == nullptr && count > 0) {
+        logError("トランザクションが無効です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    esp_err_t first_error = ESP_OK;
+    
+    for (size_t base = 0; base < count; base += MAX_BATCH_TRANSACTIONS) {
+        const size_t n = std::min(MAX_BATCH_TRANSACTIONS, count - base);
+        Transaction* chunk = &transactions[base];
+        
+        // リピートスタートで連結した1コマンドリンクとして実行
+        esp_err_t ret = ESP_ERR_NO_MEM;
+        bool sent = false;
+        i2c_cmd_handle_t cmd = createCommandLink(true);
+        if (cmd != nullptr) {
+            TickType_t timeout = 0;
+            ret = ESP_OK;
+            for (size_t i = 0; i < n && ret == ESP_OK; i++) {
+                ret = appendTransaction(cmd, chunk[i], chunk[i].is_read);
+                // 1件でも無限待ちなら全体も無限待ち、それ以外は飽和加算
+                if (timeout == portMAX_DELAY || chunk[i].timeout == portMAX_DELAY 
+                    || chunk[i].timeout > portMAX_DELAY - 1 - timeout) {
+                    timeout = portMAX_DELAY;
+                } else {
+                    timeout += chunk[i].timeout;
+                }
+            }
+            ret |= i2c_master_stop(cmd);
+            
+            if (ret == ESP_OK) {
+                uint32_t trace_start = traceBegin();
+                ret = i2c_master_cmd_begin(config_.port, cmd, timeout);
+                traceEnd(TRACE_BATCH, trace_start, ret);
+                sent = true;
+            }
+            deleteCommandLink(cmd);
+        }
+        
+        if (ret == ESP_OK) {
+            for (size_t i = 0; i < n; i++) {
+                chunk[i].result = ESP_OK;
+            }
+            continue;
+        }
+        
+        if (sent) {
+            // バス上で失敗した場合、どの要素まで完了したかは分からない。書き込みの重複や
+            // 読み取りでクリアされるレジスタ（FIFO等）の読み直しを避けるため、再実行せずに全要素を失敗とする
+            logError("I2Cバッチ実行失敗 件数:%zu エラー:%s", n, esp_err_to_name(ret));
+            for (size_t i = 0; i < n; i++) {
+                chunk[i].result = ret;
+            }
+            if (first_error == ESP_OK) {
+                first_error = ret;
+            }
+            continue;
+        }
+        
+        // コマンドリンクの構築に失敗した場合はバスに何も出ていないため、個別実行して要素毎の結果を確定
+        logDebug("I2Cバッチ連結構築失敗、個別実行に切替: %s", esp_err_to_name(ret));
+        for (size_t i = 0; i < n; i++) {
+            chunk[i].result = executeTransaction(chunk[i], chunk[i].is_read);
+            if (first_error == ESP_OK && chunk[i].result != ESP_OK) {
+                first_error = chunk[i].result;
+            }
+        }
+    }
+    
+    logDebug("I2Cバッチ実行完了 件数:%zu 結果:%s", count, esp_err_to_name(first_error));
+    return first_error;
+}
+#endif // !HAL_I2C_USE_MASTER_DRIVER
+
 } // namespace hal
\ No newline at end of file
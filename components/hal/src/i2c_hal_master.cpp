@@ -0,0 +1,530 @@
+/*
+ * I2C HAL Class Implementation (i2c_master driver)
+ * 
+ * ESP-IDF 5.x i2c_master バス/デバイスドライバを使用したI2C HAL実装
+ * デバイス毎のハンドルと非同期（完了コールバック）転送に対応
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "i2c_hal.hpp"
+#include "interrupt_plan.hpp"
+
+#if HAL_I2C_USE_MASTER_DRIVER
+
+#include "esp_attr.h"
+#include "esp_log.h"
+#include <cstring>
+
+namespace hal {
+
+esp_err_t I2cHal::configure() {
+    if (!isInitialized()) {
+        logError("I2C HALが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (config_.mode != Mode::MASTER) {
+        logError("i2c_masterドライバはスレーブモードに対応していません");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    // 既存のバスを削除
+    releaseBus();
+    
+    // I2Cバス設定構造体を作成
+    i2c_master_bus_config_t bus_conf = {};
+    bus_conf.i2c_port = config_.port;
+    bus_conf.sda_io_num = config_.sda_pin;
+    bus_conf.scl_io_num = config_.scl_pin;
+    bus_conf.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_conf.glitch_ignore_cnt = 7;
+    bus_conf.intr_priority = InterruptPlan::priority(InterruptPlan::Source::I2C_BUS);
+    bus_conf.trans_queue_depth = config_.async_queue_depth;
+    bus_conf.flags.enable_internal_pullup = config_.sda_pullup_enable || config_.scl_pullup_enable;
+    
+    // I2Cバスを作成（割り込みは配置表のコアに確保される）
+    const i2c_master_bus_config_t* conf = &bus_conf;
+    esp_err_t ret = InterruptPlan::install(InterruptPlan::Source::I2C_BUS, [this, conf]() {
+        return i2c_new_master_bus(conf, &bus_handle_);
+    });
+    if (ret != ESP_OK) {
+        logError("I2Cバス作成失敗: %s", esp_err_to_name(ret));
+        bus_handle_ = nullptr;
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    driver_installed_ = true;
+    
+    logInfo("I2C設定完了 ポート:%d 周波数:%dHz SDA:%d SCL:%d 非同期キュー:%zu", 
+            static_cast<int>(config_.port), config_.frequency, config_.sda_pin, config_.scl_pin, 
+            config_.async_queue_depth);
+    
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::reset() {
+    releaseBus();
+    
+    setState(State::INITIALIZED);
+    logInfo("I2C HALリセット完了");
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::write(uint8_t device_address, const uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("書き込みデータが空です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    i2c_master_dev_handle_t handle = getDeviceHandle(device_address);
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = i2c_master_transmit(handle, data, length, toTimeoutMs(timeout));
+    ret = waitSyncDone(ret, timeout);
+    traceEnd(TRACE_WRITE, trace_start, ret);
+    if (ret != ESP_OK) {
+        logError("I2C書き込み失敗 アドレス:0x%02X サイズ:%zu エラー:%s", 
+                 device_address, length, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logDebug("I2C書き込み成功 アドレス:0x%02X サイズ:%zu", device_address, length);
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::read(uint8_t device_address, uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    i2c_master_dev_handle_t handle = getDeviceHandle(device_address);
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = i2c_master_receive(handle, data, length, toTimeoutMs(timeout));
+    ret = waitSyncDone(ret, timeout);
+    traceEnd(TRACE_READ, trace_start, ret);
+    if (ret != ESP_OK) {
+        logError("I2C読み取り失敗 アドレス:0x%02X サイズ:%zu エラー:%s", 
+                 device_address, length, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logDebug("I2C読み取り成功 アドレス:0x%02X サイズ:%zu", device_address, length);
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::writeRegister(uint8_t device_address, uint8_t register_address, 
+                               const uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr && length > 0) {
+        logError("書き込みデータが無効です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (length > MAX_REGISTER_WRITE_SIZE) {
+        logError("書き込みサイズが上限を超えています サイズ:%zu 上限:%zu", 
+                 length, MAX_REGISTER_WRITE_SIZE);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    i2c_master_dev_handle_t handle = getDeviceHandle(device_address);
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // レジスタアドレスとデータを1回の書き込みにまとめる
+    uint8_t buffer[1 + MAX_REGISTER_WRITE_SIZE];
+    buffer[0] = register_address;
+    if (length > 0) {
+        std::memcpy(&buffer[1], data, length);
+    }
+    
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = i2c_master_transmit(handle, buffer, length + 1, toTimeoutMs(timeout));
+    ret = waitSyncDone(ret, timeout);
+    traceEnd(TRACE_WRITE, trace_start, ret);
+    if (ret != ESP_OK) {
+        logError("I2Cレジスタ書き込み失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
+                 device_address, register_address, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logDebug("I2Cレジスタ書き込み成功 アドレス:0x%02X レジスタ:0x%02X サイズ:%zu", 
+             device_address, register_address, length);
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::readRegister(uint8_t device_address, uint8_t register_address, 
+                              uint8_t* data, size_t length, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    i2c_master_dev_handle_t handle = getDeviceHandle(device_address);
+    if (handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // レジスタアドレス書き込み + リピートスタート読み取り
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = i2c_master_transmit_receive(handle, &register_address, 1, 
+                                                data, length, toTimeoutMs(timeout));
+    ret = waitSyncDone(ret, timeout);
+    traceEnd(TRACE_READ, trace_start, ret);
+    if (ret != ESP_OK) {
+        logError("I2Cレジスタ読み取り失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
+                 device_address, register_address, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logDebug("I2Cレジスタ読み取り成功 アドレス:0x%02X レジスタ:0x%02X サイズ:%zu", 
+             device_address, register_address, length);
+    return ESP_OK;
+}
+
+bool I2cHal::deviceExists(uint8_t device_address, TickType_t timeout) {
+    if (!isRunning()) {
+        return false;
+    }
+    
+    esp_err_t ret = i2c_master_probe(bus_handle_, device_address, toTimeoutMs(timeout));
+    
+    bool exists = (ret == ESP_OK);
+    logDebug("I2Cデバイス存在確認 アドレス:0x%02X 結果:%s", 
+             device_address, exists ? "存在" : "不在");
+    
+    return exists;
+}
+
+esp_err_t I2cHal::addDevice(uint8_t device_address, uint32_t scl_speed_hz) {
+    if (!driver_installed_) {
+        logError("I2Cバスが作成されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (getDeviceHandle(device_address, scl_speed_hz) == nullptr) {
+        return ESP_FAIL;
+    }
+    
+    logInfo("I2Cデバイス登録 アドレス:0x%02X", device_address);
+    return ESP_OK;
+}
+
+esp_err_t I2cHal::readRegisterAsync(uint8_t device_address, uint8_t register_address, 
+                                   uint8_t* data, size_t length, 
+                                   AsyncCallback callback, void* user_arg) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (config_.async_queue_depth == 0) {
+        // 非同期キュー無効時は同期読み取りして即座に完了通知（レガシードライバと同じ）
+        esp_err_t ret = readRegister(device_address, register_address, data, length);
+        if (callback != nullptr) {
+            callback(ret, user_arg);
+        }
+        return ret;
+    }
+    
+    AsyncSlot* slot = getAsyncSlot(device_address);
+    if (slot == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 同一デバイスの転送は1件ずつ（レジスタアドレス保持領域を共有するため）
+    if (slot->busy.exchange(true, std::memory_order_acquire)) {
+        logWarning("I2C非同期転送実行中 アドレス:0x%02X", device_address);
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    slot->register_address = register_address;
+    slot->callback = callback;
+    slot->user_arg = user_arg;
+    
+    // コールバック登録済みハンドルのため、キュー投入後に即座に戻る
+    esp_err_t ret = i2c_master_transmit_receive(slot->handle, &slot->register_address, 1, 
+                                                data, length, -1);
+    if (ret != ESP_OK) {
+        slot->busy.store(false, std::memory_order_release);
+        logError("I2C非同期読み取り開始失敗 アドレス:0x%02X レジスタ:0x%02X エラー:%s", 
+                 device_address, register_address, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    return ESP_OK;
+}
+
+bool I2cHal::isAsyncBusy(uint8_t device_address) const {
+    for (const auto& slot : async_slots_) {
+        if (slot.assigned.load(std::memory_order_acquire) && slot.device_address == device_address) {
+            return slot.busy.load(std::memory_order_acquire);
+        }
+    }
+    return false;
+}
+
+esp_err_t I2cHal::waitAllDone(TickType_t timeout) {
+    if (!driver_installed_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return i2c_master_bus_wait_all_done(bus_handle_, toTimeoutMs(timeout));
+}
+
+esp_err_t I2cHal::executeTransaction(Transaction& transaction, bool is_read) {
+    const uint8_t address = transaction.device_address;
+    std::vector<uint8_t>& data = transaction.data;
+    
+    if (transaction.use_register_address) {
+        if (is_read) {
+            return readRegister(address, transaction.register_address, data.data(), data.size(), 
+                                transaction.timeout);
+        }
+        return writeRegister(address, transaction.register_address, data.data(), data.size(), 
+                             transaction.timeout);
+    }
+    
+    if (is_read) {
+        return read(address, data.data(), data.size(), transaction.timeout);
+    }
+    return write(address, data.data(), data.size(), transaction.timeout);
+}
+
+esp_err_t I2cHal::executeBatch(Transaction* transactions, size_t count) {
+    if (!isRunning()) {
+        logError("I2C HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (transactions == nullptr && count > 0) {
+        logError("トランザクションが無効です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 公開APIでバスを保持できないため要素毎の個別転送（要素内のレジスタ読み取りのみリピートスタート）
+    esp_err_t first_error = ESP_OK;
+    for (size_t i = 0; i < count; i++) {
+        transactions[i].result = executeTransaction(transactions[i], transactions[i].is_read);
+        if (first_error == ESP_OK && transactions[i].result != ESP_OK) {
+            first_error = transactions[i].result;
+        }
+    }
+    
+    logDebug("I2Cバッチ実行完了 件数:%zu 結果:%s", count, esp_err_to_name(first_error));
+    return first_error;
+}
+
+i2c_master_dev_handle_t I2cHal::getDeviceHandle(uint8_t device_address, uint32_t scl_speed_hz) {
+    if (device_address >= MAX_DEVICE_ADDRESS) {
+        logError("I2Cデバイスアドレスが無効です アドレス:0x%02X", device_address);
+        return nullptr;
+    }
+    
+    // 登録済みハンドルはロック無しで取得
+    i2c_master_dev_handle_t handle = device_handles_[device_address].load(std::memory_order_acquire);
+    if (handle != nullptr) {
+        return handle;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    handle = device_handles_[device_address].load(std::memory_order_relaxed);
+    if (handle != nullptr) {
+        return handle;
+    }
+    
+    i2c_device_config_t dev_conf = {};
+    dev_conf.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    dev_conf.device_address = device_address;
+    dev_conf.scl_speed_hz = (scl_speed_hz != 0) ? scl_speed_hz : config_.frequency;
+    
+    esp_err_t ret = i2c_master_bus_add_device(bus_handle_, &dev_conf, &handle);
+    if (ret != ESP_OK) {
+        logError("I2Cデバイス追加失敗 アドレス:0x%02X エラー:%s", device_address, esp_err_to_name(ret));
+        return nullptr;
+    }
+    
+    device_handles_[device_address].store(handle, std::memory_order_release);
+    logDebug("I2Cデバイスハンドル作成 アドレス:0x%02X", device_address);
+    return handle;
+}
+
+I2cHal::AsyncSlot* I2cHal::getAsyncSlot(uint8_t device_address) {
+    // 割当済みスロットはロック無しで検索
+    for (auto& slot : async_slots_) {
+        if (slot.assigned.load(std::memory_order_acquire) && slot.device_address == device_address) {
+            return &slot;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    AsyncSlot* free_slot = nullptr;
+    for (auto& slot : async_slots_) {
+        if (slot.assigned.load(std::memory_order_relaxed)) {
+            if (slot.device_address == device_address) {
+                return &slot;
+            }
+        } else if (free_slot == nullptr) {
+            free_slot = &slot;
+        }
+    }
+    
+    if (free_slot == nullptr) {
+        logError("I2C非同期スロットに空きがありません アドレス:0x%02X", device_address);
+        return nullptr;
+    }
+    
+    // 非同期専用のデバイスハンドルを作成し完了コールバックを登録
+    i2c_device_config_t dev_conf = {};
+    dev_conf.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    dev_conf.device_address = device_address;
+    dev_conf.scl_speed_hz = config_.frequency;
+    
+    i2c_master_dev_handle_t handle = nullptr;
+    esp_err_t ret = i2c_master_bus_add_device(bus_handle_, &dev_conf, &handle);
+    if (ret != ESP_OK) {
+        logError("I2C非同期デバイス追加失敗 アドレス:0x%02X エラー:%s", 
+                 device_address, esp_err_to_name(ret));
+        return nullptr;
+    }
+    
+    i2c_master_event_callbacks_t cbs = {};
+    cbs.on_trans_done = asyncDoneHandler;
+    ret = i2c_master_register_event_callbacks(handle, &cbs, free_slot);
+    if (ret != ESP_OK) {
+        i2c_master_bus_rm_device(handle);
+        logError("I2C完了コールバック登録失敗 アドレス:0x%02X エラー:%s", 
+                 device_address, esp_err_to_name(ret));
+        return nullptr;
+    }
+    
+    free_slot->handle = handle;
+    free_slot->device_address = device_address;
+    free_slot->assigned.store(true, std::memory_order_release);
+    
+    logDebug("I2C非同期スロット割当 アドレス:0x%02X", device_address);
+    return free_slot;
+}
+
+void I2cHal::releaseBus() {
+    if (!driver_installed_) {
+        return;
+    }
+    
+    // 実行中の非同期転送を完了させてからハンドルを削除
+    i2c_master_bus_wait_all_done(bus_handle_, -1);
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (auto& slot : async_slots_) {
+        if (slot.assigned.load(std::memory_order_relaxed)) {
+            i2c_master_bus_rm_device(slot.handle);
+            slot.handle = nullptr;
+            slot.assigned.store(false, std::memory_order_relaxed);
+            slot.busy.store(false, std::memory_order_relaxed);
+        }
+    }
+    
+    for (auto& entry : device_handles_) {
+        i2c_master_dev_handle_t handle = entry.exchange(nullptr, std::memory_order_relaxed);
+        if (handle != nullptr) {
+            i2c_master_bus_rm_device(handle);
+        }
+    }
+    
+    esp_err_t ret = i2c_del_master_bus(bus_handle_);
+    if (ret != ESP_OK) {
+        logWarning("I2Cバス削除警告: %s", esp_err_to_name(ret));
+    }
+    bus_handle_ = nullptr;
+    driver_installed_ = false;
+    
+    logDebug("I2Cバス削除 ポート:%d", static_cast<int>(config_.port));
+}
+
+esp_err_t I2cHal::waitSyncDone(esp_err_t ret, TickType_t timeout) {
+    if (ret != ESP_OK || config_.async_queue_depth == 0) {
+        return ret;
+    }
+    // 非同期キューのバスでは転送APIが投入だけで戻るため、バッファを返す前に完了を待つ
+    return i2c_master_bus_wait_all_done(bus_handle_, toTimeoutMs(timeout));
+}
+
+int I2cHal::toTimeoutMs(TickType_t timeout) {
+    if (timeout == portMAX_DELAY) {
+        return -1;
+    }
+    return static_cast<int>(pdTICKS_TO_MS(timeout));
+}
+
+bool IRAM_ATTR I2cHal::asyncDoneHandler(i2c_master_dev_handle_t dev, 
+                                        const i2c_master_event_data_t* edata, void* user_data) {
+    AsyncSlot* slot = static_cast<AsyncSlot*>(user_data);
+    
+    esp_err_t result;
+    switch (edata->event) {
+        case I2C_EVENT_DONE:
+            result = ESP_OK;
+            break;
+        case I2C_EVENT_NACK:
+            result = ESP_FAIL;
+            break;
+        case I2C_EVENT_TIMEOUT:
+            result = ESP_ERR_TIMEOUT;
+            break;
+        default:
+            return false;   // 転送継続中
+    }
+    
+    // コールバック内で次の転送を開始できるよう、先にbusyを解除する
+    AsyncCallback callback = slot->callback;
+    void* user_arg = slot->user_arg;
+    slot->busy.store(false, std::memory_order_release);
+    
+    if (callback == nullptr) {
+        return false;
+    }
+    return callback(result, user_arg);
+}
+
+} // namespace hal
+
+#endif // HAL_I2C_USE_MASTER_DRIVER
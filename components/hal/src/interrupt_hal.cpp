@@ -10,15 +10,64 @@
  */
 
 #include "interrupt_hal.hpp"
+#include "interrupt_plan.hpp"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_cpu.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "sdkconfig.h"
+#include <cstring>
 
 namespace hal {
 
+namespace {
+
+constexpr uint32_t CYCLES_PER_US = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+constexpr uint32_t NO_LATENCY_SAMPLE = UINT32_MAX;
+constexpr int STATS_READ_RETRIES = 8;
+constexpr uint32_t MAX_VALID_CYCLES = 0x80000000u;     // これ以上の差分はコア移動による無効値
+
+/**
+ * @brief 遅延ヒストグラムのビン上限（サイクル数、μs × CYCLES_PER_US を事前計算）
+ * 
+ * recordLatency() はESP_INTR_FLAG_IRAMの割り込みからも呼ばれ、フラッシュの書き込み・消去で
+ * キャッシュが止まっている間も動く。constexprの表は.rodata（フラッシュ）に置かれるため、
+ * DRAM_ATTRで内部RAMに置く
+ */
+DRAM_ATTR const uint32_t LATENCY_BUCKET_LIMIT_CYCLES[InterruptHal::LATENCY_HISTOGRAM_BUCKETS - 1] = {
+    1 * CYCLES_PER_US, 2 * CYCLES_PER_US, 5 * CYCLES_PER_US, 10 * CYCLES_PER_US, 20 * CYCLES_PER_US, 
+    50 * CYCLES_PER_US, 100 * CYCLES_PER_US, 200 * CYCLES_PER_US, 500 * CYCLES_PER_US
+};
+
+/**
+ * @brief μsをサイクル数へ変換（上限で飽和）
+ */
+inline uint32_t usToCycles(uint64_t us) {
+    uint64_t cycles = us * CYCLES_PER_US;
+    return cycles >= NO_LATENCY_SAMPLE ? NO_LATENCY_SAMPLE - 1 : static_cast<uint32_t>(cycles);
+}
+
+/**
+ * @brief 開始サイクルからの経過サイクル数（コア移動時は0）
+ */
+inline uint32_t IRAM_ATTR elapsedCycles(uint32_t start_cycles) {
+    uint32_t delta = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    return delta < MAX_VALID_CYCLES ? delta : 0;
+}
+
+} // namespace
+
 InterruptHal::InterruptHal() 
     : HalBase("INTERRUPT_HAL") {
     portMUX_INITIALIZE(&critical_mux_);
+    for (auto& slot : latency_slots_) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.in_use.store(false, std::memory_order_relaxed);
+        slot.reset_requested.store(false, std::memory_order_relaxed);
+        slot.probe_cycles.store(0, std::memory_order_relaxed);
+        slot.probe_core.store(-1, std::memory_order_relaxed);
+    }
     logDebug("Interrupt HALクラス作成");
 }
 
@@ -78,12 +127,8 @@ esp_err_t InterruptHal::stop() {
 
 esp_err_t InterruptHal::reset() {
     // 統計情報をリセット
-    for (auto& pair : timers_) {
-        pair.second.stats = {};
-    }
-    
-    for (auto& pair : interrupts_) {
-        pair.second.stats = {};
+    for (auto& slot : latency_slots_) {
+        slot.reset_requested.store(true, std::memory_order_release);
     }
     
     setState(State::INITIALIZED);
@@ -91,7 +136,21 @@ esp_err_t InterruptHal::reset() {
     return ESP_OK;
 }
 
+esp_err_t InterruptHal::createHighResTimer(uint32_t timer_id, const TimerConfig& config,  
+                                           IsrTimerCallback callback, void* context) {
+    if (callback == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return createHighResTimer(timer_id, config, TimerCallback::fromFunction(callback, context));
+}
+
 esp_err_t InterruptHal::createHighResTimer(uint32_t timer_id, const TimerConfig& config, TimerCallback callback) {
+#if !CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (config.run_in_isr) {
+        logError("ESP_TIMER_ISRディスパッチが無効です（CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD）");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+#endif
     if (!isRunning()) {
         logError("Interrupt HALが動作していません");
         return ESP_ERR_INVALID_STATE;
@@ -106,26 +165,39 @@ esp_err_t InterruptHal::createHighResTimer(uint32_t timer_id, const TimerConfig&
         return ESP_ERR_INVALID_ARG;
     }
     
+    LatencySlot* slot = acquireLatencySlot(timer_id, true);
+    if (slot == nullptr) {
+        logError("統計スロットが不足しています ID:%d", timer_id);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // コールバック引数としてノードのアドレスを渡すため先にmapへ挿入する
+    TimerInfo& timer_info = timers_[timer_id];
+    timer_info.config = config;
+    timer_info.callback = callback;
+    timer_info.latency = slot;
+    
     // タイマー設定を作成
     esp_timer_create_args_t timer_args = {};
     timer_args.callback = espTimerCallback;
-    timer_args.arg = reinterpret_cast<void*>(timer_id);
+    timer_args.arg = &timer_info;
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    timer_args.dispatch_method = config.run_in_isr ? ESP_TIMER_ISR : ESP_TIMER_TASK;
+#else
+    timer_args.dispatch_method = ESP_TIMER_TASK;
+#endif
     timer_args.name = "hal_timer";
     timer_args.skip_unhandled_events = true;
     
-    TimerInfo timer_info;
-    timer_info.config = config;
-    timer_info.callback = callback;
-    timer_info.stats = {};
-    
     // タイマーを作成
     esp_err_t ret = esp_timer_create(&timer_args, &timer_info.handle);
     if (ret != ESP_OK) {
         logError("タイマー作成失敗 ID:%d: %s", timer_id, esp_err_to_name(ret));
+        releaseLatencySlot(slot);
+        timers_.erase(timer_id);
         return ret;
     }
     
-    timers_[timer_id] = timer_info;
     logInfo("高分解能タイマー作成 ID:%d 周期:%lluus", timer_id, config.period_us);
     
     return ESP_OK;
@@ -140,6 +212,8 @@ esp_err_t InterruptHal::startTimer(uint32_t timer_id) {
         return ESP_ERR_NOT_FOUND;
     }
     
+    armTimerLatency(it->second, it->second.config.period_us);
+    
     esp_err_t ret;
     if (it->second.config.auto_reload) {
         ret = esp_timer_start_periodic(it->second.handle, it->second.config.period_us);
@@ -192,6 +266,7 @@ esp_err_t InterruptHal::deleteTimer(uint32_t timer_id) {
         return ret;
     }
     
+    releaseLatencySlot(it->second.latency);
     timers_.erase(it);
     logInfo("タイマー削除 ID:%d", timer_id);
     
@@ -212,6 +287,7 @@ esp_err_t InterruptHal::setTimerPeriod(uint32_t timer_id, uint64_t period_us) {
     
     // 設定を更新
     it->second.config.period_us = period_us;
+    armTimerLatency(it->second, period_us);
     
     // タイマーを再開
     esp_err_t ret;
@@ -245,22 +321,31 @@ esp_err_t InterruptHal::registerInterrupt(uint32_t interrupt_id, const SourceCon
         return ESP_ERR_INVALID_ARG;
     }
     
-    InterruptInfo interrupt_info;
+    LatencySlot* slot = acquireLatencySlot(interrupt_id, false);
+    if (slot == nullptr) {
+        logError("統計スロットが不足しています ID:%d", interrupt_id);
+        return ESP_ERR_NO_MEM;
+    }
+    slot->budget_cycles = usToCycles(config.budget_us);
+    
+    // ハンドラ引数としてノードのアドレスを渡すため先にmapへ挿入する
+    InterruptInfo& interrupt_info = interrupts_[interrupt_id];
     interrupt_info.config = config;
     interrupt_info.handler = handler;
-    interrupt_info.stats = {};
+    interrupt_info.latency = slot;
     
     // 割り込みを登録
     esp_err_t ret = esp_intr_alloc(config.source, config.flags, 
                                   interruptHandlerWrapper, 
-                                  reinterpret_cast<void*>(interrupt_id), 
+                                  &interrupt_info,  
                                   &interrupt_info.handle);
     if (ret != ESP_OK) {
         logError("割り込み登録失敗 ID:%d ソース:%d: %s", interrupt_id, config.source, esp_err_to_name(ret));
+        releaseLatencySlot(slot);
+        interrupts_.erase(interrupt_id);
         return ret;
     }
     
-    interrupts_[interrupt_id] = interrupt_info;
     logInfo("割り込み登録 ID:%d ソース:%d 優先度:%d", 
             interrupt_id, config.source, static_cast<int>(config.priority));
     
@@ -282,6 +367,7 @@ esp_err_t InterruptHal::unregisterInterrupt(uint32_t interrupt_id) {
         return ret;
     }
     
+    releaseLatencySlot(it->second.latency);
     interrupts_.erase(it);
     logInfo("割り込み解除 ID:%d", interrupt_id);
     
@@ -346,12 +432,14 @@ esp_err_t InterruptHal::setPriority(uint32_t interrupt_id, Priority priority) {
     // 新しい優先度で割り込みを再登録
     esp_intr_free(it->second.handle);
     
+    // レベルのビットを置き換える（論理和では元のレベルが残り、複数レベル指定になる）
     it->second.config.priority = priority;
-    it->second.config.flags |= static_cast<int>(priority);
+    it->second.config.flags = (it->second.config.flags & ~ESP_INTR_FLAG_LEVELMASK) | 
+                              (ESP_INTR_FLAG_LEVEL1 << (static_cast<int>(priority) - 1));
     
     esp_err_t ret = esp_intr_alloc(it->second.config.source, it->second.config.flags,
                                   interruptHandlerWrapper, 
-                                  reinterpret_cast<void*>(interrupt_id),
+                                  &it->second, 
                                   &it->second.handle);
     if (ret != ESP_OK) {
         logError("割り込み優先度変更失敗 ID:%d: %s", interrupt_id, esp_err_to_name(ret));
@@ -363,53 +451,146 @@ esp_err_t InterruptHal::setPriority(uint32_t interrupt_id, Priority priority) {
 }
 
 esp_err_t InterruptHal::setCpuAffinity(uint32_t interrupt_id, uint32_t cpu_mask) {
-    // ESP32-S3では特定CPUへの割り込み親和性設定は限定的
-    logWarning("CPU親和性設定は部分的にサポートされています ID:%d マスク:0x%x", interrupt_id, cpu_mask);
+    // 割り込みは確保したコアに固定されるため、指定できるのは1つのコアだけ
+    if (cpu_mask == 0 || (cpu_mask & (cpu_mask - 1)) != 0 || cpu_mask >= (1u << portNUM_PROCESSORS)) {
+        logError("CPUマスク 0x%x は1つのコアを指定してください ID:%d", cpu_mask, interrupt_id);
+        return ESP_ERR_INVALID_ARG;
+    }
+    const BaseType_t core = static_cast<BaseType_t>(__builtin_ctz(cpu_mask));
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    auto it = interrupts_.find(interrupt_id);
+    if (it == interrupts_.end()) {
+        logError("割り込みID %d が見つかりません", interrupt_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    InterruptInfo* info = &it->second;
+    if (esp_intr_get_cpu(info->handle) == core) {
+        return ESP_OK;
+    }
+    
+    // 対象コアで解放・再確保する
+    esp_err_t ret = InterruptPlan::runOnCore(core, [info]() {
+        esp_intr_free(info->handle);
+        return esp_intr_alloc(info->config.source, info->config.flags, interruptHandlerWrapper, info, &info->handle);
+    });
+    if (ret != ESP_OK) {
+        logError("CPU親和性変更失敗 ID:%d コア:%d: %s", interrupt_id, static_cast<int>(core), esp_err_to_name(ret));
+        return ret;
+    }
+    
+    logInfo("CPU親和性変更 ID:%d コア:%d", interrupt_id, static_cast<int>(core));
     return ESP_OK;
 }
 
-esp_err_t InterruptHal::getStatistics(uint32_t interrupt_id, Statistics& stats) {
-    std::lock_guard<std::mutex> lock(mutex_);
+esp_err_t InterruptHal::getStatistics(uint32_t interrupt_id, Statistics& stats) const {
+    const LatencySlot* slot = findLatencySlot(interrupt_id);
+    if (slot == nullptr) {
+        logError("ID %d が見つかりません", interrupt_id);
+        return ESP_ERR_NOT_FOUND;
+    }
     
-    // タイマー統計を確認
-    auto timer_it = timers_.find(interrupt_id);
-    if (timer_it != timers_.end()) {
-        stats = timer_it->second.stats;
+    stats = {};
+    if (slot->reset_requested.load(std::memory_order_acquire)) {
         return ESP_OK;
     }
     
-    // 割り込み統計を確認
-    auto interrupt_it = interrupts_.find(interrupt_id);
-    if (interrupt_it != interrupts_.end()) {
-        stats = interrupt_it->second.stats;
+    // シーケンスロックで一貫したコピーを取得（書き込み側は待たせない）
+    for (int attempt = 0; attempt < STATS_READ_RETRIES; attempt++) {
+        const uint32_t before = slot->sequence.load(std::memory_order_acquire);
+        if (before & 1) {
+            continue;
+        }
+        uint32_t total_count = slot->total_count;
+        uint32_t missed_count = slot->missed_count;
+        uint32_t overrun_count = slot->overrun_count;
+        uint32_t latency_samples = slot->latency_samples;
+        uint32_t min_latency = slot->min_latency_cycles;
+        uint32_t max_latency = slot->max_latency_cycles;
+        uint64_t total_latency = slot->total_latency_cycles;
+        uint32_t max_exec = slot->max_exec_cycles;
+        uint64_t total_exec = slot->total_exec_cycles;
+        memcpy(stats.histogram, slot->histogram, sizeof(stats.histogram));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != before) {
+            continue;
+        }
+        
+        stats.total_count = total_count;
+        stats.missed_count = missed_count;
+        stats.overrun_count = overrun_count;
+        stats.latency_samples = latency_samples;
+        stats.min_latency_cycles = latency_samples > 0 ? min_latency : 0;
+        stats.max_latency_cycles = max_latency;
+        stats.avg_latency_cycles = latency_samples > 0 ? static_cast<uint32_t>(total_latency / latency_samples) : 0;
+        stats.max_exec_cycles = max_exec;
+        stats.avg_exec_cycles = total_count > 0 ? static_cast<uint32_t>(total_exec / total_count) : 0;
+        stats.max_latency_us = max_latency / CYCLES_PER_US;
+        stats.avg_latency_us = stats.avg_latency_cycles / CYCLES_PER_US;
         return ESP_OK;
     }
     
-    logError("ID %d が見つかりません", interrupt_id);
-    return ESP_ERR_NOT_FOUND;
+    return ESP_ERR_INVALID_STATE;
 }
 
 esp_err_t InterruptHal::resetStatistics(uint32_t interrupt_id) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // タイマー統計をリセット
-    auto timer_it = timers_.find(interrupt_id);
-    if (timer_it != timers_.end()) {
-        timer_it->second.stats = {};
-        logInfo("タイマー統計リセット ID:%d", interrupt_id);
-        return ESP_OK;
+    LatencySlot* slot = findLatencySlot(interrupt_id);
+    if (slot == nullptr) {
+        logError("ID %d が見つかりません", interrupt_id);
+        return ESP_ERR_NOT_FOUND;
     }
     
-    // 割り込み統計をリセット
-    auto interrupt_it = interrupts_.find(interrupt_id);
-    if (interrupt_it != interrupts_.end()) {
-        interrupt_it->second.stats = {};
-        logInfo("割り込み統計リセット ID:%d", interrupt_id);
-        return ESP_OK;
+    slot->reset_requested.store(true, std::memory_order_release);
+    logInfo("%s統計リセット ID:%d", slot->is_timer ? "タイマー" : "割り込み", interrupt_id);
+    return ESP_OK;
+}
+
+void IRAM_ATTR InterruptHal::markInterruptTrigger(uint32_t interrupt_id) {
+    LatencySlot* slot = findLatencySlot(interrupt_id);
+    if (slot == nullptr) {
+        return;
     }
     
-    logError("ID %d が見つかりません", interrupt_id);
-    return ESP_ERR_NOT_FOUND;
+    uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    slot->probe_core.store(xPortGetCoreID(), std::memory_order_relaxed);
+    slot->probe_cycles.store(cycles != 0 ? cycles : 1, std::memory_order_release);
+}
+
+void InterruptHal::dumpStatistics() const {
+    for (const auto& slot : latency_slots_) {
+        if (!slot.in_use.load(std::memory_order_acquire)) {
+            continue;
+        }
+        
+        Statistics stats;
+        if (getStatistics(slot.id, stats) != ESP_OK) {
+            continue;
+        }
+        
+        ESP_LOGI(getComponentName(), "%s ID:%lu 回数:%llu 取りこぼし:%llu 超過:%llu 遅延(平均/最大):%llu/%lluus 実行(平均/最大):%lu/%luus",  
+                 slot.is_timer ? "タイマー" : "割り込み",  
+                 static_cast<unsigned long>(slot.id),  
+                 static_cast<unsigned long long>(stats.total_count),  
+                 static_cast<unsigned long long>(stats.missed_count),  
+                 static_cast<unsigned long long>(stats.overrun_count),  
+                 static_cast<unsigned long long>(stats.avg_latency_us),  
+                 static_cast<unsigned long long>(stats.max_latency_us),  
+                 static_cast<unsigned long>(stats.avg_exec_cycles / CYCLES_PER_US),  
+                 static_cast<unsigned long>(stats.max_exec_cycles / CYCLES_PER_US));
+        
+        char line[128];
+        size_t length = 0;
+        for (size_t b = 0; b < LATENCY_HISTOGRAM_BUCKETS && length < sizeof(line); b++) {
+            int written = snprintf(line + length, sizeof(line) - length, " %lu",  
+                                   static_cast<unsigned long>(stats.histogram[b]));
+            if (written < 0) {
+                break;
+            }
+            length += static_cast<size_t>(written);
+        }
+        ESP_LOGI(getComponentName(), "  遅延ヒストグラム(<1,2,5,10,20,50,100,200,500,≥500us):%s", line);
+    }
 }
 
 int InterruptHal::getCurrentCpu() {
@@ -429,48 +610,151 @@ void InterruptHal::exitCriticalSection(portMUX_TYPE* mux) {
     portEXIT_CRITICAL(mux);
 }
 
-void InterruptHal::espTimerCallback(void* arg) {
-    uint32_t timer_id = reinterpret_cast<uintptr_t>(arg);
+InterruptHal::LatencySlot* InterruptHal::acquireLatencySlot(uint32_t id, bool is_timer) {
+    for (auto& slot : latency_slots_) {
+        if (slot.in_use.load(std::memory_order_relaxed)) {
+            continue;
+        }
     
-    // インスタンスを静的に取得（簡略化のため）
-    // 実際の実装では、より安全な方法でインスタンスを管理する必要があります
-    static InterruptHal* instance = nullptr;
-    if (!instance) {
-        return;
+        slot.id = id;
+        slot.is_timer = is_timer;
+        slot.period_us = 0;
+        slot.next_expected_us = 0;
+        slot.budget_cycles = 0;
+        slot.probe_cycles.store(0, std::memory_order_relaxed);
+        slot.probe_core.store(-1, std::memory_order_relaxed);
+        slot.reset_requested.store(true, std::memory_order_relaxed);
+        slot.in_use.store(true, std::memory_order_release);
+        return &slot;
+    }
+    return nullptr;
+}
+    
+void InterruptHal::releaseLatencySlot(LatencySlot* slot) {
+    if (slot != nullptr) {
+        slot->in_use.store(false, std::memory_order_release);
     }
+}
+
+InterruptHal::LatencySlot* IRAM_ATTR InterruptHal::findLatencySlot(uint32_t id) const {
+    for (const auto& slot : latency_slots_) {
+        if (slot.in_use.load(std::memory_order_acquire) && slot.id == id) {
+            return const_cast<LatencySlot*>(&slot);
+        }
+    }
+    return nullptr;
+}
     
-    auto it = instance->timers_.find(timer_id);
-    if (it != instance->timers_.end()) {
-        // 統計更新
-        it->second.stats.total_count++;
+void InterruptHal::armTimerLatency(TimerInfo& info, uint64_t period_us) {
+    LatencySlot* slot = info.latency;
+    slot->period_us = period_us;
+    slot->next_expected_us = esp_timer_get_time() + static_cast<int64_t>(period_us);
+}
+
+void IRAM_ATTR InterruptHal::recordLatency(LatencySlot* slot, uint32_t latency_cycles, uint32_t exec_cycles,  
+                                           bool missed, bool overrun) {
+    const uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    if (slot->reset_requested.exchange(false, std::memory_order_acq_rel)) {
+        slot->total_count = 0;
+        slot->missed_count = 0;
+        slot->overrun_count = 0;
+        slot->latency_samples = 0;
+        slot->min_latency_cycles = UINT32_MAX;
+        slot->max_latency_cycles = 0;
+        slot->total_latency_cycles = 0;
+        slot->max_exec_cycles = 0;
+        slot->total_exec_cycles = 0;
+        memset(slot->histogram, 0, sizeof(slot->histogram));
+    }
+    
+    slot->total_count++;
+    if (missed) {
+        slot->missed_count++;
+    }
+    if (overrun) {
+        slot->overrun_count++;
+    }
+    if (exec_cycles > slot->max_exec_cycles) {
+        slot->max_exec_cycles = exec_cycles;
+    }
+    slot->total_exec_cycles += exec_cycles;
+        
+    if (latency_cycles != NO_LATENCY_SAMPLE) {
+        slot->latency_samples++;
+        if (latency_cycles < slot->min_latency_cycles) {
+            slot->min_latency_cycles = latency_cycles;
+        }
+        if (latency_cycles > slot->max_latency_cycles) {
+            slot->max_latency_cycles = latency_cycles;
+        }
+        slot->total_latency_cycles += latency_cycles;
         
-        // コールバック実行
-        if (it->second.callback) {
-            it->second.callback();
+        size_t bucket = 0;
+        while (bucket < LATENCY_HISTOGRAM_BUCKETS - 1 && 
+               latency_cycles >= LATENCY_BUCKET_LIMIT_CYCLES[bucket]) {
+            bucket++;
         }
+        slot->histogram[bucket]++;
     }
+    
+    slot->sequence.store(sequence + 2, std::memory_order_release);
 }
 
-void IRAM_ATTR InterruptHal::interruptHandlerWrapper(void* arg) {
-    uint32_t interrupt_id = reinterpret_cast<uintptr_t>(arg);
+void IRAM_ATTR InterruptHal::espTimerCallback(void* arg) {
+    int64_t entry_us = esp_timer_get_time();
+    uint32_t entry_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    TimerInfo* info = static_cast<TimerInfo*>(arg);
+    LatencySlot* slot = info->latency;
     
-    // インスタンスを静的に取得（簡略化のため）
-    // 実際の実装では、より安全な方法でインスタンスを管理する必要があります
-    static InterruptHal* instance = nullptr;
-    if (!instance) {
-        return;
+    // 予定発火時刻からの遅延（esp_timerはμs基準のためμs分解能）
+    int64_t late_us = entry_us - slot->next_expected_us;
+    if (late_us < 0) {
+        late_us = 0;
+    }
+    uint64_t period_us = slot->period_us;
+    bool missed = info->config.auto_reload && period_us > 0 && static_cast<uint64_t>(late_us) >= period_us;
+    if (info->config.auto_reload) {
+        // skip_unhandled_events有効時は遅延した周期を飛ばして現在時刻から再整列される
+        slot->next_expected_us = missed ? entry_us + static_cast<int64_t>(period_us) 
+                                        : slot->next_expected_us + static_cast<int64_t>(period_us);
     }
     
-    auto it = instance->interrupts_.find(interrupt_id);
-    if (it != instance->interrupts_.end()) {
-        // 統計更新
-        it->second.stats.total_count++;
-        
-        // ハンドラ実行
-        if (it->second.handler) {
-            it->second.handler();
+    // コールバック実行
+    if (info->callback) {
+        info->callback();
+    }
+    
+    uint32_t exec_cycles = elapsedCycles(entry_cycles);
+    bool overrun = period_us > 0 && exec_cycles >= usToCycles(period_us);
+    recordLatency(slot, usToCycles(static_cast<uint64_t>(late_us)), exec_cycles, missed, overrun);
+}
+
+void IRAM_ATTR InterruptHal::interruptHandlerWrapper(void* arg) {
+    uint32_t entry_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    InterruptInfo* info = static_cast<InterruptInfo*>(arg);
+    LatencySlot* slot = info->latency;
+    
+    // 発生要因の記録があれば同一コアの場合のみサイクル差を遅延とする
+    uint32_t latency_cycles = NO_LATENCY_SAMPLE;
+    uint32_t probe_cycles = slot->probe_cycles.exchange(0, std::memory_order_acquire);
+    if (probe_cycles != 0 && slot->probe_core.load(std::memory_order_relaxed) == xPortGetCoreID()) {
+        uint32_t delta = entry_cycles - probe_cycles;
+        if (delta < MAX_VALID_CYCLES) {
+            latency_cycles = delta;
         }
     }
+    
+    // ハンドラ実行
+    if (info->handler) {
+        info->handler();
+    }
+    
+    uint32_t exec_cycles = elapsedCycles(entry_cycles);
+    bool overrun = slot->budget_cycles > 0 && exec_cycles > slot->budget_cycles;
+    recordLatency(slot, latency_cycles, exec_cycles, false, overrun);
 }
 
 } // namespace hal
\ No newline at end of file
@@ -0,0 +1,121 @@
+/*
+ * Interrupt Plan Implementation
+ * 
+ * HAL割り込みのコア・レベル・IRAMフラグの配置表実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "interrupt_plan.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstdio>
+
+namespace hal {
+
+static const char* TAG = "hal::InterruptPlan";
+
+InterruptPlan::Record InterruptPlan::records_[static_cast<size_t>(Source::COUNT)] = {};
+
+namespace {
+
+constexpr uint32_t JOB_STACK_SIZE = 4096;           // 一時タスクのスタック（Wi-Fi初期化を含む）
+
+/**
+ * @brief 一時タスクへ渡す処理
+ */
+struct Job {
+    InterruptPlan::Installer* installer;
+    TaskHandle_t waiter;
+    esp_err_t result;
+    BaseType_t core;
+};
+
+void jobEntry(void* arg) {
+    Job* job = static_cast<Job*>(arg);
+    job->core = xPortGetCoreID();
+    job->result = (*job->installer)();
+    xTaskNotifyGive(job->waiter);
+    vTaskDelete(nullptr);
+}
+
+} // namespace
+
+esp_err_t InterruptPlan::runOnCore(BaseType_t core, Installer installer, BaseType_t* ran_core) {
+    if (!installer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (core == tskNO_AFFINITY || core == xPortGetCoreID()) {
+        if (ran_core != nullptr) {
+            *ran_core = xPortGetCoreID();
+        }
+        return installer();
+    }
+    
+    // 呼び出し元と同じ優先度の一時タスクを対象コアに作り、完了をタスク通知で待つ
+    // （jobは呼び出し元のスタック上にあるため、完了まで待ち切る）
+    Job job = {&installer, xTaskGetCurrentTaskHandle(), ESP_FAIL, tskNO_AFFINITY};
+    if (xTaskCreatePinnedToCore(jobEntry, "intr_alloc", JOB_STACK_SIZE, &job, uxTaskPriorityGet(nullptr), 
+                                nullptr, core) != pdPASS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    if (ran_core != nullptr) {
+        *ran_core = job.core;
+    }
+    return job.result;
+}
+
+esp_err_t InterruptPlan::install(Source s, Installer installer) {
+    const Entry& e = entry(s);
+    Record& record = records_[static_cast<size_t>(s)];
+    const int64_t start_us = esp_timer_get_time();
+    BaseType_t core = tskNO_AFFINITY;
+    esp_err_t ret = runOnCore(e.core, installer, &core);
+    record.installed = true;
+    record.core = core;
+    record.result = ret;
+    record.elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "%s の確保失敗（コア%d）: %s", e.name, static_cast<int>(e.core), esp_err_to_name(ret));
+    } else {
+        ESP_LOGI(TAG, "%s をコア%d レベル%d%s で確保", e.name, static_cast<int>(core), e.level, e.iram ? " IRAM" : "");
+    }
+    return ret;
+}
+
+size_t InterruptPlan::checkIsolation(BaseType_t control_core) {
+    size_t violations = 0;
+    for (size_t i = 0; i < static_cast<size_t>(Source::COUNT); i++) {
+        const Entry& e = TABLE[i];
+        const Record& r = records_[i];
+        if (r.installed && r.result == ESP_OK && r.core == control_core && !e.realtime) {
+            ESP_LOGW(TAG, "%s が制御コア%d にあります（制御周期の揺らぎの原因）", e.name, static_cast<int>(control_core));
+            violations++;
+        }
+    }
+    return violations;
+}
+
+void InterruptPlan::dump() {
+    ESP_LOGI(TAG, "  %-14s 予定 確保 レベル IRAM 結果", "割り込み源");
+    for (size_t i = 0; i < static_cast<size_t>(Source::COUNT); i++) {
+        const Entry& e = TABLE[i];
+        const Record& r = records_[i];
+        if (!r.installed) {
+            ESP_LOGI(TAG, "  %-14s  %2d    -   %d    %s  未確保", e.name, static_cast<int>(e.core), e.level, 
+                     e.iram ? "有" : "無");
+            continue;
+        }
+        ESP_LOGI(TAG, "  %-14s  %2d   %2d   %d    %s  %s（%luμs）", e.name, static_cast<int>(e.core), 
+                 static_cast<int>(r.core), e.level, e.iram ? "有" : "無", esp_err_to_name(r.result), 
+                 static_cast<unsigned long>(r.elapsed_us));
+    }
+    // HAL以外（esp_timer・フラッシュ・IPC等）を含む全割り込みの割り当て
+    esp_intr_dump(stdout);
+}
+
+} // namespace hal
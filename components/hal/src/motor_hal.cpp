@@ -0,0 +1,282 @@
+/*
+ * Motor HAL Class Implementation
+ * 
+ * モーター出力用のハードウェア抽象化レイヤー実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "motor_hal.hpp"
+#include "esp_log.h"
+
+namespace hal {
+
+MotorHal::MotorHal()
+    : HalBase("MOTOR_HAL")
+    , timer_(nullptr)
+    , operators_{}
+    , comparators_{}
+    , generators_{}
+    , duty_{}
+    , period_ticks_(0)
+    , timer_enabled_(false) {
+    // StampFly標準のモーターピン配置
+    config_.pins = {GPIO_NUM_5, GPIO_NUM_42, GPIO_NUM_10, GPIO_NUM_41};
+    config_.group_id = 0;
+    config_.resolution_hz = 80000000;   // 80MHz
+    config_.frequency_hz = 150000;      // 150kHz（533ティック）
+    portMUX_INITIALIZE(&spinlock_);
+    
+    logDebug("Motor HALクラス作成");
+}
+
+MotorHal::~MotorHal() {
+    if (isRunning()) {
+        stop();
+    }
+    releaseResources();
+    logDebug("Motor HALクラス破棄");
+}
+
+esp_err_t MotorHal::initialize() {
+    setState(State::INITIALIZING);
+    
+    if (config_.frequency_hz == 0 || config_.resolution_hz < config_.frequency_hz * 2) {
+        logError("無効なPWM設定 分解能:%luHz 周波数:%luHz", 
+                 static_cast<unsigned long>(config_.resolution_hz), 
+                 static_cast<unsigned long>(config_.frequency_hz));
+        setState(State::ERROR);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    period_ticks_ = config_.resolution_hz / config_.frequency_hz;
+    
+    // 4出力で共有するタイマー
+    mcpwm_timer_config_t timer_config = {};
+    timer_config.group_id = config_.group_id;
+    timer_config.clk_src = MCPWM_TIMER_CLK_SRC_DEFAULT;
+    timer_config.resolution_hz = config_.resolution_hz;
+    timer_config.count_mode = MCPWM_TIMER_COUNT_MODE_UP;
+    timer_config.period_ticks = period_ticks_;
+    
+    esp_err_t ret = mcpwm_new_timer(&timer_config, &timer_);
+    if (ret != ESP_OK) {
+        logError("MCPWMタイマー作成失敗: %s", esp_err_to_name(ret));
+        releaseResources();
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    mcpwm_operator_config_t operator_config = {};
+    operator_config.group_id = config_.group_id;
+    operator_config.flags.update_gen_action_on_tez = 1;
+    
+    for (size_t i = 0; i < operators_.size(); i++) {
+        ret = mcpwm_new_operator(&operator_config, &operators_[i]);
+        if (ret == ESP_OK) {
+            ret = mcpwm_operator_connect_timer(operators_[i], timer_);
+        }
+        if (ret != ESP_OK) {
+            logError("MCPWMオペレータ%zu作成失敗: %s", i, esp_err_to_name(ret));
+            releaseResources();
+            setState(State::ERROR);
+            return ret;
+        }
+    }
+    
+    // コンパレータはタイマーゼロでのみ更新（4チャンネル同時ラッチ）
+    mcpwm_comparator_config_t comparator_config = {};
+    comparator_config.flags.update_cmp_on_tez = 1;
+    
+    for (size_t i = 0; i < MOTOR_COUNT; i++) {
+        mcpwm_oper_handle_t oper = operators_[i / 2];
+        
+        ret = mcpwm_new_comparator(oper, &comparator_config, &comparators_[i]);
+        if (ret != ESP_OK) {
+            logError("MCPWMコンパレータ%zu作成失敗: %s", i, esp_err_to_name(ret));
+            releaseResources();
+            setState(State::ERROR);
+            return ret;
+        }
+        mcpwm_comparator_set_compare_value(comparators_[i], 0);
+        
+        mcpwm_generator_config_t generator_config = {};
+        generator_config.gen_gpio_num = config_.pins[i];
+        ret = mcpwm_new_generator(oper, &generator_config, &generators_[i]);
+        if (ret != ESP_OK) {
+            logError("MCPWMジェネレータ%zu作成失敗 ピン%d: %s", i, config_.pins[i], esp_err_to_name(ret));
+            releaseResources();
+            setState(State::ERROR);
+            return ret;
+        }
+        
+        // タイマーゼロでHIGH、コンパレータ一致でLOW
+        mcpwm_generator_set_action_on_timer_event(generators_[i], 
+            MCPWM_GEN_TIMER_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, MCPWM_TIMER_EVENT_EMPTY, MCPWM_GEN_ACTION_HIGH));
+        mcpwm_generator_set_action_on_compare_event(generators_[i], 
+            MCPWM_GEN_COMPARE_EVENT_ACTION(MCPWM_TIMER_DIRECTION_UP, comparators_[i], MCPWM_GEN_ACTION_LOW));
+    }
+    
+    ret = mcpwm_timer_enable(timer_);
+    if (ret != ESP_OK) {
+        logError("MCPWMタイマー有効化失敗: %s", esp_err_to_name(ret));
+        releaseResources();
+        setState(State::ERROR);
+        return ret;
+    }
+    timer_enabled_ = true;
+    
+    duty_.fill(0.0f);
+    setState(State::INITIALIZED);
+    logInfo("Motor HAL初期化完了 周波数:%luHz 周期:%luティック", 
+            static_cast<unsigned long>(config_.frequency_hz), static_cast<unsigned long>(period_ticks_));
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::configure() {
+    if (!isInitialized()) {
+        logError("Motor HALが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 現在のデューティを再適用
+    return setAll(duty_);
+}
+
+esp_err_t MotorHal::start() {
+    if (!isInitialized()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    stopAll();
+    
+    esp_err_t ret = mcpwm_timer_start_stop(timer_, MCPWM_TIMER_START_NO_STOP);
+    if (ret != ESP_OK) {
+        logError("MCPWMタイマー開始失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    setState(State::RUNNING);
+    logInfo("Motor HAL開始");
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::stop() {
+    if (timer_ != nullptr) {
+        stopAll();
+        
+        // 周期の終わりで停止（出力はLOWで終わる）
+        esp_err_t ret = mcpwm_timer_start_stop(timer_, MCPWM_TIMER_STOP_EMPTY);
+        if (ret != ESP_OK) {
+            logWarning("MCPWMタイマー停止警告: %s", esp_err_to_name(ret));
+        }
+    }
+    
+    setState(State::SUSPENDED);
+    logInfo("Motor HAL停止");
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::reset() {
+    if (timer_ != nullptr) {
+        stopAll();
+    }
+    
+    setState(State::INITIALIZED);
+    logInfo("Motor HALリセット完了");
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::setConfig(const Config& config) {
+    if (timer_ != nullptr) {
+        logError("初期化後は設定変更できません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    config_ = config;
+    logDebug("Motor設定更新 周波数:%luHz", static_cast<unsigned long>(config_.frequency_hz));
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::setAll(const DutyArray& duty) {
+    if (timer_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 変換は先に済ませ、書き込み区間を最短にする
+    uint32_t ticks[MOTOR_COUNT];
+    for (size_t i = 0; i < MOTOR_COUNT; i++) {
+        ticks[i] = dutyToTicks(duty[i]);
+    }
+    
+    // 割り込み禁止で連続書き込みし、途中でタイマーゼロを跨ぐ確率を下げる
+    // （シャドウレジスタはチャンネル毎にラッチされるため、跨いだ場合は1周期の境界の前後に分かれる）
+    portENTER_CRITICAL_SAFE(&spinlock_);
+    for (size_t i = 0; i < MOTOR_COUNT; i++) {
+        mcpwm_comparator_set_compare_value(comparators_[i], ticks[i]);
+    }
+    portEXIT_CRITICAL_SAFE(&spinlock_);
+    
+    duty_ = duty;
+    return ESP_OK;
+}
+
+esp_err_t MotorHal::setMotor(Motor motor, float duty) {
+    size_t index = static_cast<size_t>(motor);
+    if (index >= MOTOR_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    DutyArray next = duty_;
+    next[index] = duty;
+    return setAll(next);
+}
+
+esp_err_t MotorHal::stopAll() {
+    DutyArray zero{};
+    return setAll(zero);
+}
+
+uint32_t MotorHal::dutyToTicks(float duty) const {
+    if (!(duty > 0.0f)) {
+        return 0;
+    }
+    if (duty >= 1.0f) {
+        return period_ticks_;
+    }
+    return static_cast<uint32_t>(duty * static_cast<float>(period_ticks_) + 0.5f);
+}
+
+void MotorHal::releaseResources() {
+    for (auto& generator : generators_) {
+        if (generator) {
+            mcpwm_del_generator(generator);
+            generator = nullptr;
+        }
+    }
+    for (auto& comparator : comparators_) {
+        if (comparator) {
+            mcpwm_del_comparator(comparator);
+            comparator = nullptr;
+        }
+    }
+    for (auto& oper : operators_) {
+        if (oper) {
+            mcpwm_del_operator(oper);
+            oper = nullptr;
+        }
+    }
+    if (timer_) {
+        if (timer_enabled_) {
+            mcpwm_timer_disable(timer_);
+            timer_enabled_ = false;
+        }
+        mcpwm_del_timer(timer_);
+        timer_ = nullptr;
+    }
+}
+
+} // namespace hal
@@ -121,7 +121,7 @@ esp_err_t NvsHal::openNamespace(const std::string& namespace_name, AccessMode mo
     }
     
     nvs_handle_t handle;
-    esp_err_t ret = nvs_open(namespace_name.c_str(), static_cast<nvs_open_mode_t>(mode), &handle);
+    esp_err_t ret = openHandle(namespace_name.c_str(), static_cast<nvs_open_mode_t>(mode), handle);
     if (ret != ESP_OK) {
         logError("名前空間オープン失敗 %s: %s", namespace_name.c_str(), esp_err_to_name(ret));
         return ret;
@@ -582,19 +582,28 @@ esp_err_t NvsHal::getStatistics(Statistics& stats) {
     return ESP_OK;
 }
 
-esp_err_t NvsHal::getNamespaceHandle(const std::string& namespace_name, nvs_handle_t& handle) {
+esp_err_t NvsHal::getHandle(std::string_view namespace_name, nvs_handle_t& handle) {
+    if (!isRunning()) {
+        logError("NVS HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    return getNamespaceHandle(namespace_name, handle);
+}
+
+esp_err_t NvsHal::getNamespaceHandle(std::string_view namespace_name, nvs_handle_t& handle) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     auto it = namespace_handles_.find(namespace_name);
     if (it == namespace_handles_.end()) {
-        // 自動的に名前空間を開く
-        esp_err_t ret = nvs_open(namespace_name.c_str(), NVS_READWRITE, &handle);
+        // 自動的に名前空間を開く（nvs_openはNUL終端の名前が必要）
+        std::string name(namespace_name);
+        esp_err_t ret = openHandle(name.c_str(), NVS_READWRITE, handle);
         if (ret != ESP_OK) {
-            logError("名前空間自動オープン失敗 %s: %s", namespace_name.c_str(), esp_err_to_name(ret));
+            logError("名前空間自動オープン失敗 %s: %s", name.c_str(), esp_err_to_name(ret));
             return ret;
         }
-        namespace_handles_[namespace_name] = handle;
-        logDebug("名前空間自動オープン: %s", namespace_name.c_str());
+        namespace_handles_.emplace(std::move(name), handle);
+        logDebug("名前空間自動オープン: %.*s", static_cast<int>(namespace_name.size()), namespace_name.data());
     } else {
         handle = it->second;
     }
@@ -602,4 +611,11 @@ esp_err_t NvsHal::getNamespaceHandle(const std::string& namespace_name, nvs_hand
     return ESP_OK;
 }
 
+esp_err_t NvsHal::openHandle(const char* namespace_name, nvs_open_mode_t mode, nvs_handle_t& handle) {
+    if (partition_label_.empty()) {
+        return nvs_open(namespace_name, mode, &handle);
+    }
+    return nvs_open_from_partition(partition_label_.c_str(), namespace_name, mode, &handle);
+}
+
 } // namespace hal
\ No newline at end of file
@@ -0,0 +1,228 @@
+/*
+ * NVS Parameter Set Implementation
+ * 
+ * NVS名前空間単位の型付きパラメータセット実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "nvs_param_set.hpp"
+#include "esp_log.h"
+
+namespace hal {
+
+static const char* TAG = "hal::NvsParamSet";
+
+NvsParamSet::NvsParamSet(NvsHal& nvs, std::string_view namespace_name, size_t capacity)
+    : nvs_(nvs)
+    , namespace_name_(namespace_name)
+    , handle_(0)
+    , handle_valid_(false)
+    , capacity_(capacity) {
+    pending_.reserve(capacity_);
+}
+
+esp_err_t NvsParamSet::open() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    esp_err_t ret = nvs_.getHandle(namespace_name_, handle_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "名前空間ハンドル取得失敗 %s: %s", namespace_name_.c_str(), esp_err_to_name(ret));
+        handle_valid_ = false;
+        return ret;
+    }
+    
+    handle_valid_ = true;
+    return ESP_OK;
+}
+
+esp_err_t NvsParamSet::commit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!handle_valid_) {
+        ESP_LOGE(TAG, "名前空間が開かれていません: %s", namespace_name_.c_str());
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (pending_.empty()) {
+        return ESP_OK;
+    }
+    
+    for (const auto& entry : pending_) {
+        esp_err_t ret = writeEntry(entry);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "書き込み失敗 %s/%s: %s", namespace_name_.c_str(), entry.key, esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    
+    esp_err_t ret = nvs_commit(handle_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "コミット失敗 %s: %s", namespace_name_.c_str(), esp_err_to_name(ret));
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "コミット完了 %s キー数:%u", namespace_name_.c_str(), static_cast<unsigned>(pending_.size()));
+    pending_.clear();
+    return ESP_OK;
+}
+
+void NvsParamSet::discard() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+}
+
+size_t NvsParamSet::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+esp_err_t NvsParamSet::stage(std::string_view key, Type type, uint64_t bits) {
+    char key_buffer[KEY_SIZE];
+    if (!copyKey(key, key_buffer)) {
+        ESP_LOGE(TAG, "キー名が不正です: %.*s", static_cast<int>(key.size()), key.data());
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    // 同じキーは最後の値で上書き（コミット時の書き込みはキーごとに1回）
+    for (auto& entry : pending_) {
+        if (strcmp(entry.key, key_buffer) == 0) {
+            entry.type = type;
+            entry.bits = bits;
+            return ESP_OK;
+        }
+    }
+    
+    if (pending_.size() >= capacity_) {
+        ESP_LOGE(TAG, "書き込み待ちが上限です %s（%u件）", namespace_name_.c_str(), static_cast<unsigned>(capacity_));
+        return ESP_ERR_NO_MEM;
+    }
+    
+    Entry entry;
+    memcpy(entry.key, key_buffer, KEY_SIZE);
+    entry.type = type;
+    entry.bits = bits;
+    pending_.push_back(entry);
+    return ESP_OK;
+}
+
+esp_err_t NvsParamSet::load(std::string_view key, Type type, uint64_t& bits) {
+    char key_buffer[KEY_SIZE];
+    if (!copyKey(key, key_buffer)) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (const auto& entry : pending_) {
+        if (strcmp(entry.key, key_buffer) == 0) {
+            if (entry.type != type) {
+                return ESP_ERR_NVS_TYPE_MISMATCH;
+            }
+            bits = entry.bits;
+            return ESP_OK;
+        }
+    }
+    
+    if (!handle_valid_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    switch (type) {
+        case Type::INT8: {
+            int8_t value = 0;
+            ret = nvs_get_i8(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::UINT8: {
+            uint8_t value = 0;
+            ret = nvs_get_u8(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::INT16: {
+            int16_t value = 0;
+            ret = nvs_get_i16(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::UINT16: {
+            uint16_t value = 0;
+            ret = nvs_get_u16(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::INT32: {
+            int32_t value = 0;
+            ret = nvs_get_i32(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::UINT32:
+        case Type::FLOAT: {
+            uint32_t value = 0;
+            ret = nvs_get_u32(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::INT64: {
+            int64_t value = 0;
+            ret = nvs_get_i64(handle_, key_buffer, &value);
+            bits = toBits(value);
+            break;
+        }
+        case Type::UINT64:
+        case Type::DOUBLE: {
+            uint64_t value = 0;
+            ret = nvs_get_u64(handle_, key_buffer, &value);
+            bits = value;
+            break;
+        }
+    }
+    
+    if (ret != ESP_OK && ret != ESP_ERR_NVS_NOT_FOUND) {
+        ESP_LOGE(TAG, "読み取り失敗 %s/%s: %s", namespace_name_.c_str(), key_buffer, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t NvsParamSet::writeEntry(const Entry& entry) {
+    switch (entry.type) {
+        case Type::INT8:
+            return nvs_set_i8(handle_, entry.key, fromBits<int8_t>(entry.bits));
+        case Type::UINT8:
+            return nvs_set_u8(handle_, entry.key, fromBits<uint8_t>(entry.bits));
+        case Type::INT16:
+            return nvs_set_i16(handle_, entry.key, fromBits<int16_t>(entry.bits));
+        case Type::UINT16:
+            return nvs_set_u16(handle_, entry.key, fromBits<uint16_t>(entry.bits));
+        case Type::INT32:
+            return nvs_set_i32(handle_, entry.key, fromBits<int32_t>(entry.bits));
+        case Type::UINT32:
+        case Type::FLOAT:
+            return nvs_set_u32(handle_, entry.key, fromBits<uint32_t>(entry.bits));
+        case Type::INT64:
+            return nvs_set_i64(handle_, entry.key, fromBits<int64_t>(entry.bits));
+        case Type::UINT64:
+        case Type::DOUBLE:
+            return nvs_set_u64(handle_, entry.key, entry.bits);
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+bool NvsParamSet::copyKey(std::string_view key, char (&buffer)[KEY_SIZE]) {
+    if (key.empty() || key.size() >= KEY_SIZE) {
+        return false;
+    }
+    memcpy(buffer, key.data(), key.size());
+    buffer[key.size()] = '\0';
+    return true;
+}
+
+} // namespace hal
@@ -17,7 +17,9 @@ namespace hal {
 
 PwmHal::PwmHal() 
     : HalBase("PWM_HAL")
-    , fade_service_installed_(false) {
+    , fade_service_installed_(false)
+    , channel_state_{}
+    , staged_mask_(0) {
     logDebug("PWM HALクラス作成");
 }
 
@@ -89,6 +91,10 @@ esp_err_t PwmHal::reset() {
     // 全設定をクリア
     timer_configs_.clear();
     channel_configs_.clear();
+    for (auto& state : channel_state_) {
+        state = ChannelState{};
+    }
+    staged_mask_.store(0, std::memory_order_relaxed);
     
     setState(State::INITIALIZED);
     logInfo("PWM HALリセット完了");
@@ -121,9 +127,16 @@ esp_err_t PwmHal::configureTimer(const TimerConfig& config) {
     // 設定を保存
     timer_configs_[config.timer_num] = config;
     
+    // このタイマーを使うチャンネルの換算係数を更新
+    for (const auto& pair : channel_configs_) {
+        if (pair.second.timer_sel == config.timer_num) {
+            updateDutyScale(pair.first);
+        }
+    }
+    
     logInfo("PWMタイマー設定完了 タイマー:%d 周波数:%dHz 分解能:%dビット",
             config.timer_num, config.frequency, 
-            static_cast<int>(config.resolution) + 1);
+            static_cast<int>(config.resolution));
     
     return ESP_OK;
 }
@@ -156,6 +169,14 @@ esp_err_t PwmHal::configureChannel(const ChannelConfig& config) {
     // 設定を保存
     channel_configs_[config.channel] = config;
     
+    ChannelState& state = channel_state_[config.channel];
+    state.speed_mode = static_cast<ledc_mode_t>(config.speed_mode);
+    state.timer_sel = config.timer_sel;
+    state.duty = config.duty;
+    state.staged_duty = config.duty;
+    state.configured = true;
+    updateDutyScale(config.channel);
+    
     logInfo("PWMチャンネル設定完了 チャンネル:%d GPIO:%d タイマー:%d デューティ:%d",
             config.channel, config.gpio_num, config.timer_sel, config.duty);
     
@@ -189,6 +210,9 @@ esp_err_t PwmHal::setDuty(ledc_channel_t channel, SpeedMode speed_mode, uint32_t
     if (it != channel_configs_.end()) {
         it->second.duty = duty;
     }
+    if (channel < LEDC_CHANNEL_MAX) {
+        channel_state_[channel].duty = duty;
+    }
     
     logDebug("デューティ比設定完了 チャンネル:%d デューティ:%d", channel, duty);
     return ESP_OK;
@@ -239,28 +263,19 @@ esp_err_t PwmHal::getFrequency(ledc_timer_t timer_num, SpeedMode speed_mode, uin
 }
 
 esp_err_t PwmHal::setDutyPercentage(ledc_channel_t channel, SpeedMode speed_mode, float percentage) {
-    // チャンネル設定から分解能を取得
-    auto it = channel_configs_.find(channel);
-    if (it == channel_configs_.end()) {
+    if (channel >= LEDC_CHANNEL_MAX || !channel_state_[channel].configured) {
         logError("未設定のチャンネル: %d", channel);
         return ESP_ERR_INVALID_ARG;
     }
     
-    // タイマー設定から分解能を取得
-    auto timer_it = timer_configs_.find(it->second.timer_sel);
-    if (timer_it == timer_configs_.end()) {
-        logError("未設定のタイマー: %d", it->second.timer_sel);
-        return ESP_ERR_INVALID_ARG;
-    }
-    
     // パーセンテージ範囲確認
     if (percentage < 0.0f || percentage > 100.0f) {
         logError("無効なパーセンテージ: %f", percentage);
         return ESP_ERR_INVALID_ARG;
     }
     
-    // デューティ値に変換
-    uint32_t duty = percentageToDuty(percentage, timer_it->second.resolution);
+    // 事前計算した係数でデューティ値に変換（除算なし）
+    uint32_t duty = static_cast<uint32_t>(percentage * channel_state_[channel].percent_to_duty);
     
     return setDuty(channel, speed_mode, duty);
 }
@@ -308,6 +323,11 @@ esp_err_t PwmHal::startFade(ledc_channel_t channel, SpeedMode speed_mode, const
     
     std::lock_guard<std::mutex> lock(mutex_);
     
+    // フェードを使ったチャンネルはLEDCドライバがデューティ更新でセマフォを取るため、予約反映の対象から外す
+    if (channel < LEDC_CHANNEL_MAX) {
+        channel_state_[channel].fade_used = true;
+    }
+    
     // フェード設定
     esp_err_t ret = ledc_set_fade_with_time(static_cast<ledc_mode_t>(speed_mode), 
                                            channel, 
@@ -387,8 +407,86 @@ esp_err_t PwmHal::resumeOutput(ledc_channel_t channel, SpeedMode speed_mode) {
     return ESP_OK;
 }
 
+esp_err_t PwmHal::stageDuty(ledc_channel_t channel, uint32_t duty) {
+    if (channel >= LEDC_CHANNEL_MAX || !channel_state_[channel].configured) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ChannelState& state = channel_state_[channel];
+    if (state.fade_used) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    state.staged_duty = duty > state.max_duty ? state.max_duty : duty;
+    staged_mask_.fetch_or(1U << channel, std::memory_order_release);
+    return ESP_OK;
+}
+
+esp_err_t PwmHal::stageDutyPercentage(ledc_channel_t channel, float percentage) {
+    if (channel >= LEDC_CHANNEL_MAX || !channel_state_[channel].configured) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (percentage < 0.0f) percentage = 0.0f;
+    if (percentage > 100.0f) percentage = 100.0f;
+    
+    ChannelState& state = channel_state_[channel];
+    if (state.fade_used) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    state.staged_duty = static_cast<uint32_t>(percentage * state.percent_to_duty);
+    staged_mask_.fetch_or(1U << channel, std::memory_order_release);
+    return ESP_OK;
+}
+
+esp_err_t PwmHal::commit() {
+    if (!isRunning()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 予約マスクを取り出して空にする（以後の予約は次回のcommit()で反映）
+    const uint32_t mask = staged_mask_.exchange(0, std::memory_order_acquire);
+    if (mask == 0) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = ESP_OK;
+    
+    // ledc_set_duty()・ledc_update_duty()はセマフォ待ち・ログ出力があるためクリティカルセクションに入れない。
+    // デューティ書き込みを先に全て済ませ、更新要求を連続で発行する
+    for (uint32_t ch = 0; ch < LEDC_CHANNEL_MAX; ch++) {
+        if (mask & (1U << ch)) {
+            ChannelState& state = channel_state_[ch];
+            if (ledc_set_duty(state.speed_mode, static_cast<ledc_channel_t>(ch), state.staged_duty) != ESP_OK) {
+                ret = ESP_FAIL;
+            }
+        }
+    }
+    for (uint32_t ch = 0; ch < LEDC_CHANNEL_MAX; ch++) {
+        if (mask & (1U << ch)) {
+            ledc_update_duty(channel_state_[ch].speed_mode, static_cast<ledc_channel_t>(ch));
+            channel_state_[ch].duty = channel_state_[ch].staged_duty;
+        }
+    }
+    
+    return ret;
+}
+
+void PwmHal::updateDutyScale(ledc_channel_t channel) {
+    ChannelState& state = channel_state_[channel];
+    auto timer_it = timer_configs_.find(state.timer_sel);
+    if (timer_it == timer_configs_.end()) {
+        state.max_duty = 0;
+        state.percent_to_duty = 0.0f;
+        return;
+    }
+    
+    state.max_duty = getMaxDuty(timer_it->second.resolution);
+    state.percent_to_duty = static_cast<float>(state.max_duty) / 100.0f;
+}
+
 uint32_t PwmHal::getMaxDuty(Resolution resolution) {
-    return (1U << (static_cast<int>(resolution) + 1)) - 1;
+    // Resolutionの値はビット数そのもの（LEDC_TIMER_n_BIT = n）
+    return (1U << static_cast<int>(resolution)) - 1;
 }
 
 uint32_t PwmHal::percentageToDuty(float percentage, Resolution resolution) {
@@ -0,0 +1,301 @@
+/*
+ * Rate Scheduler Implementation
+ * 
+ * 制御ループ用のレートグループスケジューラ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "rate_scheduler.hpp"
+#include "esp_timer.h"
+#include <numeric>
+
+namespace hal {
+
+RateScheduler::RateScheduler()
+    : HalBase("RATE_SCHEDULER")
+    , timer_(TimerHal::TimerType::HIGH_RESOLUTION)
+    , group_count_(0)
+    , reset_requested_(false) {
+    
+    config_.tick_rate_hz = DEFAULT_TICK_RATE_HZ;
+    
+    for (auto& group : groups_) {
+        group.task = nullptr;
+        group.divider = 1;
+        group.phase = 0;
+        group.countdown = 0;
+        clearStats(group);
+    }
+    
+    logDebug("Rate Schedulerクラス作成");
+}
+
+RateScheduler::~RateScheduler() {
+    timer_.stop();
+    logDebug("Rate Schedulerクラス破棄");
+}
+
+esp_err_t RateScheduler::initialize() {
+    setState(State::INITIALIZING);
+    
+    if (config_.tick_rate_hz == 0 || 1000000 % config_.tick_rate_hz != 0) {
+        logError("基本ティック周波数が不正です: %luHz", static_cast<unsigned long>(config_.tick_rate_hz));
+        setState(State::ERROR);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    esp_err_t ret = timer_.initialize();
+    if (ret == ESP_OK) {
+        ret = timer_.start();
+    }
+    if (ret == ESP_OK) {
+        TimerHal::HighResConfig timer_config = {};
+        timer_config.period_us = 1000000 / config_.tick_rate_hz;
+        timer_config.auto_reload = true;
+        timer_config.name = "rate_sched";
+        ret = timer_.configureHighResolutionIsr(timer_config, tickCallback, this);
+    }
+    if (ret != ESP_OK) {
+        logError("基本ティックタイマー作成失敗: %s", esp_err_to_name(ret));
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    setState(State::INITIALIZED);
+    logInfo("Rate Scheduler初期化完了 基本ティック:%luHz", static_cast<unsigned long>(config_.tick_rate_hz));
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::configure() {
+    if (!isInitialized()) {
+        logError("Rate Schedulerが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    logInfo("Rate Scheduler設定完了 グループ数:%u", static_cast<unsigned>(group_count_));
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::start() {
+    if (!isInitialized()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (isRunning()) {
+        return ESP_OK;
+    }
+    
+    // 位相をカウントダウンの初期値とし、最初のティックから位相どおりに通知する
+    for (size_t i = 0; i < group_count_; i++) {
+        groups_[i].countdown = groups_[i].phase;
+        groups_[i].last_notify_us = 0;
+    }
+    
+    esp_err_t ret = timer_.startHighResolution();
+    if (ret != ESP_OK) {
+        logError("基本ティック開始失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    setState(State::RUNNING);
+    logInfo("Rate Scheduler開始");
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::stop() {
+    esp_err_t ret = timer_.stop();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // TimerHalは停止でSUSPENDEDになるため再開できる状態へ戻す
+    timer_.start();
+    setState(State::INITIALIZED);
+    logInfo("Rate Scheduler停止");
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::reset() {
+    if (isRunning()) {
+        stop();
+    }
+    
+    for (auto& group : groups_) {
+        group.task = nullptr;
+        clearStats(group);
+    }
+    group_count_ = 0;
+    logInfo("Rate Schedulerリセット完了");
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::addGroup(uint32_t rate_hz, TaskHandle_t task, size_t* group_index) {
+    if (rate_hz == 0 || config_.tick_rate_hz % rate_hz != 0) {
+        logError("レートが基本ティックを割り切れません: %luHz", static_cast<unsigned long>(rate_hz));
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    uint32_t phase = 0;
+    if (!findPhase(config_.tick_rate_hz / rate_hz, phase)) {
+        logError("重ならない位相がありません: %luHz（基本ティックを上げてください）", 
+                 static_cast<unsigned long>(rate_hz));
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    return addGroup(rate_hz, task, phase, group_index);
+}
+
+esp_err_t RateScheduler::addGroup(uint32_t rate_hz, TaskHandle_t task, uint32_t phase_ticks, size_t* group_index) {
+    if (isRunning()) {
+        logError("動作中はグループを追加できません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (task == nullptr || rate_hz == 0 || config_.tick_rate_hz % rate_hz != 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (group_count_ >= MAX_GROUPS) {
+        logError("レートグループ数が上限です");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    uint32_t divider = config_.tick_rate_hz / rate_hz;
+    if (phase_ticks >= divider) {
+        logError("位相が分周比以上です: %lu >= %lu", 
+                 static_cast<unsigned long>(phase_ticks), static_cast<unsigned long>(divider));
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (collides(divider, phase_ticks)) {
+        logWarning("位相が既存グループと重なります: %luHz 位相:%lu", 
+                   static_cast<unsigned long>(rate_hz), static_cast<unsigned long>(phase_ticks));
+    }
+    
+    Group& group = groups_[group_count_];
+    group.task = task;
+    group.divider = divider;
+    group.phase = phase_ticks;
+    group.countdown = phase_ticks;
+    clearStats(group);
+    
+    if (group_index != nullptr) {
+        *group_index = group_count_;
+    }
+    group_count_++;
+    
+    logInfo("レートグループ登録 %luHz 分周比:%lu 位相:%lu（%luus）", 
+            static_cast<unsigned long>(rate_hz), static_cast<unsigned long>(divider), 
+            static_cast<unsigned long>(phase_ticks), 
+            static_cast<unsigned long>(phase_ticks * (1000000 / config_.tick_rate_hz)));
+    return ESP_OK;
+}
+
+esp_err_t RateScheduler::getGroupStats(size_t index, GroupStats& stats) const {
+    if (index >= group_count_) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    const Group& group = groups_[index];
+    stats.rate_hz = config_.tick_rate_hz / group.divider;
+    stats.divider = group.divider;
+    stats.phase_ticks = group.phase;
+    stats.notify_count = group.notify_count.load(std::memory_order_relaxed);
+    stats.overrun_count = group.overrun_count.load(std::memory_order_relaxed);
+    stats.min_interval_us = group.min_interval_us.load(std::memory_order_relaxed);
+    stats.max_interval_us = group.max_interval_us.load(std::memory_order_relaxed);
+    if (stats.min_interval_us == UINT32_MAX) {
+        stats.min_interval_us = 0;
+    }
+    return ESP_OK;
+}
+
+void RateScheduler::resetStats() {
+    reset_requested_.store(true, std::memory_order_release);
+}
+
+void RateScheduler::dumpStats() const {
+    for (size_t i = 0; i < group_count_; i++) {
+        GroupStats stats;
+        getGroupStats(i, stats);
+        logInfo("グループ%u %luHz 位相:%lu 通知:%lu 周期落ち:%lu 間隔(最小/最大):%lu/%luus", 
+                static_cast<unsigned>(i), 
+                static_cast<unsigned long>(stats.rate_hz), 
+                static_cast<unsigned long>(stats.phase_ticks), 
+                static_cast<unsigned long>(stats.notify_count), 
+                static_cast<unsigned long>(stats.overrun_count), 
+                static_cast<unsigned long>(stats.min_interval_us), 
+                static_cast<unsigned long>(stats.max_interval_us));
+    }
+}
+
+bool RateScheduler::findPhase(uint32_t divider, uint32_t& phase) const {
+    for (uint32_t candidate = 0; candidate < divider; candidate++) {
+        if (!collides(divider, candidate)) {
+            phase = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool RateScheduler::collides(uint32_t divider, uint32_t phase) const {
+    // 2つの等差数列 phase + k*divider が共通項を持つのは位相差がgcdで割り切れる場合
+    for (size_t i = 0; i < group_count_; i++) {
+        uint32_t g = std::gcd(divider, groups_[i].divider);
+        uint32_t diff = phase > groups_[i].phase ? phase - groups_[i].phase : groups_[i].phase - phase;
+        if (diff % g == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void IRAM_ATTR RateScheduler::clearStats(Group& group) {
+    group.last_notify_us = 0;
+    group.notify_count.store(0, std::memory_order_relaxed);
+    group.overrun_count.store(0, std::memory_order_relaxed);
+    group.min_interval_us.store(UINT32_MAX, std::memory_order_relaxed);
+    group.max_interval_us.store(0, std::memory_order_relaxed);
+}
+
+bool IRAM_ATTR RateScheduler::tickCallback(void* context) {
+    RateScheduler* self = static_cast<RateScheduler*>(context);
+    int64_t now_us = esp_timer_get_time();
+    bool reset_stats = self->reset_requested_.exchange(false, std::memory_order_acq_rel);
+    BaseType_t woken = pdFALSE;
+    
+    for (size_t i = 0; i < self->group_count_; i++) {
+        Group& group = self->groups_[i];
+        if (reset_stats) {
+            clearStats(group);
+        }
+        if (group.countdown != 0) {
+            group.countdown--;
+            continue;
+        }
+        group.countdown = group.divider - 1;
+        
+        uint32_t previous = 0;
+        xTaskNotifyAndQueryFromISR(group.task, 0, eIncrement, &previous, &woken);
+        group.notify_count.fetch_add(1, std::memory_order_relaxed);
+        if (previous != 0) {
+            group.overrun_count.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        if (group.last_notify_us != 0) {
+            uint32_t interval = static_cast<uint32_t>(now_us - group.last_notify_us);
+            if (interval < group.min_interval_us.load(std::memory_order_relaxed)) {
+                group.min_interval_us.store(interval, std::memory_order_relaxed);
+            }
+            if (interval > group.max_interval_us.load(std::memory_order_relaxed)) {
+                group.max_interval_us.store(interval, std::memory_order_relaxed);
+            }
+        }
+        group.last_notify_us = now_us;
+    }
+    
+    return woken == pdTRUE;
+}
+
+} // namespace hal
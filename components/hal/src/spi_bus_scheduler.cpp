@@ -0,0 +1,262 @@
+/*
+ * SPI Bus Scheduler Implementation
+ * 
+ * 共有SPIバスの優先度付き調停の実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "spi_bus_scheduler.hpp"
+#include "timebase.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+namespace hal {
+
+static const char* TAG = "hal::SpiBusScheduler";
+
+SpiBusScheduler::SpiBusScheduler(std::shared_ptr<SpiHal> spi)
+    : spi_(std::move(spi))
+    , config_()
+    , clients_{}
+    , client_count_(0)
+    , critical_waiting_(0)
+    , stats_start_us_(0)
+    , spinlock_(portMUX_INITIALIZER_UNLOCKED) {
+}
+
+esp_err_t SpiBusScheduler::start(const Config& config) {
+    if (config.max_defer_us == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config_ = config;
+    resetStats();
+    ESP_LOGI(TAG, "開始 ガード:%luμs 待ち上限:%luμs デバイス:%u", 
+             static_cast<unsigned long>(config_.guard_us), static_cast<unsigned long>(config_.max_defer_us), 
+             static_cast<unsigned>(client_count_));
+    return ESP_OK;
+}
+
+esp_err_t SpiBusScheduler::addClient(spi_device_handle_t device, const ClientConfig& config, size_t& client) {
+    if (device == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config.priority == Priority::NORMAL && (config.budget_us == 0 || config.max_chunk_bytes == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (client_count_ >= MAX_CLIENTS) {
+        ESP_LOGE(TAG, "登録数の上限 %u", static_cast<unsigned>(MAX_CLIENTS));
+        return ESP_ERR_NO_MEM;
+    }
+    
+    Client& c = clients_[client_count_];
+    c = Client{};
+    c.device = device;
+    c.config = config;
+    if (c.config.priority == Priority::CRITICAL && c.config.deadline_us == 0) {
+        c.config.deadline_us = c.config.period_us;
+    }
+    client = client_count_++;
+    ESP_LOGI(TAG, "登録 %s %s 周期:%luμs 期限:%luμs 見積もり:%luμs", 
+             c.config.name, priorityName(c.config.priority), static_cast<unsigned long>(c.config.period_us), 
+             static_cast<unsigned long>(c.config.deadline_us), static_cast<unsigned long>(c.config.budget_us));
+    return ESP_OK;
+}
+
+int64_t IRAM_ATTR SpiBusScheduler::admission(int64_t now_us, uint32_t budget_us) const {
+    int64_t retry_us = 0;
+    const bool waiting = critical_waiting_.load(std::memory_order_acquire) > 0;
+    
+    portENTER_CRITICAL_SAFE(&spinlock_);
+    for (size_t i = 0; i < client_count_; i++) {
+        const Client& c = clients_[i];
+        if (c.config.priority != Priority::CRITICAL) {
+            continue;
+        }
+        if (waiting) {
+            // 待っているCRITICALが占有して解放するまで（前回の占有時間を目安に再判定）
+            retry_us = std::max(retry_us, now_us + std::max<int64_t>(c.last_hold_us, config_.guard_us));
+            continue;
+        }
+        if (c.config.period_us == 0 || c.next_request_us == 0) {
+            continue;
+        }
+        const int64_t window_start = c.next_request_us - config_.guard_us;
+        if (now_us + budget_us <= window_start) {
+            continue;
+        }
+        if (now_us > c.next_request_us + c.config.period_us) {
+            // 1周期以上要求がない（停止中）、次の要求で予測し直す
+            continue;
+        }
+        // 窓（予測要求時刻から前回の占有時間まで）の後に再判定、要求が遅れている場合はガード分ずつ
+        const int64_t window_end = c.next_request_us + c.last_hold_us;
+        retry_us = std::max(retry_us, std::max<int64_t>(window_end, now_us + config_.guard_us));
+    }
+    portEXIT_CRITICAL_SAFE(&spinlock_);
+    return retry_us;
+}
+
+esp_err_t IRAM_ATTR SpiBusScheduler::acquire(size_t client, uint32_t budget_us) {
+    if (client >= client_count_) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    Client& c = clients_[client];
+    int64_t now = esp_timer_get_time();
+    c.request_us = now;
+    esp_err_t ret;
+    
+    if (c.config.priority == Priority::CRITICAL) {
+        critical_waiting_.fetch_add(1, std::memory_order_acq_rel);
+        ret = spi_->acquireBus(c.device);
+        critical_waiting_.fetch_sub(1, std::memory_order_acq_rel);
+        c.budget_us = 0;
+    } else {
+        c.budget_us = budget_us != 0 ? budget_us : c.config.budget_us;
+        const int64_t give_up = now + config_.max_defer_us;
+        bool deferred = false;
+        for (;;) {
+            const int64_t retry = admission(now, c.budget_us);
+            if (retry == 0) {
+                break;
+            }
+            if (now >= give_up) {
+                c.stats.forced++;
+                break;
+            }
+            deferred = true;
+            common::Deadline::at(std::min(retry, give_up)).sleep();
+            now = esp_timer_get_time();
+        }
+        if (deferred) {
+            c.stats.deferrals++;
+        }
+        ret = spi_->acquireBus(c.device);
+    }
+    
+    if (ret != ESP_OK) {
+        c.stats.errors++;
+        return ret;
+    }
+    c.grant_us = esp_timer_get_time();
+    const uint32_t wait_us = static_cast<uint32_t>(c.grant_us - c.request_us);
+    if (wait_us > c.stats.max_wait_us) {
+        c.stats.max_wait_us = wait_us;
+    }
+    return ESP_OK;
+}
+
+void IRAM_ATTR SpiBusScheduler::release(size_t client, size_t bytes) {
+    if (client >= client_count_) {
+        return;
+    }
+    Client& c = clients_[client];
+    const int64_t end = esp_timer_get_time();
+    spi_->releaseBus(c.device);
+    
+    const uint32_t hold_us = static_cast<uint32_t>(end - c.grant_us);
+    c.stats.transfers++;
+    c.stats.bytes += bytes;
+    c.stats.busy_us += hold_us;
+    if (hold_us > c.stats.max_hold_us) {
+        c.stats.max_hold_us = hold_us;
+    }
+    
+    if (c.config.priority == Priority::CRITICAL) {
+        if (c.config.deadline_us != 0 && end - c.request_us > c.config.deadline_us) {
+            c.stats.deadline_misses++;
+        }
+        if (c.config.period_us != 0) {
+            portENTER_CRITICAL_SAFE(&spinlock_);
+            c.next_request_us = c.request_us + c.config.period_us;
+            c.last_hold_us = hold_us;
+            portEXIT_CRITICAL_SAFE(&spinlock_);
+        }
+    } else if (hold_us > c.budget_us) {
+        c.stats.overruns++;
+    }
+}
+
+esp_err_t SpiBusScheduler::transferChunked(size_t client, const uint8_t* tx_data, uint8_t* rx_data, size_t length) {
+    if (client >= client_count_ || length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    Client& c = clients_[client];
+    const size_t chunk_bytes = c.config.priority == Priority::CRITICAL ? length : c.config.max_chunk_bytes;
+    
+    for (size_t offset = 0; offset < length; offset += chunk_bytes) {
+        const size_t n = std::min(chunk_bytes, length - offset);
+        esp_err_t ret = acquire(client);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ret = spi_->transmitPolling(c.device, tx_data != nullptr ? tx_data + offset : nullptr, 
+                                    rx_data != nullptr ? rx_data + offset : nullptr, n);
+        release(client, n);
+        if (ret != ESP_OK) {
+            c.stats.errors++;
+            return ret;
+        }
+        c.stats.chunks++;
+    }
+    return ESP_OK;
+}
+
+float SpiBusScheduler::utilization(size_t client) const {
+    if (client >= client_count_) {
+        return 0.0f;
+    }
+    const int64_t elapsed_us = esp_timer_get_time() - stats_start_us_;
+    if (elapsed_us <= 0) {
+        return 0.0f;
+    }
+    return static_cast<float>(static_cast<double>(clients_[client].stats.busy_us) / static_cast<double>(elapsed_us));
+}
+
+void SpiBusScheduler::resetStats() {
+    for (size_t i = 0; i < client_count_; i++) {
+        clients_[i].stats = ClientStats{};
+    }
+    stats_start_us_ = esp_timer_get_time();
+}
+
+const char* SpiBusScheduler::priorityName(Priority priority) {
+    switch (priority) {
+        case Priority::CRITICAL: return "最優先";
+        case Priority::NORMAL: return "通常";
+        default: return "不明";
+    }
+}
+
+void SpiBusScheduler::dump() const {
+    const int64_t elapsed_us = esp_timer_get_time() - stats_start_us_;
+    float total = 0.0f;
+    ESP_LOGI(TAG, "集計 %.2fs ガード %luμs 待ち上限 %luμs", static_cast<double>(elapsed_us) * 1e-6, 
+             static_cast<unsigned long>(config_.guard_us), static_cast<unsigned long>(config_.max_defer_us));
+    for (size_t i = 0; i < client_count_; i++) {
+        const Client& c = clients_[i];
+        const ClientStats& s = c.stats;
+        const float usage = utilization(i);
+        total += usage;
+        ESP_LOGI(TAG, "%s（%s）使用率 %.1f%% 占有 %lu チャンク %lu %lluバイト 最大占有 %luμs 最大待ち %luμs", 
+                 c.config.name, priorityName(c.config.priority), static_cast<double>(usage * 100.0f), 
+                 static_cast<unsigned long>(s.transfers), static_cast<unsigned long>(s.chunks), 
+                 static_cast<unsigned long long>(s.bytes), static_cast<unsigned long>(s.max_hold_us), 
+                 static_cast<unsigned long>(s.max_wait_us));
+        if (c.config.priority == Priority::CRITICAL) {
+            ESP_LOGI(TAG, "  期限超過 %lu 失敗 %lu", 
+                     static_cast<unsigned long>(s.deadline_misses), static_cast<unsigned long>(s.errors));
+        } else {
+            ESP_LOGI(TAG, "  退避 %lu 強制 %lu 見積もり超過 %lu 失敗 %lu", 
+                     static_cast<unsigned long>(s.deferrals), static_cast<unsigned long>(s.forced), 
+                     static_cast<unsigned long>(s.overruns), static_cast<unsigned long>(s.errors));
+        }
+    }
+    ESP_LOGI(TAG, "バス使用率 合計 %.1f%%", static_cast<double>(total * 100.0f));
+}
+
+} // namespace hal
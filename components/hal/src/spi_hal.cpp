@@ -11,12 +11,23 @@
  */
 
 #include "spi_hal.hpp"
+#include "interrupt_plan.hpp"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
 #include <cstring>
 #include <algorithm>
 
 namespace hal {
 
+/**
+ * @brief ドライバがそのままDMAに渡せるバッファか（内部RAM・4バイト境界）
+ */
+static inline bool IRAM_ATTR isDmaBuffer(const void* buffer) {
+    return esp_ptr_dma_capable(buffer) && (reinterpret_cast<uintptr_t>(buffer) & 3) == 0;
+}
+
 SpiHal::SpiHal(spi_host_device_t host) 
     : HalBase("SPI_HAL")
     , bus_initialized_(false) {
@@ -28,6 +39,11 @@ SpiHal::SpiHal(spi_host_device_t host)
     config_.max_transfer_size = 4096;  // デフォルト4KB
     config_.dma_channel = SPI_DMA_CH_AUTO;
     config_.queue_size = 7;
+    config_.dma_pool_size = 4;
+    config_.dma_buffer_size = 64;
+    
+    registerTracePoint(TRACE_TRANSFER, "transfer");
+    registerTracePoint(TRACE_REGISTER, "register");
     
     logDebug("SPI HALクラス作成 ホスト:%d", static_cast<int>(host));
 }
@@ -39,6 +55,10 @@ SpiHal::~SpiHal() {
         logDebug("SPIデバイス削除 ハンドル:%p", device);
     }
     devices_.clear();
+    polling_devices_.clear();
+    freeScratch();
+    
+    freeDmaPool();
     
     // SPIバスを解放
     if (bus_initialized_) {
@@ -82,6 +102,9 @@ esp_err_t SpiHal::configure() {
             spi_bus_remove_device(device);
         }
         devices_.clear();
+        polling_devices_.clear();
+        freeScratch();
+        freeDmaPool();
         
         esp_err_t ret = spi_bus_free(config_.host);
         if (ret != ESP_OK) {
@@ -98,9 +121,13 @@ esp_err_t SpiHal::configure() {
     bus_cfg.quadwp_io_num = -1;  // 使用しない
     bus_cfg.quadhd_io_num = -1;  // 使用しない
     bus_cfg.max_transfer_sz = config_.max_transfer_size;
+    bus_cfg.intr_flags = InterruptPlan::flags(InterruptPlan::Source::SPI_BUS);
     
-    // SPIバスを初期化
-    esp_err_t ret = spi_bus_initialize(config_.host, &bus_cfg, config_.dma_channel);
+    // SPIバスを初期化（割り込みは配置表のコアに確保される）
+    const spi_bus_config_t* cfg = &bus_cfg;
+    esp_err_t ret = InterruptPlan::install(InterruptPlan::Source::SPI_BUS, [this, cfg]() {
+        return spi_bus_initialize(config_.host, cfg, config_.dma_channel);
+    });
     if (ret != ESP_OK) {
         logError("SPIバス初期化失敗: %s", esp_err_to_name(ret));
         setState(State::ERROR);
@@ -109,6 +136,14 @@ esp_err_t SpiHal::configure() {
     
     bus_initialized_ = true;
     
+    // DMA転送ディスクリプタプールを確保
+    ret = allocateDmaPool();
+    if (ret != ESP_OK) {
+        logError("DMAディスクリプタプール確保失敗: %s", esp_err_to_name(ret));
+        setState(State::ERROR);
+        return ret;
+    }
+    
     logInfo("SPI設定完了 ホスト:%d MOSI:%d MISO:%d SCLK:%d", 
             static_cast<int>(config_.host), config_.mosi_pin, config_.miso_pin, config_.sclk_pin);
     
@@ -144,6 +179,9 @@ esp_err_t SpiHal::reset() {
         spi_bus_remove_device(device);
     }
     devices_.clear();
+    polling_devices_.clear();
+    freeScratch();
+    freeDmaPool();
     
     // バスを解放
     if (bus_initialized_) {
@@ -196,10 +234,29 @@ esp_err_t SpiHal::addDevice(const DeviceConfig& device_config, spi_device_handle
         return ret;
     }
     
+    // ポーリング転送用のDMAバッファ（読み取りレジスタ・呼び出し側バッファの中継）
+    PollingScratch scratch = {};
+    scratch.device = device_handle;
+    scratch.tx_buffer = static_cast<uint8_t*>(heap_caps_calloc(1, POLLING_SCRATCH_SIZE, MALLOC_CAP_DMA));
+    scratch.rx_buffer = static_cast<uint8_t*>(heap_caps_calloc(1, POLLING_SCRATCH_SIZE, MALLOC_CAP_DMA));
+    if (scratch.tx_buffer == nullptr || scratch.rx_buffer == nullptr) {
+        heap_caps_free(scratch.tx_buffer);
+        heap_caps_free(scratch.rx_buffer);
+        spi_bus_remove_device(device_handle);
+        device_handle = nullptr;
+        logError("SPIデバイスのDMAバッファ確保失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    scratch_.push_back(scratch);
+    
     devices_.push_back(device_handle);
+    if (device_config.use_polling) {
+        polling_devices_.push_back(device_handle);
+    }
     
-    logInfo("SPIデバイス追加成功 周波数:%dHz モード:%d", 
-            device_config.frequency, static_cast<int>(device_config.mode));
+    logInfo("SPIデバイス追加成功 周波数:%dHz モード:%d 転送:%s", 
+            device_config.frequency, static_cast<int>(device_config.mode), 
+            device_config.use_polling ? "ポーリング" : "割り込み");
     
     return ESP_OK;
 }
@@ -212,6 +269,17 @@ esp_err_t SpiHal::removeDevice(spi_device_handle_t device_handle) {
     if (it != devices_.end()) {
         devices_.erase(it);
     }
+    auto pit = std::find(polling_devices_.begin(), polling_devices_.end(), device_handle);
+    if (pit != polling_devices_.end()) {
+        polling_devices_.erase(pit);
+    }
+    auto sit = std::find_if(scratch_.begin(), scratch_.end(), 
+                            [device_handle](const PollingScratch& s) { return s.device == device_handle; });
+    if (sit != scratch_.end()) {
+        heap_caps_free(sit->tx_buffer);
+        heap_caps_free(sit->rx_buffer);
+        scratch_.erase(sit);
+    }
     
     // SPIバスからデバイスを削除
     esp_err_t ret = spi_bus_remove_device(device_handle);
@@ -261,8 +329,12 @@ esp_err_t SpiHal::transmit(spi_device_handle_t device_handle, Transaction& trans
         }
     }
     
-    // トランザクション実行
-    esp_err_t ret = spi_device_polling_transmit(device_handle, &spi_trans);
+    // トランザクション実行（デバイス毎にポーリング/割り込み転送を選択）
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = isPollingDevice(device_handle) 
+                        ? spi_device_polling_transmit(device_handle, &spi_trans) 
+                        : spi_device_transmit(device_handle, &spi_trans);
+    traceEnd(TRACE_TRANSFER, trace_start, ret);
     if (ret != ESP_OK) {
         logError("SPIトランザクション失敗: %s", esp_err_to_name(ret));
         return ret;
@@ -292,7 +364,6 @@ esp_err_t SpiHal::read(spi_device_handle_t device_handle, std::vector<uint8_t>&
     Transaction trans;
     trans.rx_data.resize(length);
     trans.length = length * 8;
-    trans.rxlength = length * 8;
     
     esp_err_t ret = transmit(device_handle, trans);
     if (ret == ESP_OK) {
@@ -321,7 +392,6 @@ esp_err_t SpiHal::readRegister(spi_device_handle_t device_handle, uint8_t addres
     trans.tx_data.resize(length + 1, 0);
     trans.rx_data.resize(length + 1);
     trans.length = trans.tx_data.size() * 8;
-    trans.rxlength = trans.rx_data.size() * 8;
     
     esp_err_t ret = transmit(device_handle, trans);
     if (ret == ESP_OK) {
@@ -338,14 +408,330 @@ esp_err_t SpiHal::writeRegister8(spi_device_handle_t device_handle, uint8_t addr
 }
 
 esp_err_t SpiHal::readRegister8(spi_device_handle_t device_handle, uint8_t address, uint8_t& value) {
-    std::vector<uint8_t> data;
-    esp_err_t ret = readRegister(device_handle, address, data, 1);
-    if (ret == ESP_OK && !data.empty()) {
-        value = data[0];
+    return readRegister(device_handle, address, &value, 1);
+}
+
+esp_err_t SpiHal::readRegister(spi_device_handle_t device_handle, uint8_t address, 
+                              uint8_t* data, size_t length) {
+    if (!isRunning()) {
+        logError("SPI HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (data == nullptr || length == 0) {
+        logError("読み取りサイズが0です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    DmaTransaction* t = acquireTransaction();
+    if (t == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    if (length + 1 > t->buffer_size) {
+        releaseTransaction(t);
+        logError("読み取りサイズがDMAバッファを超えています サイズ:%zu", length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // 読み取りビット（MSB=1）+ ダミーバイト
+    t->tx_buffer[0] = address | 0x80;
+    memset(&t->tx_buffer[1], 0, length);
+    
+    t->trans.flags = 0;
+    t->trans.length = (length + 1) * 8;
+    t->trans.rxlength = 0;
+    t->trans.tx_buffer = t->tx_buffer;
+    t->trans.rx_buffer = t->rx_buffer;
+    
+    esp_err_t ret;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t trace_start = traceBegin();
+        ret = spi_device_polling_transmit(device_handle, &t->trans);
+        traceEnd(TRACE_TRANSFER, trace_start, ret);
+    }
+    
+    if (ret == ESP_OK) {
+        // 最初のバイト（アドレスエコー）をスキップ
+        memcpy(data, &t->rx_buffer[1], length);
+    } else {
+        logError("SPIレジスタ読み取り失敗 アドレス:0x%02X エラー:%s", address, esp_err_to_name(ret));
+    }
+    
+    releaseTransaction(t);
+    return ret;
+}
+
+SpiHal::DmaTransaction* SpiHal::acquireTransaction() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    for (auto& t : dma_pool_) {
+        if (!t.in_use) {
+            t.in_use = true;
+            t.device = nullptr;
+            return &t;
+        }
+    }
+    
+    logWarning("DMAディスクリプタプールに空きがありません");
+    return nullptr;
+}
+
+void SpiHal::releaseTransaction(DmaTransaction* transaction) {
+    if (transaction == nullptr) {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (transaction->in_flight) {
+        logError("転送中のDMAディスクリプタは返却できません");
+        return;
+    }
+    transaction->in_use = false;
+}
+
+esp_err_t SpiHal::queueTransaction(spi_device_handle_t device_handle, DmaTransaction* transaction, 
+                                  size_t tx_length, size_t rx_length, TickType_t timeout, uint32_t flags) {
+    if (!isRunning()) {
+        logError("SPI HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (transaction == nullptr || !transaction->in_use || transaction->in_flight) {
+        logError("DMAディスクリプタが無効です");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (tx_length > transaction->buffer_size || rx_length > transaction->buffer_size) {
+        logError("転送サイズがDMAバッファを超えています 送信:%zu 受信:%zu", tx_length, rx_length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    spi_transaction_t& trans = transaction->trans;
+    trans.flags = flags;
+    trans.length = std::max(tx_length, rx_length) * 8;
+    trans.rxlength = rx_length * 8;
+    trans.tx_buffer = (tx_length > 0) ? transaction->tx_buffer : nullptr;
+    trans.rx_buffer = (rx_length > 0) ? transaction->rx_buffer : nullptr;
+    trans.user = transaction;
+    
+    transaction->device = device_handle;
+    transaction->in_flight = true;
+    
+    esp_err_t ret = spi_device_queue_trans(device_handle, &trans, timeout);
+    if (ret != ESP_OK) {
+        transaction->in_flight = false;
+        logError("SPIキュー投入失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t SpiHal::queueReadRegister(spi_device_handle_t device_handle, uint8_t address, size_t length, 
+                                   DmaTransaction*& transaction, TickType_t timeout) {
+    transaction = acquireTransaction();
+    if (transaction == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    if (length == 0 || length + 1 > transaction->buffer_size) {
+        releaseTransaction(transaction);
+        transaction = nullptr;
+        logError("読み取りサイズが無効です サイズ:%zu", length);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    
+    // 読み取りビット（MSB=1）+ ダミーバイト
+    transaction->tx_buffer[0] = address | 0x80;
+    memset(&transaction->tx_buffer[1], 0, length);
+    
+    esp_err_t ret = queueTransaction(device_handle, transaction, length + 1, length + 1, timeout);
+    if (ret != ESP_OK) {
+        releaseTransaction(transaction);
+        transaction = nullptr;
     }
     return ret;
 }
 
+esp_err_t SpiHal::getTransactionResult(spi_device_handle_t device_handle, DmaTransaction*& transaction, 
+                                      TickType_t timeout) {
+    spi_transaction_t* trans = nullptr;
+    esp_err_t ret = spi_device_get_trans_result(device_handle, &trans, timeout);
+    if (ret != ESP_OK) {
+        transaction = nullptr;
+        return ret;
+    }
+    
+    transaction = static_cast<DmaTransaction*>(trans->user);
+    transaction->in_flight = false;
+    return ESP_OK;
+}
+
+esp_err_t SpiHal::acquireBus(spi_device_handle_t device_handle, TickType_t timeout) {
+    if (!isRunning()) {
+        logError("SPI HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_err_t ret = spi_device_acquire_bus(device_handle, timeout);
+    if (ret != ESP_OK) {
+        logError("SPIバス占有失敗: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void SpiHal::releaseBus(spi_device_handle_t device_handle) {
+    spi_device_release_bus(device_handle);
+}
+
+esp_err_t IRAM_ATTR SpiHal::transmitPolling(spi_device_handle_t device_handle, const uint8_t* tx_data, 
+                                          uint8_t* rx_data, size_t length, uint32_t flags) {
+    if (length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    spi_transaction_t spi_trans = {};
+    spi_trans.length = length * 8;
+    
+    if (length <= 4) {
+        // 4バイト以下はトランザクション内部バッファを使用（DMA設定を省略）
+        if (tx_data != nullptr) {
+            memcpy(spi_trans.tx_data, tx_data, length);
+        }
+        spi_trans.flags = SPI_TRANS_USE_TXDATA | SPI_TRANS_USE_RXDATA;
+    } else {
+        spi_trans.tx_buffer = tx_data;
+        spi_trans.rx_buffer = rx_data;
+        // DMA非対応（PSRAM・フラッシュ上の定数等）・4バイト境界でないバッファはデバイス毎のDMAバッファを経由する
+        PollingScratch* scratch = length <= POLLING_SCRATCH_SIZE ? findScratch(device_handle) : nullptr;
+        if (scratch != nullptr) {
+            if (tx_data != nullptr && !isDmaBuffer(tx_data)) {
+                memcpy(scratch->tx_buffer, tx_data, length);
+                spi_trans.tx_buffer = scratch->tx_buffer;
+            }
+            if (rx_data != nullptr && !isDmaBuffer(rx_data)) {
+                spi_trans.rx_buffer = scratch->rx_buffer;
+            }
+        }
+    }
+    spi_trans.flags |= flags;
+    
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = spi_device_polling_transmit(device_handle, &spi_trans);
+    traceEnd(TRACE_REGISTER, trace_start, ret);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    if ((spi_trans.flags & SPI_TRANS_USE_RXDATA) && rx_data != nullptr) {
+        memcpy(rx_data, spi_trans.rx_data, length);
+    } else if (rx_data != nullptr && spi_trans.rx_buffer != rx_data) {
+        memcpy(rx_data, spi_trans.rx_buffer, length);
+    }
+    return ESP_OK;
+}
+
+esp_err_t SpiHal::readRegisterPolling(spi_device_handle_t device_handle, uint8_t address, 
+                                     uint8_t* data, size_t length) {
+    if (data == nullptr || length == 0 || length > MAX_POLLING_TRANSFER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    PollingScratch* scratch = findScratch(device_handle);
+    if (scratch == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 読み取りビット（MSB=1）+ ダミーバイト（デバイス毎のDMAバッファへ直接組み立てる）
+    scratch->tx_buffer[0] = address | 0x80;
+    memset(&scratch->tx_buffer[1], 0, length);
+    
+    esp_err_t ret = transmitPolling(device_handle, scratch->tx_buffer, scratch->rx_buffer, length + 1);
+    if (ret == ESP_OK) {
+        // 最初のバイト（アドレスエコー）をスキップ
+        memcpy(data, &scratch->rx_buffer[1], length);
+    }
+    return ret;
+}
+
+esp_err_t SpiHal::writeRegisterPolling(spi_device_handle_t device_handle, uint8_t address, 
+                                      const uint8_t* data, size_t length) {
+    if ((data == nullptr && length > 0) || length > MAX_POLLING_TRANSFER_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    PollingScratch* scratch = findScratch(device_handle);
+    if (scratch == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // 書き込みビット（MSB=0）
+    scratch->tx_buffer[0] = address & 0x7F;
+    if (length > 0) {
+        memcpy(&scratch->tx_buffer[1], data, length);
+    }
+    
+    return transmitPolling(device_handle, scratch->tx_buffer, nullptr, length + 1);
+}
+
+SpiHal::PollingScratch* IRAM_ATTR SpiHal::findScratch(spi_device_handle_t device_handle) {
+    // デバイス数は数個のため線形探索（transmitPolling() からも呼ぶためIRAM配置）
+    PollingScratch* scratch = scratch_.data();
+    for (size_t i = 0; i < scratch_.size(); i++) {
+        if (scratch[i].device == device_handle) {
+            return &scratch[i];
+        }
+    }
+    return nullptr;
+}
+
+void SpiHal::freeScratch() {
+    for (auto& scratch : scratch_) {
+        heap_caps_free(scratch.tx_buffer);
+        heap_caps_free(scratch.rx_buffer);
+    }
+    scratch_.clear();
+}
+
+bool SpiHal::isPollingDevice(spi_device_handle_t device_handle) const {
+    return std::find(polling_devices_.begin(), polling_devices_.end(), device_handle) 
+           != polling_devices_.end();
+}
+
+esp_err_t SpiHal::allocateDmaPool() {
+    freeDmaPool();
+    
+    // DMAは4バイト単位で転送するためバッファサイズを切り上げる
+    const size_t buffer_size = (config_.dma_buffer_size + 3) & ~static_cast<size_t>(3);
+    
+    dma_pool_.resize(config_.dma_pool_size);
+    for (auto& t : dma_pool_) {
+        t = {};
+        t.buffer_size = buffer_size;
+        t.tx_buffer = static_cast<uint8_t*>(heap_caps_malloc(buffer_size, MALLOC_CAP_DMA));
+        t.rx_buffer = static_cast<uint8_t*>(heap_caps_malloc(buffer_size, MALLOC_CAP_DMA));
+        if (t.tx_buffer == nullptr || t.rx_buffer == nullptr) {
+            freeDmaPool();
+            return ESP_ERR_NO_MEM;
+        }
+        t.trans.user = &t;
+    }
+    
+    logDebug("DMAディスクリプタプール確保 数:%zu サイズ:%zuバイト", dma_pool_.size(), buffer_size);
+    return ESP_OK;
+}
+
+void SpiHal::freeDmaPool() {
+    for (auto& t : dma_pool_) {
+        heap_caps_free(t.tx_buffer);
+        heap_caps_free(t.rx_buffer);
+    }
+    dma_pool_.clear();
+}
+
 uint32_t SpiHal::spiModeToFlags(SpiMode mode) {
     switch (mode) {
         case SpiMode::MODE0:  // CPOL=0, CPHA=0
@@ -10,7 +10,9 @@
  */
 
 #include "timer_hal.hpp"
+#include "timebase.hpp"
 #include "esp_log.h"
+#include "sdkconfig.h"
 
 namespace hal {
 
@@ -25,6 +27,7 @@ TimerHal::TimerHal(TimerType type)
     hr_config_.period_us = 1000;
     hr_config_.auto_reload = true;
     hr_config_.name = "hal_timer";
+    hr_config_.dispatch_isr = false;
     
     gp_config_.resolution_hz = 1000000; // 1MHz
     gp_config_.direction = GPTIMER_COUNT_UP;
@@ -122,23 +125,74 @@ esp_err_t TimerHal::configureHighResolution(const HighResConfig& config, TimerCa
         return ESP_ERR_INVALID_STATE;
     }
     
+    // 設定とコールバックを保存
+    HighResConfig task_config = config;
+    task_config.dispatch_isr = false;
+    callback_ = callback;
+    
+    return createEspTimer(task_config);
+}
+
+esp_err_t TimerHal::configureHighResolutionIsr(const HighResConfig& config, IsrCallback callback, void* context) {
+    if (callback == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return configureHighResolutionIsr(config, TimerCallback::fromFunction(callback, context));
+}
+
+esp_err_t TimerHal::configureHighResolutionIsr(const HighResConfig& config, TimerCallback callback) {
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (!isRunning()) {
+        logError("Timer HALが動作していません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (timer_type_ != TimerType::HIGH_RESOLUTION) {
+        logError("高分解能タイマーではありません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!callback) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    HighResConfig isr_config = config;
+    isr_config.dispatch_isr = true;
+    callback_ = callback;
+    
+    return createEspTimer(isr_config);
+#else
+    logError("ESP_TIMER_ISRディスパッチが無効です（CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD）");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t TimerHal::createEspTimer(const HighResConfig& config) {
     // 既存のタイマーを削除
     if (esp_timer_handle_) {
         esp_timer_stop(esp_timer_handle_);
         esp_timer_delete(esp_timer_handle_);
         esp_timer_handle_ = nullptr;
+        active_ = false;
     }
     
-    // 設定とコールバックを保存
     hr_config_ = config;
-    callback_ = callback;
     
     // タイマー設定
     esp_timer_create_args_t timer_args = {};
-    timer_args.callback = espTimerCallback;
     timer_args.arg = this;
     timer_args.name = config.name ? config.name : "hal_timer";
     timer_args.skip_unhandled_events = true;
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    if (config.dispatch_isr) {
+        timer_args.callback = espTimerIsrCallback;
+        timer_args.dispatch_method = ESP_TIMER_ISR;
+    } else
+#endif
+    {
+        timer_args.callback = espTimerCallback;
+        timer_args.dispatch_method = ESP_TIMER_TASK;
+    }
     
     // タイマーを作成
     esp_err_t ret = esp_timer_create(&timer_args, &esp_timer_handle_);
@@ -148,9 +202,35 @@ esp_err_t TimerHal::configureHighResolution(const HighResConfig& config, TimerCa
         return ret;
     }
     
-    logInfo("高分解能タイマー設定完了 周期:%lluus 自動リロード:%s", 
-            config.period_us, config.auto_reload ? "有効" : "無効");
+    logInfo("高分解能タイマー設定完了 周期:%lluus 自動リロード:%s ディスパッチ:%s",  
+            config.period_us, config.auto_reload ? "有効" : "無効",  
+            config.dispatch_isr ? "ISR" : "タスク");
+    
+    return ESP_OK;
+}
+
+esp_err_t TimerHal::startHighResolution() {
+    if (timer_type_ != TimerType::HIGH_RESOLUTION || !esp_timer_handle_) {
+        logError("高分解能タイマーが設定されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    esp_timer_stop(esp_timer_handle_);
+    
+    esp_err_t ret;
+    if (hr_config_.auto_reload) {
+        ret = esp_timer_start_periodic(esp_timer_handle_, hr_config_.period_us);
+    } else {
+        ret = esp_timer_start_once(esp_timer_handle_, hr_config_.period_us);
+    }
+    
+    if (ret != ESP_OK) {
+        logError("高分解能タイマー開始失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
     
+    active_ = true;
+    logInfo("高分解能タイマー開始 周期:%lluus", hr_config_.period_us);
     return ESP_OK;
 }
 
@@ -321,7 +401,7 @@ int64_t TimerHal::getCurrentTime() {
 }
 
 void TimerHal::delay(uint32_t delay_us) {
-    esp_rom_delay_us(delay_us);
+    common::Deadline::after(delay_us).sleep();
 }
 
 esp_err_t TimerHal::startOneShot(uint64_t timeout_us, TimerCallback callback, const char* name) {
@@ -336,6 +416,7 @@ esp_err_t TimerHal::startOneShot(uint64_t timeout_us, TimerCallback callback, co
         temp_config.period_us = timeout_us;
         temp_config.auto_reload = false;
         temp_config.name = name ? name : "oneshot_timer";
+        temp_config.dispatch_isr = false;
         
         esp_err_t ret = configureHighResolution(temp_config, callback);
         if (ret != ESP_OK) {
@@ -343,6 +424,11 @@ esp_err_t TimerHal::startOneShot(uint64_t timeout_us, TimerCallback callback, co
         }
     }
     
+    if (hr_config_.dispatch_isr) {
+        logError("ISRディスパッチのタイマーはワンショットに使用できません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
     callback_ = callback;
     
     esp_err_t ret = esp_timer_start_once(esp_timer_handle_, timeout_us);
@@ -372,6 +458,15 @@ void TimerHal::espTimerCallback(void* arg) {
     }
 }
 
+void IRAM_ATTR TimerHal::espTimerIsrCallback(void* arg) {
+    TimerHal* instance = static_cast<TimerHal*>(arg);
+    if (instance->callback_ && instance->callback_()) {
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        esp_timer_isr_dispatch_need_yield();
+#endif
+    }
+}
+
 bool IRAM_ATTR TimerHal::gpTimerCallback(gptimer_handle_t timer, 
                                         const gptimer_alarm_event_data_t* edata, 
                                         void* user_data) {
@@ -0,0 +1,411 @@
+/*
+ * UART DMA HAL Class Implementation
+ * 
+ * UHCI（GDMA）によるUARTの大容量転送用ハードウェア抽象化レイヤー実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "uart_dma_hal.hpp"
+#include "interrupt_plan.hpp"
+#include "esp_heap_caps.h"
+
+namespace hal {
+
+namespace {
+
+constexpr size_t RX_BLOCKS_PER_BUFFER = 8;         // 受信済みキューの深さ（受信バッファ1つあたり）
+
+} // namespace
+
+UartDmaHal::UartDmaHal(uart_port_t port)
+    : HalBase("UART_DMA_HAL")
+#if HAL_UART_UHCI_ENABLED
+    , controller_(nullptr)
+#endif
+    , config_()
+    , dma_config_()
+    , tx_free_(nullptr)
+    , rx_free_(nullptr)
+    , rx_ready_(nullptr)
+    , rx_armed_(nullptr)
+    , tx_bytes_(0)
+    , tx_transfers_(0)
+    , tx_errors_(0)
+    , rx_bytes_(0)
+    , rx_blocks_(0)
+    , rx_dropped_(0)
+    , rx_starved_(0) {
+    config_.port = port;
+    config_.baudrate = 921600;
+    config_.data_bits = UART_DATA_8_BITS;
+    config_.parity = UartHal::Parity::NONE;
+    config_.stop_bits = UartHal::StopBits::BITS_1;
+    config_.flow_control = UartHal::FlowControl::NONE;
+    config_.tx_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.rx_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.rts_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.cts_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.rx_buffer_size = 0;
+    config_.tx_buffer_size = 0;
+    config_.queue_size = 0;
+    
+    registerTracePoint(TRACE_SUBMIT, "submit");
+    registerTracePoint(TRACE_ARM, "arm");
+    
+    logDebug("UART DMA HALクラス作成 ポート:%d", static_cast<int>(port));
+}
+
+UartDmaHal::~UartDmaHal() {
+    release();
+    logDebug("UART DMA HALクラス破棄");
+}
+
+esp_err_t UartDmaHal::initialize() {
+    setState(State::INITIALIZING);
+    setState(State::INITIALIZED);
+    logInfo("UART DMA HAL初期化完了 ポート:%d", static_cast<int>(config_.port));
+    return ESP_OK;
+}
+
+esp_err_t UartDmaHal::configure() {
+    if (!isInitialized()) {
+        logError("UART DMA HALが初期化されていません");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+#if HAL_UART_UHCI_ENABLED
+    release();
+    
+    // 回線設定はUARTドライバを入れずにレジスタへ直接適用する
+    uart_config_t uart_config = {};
+    uart_config.baud_rate = config_.baudrate;
+    uart_config.data_bits = config_.data_bits;
+    uart_config.parity = static_cast<uart_parity_t>(config_.parity);
+    uart_config.stop_bits = static_cast<uart_stop_bits_t>(config_.stop_bits);
+    uart_config.flow_ctrl = static_cast<uart_hw_flowcontrol_t>(config_.flow_control);
+    uart_config.rx_flow_ctrl_thresh = 122;
+#if CONFIG_PM_ENABLE
+    uart_config.source_clk = UART_SCLK_XTAL;
+#else
+    uart_config.source_clk = UART_SCLK_DEFAULT;
+#endif
+    
+    esp_err_t ret = uart_param_config(config_.port, &uart_config);
+    if (ret == ESP_OK) {
+        ret = uart_set_pin(config_.port, config_.tx_pin, config_.rx_pin, config_.rts_pin, config_.cts_pin);
+    }
+    if (ret != ESP_OK) {
+        logError("UART設定失敗: %s", esp_err_to_name(ret));
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    ret = allocateBuffers();
+    if (ret != ESP_OK) {
+        logError("DMAバッファ確保失敗 送信:%zu×%zu 受信:%zu×%zu", dma_config_.tx_buffer_count, 
+                 dma_config_.tx_buffer_size, dma_config_.rx_buffer_count, dma_config_.rx_buffer_size);
+        release();
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    uhci_controller_config_t uhci_config = {};
+    uhci_config.uart_port = config_.port;
+    uhci_config.tx_trans_queue_depth = dma_config_.tx_buffer_count;
+    uhci_config.max_transmit_size = dma_config_.tx_buffer_size;
+    uhci_config.max_receive_internal_mem = dma_config_.rx_buffer_size;
+    uhci_config.max_packet_receive = dma_config_.rx_buffer_size;
+    uhci_config.dma_burst_size = dma_config_.dma_burst_size;
+    uhci_config.rx_eof_flags.idle_eof = dma_config_.rx_idle_eof;
+    
+    // GDMAの割り込みはコントローラ作成時に確保されるため、UARTと同じく配置表のコアで作る
+    const uhci_controller_config_t* cfg = &uhci_config;
+    ret = InterruptPlan::install(InterruptPlan::Source::UART, [this, cfg]() {
+        return uhci_new_controller(cfg, &controller_);
+    });
+    if (ret == ESP_OK) {
+        uhci_event_callbacks_t cbs = {};
+        cbs.on_tx_trans_done = onTxDone;
+        cbs.on_rx_trans_event = onRxEvent;
+        ret = uhci_register_event_callbacks(controller_, &cbs, this);
+    }
+    if (ret != ESP_OK) {
+        logError("UHCIコントローラ作成失敗: %s", esp_err_to_name(ret));
+        release();
+        setState(State::ERROR);
+        return ret;
+    }
+    
+    logInfo("UART DMA設定完了 ポート:%d ボーレート:%d 送信:%zu×%zu 受信:%zu×%zu", 
+            static_cast<int>(config_.port), config_.baudrate, dma_config_.tx_buffer_count, 
+            dma_config_.tx_buffer_size, dma_config_.rx_buffer_count, dma_config_.rx_buffer_size);
+    return ESP_OK;
+#else
+    logError("UHCIドライバがありません（ESP-IDF v5.5以上が必要）");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t UartDmaHal::start() {
+    if (!isInitialized()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (tx_free_ == nullptr) {
+        esp_err_t ret = configure();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    setState(State::RUNNING);
+    armRx();
+    logInfo("UART DMA HAL開始");
+    return ESP_OK;
+}
+
+esp_err_t UartDmaHal::stop() {
+    if (isRunning()) {
+        waitTxDone(pdMS_TO_TICKS(1000));
+    }
+    setState(State::SUSPENDED);
+    logInfo("UART DMA HAL停止");
+    return ESP_OK;
+}
+
+esp_err_t UartDmaHal::reset() {
+    stop();
+    release();
+    setState(State::INITIALIZED);
+    logInfo("UART DMA HALリセット完了");
+    return ESP_OK;
+}
+
+esp_err_t UartDmaHal::setConfig(const UartHal::Config& config) {
+    if (tx_free_ != nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    config_ = config;
+    return ESP_OK;
+}
+
+esp_err_t UartDmaHal::setDmaConfig(const DmaConfig& config) {
+    if (tx_free_ != nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config.tx_buffer_count == 0 || config.rx_buffer_count == 0 ||
+        config.tx_buffer_size == 0 || config.rx_buffer_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dma_config_ = config;
+    return ESP_OK;
+}
+
+uint8_t* UartDmaHal::acquireTxBuffer(TickType_t timeout) {
+    if (!isRunning()) {
+        return nullptr;
+    }
+    uint8_t* buffer = nullptr;
+    if (xQueueReceive(tx_free_, &buffer, timeout) != pdTRUE) {
+        return nullptr;
+    }
+    return buffer;
+}
+
+esp_err_t UartDmaHal::submitTx(uint8_t* buffer, size_t length) {
+    if (buffer == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!isRunning() || length == 0 || length > dma_config_.tx_buffer_size) {
+        releaseTxBuffer(buffer);
+        return isRunning() ? ESP_ERR_INVALID_SIZE : ESP_ERR_INVALID_STATE;
+    }
+    
+#if HAL_UART_UHCI_ENABLED
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = uhci_transmit(controller_, buffer, length);
+    traceEnd(TRACE_SUBMIT, trace_start, ret);
+    if (ret != ESP_OK) {
+        tx_errors_.fetch_add(1, std::memory_order_relaxed);
+        releaseTxBuffer(buffer);
+        return ret;
+    }
+    tx_bytes_.fetch_add(length, std::memory_order_relaxed);
+    tx_transfers_.fetch_add(1, std::memory_order_relaxed);
+    return ESP_OK;
+#else
+    releaseTxBuffer(buffer);
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void UartDmaHal::releaseTxBuffer(uint8_t* buffer) {
+    if (buffer != nullptr && tx_free_ != nullptr) {
+        xQueueSend(tx_free_, &buffer, 0);
+    }
+}
+
+esp_err_t UartDmaHal::waitTxDone(TickType_t timeout) {
+#if HAL_UART_UHCI_ENABLED
+    if (controller_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    const int timeout_ms = timeout == portMAX_DELAY ? -1 : static_cast<int>(pdTICKS_TO_MS(timeout));
+    return uhci_wait_all_tx_transaction_done(controller_, timeout_ms);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+bool UartDmaHal::receive(RxBlock& block, TickType_t timeout) {
+    if (!isRunning()) {
+        return false;
+    }
+    // 前回空きがなく止まっていた受信を再開する
+    armRx();
+    if (xQueueReceive(rx_ready_, &block, timeout) != pdTRUE) {
+        return false;
+    }
+    if (block.last) {
+        armRx();
+    }
+    return true;
+}
+
+void UartDmaHal::releaseRx(const RxBlock& block) {
+    if (!block.last || block.buffer == nullptr || rx_free_ == nullptr) {
+        return;
+    }
+    xQueueSend(rx_free_, &block.buffer, 0);
+    if (isRunning()) {
+        armRx();
+    }
+}
+
+void UartDmaHal::armRx() {
+#if HAL_UART_UHCI_ENABLED
+    if (rx_armed_.load(std::memory_order_acquire) != nullptr) {
+        return;
+    }
+    uint8_t* buffer = nullptr;
+    if (xQueueReceive(rx_free_, &buffer, 0) != pdTRUE) {
+        rx_starved_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    // 完了割り込みがバッファを特定できるよう、登録より先に受信中として記録する
+    rx_armed_.store(buffer, std::memory_order_release);
+    uint32_t trace_start = traceBegin();
+    esp_err_t ret = uhci_receive(controller_, buffer, dma_config_.rx_buffer_size);
+    traceEnd(TRACE_ARM, trace_start, ret);
+    if (ret != ESP_OK) {
+        rx_armed_.store(nullptr, std::memory_order_release);
+        xQueueSend(rx_free_, &buffer, 0);
+        logWarning("受信バッファ登録失敗: %s", esp_err_to_name(ret));
+    }
+#endif
+}
+
+#if HAL_UART_UHCI_ENABLED
+bool IRAM_ATTR UartDmaHal::onTxDone(uhci_controller_handle_t controller, const uhci_tx_done_event_data_t* event, 
+                                    void* context) {
+    UartDmaHal* self = static_cast<UartDmaHal*>(context);
+    uint8_t* buffer = static_cast<uint8_t*>(event->buffer);
+    BaseType_t woken = pdFALSE;
+    xQueueSendFromISR(self->tx_free_, &buffer, &woken);
+    return woken == pdTRUE;
+}
+
+bool IRAM_ATTR UartDmaHal::onRxEvent(uhci_controller_handle_t controller, const uhci_rx_event_data_t* event, 
+                                     void* context) {
+    UartDmaHal* self = static_cast<UartDmaHal*>(context);
+    uint8_t* buffer = self->rx_armed_.load(std::memory_order_acquire);
+    const bool last = event->flags.totally_received;
+    RxBlock block = {event->data, event->recv_size, buffer, last};
+    if (last) {
+        self->rx_armed_.store(nullptr, std::memory_order_release);
+    }
+    
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(self->rx_ready_, &block, &woken) == pdTRUE) {
+        self->rx_bytes_.fetch_add(event->recv_size, std::memory_order_relaxed);
+        self->rx_blocks_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // 受信済みキューが満杯（読み出しが遅れている）。最後のブロックならバッファは直ちに空きへ戻す
+        self->rx_dropped_.fetch_add(1, std::memory_order_relaxed);
+        if (last) {
+            xQueueSendFromISR(self->rx_free_, &buffer, &woken);
+        }
+    }
+    return woken == pdTRUE;
+}
+#endif
+
+esp_err_t UartDmaHal::allocateBuffers() {
+    const size_t total = dma_config_.tx_buffer_count + dma_config_.rx_buffer_count;
+    tx_free_ = xQueueCreate(dma_config_.tx_buffer_count, sizeof(uint8_t*));
+    rx_free_ = xQueueCreate(dma_config_.rx_buffer_count, sizeof(uint8_t*));
+    rx_ready_ = xQueueCreate(dma_config_.rx_buffer_count * RX_BLOCKS_PER_BUFFER, sizeof(RxBlock));
+    if (tx_free_ == nullptr || rx_free_ == nullptr || rx_ready_ == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    buffers_.reserve(total);
+    for (size_t i = 0; i < total; i++) {
+        const bool tx = i < dma_config_.tx_buffer_count;
+        const size_t size = tx ? dma_config_.tx_buffer_size : dma_config_.rx_buffer_size;
+        uint8_t* buffer = static_cast<uint8_t*>(heap_caps_malloc(size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL));
+        if (buffer == nullptr) {
+            return ESP_ERR_NO_MEM;
+        }
+        buffers_.push_back(buffer);
+        xQueueSend(tx ? tx_free_ : rx_free_, &buffer, 0);
+    }
+    return ESP_OK;
+}
+
+void UartDmaHal::release() {
+#if HAL_UART_UHCI_ENABLED
+    if (controller_ != nullptr) {
+        uhci_del_controller(controller_);
+        controller_ = nullptr;
+    }
+#endif
+    rx_armed_.store(nullptr, std::memory_order_release);
+    for (uint8_t* buffer : buffers_) {
+        heap_caps_free(buffer);
+    }
+    buffers_.clear();
+    for (QueueHandle_t* queue : {&tx_free_, &rx_free_, &rx_ready_}) {
+        if (*queue != nullptr) {
+            vQueueDelete(*queue);
+            *queue = nullptr;
+        }
+    }
+}
+
+UartDmaHal::Stats UartDmaHal::getStats() const {
+    Stats stats = {};
+    stats.tx_bytes = tx_bytes_.load(std::memory_order_relaxed);
+    stats.tx_transfers = tx_transfers_.load(std::memory_order_relaxed);
+    stats.tx_errors = tx_errors_.load(std::memory_order_relaxed);
+    stats.rx_bytes = rx_bytes_.load(std::memory_order_relaxed);
+    stats.rx_blocks = rx_blocks_.load(std::memory_order_relaxed);
+    stats.rx_dropped = rx_dropped_.load(std::memory_order_relaxed);
+    stats.rx_starved = rx_starved_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void UartDmaHal::dump() const {
+    const Stats s = getStats();
+    logInfo("ポート%d 送信 %lu バイト / %lu 転送（失敗 %lu） 受信 %lu バイト / %lu ブロック（破棄 %lu 空きなし %lu）", 
+            static_cast<int>(config_.port), static_cast<unsigned long>(s.tx_bytes), 
+            static_cast<unsigned long>(s.tx_transfers), static_cast<unsigned long>(s.tx_errors), 
+            static_cast<unsigned long>(s.rx_bytes), static_cast<unsigned long>(s.rx_blocks), 
+            static_cast<unsigned long>(s.rx_dropped), static_cast<unsigned long>(s.rx_starved));
+}
+
+} // namespace hal
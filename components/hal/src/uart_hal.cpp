@@ -10,7 +10,9 @@
  */
 
 #include "uart_hal.hpp"
+#include "interrupt_plan.hpp"
 #include "esp_log.h"
+#include <algorithm>
 #include <cstring>
 
 namespace hal {
@@ -19,21 +21,32 @@ UartHal::UartHal(uart_port_t port)
     : HalBase("UART_HAL")
     , driver_installed_(false)
     , event_queue_(nullptr)
-    , event_task_(nullptr) {
+    , event_task_(nullptr)
+    , rx_ring_capacity_(0)
+    , rx_head_(0)
+    , rx_tail_(0)
+    , rx_overflow_count_(0)
+    , rx_stalled_(false)
+    , frame_buffer_size_(0)
+    , frame_callback_(nullptr)
+    , frame_context_(nullptr) {
     config_.port = port;
     config_.baudrate = 115200;
     config_.data_bits = UART_DATA_8_BITS;
     config_.parity = Parity::NONE;
     config_.stop_bits = StopBits::BITS_1;
     config_.flow_control = FlowControl::NONE;
-    config_.tx_pin = UART_PIN_NO_CHANGE;
-    config_.rx_pin = UART_PIN_NO_CHANGE;
-    config_.rts_pin = UART_PIN_NO_CHANGE;
-    config_.cts_pin = UART_PIN_NO_CHANGE;
+    config_.tx_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.rx_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.rts_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
+    config_.cts_pin = static_cast<gpio_num_t>(UART_PIN_NO_CHANGE);
     config_.rx_buffer_size = 2048;
     config_.tx_buffer_size = 0;
     config_.queue_size = 20;
     
+    registerTracePoint(TRACE_WRITE, "write");
+    registerTracePoint(TRACE_READ, "read");
+    
     logDebug("UART HALクラス作成 ポート:%d", static_cast<int>(port));
 }
 
@@ -86,7 +99,12 @@ esp_err_t UartHal::configure() {
     uart_config.stop_bits = static_cast<uart_stop_bits_t>(config_.stop_bits);
     uart_config.flow_ctrl = static_cast<uart_hw_flowcontrol_t>(config_.flow_control);
     uart_config.rx_flow_ctrl_thresh = 122;
+#if CONFIG_PM_ENABLE
+    // APBクロックは周波数切替で変わるため、電源管理有効時は固定のXTAL（40MHz、最大2.5Mbps）を使う
+    uart_config.source_clk = UART_SCLK_XTAL;
+#else
     uart_config.source_clk = UART_SCLK_DEFAULT;
+#endif
     
     // UART設定を適用
     esp_err_t ret = uart_param_config(config_.port, &uart_config);
@@ -105,10 +123,12 @@ esp_err_t UartHal::configure() {
         return ret;
     }
     
-    // UARTドライバをインストール
-    ret = uart_driver_install(config_.port, config_.rx_buffer_size, 
-                             config_.tx_buffer_size, config_.queue_size, 
-                             &event_queue_, 0);
+    // UARTドライバをインストール（割り込みは配置表のコアに確保される）
+    ret = InterruptPlan::install(InterruptPlan::Source::UART, [this]() {
+        return uart_driver_install(config_.port, config_.rx_buffer_size, 
+                                   config_.tx_buffer_size, config_.queue_size, 
+                                   &event_queue_, InterruptPlan::flags(InterruptPlan::Source::UART));
+    });
     if (ret != ESP_OK) {
         logError("UARTドライバインストール失敗: %s", esp_err_to_name(ret));
         setState(State::ERROR);
@@ -118,9 +138,7 @@ esp_err_t UartHal::configure() {
     driver_installed_ = true;
     
     // イベントタスクを作成
-    if (event_queue_ && event_callback_) {
-        xTaskCreate(eventTask, "uart_event_task", 2048, this, 10, &event_task_);
-    }
+    ensureEventTask();
     
     logInfo("UART設定完了 ポート:%d ボーレート:%d TX:%d RX:%d", 
             static_cast<int>(config_.port), config_.baudrate, 
@@ -173,25 +191,31 @@ esp_err_t UartHal::setConfig(const Config& config) {
 }
 
 esp_err_t UartHal::write(const std::vector<uint8_t>& data, TickType_t timeout) {
+    return write(data.data(), data.size(), timeout);
+}
+
+esp_err_t UartHal::write(const void* data, size_t length, TickType_t timeout) {
     if (!isRunning()) {
         logError("UART HALが動作していません");
         return ESP_ERR_INVALID_STATE;
     }
     
-    if (data.empty()) {
+    if (length == 0) {
         return ESP_OK;
     }
     
     std::lock_guard<std::mutex> lock(mutex_);
     
-    int written = uart_write_bytes(config_.port, data.data(), data.size());
+    uint32_t trace_start = traceBegin();
+    int written = uart_write_bytes(config_.port, data, length);
+    traceEnd(TRACE_WRITE, trace_start, written < 0 ? ESP_FAIL : ESP_OK);
     if (written < 0) {
         logError("UART書き込み失敗");
         return ESP_FAIL;
     }
     
-    if (written != static_cast<int>(data.size())) {
-        logWarning("UART部分書き込み: %d/%zu バイト", written, data.size());
+    if (written != static_cast<int>(length)) {
+        logWarning("UART部分書き込み: %d/%zu バイト", written, length);
     }
     
     logDebug("UART書き込み成功: %d バイト", written);
@@ -199,8 +223,7 @@ esp_err_t UartHal::write(const std::vector<uint8_t>& data, TickType_t timeout) {
 }
 
 esp_err_t UartHal::writeString(const std::string& str, TickType_t timeout) {
-    std::vector<uint8_t> data(str.begin(), str.end());
-    return write(data, timeout);
+    return write(str.data(), str.size(), timeout);
 }
 
 size_t UartHal::read(std::vector<uint8_t>& data, size_t max_length, TickType_t timeout) {
@@ -212,7 +235,9 @@ size_t UartHal::read(std::vector<uint8_t>& data, size_t max_length, TickType_t t
     std::lock_guard<std::mutex> lock(mutex_);
     
     data.resize(max_length);
+    uint32_t trace_start = traceBegin();
     int length = uart_read_bytes(config_.port, data.data(), max_length, timeout);
+    traceEnd(TRACE_READ, trace_start, length < 0 ? ESP_FAIL : ESP_OK);
     
     if (length < 0) {
         logError("UART読み取り失敗");
@@ -337,14 +362,106 @@ esp_err_t UartHal::setEventCallback(EventCallback callback) {
     std::lock_guard<std::mutex> lock(mutex_);
     event_callback_ = callback;
     
-    // イベントタスクを再作成
-    if (driver_installed_ && event_queue_ && callback) {
-        if (event_task_) {
-            vTaskDelete(event_task_);
+    // イベントタスクを作成（既存タスクはコールバックを都度参照する）
+    ensureEventTask();
+    
+    return ESP_OK;
+}
+
+esp_err_t UartHal::enableRxRing(size_t capacity) {
+    if (capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        logError("受信リング容量は2のべき乗であること: %zu", capacity);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (rx_ring_) {
+        logError("受信リングは既に有効です");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    rx_ring_.reset(new uint8_t[capacity]);
+    rx_ring_capacity_ = capacity;
+    rx_head_.store(0, std::memory_order_relaxed);
+    rx_tail_.store(0, std::memory_order_relaxed);
+    
+    ensureEventTask();
+    
+    logInfo("ゼロコピー受信リング有効化: %zu バイト", capacity);
+    return ESP_OK;
+}
+
+UartHal::RxRegion UartHal::peekRx() const {
+    RxRegion region = {nullptr, 0};
+    if (!rx_ring_) {
+        return region;
+    }
+    
+    size_t tail = rx_tail_.load(std::memory_order_relaxed);
+    size_t head = rx_head_.load(std::memory_order_acquire);
+    size_t offset = tail & (rx_ring_capacity_ - 1);
+    
+    region.data = rx_ring_.get() + offset;
+    region.length = std::min(head - tail, rx_ring_capacity_ - offset);
+    return region;
+}
+
+void UartHal::consumeRx(size_t length) {
+    size_t tail = rx_tail_.load(std::memory_order_relaxed);
+    size_t head = rx_head_.load(std::memory_order_acquire);
+    rx_tail_.store(tail + std::min(length, head - tail), std::memory_order_seq_cst);
+    
+    // 満杯で止まった転送を再開する（ドライバに残ったデータは次の受信イベントまで待たされるため）
+    if (length > 0 && rx_stalled_.load(std::memory_order_seq_cst) && 
+        rx_stalled_.exchange(false, std::memory_order_acq_rel)) {
+        uart_event_t resume = {};
+        resume.type = RX_RING_RESUME;
+        if (xQueueSend(event_queue_, &resume, 0) != pdTRUE) {
+            // キューが満杯の場合は次の消費で再試行する
+            rx_stalled_.store(true, std::memory_order_release);
         }
-        xTaskCreate(eventTask, "uart_event_task", 2048, this, 10, &event_task_);
     }
+}
+
+esp_err_t UartHal::setFrameCallback(char delimiter, FrameCallback callback, void* context,  
+                                    size_t max_frame_size) {
+    if (!driver_installed_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (callback == nullptr) {
+        frame_callback_ = nullptr;
+        return uart_disable_pattern_det_intr(config_.port);
+    }
+    
+    if (max_frame_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // フレームバッファは設定時に一度だけ確保
+    if (frame_buffer_size_ < max_frame_size) {
+        frame_buffer_.reset(new uint8_t[max_frame_size]);
+        frame_buffer_size_ = max_frame_size;
+    }
+    frame_context_ = context;
+    frame_callback_ = callback;
     
+    esp_err_t ret = uart_enable_pattern_det_baud_intr(config_.port, delimiter, 1, 1, 0, 0);
+    if (ret != ESP_OK) {
+        logError("パターン検出設定失敗: %s", esp_err_to_name(ret));
+        frame_callback_ = nullptr;
+        return ret;
+    }
+    
+    ret = uart_pattern_queue_reset(config_.port, config_.queue_size);
+    if (ret != ESP_OK) {
+        logError("パターン位置キュー初期化失敗: %s", esp_err_to_name(ret));
+        frame_callback_ = nullptr;
+        return ret;
+    }
+    
+    ensureEventTask();
+    
+    logInfo("フレーム受信有効化 区切り:0x%02X 最大長:%zu", static_cast<uint8_t>(delimiter), max_frame_size);
     return ESP_OK;
 }
 
@@ -366,6 +483,22 @@ void UartHal::eventTask(void* arg) {
     
     while (true) {
         if (xQueueReceive(instance->event_queue_, &event, portMAX_DELAY)) {
+            if (event.type == RX_RING_RESUME) {
+                // consumeRx() からの再開要求（内部イベントのためコールバックへは渡さない）
+                if (!instance->frame_callback_ && instance->rx_ring_) {
+                    instance->fillRxRing();
+                }
+                continue;
+            }
+            
+            if (instance->frame_callback_) {
+                if (event.type == UART_PATTERN_DET) {
+                    instance->readFrame();
+                }
+            } else if (instance->rx_ring_ && event.type == UART_DATA) {
+                instance->fillRxRing();
+            }
+            
             if (instance->event_callback_) {
                 instance->event_callback_(
                     static_cast<EventType>(event.type), 
@@ -376,4 +509,83 @@ void UartHal::eventTask(void* arg) {
     }
 }
 
+void UartHal::ensureEventTask() {
+    if (event_task_ || !driver_installed_ || !event_queue_) {
+        return;
+    }
+    
+    if (!event_callback_ && !rx_ring_ && !frame_callback_) {
+        return;
+    }
+    
+    xTaskCreate(eventTask, "uart_event_task", EVENT_TASK_STACK_SIZE, this, 10, &event_task_);
+}
+
+void UartHal::fillRxRing() {
+    size_t buffered = 0;
+    uart_get_buffered_data_len(config_.port, &buffered);
+    
+    while (buffered > 0) {
+        size_t head = rx_head_.load(std::memory_order_relaxed);
+        size_t tail = rx_tail_.load(std::memory_order_acquire);
+        size_t free_space = rx_ring_capacity_ - (head - tail);
+        if (free_space == 0) {
+            // 残りはドライババッファに保持し、利用側の consumeRx() で空きができたら再開する
+            // （フラグを立ててから空きを確認し直し、その間の消費を取りこぼさない）
+            rx_stalled_.store(true, std::memory_order_seq_cst);
+            tail = rx_tail_.load(std::memory_order_seq_cst);
+            if (head - tail == rx_ring_capacity_) {
+                rx_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            rx_stalled_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+        
+        // リング末尾までの連続領域へ直接読み込む
+        size_t offset = head & (rx_ring_capacity_ - 1);
+        size_t chunk = std::min({buffered, free_space, rx_ring_capacity_ - offset});
+        int length = uart_read_bytes(config_.port, rx_ring_.get() + offset, chunk, 0);
+        if (length <= 0) {
+            return;
+        }
+        
+        rx_head_.store(head + length, std::memory_order_release);
+        buffered -= length;
+    }
+}
+
+void UartHal::readFrame() {
+    int position = uart_pattern_pop_pos(config_.port);
+    if (position < 0) {
+        // パターン位置キューが溢れた場合は同期を取り直す
+        uart_flush_input(config_.port);
+        uart_pattern_queue_reset(config_.port, config_.queue_size);
+        rx_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    size_t frame_length = static_cast<size_t>(position) + 1;   // 区切り文字を含む
+    if (frame_length > frame_buffer_size_) {
+        // 長すぎるフレームは破棄
+        while (frame_length > 0) {
+            size_t chunk = std::min(frame_length, frame_buffer_size_);
+            int length = uart_read_bytes(config_.port, frame_buffer_.get(), chunk, pdMS_TO_TICKS(10));
+            if (length <= 0) {
+                break;
+            }
+            frame_length -= length;
+        }
+        rx_overflow_count_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    
+    int length = uart_read_bytes(config_.port, frame_buffer_.get(), frame_length, pdMS_TO_TICKS(10));
+    if (length != static_cast<int>(frame_length)) {
+        return;
+    }
+    
+    frame_callback_(frame_buffer_.get(), frame_length - 1, frame_context_);
+}
+
 } // namespace hal
\ No newline at end of file
@@ -0,0 +1,104 @@
+/*
+ * Minimum Jerk Segment
+ * 
+ * 1軸の最小ジャーク軌道（5次多項式、ヘッダーオンリー）
+ * 係数は区間の開始時に1回だけ求め、周期毎の評価はホーナー法で行う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MIN_JERK_SEGMENT_HPP
+#define MIN_JERK_SEGMENT_HPP
+
+#include <cstddef>
+
+namespace navigation {
+
+/**
+ * @brief 区間の境界条件
+ */
+struct BoundaryState {
+    float position;             // 位置
+    float velocity;             // 速度
+    float acceleration;         // 加速度
+};
+
+/**
+ * @brief 1軸の最小ジャーク区間
+ * 
+ * 開始・終了の位置・速度・加速度と区間長から p(τ) = c0 + c1 τ + ... + c5 τ^5 を決める。
+ * 速度・加速度の係数も plan() で前計算し、evaluate() は乗算15回・加算15回で済む
+ */
+class MinimumJerkSegment {
+public:
+    static constexpr float REST_PEAK_VELOCITY = 1.875f;       // 静止→静止の最大速度 = 1.875 d / T
+    static constexpr float REST_PEAK_ACCELERATION = 5.7735f;  // 静止→静止の最大加速度 = 5.7735 d / T^2
+    
+    MinimumJerkSegment()
+        : duration_(0.0f)
+        , p_{}
+        , v_{}
+        , a_{} {}
+    
+    /**
+     * @brief 区間の計画（係数の計算）
+     * @param start 開始状態
+     * @param end 終了状態
+     * @param duration 区間長（s、正の値）
+     */
+    void plan(const BoundaryState& start, const BoundaryState& end, float duration) {
+        const float t = duration;
+        const float t2 = t * t;
+        const float t3 = t2 * t;
+        const float h = end.position - start.position;
+        const float v0 = start.velocity;
+        const float v1 = end.velocity;
+        const float a0 = start.acceleration;
+        const float a1 = end.acceleration;
+        
+        duration_ = duration;
+        p_[0] = start.position;
+        p_[1] = v0;
+        p_[2] = 0.5f * a0;
+        p_[3] = (20.0f * h - (8.0f * v1 + 12.0f * v0) * t - (3.0f * a0 - a1) * t2) / (2.0f * t3);
+        p_[4] = (-30.0f * h + (14.0f * v1 + 16.0f * v0) * t + (3.0f * a0 - 2.0f * a1) * t2) / (2.0f * t3 * t);
+        p_[5] = (12.0f * h - 6.0f * (v1 + v0) * t + (a1 - a0) * t2) / (2.0f * t3 * t2);
+        
+        for (size_t i = 0; i < 5; i++) {
+            v_[i] = static_cast<float>(i + 1) * p_[i + 1];
+        }
+        for (size_t i = 0; i < 4; i++) {
+            a_[i] = static_cast<float>(i + 1) * v_[i + 1];
+        }
+    }
+    
+    /**
+     * @brief 区間内の状態の評価（区間外は端の時刻に丸める）
+     * @param time 区間の開始からの時刻（s）
+     * @param state 状態の格納先
+     */
+    void evaluate(float time, BoundaryState& state) const {
+        const float t = (time < 0.0f) ? 0.0f : ((time > duration_) ? duration_ : time);
+        state.position = ((((p_[5] * t + p_[4]) * t + p_[3]) * t + p_[2]) * t + p_[1]) * t + p_[0];
+        state.velocity = (((v_[4] * t + v_[3]) * t + v_[2]) * t + v_[1]) * t + v_[0];
+        state.acceleration = ((a_[3] * t + a_[2]) * t + a_[1]) * t + a_[0];
+    }
+    
+    /**
+     * @brief 区間長（s）
+     */
+    float getDuration() const { return duration_; }
+    
+private:
+    float duration_;            // 区間長（s）
+    float p_[6];                // 位置の係数（τの昇順）
+    float v_[5];                // 速度の係数
+    float a_[4];                // 加速度の係数
+};
+
+} // namespace navigation
+
+#endif // MIN_JERK_SEGMENT_HPP
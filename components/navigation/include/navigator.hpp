@@ -0,0 +1,126 @@
+/*
+ * Navigator
+ * 
+ * 位置制御のレートグループで動くナビゲーション層
+ * 共有機体状態のスナップショットを読み、ウェイポイントエンジンと位置制御で作った目標を
+ * 共有姿勢目標値として姿勢ループへ渡す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef NAVIGATOR_HPP
+#define NAVIGATOR_HPP
+
+#include "flight_state.hpp"
+#include "position_controller.hpp"
+#include "waypoint_engine.hpp"
+#include <cstdint>
+
+namespace navigation {
+
+/**
+ * @brief ナビゲーションクラス
+ * 
+ * 使用例（位置制御タスク、RateSchedulerで姿勢ループを分周したグループ）:
+ *   scheduler.addGroup(50, xTaskGetCurrentTaskHandle());
+ *   while (true) {
+ *       scheduler.waitForTick();
+ *       navigator.update();
+ *   }
+ * 姿勢ループは毎周期 SharedAttitudeSetpoint::instance().snapshot() で最新の目標を読む。
+ * 状態のスナップショットが古い・飛行中でない場合は目標を無効（valid=false）として公開し、
+ * 積分をクリアする
+ */
+class Navigator {
+public:
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        float rate_hz = 50.0f;                      // 位置制御の周波数（Hz、レートグループと同じ値）
+        int64_t stale_timeout_us = 100000;          // 状態のスナップショットを古いとみなす時間（μs）
+        WaypointEngine::Config engine;              // ウェイポイントエンジン設定
+        PositionController::Config controller;      // 位置制御設定
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t updates;           // 更新回数
+        uint32_t published;         // 有効な目標を公開した回数
+        uint32_t stale;             // 状態が古く・取得できず目標を無効にした回数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param state 共有機体状態
+     * @param setpoint 共有姿勢目標値
+     */
+    explicit Navigator(const common::SharedFlightState& state = common::SharedFlightState::instance(), 
+                       common::SharedAttitudeSetpoint& setpoint = common::SharedAttitudeSetpoint::instance());
+    
+    /**
+     * @brief 設定
+     * @param config 設定
+     */
+    void setConfig(const Config& config);
+    
+    /**
+     * @brief 1周期の処理（スナップショット取得・目標値の評価・位置制御・公開）
+     * @return bool 有効な目標を公開した場合true
+     */
+    bool update();
+    
+    /**
+     * @brief 1周期の処理（状態を直接与える、リプレイ・シミュレーション用）
+     * @param state 機体状態
+     * @return bool 有効な目標を公開した場合true
+     */
+    bool update(const common::FlightState& state);
+    
+    /**
+     * @brief ウェイポイントエンジン取得（ウェイポイントの追加・位置保持）
+     */
+    WaypointEngine& getEngine() { return engine_; }
+    
+    /**
+     * @brief 直近に公開した目標
+     */
+    const common::AttitudeSetpoint& getSetpoint() const { return setpoint_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    const common::SharedFlightState& shared_state_;     // 共有機体状態
+    common::SharedAttitudeSetpoint& shared_setpoint_;   // 共有姿勢目標値
+    Config config_;                                     // 設定
+    float dt_;                                          // 周期（s）
+    WaypointEngine engine_;                             // ウェイポイントエンジン
+    PositionController controller_;                     // 位置制御
+    int64_t last_state_us_;                             // 前回使った状態の時刻
+    bool active_;                                       // 位置制御中（前回の目標が有効）
+    common::AttitudeSetpoint setpoint_;                 // 直近の目標
+    Stats stats_;                                       // 統計情報
+    
+    /**
+     * @brief 無効な目標の公開
+     */
+    void publishInvalid(const common::FlightState* state);
+};
+
+} // namespace navigation
+
+#endif // NAVIGATOR_HPP
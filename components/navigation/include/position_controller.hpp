@@ -0,0 +1,84 @@
+/*
+ * Position Controller
+ * 
+ * 位置・速度の目標値から姿勢ループへの目標（ロール・ピッチ・ヨー・推力）を作る位置制御
+ * 位置P → 速度PI + 加速度フィードフォワードで目標加速度を求め、推力ベクトルの向きを傾きに換える
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef POSITION_CONTROLLER_HPP
+#define POSITION_CONTROLLER_HPP
+
+#include "flight_state.hpp"
+#include "waypoint_engine.hpp"
+
+namespace navigation {
+
+/**
+ * @brief 位置制御クラス
+ * 
+ * 座標はNED（Z下向き）、機体座標はFRD。姿勢ループより低い周期（分周したレートグループ）で動かす。
+ * 積分は目標加速度が上限で飽和している間は飽和を深める向きに積まない
+ */
+class PositionController {
+public:
+    static constexpr float GRAVITY = 9.80665f;     // 標準重力加速度（m/s^2）
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        float position_kp = 1.2f;           // 位置ループ比例ゲイン（1/s）
+        float velocity_limit = 1.0f;        // 位置ループが出す速度補正の上限（m/s）
+        float velocity_kp = 2.5f;           // 速度ループ比例ゲイン（1/s）
+        float velocity_ki = 0.6f;           // 速度ループ積分ゲイン（1/s^2）
+        float integral_limit = 1.5f;        // 積分項の上限（m/s^2）
+        float horizontal_accel_limit = 3.0f;    // 水平の目標加速度の上限（m/s^2）
+        float vertical_accel_limit = 3.0f;      // 鉛直の目標加速度の上限（m/s^2）
+        float tilt_limit = 0.35f;           // 傾きの上限（rad）
+        float hover_thrust = 0.5f;          // ホバリング推力（0〜1）
+        float thrust_min = 0.1f;            // 推力の下限
+        float thrust_max = 0.9f;            // 推力の上限
+    };
+    
+public:
+    PositionController();
+    
+    /**
+     * @brief 設定（積分をクリアする）
+     * @param config 設定
+     */
+    void setConfig(const Config& config);
+    
+    /**
+     * @brief 積分のクリア
+     */
+    void reset();
+    
+    /**
+     * @brief 目標値の計算
+     * @param reference 位置・速度・加速度の目標値
+     * @param state 機体状態（位置・速度・ヨー）
+     * @param dt 周期（s）
+     * @param setpoint 姿勢ループへの目標の格納先（timestamp_us・validも設定する）
+     */
+    void compute(const Reference& reference, const common::FlightState& state, float dt, 
+                 common::AttitudeSetpoint& setpoint);
+    
+    /**
+     * @brief 速度ループの積分項（m/s^2、NED）
+     */
+    const float* getIntegral() const { return integral_; }
+    
+private:
+    Config config_;                 // 設定
+    float integral_[3];             // 速度ループの積分項（m/s^2）
+};
+
+} // namespace navigation
+
+#endif // POSITION_CONTROLLER_HPP
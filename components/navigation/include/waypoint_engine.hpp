@@ -0,0 +1,162 @@
+/*
+ * Waypoint Engine
+ * 
+ * ウェイポイント列から位置・速度・加速度の目標値を作る逐次軌道生成
+ * 区間（最小ジャーク軌道）は区間の開始時に1回だけ計画し、周期毎には評価のみ行う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef WAYPOINT_ENGINE_HPP
+#define WAYPOINT_ENGINE_HPP
+
+#include "min_jerk_segment.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace navigation {
+
+/**
+ * @brief ウェイポイント（座標はSharedFlightStateと同じNED、m）
+ */
+struct Waypoint {
+    float position[3];          // 目標位置（m）
+    float yaw;                  // 目標ヨー角（rad）
+    float speed;                // 区間の最大速度（m/s、0で既定値）
+    float hold_time;            // 到着後の停止時間（s）
+};
+
+/**
+ * @brief 位置制御への目標値
+ */
+struct Reference {
+    float position[3];          // 目標位置（m）
+    float velocity[3];          // 目標速度（m/s、フィードフォワード）
+    float acceleration[3];      // 目標加速度（m/s^2、フィードフォワード）
+    float yaw;                  // 目標ヨー角（rad）
+};
+
+/**
+ * @brief ウェイポイントエンジンクラス
+ * 
+ * 各ウェイポイントへは停止から停止までの最小ジャーク区間で移動する（開始時のみ現在の速度・加速度から）。
+ * 区間長は最大速度・最大加速度を超えない最短の長さで、ヨーも同じ区間長で最短回りに補間する。
+ * ウェイポイントがなくなると最後の位置で位置保持する。
+ * 呼び出しは全て同じタスク（位置制御のレートグループ）から行うこと
+ */
+class WaypointEngine {
+public:
+    static constexpr size_t MAX_WAYPOINTS = 32;     // 登録できるウェイポイント数
+    
+    /**
+     * @brief 状態
+     */
+    enum class State : uint8_t {
+        IDLE = 0,               // 未開始（目標値なし）
+        HOLD,                   // 位置保持
+        MOVING,                 // 区間の移動中
+        DWELL                   // ウェイポイントでの停止中
+    };
+    
+    /**
+     * @brief 設定構造体
+     */
+    struct Config {
+        float default_speed = 0.5f;         // 区間の最大速度の既定値（m/s）
+        float max_acceleration = 1.5f;      // 区間の最大加速度（m/s^2）
+        float max_yaw_rate = 1.0f;          // ヨーの最大角速度（rad/s）
+        float min_duration = 0.5f;          // 区間長の下限（s）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t segments;          // 計画した区間数
+        uint32_t reached;           // 到着したウェイポイント数
+        uint32_t rejected;          // 満杯で登録できなかったウェイポイント数
+    };
+    
+public:
+    WaypointEngine();
+    
+    /**
+     * @brief 設定
+     * @param config 設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief ウェイポイントの追加（移動中も可、現在の列の末尾に加える）
+     * @param waypoint ウェイポイント
+     * @return bool 登録した場合true（満杯時false）
+     */
+    bool add(const Waypoint& waypoint);
+    
+    /**
+     * @brief 未到着のウェイポイントの破棄（移動中の区間は最後まで進む）
+     */
+    void clear();
+    
+    /**
+     * @brief 位置保持の開始（列を破棄し、指定位置で静止する）
+     * @param position 保持位置（m）
+     * @param yaw 保持ヨー角（rad）
+     */
+    void hold(const float position[3], float yaw);
+    
+    /**
+     * @brief 1周期進めて目標値を求める
+     * @param dt 周期（s）
+     * @param reference 目標値の格納先
+     * @return bool 目標値がある場合true（IDLE中はfalse）
+     */
+    bool update(float dt, Reference& reference);
+    
+    /**
+     * @brief 状態取得
+     */
+    State getState() const { return state_; }
+    
+    /**
+     * @brief 未到着のウェイポイント数（移動中の区間の行き先を含む）
+     */
+    size_t pending() const { return count_ + (state_ == State::MOVING ? 1 : 0); }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr size_t AXES = 3;
+    
+    Config config_;                         // 設定
+    Waypoint waypoints_[MAX_WAYPOINTS];     // 未開始のウェイポイント（リング）
+    size_t head_;                           // 先頭（次に開始する）の位置
+    size_t count_;                          // 未開始のウェイポイント数
+    State state_;                           // 状態
+    MinimumJerkSegment segment_[AXES];      // 移動中の区間（軸毎）
+    MinimumJerkSegment yaw_segment_;        // 移動中の区間（ヨー、連続角）
+    float elapsed_;                         // 区間・停止の経過時間（s）
+    float dwell_time_;                      // 停止時間（s）
+    Reference reference_;                   // 直近の目標値
+    Stats stats_;                           // 統計情報
+    
+    /**
+     * @brief 次のウェイポイントへの区間を計画
+     */
+    void beginSegment();
+};
+
+} // namespace navigation
+
+#endif // WAYPOINT_ENGINE_HPP
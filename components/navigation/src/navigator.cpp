@@ -0,0 +1,113 @@
+/*
+ * Navigator Implementation
+ * 
+ * ナビゲーション層実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "navigator.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace navigation {
+
+static const char* TAG = "navigation::Navigator";
+
+Navigator::Navigator(const common::SharedFlightState& state, common::SharedAttitudeSetpoint& setpoint)
+    : shared_state_(state)
+    , shared_setpoint_(setpoint)
+    , config_()
+    , dt_(1.0f / config_.rate_hz)
+    , engine_()
+    , controller_()
+    , last_state_us_(0)
+    , active_(false)
+    , setpoint_{}
+    , stats_{} {
+}
+
+void Navigator::setConfig(const Config& config) {
+    config_ = config;
+    dt_ = 1.0f / config.rate_hz;
+    engine_.setConfig(config.engine);
+    controller_.setConfig(config.controller);
+}
+
+bool Navigator::update() {
+    common::FlightState state;
+    if (!shared_state_.snapshot(state) ||
+        esp_timer_get_time() - state.timestamp_us > config_.stale_timeout_us) {
+        stats_.updates++;
+        stats_.stale++;
+        publishInvalid(nullptr);
+        return false;
+    }
+    return update(state);
+}
+
+bool Navigator::update(const common::FlightState& state) {
+    stats_.updates++;
+    if (!state.armed || state.mode != common::FlightMode::FLIGHT) {
+        publishInvalid(&state);
+        return false;
+    }
+    if (state.timestamp_us == last_state_us_) {
+        // 姿勢ループ側の公開が止まっている（同じ状態で積分を進めない）
+        stats_.stale++;
+        publishInvalid(&state);
+        return false;
+    }
+    last_state_us_ = state.timestamp_us;
+    
+    if (!active_) {
+        // 位置制御の開始時は、ウェイポイントが未設定なら現在位置で位置保持する
+        controller_.reset();
+        if (engine_.getState() == WaypointEngine::State::IDLE) {
+            const float position[3] = {state.position.x, state.position.y, state.position.z};
+            engine_.hold(position, state.yaw);
+        }
+        active_ = true;
+    }
+    
+    Reference reference;
+    if (!engine_.update(dt_, reference)) {
+        publishInvalid(&state);
+        return false;
+    }
+    controller_.compute(reference, state, dt_, setpoint_);
+    shared_setpoint_.publish(setpoint_);
+    stats_.published++;
+    return true;
+}
+
+void Navigator::publishInvalid(const common::FlightState* state) {
+    if (active_) {
+        controller_.reset();
+        active_ = false;
+    }
+    setpoint_.valid = false;
+    setpoint_.thrust = 0.0f;
+    if (state != nullptr) {
+        setpoint_.roll = 0.0f;
+        setpoint_.pitch = 0.0f;
+        setpoint_.yaw = state->yaw;
+        setpoint_.timestamp_us = state->timestamp_us;
+    }
+    shared_setpoint_.publish(setpoint_);
+}
+
+void Navigator::dump() const {
+    ESP_LOGI(TAG, "%.0fHz 目標 %s roll %.1f pitch %.1f yaw %.1f deg 推力 %.3f", 
+             config_.rate_hz, setpoint_.valid ? "有効" : "無効", 
+             setpoint_.roll * 57.2958f, setpoint_.pitch * 57.2958f, setpoint_.yaw * 57.2958f, setpoint_.thrust);
+    ESP_LOGI(TAG, "更新 %lu 公開 %lu 状態なし %lu", 
+             static_cast<unsigned long>(stats_.updates), static_cast<unsigned long>(stats_.published), 
+             static_cast<unsigned long>(stats_.stale));
+    engine_.dump();
+}
+
+} // namespace navigation
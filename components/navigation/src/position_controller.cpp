@@ -0,0 +1,104 @@
+/*
+ * Position Controller Implementation
+ * 
+ * 位置制御実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "position_controller.hpp"
+#include <cmath>
+
+namespace navigation {
+
+namespace {
+
+constexpr float MIN_LIFT = 0.2f * PositionController::GRAVITY;    // 傾きを決められる最小の推力加速度
+
+inline float clampSymmetric(float value, float limit) {
+    return (value > limit) ? limit : ((value < -limit) ? -limit : value);
+}
+
+} // namespace
+
+PositionController::PositionController()
+    : config_()
+    , integral_{} {
+}
+
+void PositionController::setConfig(const Config& config) {
+    config_ = config;
+    reset();
+}
+
+void PositionController::reset() {
+    for (size_t i = 0; i < 3; i++) {
+        integral_[i] = 0.0f;
+    }
+}
+
+void PositionController::compute(const Reference& reference, const common::FlightState& state, float dt, 
+                                 common::AttitudeSetpoint& setpoint) {
+    const float position[3] = {state.position.x, state.position.y, state.position.z};
+    const float velocity[3] = {state.velocity.x, state.velocity.y, state.velocity.z};
+    
+    // 位置P（速度補正を制限）→ 速度PI + 加速度フィードフォワード
+    float velocity_error[3];
+    float accel[3];
+    for (size_t i = 0; i < 3; i++) {
+        const float correction = clampSymmetric(config_.position_kp * (reference.position[i] - position[i]), 
+                                                config_.velocity_limit);
+        velocity_error[i] = reference.velocity[i] + correction - velocity[i];
+        accel[i] = reference.acceleration[i] + config_.velocity_kp * velocity_error[i] + integral_[i];
+    }
+    
+    // 水平はベクトルの大きさ、鉛直は成分で制限（上昇側は推力、下降側は重力以下に抑える）
+    bool saturated[3] = {false, false, false};
+    float horizontal_limit = config_.horizontal_accel_limit;
+    accel[2] = clampSymmetric(accel[2], config_.vertical_accel_limit);
+    saturated[2] = std::fabs(accel[2]) >= config_.vertical_accel_limit;
+    float lift = GRAVITY - accel[2];           // 推力が担う鉛直上向きの加速度（NEDでZ下向き）
+    if (lift < MIN_LIFT) {
+        lift = MIN_LIFT;
+    }
+    const float tilt_horizontal = lift * std::tan(config_.tilt_limit);
+    if (tilt_horizontal < horizontal_limit) {
+        horizontal_limit = tilt_horizontal;
+    }
+    const float horizontal = std::sqrt(accel[0] * accel[0] + accel[1] * accel[1]);
+    if (horizontal > horizontal_limit && horizontal > 0.0f) {
+        const float scale = horizontal_limit / horizontal;
+        accel[0] *= scale;
+        accel[1] *= scale;
+        saturated[0] = saturated[1] = true;
+    }
+    
+    // 条件付き積分（飽和中は飽和を深める向きに積まない）
+    for (size_t i = 0; i < 3; i++) {
+        const float step = config_.velocity_ki * velocity_error[i] * dt;
+        if (!saturated[i] || (step * accel[i] < 0.0f)) {
+            integral_[i] = clampSymmetric(integral_[i] + step, config_.integral_limit);
+        }
+    }
+    
+    // 推力ベクトル f = a - g を機体のヨーで回し、傾きと大きさに分ける
+    const float cos_yaw = std::cos(state.yaw);
+    const float sin_yaw = std::sin(state.yaw);
+    const float forward = cos_yaw * accel[0] + sin_yaw * accel[1];
+    const float right = -sin_yaw * accel[0] + cos_yaw * accel[1];
+    setpoint.pitch = std::atan2(-forward, lift);
+    setpoint.roll = std::atan2(right, std::sqrt(forward * forward + lift * lift));
+    setpoint.yaw = reference.yaw;
+    
+    const float magnitude = std::sqrt(forward * forward + right * right + lift * lift);
+    float thrust = config_.hover_thrust * magnitude / GRAVITY;
+    thrust = (thrust < config_.thrust_min) ? config_.thrust_min : ((thrust > config_.thrust_max) ? config_.thrust_max : thrust);
+    setpoint.thrust = thrust;
+    setpoint.timestamp_us = state.timestamp_us;
+    setpoint.valid = true;
+}
+
+} // namespace navigation
@@ -0,0 +1,152 @@
+/*
+ * Waypoint Engine Implementation
+ * 
+ * ウェイポイントエンジン実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "waypoint_engine.hpp"
+#include "esp_log.h"
+#include <cmath>
+
+namespace navigation {
+
+static const char* TAG = "navigation::WaypointEngine";
+
+namespace {
+
+constexpr float PI = 3.14159265f;
+
+inline float wrapAngle(float angle) {
+    return std::remainder(angle, 2.0f * PI);
+}
+
+} // namespace
+
+WaypointEngine::WaypointEngine()
+    : config_()
+    , waypoints_{}
+    , head_(0)
+    , count_(0)
+    , state_(State::IDLE)
+    , elapsed_(0.0f)
+    , dwell_time_(0.0f)
+    , reference_{}
+    , stats_{} {
+}
+
+bool WaypointEngine::add(const Waypoint& waypoint) {
+    if (count_ >= MAX_WAYPOINTS) {
+        stats_.rejected++;
+        return false;
+    }
+    waypoints_[(head_ + count_) % MAX_WAYPOINTS] = waypoint;
+    count_++;
+    return true;
+}
+
+void WaypointEngine::clear() {
+    count_ = 0;
+}
+
+void WaypointEngine::hold(const float position[3], float yaw) {
+    count_ = 0;
+    for (size_t i = 0; i < AXES; i++) {
+        reference_.position[i] = position[i];
+        reference_.velocity[i] = 0.0f;
+        reference_.acceleration[i] = 0.0f;
+    }
+    reference_.yaw = wrapAngle(yaw);
+    state_ = State::HOLD;
+}
+
+void WaypointEngine::beginSegment() {
+    const Waypoint& target = waypoints_[head_];
+    head_ = (head_ + 1) % MAX_WAYPOINTS;
+    count_--;
+    
+    float distance_sq = 0.0f;
+    for (size_t i = 0; i < AXES; i++) {
+        const float d = target.position[i] - reference_.position[i];
+        distance_sq += d * d;
+    }
+    const float distance = std::sqrt(distance_sq);
+    const float yaw_delta = wrapAngle(target.yaw - reference_.yaw);
+    const float speed = (target.speed > 0.0f) ? target.speed : config_.default_speed;
+    
+    // 最大速度・最大加速度・ヨーの最大角速度を超えない最短の区間長
+    float duration = config_.min_duration;
+    duration = std::fmax(duration, MinimumJerkSegment::REST_PEAK_VELOCITY * distance / speed);
+    duration = std::fmax(duration, std::sqrt(MinimumJerkSegment::REST_PEAK_ACCELERATION * distance / config_.max_acceleration));
+    duration = std::fmax(duration, MinimumJerkSegment::REST_PEAK_VELOCITY * std::fabs(yaw_delta) / config_.max_yaw_rate);
+    
+    for (size_t i = 0; i < AXES; i++) {
+        const BoundaryState start = {reference_.position[i], reference_.velocity[i], reference_.acceleration[i]};
+        const BoundaryState end = {target.position[i], 0.0f, 0.0f};
+        segment_[i].plan(start, end, duration);
+    }
+    // ヨーは区間内で折り返さない連続角で計画し、評価時に正規化する
+    yaw_segment_.plan(BoundaryState{reference_.yaw, 0.0f, 0.0f}, 
+                      BoundaryState{reference_.yaw + yaw_delta, 0.0f, 0.0f}, duration);
+    
+    dwell_time_ = target.hold_time;
+    elapsed_ = 0.0f;
+    state_ = State::MOVING;
+    stats_.segments++;
+    ESP_LOGD(TAG, "区間開始 (%.2f, %.2f, %.2f) 距離 %.2fm 区間長 %.2fs", 
+             target.position[0], target.position[1], target.position[2], distance, duration);
+}
+
+bool WaypointEngine::update(float dt, Reference& reference) {
+    if (state_ == State::IDLE) {
+        return false;
+    }
+    
+    if (state_ == State::MOVING) {
+        elapsed_ += dt;
+        BoundaryState axis;
+        for (size_t i = 0; i < AXES; i++) {
+            segment_[i].evaluate(elapsed_, axis);
+            reference_.position[i] = axis.position;
+            reference_.velocity[i] = axis.velocity;
+            reference_.acceleration[i] = axis.acceleration;
+        }
+        yaw_segment_.evaluate(elapsed_, axis);
+        reference_.yaw = wrapAngle(axis.position);
+        
+        if (elapsed_ >= segment_[0].getDuration()) {
+            stats_.reached++;
+            elapsed_ = 0.0f;
+            state_ = (dwell_time_ > 0.0f) ? State::DWELL : State::HOLD;
+        }
+    } else if (state_ == State::DWELL) {
+        elapsed_ += dt;
+        if (elapsed_ >= dwell_time_) {
+            state_ = State::HOLD;
+        }
+    }
+    
+    // 停止中でなければ次の区間へ（計画は区間の開始時のみ）
+    if (state_ == State::HOLD && count_ > 0) {
+        beginSegment();
+    }
+    
+    reference = reference_;
+    return true;
+}
+
+void WaypointEngine::dump() const {
+    static const char* const STATE_NAMES[] = {"未開始", "位置保持", "移動中", "停止中"};
+    ESP_LOGI(TAG, "状態 %s 残り %u 目標 (%.2f, %.2f, %.2f) m ヨー %.1f deg", 
+             STATE_NAMES[static_cast<uint8_t>(state_)], static_cast<unsigned>(pending()), 
+             reference_.position[0], reference_.position[1], reference_.position[2], reference_.yaw * 57.2958f);
+    ESP_LOGI(TAG, "区間 %lu 到着 %lu 満杯 %lu", 
+             static_cast<unsigned long>(stats_.segments), static_cast<unsigned long>(stats_.reached), 
+             static_cast<unsigned long>(stats_.rejected));
+}
+
+} // namespace navigation
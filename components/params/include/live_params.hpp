@@ -0,0 +1,132 @@
+/*
+ * Live Params
+ * 
+ * 飛行中のパラメータ調整の二重バッファ（ヘッダーオンリー）
+ * 調整側が影のコピーへ書き、制御ループが周期の境界で一括して取り込む
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef LIVE_PARAMS_HPP
+#define LIVE_PARAMS_HPP
+
+#include "mailbox.hpp"
+#include "param_registry.hpp"
+#include <atomic>
+#include <cstdint>
+
+namespace params {
+
+/**
+ * @brief 飛行中のパラメータ調整クラス
+ * 
+ * CLI・地上局の変更は ParamRegistry の値（atomic）へ入るが、制御ループが個別に読むと
+ * 1周期の中でkpだけ新しくkdは古い、といった組み合わせが起きる。
+ * 調整タスク（ParamRegistry::process() を呼ぶ低優先度タスク）が update() で変更を検出し、
+ * 関連するパラメータの組を T へ組み立てて影のコピー（common::Mailbox）へ書く。
+ * 制御ループは周期の先頭で apply() を呼び、新しい組があれば自分の作業コピーへ丸ごと写す。
+ * 変更がない周期は版数の比較1回だけで、ロック・フラッシュアクセスはない
+ * （保存は ParamRegistry がディスアーム後に行う）。
+ * 
+ * 使用例:
+ *   void buildPid(const ParamRegistry& r, control::CascadedPid<3>::Config& c) {
+ *       c.sample_hz = static_cast<float>(r.get<ParamId::CONTROL_RATE_HZ>());
+ *       c.axis[0].rate_kp = r.get<ParamId::RATE_ROLL_KP>();
+ *       ...
+ *   }
+ *   LiveParams<control::CascadedPid<3>::Config> live(registry, buildPid);
+ *   （調整タスク）live.update(); registry.process(now_us);
+ *   （制御ループ）if (live.apply(pid_config)) { pid.setGains(pid_config); }
+ * 
+ * update()・apply() はそれぞれ単一のタスクから呼ぶこと
+ * @tparam T パラメータの組（トリビアルコピー可能であること）
+ */
+template<typename T>
+class LiveParams {
+public:
+    /**
+     * @brief 組の組み立て関数型
+     * @param registry パラメータレジストリ
+     * @param set 格納先
+     */
+    using Builder = void (*)(const ParamRegistry& registry, T& set);
+    
+    /**
+     * @brief コンストラクタ
+     * @param registry 変更を監視するレジストリ
+     * @param builder 組の組み立て関数
+     */
+    LiveParams(const ParamRegistry& registry, Builder builder)
+        : registry_(registry)
+        , builder_(builder)
+        , shadow_()
+        , built_count_(0)
+        , built_(false)
+        , applied_version_(0)
+        , applied_count_(0) {}
+    
+    LiveParams(const LiveParams&) = delete;
+    LiveParams& operator=(const LiveParams&) = delete;
+    
+    /**
+     * @brief 変更の検出と影のコピーへの書き込み（調整タスク）
+     * @return bool 新しい組を書いた場合true
+     */
+    bool update() {
+        const uint32_t count = registry_.getChangeCount();
+        if (built_ && count == built_count_) {
+            return false;
+        }
+        // 組み立て中の変更は次回の update() で拾う（変更回数を先に読む）
+        T set{};
+        builder_(registry_, set);
+        shadow_.write(set);
+        built_count_ = count;
+        built_ = true;
+        return true;
+    }
+    
+    /**
+     * @brief 新しい組の取り込み（制御ループ、周期の境界で呼ぶ）
+     * 
+     * 書き込みと競合した場合は active を変えずにfalseを返し、次の周期で取り込む
+     * @param active 制御ループの作業コピー（新しい組がある場合のみ上書き）
+     * @return bool 取り込んだ場合true
+     */
+    bool apply(T& active) {
+        const uint32_t version = shadow_.getVersion();
+        if (version == applied_version_ || (version & 1) != 0) {
+            return false;
+        }
+        T set;
+        uint32_t read_version = 0;
+        if (!shadow_.read(set, read_version, 1)) {
+            return false;
+        }
+        active = set;
+        applied_version_ = read_version;
+        applied_count_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    /**
+     * @brief 制御ループが取り込んだ回数（CLI・ログ用）
+     */
+    uint32_t getAppliedCount() const { return applied_count_.load(std::memory_order_relaxed); }
+    
+private:
+    const ParamRegistry& registry_;             // 監視するレジストリ
+    Builder builder_;                           // 組の組み立て関数
+    common::Mailbox<T> shadow_;                 // 影のコピー
+    uint32_t built_count_;                      // 組み立てたときの変更回数（調整タスク）
+    bool built_;                                // 一度以上組み立てた（調整タスク）
+    uint32_t applied_version_;                  // 取り込んだ版数（制御ループ）
+    std::atomic<uint32_t> applied_count_;       // 取り込んだ回数
+};
+
+} // namespace params
+
+#endif // LIVE_PARAMS_HPP
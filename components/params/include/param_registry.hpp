@@ -0,0 +1,312 @@
+/*
+ * Parameter Registry
+ * 
+ * RAM常駐のパラメータレジストリ
+ * 起動時にparams/backupパーティションから1回で読み込み、制御ループからはIDで直接参照する。
+ * 変更は遅延してA/B交互にNVSへ書き戻す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PARAM_REGISTRY_HPP
+#define PARAM_REGISTRY_HPP
+
+#include "nvs_hal.hpp"
+#include "esp_err.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace params {
+
+/**
+ * @brief パラメータ型列挙型
+ */
+enum class ParamType : uint8_t {
+    FLOAT,
+    INT32
+};
+
+/**
+ * @brief パラメータID列挙型（param_table.defの並び順）
+ */
+enum class ParamId : uint16_t {
+#define PARAM(id, name, type, def, min, max) id,
+#include "param_table.def"
+#undef PARAM
+    COUNT
+};
+
+/**
+ * @brief パラメータ定義構造体
+ */
+struct ParamInfo {
+    const char* name;           // 名前
+    ParamType type;             // 型
+    double default_value;       // 既定値
+    double min_value;           // 最小値
+    double max_value;           // 最大値
+    uint32_t hash;              // 名前と型のハッシュ（保存イメージ内の識別子）
+};
+
+/**
+ * @brief 名前と型のハッシュ（FNV-1a）
+ * @param name 名前
+ * @param type 型
+ * @return uint32_t ハッシュ
+ */
+constexpr uint32_t paramHash(const char* name, ParamType type) {
+    uint32_t hash = 2166136261u;
+    for (const char* p = name; *p != '\0'; p++) {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    return (hash ^ static_cast<uint8_t>(type)) * 16777619u;
+}
+
+/**
+ * @brief パラメータ定義表（フラッシュ配置）
+ */
+inline constexpr ParamInfo PARAM_TABLE[] = {
+#define PARAM(id, name, type, def, min, max) \
+    { name, ParamType::type, def, min, max, paramHash(name, ParamType::type) },
+#include "param_table.def"
+#undef PARAM
+};
+
+static_assert(sizeof(PARAM_TABLE) / sizeof(PARAM_TABLE[0]) == static_cast<size_t>(ParamId::COUNT), 
+              "パラメータ定義表とIDの数が一致しません");
+
+/**
+ * @brief パラメータレジストリクラス
+ * 
+ * 値は32bitのatomicとしてRAMに保持し、get系は配列参照1回でフラッシュに触れない。
+ * 保存イメージは「ヘッダー + (ハッシュ, 値)の列」を1つのBLOBとし、
+ * paramsパーティション（スロットA）とbackupパーティション（スロットB）へ交互に書き込む。
+ * 起動時は両スロットを読み、有効で世代番号の新しい方を採用するため、
+ * 書き込み中に電源断しても直前の世代が残る
+ */
+class ParamRegistry {
+public:
+    static constexpr size_t COUNT = static_cast<size_t>(ParamId::COUNT);   // パラメータ数
+    static constexpr int64_t DEFAULT_SAVE_DELAY_US = 2000000;              // 最後の変更から保存までの待ち時間
+    static constexpr const char* PRIMARY_PARTITION = "params";             // スロットA
+    static constexpr const char* BACKUP_PARTITION = "backup";              // スロットB
+    
+    /**
+     * @brief コンストラクタ（全パラメータを既定値で初期化）
+     */
+    ParamRegistry();
+    
+    /**
+     * @brief 初期化（NVSパーティションを開き保存値を読み込む）
+     * 
+     * 保存値がない・壊れている場合は既定値のまま動作する
+     * @return esp_err_t 初期化結果（パーティションが使えない場合のみエラー）
+     */
+    esp_err_t initialize();
+    
+    /**
+     * @brief float値取得（制御ループ用、フラッシュアクセスなし）
+     * @param id パラメータID（FLOAT型）
+     * @return float 値
+     */
+    float getFloat(ParamId id) const {
+        uint32_t bits = values_[static_cast<size_t>(id)].load(std::memory_order_relaxed);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    /**
+     * @brief int32値取得（制御ループ用、フラッシュアクセスなし）
+     * @param id パラメータID（INT32型）
+     * @return int32_t 値
+     */
+    int32_t getInt(ParamId id) const {
+        return static_cast<int32_t>(values_[static_cast<size_t>(id)].load(std::memory_order_relaxed));
+    }
+    
+    /**
+     * @brief 型付き値取得（型をコンパイル時に決定）
+     * @tparam ID パラメータID
+     * @return float または int32_t
+     */
+    template<ParamId ID>
+    auto get() const {
+        if constexpr (PARAM_TABLE[static_cast<size_t>(ID)].type == ParamType::FLOAT) {
+            return getFloat(ID);
+        } else {
+            return getInt(ID);
+        }
+    }
+    
+    /**
+     * @brief float値設定（範囲外はエラー、保存は遅延実行）
+     * @param id パラメータID
+     * @param value 値
+     * @return esp_err_t 設定結果（型不一致・範囲外はESP_ERR_INVALID_ARG）
+     */
+    esp_err_t setFloat(ParamId id, float value);
+    
+    /**
+     * @brief int32値設定（範囲外はエラー、保存は遅延実行）
+     * @param id パラメータID
+     * @param value 値
+     * @return esp_err_t 設定結果（型不一致・範囲外はESP_ERR_INVALID_ARG）
+     */
+    esp_err_t setInt(ParamId id, int32_t value);
+    
+    /**
+     * @brief 名前からID検索（CLI・GCS用）
+     * @param name 名前
+     * @param id ID格納先
+     * @return esp_err_t 検索結果（見つからない場合ESP_ERR_NOT_FOUND）
+     */
+    static esp_err_t findByName(std::string_view name, ParamId& id);
+    
+    /**
+     * @brief パラメータ定義取得
+     * @param id パラメータID
+     * @return const ParamInfo& 定義
+     */
+    static const ParamInfo& getInfo(ParamId id) { return PARAM_TABLE[static_cast<size_t>(id)]; }
+    
+    /**
+     * @brief 全パラメータを既定値へ戻す（保存は遅延実行）
+     */
+    void resetToDefaults();
+    
+    /**
+     * @brief 遅延保存の処理（低優先度タスクから周期的に呼び出す）
+     * 
+     * 未保存の変更があり、最後の変更から保存待ち時間が経過していれば保存する。
+     * フラッシュ書き込み中はキャッシュが無効になり両コアのフラッシュ実行が止まるため、
+     * common::FlashGuard の抑止中（アーム中）は自動サスペンドの有無に関わらず保存を後回しにし、
+     * 飛行中の変更はディスアーム後の最初の呼び出しで保存する
+     * @param now_us 現在時刻（μs）
+     * @return esp_err_t 処理結果
+     */
+    esp_err_t process(int64_t now_us);
+    
+    /**
+     * @brief 未保存の変更を即時保存
+     * @return esp_err_t 保存結果（アーム中で断った場合ESP_ERR_NOT_ALLOWED）
+     */
+    esp_err_t flush();
+    
+    /**
+     * @brief 変更回数取得（LiveParamsが新しい値の有無を判定する）
+     * @return uint32_t 変更回数
+     */
+    uint32_t getChangeCount() const { return change_count_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 未保存の変更有無
+     * @return bool 未保存の変更がある場合true
+     */
+    bool isDirty() const {
+        return change_count_.load(std::memory_order_acquire) != saved_count_.load(std::memory_order_acquire);
+    }
+    
+    /**
+     * @brief 保存待ち時間設定
+     * @param delay_us 待ち時間（μs）
+     */
+    void setSaveDelay(int64_t delay_us) { save_delay_us_ = delay_us; }
+    
+    /**
+     * @brief 保存世代番号取得
+     * @return uint32_t 現在の世代番号（未保存は0）
+     */
+    uint32_t getSequence() const { return sequence_; }
+    
+    /**
+     * @brief 全パラメータのログ出力
+     */
+    void dump() const;
+    
+private:
+    static constexpr uint32_t IMAGE_MAGIC = 0x50524D53;     // "SMRP"
+    static constexpr uint16_t IMAGE_VERSION = 1;            // イメージ形式バージョン
+    static constexpr const char* IMAGE_NAMESPACE = "params";    // NVS名前空間
+    static constexpr const char* IMAGE_KEY = "image";           // NVSキー
+    
+    /**
+     * @brief 保存イメージのヘッダー
+     */
+    struct ImageHeader {
+        uint32_t magic;             // 識別子
+        uint16_t version;           // 形式バージョン
+        uint16_t count;             // エントリ数
+        uint32_t sequence;          // 世代番号
+    };
+    
+    /**
+     * @brief 保存イメージのエントリ
+     */
+    struct ImageEntry {
+        uint32_t hash;              // 名前と型のハッシュ
+        uint32_t bits;              // 値（ビット表現）
+    };
+    
+    /**
+     * @brief 読み込んだスロットの内容
+     */
+    struct SlotImage {
+        bool valid;                 // 有効
+        uint32_t sequence;          // 世代番号
+        std::vector<uint8_t> blob;  // イメージ
+    };
+    
+    hal::NvsHal slots_[2];                          // A: params、B: backup
+    bool slot_ready_[2];                            // スロット使用可能
+    std::atomic<uint32_t> values_[COUNT];           // 現在値（ビット表現）
+    std::atomic<uint32_t> change_count_;            // 変更回数
+    std::atomic<uint32_t> saved_count_;             // 保存済みの変更回数
+    std::atomic<uint32_t> last_change_ms_;          // 最後の変更時刻（ms、32bitで巻き戻りを差分で吸収）
+    int64_t save_delay_us_;                         // 保存待ち時間
+    uint32_t sequence_;                             // 現在の世代番号
+    int active_slot_;                               // 最新世代のスロット（-1は未保存）
+    std::mutex save_mutex_;                         // 保存処理の排他制御
+    
+    /**
+     * @brief 値の検証と格納
+     */
+    esp_err_t store(ParamId id, ParamType type, double value, uint32_t bits);
+    
+    /**
+     * @brief スロット読み込み
+     */
+    void readSlot(int slot, SlotImage& image);
+    
+    /**
+     * @brief イメージを適用
+     * @return size_t 適用した値の数
+     */
+    size_t applyImage(const std::vector<uint8_t>& blob);
+    
+    /**
+     * @brief 保存処理（save_mutex_保持中に呼び出す）
+     */
+    esp_err_t save();
+    
+    /**
+     * @brief 既定値のビット表現
+     */
+    static uint32_t defaultBits(const ParamInfo& info);
+    
+    /**
+     * @brief 変更の記録
+     */
+    void markChanged();
+};
+
+} // namespace params
+
+#endif // PARAM_REGISTRY_HPP
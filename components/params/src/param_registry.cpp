@@ -0,0 +1,309 @@
+/*
+ * Parameter Registry Implementation
+ * 
+ * RAM常駐のパラメータレジストリ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "param_registry.hpp"
+#include "flash_guard.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cmath>
+
+namespace params {
+
+static const char* TAG = "params::ParamRegistry";
+
+namespace {
+
+uint32_t nowMs() {
+    return static_cast<uint32_t>(esp_timer_get_time() / 1000);
+}
+
+} // namespace
+
+ParamRegistry::ParamRegistry()
+    : slots_{hal::NvsHal(PRIMARY_PARTITION), hal::NvsHal(BACKUP_PARTITION)}
+    , slot_ready_{false, false}
+    , change_count_(0)
+    , saved_count_(0)
+    , last_change_ms_(0)
+    , save_delay_us_(DEFAULT_SAVE_DELAY_US)
+    , sequence_(0)
+    , active_slot_(-1) {
+    for (size_t i = 0; i < COUNT; i++) {
+        values_[i].store(defaultBits(PARAM_TABLE[i]), std::memory_order_relaxed);
+    }
+}
+
+esp_err_t ParamRegistry::initialize() {
+    for (int slot = 0; slot < 2; slot++) {
+        esp_err_t ret = slots_[slot].initialize();
+        if (ret == ESP_OK) {
+            ret = slots_[slot].start();
+        }
+        slot_ready_[slot] = (ret == ESP_OK);
+        if (!slot_ready_[slot]) {
+            ESP_LOGW(TAG, "パーティション%sが使用できません: %s",  
+                     slot == 0 ? PRIMARY_PARTITION : BACKUP_PARTITION, esp_err_to_name(ret));
+        }
+    }
+    if (!slot_ready_[0] && !slot_ready_[1]) {
+        ESP_LOGE(TAG, "パラメータ用パーティションがありません（既定値で動作）");
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // 両スロットを読み、有効で新しい世代を採用（世代番号の巻き戻りは差分の符号で判定）
+    SlotImage images[2];
+    readSlot(0, images[0]);
+    readSlot(1, images[1]);
+    
+    int selected = -1;
+    if (images[0].valid && images[1].valid) {
+        selected = static_cast<int32_t>(images[1].sequence - images[0].sequence) > 0 ? 1 : 0;
+    } else if (images[0].valid) {
+        selected = 0;
+    } else if (images[1].valid) {
+        selected = 1;
+    }
+    
+    if (selected < 0) {
+        ESP_LOGI(TAG, "保存値なし（既定値%u件）", static_cast<unsigned>(COUNT));
+        return ESP_OK;
+    }
+    
+    size_t applied = applyImage(images[selected].blob);
+    sequence_ = images[selected].sequence;
+    active_slot_ = selected;
+    ESP_LOGI(TAG, "パラメータ読み込み完了 スロット:%s 世代:%lu 適用:%u/%u",  
+             selected == 0 ? "A" : "B", static_cast<unsigned long>(sequence_),  
+             static_cast<unsigned>(applied), static_cast<unsigned>(COUNT));
+    return ESP_OK;
+}
+
+esp_err_t ParamRegistry::setFloat(ParamId id, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return store(id, ParamType::FLOAT, value, bits);
+}
+
+esp_err_t ParamRegistry::setInt(ParamId id, int32_t value) {
+    return store(id, ParamType::INT32, value, static_cast<uint32_t>(value));
+}
+
+esp_err_t ParamRegistry::findByName(std::string_view name, ParamId& id) {
+    for (size_t i = 0; i < COUNT; i++) {
+        if (name == PARAM_TABLE[i].name) {
+            id = static_cast<ParamId>(i);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NOT_FOUND;
+}
+
+void ParamRegistry::resetToDefaults() {
+    for (size_t i = 0; i < COUNT; i++) {
+        values_[i].store(defaultBits(PARAM_TABLE[i]), std::memory_order_relaxed);
+    }
+    markChanged();
+    ESP_LOGI(TAG, "全パラメータを既定値へ戻しました");
+}
+
+esp_err_t ParamRegistry::process(int64_t now_us) {
+    if (!isDirty()) {
+        return ESP_OK;
+    }
+    
+    uint32_t elapsed_ms = static_cast<uint32_t>(now_us / 1000) - last_change_ms_.load(std::memory_order_relaxed);
+    if (static_cast<int64_t>(elapsed_ms) * 1000 < save_delay_us_) {
+        return ESP_OK;
+    }
+    
+    std::lock_guard<std::mutex> lock(save_mutex_);
+    esp_err_t ret = save();
+    // アーム中（FlashGuard）は保存を後回しにする（未保存のまま次の呼び出しで再試行）
+    return ret == ESP_ERR_NOT_ALLOWED ? ESP_OK : ret;
+}
+
+esp_err_t ParamRegistry::flush() {
+    std::lock_guard<std::mutex> lock(save_mutex_);
+    if (!isDirty()) {
+        return ESP_OK;
+    }
+    return save();
+}
+
+void ParamRegistry::dump() const {
+    for (size_t i = 0; i < COUNT; i++) {
+        const ParamInfo& info = PARAM_TABLE[i];
+        ParamId id = static_cast<ParamId>(i);
+        if (info.type == ParamType::FLOAT) {
+            ESP_LOGI(TAG, "%-16s %.4f", info.name, getFloat(id));
+        } else {
+            ESP_LOGI(TAG, "%-16s %ld", info.name, static_cast<long>(getInt(id)));
+        }
+    }
+    ESP_LOGI(TAG, "世代:%lu 未保存:%s", static_cast<unsigned long>(sequence_), isDirty() ? "あり" : "なし");
+}
+
+esp_err_t ParamRegistry::store(ParamId id, ParamType type, double value, uint32_t bits) {
+    size_t index = static_cast<size_t>(id);
+    if (index >= COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    const ParamInfo& info = PARAM_TABLE[index];
+    if (info.type != type) {
+        ESP_LOGE(TAG, "型が一致しません: %s", info.name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (std::isnan(value) || value < info.min_value || value > info.max_value) {
+        ESP_LOGE(TAG, "範囲外です: %s（%g〜%g）", info.name, info.min_value, info.max_value);
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (values_[index].exchange(bits, std::memory_order_relaxed) != bits) {
+        markChanged();
+    }
+    return ESP_OK;
+}
+
+void ParamRegistry::readSlot(int slot, SlotImage& image) {
+    image.valid = false;
+    image.sequence = 0;
+    if (!slot_ready_[slot]) {
+        return;
+    }
+    
+    esp_err_t ret = slots_[slot].readBlob(IMAGE_NAMESPACE, IMAGE_KEY, image.blob);
+    if (ret != ESP_OK) {
+        return;
+    }
+    
+    ImageHeader header;
+    if (image.blob.size() < sizeof(header)) {
+        ESP_LOGW(TAG, "スロット%sのイメージが短すぎます", slot == 0 ? "A" : "B");
+        return;
+    }
+    memcpy(&header, image.blob.data(), sizeof(header));
+    if (header.magic != IMAGE_MAGIC || header.version != IMAGE_VERSION ||
+        image.blob.size() != sizeof(header) + header.count * sizeof(ImageEntry)) {
+        ESP_LOGW(TAG, "スロット%sのイメージが不正です", slot == 0 ? "A" : "B");
+        return;
+    }
+    
+    image.valid = true;
+    image.sequence = header.sequence;
+}
+
+size_t ParamRegistry::applyImage(const std::vector<uint8_t>& blob) {
+    ImageHeader header;
+    memcpy(&header, blob.data(), sizeof(header));
+    const uint8_t* entries = blob.data() + sizeof(header);
+    
+    // ハッシュで照合するため、定義表の並び替え・追加・削除があっても既存の値を引き継げる
+    size_t applied = 0;
+    for (size_t n = 0; n < header.count; n++) {
+        ImageEntry entry;
+        memcpy(&entry, entries + n * sizeof(entry), sizeof(entry));
+        
+        for (size_t i = 0; i < COUNT; i++) {
+            const ParamInfo& info = PARAM_TABLE[i];
+            if (info.hash != entry.hash) {
+                continue;
+            }
+            
+            double value;
+            if (info.type == ParamType::FLOAT) {
+                float f;
+                memcpy(&f, &entry.bits, sizeof(f));
+                value = f;
+            } else {
+                value = static_cast<int32_t>(entry.bits);
+            }
+            if (std::isnan(value) || value < info.min_value || value > info.max_value) {
+                ESP_LOGW(TAG, "保存値が範囲外のため既定値を使用: %s", info.name);
+            } else {
+                values_[i].store(entry.bits, std::memory_order_relaxed);
+                applied++;
+            }
+            break;
+        }
+    }
+    return applied;
+}
+
+esp_err_t ParamRegistry::save() {
+    // 前回と反対側のスロットへ書き込む（最新世代を上書きしない）
+    int target = active_slot_ == 0 ? 1 : 0;
+    if (!slot_ready_[target]) {
+        target = 1 - target;
+    }
+    if (!slot_ready_[target]) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // 自動サスペンドが有効でもアーム中は書かない（飛行中の変更は値だけ反映し、保存はディスアーム後）
+    if (common::FlashGuard::instance().isRealtime()) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    common::FlashGuard::Scope guard(common::FlashGuard::instance());
+    if (!guard.allowed()) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    
+    // 書き込み中の変更は次回の保存対象とするため、スナップショット前の変更回数を記録
+    uint32_t changes = change_count_.load(std::memory_order_acquire);
+    
+    ImageHeader header;
+    header.magic = IMAGE_MAGIC;
+    header.version = IMAGE_VERSION;
+    header.count = static_cast<uint16_t>(COUNT);
+    header.sequence = sequence_ + 1;
+    
+    std::vector<uint8_t> blob(sizeof(header) + COUNT * sizeof(ImageEntry));
+    memcpy(blob.data(), &header, sizeof(header));
+    for (size_t i = 0; i < COUNT; i++) {
+        ImageEntry entry;
+        entry.hash = PARAM_TABLE[i].hash;
+        entry.bits = values_[i].load(std::memory_order_relaxed);
+        memcpy(blob.data() + sizeof(header) + i * sizeof(entry), &entry, sizeof(entry));
+    }
+    
+    esp_err_t ret = slots_[target].writeBlob(IMAGE_NAMESPACE, IMAGE_KEY, blob);
+    if (ret == ESP_OK) {
+        ret = slots_[target].commit(IMAGE_NAMESPACE);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "パラメータ保存失敗 スロット:%s: %s", target == 0 ? "A" : "B", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    sequence_ = header.sequence;
+    active_slot_ = target;
+    saved_count_.store(changes, std::memory_order_release);
+    ESP_LOGI(TAG, "パラメータ保存 スロット:%s 世代:%lu", target == 0 ? "A" : "B",  
+             static_cast<unsigned long>(sequence_));
+    return ESP_OK;
+}
+
+uint32_t ParamRegistry::defaultBits(const ParamInfo& info) {
+    if (info.type == ParamType::FLOAT) {
+        float value = static_cast<float>(info.default_value);
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+    return static_cast<uint32_t>(static_cast<int32_t>(info.default_value));
+}
+
+void ParamRegistry::markChanged() {
+    last_change_ms_.store(nowMs(), std::memory_order_relaxed);
+    change_count_.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace params
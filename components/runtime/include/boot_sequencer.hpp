@@ -0,0 +1,255 @@
+/*
+ * Boot Sequencer
+ * 
+ * 依存関係を宣言した初期化ステージを両コアで並列実行する起動シーケンサ
+ * 飛行に必須なステージを先に完了させ、非必須のステージ（音・LED・ストレージ等）は
+ * 準備完了後にバックグラウンドで初期化する。ステージ毎の起動時間を記録する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BOOT_SEQUENCER_HPP
+#define BOOT_SEQUENCER_HPP
+
+#include "delegate.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+namespace runtime {
+
+/**
+ * @brief 起動シーケンサクラス
+ * 
+ * addStage()でステージを登録し、runCritical()で飛行必須ステージを実行して待ち、
+ * startDeferred()で残りをバックグラウンド実行する。
+ * 各フェーズでは両コアに1つずつワーカータスクを置き、依存先がすべて完了した
+ * ステージから順に取り出して実行する。依存先は登録済みのステージに限るため循環しない。
+ * 同じバスを使うステージは共有リソースのビットを同じにすると同時に実行されない。
+ * 依存先が失敗したステージは実行せずスキップする
+ */
+class BootSequencer {
+public:
+    static constexpr size_t MAX_STAGES = 32;                // 登録できるステージ数
+    static constexpr int ANY_CORE = -1;                     // コア指定なし
+    static constexpr uint32_t DEFAULT_STACK_SIZE = 4096;    // ワーカータスクのスタックサイズ
+    
+    /**
+     * @brief ステージ初期化関数型
+     */
+    using StageFunction = common::Delegate<esp_err_t(void)>;
+    
+    /**
+     * @brief 実行フェーズ列挙型
+     */
+    enum class Phase : uint8_t {
+        CRITICAL,       // 飛行必須（runCritical()で実行）
+        DEFERRED        // 準備完了後（startDeferred()で実行）
+    };
+    
+    /**
+     * @brief ステージ状態列挙型
+     */
+    enum class StageState : uint8_t {
+        PENDING,        // 未実行
+        RUNNING,        // 実行中
+        DONE,           // 完了
+        FAILED,         // 失敗
+        SKIPPED         // 依存先の失敗によりスキップ
+    };
+    
+    /**
+     * @brief ステージオプション構造体
+     */
+    struct StageOptions {
+        Phase phase = Phase::CRITICAL;  // 実行フェーズ
+        int core = ANY_CORE;            // 実行コア（ANY_COREはどちらでも）
+        uint32_t resources = 0;         // 共有リソースのビット（重なるステージは同時実行しない）
+        bool required = true;           // 失敗時にフェーズ全体を失敗とする
+    };
+    
+    /**
+     * @brief ステージ実行記録構造体
+     */
+    struct StageReport {
+        const char* name;           // ステージ名
+        Phase phase;                // 実行フェーズ
+        StageState state;           // 状態
+        esp_err_t result;           // 初期化関数の戻り値
+        int core;                   // 実行したコア
+        int64_t start_us;           // 開始時刻（起動からのμs）
+        int64_t end_us;             // 終了時刻（起動からのμs）
+    };
+    
+    /**
+     * @brief シーケンサ設定構造体
+     */
+    struct Config {
+        uint32_t stack_size;            // ワーカータスクのスタックサイズ
+        UBaseType_t critical_priority;  // 飛行必須フェーズのワーカー優先度
+        UBaseType_t deferred_priority;  // 準備完了後フェーズのワーカー優先度
+    };
+    
+    /**
+     * @brief ステージ番号から依存ビットを作成
+     * @param index ステージ番号
+     * @return uint32_t 依存ビット
+     */
+    static constexpr uint32_t dependsOn(size_t index) { return 1u << index; }
+    
+public:
+    /**
+     * @brief コンストラクタ
+     */
+    BootSequencer();
+    
+    /**
+     * @brief デストラクタ
+     * 
+     * ワーカーがthisを参照するため、全フェーズ完了前に破棄しないこと
+     */
+    ~BootSequencer() = default;
+    
+    /**
+     * @brief 設定
+     * @param config シーケンサ設定
+     */
+    void setConfig(const Config& config) { config_ = config; }
+    
+    /**
+     * @brief ステージ登録（runCritical()前に行う）
+     * @param name ステージ名（文字列リテラル等、寿命が続くもの）
+     * @param function 初期化関数
+     * @param depends 依存先ステージのビット（dependsOn()の論理和）
+     * @param options ステージオプション
+     * @param index 登録したステージ番号の格納先（nullptr可）
+     * @return esp_err_t 登録結果（未登録・準備完了後フェーズへの依存はESP_ERR_INVALID_ARG）
+     */
+    esp_err_t addStage(const char* name, StageFunction function, uint32_t depends, 
+                       const StageOptions& options, size_t* index = nullptr);
+    
+    /**
+     * @brief ステージ登録（既定オプション）
+     */
+    esp_err_t addStage(const char* name, StageFunction function, uint32_t depends = 0, size_t* index = nullptr) {
+        return addStage(name, function, depends, StageOptions(), index);
+    }
+    
+    /**
+     * @brief 飛行必須フェーズの実行（完了まで待つ）
+     * @param timeout 待ち時間
+     * @return esp_err_t 実行結果（必須ステージの失敗時ESP_FAIL、タイムアウト時ESP_ERR_TIMEOUT）
+     */
+    esp_err_t runCritical(TickType_t timeout = portMAX_DELAY);
+    
+    /**
+     * @brief 準備完了後フェーズの開始（待たずに戻る）
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t startDeferred();
+    
+    /**
+     * @brief 準備完了後フェーズの完了判定
+     * @return bool 完了した場合true
+     */
+    bool isDeferredDone() const { return deferred_done_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 準備完了時刻取得
+     * @return int64_t 飛行必須フェーズが完了した時刻（起動からのμs、未完了は0）
+     */
+    int64_t getReadyTimeUs() const { return ready_time_us_; }
+    
+    /**
+     * @brief ステージ数取得
+     * @return size_t ステージ数
+     */
+    size_t getStageCount() const { return stage_count_; }
+    
+    /**
+     * @brief ステージ実行記録取得
+     * @param index ステージ番号
+     * @param report 記録格納先
+     * @return esp_err_t 取得結果
+     */
+    esp_err_t getReport(size_t index, StageReport& report) const;
+    
+    /**
+     * @brief 起動時間のログ出力
+     */
+    void dumpReport() const;
+    
+private:
+    /**
+     * @brief ステージ
+     */
+    struct Stage {
+        const char* name;           // ステージ名
+        StageFunction function;     // 初期化関数
+        uint32_t depends;           // 依存先ビット
+        StageOptions options;       // オプション
+        StageState state;           // 状態
+        esp_err_t result;           // 戻り値
+        int core;                   // 実行コア
+        int64_t start_us;           // 開始時刻
+        int64_t end_us;             // 終了時刻
+    };
+    
+    /**
+     * @brief ワーカータスク引数
+     */
+    struct WorkerArgs {
+        BootSequencer* self;        // シーケンサ
+        Phase phase;                // 実行フェーズ
+        int core;                   // 担当コア
+    };
+    
+    Config config_;                             // 設定
+    Stage stages_[MAX_STAGES];                  // ステージ
+    size_t stage_count_;                        // 登録ステージ数
+    uint32_t done_mask_;                        // 完了ステージのビット
+    uint32_t failed_mask_;                      // 失敗・スキップしたステージのビット
+    uint32_t busy_resources_;                   // 実行中ステージの共有リソース
+    bool required_failed_[2];                   // フェーズ毎の必須ステージ失敗
+    mutable std::mutex mutex_;                  // ステージ状態の排他制御
+    WorkerArgs worker_args_[2][2];              // フェーズ×コアのワーカー引数
+    TaskHandle_t workers_[2][2];                // フェーズ×コアのワーカー（終了時にnullptr）
+    TaskHandle_t waiter_;                       // 飛行必須フェーズの完了待ちタスク
+    std::atomic<uint32_t> deferred_exited_;     // 終了した準備完了後ワーカー数
+    std::atomic<bool> deferred_done_;           // 準備完了後フェーズ完了
+    int64_t ready_time_us_;                     // 準備完了時刻
+    
+    /**
+     * @brief フェーズのワーカー起動
+     */
+    esp_err_t startWorkers(Phase phase, UBaseType_t priority);
+    
+    /**
+     * @brief ワーカータスク本体
+     */
+    static void workerTask(void* arg);
+    
+    /**
+     * @brief 実行可能なステージを取り出す（mutex_保持中に呼び出す）
+     * @param phase 実行フェーズ
+     * @param core 担当コア
+     * @param finished フェーズ内に未完了のステージがない場合true
+     * @return int ステージ番号（なければ-1）
+     */
+    int takeReadyStage(Phase phase, int core, bool& finished);
+    
+    /**
+     * @brief 他方のワーカーを起こす（終了済みのワーカーには通知しない）
+     */
+    void wakeWorkers(Phase phase, int core);
+};
+
+} // namespace runtime
+
+#endif // BOOT_SEQUENCER_HPP
@@ -0,0 +1,178 @@
+/*
+ * CPU Profiler
+ * 
+ * タスク別・コア別のCPU使用率プロファイラ
+ * FreeRTOSの実行時間統計（esp_timerカウンタ）の差分から、直近の計測窓と
+ * 複数窓の移動区間での使用率を求める。割り込み時間はIsrTimeの積算から別に求める
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef CPU_PROFILER_HPP
+#define CPU_PROFILER_HPP
+
+#include "mailbox.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief CPU使用率プロファイラクラス
+ * 
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS（カウンタはesp_timer）と
+ * CONFIG_FREERTOS_USE_TRACE_FACILITY が必要。window_ms 毎に全タスクの実行時間を読み、
+ * 前回との差分を窓の長さで割って1コアに対する使用率（‰）とする。
+ * コアの負荷は 1000‰ - そのコアのIDLEタスクの使用率。割り込み時間は割り込まれた
+ * タスクにも含まれるため、タスクの合計とコア負荷の差ではなくIsrTime（計測したハンドラのみ）で示す。
+ * 移動区間の値は直近 history_windows 窓の合計から求める
+ */
+class CpuProfiler {
+public:
+    static constexpr size_t MAX_TASKS = 24;         // 計測するタスク数の上限
+    static constexpr size_t MAX_WINDOWS = 10;       // 移動区間の窓数の上限
+    static constexpr size_t CORE_COUNT = 2;         // コア数
+    static constexpr size_t NAME_SIZE = configMAX_TASK_NAME_LEN;    // タスク名
+    static constexpr int8_t ANY_CORE = -1;          // コア固定なし
+    
+    /**
+     * @brief プロファイラ設定構造体
+     */
+    struct Config {
+        uint32_t window_ms = 1000;                  // 計測窓（ms、17秒未満）
+        size_t history_windows = 5;                 // 移動区間の窓数（MAX_WINDOWS以下）
+        uint32_t cpu_mhz = 240;                     // CPU周波数（MHz、割り込みサイクルの換算用）
+        UBaseType_t priority = 1;                   // 計測タスクの優先度
+        uint32_t stack_size = 3072;                 // 計測タスクのスタックサイズ
+        int core = tskNO_AFFINITY;                  // 計測タスクのコア
+    };
+    
+    /**
+     * @brief コア計測結果（‰）
+     */
+    struct CoreReport {
+        uint16_t load;                  // 直近の窓の負荷
+        uint16_t load_average;          // 移動区間の負荷
+        uint16_t isr;                   // 直近の窓の割り込み時間
+        uint16_t isr_average;           // 移動区間の割り込み時間
+        uint32_t isr_count;             // 直近の窓の割り込み回数
+    };
+    
+    /**
+     * @brief タスク計測結果（1コアに対する‰）
+     */
+    struct TaskReport {
+        char name[NAME_SIZE];           // タスク名
+        int8_t core;                    // 固定したコア（ANY_COREは固定なし）
+        uint8_t priority;               // 現在の優先度
+        uint16_t load;                  // 直近の窓の使用率
+        uint16_t load_average;          // 移動区間の使用率
+    };
+    
+    /**
+     * @brief 集計結果構造体
+     */
+    struct Report {
+        uint32_t time_us;                           // 計測時刻（μs、下位32bit）
+        uint32_t window_us;                         // 直近の窓の長さ（μs）
+        uint32_t windows;                           // 移動区間の窓数（起動直後は少ない）
+        CoreReport core[CORE_COUNT];                // コア
+        uint32_t task_count;                        // タスク数
+        TaskReport task[MAX_TASKS];                 // タスク（直近の使用率の大きい順）
+    };
+    
+public:
+    CpuProfiler();
+    ~CpuProfiler();
+    
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+    
+    /**
+     * @brief 計測タスク開始
+     * @param config プロファイラ設定
+     * @return esp_err_t 実行時間統計が無効なビルドではESP_ERR_NOT_SUPPORTED
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 計測タスク開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 計測タスク停止
+     * @return esp_err_t 停止を確認できない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 1窓分の計測と公開（計測タスクを使わない場合に窓の間隔で直接呼ぶ）
+     */
+    void sample();
+    
+    /**
+     * @brief 最新の集計取得（他タスクから呼び出し可）
+     * @param report 集計格納先
+     * @return bool 集計がある場合true
+     */
+    bool getReport(Report& report) const { return report_.read(report); }
+    
+    /**
+     * @brief 集計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief タスクの記録（窓を跨いで同じ位置に置く）
+     */
+    struct Slot {
+        TaskHandle_t task;                          // タスクハンドル（nullptrは空き）
+        uint32_t last_counter;                      // 前回の実行時間カウンタ
+        uint32_t history[MAX_WINDOWS];              // 窓毎の実行時間
+        bool seen;                                  // 今回の列挙にあった
+    };
+    
+    Config config_;                                 // 設定
+    Slot slots_[MAX_TASKS];                         // タスクの記録（計測側のみ）
+    uint32_t window_history_[MAX_WINDOWS];          // 窓毎の長さ（計測側のみ）
+    uint32_t isr_history_[CORE_COUNT][MAX_WINDOWS]; // 窓毎のコア別割り込みサイクル（計測側のみ）
+    uint32_t last_isr_cycles_[CORE_COUNT];          // 前回の割り込み積算サイクル
+    uint32_t last_isr_count_[CORE_COUNT];           // 前回の割り込み積算回数
+    uint32_t last_total_;                           // 前回の全体カウンタ
+    size_t window_index_;                           // 次に書く窓
+    size_t windows_;                                // 記録した窓数
+    bool primed_;                                   // 前回値あり
+    TaskStatus_t status_[MAX_TASKS];                // タスク列挙の作業領域（計測側のみ）
+    Report scratch_;                                // 計測中の集計（計測側のみ）
+    common::Mailbox<Report> report_;                // 公開した集計
+    TaskHandle_t task_;                             // 計測タスク
+    std::atomic<bool> running_;                     // 計測タスク実行中
+    
+    /**
+     * @brief タスクの記録位置（新しいタスクは空きへ）
+     */
+    Slot* findSlot(TaskHandle_t task);
+    
+    /**
+     * @brief 移動区間の合計
+     */
+    uint64_t historySum(const uint32_t* history) const;
+    
+    /**
+     * @brief 計測タスク本体
+     */
+    static void taskEntry(void* arg);
+};
+
+} // namespace runtime
+
+#endif // CPU_PROFILER_HPP
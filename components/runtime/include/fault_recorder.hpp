@@ -0,0 +1,235 @@
+/*
+ * Fault Recorder
+ * 
+ * RTC_NOINITメモリ上の障害記録リング
+ * 制御ループのスナップショットとイベントを毎周期通常のstoreで書き、
+ * パニック・ブラウンアウト・ウォッチドッグによる再起動後に直前の飛行を取り出す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef FAULT_RECORDER_HPP
+#define FAULT_RECORDER_HPP
+
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 障害記録クラス
+ * 
+ * 記録領域はRTC_NOINIT（RTC低速メモリ、再起動で初期化されない）に1つだけ置くため instance() で使う。
+ * 書き込みはフラッシュに触れず、record() は32バイトのコピーと添字の更新だけで、
+ * 添字はコピーの後に進めるため書きかけのスナップショットは読み出し対象にならない。
+ * 
+ * 使い方:
+ * 1. 起動直後に recover() を呼ぶ。記録が有効なら前回のセッションを保持し、リセット要因を添えて残す
+ * 2. CLIの dump()・forEachSnapshot()・forEachEvent() で取り出す（ブラックボックス・地上局へ送る等）
+ * 3. アーム時に begin() で新しいセッションを始める（前回の記録はここで消える）
+ * 4. 制御タスクが毎周期 record()、状態変化で event() を呼ぶ
+ * 
+ * 電源投入時のRTCメモリは不定のため、リセット要因と識別子・配置・検査値で有効かを判定する
+ */
+class FaultRecorder {
+public:
+    static constexpr size_t SNAPSHOT_COUNT = 128;   // スナップショット数（2のべき乗）
+    static constexpr size_t EVENT_COUNT = 32;       // イベント数（2のべき乗）
+    
+    /**
+     * @brief イベント種別列挙型
+     */
+    enum class Event : uint16_t {
+        SESSION_START = 0,      // セッション開始（value: 0）
+        ARM,                    // アーム
+        DISARM,                 // ディスアーム
+        MODE_CHANGE,            // 飛行モード変更（value: 新しいモード）
+        FAILSAFE,               // フェイルセーフ（value: 要因）
+        EMERGENCY_STOP,         // 緊急停止（value: 要因）
+        WATCHDOG,               // ウォッチドッグ違反（value: スロット番号）
+        LOOP_OVERRUN,           // 制御周期の予算超過（value: 連続回数）
+        BATTERY_LOW,            // 低電圧（value: mV）
+        SENSOR_FAULT,           // センサー異常（value: センサー番号）
+        USER                    // 利用側の任意のイベント
+    };
+    
+    /**
+     * @brief 制御ループのスナップショット（32バイト、固定小数点）
+     */
+    struct Snapshot {
+        uint32_t time_ms;           // 時刻（ms、起動から）
+        int16_t attitude[3];        // ロール・ピッチ・ヨー（rad × 10000）
+        int16_t rates[3];           // 角速度（rad/s × 1000）
+        uint16_t motors[4];         // モーター出力（0〜65535）
+        uint16_t throttle;          // 推力指令（0〜65535）
+        int16_t altitude_cm;        // 高度（cm）
+        uint16_t battery_mv;        // バッテリー電圧（mV）
+        uint8_t mode;               // 飛行モード（common::FlightMode）
+        uint8_t flags;              // 利用側のフラグ（アーム・フェイルセーフ等）
+    };
+    
+    /**
+     * @brief イベントの記録
+     */
+    struct EventRecord {
+        uint32_t time_ms;           // 時刻（ms、起動から）
+        Event code;                 // 種別
+        uint16_t value;             // 付加値
+    };
+    
+    /**
+     * @brief 前回のセッションの情報
+     */
+    struct Recovery {
+        bool valid;                         // 前回の記録がある
+        bool crashed;                       // 異常なリセット（パニック・ウォッチドッグ・ブラウンアウト）
+        esp_reset_reason_t reset_reason;    // 今回の起動のリセット要因
+        uint32_t session;                   // 前回のセッション番号
+        uint32_t snapshots;                 // 保持しているスナップショット数
+        uint32_t events;                    // 保持しているイベント数
+        uint32_t last_time_ms;              // 最後のスナップショットの時刻（ms）
+    };
+    
+    /**
+     * @brief 取り出し関数型（古い順）
+     */
+    using SnapshotVisitor = void (*)(const Snapshot& snapshot, void* context);
+    using EventVisitor = void (*)(const EventRecord& event, void* context);
+    
+public:
+    /**
+     * @brief 唯一のインスタンス取得
+     */
+    static FaultRecorder& instance();
+    
+    FaultRecorder(const FaultRecorder&) = delete;
+    FaultRecorder& operator=(const FaultRecorder&) = delete;
+    
+    /**
+     * @brief 起動時の復元（起動直後に1回呼ぶ）
+     * @return esp_err_t 前回の記録がない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t recover();
+    
+    /**
+     * @brief 新しいセッションの開始（アーム時、前回の記録を消す）
+     */
+    void begin();
+    
+    /**
+     * @brief セッション中か
+     */
+    bool isRecording() const { return recording_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief スナップショットの記録（制御タスク、IRAM配置）
+     * @param snapshot スナップショット
+     */
+    void IRAM_ATTR record(const Snapshot& snapshot) {
+        if (!recording_.load(std::memory_order_acquire)) {
+            return;
+        }
+        const uint32_t head = rtc_region_.snapshot_head;
+        rtc_region_.snapshots[head & (SNAPSHOT_COUNT - 1)] = snapshot;
+        // パニックは同じコアで起きるため、コンパイラの並べ替えだけを止めればコピーの後に添字が残る
+        std::atomic_signal_fence(std::memory_order_release);
+        rtc_region_.snapshot_head = head + 1;
+    }
+    
+    /**
+     * @brief イベントの記録（制御タスク、IRAM配置）
+     * @param code 種別
+     * @param value 付加値
+     * @param time_ms 時刻（ms）
+     */
+    void IRAM_ATTR event(Event code, uint16_t value, uint32_t time_ms) {
+        if (!recording_.load(std::memory_order_acquire)) {
+            return;
+        }
+        const uint32_t head = rtc_region_.event_head;
+        EventRecord& record = rtc_region_.events[head & (EVENT_COUNT - 1)];
+        record.time_ms = time_ms;
+        record.code = code;
+        record.value = value;
+        std::atomic_signal_fence(std::memory_order_release);
+        rtc_region_.event_head = head + 1;
+    }
+    
+    /**
+     * @brief 前回のセッションの情報（recover()の結果）
+     */
+    const Recovery& getRecovery() const { return recovery_; }
+    
+    /**
+     * @brief 保持しているスナップショットを古い順に取り出す
+     * @param visitor 取り出し関数
+     * @param context 取り出し関数の引数
+     * @return size_t 取り出した数
+     */
+    size_t forEachSnapshot(SnapshotVisitor visitor, void* context) const;
+    
+    /**
+     * @brief 保持しているイベントを古い順に取り出す
+     * @param visitor 取り出し関数
+     * @param context 取り出し関数の引数
+     * @return size_t 取り出した数
+     */
+    size_t forEachEvent(EventVisitor visitor, void* context) const;
+    
+    /**
+     * @brief 状態と記録のログ出力（CLI用、スナップショットは新しい方から max_snapshots 件）
+     * @param max_snapshots 表示するスナップショット数
+     */
+    void dump(size_t max_snapshots = 16) const;
+    
+    /**
+     * @brief イベント種別名
+     */
+    static const char* eventName(Event code);
+    
+private:
+    static constexpr uint32_t MAGIC = 0x46524543;       // "FREC"
+    static constexpr uint16_t VERSION = 1;              // 配置のバージョン
+    
+    /**
+     * @brief RTCメモリ上の記録領域
+     */
+    struct Region {
+        uint32_t magic;                             // 識別子
+        uint16_t version;                           // 配置のバージョン
+        uint16_t size;                              // 領域のサイズ（配置の検証）
+        uint32_t session;                           // セッション番号
+        uint32_t check;                             // magic ^ session（不定値の誤判定を減らす）
+        uint32_t snapshot_head;                     // 次に書くスナップショットの通し番号
+        uint32_t event_head;                        // 次に書くイベントの通し番号
+        Snapshot snapshots[SNAPSHOT_COUNT];         // スナップショットのリング
+        EventRecord events[EVENT_COUNT];            // イベントのリング
+    };
+    
+    static_assert(sizeof(Snapshot) == 32, "スナップショットは32バイト");
+    static_assert((SNAPSHOT_COUNT & (SNAPSHOT_COUNT - 1)) == 0, "スナップショット数は2のべき乗");
+    static_assert((EVENT_COUNT & (EVENT_COUNT - 1)) == 0, "イベント数は2のべき乗");
+    static_assert(sizeof(Region) < 0x10000, "領域のサイズは16bitに収める");
+    
+    FaultRecorder();
+    
+    /**
+     * @brief 領域が有効な記録か
+     */
+    bool regionValid() const;
+    
+    static Region rtc_region_;                      // RTCメモリ上の記録領域（RTC_NOINIT）
+    std::atomic<bool> recording_;                   // セッション中
+    Recovery recovery_;                             // 前回のセッションの情報
+};
+
+} // namespace runtime
+
+#endif // FAULT_RECORDER_HPP
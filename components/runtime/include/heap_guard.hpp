@@ -0,0 +1,130 @@
+/*
+ * Heap Guard
+ * 
+ * 飛行中のヒープ使用の検出（ヒープフック）
+ * アーム後の確保を数えて呼び出し元を記録する、または直ちに停止させる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef HEAP_GUARD_HPP
+#define HEAP_GUARD_HPP
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 飛行モードのヒープ監視クラス（全体で1つ）
+ * 
+ * CONFIG_HEAP_USE_HOOKS のヒープフック（esp_heap_trace_alloc_hook・esp_heap_trace_free_hook）で
+ * すべてのmalloc・new・heap_caps_malloc・freeを受け取る。飛行モード中の確保は
+ * 呼び出し元のバックトレース毎に回数・バイト数を数え、dump()でアドレスを出力する
+ * （xtensa-esp32s3-elf-addr2line -e build/stampfly_espidf.elf で関数名に変換する）。
+ * 方針がTRAPの場合は最初の確保で停止し、パニック出力のバックトレースに呼び出し元が出る。
+ * アーム時に enterFlightMode()、ディスアーム時に exitFlightMode() を呼ぶ
+ */
+class HeapGuard {
+public:
+    static constexpr size_t BACKTRACE_DEPTH = 6;    // 記録する呼び出し元の段数
+    static constexpr size_t MAX_SITES = 16;         // 記録する呼び出し元の数
+    
+    /**
+     * @brief 飛行モード中の確保の扱い
+     */
+    enum class Policy : uint8_t {
+        COUNT = 0,          // 数えて記録する（飛行は続ける）
+        TRAP                // 停止させる（地上試験用）
+    };
+    
+    /**
+     * @brief 呼び出し元の記録
+     */
+    struct Site {
+        uint32_t pc[BACKTRACE_DEPTH];   // バックトレース（フックの直上から）
+        uint32_t count;                 // 確保回数
+        uint32_t bytes;                 // 確保バイト数の合計
+        uint32_t max_size;              // 1回の最大バイト数
+    };
+    
+    /**
+     * @brief 統計構造体
+     */
+    struct Stats {
+        uint32_t allocations;           // 飛行モード中の確保回数
+        uint32_t frees;                 // 飛行モード中の解放回数
+        uint32_t bytes;                 // 飛行モード中の確保バイト数の合計
+        uint32_t isr_allocations;       // うちISRからの確保回数
+        uint32_t untracked;             // 記録表が満杯で呼び出し元を記録できなかった回数
+        uint32_t sessions;              // 飛行モードに入った回数
+    };
+    
+    /**
+     * @brief 飛行モード開始（記録は前回の続きから）
+     * @param policy 確保の扱い
+     * @return esp_err_t ヒープフックが無効なビルドではESP_ERR_NOT_SUPPORTED
+     */
+    static esp_err_t enterFlightMode(Policy policy = Policy::COUNT);
+    
+    /**
+     * @brief 飛行モード終了
+     */
+    static void exitFlightMode();
+    
+    /**
+     * @brief 飛行モード中か
+     */
+    static bool inFlightMode() { return active_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 統計取得
+     */
+    static Stats getStats();
+    
+    /**
+     * @brief 呼び出し元の記録取得
+     * @param sites 格納先
+     * @param max_sites 格納先の要素数
+     * @return size_t 格納した数
+     */
+    static size_t getSites(Site* sites, size_t max_sites);
+    
+    /**
+     * @brief 統計・記録のクリア
+     */
+    static void reset();
+    
+    /**
+     * @brief 統計・呼び出し元のログ出力（CLI用）
+     */
+    static void dump();
+    
+    /**
+     * @brief 確保の通知（ヒープフックから呼ばれる）
+     */
+    static void onAllocate(size_t size);
+    
+    /**
+     * @brief 解放の通知（ヒープフックから呼ばれる）
+     */
+    static void onFree();
+    
+private:
+    static std::atomic<bool> active_;               // 飛行モード中
+    static Policy policy_;                          // 確保の扱い
+    static Stats stats_;                            // 統計（spinlock_保護）
+    static Site sites_[MAX_SITES];                  // 呼び出し元（spinlock_保護）
+    static size_t site_count_;                      // 記録数（spinlock_保護）
+    static portMUX_TYPE spinlock_;                  // 記録保護
+};
+
+} // namespace runtime
+
+#endif // HEAP_GUARD_HPP
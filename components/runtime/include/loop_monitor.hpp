@@ -0,0 +1,226 @@
+/*
+ * Loop Monitor
+ * 
+ * 制御ループの処理時間予算モニタ
+ * ステージ毎（センサー読み出し・推定・制御・ミキシング・出力）のサイクル数を毎周期記録し、
+ * 周期に対する予算を超えた場合は設定した方針で負荷を下げる・緊急停止を要求する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef LOOP_MONITOR_HPP
+#define LOOP_MONITOR_HPP
+
+#include "delegate.hpp"
+#include "mailbox.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 制御ループ処理時間モニタクラス
+ * 
+ * 制御タスクは毎周期 beginCycle() → 各ステージ終了時に endStage() → endCycle() を呼び出す。
+ * 計測はCPUサイクルカウンタの差分のみで、ロック・ヒープ・ログ出力はない。
+ * 移動最悪値は window_cycles 周期毎の区間最大で、直近2区間の大きい方を返す。
+ * 区間の終わりに集計（Report）をMailboxへ公開するため、CLI・テレメトリからは一貫した値を読める。
+ * 
+ * 予算超過時の方針:
+ * - SKIP_LOW_RATE: 低レート処理（ログ・テレメトリ・スペクトル解析等）を止める
+ * - DEGRADE_ESTIMATOR: 推定器の更新レートを落とす
+ * - EMERGENCY_STOP: 直ちに緊急停止を要求する
+ * いずれの方針でも、連続超過がescalate_after回に達すると緊急停止を要求する（ラッチ）。
+ * 方針の実行は呼び出し側が getAction() を見て行い、変化時は通知関数も呼ばれる
+ */
+class LoopMonitor {
+public:
+    /**
+     * @brief ループのステージ列挙型
+     */
+    enum class Stage : uint8_t {
+        SENSOR_READ = 0,    // センサー読み出し
+        ESTIMATE,           // 状態推定
+        CONTROL,            // 制御演算
+        MIX,                // ミキシング
+        OUTPUT,             // モーター出力
+        COUNT
+    };
+    
+    static constexpr size_t STAGE_COUNT = static_cast<size_t>(Stage::COUNT);   // ステージ数
+    static constexpr size_t HISTOGRAM_BINS = 11;    // 周期使用率の分布（10%刻み、最後は100%超）
+    
+    /**
+     * @brief 超過時の動作列挙型
+     */
+    enum class Action : uint8_t {
+        NONE = 0,               // 通常動作
+        SKIP_LOW_RATE,          // 低レート処理を止める
+        DEGRADE_ESTIMATOR,      // 推定器のレートを落とす
+        EMERGENCY_STOP          // 緊急停止
+    };
+    
+    /**
+     * @brief モニタ設定構造体
+     */
+    struct Config {
+        uint32_t period_us = 2500;                  // 制御周期（μs）
+        uint32_t cpu_mhz = 240;                     // CPU周波数（MHz、サイクル換算用）
+        float budget_ratio = 0.9f;                  // 予算（周期に対する比率）
+        Action policy = Action::SKIP_LOW_RATE;      // 予算超過時の動作
+        uint32_t escalate_after = 20;               // 緊急停止に移る連続超過回数（0で移らない）
+        uint32_t recovery_cycles = 400;             // 通常動作へ戻るまでの超過なし周期数
+        uint32_t window_cycles = 400;               // 移動最悪値の区間長（周期）
+    };
+    
+    /**
+     * @brief ステージ統計構造体（サイクル数）
+     */
+    struct StageReport {
+        uint32_t last;                  // 前回
+        uint32_t average;               // 直近区間の平均
+        uint32_t moving_max;            // 移動最悪値
+        uint32_t max;                   // 開始以来の最大
+    };
+    
+    /**
+     * @brief 集計結果構造体
+     */
+    struct Report {
+        uint32_t cycles;                            // 計測した周期数
+        uint32_t budget_cycles;                     // 予算（サイクル）
+        uint32_t overruns;                          // 予算超過回数
+        uint32_t max_consecutive_overruns;          // 最大連続超過回数
+        Action action;                              // 現在の動作
+        StageReport stage[STAGE_COUNT];             // ステージ毎
+        StageReport total;                          // 1周期全体
+        uint32_t histogram[HISTOGRAM_BINS];         // 周期使用率の分布
+    };
+    
+    /**
+     * @brief 動作変化の通知関数型（制御タスクから呼び出される、EMERGENCY_STOPでemergency_stop()等）
+     */
+    using ActionCallback = common::Delegate<void(Action)>;
+    
+public:
+    LoopMonitor();
+    
+    /**
+     * @brief 設定（統計をクリアする）
+     * @param config モニタ設定
+     */
+    void setConfig(const Config& config);
+    
+    /**
+     * @brief 設定取得
+     */
+    const Config& getConfig() const { return config_; }
+    
+    /**
+     * @brief 動作変化の通知設定
+     * @param callback 通知関数
+     */
+    void setActionCallback(ActionCallback callback) { callback_ = callback; }
+    
+    /**
+     * @brief 周期の開始
+     */
+    void beginCycle();
+    
+    /**
+     * @brief ステージの終了（前のステージ終了または周期開始からの経過を記録）
+     * @param stage ステージ
+     */
+    void endStage(Stage stage);
+    
+    /**
+     * @brief 周期の終了（予算判定と動作の更新）
+     * @return Action 次の周期に適用する動作
+     */
+    Action endCycle();
+    
+    /**
+     * @brief 現在の動作取得
+     */
+    Action getAction() const { return action_; }
+    
+    /**
+     * @brief 緊急停止のラッチ解除と統計クリア（着陸・ディスアーム後）
+     */
+    void reset();
+    
+    /**
+     * @brief 最新の集計取得（他タスクから呼び出し可）
+     * @param report 集計格納先
+     * @return bool 集計がある場合true
+     */
+    bool getReport(Report& report) const { return report_.read(report); }
+    
+    /**
+     * @brief 集計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief 動作名取得
+     */
+    static const char* actionName(Action action);
+    
+    /**
+     * @brief ステージ名取得
+     */
+    static const char* stageName(Stage stage);
+    
+private:
+    /**
+     * @brief 計測中の統計（制御タスクのみが触る）
+     */
+    struct Accumulator {
+        uint32_t last;                  // 前回
+        uint64_t window_sum;            // 区間合計
+        uint32_t window_max;            // 区間最大
+        uint32_t previous_window_max;   // 前区間の最大
+        uint32_t max;                   // 開始以来の最大
+        
+        void clear();
+        void add(uint32_t cycles);
+        void rollWindow();
+        StageReport report(uint32_t window_count) const;
+    };
+    
+    Config config_;                             // 設定
+    uint32_t budget_cycles_;                    // 予算（サイクル）
+    ActionCallback callback_;                   // 動作変化の通知
+    
+    uint32_t cycle_start_;                      // 周期開始のサイクルカウント
+    uint32_t stage_start_;                      // ステージ開始のサイクルカウント
+    Accumulator stages_[STAGE_COUNT];           // ステージ毎
+    Accumulator total_;                         // 1周期全体
+    uint32_t histogram_[HISTOGRAM_BINS];        // 周期使用率の分布
+    uint32_t cycles_;                           // 計測した周期数
+    uint32_t window_count_;                     // 区間内の周期数
+    uint32_t overruns_;                         // 予算超過回数
+    uint32_t consecutive_overruns_;             // 連続超過回数
+    uint32_t max_consecutive_overruns_;         // 最大連続超過回数
+    uint32_t clean_cycles_;                     // 最後の超過からの周期数
+    Action action_;                             // 現在の動作
+    
+    common::Mailbox<Report> report_;            // 公開した集計
+    
+    /**
+     * @brief 動作変更と通知
+     */
+    void setAction(Action action);
+    
+    /**
+     * @brief 集計の公開
+     */
+    void publish();
+};
+
+} // namespace runtime
+
+#endif // LOOP_MONITOR_HPP
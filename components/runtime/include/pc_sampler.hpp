@@ -0,0 +1,173 @@
+/*
+ * PC Sampler
+ * 
+ * タイマ割り込みによるプログラムカウンタのサンプリングプロファイラ
+ * 割り込まれた位置のPC（と呼び出し元数段）をコア別のリングバッファへ記録し、
+ * ホスト側（tools/pc_profile.py）でELFと突き合わせてフラットプロファイルにする
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PC_SAMPLER_HPP
+#define PC_SAMPLER_HPP
+
+#include "esp_err.h"
+#include "driver/gptimer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief PCサンプリングプロファイラクラス
+ * 
+ * サンプリングするコア毎にGPTimerを1つ使い、そのコアで割り込みを確保する
+ * （割り込みは確保したコアで実行されるため）。割り込みハンドラでバックトレースを取り、
+ * タイマ・割り込みディスパッチの段を skip_frames 段飛ばした先の FRAME_DEPTH 段を記録する。
+ * 割り込まれたタスクまで辿るには CONFIG_FREERTOS_INTERRUPT_BACKTRACE が必要（Xtensaのみ）。
+ * 飛ばし切れなかったISRの段はホスト側で関数名から取り除く。
+ * バッファは start() で確保し、満杯後は古いサンプルから上書きする（直近の区間が残る）。
+ * 割り込み禁止区間（クリティカルセクション等）の時間は禁止を解いた位置に計上される。
+ * 周期は制御ループ（1kHz等）と同期しないよう素数の既定値にしている。
+ * 計測中の読み出しはできないため、stop() 後に dump() でログへ出力し、
+ * シリアルのログを tools/pc_profile.py に渡す
+ */
+class PcSampler {
+public:
+    static constexpr size_t FRAME_DEPTH = 4;        // 1サンプルに記録する段数（[0]が割り込まれたPC）
+    static constexpr size_t CORE_COUNT = 2;         // コア数
+    
+    /**
+     * @brief サンプラ設定構造体
+     */
+    struct Config {
+        uint32_t period_us = 1009;                  // サンプリング周期（μs）
+        size_t capacity = 1024;                     // コア毎のサンプル数（リングバッファ）
+        uint8_t core_mask = 0x3;                    // サンプリングするコア（bit0: コア0、bit1: コア1）
+        uint8_t skip_frames = 2;                    // 飛ばすISRの段数（タイマドライバ・ディスパッチ）
+    };
+    
+    /**
+     * @brief 1サンプル（0は記録なし）
+     */
+    struct Sample {
+        uint32_t pc[FRAME_DEPTH];       // [0]が割り込まれたPC、以降は呼び出し元
+    };
+    
+    /**
+     * @brief コア別の統計
+     */
+    struct Stats {
+        uint32_t samples;               // 記録したサンプル数（上書きされたものを含む）
+        uint32_t stored;                // バッファに残っているサンプル数
+        uint32_t truncated;             // 割り込まれた位置まで辿れなかったサンプル数
+    };
+    
+public:
+    PcSampler();
+    ~PcSampler();
+    
+    PcSampler(const PcSampler&) = delete;
+    PcSampler& operator=(const PcSampler&) = delete;
+    
+    /**
+     * @brief サンプリング開始（前回のサンプルは破棄する）
+     * @param config サンプラ設定
+     * @return esp_err_t Xtensa以外ではESP_ERR_NOT_SUPPORTED
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief サンプリング開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief サンプリング停止（サンプルは保持する）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief サンプリング中か
+     */
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief コア別の統計取得
+     * @param core コア番号
+     */
+    Stats getStats(size_t core) const;
+    
+    /**
+     * @brief サンプルの読み出し（古い順、停止中のみ）
+     * @param core コア番号
+     * @param index 古い方からの位置
+     * @param sample 格納先
+     * @return esp_err_t サンプリング中はESP_ERR_INVALID_STATE、範囲外はESP_ERR_INVALID_ARG
+     */
+    esp_err_t read(size_t core, size_t index, Sample& sample) const;
+    
+    /**
+     * @brief サンプルのログ出力（停止中のみ、tools/pc_profile.py の入力）
+     * 
+     * 1サンプル1行で "PCS <コア> <pc0> <pc1> ..." の形式で出力する
+     */
+    void dump() const;
+    
+    /**
+     * @brief サンプルの破棄（停止中のみ）
+     */
+    void clear();
+    
+private:
+    /**
+     * @brief コア別のサンプリング状態
+     */
+    struct Channel {
+        PcSampler* owner;                           // サンプラ
+        gptimer_handle_t timer;                     // タイマ（そのコアで割り込みを確保）
+        Sample* buffer;                             // リングバッファ
+        std::atomic<uint32_t> samples;              // 記録した数（ISRのみ書き込み）
+        std::atomic<uint32_t> truncated;            // 辿れなかった数（ISRのみ書き込み）
+    };
+    
+    /**
+     * @brief セットアップタスクへの引数
+     */
+    struct Setup {
+        Channel* channel;                           // 対象のコア
+        uint32_t period_us;                         // 周期
+        TaskHandle_t waiter;                        // 完了を待つタスク
+        esp_err_t result;                           // 結果
+    };
+    
+    Config config_;                                 // 設定
+    Channel channel_[CORE_COUNT];                   // コア別の状態
+    std::atomic<bool> running_;                     // サンプリング中
+    
+    /**
+     * @brief タイマの作成と開始（対象のコアに固定したタスクで実行）
+     */
+    static void setupEntry(void* arg);
+    
+    /**
+     * @brief タイマ・バッファの解放
+     */
+    void release();
+    
+    /**
+     * @brief タイマ割り込み（割り込まれたPCの記録）
+     */
+    static bool alarmCallback(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx);
+};
+
+} // namespace runtime
+
+#endif // PC_SAMPLER_HPP
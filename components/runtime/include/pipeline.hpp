@@ -0,0 +1,427 @@
+/*
+ * Pipeline
+ * 
+ * タスク通知で起床するタスク間パイプライン（センサー → 制御 → CLI・テレメトリ）
+ * ロックフリーのリング・メールボックスへ積み、xTaskNotifyGive で消費側を起こす。
+ * IMUのサンプル時刻を段をまたいで運び、モーター出力までの遅延を計測する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+
+#include "mailbox.hpp"
+#include "ring_buffer.hpp"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 段をまたいで運ぶ時刻
+ */
+struct PipelineStamp {
+    int64_t sample_us;          // 起点（IMUのサンプル）の時刻（μs）
+    int64_t publish_us;         // 直前の段が渡した時刻（μs）
+    uint32_t sequence;          // 起点のサンプル番号（欠落の検出用）
+};
+
+/**
+ * @brief 消費側タスクの通知（チャネル共通）
+ * 
+ * 消費側タスクのタスク通知（インデックス0）を起床に使うため、
+ * そのタスクは他の用途でタスク通知を使わないこと。
+ * 複数のチャネルを待つ消費側は wait() で起床し、各チャネルの tryReceive() で全て取り出す
+ * 
+ * 使用例（sensor_task → control_task → cli_task）:
+ *   PipelineConsumer control_wake;
+ *   PipelineRing<ImuSample, 8> imu(control_wake);
+ *   PipelineLatest<MotorOutput> outputs(nullptr);
+ *   （sensor_task）imu.publish(sample, {sample_us, 0, sequence++});
+ *   （control_task）control_wake.bindCurrentTask();
+ *                   while (imu.receive(sample, stamp, timeout)) { latency.recordHop(0, stamp, now); ...
+ *                       mixer出力後 latency.recordOutput(stamp, esp_timer_get_time()); outputs.publish(out, stamp); }
+ *   （cli_task）outputs.peek(out); latency.dump();
+ */
+class PipelineConsumer {
+public:
+    PipelineConsumer()
+        : task_(nullptr) {}
+    
+    PipelineConsumer(const PipelineConsumer&) = delete;
+    PipelineConsumer& operator=(const PipelineConsumer&) = delete;
+    
+    /**
+     * @brief 呼び出したタスクを消費側にする（消費側タスクの先頭で呼ぶ）
+     */
+    void bindCurrentTask() { task_.store(xTaskGetCurrentTaskHandle(), std::memory_order_release); }
+    
+    /**
+     * @brief 消費側の解除（消費側タスクの終了前に呼ぶ）
+     */
+    void unbind() { task_.store(nullptr, std::memory_order_release); }
+    
+    /**
+     * @brief 消費側を起こす（生産側タスク）
+     */
+    void notify() {
+        TaskHandle_t task = task_.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            xTaskNotifyGive(task);
+        }
+    }
+    
+    /**
+     * @brief 消費側を起こす（ISR）
+     * @param woken 高優先度タスクを起こした場合pdTRUE（portYIELD_FROM_ISRへ渡す）
+     */
+    void IRAM_ATTR notifyFromIsr(BaseType_t* woken) {
+        TaskHandle_t task = task_.load(std::memory_order_acquire);
+        if (task != nullptr) {
+            vTaskNotifyGiveFromISR(task, woken);
+        }
+    }
+    
+    /**
+     * @brief 通知を待つ（消費側タスク、溜まった通知はまとめて消費する）
+     * @param timeout 待ち時間
+     * @return bool 通知があった場合true
+     */
+    static bool wait(TickType_t timeout) { return ulTaskNotifyTake(pdTRUE, timeout) != 0; }
+    
+private:
+    std::atomic<TaskHandle_t> task_;    // 消費側タスク
+};
+
+/**
+ * @brief 全件を順に渡すチャネル（単一生産者/単一消費者リング）
+ * 
+ * センサー → 推定のように全サンプルを使う段に使う。満杯なら新しい方を捨てて数える
+ * @tparam T 値の型（トリビアルコピー可能であること）
+ * @tparam N 容量（2のべき乗）
+ */
+template<typename T, size_t N>
+class PipelineRing {
+public:
+    /**
+     * @brief コンストラクタ
+     * @param consumer 消費側の通知（複数のチャネルで共有してよい）
+     */
+    explicit PipelineRing(PipelineConsumer& consumer)
+        : consumer_(consumer) {}
+    
+    PipelineRing(const PipelineRing&) = delete;
+    PipelineRing& operator=(const PipelineRing&) = delete;
+    
+    /**
+     * @brief 値を渡して消費側を起こす（生産側タスク）
+     * @param value 値
+     * @param stamp 時刻（publish_usは現在時刻で上書きする）
+     * @return bool 満杯で捨てた場合false
+     */
+    bool publish(const T& value, const PipelineStamp& stamp) {
+        if (!push(value, stamp)) {
+            return false;
+        }
+        consumer_.notify();
+        return true;
+    }
+    
+    /**
+     * @brief 値を渡して消費側を起こす（ISR）
+     * @param value 値
+     * @param stamp 時刻（publish_usは現在時刻で上書きする）
+     * @param woken 高優先度タスクを起こした場合pdTRUE
+     * @return bool 満杯で捨てた場合false
+     */
+    bool IRAM_ATTR publishFromIsr(const T& value, const PipelineStamp& stamp, BaseType_t* woken) {
+        if (!push(value, stamp)) {
+            return false;
+        }
+        consumer_.notifyFromIsr(woken);
+        return true;
+    }
+    
+    /**
+     * @brief 取り出し（消費側タスク、待たない）
+     * @param value 格納先
+     * @param stamp 時刻の格納先
+     * @return bool 取り出せた場合true
+     */
+    bool tryReceive(T& value, PipelineStamp& stamp) {
+        Envelope envelope;
+        if (!ring_.pop(envelope)) {
+            return false;
+        }
+        value = envelope.value;
+        stamp = envelope.stamp;
+        return true;
+    }
+    
+    /**
+     * @brief 取り出し（消費側タスク、空なら通知を待つ）
+     * @param value 格納先
+     * @param stamp 時刻の格納先
+     * @param timeout 待ち時間
+     * @return bool 取り出せた場合true
+     */
+    bool receive(T& value, PipelineStamp& stamp, TickType_t timeout) {
+        // 空を確認してから待つまでに積まれた分は通知が残っているため取りこぼさない
+        if (tryReceive(value, stamp)) {
+            return true;
+        }
+        PipelineConsumer::wait(timeout);
+        return tryReceive(value, stamp);
+    }
+    
+    /**
+     * @brief 格納数（概数）
+     */
+    size_t size() const { return ring_.size(); }
+    
+    /**
+     * @brief 満杯で捨てた数
+     */
+    uint32_t getDroppedCount() const { return ring_.getDroppedCount(); }
+    
+private:
+    /**
+     * @brief 値と時刻の組
+     */
+    struct Envelope {
+        T value;
+        PipelineStamp stamp;
+    };
+    
+    bool IRAM_ATTR push(const T& value, const PipelineStamp& stamp) {
+        Envelope envelope;
+        envelope.value = value;
+        envelope.stamp = stamp;
+        envelope.stamp.publish_us = esp_timer_get_time();
+        return ring_.push(envelope);
+    }
+    
+    PipelineConsumer& consumer_;                    // 消費側の通知
+    common::RingBuffer<Envelope, N> ring_;          // 受け渡しリング
+};
+
+/**
+ * @brief 最新値だけを渡すチャネル（シーケンスロックのメールボックス）
+ * 
+ * 制御 → CLI・テレメトリのように最新の1件だけが意味を持つ段に使う。
+ * 生産側は待たず、消費側が読まないうちに上書きされた分は skipped として数える
+ * @tparam T 値の型（トリビアルコピー可能であること）
+ */
+template<typename T>
+class PipelineLatest {
+public:
+    /**
+     * @brief コンストラクタ
+     * @param consumer 消費側の通知（nullptrで起こさない、読み出し側が周期的に読む）
+     */
+    explicit PipelineLatest(PipelineConsumer* consumer)
+        : consumer_(consumer)
+        , read_version_(0)
+        , stat_skipped_(0) {}
+    
+    PipelineLatest(const PipelineLatest&) = delete;
+    PipelineLatest& operator=(const PipelineLatest&) = delete;
+    
+    /**
+     * @brief 最新値を渡して消費側を起こす（単一の生産側タスク）
+     * @param value 値
+     * @param stamp 時刻（publish_usは現在時刻で上書きする）
+     */
+    void publish(const T& value, const PipelineStamp& stamp) {
+        Envelope envelope;
+        envelope.value = value;
+        envelope.stamp = stamp;
+        envelope.stamp.publish_us = esp_timer_get_time();
+        mailbox_.write(envelope);
+        if (consumer_ != nullptr) {
+            consumer_->notify();
+        }
+    }
+    
+    /**
+     * @brief 新しい値の取り出し（単一の消費側タスク、待たない）
+     * @param value 格納先
+     * @param stamp 時刻の格納先
+     * @return bool 前回から新しい値があった場合true
+     */
+    bool tryReceive(T& value, PipelineStamp& stamp) {
+        if (mailbox_.getVersion() == read_version_) {
+            return false;
+        }
+        Envelope envelope;
+        uint32_t version = 0;
+        if (!mailbox_.read(envelope, version)) {
+            return false;
+        }
+        // 版数は書き込み毎に2増える
+        if (read_version_ != 0 && version - read_version_ > 2) {
+            stat_skipped_.fetch_add((version - read_version_) / 2 - 1, std::memory_order_relaxed);
+        }
+        read_version_ = version;
+        value = envelope.value;
+        stamp = envelope.stamp;
+        return true;
+    }
+    
+    /**
+     * @brief 新しい値の取り出し（単一の消費側タスク、なければ通知を待つ）
+     * @param value 格納先
+     * @param stamp 時刻の格納先
+     * @param timeout 待ち時間
+     * @return bool 新しい値を取り出せた場合true
+     */
+    bool receive(T& value, PipelineStamp& stamp, TickType_t timeout) {
+        if (tryReceive(value, stamp)) {
+            return true;
+        }
+        PipelineConsumer::wait(timeout);
+        return tryReceive(value, stamp);
+    }
+    
+    /**
+     * @brief 最新値の参照（複数の読み出し側から可、新旧は判定しない）
+     * @param value 格納先
+     * @return bool 一貫した値を取得できた場合true
+     */
+    bool peek(T& value) const {
+        Envelope envelope;
+        if (!mailbox_.read(envelope)) {
+            return false;
+        }
+        value = envelope.value;
+        return true;
+    }
+    
+    /**
+     * @brief 読まれずに上書きされた数
+     */
+    uint32_t getSkippedCount() const { return stat_skipped_.load(std::memory_order_relaxed); }
+    
+private:
+    /**
+     * @brief 値と時刻の組
+     */
+    struct Envelope {
+        T value;
+        PipelineStamp stamp;
+    };
+    
+    PipelineConsumer* consumer_;                    // 消費側の通知
+    common::Mailbox<Envelope> mailbox_;             // 最新値
+    uint32_t read_version_;                         // 取り出した版数（消費側のみ）
+    std::atomic<uint32_t> stat_skipped_;            // 読まれずに上書きされた数
+};
+
+/**
+ * @brief パイプラインの遅延計測クラス
+ * 
+ * 各段の受け渡し遅延（publish_us → 消費側が取り出した時刻）と、IMUのサンプルから
+ * モーター出力までの全体の遅延（sample_us → 出力時刻）を記録する。
+ * 各系列は単一のタスクから記録すること（読み出しは任意のタスクから）
+ */
+class PipelineLatency {
+public:
+    static constexpr size_t MAX_HOPS = 4;           // 受け渡しの段数
+    
+    /**
+     * @brief 遅延の系列
+     */
+    struct Series {
+        uint32_t count;             // 記録数
+        uint32_t last_us;           // 直近（μs）
+        uint32_t average_us;        // 指数移動平均（μs、1/16）
+        uint32_t max_us;            // 最大（μs）
+    };
+    
+    /**
+     * @brief 集計結果
+     */
+    struct Report {
+        Series hop[MAX_HOPS];       // 段毎の受け渡し遅延
+        Series end_to_end;          // サンプルからモーター出力まで
+        uint32_t lost;              // サンプル番号の欠落数（出力側で判定）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param hop_names 段の名前（dump用、hop_count個、静的な配列）
+     * @param hop_count 段数（MAX_HOPSまで）
+     */
+    PipelineLatency(const char* const* hop_names, size_t hop_count);
+    
+    PipelineLatency(const PipelineLatency&) = delete;
+    PipelineLatency& operator=(const PipelineLatency&) = delete;
+    
+    /**
+     * @brief 受け渡し遅延の記録（各段の消費側が取り出した直後）
+     * @param hop 段番号
+     * @param stamp 取り出した時刻
+     * @param now_us 現在時刻（μs）
+     */
+    void recordHop(size_t hop, const PipelineStamp& stamp, int64_t now_us);
+    
+    /**
+     * @brief 全体の遅延の記録（モーター出力の直後）
+     * @param stamp 出力に使ったサンプルの時刻
+     * @param now_us 出力時刻（μs）
+     */
+    void recordOutput(const PipelineStamp& stamp, int64_t now_us);
+    
+    /**
+     * @brief 集計結果取得
+     * @return Report 集計結果
+     */
+    Report getReport() const;
+    
+    /**
+     * @brief 統計クリア
+     */
+    void reset();
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 系列の積算（記録は単一のタスク）
+     */
+    struct Accumulator {
+        std::atomic<uint32_t> count;
+        std::atomic<uint32_t> last_us;
+        std::atomic<uint32_t> max_us;
+        std::atomic<uint32_t> average_x16;      // 指数移動平均×16（64bitのatomicはロックになるため32bitで持つ）
+        
+        void add(int64_t latency_us);
+        void clear();
+        Series get() const;
+    };
+    
+    const char* const* hop_names_;                  // 段の名前
+    size_t hop_count_;                              // 段数
+    Accumulator hops_[MAX_HOPS];                    // 段毎
+    Accumulator end_to_end_;                        // 全体
+    uint32_t last_sequence_;                        // 出力した直前のサンプル番号（出力側のみ）
+    bool sequence_valid_;                           // last_sequence_が有効
+    std::atomic<uint32_t> stat_lost_;               // サンプル番号の欠落数
+};
+
+} // namespace runtime
+
+#endif // PIPELINE_HPP
@@ -0,0 +1,146 @@
+/*
+ * Power Manager
+ * 
+ * 動的周波数切替と自動ライトスリープによる電源管理
+ * アーム中は240MHz固定・ライトスリープ禁止、ディスアーム中は低周波数と自動ライトスリープで待機電力を減らす
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef POWER_MANAGER_HPP
+#define POWER_MANAGER_HPP
+
+#include "esp_err.h"
+#include "esp_pm.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 電源管理クラス
+ * 
+ * start() で esp_pm を最大・最小周波数と自動ライトスリープで設定し、
+ * 飛行用の電源管理ロック（CPU最大周波数・ライトスリープ禁止）を作る。
+ * アーム時に enterFlightMode() でロックを取得し、戻った時点で最大周波数へ切り替わっている
+ * （制御ティック開始より前に呼ぶ）。ディスアーム時に exitFlightMode() で解放すると、
+ * 他のロックがなければアイドル中は最小周波数・ライトスリープになる。
+ * 飛行モードの開始・終了で common::FlashGuard の抑止も開始・終了する（電源管理が無効なビルドでも行う）。
+ * 
+ * ドライバのロックは転送中・有効化中だけ持たれる（SPI・I2Cはトランザクション中、
+ * ControlTickはstart()〜stop()）。USB・UARTのCLI接続中など起きていてほしい間は holdAwake() を使う。
+ * CONFIG_PM_ENABLE が無効なビルドでは start() は警告のみで、以降の呼び出しは何もしない
+ */
+class PowerManager {
+public:
+    /**
+     * @brief 電源管理設定構造体
+     */
+    struct Config {
+        int max_freq_mhz = 240;             // 最大周波数（MHz、アーム中）
+        int min_freq_mhz = 40;              // 最小周波数（MHz、XTAL）
+        bool light_sleep = true;            // ディスアーム中の自動ライトスリープ（要CONFIG_FREERTOS_USE_TICKLESS_IDLE）
+        uint32_t flash_drain_ms = 200;      // アーム時に実行中のフラッシュ書き込み・消去の終了を待つ時間（ms）
+    };
+    
+    /**
+     * @brief 統計構造体
+     */
+    struct Stats {
+        uint32_t flight_sessions;           // enterFlightMode() の回数
+        uint32_t last_switch_us;            // 直近の最大周波数への切替時間（μs）
+        uint32_t max_switch_us;             // 最大周波数への切替時間の最大（μs）
+        uint32_t awake_holds;               // holdAwake(true) の回数
+    };
+    
+public:
+    PowerManager();
+    ~PowerManager();
+    
+    PowerManager(const PowerManager&) = delete;
+    PowerManager& operator=(const PowerManager&) = delete;
+    
+    /**
+     * @brief 電源管理開始（esp_pmの設定とロックの作成）
+     * @param config 電源管理設定
+     * @return esp_err_t エラーコード（電源管理が無効なビルドでもESP_OK）
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 電源管理開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 電源管理停止（ロックを解放して削除し、最大周波数固定へ戻す）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 飛行モード開始（アーム時、フラッシュ書き込みの抑止・最大周波数・ライトスリープ禁止）
+     * @return esp_err_t 実行中のフラッシュ書き込みが終わらない場合ESP_ERR_TIMEOUT（アームしないこと）
+     */
+    esp_err_t enterFlightMode();
+    
+    /**
+     * @brief 飛行モード終了（ディスアーム時）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t exitFlightMode();
+    
+    /**
+     * @brief 飛行モード中か
+     */
+    bool isFlightMode() const { return flight_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief ライトスリープの一時禁止（CLI接続中・地上局接続中など、周波数は下げてよい）
+     * @param hold 禁止する場合true
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t holdAwake(bool hold);
+    
+    /**
+     * @brief 電源管理が動作中か（CONFIG_PM_ENABLE有効かつstart()済み）
+     */
+    bool isActive() const { return active_; }
+    
+    /**
+     * @brief 統計取得
+     * @return Stats 統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief ロックの解放と削除
+     */
+    void deleteLocks();
+    
+    Config config_;                                 // 電源管理設定
+    bool active_;                                   // 電源管理動作中
+    esp_pm_lock_handle_t cpu_lock_;                 // CPU最大周波数ロック（飛行モード）
+    esp_pm_lock_handle_t sleep_lock_;               // ライトスリープ禁止ロック（飛行モード）
+    esp_pm_lock_handle_t awake_lock_;               // ライトスリープ禁止ロック（holdAwake）
+    std::atomic<bool> flight_;                      // 飛行モード中
+    std::atomic<bool> awake_;                       // holdAwake中
+    std::atomic<uint32_t> flight_sessions_;         // 統計: 飛行モード回数
+    std::atomic<uint32_t> last_switch_us_;          // 統計: 直近の切替時間
+    std::atomic<uint32_t> max_switch_us_;           // 統計: 切替時間の最大
+    std::atomic<uint32_t> awake_holds_;             // 統計: holdAwake回数
+};
+
+} // namespace runtime
+
+#endif // POWER_MANAGER_HPP
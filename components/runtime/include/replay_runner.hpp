@@ -0,0 +1,213 @@
+/*
+ * Replay Runner
+ * 
+ * 記録済みセンサー値による推定・制御のHILリプレイ
+ * SensorReplayのフレームを姿勢推定器・EKF・姿勢制御器・ミキサーへ順に通し、
+ * 推定・制御の処理サイクル数と出力のハッシュを集計する（変更前後の比較用）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef REPLAY_RUNNER_HPP
+#define REPLAY_RUNNER_HPP
+
+#include "attitude_estimator.hpp"
+#include "cascaded_pid.hpp"
+#include "error_state_ekf.hpp"
+#include "mailbox.hpp"
+#include "mixer.hpp"
+#include "sensor_replay.hpp"
+#include "uart_hal.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief HILリプレイ実行クラス
+ * 
+ * 1フレーム毎の処理:
+ * 1. AttitudeEstimator::update()（1サンプル）・ErrorStateEkf::predict()、有効ならToF・フローを融合
+ * 2. 指令（ロール・ピッチ・ヨーは max_angle 倍の目標角度、推力はそのまま）でCascadedPid<3>・Mixerを計算
+ * 3. 推定（1）と制御（2）のサイクル数を別々に計測し、姿勢・デューティのビット列をFNV-1aで連鎖ハッシュする
+ * 
+ * 推定器・制御器は先頭フレームの加速度で整列してから始めるため、同じ入力・同じ設定なら
+ * 出力のハッシュは毎回一致する（不一致は数値結果が変わったことを示す）。
+ * output を渡すとフレーム毎に ReplayOutputMessage を送り、地上側でフレーム単位に比較できる
+ * （UART入力の場合は送り返しが地上ツールの送信の流量制御も兼ねる）
+ */
+class ReplayRunner {
+public:
+    using QuadXMixer = control::Mixer<control::QuadXFrame>;
+    
+    /**
+     * @brief 実行設定構造体
+     */
+    struct Config {
+        sensors::SensorReplay::Config replay;                   // リプレイ設定（open時に使う）
+        float control_hz = 400.0f;                              // 記録の制御周波数（Hz、時刻差分が異常な場合のdt）
+        float max_angle = 0.5f;                                 // 指令1.0に対応する目標角度（rad）
+        estimation::AttitudeEstimator::Config estimator;        // 姿勢推定器設定
+        estimation::ErrorStateEkf::Config ekf;                  // EKF設定
+        control::CascadedPid<3>::Config pid;                    // 姿勢制御器設定（sample_hzはcontrol_hzで上書き）
+        QuadXMixer::Config mixer;                               // ミキサー設定
+        uint32_t report_frames = 400;                           // 集計を公開するフレーム間隔
+        UBaseType_t priority = 20;                              // 実行タスクの優先度
+        uint32_t stack_size = 6144;                             // 実行タスクのスタックサイズ
+        int core = 1;                                           // 実行タスクのコア
+    };
+    
+    /**
+     * @brief サイクル数の集計構造体
+     */
+    struct CycleReport {
+        uint32_t last;                  // 前回
+        uint32_t average;               // 平均
+        uint32_t min;                   // 最小
+        uint32_t max;                   // 最大
+    };
+    
+    /**
+     * @brief 集計結果構造体
+     */
+    struct Report {
+        uint32_t frames;                // 処理したフレーム数
+        uint32_t first_time_us;         // 先頭フレームの記録時刻
+        uint32_t last_time_us;          // 最終フレームの記録時刻
+        uint32_t elapsed_us;            // 開始からの経過時間（μs）
+        CycleReport estimate;           // 推定のサイクル数
+        CycleReport control;            // 制御・ミキシングのサイクル数
+        uint32_t output_hash;           // 出力のハッシュ（FNV-1a、先頭から連鎖）
+        uint32_t saturated;             // ミキサーが飽和したフレーム数
+        float quaternion[4];            // 最終の推定姿勢 w, x, y, z
+        float duty[4];                  // 最終のモーター出力
+        esp_err_t result;               // 終了理由（実行中はESP_OK、終わりに達した場合ESP_ERR_NOT_FOUND）
+        bool finished;                  // 終了した
+    };
+    
+public:
+    ReplayRunner();
+    ~ReplayRunner();
+    
+    ReplayRunner(const ReplayRunner&) = delete;
+    ReplayRunner& operator=(const ReplayRunner&) = delete;
+    
+    /**
+     * @brief logsパーティションの記録で開始
+     * @param log 開いたパーティションログ（記録は止めておくこと）
+     * @param config 実行設定
+     * @param output 出力の送り先（nullptrで送らない）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t startPartition(const storage::PartitionLog& log, const Config& config, hal::UartHal* output = nullptr);
+    
+    /**
+     * @brief UARTで受信するフレームで開始（出力は同じUARTへ送り返す）
+     * @param uart 開始済みのUART HAL
+     * @param config 実行設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t startUart(hal::UartHal& uart, const Config& config);
+    
+    /**
+     * @brief 停止
+     * @return esp_err_t 停止を確認できない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 実行中か
+     */
+    bool isRunning() const { return running_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 最新の集計取得（他タスクから呼び出し可）
+     * @param report 集計格納先
+     * @return bool 集計がある場合true
+     */
+    bool getReport(Report& report) const { return report_.read(report); }
+    
+    /**
+     * @brief 集計のログ出力（CLI用、最後に "REPLAY" 行を出す）
+     */
+    void dump() const;
+    
+    /**
+     * @brief 1フレームの処理（実行タスクを使わない場合に直接呼ぶ）
+     * @param frame リプレイフレーム
+     */
+    void process(const sensors::ReplayFrame& frame);
+    
+    /**
+     * @brief 推定器・制御器・集計の初期化（次のフレームで整列する）
+     * @param config 実行設定
+     */
+    void reset(const Config& config);
+    
+private:
+    /**
+     * @brief サイクル数の累積
+     */
+    struct Accumulator {
+        uint64_t sum;                   // 合計
+        uint32_t last;                  // 前回
+        uint32_t min;                   // 最小
+        uint32_t max;                   // 最大
+        
+        void add(uint32_t cycles);
+        void clear();
+        CycleReport report(uint32_t count) const;
+    };
+    
+    Config config_;                             // 設定
+    sensors::SensorReplay replay_;              // リプレイ入力
+    hal::UartHal* output_;                      // 出力の送り先
+    estimation::AttitudeEstimator estimator_;   // 姿勢推定器
+    estimation::ErrorStateEkf ekf_;             // EKF
+    control::CascadedPid<3> pid_;               // 姿勢制御器
+    QuadXMixer mixer_;                          // ミキサー
+    QuadXMixer::Output duty_;                   // 最新のデューティ
+    bool aligned_;                              // 整列済み
+    uint32_t previous_time_us_;                 // 前フレームの記録時刻
+    uint32_t frames_;                           // 処理したフレーム数
+    uint32_t saturated_;                        // 飽和したフレーム数
+    uint32_t hash_;                             // 出力のハッシュ
+    Accumulator estimate_cycles_;               // 推定のサイクル数
+    Accumulator control_cycles_;                // 制御のサイクル数
+    int64_t start_us_;                          // 開始時刻
+    Report scratch_;                            // 集計の作業領域（実行側のみ）
+    common::Mailbox<Report> report_;            // 公開した集計
+    uint8_t output_sequence_;                   // 出力フレームのシーケンス番号
+    TaskHandle_t task_;                         // 実行タスク
+    std::atomic<bool> running_;                 // 実行タスク実行中
+    
+    /**
+     * @brief 実行タスクの開始
+     */
+    esp_err_t startTask();
+    
+    /**
+     * @brief 集計の公開
+     */
+    void publish(esp_err_t result, bool finished);
+    
+    /**
+     * @brief 出力フレームの送信
+     */
+    void sendOutput(uint32_t time_us, uint32_t estimate_cycles, uint32_t control_cycles);
+    
+    /**
+     * @brief 実行タスク
+     */
+    static void taskEntry(void* arg);
+};
+
+} // namespace runtime
+
+#endif // REPLAY_RUNNER_HPP
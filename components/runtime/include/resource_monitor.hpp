@@ -0,0 +1,207 @@
+/*
+ * Resource Monitor
+ * 
+ * ヒープ・タスクスタックの使用量モニタ
+ * 能力別（内部RAM・DMA可能RAM）のヒープ空き・最小空き・最大ブロック・断片化と
+ * タスク毎のスタック残りの最小を周期的に計測し、CLI・テレメトリへ公開する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef RESOURCE_MONITOR_HPP
+#define RESOURCE_MONITOR_HPP
+
+#include "mailbox.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief リソースモニタクラス
+ * 
+ * 低優先度のタスクで period_ms 毎に計測し、集計（Report）をMailboxへ公開する。
+ * CONFIG_FREERTOS_USE_TRACE_FACILITY が有効な場合は全タスクを列挙し、
+ * 無効な場合は registerTask() したタスクのみ計測する。スタックサイズはFreeRTOSから
+ * 取得できないため、使用率を見たいタスクは作成時のサイズとともに登録する。
+ * ESP-IDFのスタック単位はバイトで、残りの最小（high water mark）もバイトで表す
+ */
+class ResourceMonitor {
+public:
+    static constexpr size_t MAX_TASKS = 24;         // 計測するタスク数の上限
+    static constexpr size_t NAME_SIZE = configMAX_TASK_NAME_LEN;    // タスク名
+    
+    /**
+     * @brief ヒープの種類列挙型
+     */
+    enum class Heap : uint8_t {
+        INTERNAL = 0,       // 内部RAM（MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT）
+        DMA,                // DMA可能RAM（MALLOC_CAP_DMA）
+        COUNT
+    };
+    
+    static constexpr size_t HEAP_COUNT = static_cast<size_t>(Heap::COUNT);     // ヒープの種類数
+    
+    /**
+     * @brief モニタ設定構造体
+     */
+    struct Config {
+        uint32_t period_ms = 1000;                  // 計測周期（ms）
+        uint32_t stack_warning_bytes = 512;         // スタック残りの警告閾値（バイト）
+        UBaseType_t priority = 1;                   // 計測タスクの優先度
+        uint32_t stack_size = 3072;                 // 計測タスクのスタックサイズ
+        int core = tskNO_AFFINITY;                  // 計測タスクのコア
+    };
+    
+    /**
+     * @brief ヒープ計測結果
+     */
+    struct HeapReport {
+        uint32_t total;                 // 全体（バイト）
+        uint32_t free;                  // 空き（バイト）
+        uint32_t minimum_free;          // 起動以来の空きの最小（バイト）
+        uint32_t largest_block;         // 最大空きブロック（バイト）
+        uint16_t fragmentation;         // 断片化（‰、1 - 最大ブロック / 空き）
+    };
+    
+    /**
+     * @brief タスク計測結果
+     */
+    struct TaskReport {
+        char name[NAME_SIZE];           // タスク名
+        uint32_t stack_size;            // スタックサイズ（バイト、未登録は0）
+        uint32_t stack_free;            // スタック残りの最小（バイト）
+        uint8_t priority;               // 現在の優先度
+        bool low;                       // 残りが警告閾値未満
+    };
+    
+    /**
+     * @brief 集計結果構造体
+     */
+    struct Report {
+        uint32_t time_us;                           // 計測時刻（μs、下位32bit）
+        uint32_t samples;                           // 計測回数
+        HeapReport heap[HEAP_COUNT];                // ヒープ
+        uint32_t task_count;                        // タスク数
+        uint32_t low_stack_count;                   // 残りが警告閾値未満のタスク数
+        TaskReport task[MAX_TASKS];                 // タスク
+    };
+    
+public:
+    ResourceMonitor();
+    ~ResourceMonitor();
+    
+    ResourceMonitor(const ResourceMonitor&) = delete;
+    ResourceMonitor& operator=(const ResourceMonitor&) = delete;
+    
+    /**
+     * @brief 計測タスク開始
+     * @param config モニタ設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 計測タスク開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 計測タスク停止
+     * @return esp_err_t 停止を確認できない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief タスクの登録（作成時のスタックサイズを使用率の計算に使う）
+     * @param task タスクハンドル
+     * @param stack_size 作成時のスタックサイズ（バイト）
+     * @return esp_err_t 登録数の上限を超えた場合ESP_ERR_NO_MEM
+     */
+    esp_err_t registerTask(TaskHandle_t task, uint32_t stack_size);
+    
+    /**
+     * @brief タスクの登録解除（タスクを削除する前に呼ぶ）
+     */
+    void unregisterTask(TaskHandle_t task);
+    
+    /**
+     * @brief 1回分の計測と公開（計測タスクを使わない場合に直接呼ぶ）
+     */
+    void sample();
+    
+    /**
+     * @brief 最新の集計取得（他タスクから呼び出し可）
+     * @param report 集計格納先
+     * @return bool 集計がある場合true
+     */
+    bool getReport(Report& report) const { return report_.read(report); }
+    
+    /**
+     * @brief 集計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief テレメトリのペイロード生成（TelemetryLink::registerStream()に渡す）
+     * 
+     * 1回毎にResourceMessage::TASKS件ずつタスクを巡回する
+     * @param buffer ペイロード出力先
+     * @param capacity 出力先の容量
+     * @param context ResourceMonitorのポインタ
+     * @return size_t ペイロード長（集計がない場合0）
+     */
+    static size_t fillTelemetry(uint8_t* buffer, size_t capacity, void* context);
+    
+private:
+    /**
+     * @brief 登録タスク
+     */
+    struct Registration {
+        TaskHandle_t task;              // タスクハンドル
+        uint32_t stack_size;            // スタックサイズ（バイト）
+    };
+    
+    Config config_;                             // 設定
+    Registration registered_[MAX_TASKS];        // 登録タスク（spinlock_保護）
+    size_t registered_count_;                   // 登録数（spinlock_保護）
+    portMUX_TYPE spinlock_;                     // 登録保護
+    uint32_t samples_;                          // 計測回数（計測側のみ）
+    Report scratch_;                            // 計測中の集計（計測側のみ）
+    TaskStatus_t status_[MAX_TASKS];            // タスク列挙の作業領域（計測側のみ）
+    common::Mailbox<Report> report_;            // 公開した集計
+    size_t telemetry_cursor_;                   // テレメトリで次に送るタスク
+    TaskHandle_t task_;                         // 計測タスク
+    std::atomic<bool> running_;                 // 計測タスク実行中
+    
+    /**
+     * @brief 登録されたスタックサイズ（未登録は0）
+     */
+    uint32_t registeredStackSize(TaskHandle_t task);
+    
+    /**
+     * @brief ヒープの計測
+     */
+    static void sampleHeap(uint32_t caps, HeapReport& report);
+    
+    /**
+     * @brief タスクの計測
+     */
+    void sampleTasks(Report& report);
+    
+    /**
+     * @brief 計測タスク本体
+     */
+    static void taskEntry(void* arg);
+};
+
+} // namespace runtime
+
+#endif // RESOURCE_MONITOR_HPP
@@ -0,0 +1,167 @@
+/*
+ * Task Topology
+ * 
+ * 処理段毎のコア・優先度・周期の配置表
+ * app_main.h の固定マクロの代わりに起動時に配置を選び（パラメータ task_layout）、検証してからタスクを作る
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TASK_TOPOLOGY_HPP
+#define TASK_TOPOLOGY_HPP
+
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief 処理段列挙型
+ */
+enum class Stage : uint8_t {
+    SENSOR = 0,         // IMU読み出し（起点）
+    ESTIMATION,         // 姿勢推定
+    CONTROL,            // 制御・モーター出力
+    TELEMETRY,          // テレメトリ送信
+    CLI,                // CLI（周期なし）
+    COUNT
+};
+
+/**
+ * @brief 段毎の配置
+ */
+struct StageConfig {
+    BaseType_t core;            // コア（tskNO_AFFINITYで固定なし）
+    UBaseType_t priority;       // 優先度
+    uint32_t rate_hz;           // 周期（Hz、0で周期なし）
+    uint32_t stack_size;        // スタックサイズ
+};
+
+/**
+ * @brief 配置の候補
+ */
+struct TaskLayout {
+    const char* name;                                           // 名前（CLI・ベンチマーク用）
+    StageConfig stages[static_cast<size_t>(Stage::COUNT)];      // 段毎の配置（Stageの順）
+    
+    /**
+     * @brief 段の配置取得
+     */
+    constexpr const StageConfig& stage(Stage s) const { return stages[static_cast<size_t>(s)]; }
+};
+
+/**
+ * @brief タスク配置クラス
+ * 
+ * 候補は LAYOUTS の定数表で、番号をパラメータ task_layout に保存して再起動で切り替える
+ * （再コンパイル不要）。起動時に select() で選び、validate() が通った配置の stage() で
+ * 各タスクを xTaskCreatePinnedToCore する。
+ * 0番の既定の配置は app_main.h のマクロと同じ値。
+ * Wi-Fiを使わない飛行では推定をコア1へ移す配置（1番）を TopologyBenchmark で比べて選ぶ
+ */
+class TaskTopology {
+public:
+    /**
+     * @brief 配置の候補（0番が既定）
+     */
+    static constexpr TaskLayout LAYOUTS[] = {
+        // 既定: センサー・推定はコア0、制御はコア1（app_main.hと同じ）
+        {"default", {
+            {0, configMAX_PRIORITIES - 3, 1000, 6144},      // SENSOR
+            {0, configMAX_PRIORITIES - 3, 400, 6144},       // ESTIMATION
+            {1, configMAX_PRIORITIES - 2, 400, 8192},       // CONTROL
+            {0, 5, 50, 4096},                               // TELEMETRY
+            {0, 3, 0, 4096},                                // CLI
+        }},
+        // Wi-Fiなし: 推定を制御と同じコア1へ移し、コア間の受け渡しをなくす
+        {"est_core1", {
+            {0, configMAX_PRIORITIES - 3, 1000, 6144},
+            {1, configMAX_PRIORITIES - 3, 400, 6144},
+            {1, configMAX_PRIORITIES - 2, 400, 8192},
+            {0, 5, 50, 4096},
+            {0, 3, 0, 4096},
+        }},
+        // リアルタイム段をすべてコア1へ集め、コア0は通信・CLIだけにする
+        {"rt_core1", {
+            {1, configMAX_PRIORITIES - 2, 1000, 6144},
+            {1, configMAX_PRIORITIES - 3, 400, 6144},
+            {1, configMAX_PRIORITIES - 4, 400, 8192},
+            {0, 5, 50, 4096},
+            {0, 3, 0, 4096},
+        }},
+    };
+    static constexpr size_t LAYOUT_COUNT = sizeof(LAYOUTS) / sizeof(LAYOUTS[0]);
+    
+    /**
+     * @brief 検証の前提
+     */
+    struct Options {
+        bool wifi_enabled = true;                   // Wi-Fiを使う
+        BaseType_t wifi_core = 0;                   // Wi-Fiタスクのコア（CONFIG_ESP_WIFI_TASK_CORE_ID）
+        UBaseType_t wifi_priority = 23;             // Wi-Fiタスクの優先度（ESP_TASK_WIFI_PRIO）
+    };
+    
+    /**
+     * @brief 配置の選択（起動時、タスク作成前）
+     * @param index LAYOUTS の番号
+     * @return esp_err_t 範囲外の場合ESP_ERR_INVALID_ARG（既定の配置のまま）
+     */
+    static esp_err_t select(size_t index);
+    
+    /**
+     * @brief 選択中の配置
+     */
+    static const TaskLayout& current() { return LAYOUTS[selected_]; }
+    
+    /**
+     * @brief 選択中の配置の番号
+     */
+    static size_t currentIndex() { return selected_; }
+    
+    /**
+     * @brief 選択中の配置の段
+     * @param s 段
+     */
+    static const StageConfig& stage(Stage s) { return current().stage(s); }
+    
+    /**
+     * @brief 配置の検証（起動時）
+     * 
+     * コア・優先度・周期の範囲外は誤り、同じコア上で周期の短い段の優先度が低い（レート単調の逆転）、
+     * 推定が制御より遅い、Wi-Fiタスクと同じコアでそれ以下の優先度のリアルタイム段は警告としてログに出す
+     * @param layout 配置
+     * @param options 検証の前提
+     * @param warnings 警告数の格納先（nullptr可）
+     * @return esp_err_t 誤りがある場合ESP_ERR_INVALID_ARG
+     */
+    static esp_err_t validate(const TaskLayout& layout, const Options& options, size_t* warnings = nullptr);
+    
+    /**
+     * @brief 段の名前
+     */
+    static const char* stageName(Stage s);
+    
+    /**
+     * @brief 配置のログ出力（CLI用）
+     * @param layout 配置
+     */
+    static void dump(const TaskLayout& layout);
+    
+    /**
+     * @brief 選択中の配置のログ出力（CLI用）
+     */
+    static void dump() { dump(current()); }
+    
+private:
+    static size_t selected_;                        // 選択中の番号
+};
+
+} // namespace runtime
+
+#endif // TASK_TOPOLOGY_HPP
@@ -0,0 +1,119 @@
+/*
+ * Topology Benchmark
+ * 
+ * タスク配置の候補毎のセンサー→推定→制御の遅延計測
+ * 配置通りのコア・優先度で擬似負荷の処理段を動かし、PipelineLatencyで段毎と全体の遅延を集計する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef TOPOLOGY_BENCHMARK_HPP
+#define TOPOLOGY_BENCHMARK_HPP
+
+#include "pipeline.hpp"
+#include "task_topology.hpp"
+#include "esp_err.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief タスク配置のベンチマーククラス
+ * 
+ * 地上でディスアーム中に実行する（実際の処理タスクとは別に計測用のタスクを作る）。
+ * センサー段は配置の周期で起点の時刻を打ち、推定段・制御段はそれぞれの周期に間引いて
+ * 通知で受け取り、設定した時間だけ処理を模擬してから次へ渡す。
+ * 背景負荷（Wi-Fi・テレメトリの代わり）を任意のコアで回し、配置の差が出る状況を作れる
+ */
+class TopologyBenchmark {
+public:
+    /**
+     * @brief ベンチマーク設定構造体
+     */
+    struct Config {
+        uint32_t duration_ms = 2000;                // 配置毎の計測時間（ms）
+        uint32_t sensor_work_us = 80;               // センサー段の処理時間（μs）
+        uint32_t estimation_work_us = 300;          // 推定段の処理時間（μs）
+        uint32_t control_work_us = 150;             // 制御段の処理時間（μs）
+        uint32_t load_percent = 0;                  // 背景負荷（%、0で負荷なし）
+        BaseType_t load_core = 0;                   // 背景負荷のコア
+        UBaseType_t load_priority = 23;             // 背景負荷の優先度（Wi-Fiタスク相当）
+    };
+    
+    /**
+     * @brief 配置毎の結果
+     */
+    struct Result {
+        const char* layout;                         // 配置名
+        PipelineLatency::Report report;             // 段毎（センサー→推定、推定→制御）と全体の遅延
+        uint32_t outputs;                           // 制御段の出力回数
+    };
+    
+public:
+    TopologyBenchmark();
+    
+    TopologyBenchmark(const TopologyBenchmark&) = delete;
+    TopologyBenchmark& operator=(const TopologyBenchmark&) = delete;
+    
+    /**
+     * @brief 1つの配置の計測（呼び出しタスクは計測時間の間ブロックする）
+     * @param layout 配置
+     * @param config ベンチマーク設定
+     * @param result 結果の格納先
+     * @return esp_err_t タスク作成失敗時ESP_ERR_NO_MEM、停止しない場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t run(const TaskLayout& layout, const Config& config, Result& result);
+    
+    /**
+     * @brief 全候補の計測と結果のログ出力（CLI用）
+     * @param config ベンチマーク設定
+     * @param results 結果の格納先（TaskTopology::LAYOUT_COUNT個、nullptr可）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t runAll(const Config& config, Result* results = nullptr);
+    
+private:
+    /**
+     * @brief 段の間の受け渡しデータ
+     */
+    struct Token {
+        uint32_t sequence;
+    };
+    
+    static void sensorEntry(void* arg);
+    static void estimationEntry(void* arg);
+    static void controlEntry(void* arg);
+    static void loadEntry(void* arg);
+    
+    /**
+     * @brief 指定時間の擬似処理（ビジーループ）
+     */
+    static void spin(uint32_t work_us);
+    
+    /**
+     * @brief 計測タスクの終了（動作中の数を減らして自身を削除する）
+     */
+    void exitTask();
+    
+    static const char* const HOP_NAMES[];           // 段の名前
+    
+    Config config_;                                 // 実行中の設定
+    const TaskLayout* layout_;                      // 実行中の配置
+    PipelineConsumer estimation_wake_;              // 推定段の通知
+    PipelineConsumer control_wake_;                 // 制御段の通知
+    PipelineLatest<Token> to_estimation_;           // センサー → 推定
+    PipelineLatest<Token> to_control_;              // 推定 → 制御
+    PipelineLatency latency_;                       // 遅延の集計
+    std::atomic<bool> running_;                     // 計測中
+    std::atomic<uint32_t> alive_;                   // 動作中の計測タスク数
+    std::atomic<uint32_t> outputs_;                 // 制御段の出力回数
+};
+
+} // namespace runtime
+
+#endif // TOPOLOGY_BENCHMARK_HPP
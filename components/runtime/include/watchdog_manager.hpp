@@ -0,0 +1,204 @@
+/*
+ * Watchdog Manager
+ * 
+ * タスク毎の期限付きハートビートによるソフトウェアウォッチドッグ
+ * 監視タスクが全タスクの期限を1回で確認し、違反時のみ緊急停止とハードウェアTWDTへ上げる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef WATCHDOG_MANAGER_HPP
+#define WATCHDOG_MANAGER_HPP
+
+#include "delegate.hpp"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+/**
+ * @brief ウォッチドッグ管理クラス
+ * 
+ * リアルタイムタスクは registerTask() で期限（ハートビートの最大間隔）を登録し、
+ * 毎周期 heartbeat() で時刻を1回storeする（ロック・カーネル呼び出しなし）。
+ * 監視タスクは周期毎に全スロットの最終ハートビートからの経過を期限と比べ、
+ * 違反がなければハードウェアTWDT（監視タスク1つだけを登録）をリセットする。
+ * 違反したら違反の通知（emergency_stop 等）を1回だけ呼び、どのタスクがどれだけ遅れたかを残す。
+ * escalate_to_twdt が有効ならその後TWDTのリセットを止め、ハードウェアの監視に任せる。
+ * 監視タスク自身が止まった場合もTWDTが検出する。
+ * 期限の判定は最初のハートビートから始めるため、初期化に時間がかかるタスクも登録を先にしてよい
+ */
+class WatchdogManager {
+public:
+    static constexpr size_t MAX_TASKS = 8;          // 登録できるタスク数
+    
+    /**
+     * @brief 監視設定構造体
+     */
+    struct Config {
+        uint32_t period_ms = 10;                    // 監視周期（ms）
+        UBaseType_t priority = configMAX_PRIORITIES - 1;    // 監視タスクの優先度（制御タスクより上）
+        uint32_t stack_size = 3072;                 // 監視タスクのスタックサイズ
+        int core = 0;                               // 監視タスクのコア（制御タスクと別のコア）
+        bool use_twdt = true;                       // 監視タスクをハードウェアTWDTへ登録する
+        bool escalate_to_twdt = true;               // 違反後にTWDTのリセットを止める
+    };
+    
+    /**
+     * @brief 違反の情報
+     */
+    struct Violation {
+        size_t slot;                // スロット番号
+        const char* name;           // タスク名
+        uint32_t deadline_us;       // 期限（μs）
+        uint32_t elapsed_us;        // 最終ハートビートからの経過（μs）
+    };
+    
+    /**
+     * @brief 違反の通知関数型（監視タスクから1回だけ呼び出される）
+     */
+    using ViolationCallback = common::Delegate<void(const Violation&)>;
+    
+    /**
+     * @brief タスク毎の状態
+     */
+    struct TaskReport {
+        const char* name;           // タスク名
+        uint32_t deadline_us;       // 期限（μs）
+        uint32_t beats;             // ハートビート数
+        uint32_t max_elapsed_us;    // 監視で見た最終ハートビートからの経過の最大（μs）
+        uint32_t misses;            // 期限違反を検出した監視周期の数
+        bool enabled;               // 監視中
+    };
+    
+public:
+    WatchdogManager();
+    ~WatchdogManager();
+    
+    WatchdogManager(const WatchdogManager&) = delete;
+    WatchdogManager& operator=(const WatchdogManager&) = delete;
+    
+    /**
+     * @brief タスクの登録（監視開始前・後どちらでもよい）
+     * @param name タスク名（静的な文字列）
+     * @param deadline_us 期限（ハートビートの最大間隔、μs）
+     * @param slot 割り当てたスロット番号
+     * @return esp_err_t 空きがない場合ESP_ERR_NO_MEM
+     */
+    esp_err_t registerTask(const char* name, uint32_t deadline_us, size_t& slot);
+    
+    /**
+     * @brief ハートビート（登録したタスクが毎周期呼ぶ、IRAM配置）
+     * @param slot スロット番号
+     */
+    void IRAM_ATTR heartbeat(size_t slot) {
+        Slot& s = slots_[slot];
+        s.last_beat_us.store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+        s.beats.store(s.beats.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    
+    /**
+     * @brief 監視の一時停止・再開（ディスアーム中に止めるタスク等、再開時は期限1回分の猶予）
+     * @param slot スロット番号
+     * @param enabled 監視する場合true
+     */
+    void setEnabled(size_t slot, bool enabled);
+    
+    /**
+     * @brief 違反の通知設定
+     * @param callback 通知関数
+     */
+    void setViolationCallback(ViolationCallback callback) { callback_ = callback; }
+    
+    /**
+     * @brief 監視タスク開始
+     * @param config 監視設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start(const Config& config);
+    
+    /**
+     * @brief 監視タスク開始（既定の設定）
+     */
+    esp_err_t start() { return start(Config{}); }
+    
+    /**
+     * @brief 監視タスク停止（TWDTの登録も外す）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 全スロットの確認（監視タスクから呼ばれる、テスト用に公開）
+     * @param now_us 現在時刻（μs）
+     * @return bool 違反がない場合true
+     */
+    bool check(int64_t now_us);
+    
+    /**
+     * @brief 違反済みか（ラッチ）
+     */
+    bool isTripped() const { return tripped_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 最初の違反の情報
+     * @param violation 格納先
+     * @return bool 違反済みの場合true
+     */
+    bool getViolation(Violation& violation) const;
+    
+    /**
+     * @brief タスク毎の状態取得
+     * @param slot スロット番号
+     * @param report 格納先
+     * @return bool 登録済みの場合true
+     */
+    bool getReport(size_t slot, TaskReport& report) const;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief 監視スロット
+     */
+    struct Slot {
+        const char* name;                           // タスク名（登録時のみ書く）
+        uint32_t deadline_us;                       // 期限（登録時のみ書く）
+        std::atomic<bool> enabled;                  // 監視中
+        std::atomic<uint32_t> last_beat_us;         // 最終ハートビート時刻（μs、下位32bit）
+        std::atomic<uint32_t> beats;                // ハートビート数（タスクのみ更新）
+        std::atomic<uint32_t> max_elapsed_us;       // 監視で見た経過の最大
+        std::atomic<uint32_t> misses;               // 違反した監視周期の数
+    };
+    
+    /**
+     * @brief 監視タスク
+     */
+    static void taskEntry(void* arg);
+    
+    Config config_;                                 // 監視設定
+    portMUX_TYPE spinlock_;                         // 登録の排他制御
+    Slot slots_[MAX_TASKS];                         // 監視スロット
+    std::atomic<size_t> count_;                     // 登録数（公開順）
+    ViolationCallback callback_;                    // 違反の通知
+    std::atomic<bool> tripped_;                     // 違反済み（ラッチ）
+    Violation violation_;                           // 最初の違反（tripped_の前に書く）
+    TaskHandle_t task_;                             // 監視タスク
+    std::atomic<bool> running_;                     // 監視タスク動作中フラグ
+};
+
+} // namespace runtime
+
+#endif // WATCHDOG_MANAGER_HPP
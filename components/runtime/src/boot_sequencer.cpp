@@ -0,0 +1,320 @@
+/*
+ * Boot Sequencer Implementation
+ * 
+ * 起動シーケンサ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "boot_sequencer.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::BootSequencer";
+
+namespace {
+
+constexpr TickType_t WORKER_POLL_TICKS = pdMS_TO_TICKS(5);     // 実行可能なステージがない時の待ち時間
+
+const char* stateName(BootSequencer::StageState state) {
+    switch (state) {
+        case BootSequencer::StageState::PENDING: return "未実行";
+        case BootSequencer::StageState::RUNNING: return "実行中";
+        case BootSequencer::StageState::DONE: return "完了";
+        case BootSequencer::StageState::FAILED: return "失敗";
+        case BootSequencer::StageState::SKIPPED: return "スキップ";
+    }
+    return "?";
+}
+
+} // namespace
+
+BootSequencer::BootSequencer()
+    : stage_count_(0)
+    , done_mask_(0)
+    , failed_mask_(0)
+    , busy_resources_(0)
+    , required_failed_{false, false}
+    , workers_{}
+    , waiter_(nullptr)
+    , deferred_exited_(0)
+    , deferred_done_(false)
+    , ready_time_us_(0) {
+    config_.stack_size = DEFAULT_STACK_SIZE;
+    config_.critical_priority = configMAX_PRIORITIES - 3;
+    config_.deferred_priority = tskIDLE_PRIORITY + 2;
+}
+
+esp_err_t BootSequencer::addStage(const char* name, StageFunction function, uint32_t depends, 
+                                  const StageOptions& options, size_t* index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (stage_count_ >= MAX_STAGES) {
+        ESP_LOGE(TAG, "ステージ数が上限です: %s", name);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    // 依存先は登録済みのステージのみ（登録順がそのまま位相順序になり循環しない）
+    uint32_t registered = stage_count_ == 0 ? 0 : (0xFFFFFFFFu >> (32 - stage_count_));
+    if ((depends & ~registered) != 0) {
+        ESP_LOGE(TAG, "未登録のステージに依存しています: %s", name);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (options.phase == Phase::CRITICAL) {
+        for (size_t i = 0; i < stage_count_; i++) {
+            if ((depends & dependsOn(i)) && stages_[i].options.phase == Phase::DEFERRED) {
+                ESP_LOGE(TAG, "飛行必須ステージが準備完了後ステージに依存しています: %s -> %s", name, stages_[i].name);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+    
+    Stage& stage = stages_[stage_count_];
+    stage.name = name;
+    stage.function = function;
+    stage.depends = depends;
+    stage.options = options;
+    stage.state = StageState::PENDING;
+    stage.result = ESP_OK;
+    stage.core = ANY_CORE;
+    stage.start_us = 0;
+    stage.end_us = 0;
+    
+    if (index != nullptr) {
+        *index = stage_count_;
+    }
+    stage_count_++;
+    return ESP_OK;
+}
+
+esp_err_t BootSequencer::runCritical(TickType_t timeout) {
+    waiter_ = xTaskGetCurrentTaskHandle();
+    int64_t begin_us = esp_timer_get_time();
+    
+    esp_err_t ret = startWorkers(Phase::CRITICAL, config_.critical_priority);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 各ワーカーがフェーズ完了時に1回ずつ通知する
+    TickType_t start_tick = xTaskGetTickCount();
+    for (int exited = 0; exited < portNUM_PROCESSORS; exited++) {
+        TickType_t wait = timeout;
+        if (timeout != portMAX_DELAY) {
+            TickType_t elapsed = xTaskGetTickCount() - start_tick;
+            wait = elapsed < timeout ? timeout - elapsed : 0;
+        }
+        if (ulTaskNotifyTake(pdFALSE, wait) == 0) {
+            ESP_LOGE(TAG, "飛行必須フェーズがタイムアウトしました");
+            dumpReport();
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+    
+    ready_time_us_ = esp_timer_get_time();
+    bool failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        failed = required_failed_[static_cast<int>(Phase::CRITICAL)];
+    }
+    ESP_LOGI(TAG, "飛行必須フェーズ完了 %lldms（起動から%lldms）%s", 
+             static_cast<long long>((ready_time_us_ - begin_us) / 1000), 
+             static_cast<long long>(ready_time_us_ / 1000), failed ? " 必須ステージ失敗あり" : "");
+    return failed ? ESP_FAIL : ESP_OK;
+}
+
+esp_err_t BootSequencer::startDeferred() {
+    deferred_exited_.store(0, std::memory_order_relaxed);
+    deferred_done_.store(false, std::memory_order_release);
+    return startWorkers(Phase::DEFERRED, config_.deferred_priority);
+}
+
+esp_err_t BootSequencer::getReport(size_t index, StageReport& report) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (index >= stage_count_) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    const Stage& stage = stages_[index];
+    report.name = stage.name;
+    report.phase = stage.options.phase;
+    report.state = stage.state;
+    report.result = stage.result;
+    report.core = stage.core;
+    report.start_us = stage.start_us;
+    report.end_us = stage.end_us;
+    return ESP_OK;
+}
+
+void BootSequencer::dumpReport() const {
+    ESP_LOGI(TAG, "起動ステージ（時刻は起動からのms）");
+    for (size_t i = 0; i < stage_count_; i++) {
+        StageReport report;
+        if (getReport(i, report) != ESP_OK) {
+            continue;
+        }
+        int64_t duration_us = report.end_us > report.start_us ? report.end_us - report.start_us : 0;
+        ESP_LOGI(TAG, "%2u %-16s %s コア:%d 開始:%4lld.%01lld 所要:%4lld.%01lld %s %s", 
+                 static_cast<unsigned>(i), report.name, 
+                 report.phase == Phase::CRITICAL ? "必須" : "遅延", 
+                 report.core, 
+                 static_cast<long long>(report.start_us / 1000), static_cast<long long>((report.start_us / 100) % 10), 
+                 static_cast<long long>(duration_us / 1000), static_cast<long long>((duration_us / 100) % 10), 
+                 stateName(report.state), 
+                 report.state == StageState::FAILED ? esp_err_to_name(report.result) : "");
+    }
+    if (ready_time_us_ != 0) {
+        ESP_LOGI(TAG, "準備完了: %lldms", static_cast<long long>(ready_time_us_ / 1000));
+    }
+}
+
+esp_err_t BootSequencer::startWorkers(Phase phase, UBaseType_t priority) {
+    int p = static_cast<int>(phase);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        worker_args_[p][core].self = this;
+        worker_args_[p][core].phase = phase;
+        worker_args_[p][core].core = core;
+    }
+    
+    // 互いに起こし合うため、全ワーカーのハンドルが揃ってから走らせる
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        BaseType_t created = xTaskCreatePinnedToCore(workerTask, 
+                                                     phase == Phase::CRITICAL ? "boot_crit" : "boot_defer", 
+                                                     config_.stack_size, &worker_args_[p][core], 
+                                                     priority, &workers_[p][core], core);
+        if (created != pdPASS) {
+            ESP_LOGE(TAG, "ワーカータスク作成失敗 コア:%d", core);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    return ESP_OK;
+}
+
+void BootSequencer::workerTask(void* arg) {
+    WorkerArgs* args = static_cast<WorkerArgs*>(arg);
+    BootSequencer* self = args->self;
+    int p = static_cast<int>(args->phase);
+    
+    while (true) {
+        int index;
+        bool finished;
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            index = self->takeReadyStage(args->phase, args->core, finished);
+        }
+        if (index < 0) {
+            if (finished) {
+                break;
+            }
+            // 依存先・共有リソースの解放待ち（完了したワーカーが通知で起こす）
+            ulTaskNotifyTake(pdTRUE, WORKER_POLL_TICKS);
+            continue;
+        }
+        
+        Stage& stage = self->stages_[index];
+        esp_err_t ret = stage.function ? stage.function() : ESP_OK;
+        int64_t end_us = esp_timer_get_time();
+        {
+            std::lock_guard<std::mutex> lock(self->mutex_);
+            stage.result = ret;
+            stage.end_us = end_us;
+            self->busy_resources_ &= ~stage.options.resources;
+            if (ret == ESP_OK) {
+                stage.state = StageState::DONE;
+                self->done_mask_ |= dependsOn(index);
+            } else {
+                stage.state = StageState::FAILED;
+                self->failed_mask_ |= dependsOn(index);
+                if (stage.options.required) {
+                    self->required_failed_[p] = true;
+                }
+            }
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "ステージ失敗 %s: %s", stage.name, esp_err_to_name(ret));
+        } else {
+            ESP_LOGD(TAG, "ステージ完了 %s %lldus", stage.name, static_cast<long long>(end_us - stage.start_us));
+        }
+        self->wakeWorkers(args->phase, args->core);
+    }
+    
+    // フェーズ完了（ハンドルを消してから、待機中のもう一方に終了判定させる）
+    {
+        std::lock_guard<std::mutex> lock(self->mutex_);
+        self->workers_[p][args->core] = nullptr;
+    }
+    self->wakeWorkers(args->phase, args->core);
+    if (args->phase == Phase::CRITICAL) {
+        xTaskNotifyGive(self->waiter_);
+    } else if (self->deferred_exited_.fetch_add(1, std::memory_order_acq_rel) + 1 == portNUM_PROCESSORS) {
+        self->deferred_done_.store(true, std::memory_order_release);
+        ESP_LOGI(TAG, "準備完了後フェーズ完了 %lldms", static_cast<long long>(esp_timer_get_time() / 1000));
+    }
+    vTaskDelete(nullptr);
+}
+
+int BootSequencer::takeReadyStage(Phase phase, int core, bool& finished) {
+    finished = true;
+    for (size_t i = 0; i < stage_count_; i++) {
+        Stage& stage = stages_[i];
+        if (stage.options.phase != phase) {
+            continue;
+        }
+        if (stage.state == StageState::RUNNING) {
+            finished = false;
+            continue;
+        }
+        if (stage.state != StageState::PENDING) {
+            continue;
+        }
+        
+        // 依存先が失敗・スキップ済みなら実行しない（依存先は常に前方なので1回の走査で伝播する）
+        if ((stage.depends & failed_mask_) != 0) {
+            stage.state = StageState::SKIPPED;
+            stage.result = ESP_ERR_INVALID_STATE;
+            failed_mask_ |= dependsOn(i);
+            if (stage.options.required) {
+                required_failed_[static_cast<int>(phase)] = true;
+            }
+            ESP_LOGW(TAG, "依存先の失敗によりスキップ: %s", stage.name);
+            continue;
+        }
+        
+        finished = false;
+        if ((stage.depends & ~done_mask_) != 0) {
+            continue;
+        }
+        // 存在しないコアの指定はコア指定なしとして扱う（シングルコア構成）
+        if (stage.options.core != ANY_CORE && stage.options.core < portNUM_PROCESSORS && stage.options.core != core) {
+            continue;
+        }
+        if ((stage.options.resources & busy_resources_) != 0) {
+            continue;
+        }
+        
+        stage.state = StageState::RUNNING;
+        stage.core = core;
+        stage.start_us = esp_timer_get_time();
+        busy_resources_ |= stage.options.resources;
+        return static_cast<int>(i);
+    }
+    return -1;
+}
+
+void BootSequencer::wakeWorkers(Phase phase, int core) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int p = static_cast<int>(phase);
+    for (int other = 0; other < portNUM_PROCESSORS; other++) {
+        if (other != core && workers_[p][other] != nullptr) {
+            xTaskNotifyGive(workers_[p][other]);
+        }
+    }
+}
+
+} // namespace runtime
@@ -0,0 +1,297 @@
+/*
+ * CPU Profiler Implementation
+ * 
+ * タスク別・コア別のCPU使用率プロファイラ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "cpu_profiler.hpp"
+#include "isr_time.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <algorithm>
+#include <cstring>
+
+namespace runtime {
+
+static const char* TAG = "runtime::CpuProfiler";
+
+/**
+ * @brief 実行時間を窓の長さに対する‰へ換算（1000で飽和）
+ */
+static uint16_t perMille(uint64_t part, uint64_t whole) {
+    if (whole == 0) {
+        return 0;
+    }
+    uint64_t value = part * 1000 / whole;
+    return static_cast<uint16_t>(value > 1000 ? 1000 : value);
+}
+
+CpuProfiler::CpuProfiler()
+    : config_()
+    , slots_{}
+    , window_history_{}
+    , isr_history_{}
+    , last_isr_cycles_{}
+    , last_isr_count_{}
+    , last_total_(0)
+    , window_index_(0)
+    , windows_(0)
+    , primed_(false)
+    , status_{}
+    , scratch_{}
+    , task_(nullptr)
+    , running_(false) {}
+
+CpuProfiler::~CpuProfiler() {
+    stop();
+}
+
+esp_err_t CpuProfiler::start(const Config& config) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_USE_TRACE_FACILITY
+    if (config.window_ms == 0 || config.history_windows == 0 || config.history_windows > MAX_WINDOWS
+        || config.cpu_mhz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    config_ = config;
+    primed_ = false;
+    windows_ = 0;
+    window_index_ = 0;
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "cpu_prof", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        ESP_LOGE(TAG, "計測タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+#else
+    (void)config;
+    ESP_LOGE(TAG, "CONFIG_FREERTOS_GENERATE_RUN_TIME_STATSが無効");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t CpuProfiler::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 計測タスクは1窓以内にtask_を消して自分を削除する
+    for (uint32_t waited = 0; waited <= config_.window_ms + 100 && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return task_ == nullptr ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+CpuProfiler::Slot* CpuProfiler::findSlot(TaskHandle_t task) {
+    Slot* empty = nullptr;
+    for (size_t i = 0; i < MAX_TASKS; i++) {
+        if (slots_[i].task == task) {
+            return &slots_[i];
+        }
+        if (empty == nullptr && slots_[i].task == nullptr) {
+            empty = &slots_[i];
+        }
+    }
+    return empty;
+}
+
+uint64_t CpuProfiler::historySum(const uint32_t* history) const {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < windows_; i++) {
+        sum += history[i];
+    }
+    return sum;
+}
+
+void CpuProfiler::sample() {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS && CONFIG_FREERTOS_USE_TRACE_FACILITY
+    uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+    // 配列が全タスク数より小さい場合は0が返る
+    UBaseType_t listed_count = uxTaskGetSystemState(status_, MAX_TASKS, nullptr);
+    if (listed_count == 0) {
+        ESP_LOGW(TAG, "タスク数が%lu超", static_cast<unsigned long>(MAX_TASKS));
+        return;
+    }
+    uint32_t isr_cycles[CORE_COUNT];
+    uint32_t isr_count[CORE_COUNT];
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        isr_cycles[core] = common::IsrTime::cycles(core);
+        isr_count[core] = common::IsrTime::count(core);
+    }
+    
+    if (!primed_) {
+        // 初回は前回値のみ記録する
+        for (size_t i = 0; i < MAX_TASKS; i++) {
+            slots_[i] = Slot{};
+        }
+        for (UBaseType_t i = 0; i < listed_count; i++) {
+            Slot* slot = findSlot(status_[i].xHandle);
+            if (slot != nullptr) {
+                slot->task = status_[i].xHandle;
+                slot->last_counter = static_cast<uint32_t>(status_[i].ulRunTimeCounter);
+            }
+        }
+        memcpy(last_isr_cycles_, isr_cycles, sizeof(last_isr_cycles_));
+        memcpy(last_isr_count_, isr_count, sizeof(last_isr_count_));
+        last_total_ = now;
+        primed_ = true;
+        return;
+    }
+    
+    // カウンタは一周するので符号なしの差分を取る
+    size_t index = window_index_;
+    uint32_t elapsed = now - last_total_;
+    last_total_ = now;
+    window_history_[index] = elapsed;
+    windows_ = std::min(windows_ + 1, config_.history_windows);
+    window_index_ = (index + 1) % config_.history_windows;
+    
+    Report& report = scratch_;
+    memset(&report, 0, sizeof(report));
+    report.time_us = now;
+    report.window_us = elapsed;
+    report.windows = static_cast<uint32_t>(windows_);
+    uint64_t elapsed_sum = historySum(window_history_);
+    
+    for (size_t i = 0; i < MAX_TASKS; i++) {
+        slots_[i].seen = false;
+    }
+    uint32_t idle[CORE_COUNT] = {};
+    uint64_t idle_sum[CORE_COUNT] = {};
+    bool idle_found[CORE_COUNT] = {};
+    size_t count = 0;
+    for (UBaseType_t i = 0; i < listed_count; i++) {
+        const TaskStatus_t& status = status_[i];
+        Slot* slot = findSlot(status.xHandle);
+        if (slot == nullptr) {
+            continue;
+        }
+        uint32_t counter = static_cast<uint32_t>(status.ulRunTimeCounter);
+        uint32_t delta = 0;
+        if (slot->task == status.xHandle) {
+            delta = counter - slot->last_counter;
+        } else {
+            // 前回の計測以降に作成されたタスク（同じハンドルの作り直しは区別しない）
+            *slot = Slot{};
+            slot->task = status.xHandle;
+            delta = counter;
+        }
+        slot->last_counter = counter;
+        slot->history[index] = delta;
+        slot->seen = true;
+        uint64_t delta_sum = historySum(slot->history);
+        
+        int8_t core = ANY_CORE;
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        if (status.xCoreID >= 0 && status.xCoreID < static_cast<BaseType_t>(CORE_COUNT)) {
+            core = static_cast<int8_t>(status.xCoreID);
+        }
+#endif
+        if (strncmp(status.pcTaskName, "IDLE", 4) == 0) {
+            // IDLEタスクは各コアに固定される（名前の末尾がコア番号）
+            if (core == ANY_CORE) {
+                char last = status.pcTaskName[strnlen(status.pcTaskName, NAME_SIZE) - 1];
+                core = (last >= '0' && last < static_cast<char>('0' + CORE_COUNT)) ? static_cast<int8_t>(last - '0') : ANY_CORE;
+            }
+            if (core != ANY_CORE) {
+                idle[core] += delta;
+                idle_sum[core] += delta_sum;
+                idle_found[core] = true;
+            }
+        }
+        
+        TaskReport& task = report.task[count++];
+        size_t length = strnlen(status.pcTaskName, NAME_SIZE - 1);
+        memcpy(task.name, status.pcTaskName, length);
+        task.core = core;
+        task.priority = static_cast<uint8_t>(status.uxCurrentPriority);
+        task.load = perMille(delta, elapsed);
+        task.load_average = perMille(delta_sum, elapsed_sum);
+    }
+    // 削除されたタスクの記録を空ける
+    for (size_t i = 0; i < MAX_TASKS; i++) {
+        if (slots_[i].task != nullptr && !slots_[i].seen) {
+            slots_[i] = Slot{};
+        }
+    }
+    report.task_count = static_cast<uint32_t>(count);
+    std::sort(report.task, report.task + count, [](const TaskReport& a, const TaskReport& b) {
+        return a.load > b.load;
+    });
+    
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        CoreReport& core_report = report.core[core];
+        if (idle_found[core]) {
+            core_report.load = static_cast<uint16_t>(1000 - perMille(idle[core], elapsed));
+            core_report.load_average = static_cast<uint16_t>(1000 - perMille(idle_sum[core], elapsed_sum));
+        }
+        isr_history_[core][index] = isr_cycles[core] - last_isr_cycles_[core];
+        core_report.isr = perMille(isr_history_[core][index], static_cast<uint64_t>(elapsed) * config_.cpu_mhz);
+        core_report.isr_average = perMille(historySum(isr_history_[core]), elapsed_sum * config_.cpu_mhz);
+        core_report.isr_count = isr_count[core] - last_isr_count_[core];
+        last_isr_cycles_[core] = isr_cycles[core];
+        last_isr_count_[core] = isr_count[core];
+    }
+    report_.write(report);
+#endif
+}
+
+void CpuProfiler::dump() const {
+    Report report;
+    if (!getReport(report)) {
+        ESP_LOGI(TAG, "計測なし");
+        return;
+    }
+    ESP_LOGI(TAG, "窓 %lu ms（移動区間 %lu 窓）タスク %lu", static_cast<unsigned long>(report.window_us / 1000), 
+             static_cast<unsigned long>(report.windows), static_cast<unsigned long>(report.task_count));
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        const CoreReport& core_report = report.core[core];
+        ESP_LOGI(TAG, "  コア%u 負荷 %u.%u%%（平均 %u.%u%%）割り込み %u.%u%%（平均 %u.%u%%、%lu 回）", 
+                 static_cast<unsigned>(core), 
+                 static_cast<unsigned>(core_report.load / 10), static_cast<unsigned>(core_report.load % 10), 
+                 static_cast<unsigned>(core_report.load_average / 10), static_cast<unsigned>(core_report.load_average % 10), 
+                 static_cast<unsigned>(core_report.isr / 10), static_cast<unsigned>(core_report.isr % 10), 
+                 static_cast<unsigned>(core_report.isr_average / 10), static_cast<unsigned>(core_report.isr_average % 10), 
+                 static_cast<unsigned long>(core_report.isr_count));
+    }
+    for (size_t i = 0; i < report.task_count; i++) {
+        const TaskReport& task = report.task[i];
+        char core[4] = "-";
+        if (task.core != ANY_CORE) {
+            core[0] = static_cast<char>('0' + task.core);
+        }
+        ESP_LOGI(TAG, "  %-16s コア %s 優先度 %2u 使用率 %3u.%u%%（平均 %3u.%u%%）", task.name, core, 
+                 static_cast<unsigned>(task.priority), 
+                 static_cast<unsigned>(task.load / 10), static_cast<unsigned>(task.load % 10), 
+                 static_cast<unsigned>(task.load_average / 10), static_cast<unsigned>(task.load_average % 10));
+    }
+}
+
+void CpuProfiler::taskEntry(void* arg) {
+    CpuProfiler* self = static_cast<CpuProfiler*>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->config_.window_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->sample();
+        vTaskDelayUntil(&last_wake, period);
+    }
+    
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+} // namespace runtime
@@ -0,0 +1,191 @@
+/*
+ * Fault Recorder Implementation
+ * 
+ * RTC_NOINITメモリ上の障害記録リング実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "fault_recorder.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstring>
+
+namespace runtime {
+
+static const char* TAG = "runtime::FaultRecorder";
+
+RTC_NOINIT_ATTR FaultRecorder::Region FaultRecorder::rtc_region_;
+
+namespace {
+
+/**
+ * @brief 異常なリセットか（記録を調べる価値があるもの）
+ */
+bool isCrash(esp_reset_reason_t reason) {
+    switch (reason) {
+    case ESP_RST_PANIC:
+    case ESP_RST_INT_WDT:
+    case ESP_RST_TASK_WDT:
+    case ESP_RST_WDT:
+    case ESP_RST_BROWNOUT:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char* resetName(esp_reset_reason_t reason) {
+    switch (reason) {
+    case ESP_RST_POWERON:   return "電源投入";
+    case ESP_RST_EXT:       return "外部リセット";
+    case ESP_RST_SW:        return "ソフトウェア";
+    case ESP_RST_PANIC:     return "パニック";
+    case ESP_RST_INT_WDT:   return "割り込みWDT";
+    case ESP_RST_TASK_WDT:  return "タスクWDT";
+    case ESP_RST_WDT:       return "WDT";
+    case ESP_RST_DEEPSLEEP: return "ディープスリープ";
+    case ESP_RST_BROWNOUT:  return "ブラウンアウト";
+    default:                return "不明";
+    }
+}
+
+uint32_t retained(uint32_t head, size_t capacity) {
+    return head < capacity ? head : static_cast<uint32_t>(capacity);
+}
+
+} // namespace
+
+FaultRecorder& FaultRecorder::instance() {
+    static FaultRecorder recorder;
+    return recorder;
+}
+
+FaultRecorder::FaultRecorder()
+    : recording_(false)
+    , recovery_{} {}
+
+bool FaultRecorder::regionValid() const {
+    const Region& r = rtc_region_;
+    return r.magic == MAGIC && r.version == VERSION && r.size == sizeof(Region) && r.check == (MAGIC ^ r.session);
+}
+
+esp_err_t FaultRecorder::recover() {
+    recording_.store(false, std::memory_order_release);
+    recovery_ = {};
+    recovery_.reset_reason = esp_reset_reason();
+    recovery_.crashed = isCrash(recovery_.reset_reason);
+    if (recovery_.reset_reason == ESP_RST_POWERON || !regionValid()) {
+        // 電源投入時のRTCメモリは不定（識別子が偶然一致しても使わない）
+        ESP_LOGI(TAG, "前回の記録なし（%s）", resetName(recovery_.reset_reason));
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    recovery_.valid = true;
+    recovery_.session = rtc_region_.session;
+    recovery_.snapshots = retained(rtc_region_.snapshot_head, SNAPSHOT_COUNT);
+    recovery_.events = retained(rtc_region_.event_head, EVENT_COUNT);
+    if (recovery_.snapshots > 0) {
+        const uint32_t last = rtc_region_.snapshot_head - 1;
+        recovery_.last_time_ms = rtc_region_.snapshots[last & (SNAPSHOT_COUNT - 1)].time_ms;
+    }
+    if (recovery_.crashed) {
+        ESP_LOGW(TAG, "異常リセット（%s）: セッション %lu スナップショット %lu イベント %lu を保持", 
+                 resetName(recovery_.reset_reason), static_cast<unsigned long>(recovery_.session), 
+                 static_cast<unsigned long>(recovery_.snapshots), static_cast<unsigned long>(recovery_.events));
+    } else {
+        ESP_LOGI(TAG, "前回の記録を保持（%s）: セッション %lu", resetName(recovery_.reset_reason), 
+                 static_cast<unsigned long>(recovery_.session));
+    }
+    return ESP_OK;
+}
+
+void FaultRecorder::begin() {
+    recording_.store(false, std::memory_order_release);
+    const uint32_t session = regionValid() ? rtc_region_.session + 1 : 1;
+    memset(&rtc_region_, 0, sizeof(rtc_region_));
+    rtc_region_.magic = MAGIC;
+    rtc_region_.version = VERSION;
+    rtc_region_.size = static_cast<uint16_t>(sizeof(Region));
+    rtc_region_.session = session;
+    rtc_region_.check = MAGIC ^ session;
+    recovery_.valid = false;
+    recording_.store(true, std::memory_order_release);
+    event(Event::SESSION_START, 0, static_cast<uint32_t>(esp_timer_get_time() / 1000));
+}
+
+size_t FaultRecorder::forEachSnapshot(SnapshotVisitor visitor, void* context) const {
+    if (!regionValid()) {
+        return 0;
+    }
+    const uint32_t head = rtc_region_.snapshot_head;
+    const uint32_t count = retained(head, SNAPSHOT_COUNT);
+    for (uint32_t i = head - count; i != head; i++) {
+        visitor(rtc_region_.snapshots[i & (SNAPSHOT_COUNT - 1)], context);
+    }
+    return count;
+}
+
+size_t FaultRecorder::forEachEvent(EventVisitor visitor, void* context) const {
+    if (!regionValid()) {
+        return 0;
+    }
+    const uint32_t head = rtc_region_.event_head;
+    const uint32_t count = retained(head, EVENT_COUNT);
+    for (uint32_t i = head - count; i != head; i++) {
+        visitor(rtc_region_.events[i & (EVENT_COUNT - 1)], context);
+    }
+    return count;
+}
+
+const char* FaultRecorder::eventName(Event code) {
+    switch (code) {
+    case Event::SESSION_START:  return "開始";
+    case Event::ARM:            return "アーム";
+    case Event::DISARM:         return "ディスアーム";
+    case Event::MODE_CHANGE:    return "モード変更";
+    case Event::FAILSAFE:       return "フェイルセーフ";
+    case Event::EMERGENCY_STOP: return "緊急停止";
+    case Event::WATCHDOG:       return "WDT違反";
+    case Event::LOOP_OVERRUN:   return "周期超過";
+    case Event::BATTERY_LOW:    return "低電圧";
+    case Event::SENSOR_FAULT:   return "センサー異常";
+    case Event::USER:           return "ユーザー";
+    default:                    return "不明";
+    }
+}
+
+void FaultRecorder::dump(size_t max_snapshots) const {
+    if (!regionValid()) {
+        ESP_LOGI(TAG, "記録なし（リセット要因: %s）", resetName(recovery_.reset_reason));
+        return;
+    }
+    ESP_LOGI(TAG, "セッション %lu %s リセット要因: %s%s", static_cast<unsigned long>(rtc_region_.session), 
+             isRecording() ? "記録中" : "保持", resetName(recovery_.reset_reason), 
+             recovery_.valid && recovery_.crashed ? "（この記録の直後に異常リセット）" : "");
+    
+    forEachEvent([](const EventRecord& e, void*) {
+        ESP_LOGI(TAG, "  %8lu ms %-12s %u", static_cast<unsigned long>(e.time_ms), eventName(e.code), 
+                 static_cast<unsigned>(e.value));
+    }, nullptr);
+    
+    const uint32_t head = rtc_region_.snapshot_head;
+    uint32_t count = retained(head, SNAPSHOT_COUNT);
+    if (count > max_snapshots) {
+        count = static_cast<uint32_t>(max_snapshots);
+    }
+    ESP_LOGI(TAG, "  時刻ms     roll  pitch    yaw     p     q     r   m1    m2    m3    m4  thr  alt  mV  mode");
+    for (uint32_t i = head - count; i != head; i++) {
+        const Snapshot& s = rtc_region_.snapshots[i & (SNAPSHOT_COUNT - 1)];
+        ESP_LOGI(TAG, "  %8lu %6.3f %6.3f %6.3f %5.2f %5.2f %5.2f %5u %5u %5u %5u %5u %4d %5u %u/%02x", 
+                 static_cast<unsigned long>(s.time_ms), s.attitude[0] / 10000.0f, s.attitude[1] / 10000.0f, 
+                 s.attitude[2] / 10000.0f, s.rates[0] / 1000.0f, s.rates[1] / 1000.0f, s.rates[2] / 1000.0f, 
+                 s.motors[0], s.motors[1], s.motors[2], s.motors[3], s.throttle, s.altitude_cm, s.battery_mv, 
+                 s.mode, s.flags);
+    }
+}
+
+} // namespace runtime
@@ -0,0 +1,189 @@
+/*
+ * Heap Guard Implementation
+ * 
+ * 飛行中のヒープ使用の検出実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "heap_guard.hpp"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "sdkconfig.h"
+#include <cstring>
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "esp_debug_helpers.h"
+#endif
+
+namespace runtime {
+
+static const char* TAG = "runtime::HeapGuard";
+
+std::atomic<bool> HeapGuard::active_{false};
+HeapGuard::Policy HeapGuard::policy_ = HeapGuard::Policy::COUNT;
+HeapGuard::Stats HeapGuard::stats_ = {};
+HeapGuard::Site HeapGuard::sites_[MAX_SITES] = {};
+size_t HeapGuard::site_count_ = 0;
+portMUX_TYPE HeapGuard::spinlock_ = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief 呼び出し元のバックトレース取得（自身・onAllocate・フックの段は飛ばす）
+ */
+static void IRAM_ATTR captureBacktrace(uint32_t (&pc)[HeapGuard::BACKTRACE_DEPTH]) {
+    memset(pc, 0, sizeof(pc));
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    esp_backtrace_frame_t frame = {};
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+    for (size_t skip = 0; skip < 2 && frame.next_pc != 0; skip++) {
+        if (!esp_backtrace_get_next_frame(&frame)) {
+            return;
+        }
+    }
+    for (size_t i = 0; i < HeapGuard::BACKTRACE_DEPTH && frame.next_pc != 0; i++) {
+        if (!esp_backtrace_get_next_frame(&frame)) {
+            break;
+        }
+        pc[i] = esp_cpu_process_stack_pc(frame.pc);
+    }
+#endif
+}
+
+esp_err_t HeapGuard::enterFlightMode(Policy policy) {
+#if CONFIG_HEAP_USE_HOOKS
+    portENTER_CRITICAL(&spinlock_);
+    policy_ = policy;
+    stats_.sessions++;
+    portEXIT_CRITICAL(&spinlock_);
+    active_.store(true, std::memory_order_release);
+    return ESP_OK;
+#else
+    (void)policy;
+    ESP_LOGW(TAG, "CONFIG_HEAP_USE_HOOKS が無効（監視なし）");
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void HeapGuard::exitFlightMode() {
+    active_.store(false, std::memory_order_release);
+}
+
+void IRAM_ATTR HeapGuard::onAllocate(size_t size) {
+    if (!active_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (policy_ == Policy::TRAP) {
+        esp_system_abort("飛行モード中のヒープ確保");
+    }
+    
+    uint32_t pc[BACKTRACE_DEPTH];
+    captureBacktrace(pc);
+    bool in_isr = xPortInIsrContext();
+    
+    portENTER_CRITICAL_SAFE(&spinlock_);
+    stats_.allocations++;
+    stats_.bytes += static_cast<uint32_t>(size);
+    if (in_isr) {
+        stats_.isr_allocations++;
+    }
+    Site* site = nullptr;
+    for (size_t i = 0; i < site_count_; i++) {
+        if (memcmp(sites_[i].pc, pc, sizeof(pc)) == 0) {
+            site = &sites_[i];
+            break;
+        }
+    }
+    if (site == nullptr && site_count_ < MAX_SITES) {
+        site = &sites_[site_count_++];
+        memcpy(site->pc, pc, sizeof(pc));
+    }
+    if (site != nullptr) {
+        site->count++;
+        site->bytes += static_cast<uint32_t>(size);
+        if (size > site->max_size) {
+            site->max_size = static_cast<uint32_t>(size);
+        }
+    } else {
+        stats_.untracked++;
+    }
+    portEXIT_CRITICAL_SAFE(&spinlock_);
+}
+
+void IRAM_ATTR HeapGuard::onFree() {
+    if (!active_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    portENTER_CRITICAL_SAFE(&spinlock_);
+    stats_.frees++;
+    portEXIT_CRITICAL_SAFE(&spinlock_);
+}
+
+HeapGuard::Stats HeapGuard::getStats() {
+    portENTER_CRITICAL(&spinlock_);
+    Stats stats = stats_;
+    portEXIT_CRITICAL(&spinlock_);
+    return stats;
+}
+
+size_t HeapGuard::getSites(Site* sites, size_t max_sites) {
+    portENTER_CRITICAL(&spinlock_);
+    size_t count = site_count_ < max_sites ? site_count_ : max_sites;
+    memcpy(sites, sites_, count * sizeof(Site));
+    portEXIT_CRITICAL(&spinlock_);
+    return count;
+}
+
+void HeapGuard::reset() {
+    portENTER_CRITICAL(&spinlock_);
+    uint32_t sessions = stats_.sessions;
+    stats_ = Stats{};
+    stats_.sessions = sessions;
+    memset(sites_, 0, sizeof(sites_));
+    site_count_ = 0;
+    portEXIT_CRITICAL(&spinlock_);
+}
+
+void HeapGuard::dump() {
+    // ログ出力自体が確保する場合があるため、記録の写しを取ってから出力する
+    Stats stats = getStats();
+    Site sites[MAX_SITES];
+    size_t count = getSites(sites, MAX_SITES);
+    
+    ESP_LOGI(TAG, "%s 方針 %s 確保 %lu（%lu バイト、ISR %lu） 解放 %lu 未記録 %lu 飛行回数 %lu", 
+             inFlightMode() ? "飛行モード" : "地上", policy_ == Policy::TRAP ? "停止" : "計数", 
+             static_cast<unsigned long>(stats.allocations), static_cast<unsigned long>(stats.bytes), 
+             static_cast<unsigned long>(stats.isr_allocations), static_cast<unsigned long>(stats.frees), 
+             static_cast<unsigned long>(stats.untracked), static_cast<unsigned long>(stats.sessions));
+    for (size_t i = 0; i < count; i++) {
+        const Site& site = sites[i];
+        ESP_LOGI(TAG, "  [%u] %lu 回 %lu バイト（最大 %lu） 0x%08lx 0x%08lx 0x%08lx 0x%08lx 0x%08lx 0x%08lx", 
+                 static_cast<unsigned>(i), static_cast<unsigned long>(site.count), 
+                 static_cast<unsigned long>(site.bytes), static_cast<unsigned long>(site.max_size), 
+                 static_cast<unsigned long>(site.pc[0]), static_cast<unsigned long>(site.pc[1]), 
+                 static_cast<unsigned long>(site.pc[2]), static_cast<unsigned long>(site.pc[3]), 
+                 static_cast<unsigned long>(site.pc[4]), static_cast<unsigned long>(site.pc[5]));
+    }
+}
+
+} // namespace runtime
+
+#if CONFIG_HEAP_USE_HOOKS
+
+// ヒープコンポーネントの弱宣言を上書きする（ISRからも呼ばれるためIRAMに置く）
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+    (void)ptr;
+    (void)caps;
+    runtime::HeapGuard::onAllocate(size);
+}
+
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+    (void)ptr;
+    runtime::HeapGuard::onFree();
+}
+
+#endif
@@ -0,0 +1,219 @@
+/*
+ * Loop Monitor Implementation
+ * 
+ * 制御ループの処理時間予算モニタ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "loop_monitor.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::LoopMonitor";
+
+void LoopMonitor::Accumulator::clear() {
+    last = 0;
+    window_sum = 0;
+    window_max = 0;
+    previous_window_max = 0;
+    max = 0;
+}
+
+void LoopMonitor::Accumulator::add(uint32_t cycles) {
+    last = cycles;
+    window_sum += cycles;
+    if (cycles > window_max) {
+        window_max = cycles;
+    }
+    if (cycles > max) {
+        max = cycles;
+    }
+}
+
+void LoopMonitor::Accumulator::rollWindow() {
+    previous_window_max = window_max;
+    window_max = 0;
+    window_sum = 0;
+}
+
+LoopMonitor::StageReport LoopMonitor::Accumulator::report(uint32_t window_count) const {
+    StageReport result;
+    result.last = last;
+    result.average = window_count > 0 ? static_cast<uint32_t>(window_sum / window_count) : 0;
+    result.moving_max = window_max > previous_window_max ? window_max : previous_window_max;
+    result.max = max;
+    return result;
+}
+
+LoopMonitor::LoopMonitor() {
+    setConfig(Config{});
+}
+
+void LoopMonitor::setConfig(const Config& config) {
+    config_ = config;
+    if (config_.window_cycles == 0) {
+        config_.window_cycles = 1;
+    }
+    budget_cycles_ = static_cast<uint32_t>(static_cast<float>(config_.period_us) * static_cast<float>(config_.cpu_mhz)
+                                           * config_.budget_ratio);
+    reset();
+}
+
+void LoopMonitor::reset() {
+    for (auto& stage : stages_) {
+        stage.clear();
+    }
+    total_.clear();
+    for (auto& bin : histogram_) {
+        bin = 0;
+    }
+    cycle_start_ = 0;
+    stage_start_ = 0;
+    cycles_ = 0;
+    window_count_ = 0;
+    overruns_ = 0;
+    consecutive_overruns_ = 0;
+    max_consecutive_overruns_ = 0;
+    clean_cycles_ = 0;
+    action_ = Action::NONE;
+}
+
+void LoopMonitor::beginCycle() {
+    cycle_start_ = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    stage_start_ = cycle_start_;
+}
+
+void LoopMonitor::endStage(Stage stage) {
+    uint32_t now = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    stages_[static_cast<size_t>(stage)].add(now - stage_start_);
+    stage_start_ = now;
+}
+
+LoopMonitor::Action LoopMonitor::endCycle() {
+    uint32_t elapsed = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - cycle_start_;
+    total_.add(elapsed);
+    cycles_++;
+    window_count_++;
+    
+    // 周期に対する使用率の分布（予算ではなく周期全体が基準）
+    uint32_t period_cycles = config_.period_us * config_.cpu_mhz;
+    uint32_t bin = period_cycles > 0 ? static_cast<uint32_t>((static_cast<uint64_t>(elapsed) * 10) / period_cycles) : 0;
+    histogram_[bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS - 1]++;
+    
+    if (elapsed > budget_cycles_) {
+        overruns_++;
+        consecutive_overruns_++;
+        clean_cycles_ = 0;
+        if (consecutive_overruns_ > max_consecutive_overruns_) {
+            max_consecutive_overruns_ = consecutive_overruns_;
+        }
+        if (config_.escalate_after > 0 && consecutive_overruns_ >= config_.escalate_after) {
+            setAction(Action::EMERGENCY_STOP);
+        } else if (action_ != Action::EMERGENCY_STOP) {
+            setAction(config_.policy);
+        }
+    } else {
+        consecutive_overruns_ = 0;
+        clean_cycles_++;
+        // 緊急停止はラッチし、reset()まで解除しない
+        if (action_ != Action::NONE && action_ != Action::EMERGENCY_STOP && clean_cycles_ >= config_.recovery_cycles) {
+            setAction(Action::NONE);
+        }
+    }
+    
+    if (window_count_ >= config_.window_cycles) {
+        publish();
+        for (auto& stage : stages_) {
+            stage.rollWindow();
+        }
+        total_.rollWindow();
+        window_count_ = 0;
+    }
+    return action_;
+}
+
+void LoopMonitor::setAction(Action action) {
+    if (action == action_) {
+        return;
+    }
+    action_ = action;
+    if (callback_) {
+        callback_(action);
+    }
+}
+
+void LoopMonitor::publish() {
+    Report report;
+    report.cycles = cycles_;
+    report.budget_cycles = budget_cycles_;
+    report.overruns = overruns_;
+    report.max_consecutive_overruns = max_consecutive_overruns_;
+    report.action = action_;
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        report.stage[i] = stages_[i].report(window_count_);
+    }
+    report.total = total_.report(window_count_);
+    for (size_t i = 0; i < HISTOGRAM_BINS; i++) {
+        report.histogram[i] = histogram_[i];
+    }
+    report_.write(report);
+}
+
+const char* LoopMonitor::actionName(Action action) {
+    switch (action) {
+        case Action::NONE:              return "NONE";
+        case Action::SKIP_LOW_RATE:     return "SKIP_LOW_RATE";
+        case Action::DEGRADE_ESTIMATOR: return "DEGRADE_ESTIMATOR";
+        case Action::EMERGENCY_STOP:    return "EMERGENCY_STOP";
+    }
+    return "UNKNOWN";
+}
+
+const char* LoopMonitor::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::SENSOR_READ:    return "sensor";
+        case Stage::ESTIMATE:       return "estimate";
+        case Stage::CONTROL:        return "control";
+        case Stage::MIX:            return "mix";
+        case Stage::OUTPUT:         return "output";
+        case Stage::COUNT:          break;
+    }
+    return "unknown";
+}
+
+void LoopMonitor::dump() const {
+    Report report;
+    if (!getReport(report)) {
+        ESP_LOGI(TAG, "集計なし");
+        return;
+    }
+    
+    float us_per_cycle = 1.0f / static_cast<float>(config_.cpu_mhz);
+    ESP_LOGI(TAG, "周期 %lu回 予算 %.1fμs 超過 %lu回（最大連続 %lu） 動作 %s", 
+             static_cast<unsigned long>(report.cycles), report.budget_cycles * us_per_cycle, 
+             static_cast<unsigned long>(report.overruns), static_cast<unsigned long>(report.max_consecutive_overruns), 
+             actionName(report.action));
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        const StageReport& s = report.stage[i];
+        ESP_LOGI(TAG, "  %-8s 平均 %7.1fμs 移動最悪 %7.1fμs 最大 %7.1fμs", stageName(static_cast<Stage>(i)), 
+                 s.average * us_per_cycle, s.moving_max * us_per_cycle, s.max * us_per_cycle);
+    }
+    ESP_LOGI(TAG, "  %-8s 平均 %7.1fμs 移動最悪 %7.1fμs 最大 %7.1fμs", "total", 
+             report.total.average * us_per_cycle, report.total.moving_max * us_per_cycle, 
+             report.total.max * us_per_cycle);
+    ESP_LOGI(TAG, "  使用率分布 0-10%%:%lu 10-:%lu 20-:%lu 30-:%lu 40-:%lu 50-:%lu 60-:%lu 70-:%lu 80-:%lu 90-:%lu 100%%超:%lu", 
+             static_cast<unsigned long>(report.histogram[0]), static_cast<unsigned long>(report.histogram[1]), 
+             static_cast<unsigned long>(report.histogram[2]), static_cast<unsigned long>(report.histogram[3]), 
+             static_cast<unsigned long>(report.histogram[4]), static_cast<unsigned long>(report.histogram[5]), 
+             static_cast<unsigned long>(report.histogram[6]), static_cast<unsigned long>(report.histogram[7]), 
+             static_cast<unsigned long>(report.histogram[8]), static_cast<unsigned long>(report.histogram[9]), 
+             static_cast<unsigned long>(report.histogram[10]));
+}
+
+} // namespace runtime
@@ -0,0 +1,268 @@
+/*
+ * PC Sampler Implementation
+ * 
+ * タイマ割り込みによるプログラムカウンタのサンプリングプロファイラ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "pc_sampler.hpp"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <cstring>
+
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "esp_cpu.h"
+#include "esp_debug_helpers.h"
+#endif
+
+namespace runtime {
+
+static const char* TAG = "runtime::PcSampler";
+
+static constexpr uint32_t TIMER_RESOLUTION_HZ = 1000000;        // タイマ分解能（1μs）
+static constexpr uint32_t SETUP_STACK_SIZE = 3072;              // セットアップタスクのスタックサイズ
+static constexpr uint32_t SETUP_TIMEOUT_MS = 1000;              // セットアップの待ち時間
+
+PcSampler::PcSampler()
+    : config_()
+    , channel_{}
+    , running_(false) {
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        channel_[core].owner = this;
+    }
+}
+
+PcSampler::~PcSampler() {
+    stop();
+    clear();
+}
+
+esp_err_t PcSampler::start(const Config& config) {
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    if (config.period_us == 0 || config.capacity == 0 || (config.core_mask & ((1u << CORE_COUNT) - 1)) == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+#if !CONFIG_FREERTOS_INTERRUPT_BACKTRACE
+    ESP_LOGW(TAG, "CONFIG_FREERTOS_INTERRUPT_BACKTRACEが無効のため割り込まれた位置まで辿れません");
+#endif
+    clear();
+    config_ = config;
+    
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        if ((config_.core_mask & (1u << core)) == 0) {
+            continue;
+        }
+        // ISRから書き込むため内部RAMに置く
+        Channel& channel = channel_[core];
+        channel.buffer = static_cast<Sample*>(heap_caps_calloc(config_.capacity, sizeof(Sample), 
+                                                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        if (channel.buffer == nullptr) {
+            ESP_LOGE(TAG, "バッファ確保失敗（コア%u %lu バイト）", static_cast<unsigned>(core), 
+                     static_cast<unsigned long>(config_.capacity * sizeof(Sample)));
+            release();
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    
+    running_.store(true, std::memory_order_release);
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        if ((config_.core_mask & (1u << core)) == 0) {
+            continue;
+        }
+        // 割り込みはタイマのコールバック登録を呼んだコアで確保される
+        Setup setup = {&channel_[core], config_.period_us, xTaskGetCurrentTaskHandle(), ESP_FAIL};
+        if (xTaskCreatePinnedToCore(setupEntry, "pcs_setup", SETUP_STACK_SIZE, &setup, 
+                                    uxTaskPriorityGet(nullptr), nullptr, static_cast<BaseType_t>(core)) != pdPASS) {
+            setup.result = ESP_ERR_NO_MEM;
+        } else if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SETUP_TIMEOUT_MS)) == 0) {
+            // タスクがsetupを参照したまま戻れないため、待ち続ける
+            ESP_LOGE(TAG, "コア%uのセットアップ応答なし", static_cast<unsigned>(core));
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        if (setup.result != ESP_OK) {
+            ESP_LOGE(TAG, "コア%uのタイマ設定失敗: %s", static_cast<unsigned>(core), esp_err_to_name(setup.result));
+            stop();
+            return setup.result;
+        }
+    }
+    ESP_LOGI(TAG, "サンプリング開始 周期 %lu us コア 0x%x バッファ %lu サンプル", 
+             static_cast<unsigned long>(config_.period_us), static_cast<unsigned>(config_.core_mask), 
+             static_cast<unsigned long>(config_.capacity));
+    return ESP_OK;
+#else
+    (void)config;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void PcSampler::setupEntry(void* arg) {
+    Setup* setup = static_cast<Setup*>(arg);
+    Channel& channel = *setup->channel;
+    
+    gptimer_config_t timer_config = {};
+    timer_config.clk_src = GPTIMER_CLK_SRC_DEFAULT;
+    timer_config.direction = GPTIMER_COUNT_UP;
+    timer_config.resolution_hz = TIMER_RESOLUTION_HZ;
+    esp_err_t ret = gptimer_new_timer(&timer_config, &channel.timer);
+    if (ret == ESP_OK) {
+        gptimer_event_callbacks_t cbs = {};
+        cbs.on_alarm = alarmCallback;
+        ret = gptimer_register_event_callbacks(channel.timer, &cbs, &channel);
+    }
+    if (ret == ESP_OK) {
+        ret = gptimer_enable(channel.timer);
+    }
+    if (ret == ESP_OK) {
+        gptimer_alarm_config_t alarm_config = {};
+        alarm_config.alarm_count = setup->period_us;
+        alarm_config.reload_count = 0;
+        alarm_config.flags.auto_reload_on_alarm = 1;
+        ret = gptimer_set_alarm_action(channel.timer, &alarm_config);
+    }
+    if (ret == ESP_OK) {
+        ret = gptimer_start(channel.timer);
+    }
+    
+    setup->result = ret;
+    TaskHandle_t waiter = setup->waiter;
+    xTaskNotifyGive(waiter);
+    vTaskDelete(nullptr);
+}
+
+esp_err_t PcSampler::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    esp_err_t result = ESP_OK;
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        Channel& channel = channel_[core];
+        if (channel.timer == nullptr) {
+            continue;
+        }
+        // 停止していないタイマのdisableは失敗するため、stopの結果は見ない
+        gptimer_stop(channel.timer);
+        esp_err_t ret = gptimer_disable(channel.timer);
+        if (ret == ESP_OK || ret == ESP_ERR_INVALID_STATE) {
+            ret = gptimer_del_timer(channel.timer);
+        }
+        if (ret != ESP_OK) {
+            result = ret;
+        }
+        channel.timer = nullptr;
+    }
+    return result;
+}
+
+void PcSampler::release() {
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        Channel& channel = channel_[core];
+        heap_caps_free(channel.buffer);
+        channel.buffer = nullptr;
+        channel.samples.store(0, std::memory_order_relaxed);
+        channel.truncated.store(0, std::memory_order_relaxed);
+    }
+}
+
+void PcSampler::clear() {
+    if (running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    release();
+}
+
+PcSampler::Stats PcSampler::getStats(size_t core) const {
+    Stats stats = {};
+    if (core >= CORE_COUNT) {
+        return stats;
+    }
+    const Channel& channel = channel_[core];
+    stats.samples = channel.samples.load(std::memory_order_acquire);
+    stats.stored = channel.buffer == nullptr ? 0
+        : static_cast<uint32_t>(stats.samples < config_.capacity ? stats.samples : config_.capacity);
+    stats.truncated = channel.truncated.load(std::memory_order_relaxed);
+    return stats;
+}
+
+esp_err_t PcSampler::read(size_t core, size_t index, Sample& sample) const {
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    Stats stats = getStats(core);
+    if (index >= stats.stored) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // 満杯後は最も古いサンプルが次の書き込み位置にある
+    uint32_t oldest = stats.samples - stats.stored;
+    sample = channel_[core].buffer[(oldest + index) % config_.capacity];
+    return ESP_OK;
+}
+
+void PcSampler::dump() const {
+    if (running_.load(std::memory_order_acquire)) {
+        ESP_LOGW(TAG, "サンプリング中は出力できません");
+        return;
+    }
+    ESP_LOGI(TAG, "PCS_BEGIN %lu %lu", static_cast<unsigned long>(config_.period_us), 
+             static_cast<unsigned long>(FRAME_DEPTH));
+    for (size_t core = 0; core < CORE_COUNT; core++) {
+        Stats stats = getStats(core);
+        if (stats.stored == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "コア%u サンプル %lu（保持 %lu 途切れ %lu）", static_cast<unsigned>(core), 
+                 static_cast<unsigned long>(stats.samples), static_cast<unsigned long>(stats.stored), 
+                 static_cast<unsigned long>(stats.truncated));
+        for (size_t i = 0; i < stats.stored; i++) {
+            Sample sample;
+            read(core, i, sample);
+            ESP_LOGI(TAG, "PCS %u %08lx %08lx %08lx %08lx", static_cast<unsigned>(core), 
+                     static_cast<unsigned long>(sample.pc[0]), static_cast<unsigned long>(sample.pc[1]), 
+                     static_cast<unsigned long>(sample.pc[2]), static_cast<unsigned long>(sample.pc[3]));
+        }
+    }
+    ESP_LOGI(TAG, "PCS_END");
+}
+
+static_assert(PcSampler::FRAME_DEPTH == 4, "dump()の出力形式を合わせること");
+
+bool IRAM_ATTR PcSampler::alarmCallback(gptimer_handle_t timer, const gptimer_alarm_event_data_t* edata, void* user_ctx) {
+    (void)timer;
+    (void)edata;
+    Channel* channel = static_cast<Channel*>(user_ctx);
+    const Config& config = channel->owner->config_;
+    uint32_t index = channel->samples.load(std::memory_order_relaxed);
+    Sample& sample = channel->buffer[index % config.capacity];
+    memset(&sample, 0, sizeof(sample));
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    // 先頭はこの関数。skip_frames 段上がった次の段が割り込まれた位置
+    esp_backtrace_frame_t frame = {};
+    esp_backtrace_get_start(&frame.pc, &frame.sp, &frame.next_pc);
+    bool complete = true;
+    // 浅いスタックは途中で終わる（記録のない段は0）
+    for (size_t skip = 0; skip < config.skip_frames && complete; skip++) {
+        complete = frame.next_pc != 0 && esp_backtrace_get_next_frame(&frame);
+    }
+    for (size_t i = 0; i < FRAME_DEPTH && complete; i++) {
+        complete = frame.next_pc != 0 && esp_backtrace_get_next_frame(&frame);
+        if (complete) {
+            sample.pc[i] = esp_cpu_process_stack_pc(frame.pc);
+        }
+    }
+    if (sample.pc[0] == 0) {
+        channel->truncated.fetch_add(1, std::memory_order_relaxed);
+    }
+#endif
+    channel->samples.store(index + 1, std::memory_order_release);
+    return false;
+}
+
+} // namespace runtime
@@ -0,0 +1,119 @@
+/*
+ * Pipeline Implementation
+ * 
+ * タスク間パイプラインの遅延計測実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "pipeline.hpp"
+#include "esp_log.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::Pipeline";
+
+namespace {
+
+constexpr int64_t MAX_LATENCY_US = UINT32_MAX >> 4;    // 平均×16が32bitに収まる上限（約268秒）
+
+} // namespace
+
+void PipelineLatency::Accumulator::add(int64_t latency_us) {
+    // 時計の前後（コア間の読み出し順）で負になった分は0とする
+    const uint32_t value = static_cast<uint32_t>(latency_us <= 0 ? 0 : (latency_us > MAX_LATENCY_US ? MAX_LATENCY_US : latency_us));
+    const uint32_t n = count.load(std::memory_order_relaxed);
+    uint32_t average = average_x16.load(std::memory_order_relaxed);
+    if (n == 0) {
+        average = value << 4;
+    } else {
+        average = average + value - (average >> 4);
+    }
+    average_x16.store(average, std::memory_order_relaxed);
+    last_us.store(value, std::memory_order_relaxed);
+    if (value > max_us.load(std::memory_order_relaxed)) {
+        max_us.store(value, std::memory_order_relaxed);
+    }
+    count.store(n + 1, std::memory_order_relaxed);
+}
+
+void PipelineLatency::Accumulator::clear() {
+    count.store(0, std::memory_order_relaxed);
+    last_us.store(0, std::memory_order_relaxed);
+    max_us.store(0, std::memory_order_relaxed);
+    average_x16.store(0, std::memory_order_relaxed);
+}
+
+PipelineLatency::Series PipelineLatency::Accumulator::get() const {
+    Series series;
+    series.count = count.load(std::memory_order_relaxed);
+    series.last_us = last_us.load(std::memory_order_relaxed);
+    series.average_us = average_x16.load(std::memory_order_relaxed) >> 4;
+    series.max_us = max_us.load(std::memory_order_relaxed);
+    return series;
+}
+
+PipelineLatency::PipelineLatency(const char* const* hop_names, size_t hop_count)
+    : hop_names_(hop_names)
+    , hop_count_(hop_count < MAX_HOPS ? hop_count : MAX_HOPS)
+    , last_sequence_(0)
+    , sequence_valid_(false)
+    , stat_lost_(0) {
+    reset();
+}
+
+void PipelineLatency::recordHop(size_t hop, const PipelineStamp& stamp, int64_t now_us) {
+    if (hop < hop_count_) {
+        hops_[hop].add(now_us - stamp.publish_us);
+    }
+}
+
+void PipelineLatency::recordOutput(const PipelineStamp& stamp, int64_t now_us) {
+    end_to_end_.add(now_us - stamp.sample_us);
+    if (sequence_valid_ && stamp.sequence != last_sequence_ + 1) {
+        const uint32_t gap = stamp.sequence - last_sequence_ - 1;
+        if (gap < 0x80000000u) {
+            stat_lost_.fetch_add(gap, std::memory_order_relaxed);
+        }
+    }
+    last_sequence_ = stamp.sequence;
+    sequence_valid_ = true;
+}
+
+PipelineLatency::Report PipelineLatency::getReport() const {
+    Report report = {};
+    for (size_t i = 0; i < hop_count_; i++) {
+        report.hop[i] = hops_[i].get();
+    }
+    report.end_to_end = end_to_end_.get();
+    report.lost = stat_lost_.load(std::memory_order_relaxed);
+    return report;
+}
+
+void PipelineLatency::reset() {
+    for (size_t i = 0; i < MAX_HOPS; i++) {
+        hops_[i].clear();
+    }
+    end_to_end_.clear();
+    stat_lost_.store(0, std::memory_order_relaxed);
+}
+
+void PipelineLatency::dump() const {
+    const Report report = getReport();
+    for (size_t i = 0; i < hop_count_; i++) {
+        const Series& s = report.hop[i];
+        ESP_LOGI(TAG, "%-12s 受け渡し 直近 %luμs 平均 %luμs 最大 %luμs (%lu回)", hop_names_[i], 
+                 static_cast<unsigned long>(s.last_us), static_cast<unsigned long>(s.average_us), 
+                 static_cast<unsigned long>(s.max_us), static_cast<unsigned long>(s.count));
+    }
+    const Series& e = report.end_to_end;
+    ESP_LOGI(TAG, "サンプル→出力 直近 %luμs 平均 %luμs 最大 %luμs (%lu回) 欠落 %lu", 
+             static_cast<unsigned long>(e.last_us), static_cast<unsigned long>(e.average_us), 
+             static_cast<unsigned long>(e.max_us), static_cast<unsigned long>(e.count), 
+             static_cast<unsigned long>(report.lost));
+}
+
+} // namespace runtime
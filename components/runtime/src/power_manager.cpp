@@ -0,0 +1,206 @@
+/*
+ * Power Manager Implementation
+ * 
+ * 動的周波数切替と自動ライトスリープによる電源管理実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "power_manager.hpp"
+#include "flash_guard.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cstdio>
+
+namespace runtime {
+
+static const char* TAG = "runtime::PowerManager";
+
+PowerManager::PowerManager()
+    : config_()
+    , active_(false)
+    , cpu_lock_(nullptr)
+    , sleep_lock_(nullptr)
+    , awake_lock_(nullptr)
+    , flight_(false)
+    , awake_(false)
+    , flight_sessions_(0)
+    , last_switch_us_(0)
+    , max_switch_us_(0)
+    , awake_holds_(0) {}
+
+PowerManager::~PowerManager() {
+    stop();
+}
+
+esp_err_t PowerManager::start(const Config& config) {
+    if (active_) {
+        return ESP_OK;
+    }
+    if (config.min_freq_mhz <= 0 || config.min_freq_mhz > config.max_freq_mhz) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config_ = config;
+    
+    esp_pm_config_t pm_config = {};
+    pm_config.max_freq_mhz = config_.max_freq_mhz;
+    pm_config.min_freq_mhz = config_.min_freq_mhz;
+    pm_config.light_sleep_enable = config_.light_sleep;
+    esp_err_t ret = esp_pm_configure(&pm_config);
+    if (ret == ESP_ERR_NOT_SUPPORTED && config_.light_sleep) {
+        // ティックレスアイドルが無効なビルドでは周波数切替のみ使う
+        ESP_LOGW(TAG, "自動ライトスリープ非対応のため周波数切替のみ使用");
+        config_.light_sleep = false;
+        pm_config.light_sleep_enable = false;
+        ret = esp_pm_configure(&pm_config);
+    }
+    if (ret == ESP_ERR_NOT_SUPPORTED) {
+        ESP_LOGW(TAG, "電源管理が無効なビルドです（CONFIG_PM_ENABLE）");
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "電源管理設定失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    ret = esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "flight_cpu", &cpu_lock_);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "flight_sleep", &sleep_lock_);
+    }
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "awake", &awake_lock_);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "電源管理ロック作成失敗: %s", esp_err_to_name(ret));
+        deleteLocks();
+        return ret;
+    }
+    
+    active_ = true;
+    ESP_LOGI(TAG, "電源管理開始 %d〜%dMHz ライトスリープ:%s", config_.min_freq_mhz, config_.max_freq_mhz, 
+             config_.light_sleep ? "有効" : "無効");
+    return ESP_OK;
+}
+
+esp_err_t PowerManager::stop() {
+    exitFlightMode();
+    if (!active_) {
+        return ESP_OK;
+    }
+    holdAwake(false);
+    deleteLocks();
+    active_ = false;
+    
+    // 最大周波数固定へ戻す（以降はロックなしで常に全速）
+    esp_pm_config_t pm_config = {};
+    pm_config.max_freq_mhz = config_.max_freq_mhz;
+    pm_config.min_freq_mhz = config_.max_freq_mhz;
+    pm_config.light_sleep_enable = false;
+    return esp_pm_configure(&pm_config);
+}
+
+void PowerManager::deleteLocks() {
+    esp_pm_lock_handle_t* locks[] = {&cpu_lock_, &sleep_lock_, &awake_lock_};
+    for (esp_pm_lock_handle_t* lock : locks) {
+        if (*lock != nullptr) {
+            esp_pm_lock_delete(*lock);
+            *lock = nullptr;
+        }
+    }
+}
+
+esp_err_t PowerManager::enterFlightMode() {
+    if (flight_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // フラッシュの書き込み・消去を止め、実行中の書き込み（セクタ消去等）が終わるのを待つ
+    common::FlashGuard& flash = common::FlashGuard::instance();
+    if (!flash.enterRealtime(pdMS_TO_TICKS(config_.flash_drain_ms))) {
+        flash.exitRealtime();
+        flight_.store(false, std::memory_order_release);
+        ESP_LOGE(TAG, "フラッシュ書き込みが %lums 以内に終わらない", static_cast<unsigned long>(config_.flash_drain_ms));
+        return ESP_ERR_TIMEOUT;
+    }
+    if (!active_) {
+        return ESP_OK;
+    }
+    // ロック取得時に周波数が切り替わるため、戻った時点で最大周波数になっている
+    const int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = esp_pm_lock_acquire(sleep_lock_);
+    if (ret == ESP_OK) {
+        ret = esp_pm_lock_acquire(cpu_lock_);
+        if (ret != ESP_OK) {
+            esp_pm_lock_release(sleep_lock_);
+        }
+    }
+    if (ret != ESP_OK) {
+        flash.exitRealtime();
+        flight_.store(false, std::memory_order_release);
+        ESP_LOGE(TAG, "飛行モードのロック取得失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    const uint32_t elapsed = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    last_switch_us_.store(elapsed, std::memory_order_relaxed);
+    if (elapsed > max_switch_us_.load(std::memory_order_relaxed)) {
+        max_switch_us_.store(elapsed, std::memory_order_relaxed);
+    }
+    flight_sessions_.fetch_add(1, std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+esp_err_t PowerManager::exitFlightMode() {
+    if (!flight_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 後回しにしたフラッシュ書き込みは書き込み側の次の周期で行われる
+    common::FlashGuard::instance().exitRealtime();
+    if (!active_) {
+        return ESP_OK;
+    }
+    esp_pm_lock_release(cpu_lock_);
+    return esp_pm_lock_release(sleep_lock_);
+}
+
+esp_err_t PowerManager::holdAwake(bool hold) {
+    if (!active_) {
+        return ESP_OK;
+    }
+    if (awake_.exchange(hold, std::memory_order_acq_rel) == hold) {
+        return ESP_OK;
+    }
+    if (!hold) {
+        return esp_pm_lock_release(awake_lock_);
+    }
+    awake_holds_.fetch_add(1, std::memory_order_relaxed);
+    return esp_pm_lock_acquire(awake_lock_);
+}
+
+PowerManager::Stats PowerManager::getStats() const {
+    Stats stats;
+    stats.flight_sessions = flight_sessions_.load(std::memory_order_relaxed);
+    stats.last_switch_us = last_switch_us_.load(std::memory_order_relaxed);
+    stats.max_switch_us = max_switch_us_.load(std::memory_order_relaxed);
+    stats.awake_holds = awake_holds_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void PowerManager::dump() const {
+    if (!active_) {
+        ESP_LOGI(TAG, "電源管理停止中（常に最大周波数）");
+        return;
+    }
+    const Stats stats = getStats();
+    ESP_LOGI(TAG, "%s%s %d〜%dMHz ライトスリープ:%s", isFlightMode() ? "飛行モード" : "待機", 
+             awake_.load(std::memory_order_relaxed) ? "（スリープ禁止中）" : "", 
+             config_.min_freq_mhz, config_.max_freq_mhz, config_.light_sleep ? "有効" : "無効");
+    ESP_LOGI(TAG, "飛行 %lu回 切替 直近 %luμs 最大 %luμs", static_cast<unsigned long>(stats.flight_sessions), 
+             static_cast<unsigned long>(stats.last_switch_us), static_cast<unsigned long>(stats.max_switch_us));
+    // ロック毎の保持状況（CONFIG_PM_PROFILINGで保持時間も出る）
+    esp_pm_dump_locks(stdout);
+}
+
+} // namespace runtime
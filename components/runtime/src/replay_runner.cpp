@@ -0,0 +1,342 @@
+/*
+ * Replay Runner Implementation
+ * 
+ * 記録済みセンサー値による推定・制御のHILリプレイ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "replay_runner.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace runtime {
+
+static const char* TAG = "runtime::ReplayRunner";
+
+namespace {
+
+constexpr uint32_t FNV_OFFSET = 2166136261u;    // FNV-1a 32bitの初期値
+constexpr uint32_t FNV_PRIME = 16777619u;       // FNV-1a 32bitの乗数
+
+/**
+ * @brief floatのビット列をハッシュへ連鎖（-0.0とNaNのビット列も区別する）
+ */
+inline uint32_t hashFloats(uint32_t hash, const float* values, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &values[i], sizeof(bits));
+        for (size_t b = 0; b < 4; b++) {
+            hash ^= (bits >> (8 * b)) & 0xFF;
+            hash *= FNV_PRIME;
+        }
+    }
+    return hash;
+}
+
+} // namespace
+
+void ReplayRunner::Accumulator::add(uint32_t cycles) {
+    last = cycles;
+    sum += cycles;
+    if (cycles < min) {
+        min = cycles;
+    }
+    if (cycles > max) {
+        max = cycles;
+    }
+}
+
+void ReplayRunner::Accumulator::clear() {
+    sum = 0;
+    last = 0;
+    min = UINT32_MAX;
+    max = 0;
+}
+
+ReplayRunner::CycleReport ReplayRunner::Accumulator::report(uint32_t count) const {
+    CycleReport result;
+    result.last = last;
+    result.average = count > 0 ? static_cast<uint32_t>(sum / count) : 0;
+    result.min = count > 0 ? min : 0;
+    result.max = max;
+    return result;
+}
+
+ReplayRunner::ReplayRunner()
+    : config_()
+    , replay_()
+    , output_(nullptr)
+    , estimator_()
+    , ekf_()
+    , pid_()
+    , mixer_()
+    , duty_{}
+    , aligned_(false)
+    , previous_time_us_(0)
+    , frames_(0)
+    , saturated_(0)
+    , hash_(FNV_OFFSET)
+    , estimate_cycles_{}
+    , control_cycles_{}
+    , start_us_(0)
+    , scratch_{}
+    , report_()
+    , output_sequence_(0)
+    , task_(nullptr)
+    , running_(false) {}
+
+ReplayRunner::~ReplayRunner() {
+    stop();
+}
+
+void ReplayRunner::reset(const Config& config) {
+    config_ = config;
+    config_.pid.sample_hz = config.control_hz;
+    estimator_.setConfig(config_.estimator);
+    estimator_.reset();
+    ekf_.setConfig(config_.ekf);
+    pid_.setConfig(config_.pid);
+    mixer_.setConfig(config_.mixer);
+    duty_ = {};
+    aligned_ = false;
+    previous_time_us_ = 0;
+    frames_ = 0;
+    saturated_ = 0;
+    hash_ = FNV_OFFSET;
+    estimate_cycles_.clear();
+    control_cycles_.clear();
+    start_us_ = esp_timer_get_time();
+    output_sequence_ = 0;
+    scratch_ = Report{};
+}
+
+esp_err_t ReplayRunner::startPartition(const storage::PartitionLog& log, const Config& config, hal::UartHal* output) {
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = replay_.openPartition(log, config.replay);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    reset(config);
+    output_ = output;
+    return startTask();
+}
+
+esp_err_t ReplayRunner::startUart(hal::UartHal& uart, const Config& config) {
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = replay_.openUart(uart, config.replay);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    reset(config);
+    output_ = &uart;
+    return startTask();
+}
+
+esp_err_t ReplayRunner::startTask() {
+    running_.store(true, std::memory_order_release);
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "replay", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        replay_.close();
+        ESP_LOGE(TAG, "実行タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t ReplayRunner::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 実行タスクは受信待ちの上限以内にtask_を消して自分を削除する
+    uint32_t limit_ms = config_.replay.uart_timeout_ms + 100;
+    for (uint32_t waited = 0; waited <= limit_ms && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return task_ != nullptr ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+void ReplayRunner::process(const sensors::ReplayFrame& frame) {
+    if (!aligned_) {
+        // 記録先頭の加速度で重力方向へ整列（ヨーは0）
+        estimator_.alignToGravity(frame.accel[0], frame.accel[1], frame.accel[2]);
+        float altitude = (frame.flags & sensors::ReplayFrame::FLAG_RANGE) ? frame.range : 0.0f;
+        ekf_.reset(estimator_.getQuaternion(), altitude);
+        pid_.reset();
+        aligned_ = true;
+        previous_time_us_ = frame.time_us;
+        scratch_.first_time_us = frame.time_us;
+    }
+    
+    // 時刻差分が0や記録の欠落で大きく外れた場合は公称周期を使う
+    const float nominal_dt = 1.0f / config_.control_hz;
+    float dt = static_cast<float>(frame.time_us - previous_time_us_) * 1e-6f;
+    if (dt <= 0.0f || dt > 4.0f * nominal_dt) {
+        dt = nominal_dt;
+    }
+    previous_time_us_ = frame.time_us;
+    
+    // 推定
+    uint32_t start = esp_cpu_get_cycle_count();
+    estimator_.update(&frame.gyro[0], &frame.gyro[1], &frame.gyro[2], 
+                      &frame.accel[0], &frame.accel[1], &frame.accel[2], 1, dt);
+    ekf_.predict(frame.gyro[0], frame.gyro[1], frame.gyro[2], frame.accel[0], frame.accel[1], frame.accel[2], dt);
+    if (frame.flags & sensors::ReplayFrame::FLAG_RANGE) {
+        ekf_.fuseTofRange(frame.range);
+    }
+    if (frame.flags & sensors::ReplayFrame::FLAG_FLOW) {
+        ekf_.fuseOpticalFlow(frame.flow[0], frame.flow[1]);
+    }
+    uint32_t estimated = esp_cpu_get_cycle_count();
+    
+    // 制御（角度は推定値、角速度はバイアスを除いたジャイロ値）
+    estimation::EulerAngles euler = estimator_.getEulerAngles();
+    float bx = 0.0f;
+    float by = 0.0f;
+    float bz = 0.0f;
+    estimator_.getGyroBias(bx, by, bz);
+    float angle_target[3] = {
+        frame.setpoint[0] * config_.max_angle,
+        frame.setpoint[1] * config_.max_angle,
+        frame.setpoint[2] * config_.max_angle
+    };
+    float angle[3] = {euler.roll, euler.pitch, euler.yaw};
+    float rate[3] = {frame.gyro[0] - bx, frame.gyro[1] - by, frame.gyro[2] - bz};
+    // ヨーは ±π の折り返しを跨がないよう誤差を正規化してから目標に戻す
+    float yaw_error = std::remainder(angle_target[2] - angle[2], 2.0f * static_cast<float>(M_PI));
+    angle_target[2] = angle[2] + yaw_error;
+    float torque[3];
+    pid_.compute(angle_target, angle, rate, torque);
+    control::MixerCommand command = {torque[0], torque[1], torque[2], frame.setpoint[3]};
+    uint8_t saturation = mixer_.mix(command, duty_);
+    uint32_t controlled = esp_cpu_get_cycle_count();
+    
+    uint32_t estimate_cycles = estimated - start;
+    uint32_t control_cycles = controlled - estimated;
+    estimate_cycles_.add(estimate_cycles);
+    control_cycles_.add(control_cycles);
+    frames_++;
+    saturated_ += saturation != 0 ? 1 : 0;
+    
+    const estimation::Quaternion& q = estimator_.getQuaternion();
+    float quaternion[4] = {q.w, q.x, q.y, q.z};
+    hash_ = hashFloats(hash_, quaternion, 4);
+    hash_ = hashFloats(hash_, duty_.data(), duty_.size());
+    
+    if (output_ != nullptr) {
+        sendOutput(frame.time_us, estimate_cycles, control_cycles);
+    }
+    if (config_.report_frames > 0 && frames_ % config_.report_frames == 0) {
+        publish(ESP_OK, false);
+    }
+}
+
+void ReplayRunner::sendOutput(uint32_t time_us, uint32_t estimate_cycles, uint32_t control_cycles) {
+    communication::ReplayOutputMessage message;
+    const estimation::Quaternion& q = estimator_.getQuaternion();
+    message.time_us = time_us;
+    message.quaternion[0] = q.w;
+    message.quaternion[1] = q.x;
+    message.quaternion[2] = q.y;
+    message.quaternion[3] = q.z;
+    for (size_t i = 0; i < 4; i++) {
+        message.duty[i] = duty_[i];
+    }
+    message.estimate_cycles = estimate_cycles;
+    message.control_cycles = control_cycles;
+    message.output_hash = hash_;
+    
+    uint8_t buffer[communication::MAX_FRAME_SIZE];
+    size_t length = communication::encodeFrame(buffer, sizeof(buffer), communication::ReplayOutputMessage::ID, 
+                                               output_sequence_++, &message, sizeof(message));
+    if (length > 0) {
+        output_->write(buffer, length);
+    }
+}
+
+void ReplayRunner::publish(esp_err_t result, bool finished) {
+    Report& report = scratch_;
+    report.frames = frames_;
+    report.last_time_us = previous_time_us_;
+    report.elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - start_us_);
+    report.estimate = estimate_cycles_.report(frames_);
+    report.control = control_cycles_.report(frames_);
+    report.output_hash = hash_;
+    report.saturated = saturated_;
+    const estimation::Quaternion& q = estimator_.getQuaternion();
+    report.quaternion[0] = q.w;
+    report.quaternion[1] = q.x;
+    report.quaternion[2] = q.y;
+    report.quaternion[3] = q.z;
+    for (size_t i = 0; i < 4; i++) {
+        report.duty[i] = duty_[i];
+    }
+    report.result = result;
+    report.finished = finished;
+    report_.write(report);
+}
+
+void ReplayRunner::dump() const {
+    Report report;
+    if (!report_.read(report)) {
+        ESP_LOGI(TAG, "集計なし");
+        return;
+    }
+    replay_.dump();
+    ESP_LOGI(TAG, "%s: %lu フレーム（記録 %lu ms、実行 %lu ms） 飽和 %lu", 
+             report.finished ? esp_err_to_name(report.result) : "実行中", 
+             static_cast<unsigned long>(report.frames), 
+             static_cast<unsigned long>((report.last_time_us - report.first_time_us) / 1000), 
+             static_cast<unsigned long>(report.elapsed_us / 1000), static_cast<unsigned long>(report.saturated));
+    ESP_LOGI(TAG, "推定 平均 %lu 最小 %lu 最大 %lu サイクル", 
+             static_cast<unsigned long>(report.estimate.average), static_cast<unsigned long>(report.estimate.min), 
+             static_cast<unsigned long>(report.estimate.max));
+    ESP_LOGI(TAG, "制御 平均 %lu 最小 %lu 最大 %lu サイクル", 
+             static_cast<unsigned long>(report.control.average), static_cast<unsigned long>(report.control.min), 
+             static_cast<unsigned long>(report.control.max));
+    // 比較しやすいよう1行にまとめる（ハッシュが同じなら全フレームの出力がビット一致）
+    printf("REPLAY frames=%lu hash=%08lx est_avg=%lu est_max=%lu ctl_avg=%lu ctl_max=%lu\n", 
+           static_cast<unsigned long>(report.frames), static_cast<unsigned long>(report.output_hash), 
+           static_cast<unsigned long>(report.estimate.average), static_cast<unsigned long>(report.estimate.max), 
+           static_cast<unsigned long>(report.control.average), static_cast<unsigned long>(report.control.max));
+}
+
+void ReplayRunner::taskEntry(void* arg) {
+    ReplayRunner* self = static_cast<ReplayRunner*>(arg);
+    esp_err_t result = ESP_OK;
+    sensors::ReplayFrame frame;
+    while (self->running_.load(std::memory_order_acquire)) {
+        result = self->replay_.next(frame);
+        if (result == ESP_ERR_TIMEOUT) {
+            continue;      // 受信待ち（停止要求を確認する）
+        }
+        if (result != ESP_OK) {
+            break;
+        }
+        self->process(frame);
+    }
+    self->publish(result, true);
+    self->replay_.close();
+    ESP_LOGI(TAG, "リプレイ終了: %lu フレーム hash=%08lx", static_cast<unsigned long>(self->frames_), 
+             static_cast<unsigned long>(self->hash_));
+    self->running_.store(false, std::memory_order_release);
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+} // namespace runtime
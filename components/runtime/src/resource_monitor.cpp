@@ -0,0 +1,288 @@
+/*
+ * Resource Monitor Implementation
+ * 
+ * ヒープ・タスクスタックの使用量モニタ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "resource_monitor.hpp"
+#include "synced_clock.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+#include <cstring>
+
+namespace runtime {
+
+static const char* TAG = "runtime::ResourceMonitor";
+
+// ヒープの種類毎の能力フラグ（Heap列挙型の順）
+static constexpr uint32_t HEAP_CAPS[ResourceMonitor::HEAP_COUNT] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_DMA,
+};
+
+static const char* const HEAP_NAMES[ResourceMonitor::HEAP_COUNT] = {
+    "内部RAM",
+    "DMA",
+};
+
+ResourceMonitor::ResourceMonitor()
+    : config_()
+    , registered_{}
+    , registered_count_(0)
+    , spinlock_(portMUX_INITIALIZER_UNLOCKED)
+    , samples_(0)
+    , scratch_{}
+    , status_{}
+    , telemetry_cursor_(0)
+    , task_(nullptr)
+    , running_(false) {}
+
+ResourceMonitor::~ResourceMonitor() {
+    stop();
+}
+
+esp_err_t ResourceMonitor::start(const Config& config) {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    config_ = config;
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "res_mon", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        ESP_LOGE(TAG, "計測タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    registerTask(task_, config_.stack_size);
+    return ESP_OK;
+}
+
+esp_err_t ResourceMonitor::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 計測タスクは1周期以内にtask_を消して自分を削除する
+    TaskHandle_t task = task_;
+    for (uint32_t waited = 0; waited <= config_.period_ms + 100 && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (task_ != nullptr) {
+        return ESP_ERR_TIMEOUT;
+    }
+    unregisterTask(task);
+    return ESP_OK;
+}
+
+esp_err_t ResourceMonitor::registerTask(TaskHandle_t task, uint32_t stack_size) {
+    if (task == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&spinlock_);
+    for (size_t i = 0; i < registered_count_; i++) {
+        if (registered_[i].task == task) {
+            registered_[i].stack_size = stack_size;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    if (ret != ESP_OK && registered_count_ < MAX_TASKS) {
+        registered_[registered_count_++] = Registration{task, stack_size};
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&spinlock_);
+    return ret;
+}
+
+void ResourceMonitor::unregisterTask(TaskHandle_t task) {
+    portENTER_CRITICAL(&spinlock_);
+    for (size_t i = 0; i < registered_count_; i++) {
+        if (registered_[i].task == task) {
+            registered_[i] = registered_[--registered_count_];
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&spinlock_);
+}
+
+uint32_t ResourceMonitor::registeredStackSize(TaskHandle_t task) {
+    uint32_t stack_size = 0;
+    portENTER_CRITICAL(&spinlock_);
+    for (size_t i = 0; i < registered_count_; i++) {
+        if (registered_[i].task == task) {
+            stack_size = registered_[i].stack_size;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&spinlock_);
+    return stack_size;
+}
+
+void ResourceMonitor::sample() {
+    Report& report = scratch_;
+    memset(&report, 0, sizeof(report));
+    report.time_us = static_cast<uint32_t>(esp_timer_get_time());
+    report.samples = ++samples_;
+    for (size_t i = 0; i < HEAP_COUNT; i++) {
+        sampleHeap(HEAP_CAPS[i], report.heap[i]);
+    }
+    sampleTasks(report);
+    report_.write(report);
+}
+
+void ResourceMonitor::sampleHeap(uint32_t caps, HeapReport& report) {
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, caps);
+    report.total = static_cast<uint32_t>(heap_caps_get_total_size(caps));
+    report.free = static_cast<uint32_t>(info.total_free_bytes);
+    report.minimum_free = static_cast<uint32_t>(info.minimum_free_bytes);
+    report.largest_block = static_cast<uint32_t>(info.largest_free_block);
+    report.fragmentation = report.free > 0
+        ? static_cast<uint16_t>(1000 - static_cast<uint64_t>(report.largest_block) * 1000 / report.free)
+        : 0;
+}
+
+void ResourceMonitor::sampleTasks(Report& report) {
+    size_t count = 0;
+    bool listed = false;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    // 配列が全タスク数より小さい場合は0が返るので、登録タスクのみの計測に切り替える
+    UBaseType_t listed_count = uxTaskGetSystemState(status_, MAX_TASKS, nullptr);
+    if (listed_count > 0) {
+        listed = true;
+        for (UBaseType_t i = 0; i < listed_count; i++) {
+            TaskReport& task = report.task[count++];
+            strncpy(task.name, status_[i].pcTaskName, NAME_SIZE - 1);
+            task.stack_size = registeredStackSize(status_[i].xHandle);
+            task.stack_free = static_cast<uint32_t>(status_[i].usStackHighWaterMark);
+            task.priority = static_cast<uint8_t>(status_[i].uxCurrentPriority);
+        }
+    }
+#endif
+    if (!listed) {
+        Registration registered[MAX_TASKS];
+        size_t registered_count;
+        portENTER_CRITICAL(&spinlock_);
+        registered_count = registered_count_;
+        memcpy(registered, registered_, registered_count * sizeof(Registration));
+        portEXIT_CRITICAL(&spinlock_);
+        for (size_t i = 0; i < registered_count; i++) {
+            TaskReport& task = report.task[count++];
+            strncpy(task.name, pcTaskGetName(registered[i].task), NAME_SIZE - 1);
+            task.stack_size = registered[i].stack_size;
+            task.stack_free = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(registered[i].task));
+            task.priority = static_cast<uint8_t>(uxTaskPriorityGet(registered[i].task));
+        }
+    }
+    
+    report.task_count = static_cast<uint32_t>(count);
+    for (size_t i = 0; i < count; i++) {
+        TaskReport& task = report.task[i];
+        task.low = task.stack_free < config_.stack_warning_bytes;
+        if (task.low) {
+            report.low_stack_count++;
+        }
+    }
+}
+
+void ResourceMonitor::dump() const {
+    Report report;
+    if (!getReport(report)) {
+        ESP_LOGI(TAG, "計測なし");
+        return;
+    }
+    ESP_LOGI(TAG, "計測 %lu 回 タスク %lu（スタック残り %lu バイト未満 %lu）", 
+             static_cast<unsigned long>(report.samples), static_cast<unsigned long>(report.task_count), 
+             static_cast<unsigned long>(config_.stack_warning_bytes), static_cast<unsigned long>(report.low_stack_count));
+    for (size_t i = 0; i < HEAP_COUNT; i++) {
+        const HeapReport& heap = report.heap[i];
+        ESP_LOGI(TAG, "  %s 全体 %lu 空き %lu 最小 %lu 最大ブロック %lu 断片化 %u‰", HEAP_NAMES[i], 
+                 static_cast<unsigned long>(heap.total), static_cast<unsigned long>(heap.free), 
+                 static_cast<unsigned long>(heap.minimum_free), static_cast<unsigned long>(heap.largest_block), 
+                 static_cast<unsigned>(heap.fragmentation));
+    }
+    for (size_t i = 0; i < report.task_count; i++) {
+        const TaskReport& task = report.task[i];
+        if (task.stack_size > 0) {
+            ESP_LOGI(TAG, "  %-16s 優先度 %2u 残り %5lu / %5lu バイト（使用 %lu%%）%s", task.name, 
+                     static_cast<unsigned>(task.priority), static_cast<unsigned long>(task.stack_free), 
+                     static_cast<unsigned long>(task.stack_size), 
+                     static_cast<unsigned long>((task.stack_size - task.stack_free) * 100 / task.stack_size), 
+                     task.low ? " 不足" : "");
+        } else {
+            ESP_LOGI(TAG, "  %-16s 優先度 %2u 残り %5lu バイト%s", task.name, 
+                     static_cast<unsigned>(task.priority), static_cast<unsigned long>(task.stack_free), 
+                     task.low ? " 不足" : "");
+        }
+    }
+}
+
+size_t ResourceMonitor::fillTelemetry(uint8_t* buffer, size_t capacity, void* context) {
+    using communication::ResourceMessage;
+    using communication::ResourceTaskEntry;
+    ResourceMonitor* self = static_cast<ResourceMonitor*>(context);
+    if (capacity < sizeof(ResourceMessage)) {
+        return 0;
+    }
+    Report report;
+    if (!self->getReport(report)) {
+        return 0;
+    }
+    
+    const HeapReport& internal = report.heap[static_cast<size_t>(Heap::INTERNAL)];
+    const HeapReport& dma = report.heap[static_cast<size_t>(Heap::DMA)];
+    ResourceMessage message = {};
+    message.time_us = common::SyncedClock::instance().stamp(report.time_us);
+    message.internal_free = internal.free;
+    message.internal_min_free = internal.minimum_free;
+    message.internal_largest = internal.largest_block;
+    message.dma_free = dma.free;
+    message.dma_min_free = dma.minimum_free;
+    message.dma_largest = dma.largest_block;
+    message.internal_fragmentation = internal.fragmentation;
+    message.dma_fragmentation = dma.fragmentation;
+    message.task_count = static_cast<uint8_t>(report.task_count);
+    
+    if (self->telemetry_cursor_ >= report.task_count) {
+        self->telemetry_cursor_ = 0;
+    }
+    message.task_index = static_cast<uint8_t>(self->telemetry_cursor_);
+    for (size_t i = 0; i < ResourceMessage::TASKS && self->telemetry_cursor_ < report.task_count; i++) {
+        const TaskReport& task = report.task[self->telemetry_cursor_++];
+        ResourceTaskEntry& entry = message.task[i];
+        size_t length = strnlen(task.name, NAME_SIZE);
+        memcpy(entry.name, task.name, length < ResourceTaskEntry::NAME_SIZE ? length : ResourceTaskEntry::NAME_SIZE);
+        entry.stack_free = static_cast<uint16_t>(task.stack_free > 0xFFFF ? 0xFFFF : task.stack_free);
+        entry.stack_size = static_cast<uint16_t>(task.stack_size > 0xFFFF ? 0xFFFF : task.stack_size);
+    }
+    memcpy(buffer, &message, sizeof(message));
+    return sizeof(message);
+}
+
+void ResourceMonitor::taskEntry(void* arg) {
+    ResourceMonitor* self = static_cast<ResourceMonitor*>(arg);
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->config_.period_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->sample();
+        vTaskDelayUntil(&last_wake, period);
+    }
+    
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+} // namespace runtime
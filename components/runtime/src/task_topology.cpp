@@ -0,0 +1,129 @@
+/*
+ * Task Topology Implementation
+ * 
+ * 処理段毎のコア・優先度・周期の配置表実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "task_topology.hpp"
+#include "esp_log.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::TaskTopology";
+
+size_t TaskTopology::selected_ = 0;
+
+namespace {
+
+/**
+ * @brief リアルタイム段か（Wi-Fiタスクに割り込まれると制御周期に響く段）
+ */
+bool isRealtime(Stage s) {
+    return s == Stage::SENSOR || s == Stage::ESTIMATION || s == Stage::CONTROL;
+}
+
+} // namespace
+
+esp_err_t TaskTopology::select(size_t index) {
+    if (index >= LAYOUT_COUNT) {
+        ESP_LOGE(TAG, "配置番号 %u は範囲外です（既定の配置を使用）", static_cast<unsigned>(index));
+        return ESP_ERR_INVALID_ARG;
+    }
+    selected_ = index;
+    ESP_LOGI(TAG, "配置: %s", LAYOUTS[index].name);
+    return ESP_OK;
+}
+
+esp_err_t TaskTopology::validate(const TaskLayout& layout, const Options& options, size_t* warnings) {
+    constexpr size_t count = static_cast<size_t>(Stage::COUNT);
+    size_t errors = 0;
+    size_t warned = 0;
+    
+    for (size_t i = 0; i < count; i++) {
+        const Stage s = static_cast<Stage>(i);
+        const StageConfig& c = layout.stages[i];
+        if (c.core != tskNO_AFFINITY && (c.core < 0 || c.core >= portNUM_PROCESSORS)) {
+            ESP_LOGE(TAG, "%s: %s のコア %d は範囲外", layout.name, stageName(s), static_cast<int>(c.core));
+            errors++;
+        }
+        if (c.priority == 0 || c.priority >= configMAX_PRIORITIES) {
+            ESP_LOGE(TAG, "%s: %s の優先度 %u は範囲外", layout.name, stageName(s), static_cast<unsigned>(c.priority));
+            errors++;
+        }
+        if (isRealtime(s) && c.rate_hz == 0) {
+            ESP_LOGE(TAG, "%s: %s に周期がありません", layout.name, stageName(s));
+            errors++;
+        }
+        if (c.stack_size < 2048) {
+            ESP_LOGE(TAG, "%s: %s のスタック %lu は小さすぎます", layout.name, stageName(s), 
+                     static_cast<unsigned long>(c.stack_size));
+            errors++;
+        }
+        if (options.wifi_enabled && isRealtime(s) && c.core == options.wifi_core && c.priority <= options.wifi_priority) {
+            ESP_LOGW(TAG, "%s: %s はWi-Fiタスク（コア%d 優先度%u）に割り込まれます", layout.name, stageName(s), 
+                     static_cast<int>(options.wifi_core), static_cast<unsigned>(options.wifi_priority));
+            warned++;
+        }
+        
+        // 同じコア上でレート単調の順（周期が短いほど高い優先度）が逆転していないか
+        for (size_t j = 0; j < count; j++) {
+            const StageConfig& o = layout.stages[j];
+            if (j == i || o.core != c.core || c.core == tskNO_AFFINITY || o.rate_hz == 0) {
+                continue;
+            }
+            if (c.rate_hz > o.rate_hz && c.priority < o.priority) {
+                ESP_LOGW(TAG, "%s: コア%d で %s（%luHz）の優先度が %s（%luHz）より低い", layout.name, 
+                         static_cast<int>(c.core), stageName(s), static_cast<unsigned long>(c.rate_hz), 
+                         stageName(static_cast<Stage>(j)), static_cast<unsigned long>(o.rate_hz));
+                warned++;
+            }
+        }
+    }
+    
+    const StageConfig& sensor = layout.stage(Stage::SENSOR);
+    const StageConfig& estimation = layout.stage(Stage::ESTIMATION);
+    const StageConfig& control = layout.stage(Stage::CONTROL);
+    if (estimation.rate_hz < control.rate_hz || sensor.rate_hz < estimation.rate_hz) {
+        ESP_LOGW(TAG, "%s: 上流の段が下流より遅い（センサー %lu 推定 %lu 制御 %lu Hz）", layout.name, 
+                 static_cast<unsigned long>(sensor.rate_hz), static_cast<unsigned long>(estimation.rate_hz), 
+                 static_cast<unsigned long>(control.rate_hz));
+        warned++;
+    }
+    
+    if (warnings != nullptr) {
+        *warnings = warned;
+    }
+    if (errors > 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "%s: 検証OK（警告 %u）", layout.name, static_cast<unsigned>(warned));
+    return ESP_OK;
+}
+
+const char* TaskTopology::stageName(Stage s) {
+    switch (s) {
+    case Stage::SENSOR:     return "sensor";
+    case Stage::ESTIMATION: return "estimation";
+    case Stage::CONTROL:    return "control";
+    case Stage::TELEMETRY:  return "telemetry";
+    case Stage::CLI:        return "cli";
+    default:                return "unknown";
+    }
+}
+
+void TaskTopology::dump(const TaskLayout& layout) {
+    ESP_LOGI(TAG, "配置 %s%s", layout.name, &layout == &current() ? "（選択中）" : "");
+    for (size_t i = 0; i < static_cast<size_t>(Stage::COUNT); i++) {
+        const StageConfig& c = layout.stages[i];
+        ESP_LOGI(TAG, "  %-10s コア %2d 優先度 %2u 周期 %4luHz スタック %lu", stageName(static_cast<Stage>(i)), 
+                 static_cast<int>(c.core), static_cast<unsigned>(c.priority), static_cast<unsigned long>(c.rate_hz), 
+                 static_cast<unsigned long>(c.stack_size));
+    }
+}
+
+} // namespace runtime
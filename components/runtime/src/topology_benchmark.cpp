@@ -0,0 +1,233 @@
+/*
+ * Topology Benchmark Implementation
+ * 
+ * タスク配置の候補毎のセンサー→推定→制御の遅延計測実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "topology_benchmark.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::TopologyBenchmark";
+
+const char* const TopologyBenchmark::HOP_NAMES[] = {"sensor->est", "est->control"};
+
+namespace {
+
+constexpr uint32_t TASK_STACK_SIZE = 3072;          // 計測タスクのスタックサイズ
+constexpr uint32_t STOP_TIMEOUT_MS = 500;           // 計測タスクの停止待ち
+
+/**
+ * @brief 上流の周期に対する間引き数
+ */
+uint32_t decimation(uint32_t upstream_hz, uint32_t rate_hz) {
+    if (rate_hz == 0 || rate_hz >= upstream_hz) {
+        return 1;
+    }
+    return upstream_hz / rate_hz;
+}
+
+} // namespace
+
+TopologyBenchmark::TopologyBenchmark()
+    : config_()
+    , layout_(nullptr)
+    , estimation_wake_()
+    , control_wake_()
+    , to_estimation_(&estimation_wake_)
+    , to_control_(&control_wake_)
+    , latency_(HOP_NAMES, 2)
+    , running_(false)
+    , alive_(0)
+    , outputs_(0) {}
+
+void TopologyBenchmark::spin(uint32_t work_us) {
+    const int64_t end_us = esp_timer_get_time() + work_us;
+    while (esp_timer_get_time() < end_us) {
+    }
+}
+
+void TopologyBenchmark::exitTask() {
+    alive_.fetch_sub(1, std::memory_order_acq_rel);
+    vTaskDelete(nullptr);
+}
+
+void TopologyBenchmark::sensorEntry(void* arg) {
+    TopologyBenchmark* self = static_cast<TopologyBenchmark*>(arg);
+    const StageConfig& sensor = self->layout_->stage(Stage::SENSOR);
+    const uint32_t every = decimation(sensor.rate_hz, self->layout_->stage(Stage::ESTIMATION).rate_hz);
+    TickType_t period = pdMS_TO_TICKS(1000 / sensor.rate_hz);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    uint32_t sequence = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (self->running_.load(std::memory_order_acquire)) {
+        const int64_t sample_us = esp_timer_get_time();
+        spin(self->config_.sensor_work_us);
+        if (sequence % every == 0) {
+            self->to_estimation_.publish(Token{sequence}, {sample_us, 0, sequence / every});
+        }
+        sequence++;
+        vTaskDelayUntil(&last_wake, period);
+    }
+    self->exitTask();
+}
+
+void TopologyBenchmark::estimationEntry(void* arg) {
+    TopologyBenchmark* self = static_cast<TopologyBenchmark*>(arg);
+    const uint32_t every = decimation(self->layout_->stage(Stage::ESTIMATION).rate_hz, 
+                                      self->layout_->stage(Stage::CONTROL).rate_hz);
+    self->estimation_wake_.bindCurrentTask();
+    
+    uint32_t processed = 0;
+    while (self->running_.load(std::memory_order_acquire)) {
+        Token token;
+        PipelineStamp stamp;
+        if (!self->to_estimation_.receive(token, stamp, pdMS_TO_TICKS(20))) {
+            continue;
+        }
+        self->latency_.recordHop(0, stamp, esp_timer_get_time());
+        spin(self->config_.estimation_work_us);
+        if (processed % every == 0) {
+            stamp.sequence = processed / every;
+            self->to_control_.publish(token, stamp);
+        }
+        processed++;
+    }
+    self->estimation_wake_.unbind();
+    self->exitTask();
+}
+
+void TopologyBenchmark::controlEntry(void* arg) {
+    TopologyBenchmark* self = static_cast<TopologyBenchmark*>(arg);
+    self->control_wake_.bindCurrentTask();
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        Token token;
+        PipelineStamp stamp;
+        if (!self->to_control_.receive(token, stamp, pdMS_TO_TICKS(20))) {
+            continue;
+        }
+        self->latency_.recordHop(1, stamp, esp_timer_get_time());
+        spin(self->config_.control_work_us);
+        self->latency_.recordOutput(stamp, esp_timer_get_time());
+        self->outputs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    self->control_wake_.unbind();
+    self->exitTask();
+}
+
+void TopologyBenchmark::loadEntry(void* arg) {
+    TopologyBenchmark* self = static_cast<TopologyBenchmark*>(arg);
+    // 10ms毎に load_percent の割合だけCPUを占有する
+    const TickType_t period = pdMS_TO_TICKS(10);
+    const uint32_t busy_us = self->config_.load_percent * 100;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (self->running_.load(std::memory_order_acquire)) {
+        spin(busy_us);
+        vTaskDelayUntil(&last_wake, period);
+    }
+    self->exitTask();
+}
+
+esp_err_t TopologyBenchmark::run(const TaskLayout& layout, const Config& config, Result& result) {
+    if (running_.load(std::memory_order_acquire) || alive_.load(std::memory_order_acquire) != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (config.load_percent > 90 || layout.stage(Stage::SENSOR).rate_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    config_ = config;
+    layout_ = &layout;
+    latency_.reset();
+    outputs_.store(0, std::memory_order_relaxed);
+    running_.store(true, std::memory_order_release);
+    
+    struct Spawn {
+        TaskFunction_t entry;
+        const char* name;
+        const StageConfig* stage;
+    };
+    const StageConfig load = {config.load_core, config.load_priority, 100, TASK_STACK_SIZE};
+    const Spawn spawns[] = {
+        {estimationEntry, "bench_est", &layout.stage(Stage::ESTIMATION)},
+        {controlEntry, "bench_ctrl", &layout.stage(Stage::CONTROL)},
+        {loadEntry, "bench_load", config.load_percent > 0 ? &load : nullptr},
+        {sensorEntry, "bench_sensor", &layout.stage(Stage::SENSOR)},
+    };
+    esp_err_t ret = ESP_OK;
+    for (const Spawn& spawn : spawns) {
+        if (spawn.stage == nullptr) {
+            continue;
+        }
+        // 作成直後に終了しても数が負にならないよう先に数える
+        alive_.fetch_add(1, std::memory_order_acq_rel);
+        if (xTaskCreatePinnedToCore(spawn.entry, spawn.name, TASK_STACK_SIZE, this, spawn.stage->priority, 
+                                    nullptr, spawn.stage->core) != pdPASS) {
+            alive_.fetch_sub(1, std::memory_order_acq_rel);
+            ESP_LOGE(TAG, "計測タスク作成失敗: %s", spawn.name);
+            ret = ESP_ERR_NO_MEM;
+            break;
+        }
+    }
+    
+    if (ret == ESP_OK) {
+        vTaskDelay(pdMS_TO_TICKS(config.duration_ms));
+    }
+    running_.store(false, std::memory_order_release);
+    estimation_wake_.notify();
+    control_wake_.notify();
+    for (uint32_t waited = 0; waited <= STOP_TIMEOUT_MS && alive_.load(std::memory_order_acquire) != 0; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    if (ret == ESP_OK && alive_.load(std::memory_order_acquire) != 0) {
+        ret = ESP_ERR_TIMEOUT;
+    }
+    
+    result.layout = layout.name;
+    result.report = latency_.getReport();
+    result.outputs = outputs_.load(std::memory_order_relaxed);
+    return ret;
+}
+
+esp_err_t TopologyBenchmark::runAll(const Config& config, Result* results) {
+    ESP_LOGI(TAG, "配置 %u 候補を各 %lums 計測（処理 %lu/%lu/%luμs 背景負荷 %lu%% コア%d）", 
+             static_cast<unsigned>(TaskTopology::LAYOUT_COUNT), static_cast<unsigned long>(config.duration_ms), 
+             static_cast<unsigned long>(config.sensor_work_us), static_cast<unsigned long>(config.estimation_work_us), 
+             static_cast<unsigned long>(config.control_work_us), static_cast<unsigned long>(config.load_percent), 
+             static_cast<int>(config.load_core));
+    esp_err_t first_error = ESP_OK;
+    for (size_t i = 0; i < TaskTopology::LAYOUT_COUNT; i++) {
+        Result result = {};
+        esp_err_t ret = run(TaskTopology::LAYOUTS[i], config, result);
+        if (results != nullptr) {
+            results[i] = result;
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "%s: 計測失敗 %s", TaskTopology::LAYOUTS[i].name, esp_err_to_name(ret));
+            if (first_error == ESP_OK) {
+                first_error = ret;
+            }
+            continue;
+        }
+        const PipelineLatency::Report& r = result.report;
+        ESP_LOGI(TAG, "%-10s 全体 平均 %4luμs 最大 %5luμs | 段 %lu/%luμs 最大 %lu/%luμs | 出力 %lu 欠落 %lu", 
+                 result.layout, static_cast<unsigned long>(r.end_to_end.average_us), 
+                 static_cast<unsigned long>(r.end_to_end.max_us), static_cast<unsigned long>(r.hop[0].average_us), 
+                 static_cast<unsigned long>(r.hop[1].average_us), static_cast<unsigned long>(r.hop[0].max_us), 
+                 static_cast<unsigned long>(r.hop[1].max_us), static_cast<unsigned long>(result.outputs), 
+                 static_cast<unsigned long>(r.lost));
+    }
+    return first_error;
+}
+
+} // namespace runtime
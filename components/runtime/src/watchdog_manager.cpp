@@ -0,0 +1,219 @@
+/*
+ * Watchdog Manager Implementation
+ * 
+ * タスク毎の期限付きハートビートによるソフトウェアウォッチドッグ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "watchdog_manager.hpp"
+#include "esp_log.h"
+#include "esp_task_wdt.h"
+
+namespace runtime {
+
+static const char* TAG = "runtime::WatchdogManager";
+
+WatchdogManager::WatchdogManager()
+    : config_()
+    , spinlock_(portMUX_INITIALIZER_UNLOCKED)
+    , slots_{}
+    , count_(0)
+    , callback_()
+    , tripped_(false)
+    , violation_{}
+    , task_(nullptr)
+    , running_(false) {}
+
+WatchdogManager::~WatchdogManager() {
+    stop();
+}
+
+esp_err_t WatchdogManager::registerTask(const char* name, uint32_t deadline_us, size_t& slot) {
+    if (deadline_us == 0 || deadline_us >= 0x80000000u) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    portENTER_CRITICAL(&spinlock_);
+    const size_t count = count_.load(std::memory_order_relaxed);
+    if (count < MAX_TASKS) {
+        Slot& s = slots_[count];
+        s.name = name;
+        s.deadline_us = deadline_us;
+        s.last_beat_us.store(0, std::memory_order_relaxed);
+        s.beats.store(0, std::memory_order_relaxed);
+        s.max_elapsed_us.store(0, std::memory_order_relaxed);
+        s.misses.store(0, std::memory_order_relaxed);
+        s.enabled.store(true, std::memory_order_relaxed);
+        // 監視タスクはcount_を見てからスロットを読むため、書き終えてから公開する
+        count_.store(count + 1, std::memory_order_release);
+        slot = count;
+        ret = ESP_OK;
+    }
+    portEXIT_CRITICAL(&spinlock_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "登録数の上限です: %s", name);
+    }
+    return ret;
+}
+
+void WatchdogManager::setEnabled(size_t slot, bool enabled) {
+    if (slot >= count_.load(std::memory_order_acquire)) {
+        return;
+    }
+    Slot& s = slots_[slot];
+    if (enabled) {
+        s.last_beat_us.store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+    }
+    s.enabled.store(enabled, std::memory_order_release);
+}
+
+esp_err_t WatchdogManager::start(const Config& config) {
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    config_ = config;
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "watchdog", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        ESP_LOGE(TAG, "監視タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t WatchdogManager::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 監視タスクは1周期以内にTWDTの登録を外し、task_を消して自分を削除する
+    for (uint32_t waited = 0; waited <= config_.period_ms + 100 && task_ != nullptr; waited += 10) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return task_ != nullptr ? ESP_ERR_TIMEOUT : ESP_OK;
+}
+
+bool WatchdogManager::check(int64_t now_us) {
+    const uint32_t now = static_cast<uint32_t>(now_us);
+    const size_t count = count_.load(std::memory_order_acquire);
+    bool healthy = true;
+    for (size_t i = 0; i < count; i++) {
+        Slot& s = slots_[i];
+        if (!s.enabled.load(std::memory_order_acquire) || s.beats.load(std::memory_order_acquire) == 0) {
+            continue;
+        }
+        // 読み出しの後にハートビートが入ると負になるため符号付きで比べる
+        const int32_t elapsed = static_cast<int32_t>(now - s.last_beat_us.load(std::memory_order_relaxed));
+        if (elapsed <= 0) {
+            continue;
+        }
+        const uint32_t elapsed_us = static_cast<uint32_t>(elapsed);
+        if (elapsed_us > s.max_elapsed_us.load(std::memory_order_relaxed)) {
+            s.max_elapsed_us.store(elapsed_us, std::memory_order_relaxed);
+        }
+        if (elapsed_us <= s.deadline_us) {
+            continue;
+        }
+        
+        healthy = false;
+        s.misses.fetch_add(1, std::memory_order_relaxed);
+        if (!tripped_.load(std::memory_order_relaxed)) {
+            violation_.slot = i;
+            violation_.name = s.name;
+            violation_.deadline_us = s.deadline_us;
+            violation_.elapsed_us = elapsed_us;
+            tripped_.store(true, std::memory_order_release);
+            ESP_LOGE(TAG, "期限違反: %s 経過 %luμs 期限 %luμs", s.name, 
+                     static_cast<unsigned long>(elapsed_us), static_cast<unsigned long>(s.deadline_us));
+            if (callback_) {
+                callback_(violation_);
+            }
+        }
+    }
+    return healthy;
+}
+
+bool WatchdogManager::getViolation(Violation& violation) const {
+    if (!tripped_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    violation = violation_;
+    return true;
+}
+
+bool WatchdogManager::getReport(size_t slot, TaskReport& report) const {
+    if (slot >= count_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    const Slot& s = slots_[slot];
+    report.name = s.name;
+    report.deadline_us = s.deadline_us;
+    report.beats = s.beats.load(std::memory_order_relaxed);
+    report.max_elapsed_us = s.max_elapsed_us.load(std::memory_order_relaxed);
+    report.misses = s.misses.load(std::memory_order_relaxed);
+    report.enabled = s.enabled.load(std::memory_order_relaxed);
+    return true;
+}
+
+void WatchdogManager::taskEntry(void* arg) {
+    WatchdogManager* self = static_cast<WatchdogManager*>(arg);
+    // TWDTへは監視タスク1つだけを登録する（タスク毎の登録より安く、違反したタスクも分かる）
+    bool twdt = false;
+    if (self->config_.use_twdt) {
+        esp_err_t ret = esp_task_wdt_add(nullptr);
+        twdt = (ret == ESP_OK);
+        if (!twdt) {
+            ESP_LOGW(TAG, "TWDT登録失敗: %s", esp_err_to_name(ret));
+        }
+    }
+    
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(self->config_.period_ms);
+    if (period == 0) {
+        period = 1;
+    }
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->check(esp_timer_get_time());
+        // 違反後はリセットを止め、TWDTの期限で再起動させる（緊急停止は通知で済んでいる）
+        if (twdt && !(self->config_.escalate_to_twdt && self->isTripped())) {
+            esp_task_wdt_reset();
+        }
+        vTaskDelayUntil(&last_wake, period);
+    }
+    
+    if (twdt) {
+        esp_task_wdt_delete(nullptr);
+    }
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void WatchdogManager::dump() const {
+    const size_t count = count_.load(std::memory_order_acquire);
+    Violation violation;
+    if (getViolation(violation)) {
+        ESP_LOGI(TAG, "違反: %s 経過 %luμs 期限 %luμs", violation.name, 
+                 static_cast<unsigned long>(violation.elapsed_us), static_cast<unsigned long>(violation.deadline_us));
+    } else {
+        ESP_LOGI(TAG, "%s 登録 %u 違反なし", running_.load(std::memory_order_relaxed) ? "監視中" : "停止", 
+                 static_cast<unsigned>(count));
+    }
+    for (size_t i = 0; i < count; i++) {
+        TaskReport report;
+        if (!getReport(i, report)) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-12s 期限 %luμs 最大経過 %luμs 違反 %lu 拍 %lu%s", report.name, 
+                 static_cast<unsigned long>(report.deadline_us), static_cast<unsigned long>(report.max_elapsed_us), 
+                 static_cast<unsigned long>(report.misses), static_cast<unsigned long>(report.beats), 
+                 report.enabled ? "" : "（停止中）");
+    }
+}
+
+} // namespace runtime
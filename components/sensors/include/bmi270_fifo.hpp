@@ -0,0 +1,219 @@
+/*
+ * BMI270 FIFO Reader
+ * 
+ * BMI270 IMUのFIFOを1回のSPIバースト転送で読み出し、
+ * フレームを展開してセンサー時刻（sensortime）基準のタイムスタンプを付与する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BMI270_FIFO_HPP
+#define BMI270_FIFO_HPP
+
+#include "spi_hal.hpp"
+#include "spi_bus_scheduler.hpp"
+#include "imu_sample_buffer.hpp"
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief BMI270 FIFOリーダークラス
+ * 
+ * ヘッダーモードFIFO（加速度 + 角速度 + sensortime）を使用する。
+ * BMI270のコンフィグファイル書き込み（初期化シーケンス）は事前に完了していること
+ */
+class Bmi270Fifo {
+public:
+    /**
+     * @brief 出力データレート列挙型（レジスタ値）
+     */
+    enum class Odr : uint8_t {
+        HZ_100 = 0x08,
+        HZ_200 = 0x09,
+        HZ_400 = 0x0A,
+        HZ_800 = 0x0B,
+        HZ_1600 = 0x0C
+    };
+    
+    /**
+     * @brief 加速度レンジ列挙型（レジスタ値）
+     */
+    enum class AccelRange : uint8_t {
+        G2 = 0x00,
+        G4 = 0x01,
+        G8 = 0x02,
+        G16 = 0x03
+    };
+    
+    /**
+     * @brief 角速度レンジ列挙型（レジスタ値）
+     */
+    enum class GyroRange : uint8_t {
+        DPS2000 = 0x00,
+        DPS1000 = 0x01,
+        DPS500 = 0x02,
+        DPS250 = 0x03,
+        DPS125 = 0x04
+    };
+    
+    /**
+     * @brief BMI270 FIFO設定構造体
+     */
+    struct Config {
+        Odr odr;                    // 加速度・角速度共通ODR
+        AccelRange accel_range;     // 加速度レンジ
+        GyroRange gyro_range;       // 角速度レンジ
+        size_t burst_buffer_size;   // バースト読み取りバッファサイズ（バイト）
+    };
+    
+    /**
+     * @brief FIFO統計情報構造体
+     */
+    struct Stats {
+        uint32_t bursts;            // バースト読み取り回数
+        uint32_t frames;            // 展開したデータフレーム数
+        uint32_t skipped_frames;    // FIFOオーバーフローでセンサー側が破棄したフレーム数
+        uint32_t truncated_bursts;  // バッファ不足で途中までしか読めなかった回数
+        uint32_t missing_sensortime;    // sensortimeフレームが無く推定時刻を使用した回数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param spi SPI HAL
+     * @param device BMI270のSPIデバイスハンドル
+     */
+    Bmi270Fifo(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t device);
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~Bmi270Fifo();
+    
+    Bmi270Fifo(const Bmi270Fifo&) = delete;
+    Bmi270Fifo& operator=(const Bmi270Fifo&) = delete;
+    
+    /**
+     * @brief 初期化（ODR・レンジ・FIFO設定とDMAバッファ確保）
+     * @param config FIFO設定
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief FIFOフラッシュ
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t flush();
+    
+    /**
+     * @brief FIFO読み出し
+     * 
+     * FIFO長を読み取り、FIFO全体を1回のSPIバーストで読み出してバッファへ追加する。
+     * 各サンプルの時刻は末尾のsensortimeフレームからODR周期で逆算する
+     * @tparam Capacity バッファ容量
+     * @param buffer サンプル格納先（追加のみ行い、クリアしない）
+     * @return esp_err_t 読み出し結果
+     */
+    template<size_t Capacity>
+    esp_err_t drain(ImuSampleBuffer<Capacity>& buffer) {
+        return drainInto(buffer.accel_x, buffer.accel_y, buffer.accel_z, 
+                         buffer.gyro_x, buffer.gyro_y, buffer.gyro_z, 
+                         buffer.timestamp_us, buffer.count, Capacity, buffer.overflow_count);
+    }
+    
+    /**
+     * @brief 共有バススケジューラの設定（以後の読み出しはCRITICALとして調停する）
+     * 
+     * FIFO長の読み取りとバーストを1回の占有にまとめ、要求から解放までを期限と比べる
+     * @param scheduler バススケジューラ（nullptrで直接転送に戻す）
+     * @param client SpiBusScheduler::addClient() の登録番号（Priority::CRITICAL）
+     */
+    void attachScheduler(std::shared_ptr<hal::SpiBusScheduler> scheduler, size_t client) {
+        scheduler_ = std::move(scheduler);
+        bus_client_ = client;
+    }
+    
+    /**
+     * @brief 統計情報取得
+     * @return const Stats& 統計情報
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief サンプル周期取得
+     * @return uint32_t サンプル周期（μs）
+     */
+    uint32_t getSamplePeriodUs() const;
+    
+private:
+    static constexpr uint8_t REG_CHIP_ID = 0x00;
+    static constexpr uint8_t REG_FIFO_LENGTH_0 = 0x24;
+    static constexpr uint8_t REG_FIFO_DATA = 0x26;
+    static constexpr uint8_t REG_ACC_CONF = 0x40;
+    static constexpr uint8_t REG_ACC_RANGE = 0x41;
+    static constexpr uint8_t REG_GYR_CONF = 0x42;
+    static constexpr uint8_t REG_GYR_RANGE = 0x43;
+    static constexpr uint8_t REG_FIFO_CONFIG_0 = 0x48;
+    static constexpr uint8_t REG_FIFO_CONFIG_1 = 0x49;
+    static constexpr uint8_t REG_PWR_CTRL = 0x7D;
+    static constexpr uint8_t REG_CMD = 0x7E;
+    static constexpr uint8_t CMD_FIFO_FLUSH = 0xB0;
+    static constexpr uint8_t CHIP_ID = 0x24;
+    
+    static constexpr uint32_t SENSORTIME_MASK = 0x00FFFFFF;     // 24bitカウンタ
+    static constexpr size_t SPI_READ_OFFSET = 2;                // アドレス + ダミーバイト
+    
+    std::shared_ptr<hal::SpiHal> spi_;      // SPI HAL
+    spi_device_handle_t device_;            // SPIデバイスハンドル
+    Config config_;                         // FIFO設定
+    Stats stats_;                           // 統計情報
+    uint8_t* tx_buffer_;                    // バースト送信バッファ（DMA対応）
+    uint8_t* rx_buffer_;                    // バースト受信バッファ（DMA対応）
+    size_t buffer_size_;                    // バースト転送バッファサイズ
+    uint32_t period_ticks_;                 // ODR周期（sensortime単位）
+    float accel_scale_;                     // 加速度換算係数（m/s^2/LSB）
+    float gyro_scale_;                      // 角速度換算係数（rad/s/LSB）
+    uint64_t sensortime_ticks_;             // 展開済みsensortime（64bit）
+    uint32_t last_sensortime_raw_;          // 前回のsensortime生値
+    bool sensortime_valid_;                 // sensortime取得済みフラグ
+    std::shared_ptr<hal::SpiBusScheduler> scheduler_;   // 共有バススケジューラ（nullptrで直接転送）
+    size_t bus_client_;                     // スケジューラの登録番号
+    
+    /**
+     * @brief FIFO長の読み取りとバースト転送
+     * @param read_length 読み出したFIFOデータ長格納先（FIFOが空の場合0）
+     */
+    esp_err_t readFifo(size_t& read_length);
+    
+    /**
+     * @brief レジスタ読み取り（BMI270 SPIダミーバイト処理込み）
+     */
+    esp_err_t readRegisters(uint8_t reg, uint8_t* data, size_t length);
+    
+    /**
+     * @brief レジスタ書き込み
+     */
+    esp_err_t writeRegister(uint8_t reg, uint8_t value);
+    
+    /**
+     * @brief FIFO読み出し本体（SoA配列へ展開）
+     */
+    esp_err_t drainInto(float* ax, float* ay, float* az, float* gx, float* gy, float* gz, 
+                        uint64_t* t_us, size_t& count, size_t capacity, uint32_t& overflow);
+    
+    /**
+     * @brief sensortime生値を64bitに展開
+     * @param raw 24bit sensortime
+     * @return uint64_t 展開後のsensortime
+     */
+    uint64_t unwrapSensortime(uint32_t raw);
+};
+
+} // namespace sensors
+
+#endif // BMI270_FIFO_HPP
@@ -0,0 +1,206 @@
+/*
+ * BMM150 Magnetometer
+ * 
+ * BMM150地磁気センサーのドライバ
+ * ノーマルモードの出力データレートに合わせて結果のみを読み、
+ * 製造時のトリム値による補償（μT）を行う。読み取りはBmp280と同じくバッチ実行の1スロットに収める
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BMM150_HPP
+#define BMM150_HPP
+
+#include "i2c_hal.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief BMM150ドライバクラス
+ * 
+ * センサータスクは周期毎に prepare() でスロットを埋めてもらい、executeBatch() の後に
+ * complete() に結果を渡す（バッチを組まない場合は service()）。出力データレートの周期が
+ * 経つまではスロットを使わない。ハードアイアン・ソフトアイアンの補正は MagCalibrator で行う。
+ * 
+ * prepare()・complete()・service()・consume()は同じタスクから呼び出すこと
+ */
+class Bmm150 {
+public:
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x10;    // 既定のI2Cアドレス（SDO・CSB=GND）
+    static constexpr uint8_t CHIP_ID = 0x32;            // チップID
+    static constexpr size_t DATA_SIZE = 8;              // X・Y・Z・RHALLの読み取り長
+    
+    /**
+     * @brief 出力データレート
+     */
+    enum class DataRate : uint8_t {
+        HZ_10 = 0,
+        HZ_2 = 1,
+        HZ_6 = 2,
+        HZ_8 = 3,
+        HZ_15 = 4,
+        HZ_20 = 5,
+        HZ_25 = 6,
+        HZ_30 = 7
+    };
+    
+    /**
+     * @brief ドライバ設定構造体
+     */
+    struct Config {
+        DataRate data_rate = DataRate::HZ_25;           // 出力データレート
+        uint8_t repetitions_xy = 0x04;                  // XYの繰り返し（1+2n回、既定は標準プリセットの9回）
+        uint8_t repetitions_z = 0x0E;                   // Zの繰り返し（1+n回、既定は標準プリセットの15回）
+        uint32_t scl_speed_hz = 400000;                 // I2Cクロック
+        TickType_t timeout = pdMS_TO_TICKS(5);          // 1スロットのタイムアウト
+    };
+    
+    /**
+     * @brief 測定サンプル
+     */
+    struct Sample {
+        float field_ut[3];          // 磁場（μT、センサー座標、補正前）
+        uint16_t rhall;             // ホール抵抗（補償に使用）
+        int64_t timestamp_us;       // 読み取り時刻（μs）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t reads;             // 読み取り回数
+        uint32_t samples;           // 補償したサンプル数
+        uint32_t stale;             // データレディでなかった読み取り回数（次の周期で読み直す）
+        uint32_t overflows;         // 飽和（強磁場）で捨てたサンプル数
+        uint32_t errors;            // 転送失敗回数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param i2c I2C HAL
+     * @param address I2Cアドレス
+     */
+    explicit Bmm150(std::shared_ptr<hal::I2cHal> i2c, uint8_t address = DEFAULT_ADDRESS);
+    
+    Bmm150(const Bmm150&) = delete;
+    Bmm150& operator=(const Bmm150&) = delete;
+    
+    /**
+     * @brief 初期化（電源投入・ID確認・トリム値読み出し・ノーマルモード開始）
+     * @param config ドライバ設定
+     * @return esp_err_t IDが一致しない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 初期化（既定設定）
+     */
+    esp_err_t initialize() { return initialize(Config{}); }
+    
+    /**
+     * @brief バッチのスロットの準備
+     * @param slot 埋めるスロット（dataの容量は再利用する）
+     * @param now_us 現在時刻（μs）
+     * @return bool スロットを使う場合true
+     */
+    bool prepare(hal::I2cHal::Transaction& slot, int64_t now_us);
+    
+    /**
+     * @brief バッチ実行後の結果の反映
+     * @param slot prepare()で埋めたスロット
+     * @param now_us バッチ完了時刻（μs）
+     */
+    void complete(const hal::I2cHal::Transaction& slot, int64_t now_us);
+    
+    /**
+     * @brief 周期処理（単独実行）
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t service();
+    
+    /**
+     * @brief 新しいサンプルの取り出し
+     * @param sample サンプル格納先
+     * @return bool 前回の取り出し以降に新しいサンプルがあった場合true
+     */
+    bool consume(Sample& sample);
+    
+    /**
+     * @brief 最新のサンプル
+     */
+    const Sample& getLatest() const { return latest_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr uint8_t REG_CHIP_ID = 0x40;
+    static constexpr uint8_t REG_DATA_X_LSB = 0x42;
+    static constexpr uint8_t REG_POWER_CONTROL = 0x4B;
+    static constexpr uint8_t REG_OP_MODE = 0x4C;
+    static constexpr uint8_t REG_REP_XY = 0x51;
+    static constexpr uint8_t REG_REP_Z = 0x52;
+    static constexpr uint8_t REG_TRIM_X1 = 0x5D;
+    static constexpr uint8_t REG_TRIM_Z4 = 0x62;
+    static constexpr uint8_t REG_TRIM_Z2 = 0x68;
+    
+    /**
+     * @brief 製造時のトリム値
+     */
+    struct Trim {
+        int8_t x1;
+        int8_t y1;
+        int8_t x2;
+        int8_t y2;
+        uint16_t z1;
+        int16_t z2;
+        int16_t z3;
+        int16_t z4;
+        uint8_t xy1;
+        int8_t xy2;
+        uint16_t xyz1;
+    };
+    
+    std::shared_ptr<hal::I2cHal> i2c_;          // I2C HAL
+    uint8_t address_;                           // I2Cアドレス
+    Config config_;                             // 設定
+    bool initialized_;                          // 初期化済み
+    Trim trim_;                                 // トリム値
+    int64_t interval_us_;                       // 読み取り間隔（出力データレートの周期）
+    int64_t last_read_us_;                      // 前回データを得た時刻
+    hal::I2cHal::Transaction transaction_;      // 単独実行用スロット
+    
+    Sample latest_;                             // 最新のサンプル
+    bool fresh_;                                // 未取り出しのサンプルあり
+    Stats stats_;                               // 統計情報
+    
+    /**
+     * @brief X・Y軸の補償
+     */
+    float compensateXy(int16_t raw, uint16_t rhall, int8_t t1, int8_t t2) const;
+    
+    /**
+     * @brief Z軸の補償
+     */
+    float compensateZ(int16_t raw, uint16_t rhall) const;
+};
+
+} // namespace sensors
+
+#endif // BMM150_HPP
@@ -0,0 +1,237 @@
+/*
+ * BMP280 Barometer
+ * 
+ * BMP280気圧センサーのドライバ
+ * 強制モードの変換開始・変換待ち・結果読み取りをセンサータスクの周期をまたいで進め、
+ * 1周期のI2Cアクセスをバッチ実行（I2cHal::executeBatch）の1スロットに収める
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BMP280_HPP
+#define BMP280_HPP
+
+#include "i2c_hal.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief BMP280ドライバクラス
+ * 
+ * センサータスクは周期毎に prepare() でスロットを埋めてもらい、他のデバイスのスロットと
+ * まとめて executeBatch() で実行した後 complete() に結果を渡す。変換待ちの間は
+ * スロットを使わない（prepare()がfalseを返す）。バッチを組まない場合は service() を呼ぶ。
+ * 補償計算は校正値から前計算した係数によるfloat演算で行う。
+ * 
+ * prepare()・complete()・service()・consume()は同じタスクから呼び出すこと
+ */
+class Bmp280 {
+public:
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x76;    // 既定のI2Cアドレス（SDO=GND）
+    static constexpr uint8_t CHIP_ID = 0x58;            // BMP280のチップID
+    static constexpr uint8_t CHIP_ID_BME280 = 0x60;     // BME280のチップID（気圧・温度の補償は共通）
+    static constexpr size_t DATA_SIZE = 6;              // 気圧・温度の読み取り長
+    
+    /**
+     * @brief オーバーサンプリング
+     */
+    enum class Oversampling : uint8_t {
+        X1 = 1,
+        X2 = 2,
+        X4 = 3,
+        X8 = 4,
+        X16 = 5
+    };
+    
+    /**
+     * @brief IIRフィルタ係数
+     */
+    enum class Filter : uint8_t {
+        OFF = 0,
+        X2 = 1,
+        X4 = 2,
+        X8 = 3,
+        X16 = 4
+    };
+    
+    /**
+     * @brief ドライバ設定構造体
+     */
+    struct Config {
+        Oversampling pressure = Oversampling::X8;       // 気圧のオーバーサンプリング
+        Oversampling temperature = Oversampling::X1;    // 温度のオーバーサンプリング
+        Filter filter = Filter::X4;                     // IIRフィルタ（強制モードでも変換毎に適用）
+        float sea_level_pa = 101325.0f;                 // 高度換算の基準気圧（Pa）
+        uint32_t scl_speed_hz = 400000;                 // I2Cクロック
+        TickType_t timeout = pdMS_TO_TICKS(5);          // 1スロットのタイムアウト
+    };
+    
+    /**
+     * @brief 測定サンプル
+     */
+    struct Sample {
+        float pressure_pa;          // 気圧（Pa）
+        float temperature_c;        // 温度（℃）
+        float altitude_m;           // 基準気圧からの高度（m）
+        int64_t timestamp_us;       // 気圧変換の中心時刻（μs）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t conversions;       // 変換開始回数
+        uint32_t samples;           // 補償したサンプル数
+        uint32_t errors;            // 転送失敗回数（変換開始からやり直す）
+        uint32_t conversion_us;     // 変換時間（μs、設定から算出した最大値）
+        uint32_t last_period_us;    // 前回のサンプル間隔（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param i2c I2C HAL
+     * @param address I2Cアドレス
+     */
+    explicit Bmp280(std::shared_ptr<hal::I2cHal> i2c, uint8_t address = DEFAULT_ADDRESS);
+    
+    Bmp280(const Bmp280&) = delete;
+    Bmp280& operator=(const Bmp280&) = delete;
+    
+    /**
+     * @brief 初期化（リセット・ID確認・校正値読み出し・係数の前計算）
+     * @param config ドライバ設定
+     * @return esp_err_t IDが一致しない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 初期化（既定設定）
+     */
+    esp_err_t initialize() { return initialize(Config{}); }
+    
+    /**
+     * @brief バッチのスロットの準備
+     * @param slot 埋めるスロット（dataの容量は再利用する）
+     * @param now_us 現在時刻（μs）
+     * @return bool スロットを使う場合true（falseの場合はバッチに含めない）
+     */
+    bool prepare(hal::I2cHal::Transaction& slot, int64_t now_us);
+    
+    /**
+     * @brief バッチ実行後の結果の反映
+     * @param slot prepare()で埋めたスロット（resultを参照）
+     * @param now_us バッチ完了時刻（μs）
+     */
+    void complete(const hal::I2cHal::Transaction& slot, int64_t now_us);
+    
+    /**
+     * @brief 周期処理（単独実行、必要な場合のみ1スロットを実行する）
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t service();
+    
+    /**
+     * @brief 新しいサンプルの取り出し
+     * @param sample サンプル格納先
+     * @return bool 前回の取り出し以降に新しいサンプルがあった場合true
+     */
+    bool consume(Sample& sample);
+    
+    /**
+     * @brief 最新のサンプル
+     */
+    const Sample& getLatest() const { return latest_; }
+    
+    /**
+     * @brief 高度換算の基準気圧の設定（地上で現在の気圧を設定すると高度0）
+     * @param pressure_pa 基準気圧（Pa）
+     */
+    void setReferencePressure(float pressure_pa) { config_.sea_level_pa = pressure_pa; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr uint8_t REG_CALIBRATION = 0x88;
+    static constexpr uint8_t REG_CHIP_ID = 0xD0;
+    static constexpr uint8_t REG_RESET = 0xE0;
+    static constexpr uint8_t REG_STATUS = 0xF3;
+    static constexpr uint8_t REG_CTRL_MEAS = 0xF4;
+    static constexpr uint8_t REG_CONFIG = 0xF5;
+    static constexpr uint8_t REG_PRESS_MSB = 0xF7;
+    static constexpr uint8_t RESET_VALUE = 0xB6;
+    static constexpr size_t CALIBRATION_SIZE = 24;
+    
+    /**
+     * @brief 変換の状態
+     */
+    enum class State : uint8_t {
+        START,          // 変換開始の書き込み待ち
+        CONVERTING,     // 変換中（スロット不要）
+        READ            // 結果読み取り待ち
+    };
+    
+    /**
+     * @brief 校正値から前計算した補償係数
+     */
+    struct Coefficients {
+        float t_offset;     // 16 * T1
+        float t1;           // T2 / 2^14
+        float t2;           // T3 / 2^34
+        float p1_0;         // P1
+        float p1_1;         // P1 * P2 / 2^34
+        float p1_2;         // P1 * P3 / 2^53
+        float p2_0;         // P4 * 2^16
+        float p2_1;         // P5 / 2
+        float p2_2;         // P6 / 2^17
+        float p3_0;         // P7 / 16
+        float p3_1;         // P8 / 2^19
+        float p3_2;         // P9 / 2^35
+    };
+    
+    std::shared_ptr<hal::I2cHal> i2c_;          // I2C HAL
+    uint8_t address_;                           // I2Cアドレス
+    Config config_;                             // 設定
+    bool initialized_;                          // 初期化済み
+    Coefficients coefficients_;                 // 補償係数
+    uint8_t ctrl_meas_;                         // 強制モードの変換開始値
+    uint32_t pressure_offset_us_;               // 変換開始から気圧変換の中心まで（μs）
+    
+    State state_;                               // 変換の状態
+    int64_t conversion_start_us_;               // 変換開始時刻
+    hal::I2cHal::Transaction transaction_;      // 単独実行用スロット
+    
+    Sample latest_;                             // 最新のサンプル
+    bool fresh_;                                // 未取り出しのサンプルあり
+    Stats stats_;                               // 統計情報
+    
+    /**
+     * @brief 校正値の展開と係数の前計算
+     */
+    void computeCoefficients(const uint8_t* calibration);
+    
+    /**
+     * @brief 生データの補償
+     */
+    void compensate(const uint8_t* data, int64_t timestamp_us);
+};
+
+} // namespace sensors
+
+#endif // BMP280_HPP
@@ -0,0 +1,217 @@
+/*
+ * Gyro Spectrum Analyzer
+ * 
+ * ジャイロ信号のリアルタイムスペクトル解析
+ * IMUタスクから受け取ったサンプルを重なりのある窓でFFTし、
+ * 軸毎のピーク周波数と帯域エネルギーをテレメトリ・CLI・動的ノッチへ提供する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef GYRO_SPECTRUM_HPP
+#define GYRO_SPECTRUM_HPP
+
+#include "delegate.hpp"
+#include "mailbox.hpp"
+#include "ring_buffer.hpp"
+#include "telemetry_protocol.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sensors {
+
+/**
+ * @brief ジャイロスペクトル解析クラス
+ * 
+ * push()はIMUタスクから呼び出し、サンプルをリングバッファへ積むだけで戻る。
+ * 解析はコア0の低優先度タスクで行い、ホップ長分の新しいサンプルが溜まる毎に
+ * 直近の窓（ハン窓）をFFTする。X/Y軸は実部・虚部に詰めて1回の複素FFTで同時に変換し、
+ * 共役対称性で分離するため、3軸でFFTは2回で済む。
+ * 結果は指数平均したパワースペクトルから求め、Mailboxで公開する
+ */
+class GyroSpectrum {
+public:
+    static constexpr size_t AXES = 3;                                   // 軸数
+    static constexpr size_t MAX_FFT_SIZE = 512;                         // 最大FFT点数
+    static constexpr size_t PEAKS = communication::GyroSpectrumMessage::PEAKS;  // 軸あたりのピーク数
+    static constexpr size_t BANDS = communication::GyroSpectrumMessage::BANDS;  // 軸あたりの帯域数
+    static constexpr size_t INPUT_CAPACITY = 1024;                      // 入力リングの容量（サンプル）
+    
+    /**
+     * @brief 解析設定構造体
+     */
+    struct Config {
+        float sample_hz = 1000.0f;          // サンプリング周波数（Hz）
+        size_t fft_size = 256;              // FFT点数（2のべき乗、MAX_FFT_SIZE以下）
+        size_t hop_size = 128;              // 解析間隔（サンプル、fft_size未満で窓が重なる）
+        float smoothing = 0.7f;             // パワースペクトルの指数平均係数（0で平均なし）
+        float min_peak_hz = 50.0f;          // ピーク探索の下限（Hz）
+        float max_peak_hz = 0.0f;           // ピーク探索の上限（Hz、0でナイキスト）
+        float band_edges_hz[BANDS + 1] = {0.0f, 50.0f, 150.0f, 300.0f, 0.0f};  // 帯域境界（末尾0でナイキスト）
+        int core = 0;                       // 解析タスクのコア
+        UBaseType_t priority = 2;           // 解析タスクの優先度
+        uint32_t stack_size = 4096;         // 解析タスクのスタックサイズ
+    };
+    
+    /**
+     * @brief 解析結果構造体
+     */
+    struct Result {
+        uint32_t time_us;                   // 解析窓の終端時刻（μs、下位32bit）
+        uint32_t frame;                     // 解析回数
+        float bin_hz;                       // 周波数分解能（Hz）
+        float peak_hz[AXES][PEAKS];         // ピーク周波数（Hz、大きい順、0はピークなし）
+        float peak_power[AXES][PEAKS];      // ピークのパワー（(rad/s)^2）
+        float band_energy[AXES][BANDS];     // 帯域エネルギー（(rad/s)^2、帯域内の平均二乗）
+    };
+    
+    /**
+     * @brief 解析統計構造体
+     */
+    struct Stats {
+        uint32_t frames;                    // 解析回数
+        uint32_t dropped_samples;           // 入力リング満杯で破棄したサンプル数
+        uint32_t last_cycles;               // 前回の解析サイクル数
+        uint32_t max_cycles;                // 最大解析サイクル数
+    };
+    
+    /**
+     * @brief 結果通知関数型（解析タスクから呼び出される、動的ノッチへの反映等）
+     */
+    using ResultCallback = common::Delegate<void(const Result&)>;
+    
+public:
+    GyroSpectrum();
+    ~GyroSpectrum();
+    
+    GyroSpectrum(const GyroSpectrum&) = delete;
+    GyroSpectrum& operator=(const GyroSpectrum&) = delete;
+    
+    /**
+     * @brief 初期化（窓関数・FFT表の作成）
+     * @param config 解析設定
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 解析タスク開始
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start();
+    
+    /**
+     * @brief 解析タスク停止
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief サンプルのブロック投入（IMUタスクから呼び出す、単一生産者）
+     * @param gx 角速度X（rad/s）
+     * @param gy 角速度Y（rad/s）
+     * @param gz 角速度Z（rad/s）
+     * @param count サンプル数
+     * @param last_time_us 最後のサンプルの時刻（μs、下位32bit）
+     */
+    void push(const float* gx, const float* gy, const float* gz, size_t count, uint32_t last_time_us);
+    
+    /**
+     * @brief 結果通知の設定（start()前に呼び出す）
+     * @param callback 結果通知関数
+     */
+    void setResultCallback(ResultCallback callback) { callback_ = callback; }
+    
+    /**
+     * @brief 最新の解析結果取得
+     * @param result 結果格納先
+     * @return bool 結果がある場合true
+     */
+    bool getResult(Result& result) const { return result_.read(result); }
+    
+    /**
+     * @brief 統計取得
+     * @return Stats 統計
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 最新結果のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief テレメトリのペイロード生成（TelemetryLink::registerStream用）
+     * @param buffer 出力先
+     * @param capacity 出力先サイズ
+     * @param context GyroSpectrumインスタンス
+     * @return size_t ペイロード長（新しい結果がない場合0）
+     */
+    static size_t fillTelemetry(uint8_t* buffer, size_t capacity, void* context);
+    
+private:
+    /**
+     * @brief 入力サンプル
+     */
+    struct Sample {
+        float x;
+        float y;
+        float z;
+    };
+    
+    Config config_;                                     // 設定
+    bool initialized_;                                  // 初期化状態
+    common::RingBuffer<Sample, INPUT_CAPACITY> input_;  // 入力リング（IMUタスク→解析タスク）
+    std::atomic<uint32_t> last_time_us_;                // 直近サンプルの時刻（μs、下位32bit）
+    ResultCallback callback_;                           // 結果通知
+    
+    float window_[MAX_FFT_SIZE];                        // ハン窓
+    float window_scale_;                                // 片側パワーをHz毎の平均二乗に換算する係数
+    float history_[AXES][MAX_FFT_SIZE];                 // 軸毎の環状サンプル履歴
+    size_t history_head_;                               // 次に書き込む位置
+    size_t history_fill_;                               // 履歴の有効サンプル数
+    size_t since_analysis_;                             // 前回解析からの新サンプル数
+    alignas(16) float work_xy_[2 * MAX_FFT_SIZE];       // X+jYの複素FFT作業領域
+    alignas(16) float work_z_[2 * MAX_FFT_SIZE];        // Zの複素FFT作業領域
+    float power_[AXES][MAX_FFT_SIZE / 2 + 1];           // 平均パワースペクトル
+    uint32_t frames_;                                   // 解析回数
+    
+    common::Mailbox<Result> result_;                    // 最新結果
+    uint32_t telemetry_version_;                        // テレメトリ送信済みの結果の版数
+    std::atomic<uint32_t> last_cycles_;                 // 前回の解析サイクル数
+    std::atomic<uint32_t> max_cycles_;                  // 最大解析サイクル数
+    
+    TaskHandle_t task_;                                 // 解析タスク
+    std::atomic<bool> running_;                         // 解析タスク実行中
+    
+    /**
+     * @brief 解析タスク本体
+     */
+    static void taskEntry(void* arg);
+    
+    /**
+     * @brief 入力リングを履歴へ移す
+     */
+    void drainInput();
+    
+    /**
+     * @brief 1窓分の解析
+     */
+    void analyze();
+    
+    /**
+     * @brief 1軸分のピーク・帯域エネルギー抽出
+     */
+    void extract(size_t axis, Result& result) const;
+};
+
+} // namespace sensors
+
+#endif // GYRO_SPECTRUM_HPP
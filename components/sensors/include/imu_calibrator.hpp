@@ -0,0 +1,239 @@
+/*
+ * IMU Calibrator
+ * 
+ * 起動時のジャイロバイアス・水平（重力方向）の逐次推定
+ * FIFOのサンプル列を逐次統計で集計し、平均の標準誤差が許容値に入った時点で終える（固定時間待たない）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef IMU_CALIBRATOR_HPP
+#define IMU_CALIBRATOR_HPP
+
+#include "imu_sample_buffer.hpp"
+#include "nvs_hal.hpp"
+#include "online_stats.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace sensors {
+
+/**
+ * @brief IMU静止キャリブレーションクラス
+ * 
+ * SYSTEM_STATE_CALIBRATION の間、SensorManager::update() が取得した全サンプルを add() に渡す。
+ * 軸毎の平均・分散を RunningStats で集計し、全軸の平均の標準誤差（σ/√n）が許容値以下になれば
+ * 収束としてバイアスと重力方向を採用する。静かな机上なら 0.1 秒前後で終わり、雑音が大きいほど長くなる。
+ * 集計中の平均から動き判定の閾値以上離れたサンプルが来たら（持ち上げた・触れた）集計をやり直す。
+ * max_duration_us 以内に収束しなければ TIMED_OUT とし、保存済みの補正値（load()）をそのまま使う。
+ * 
+ * 水平は机上の重力方向から求める（取り付けの傾きの補正、ロール・ピッチのトリム角）。
+ * 保存は NvsHal::writeStruct() で行い、制御中（FlashGuard）は後回しにする
+ */
+class ImuCalibrator {
+public:
+    static constexpr uint32_t CALIBRATION_MAGIC = 0x49434131;   // "ICA1"
+    static constexpr float GRAVITY = 9.80665f;                  // 標準重力加速度（m/s^2）
+    
+    /**
+     * @brief キャリブレーション設定構造体
+     */
+    struct Config {
+        float gyro_tolerance_rad_s = 0.0005f;   // ジャイロ平均の標準誤差の許容値（約0.03deg/s）
+        float accel_tolerance_mss = 0.005f;     // 加速度平均の標準誤差の許容値
+        uint32_t min_samples = 200;             // 収束判定を始めるサンプル数（分散推定の安定化）
+        uint32_t max_duration_us = 5000000;     // 収束しなければ打ち切る時間（集計のやり直しを含む）
+        float gyro_motion_rad_s = 0.05f;        // 動き判定: 集計中の平均からのジャイロの偏差
+        float accel_motion_mss = 0.3f;          // 動き判定: 集計中の平均からの加速度の偏差
+        float gravity_tolerance = 0.05f;        // 重力の大きさの許容範囲（GRAVITYに対する比）
+        float max_level_tilt_rad = 0.35f;       // 水平として採用する傾きの上限（約20deg、超えたらバイアスのみ）
+    };
+    
+    /**
+     * @brief 補正値（NVMへの保存形式）
+     */
+    struct Calibration {
+        uint32_t magic;             // CALIBRATION_MAGIC
+        float gyro_bias[3];         // ジャイロバイアス（rad/s）
+        float gravity[3];           // 静止時の加速度（m/s^2、機体座標の重力方向）
+        float level_roll;           // 水平のロールのトリム角（rad）
+        float level_pitch;          // 水平のピッチのトリム角（rad）
+        float gyro_noise;           // ジャイロの標準偏差（全軸の最大、rad/s）
+        float accel_noise;          // 加速度の標準偏差（全軸の最大、m/s^2）
+        uint32_t samples;           // 採用時のサンプル数
+        uint32_t duration_us;       // 開始から収束までの時間（μs）
+        uint8_t level_valid;        // 水平を採用した（傾き・重力の大きさが範囲内）
+        uint8_t reserved[3];        // 予約
+    };
+    
+    /**
+     * @brief 状態列挙型
+     */
+    enum class State : uint8_t {
+        IDLE = 0,           // 未開始
+        COLLECTING,         // 集計中
+        CONVERGED,          // 収束（補正値を採用した）
+        TIMED_OUT           // 打ち切り（補正値は変えない）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t runs;              // start()の回数
+        uint32_t offered;           // 入力サンプル数
+        uint32_t restarts;          // 動きで集計をやり直した回数
+        uint32_t converged;         // 収束した回数
+        uint32_t timeouts;          // 打ち切った回数
+        uint32_t level_rejected;    // 傾き・重力の大きさで水平を採用しなかった回数
+    };
+    
+public:
+    ImuCalibrator();
+    
+    /**
+     * @brief キャリブレーション開始（集計をやり直す、採用済みの補正値は保つ）
+     * @param config 設定
+     */
+    void start(const Config& config);
+    
+    /**
+     * @brief キャリブレーション開始（既定設定）
+     */
+    void start() { start(Config{}); }
+    
+    /**
+     * @brief サンプルの追加
+     * @param gyro 角速度（rad/s、バイアス補正前）
+     * @param accel 加速度（m/s^2）
+     * @param timestamp_us サンプル時刻（μs）
+     * @return State 追加後の状態
+     */
+    State add(const float gyro[3], const float accel[3], uint64_t timestamp_us);
+    
+    /**
+     * @brief バッファの全サンプルの追加（収束・打ち切り後のサンプルは使わない）
+     * @return State 追加後の状態
+     */
+    template<size_t Capacity>
+    State add(const ImuSampleBuffer<Capacity>& buffer) {
+        for (size_t i = 0; i < buffer.count && state_ == State::COLLECTING; i++) {
+            const float gyro[3] = {buffer.gyro_x[i], buffer.gyro_y[i], buffer.gyro_z[i]};
+            const float accel[3] = {buffer.accel_x[i], buffer.accel_y[i], buffer.accel_z[i]};
+            add(gyro, accel, buffer.timestamp_us[i]);
+        }
+        return state_;
+    }
+    
+    /**
+     * @brief ジャイロバイアスの補正（採用済みの補正値がない場合は何もしない）
+     */
+    template<size_t Capacity>
+    void apply(ImuSampleBuffer<Capacity>& buffer) const {
+        if (!isCalibrated()) {
+            return;
+        }
+        for (size_t i = 0; i < buffer.count; i++) {
+            buffer.gyro_x[i] -= active_.gyro_bias[0];
+            buffer.gyro_y[i] -= active_.gyro_bias[1];
+            buffer.gyro_z[i] -= active_.gyro_bias[2];
+        }
+    }
+    
+    /**
+     * @brief 状態取得
+     */
+    State getState() const { return state_; }
+    
+    /**
+     * @brief 集計中か
+     */
+    bool isCollecting() const { return state_ == State::COLLECTING; }
+    
+    /**
+     * @brief 補正値を採用済みか（読み込み・推定のいずれか）
+     */
+    bool isCalibrated() const { return active_.magic == CALIBRATION_MAGIC; }
+    
+    /**
+     * @brief 採用済みの補正値
+     */
+    const Calibration& getCalibration() const { return active_; }
+    
+    /**
+     * @brief 保存が必要か
+     */
+    bool needsSave() const { return dirty_; }
+    
+    /**
+     * @brief 補正値の読み込み（打ち切り時に使う）
+     * @param nvs NVS HAL
+     * @param namespace_name 名前空間名
+     * @param key キー名
+     * @return esp_err_t 読み込み結果（形式不一致はESP_ERR_INVALID_VERSION）
+     */
+    esp_err_t load(hal::NvsHal& nvs, const char* namespace_name = "sensors", const char* key = "imu_cal");
+    
+    /**
+     * @brief 補正値の保存
+     * @param nvs NVS HAL
+     * @param namespace_name 名前空間名
+     * @param key キー名
+     * @return esp_err_t 保存結果（制御中はESP_ERR_NOT_ALLOWED、保存は要求されたまま）
+     */
+    esp_err_t save(hal::NvsHal& nvs, const char* namespace_name = "sensors", const char* key = "imu_cal");
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態名
+     */
+    static const char* stateName(State state);
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    Config config_;                             // 設定
+    State state_;                               // 状態
+    common::RunningStats<float> gyro_[3];       // ジャイロの集計
+    common::RunningStats<float> accel_[3];      // 加速度の集計
+    uint64_t start_us_;                         // 最初のサンプルの時刻
+    bool has_start_;                            // 最初のサンプルを受けた
+    Calibration active_;                        // 採用済みの補正値
+    bool dirty_;                                // 保存が必要
+    Stats stats_;                               // 統計情報
+    
+    /**
+     * @brief 集計のやり直し
+     */
+    void restart();
+    
+    /**
+     * @brief 集計中の平均から動き判定の閾値以上離れているか
+     */
+    bool isMotion(const float gyro[3], const float accel[3]) const;
+    
+    /**
+     * @brief 全軸の平均の標準誤差が許容値以下か
+     */
+    bool hasConverged() const;
+    
+    /**
+     * @brief 集計結果の採用
+     */
+    void adopt(uint32_t duration_us);
+};
+
+} // namespace sensors
+
+#endif // IMU_CALIBRATOR_HPP
@@ -0,0 +1,76 @@
+/*
+ * IMU Sample Buffer
+ * 
+ * IMUサンプルの固定長バッファ（Structure of Arrays）
+ * 推定器が軸毎に連続アクセスできるよう、軸・時刻を配列毎に保持する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef IMU_SAMPLE_BUFFER_HPP
+#define IMU_SAMPLE_BUFFER_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sensors {
+
+/**
+ * @brief IMUサンプル固定長バッファ
+ * 
+ * ヒープを使用せず、1制御周期分のサンプルを保持する
+ * @tparam Capacity 最大サンプル数
+ */
+template<size_t Capacity>
+struct ImuSampleBuffer {
+    static_assert(Capacity > 0, "バッファ容量は1以上");
+    static constexpr size_t CAPACITY = Capacity;
+
+    float accel_x[Capacity];        // 加速度X（m/s^2）
+    float accel_y[Capacity];        // 加速度Y（m/s^2）
+    float accel_z[Capacity];        // 加速度Z（m/s^2）
+    float gyro_x[Capacity];         // 角速度X（rad/s）
+    float gyro_y[Capacity];         // 角速度Y（rad/s）
+    float gyro_z[Capacity];         // 角速度Z（rad/s）
+    uint64_t timestamp_us[Capacity];    // サンプル時刻（センサー時刻基準、μs）
+    size_t count;                   // 格納サンプル数
+    uint32_t overflow_count;        // 容量超過で破棄したサンプル数
+
+    /**
+     * @brief バッファクリア（オーバーフロー計数は保持）
+     */
+    void clear() { count = 0; }
+
+    /**
+     * @brief 満杯確認
+     * @return bool 満杯の場合true
+     */
+    bool full() const { return count >= Capacity; }
+
+    /**
+     * @brief サンプル追加
+     * @return bool 追加できた場合true（満杯時はoverflow_countを加算）
+     */
+    bool push(float ax, float ay, float az, float gx, float gy, float gz, uint64_t t_us) {
+        if (full()) {
+            overflow_count++;
+            return false;
+        }
+        accel_x[count] = ax;
+        accel_y[count] = ay;
+        accel_z[count] = az;
+        gyro_x[count] = gx;
+        gyro_y[count] = gy;
+        gyro_z[count] = gz;
+        timestamp_us[count] = t_us;
+        count++;
+        return true;
+    }
+};
+
+} // namespace sensors
+
+#endif // IMU_SAMPLE_BUFFER_HPP
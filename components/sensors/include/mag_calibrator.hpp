@@ -0,0 +1,199 @@
+/*
+ * Mag Calibrator
+ * 
+ * 地磁気センサーのハードアイアン・ソフトアイアン補正の逐次推定
+ * 楕円体の二次形式を再帰最小二乗（RLS）で飛行中のサンプルから逐次に当てはめ、
+ * サンプル列を保持せず1サンプルあたり一定の計算量で補正値を更新する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MAG_CALIBRATOR_HPP
+#define MAG_CALIBRATOR_HPP
+
+#include "nvs_hal.hpp"
+#include "symmetric_matrix.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace sensors {
+
+/**
+ * @brief 地磁気補正の逐次推定クラス
+ * 
+ * 楕円体 m^T A m + 2 v^T m = 1 の9係数をRLS（忘却係数付き）で推定する。
+ * 直前に採用したサンプルから一定距離以上離れたサンプルのみを使い、同じ姿勢が続く間の
+ * 共分散の発散と偏りを防ぐ。一定数毎に中心（ハードアイアン）と形状（ソフトアイアン）を解き、
+ * 候補は続くサンプルでの半径の誤差が小さい場合のみ採用する（専用の校正モードは不要）。
+ * 補正後の磁場は m_cal = S (m - offset)、|m_cal| は推定した磁場の強さになる。
+ * 
+ * 保存は NvsHal::writeStruct() で行い、制御中（FlashGuard）は後回しにする
+ */
+class MagCalibrator {
+public:
+    static constexpr size_t PARAM_COUNT = 9;                // 楕円体の係数の数
+    static constexpr uint32_t CALIBRATION_MAGIC = 0x4D434131;   // "MCA1"
+    
+    /**
+     * @brief 推定設定構造体
+     */
+    struct Config {
+        float scale_ut = 50.0f;                 // 正規化の磁場（条件数を保つため、地磁気の強さ程度）
+        float forgetting = 0.998f;              // 忘却係数（採用サンプル毎）
+        float initial_covariance = 100.0f;      // 共分散の初期値（正規化単位）
+        float max_covariance = 1.0e4f;          // 共分散の対角がこれを超えたら忘却を止める
+        float min_separation_ut = 4.0f;         // 前回の採用サンプルからの最小距離
+        uint32_t min_samples = 150;             // 解く前に必要な採用サンプル数
+        uint32_t solve_interval = 25;           // 解く間隔・候補の検証サンプル数
+        float max_axis_ratio = 1.5f;            // 楕円体の長軸/短軸の上限
+        float min_field_ut = 15.0f;             // 推定磁場の強さの下限
+        float max_field_ut = 100.0f;            // 推定磁場の強さの上限
+        float max_fit_error = 0.05f;            // 採用する候補の半径の相対誤差（RMS）の上限
+        float save_offset_change_ut = 1.0f;     // 保存済みからこれ以上変わったら保存を要求
+    };
+    
+    /**
+     * @brief 補正値（NVMへの保存形式）
+     */
+    struct Calibration {
+        uint32_t magic;             // CALIBRATION_MAGIC
+        float offset[3];            // ハードアイアン（μT）
+        float soft_iron[9];         // ソフトアイアン行列（行優先、対称）
+        float field_ut;             // 推定磁場の強さ（μT）
+        float fit_error;            // 採用時の半径の相対誤差（RMS）
+        uint32_t samples;           // 採用時までの採用サンプル数
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t offered;           // 入力サンプル数
+        uint32_t accepted;          // RLSに使ったサンプル数
+        uint32_t solves;            // 解いた回数
+        uint32_t rejected;          // 不適（非正定値・軸比・磁場の強さ・誤差）だった候補数
+        uint32_t adopted;           // 採用した候補数
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ（単位行列・オフセットなしの補正から開始）
+     */
+    MagCalibrator();
+    
+    /**
+     * @brief 初期化（推定をやり直す、採用済みの補正値は保つ）
+     * @param config 推定設定
+     */
+    void initialize(const Config& config);
+    
+    /**
+     * @brief 初期化（既定設定）
+     */
+    void initialize() { initialize(Config{}); }
+    
+    /**
+     * @brief サンプルの追加
+     * @param field_ut 補正前の磁場（μT）
+     * @return bool 新しい補正値を採用した場合true
+     */
+    bool add(const float field_ut[3]);
+    
+    /**
+     * @brief 補正の適用
+     * @param field_ut 補正前の磁場（μT）
+     * @param corrected 補正後の磁場（μT）
+     */
+    void apply(const float field_ut[3], float corrected[3]) const;
+    
+    /**
+     * @brief 採用済みの補正値
+     */
+    const Calibration& getCalibration() const { return active_; }
+    
+    /**
+     * @brief 補正値を採用済みか（読み込み・推定のいずれか）
+     */
+    bool isCalibrated() const { return active_.magic == CALIBRATION_MAGIC; }
+    
+    /**
+     * @brief 保存が必要か
+     */
+    bool needsSave() const { return dirty_; }
+    
+    /**
+     * @brief 補正値の読み込み（RLSの初期値にも使う）
+     * @param nvs NVS HAL
+     * @param namespace_name 名前空間名
+     * @param key キー名
+     * @return esp_err_t 読み込み結果（形式不一致はESP_ERR_INVALID_VERSION）
+     */
+    esp_err_t load(hal::NvsHal& nvs, const char* namespace_name = "sensors", const char* key = "mag_cal");
+    
+    /**
+     * @brief 補正値の保存
+     * @param nvs NVS HAL
+     * @param namespace_name 名前空間名
+     * @param key キー名
+     * @return esp_err_t 保存結果（制御中はESP_ERR_NOT_ALLOWED、保存は要求されたまま）
+     */
+    esp_err_t save(hal::NvsHal& nvs, const char* namespace_name = "sensors", const char* key = "mag_cal");
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    Config config_;                                     // 設定
+    float theta_[PARAM_COUNT];                          // 楕円体の係数（正規化単位）
+    common::SymmetricMatrix<PARAM_COUNT> covariance_;   // RLSの共分散
+    float last_accepted_[3];                            // 前回の採用サンプル（μT）
+    bool has_last_;                                     // 前回の採用サンプルあり
+    uint32_t since_solve_;                              // 前回解いてからの採用サンプル数
+    
+    // 検証中の候補（解いた後のsolve_interval個のサンプルで誤差を測る）
+    Calibration candidate_;                             // 候補
+    bool has_candidate_;                                // 候補あり
+    float candidate_error_sum_;                         // 半径の相対誤差の二乗和
+    uint32_t candidate_count_;                          // 検証したサンプル数
+    
+    Calibration active_;                                // 採用済みの補正値
+    Calibration saved_;                                 // 保存済みの補正値
+    bool dirty_;                                        // 保存が必要
+    Stats stats_;                                       // 統計情報
+    
+    /**
+     * @brief RLSの初期化（現在の採用済み補正値、なければ原点中心の球から）
+     */
+    void resetEstimate();
+    
+    /**
+     * @brief RLSの1サンプル更新
+     */
+    void update(const float field_ut[3]);
+    
+    /**
+     * @brief 係数から中心と形状を解く
+     * @return bool 候補として妥当な場合true
+     */
+    bool solve(Calibration& result) const;
+    
+    /**
+     * @brief 単位行列・オフセットなしの補正値
+     */
+    static Calibration identity();
+};
+
+} // namespace sensors
+
+#endif // MAG_CALIBRATOR_HPP
@@ -0,0 +1,248 @@
+/*
+ * PMW3901 Optical Flow
+ * 
+ * PMW3901オプティカルフローセンサーのドライバ
+ * モーションバースト（0x16）で移動量・品質・シャッターを1回のCS区間で読み出し、
+ * 推定器の更新間の移動量を積算して角速度（rad/s）のフローとして渡す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PMW3901_HPP
+#define PMW3901_HPP
+
+#include "spi_hal.hpp"
+#include "spi_bus_scheduler.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief PMW3901ドライバクラス
+ * 
+ * デバイスはSPIモード3・2MHz以下で登録しておくこと。
+ * レジスタ読み取りはアドレス送信後に待ち（tSRAD）が要るため、1つのDMA転送にはまとめられない。
+ * バースト読み取りはバスを占有し、アドレス1バイトをCSを保持したまま送り、待ちの後に
+ * 12バイトのデータを1つのDMA転送としてキューへ投入する（個別のレジスタ読み取り5回分の待ちを1回にする）。
+ * beginBurst()とfinishBurst()の間はCPUが空くため、推定の計算等と重ねられる（バスは占有したまま）。
+ * 
+ * IMUと同じバスではスケジューラを attachScheduler() で設定し、NORMALとして調停する。
+ * バーストはCSを上げると打ち切られ分割できないため、beginBurst() は占有の見積もり（登録時の budget_us、
+ * finishBurst() までに重ねる計算を含む）が次のIMUの窓の前に収まるまで待ってからバスを占有する。
+ * 
+ * beginBurst()・finishBurst()・consume()は同じタスクから呼び出すこと
+ */
+class Pmw3901 {
+public:
+    static constexpr uint8_t PRODUCT_ID = 0x49;     // Product_ID
+    static constexpr size_t BURST_SIZE = 12;        // モーションバーストのデータ長
+    
+    /**
+     * @brief ドライバ設定構造体
+     */
+    struct Config {
+        float radians_per_count = 0.71674f / 35.0f;     // 1カウントの角度（rad、視野42°/35画素）
+        bool swap_xy = false;                           // センサーX/Yの入れ替え（取り付け向き）
+        bool flip_x = false;                            // 入れ替え後のX反転
+        bool flip_y = false;                            // 入れ替え後のY反転
+        uint8_t min_quality = 30;                       // 採用するSQUALの下限（表面の特徴量）
+        uint16_t max_shutter = 0x1C00;                  // 採用するシャッターの上限（暗所で長くなる）
+        TickType_t timeout = pdMS_TO_TICKS(5);          // DMA転送の完了待ち
+    };
+    
+    /**
+     * @brief 1回のバースト読み取り結果
+     */
+    struct Motion {
+        int16_t delta_x;            // X移動量（カウント、取り付け向き補正後）
+        int16_t delta_y;            // Y移動量（カウント、取り付け向き補正後）
+        uint8_t quality;            // SQUAL（表面品質）
+        uint8_t raw_sum;            // RawData_Sum
+        uint8_t raw_max;            // Maximum_RawData
+        uint8_t raw_min;            // Minimum_RawData
+        uint16_t shutter;           // シャッター（13bit）
+        bool moved;                 // Motionビット（前回の読み取りから移動あり）
+        int64_t timestamp_us;       // 読み取り時刻（μs）
+    };
+    
+    /**
+     * @brief 積算したフロー（consume()の結果）
+     */
+    struct FlowSample {
+        float flow_x;               // フローX（rad/s、機体回転の補正前）
+        float flow_y;               // フローY（rad/s、機体回転の補正前）
+        int32_t delta_x;            // 積算したX移動量（カウント）
+        int32_t delta_y;            // 積算したY移動量（カウント）
+        uint32_t dt_us;             // 積算時間（μs）
+        uint16_t reads;             // 積算した読み取り回数
+        uint8_t min_quality;        // 積算中の最小SQUAL
+        uint16_t max_shutter;       // 積算中の最大シャッター
+        bool valid;                 // 品質・シャッター・時間がすべて条件内
+        int64_t timestamp_us;       // 最後の読み取り時刻（μs）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t bursts;            // バースト読み取り回数
+        uint32_t errors;            // 転送失敗回数
+        uint32_t low_quality;       // SQUALが下限未満だった読み取り回数
+        uint32_t long_shutter;      // シャッターが上限を超えた読み取り回数
+        uint32_t samples;           // consume()で渡したフロー数
+        uint32_t rejected;          // 条件外（valid=false）だったフロー数
+        uint32_t last_burst_us;     // 前回のバースト所要時間（μs、占有から解放まで）
+        uint32_t max_burst_us;      // 最大のバースト所要時間（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param spi SPI HAL
+     * @param device PMW3901のSPIデバイスハンドル
+     */
+    Pmw3901(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t device);
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~Pmw3901();
+    
+    Pmw3901(const Pmw3901&) = delete;
+    Pmw3901& operator=(const Pmw3901&) = delete;
+    
+    /**
+     * @brief 初期化（リセット・ID確認・推奨レジスタ設定、約110ms）
+     * @param config ドライバ設定
+     * @return esp_err_t IDが一致しない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 初期化（既定設定）
+     */
+    esp_err_t initialize() { return initialize(Config{}); }
+    
+    /**
+     * @brief バースト読み取りの開始（バスを占有しDMA転送を投入して戻る）
+     * @return esp_err_t 実行結果（失敗時はバスを解放済み）
+     */
+    esp_err_t beginBurst();
+    
+    /**
+     * @brief バースト読み取りの完了待ち（結果の展開・積算とバスの解放）
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t finishBurst();
+    
+    /**
+     * @brief バースト読み取り（beginBurst() + finishBurst()）
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t read();
+    
+    /**
+     * @brief 共有バススケジューラの設定（以後のバス占有はスケジューラを通す）
+     * @param scheduler バススケジューラ（nullptrで直接占有に戻す）
+     * @param client SpiBusScheduler::addClient() の登録番号（Priority::NORMAL）
+     */
+    void attachScheduler(std::shared_ptr<hal::SpiBusScheduler> scheduler, size_t client) {
+        scheduler_ = std::move(scheduler);
+        bus_client_ = client;
+    }
+    
+    /**
+     * @brief 前回の呼び出しからの積算フローを取り出し、積算をやり直す（推定器の更新毎に呼ぶ）
+     * @param sample 積算フロー格納先
+     * @return bool 読み取りが1回以上あった場合true
+     */
+    bool consume(FlowSample& sample);
+    
+    /**
+     * @brief 最新の読み取り結果
+     */
+    const Motion& getMotion() const { return motion_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr uint8_t REG_PRODUCT_ID = 0x00;
+    static constexpr uint8_t REG_MOTION = 0x02;
+    static constexpr uint8_t REG_MOTION_BURST = 0x16;
+    static constexpr uint8_t REG_POWER_UP_RESET = 0x3A;
+    static constexpr uint8_t REG_INVERSE_PRODUCT_ID = 0x5F;
+    static constexpr uint8_t INVERSE_PRODUCT_ID = 0xB6;
+    static constexpr uint8_t POWER_UP_RESET = 0x5A;
+    static constexpr uint32_t READ_DELAY_US = 35;       // アドレス送信から読み取りまで（tSRAD）
+    static constexpr uint32_t WRITE_DELAY_US = 45;      // 書き込み後の待ち（tSWW・tSWR）
+    
+    std::shared_ptr<hal::SpiHal> spi_;          // SPI HAL
+    spi_device_handle_t device_;                // デバイスハンドル
+    std::shared_ptr<hal::SpiBusScheduler> scheduler_;   // 共有バススケジューラ（nullptrで直接占有）
+    size_t bus_client_;                         // スケジューラの登録番号
+    Config config_;                             // 設定
+    bool initialized_;                          // 初期化済み
+    hal::SpiHal::DmaTransaction* transaction_;  // 転送中のDMAディスクリプタ
+    int64_t burst_start_us_;                    // バースト開始時刻
+    Motion motion_;                             // 最新の読み取り結果
+    
+    // 積算（consume()でやり直す）
+    int32_t sum_x_;                             // X移動量
+    int32_t sum_y_;                             // Y移動量
+    uint16_t sum_reads_;                        // 読み取り回数
+    uint8_t sum_min_quality_;                   // 最小SQUAL
+    uint16_t sum_max_shutter_;                  // 最大シャッター
+    int64_t window_start_us_;                   // 積算区間の開始（前回取り出した最後の読み取り時刻）
+    
+    Stats stats_;                               // 統計情報
+    
+    /**
+     * @brief 展開と積算
+     */
+    void accumulate(const uint8_t* data, int64_t timestamp_us);
+    
+    /**
+     * @brief バス占有（スケジューラがあれば調停する）
+     */
+    esp_err_t lockBus();
+    
+    /**
+     * @brief バス占有解除
+     * @param bytes 占有中に転送したバイト数（スケジューラの統計用）
+     */
+    void unlockBus(size_t bytes);
+    
+    /**
+     * @brief レジスタ読み取り（ポーリング、アドレス後の待ちあり）
+     */
+    esp_err_t readRegister(uint8_t reg, uint8_t& value);
+    
+    /**
+     * @brief レジスタ書き込み（ポーリング、書き込み後の待ちあり）
+     */
+    esp_err_t writeRegister(uint8_t reg, uint8_t value);
+    
+    /**
+     * @brief レジスタ設定表の書き込み
+     */
+    esp_err_t writeTable(const uint8_t (*table)[2], size_t count);
+};
+
+} // namespace sensors
+
+#endif // PMW3901_HPP
@@ -0,0 +1,102 @@
+/*
+ * Sensor Manager
+ * 
+ * センサー群の統合管理クラス
+ * 制御周期毎にIMU FIFOを読み出し、サンプルバッファを更新する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SENSOR_MANAGER_HPP
+#define SENSOR_MANAGER_HPP
+
+#include "bmi270_fifo.hpp"
+#include "imu_calibrator.hpp"
+#include "imu_sample_buffer.hpp"
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief センサーマネージャークラス
+ */
+class SensorManager {
+public:
+    static constexpr size_t IMU_BUFFER_CAPACITY = 32;  // 1制御周期あたりの最大IMUサンプル数
+    using ImuBuffer = ImuSampleBuffer<IMU_BUFFER_CAPACITY>;
+
+    /**
+     * @brief センサーマネージャー設定構造体
+     */
+    struct Config {
+        Bmi270Fifo::Config imu;     // IMU FIFO設定
+    };
+
+public:
+    /**
+     * @brief コンストラクタ
+     * @param spi SPI HAL
+     * @param imu_device IMUのSPIデバイスハンドル
+     */
+    SensorManager(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t imu_device);
+
+    /**
+     * @brief 初期化
+     * @param config 設定
+     * @return esp_err_t 初期化結果
+     */
+    esp_err_t initialize(const Config& config);
+
+    /**
+     * @brief センサー更新（制御周期毎に呼び出す）
+     * 
+     * 前回分のIMUサンプルをクリアし、FIFOに溜まったサンプルを読み出す。
+     * キャリブレーション中は読み出した全サンプルを集計し、採用済みのジャイロバイアスを差し引いて渡す
+     * @return esp_err_t 更新結果
+     */
+    esp_err_t update();
+
+    /**
+     * @brief IMUキャリブレーション開始（SYSTEM_STATE_CALIBRATION へ入る時に呼ぶ）
+     * 
+     * 以降の update() で収束・打ち切りまでサンプルを集計する。終了は getImuCalibrator().getState() で確かめる
+     * @param config キャリブレーション設定
+     */
+    void startCalibration(const ImuCalibrator::Config& config) { calibrator_.start(config); }
+
+    /**
+     * @brief IMUキャリブレーション開始（既定設定）
+     */
+    void startCalibration() { calibrator_.start(); }
+
+    /**
+     * @brief IMUキャリブレーション取得（補正値の読み込み・保存・状態確認）
+     */
+    ImuCalibrator& getImuCalibrator() { return calibrator_; }
+    const ImuCalibrator& getImuCalibrator() const { return calibrator_; }
+
+    /**
+     * @brief IMUサンプル取得
+     * @return const ImuBuffer& 直近の update() で取得したサンプル（時刻順）
+     */
+    const ImuBuffer& getImuSamples() const { return imu_samples_; }
+
+    /**
+     * @brief IMU FIFO統計情報取得
+     * @return const Bmi270Fifo::Stats& 統計情報
+     */
+    const Bmi270Fifo::Stats& getImuStats() const { return imu_.getStats(); }
+
+private:
+    Bmi270Fifo imu_;                // IMU FIFOリーダー
+    ImuBuffer imu_samples_;         // IMUサンプルバッファ
+    ImuCalibrator calibrator_;      // ジャイロバイアス・水平のキャリブレーション
+    bool initialized_;              // 初期化状態
+};
+
+} // namespace sensors
+
+#endif // SENSOR_MANAGER_HPP
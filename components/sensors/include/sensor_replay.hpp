@@ -0,0 +1,228 @@
+/*
+ * Sensor Replay
+ * 
+ * 記録済みセンサー値のリプレイ入力（HIL用、SensorManagerの代わりに推定・制御へ渡す）
+ * logsパーティションのブラックボックス、またはUARTで地上から流したフレームを
+ * 記録時刻どおりの間隔（REAL_TIME）か待ちなし（MAX_RATE）で1フレームずつ取り出す
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SENSOR_REPLAY_HPP
+#define SENSOR_REPLAY_HPP
+
+#include "sensor_manager.hpp"
+#include "blackbox_format.hpp"
+#include "partition_log.hpp"
+#include "ring_buffer.hpp"
+#include "telemetry_protocol.hpp"
+#include "uart_hal.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace sensors {
+
+/**
+ * @brief リプレイの1フレーム（物理量、1制御周期分）
+ */
+struct ReplayFrame {
+    static constexpr uint8_t FLAG_RANGE = communication::ReplayFrameMessage::FLAG_RANGE;   // rangeが有効
+    static constexpr uint8_t FLAG_FLOW = communication::ReplayFrameMessage::FLAG_FLOW;     // flowが有効
+    
+    uint32_t time_us;           // 記録時刻（μs）
+    float gyro[3];              // 角速度（rad/s）
+    float accel[3];             // 加速度（m/s^2）
+    float setpoint[4];          // 指令 ロール, ピッチ, ヨー, 推力
+    float range;                // ToF距離（m）
+    float flow[2];              // 並進フロー X, Y（rad/s）
+    uint8_t flags;              // FLAG_*
+};
+
+/**
+ * @brief センサーリプレイクラス
+ * 
+ * 入力元:
+ * - PARTITION: logsパーティションのブラックボックスを古い順に復号する。
+ *   ブラックボックスはIMU・指令のみを記録するため、ToF・フローは常に無効になる
+ *   （量子化後の値を物理量へ戻すので、同じ記録からは毎回同じ入力になる）
+ * - UART: 地上ツール（tools/replay_stream.py）がテレメトリと同じフレーム形式で送る
+ *   ReplayFrameMessage を受け取る。ToF・フローも送れる
+ * 
+ * next()・update()は1つのタスクから呼び出すこと。
+ * REAL_TIMEでは先頭フレームを基準に記録時刻の差分だけ待ち、遅れた場合は待たずに返す（遅れは統計に残す）
+ */
+class SensorReplay {
+public:
+    using ImuBuffer = SensorManager::ImuBuffer;
+    
+    /**
+     * @brief 入力元列挙型
+     */
+    enum class Source : uint8_t {
+        PARTITION = 0,      // logsパーティションのブラックボックス
+        UART                // UARTで受信するフレーム
+    };
+    
+    /**
+     * @brief 再生速度列挙型
+     */
+    enum class Pacing : uint8_t {
+        REAL_TIME = 0,      // 記録時刻どおりの間隔
+        MAX_RATE            // 待ちなし（処理が終わり次第次のフレーム）
+    };
+    
+    /**
+     * @brief リプレイ設定構造体
+     */
+    struct Config {
+        Pacing pacing = Pacing::REAL_TIME;      // 再生速度
+        uint32_t session = 0;                   // 再生するセッション番号（PARTITION、0で最新）
+        uint32_t uart_timeout_ms = 1000;        // 受信待ちの上限（UART、超えるとESP_ERR_TIMEOUT）
+        uint32_t spin_threshold_us = 2000;      // 待ちがこれ未満ならvTaskDelayせず空回りする（μs）
+    };
+    
+    /**
+     * @brief 統計構造体
+     */
+    struct Stats {
+        uint32_t frames;                // 取り出したフレーム数
+        uint32_t blocks;                // 復号したブロック数（PARTITION）
+        uint32_t bad_records;           // 読めなかったレコード・ブロック数（PARTITION）
+        uint32_t dropped_frames;        // 記録時に欠落していたフレーム数（ブロックヘッダの合計）
+        uint32_t rx_overruns;           // 受信キューが満杯で捨てたフレーム数（UART）
+        uint32_t late_frames;           // 記録時刻に間に合わなかったフレーム数（REAL_TIME）
+        uint32_t max_late_us;           // 最大の遅れ（μs）
+    };
+    
+public:
+    SensorReplay();
+    
+    SensorReplay(const SensorReplay&) = delete;
+    SensorReplay& operator=(const SensorReplay&) = delete;
+    
+    /**
+     * @brief logsパーティションから開く
+     * @param log 開いたパーティションログ（記録は止めておくこと）
+     * @param config リプレイ設定
+     * @return esp_err_t 指定セッションのレコードがない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t openPartition(const storage::PartitionLog& log, const Config& config);
+    
+    /**
+     * @brief UARTから開く
+     * @param uart 開始済みのUART HAL
+     * @param config リプレイ設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t openUart(hal::UartHal& uart, const Config& config);
+    
+    /**
+     * @brief 閉じる
+     */
+    void close();
+    
+    /**
+     * @brief 次のフレーム取得（REAL_TIMEでは記録時刻まで待つ）
+     * @param frame 格納先
+     * @return esp_err_t 終わりに達した場合ESP_ERR_NOT_FOUND、受信待ちの上限を超えた場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t next(ReplayFrame& frame);
+    
+    /**
+     * @brief 次のフレームをIMUバッファへ展開（SensorManager::update()の代わり）
+     * @return esp_err_t next()と同じ
+     */
+    esp_err_t update();
+    
+    /**
+     * @brief 最新フレームのIMUサンプル取得（1サンプル）
+     */
+    const ImuBuffer& getImuSamples() const { return imu_samples_; }
+    
+    /**
+     * @brief 最新フレーム取得
+     */
+    const ReplayFrame& getFrame() const { return frame_; }
+    
+    /**
+     * @brief 再生中のセッション番号（PARTITION）
+     */
+    uint32_t getSession() const { return session_; }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態・統計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief ブラックボックスのフレームを物理量へ戻す
+     * @param source 量子化済みフレーム
+     * @param frame 格納先（ToF・フローは無効）
+     */
+    static void dequantize(const storage::BlackboxFrame& source, ReplayFrame& frame);
+    
+private:
+    static constexpr size_t RX_QUEUE_SIZE = 32;     // 受信済みで未処理のフレーム数（UART）
+    static constexpr size_t RX_CHUNK_SIZE = 256;    // 1回の読み出しバイト数（UART）
+    
+    Source source_;                                 // 入力元
+    Config config_;                                 // 設定
+    bool open_;                                     // 開いている
+    bool ended_;                                    // 終わりに達した
+    const storage::PartitionLog* log_;              // パーティションログ（PARTITION）
+    uint32_t session_;                              // 再生するセッション（PARTITION）
+    uint32_t sector_index_;                         // 次に読むセクタ（最古からの番号、PARTITION）
+    std::vector<uint8_t> block_;                    // ブロックの読み出し先（PARTITION）
+    storage::BlackboxDecoder decoder_;              // ブロック復号（PARTITION）
+    bool block_valid_;                              // 復号中のブロックがある（PARTITION）
+    hal::UartHal* uart_;                            // UART HAL（UART）
+    communication::FrameParser parser_;             // フレームパーサー（UART）
+    std::vector<uint8_t> rx_chunk_;                 // 受信データ（UART）
+    common::RingBuffer<ReplayFrame, RX_QUEUE_SIZE> rx_queue_;   // 受信済みフレーム（UART）
+    bool rx_end_;                                   // 最終フレームを受信した（UART）
+    ReplayFrame frame_;                             // 最新フレーム
+    ImuBuffer imu_samples_;                         // 最新フレームのIMUサンプル
+    bool paced_;                                    // 記録時刻の基準がある
+    uint32_t first_time_us_;                        // 基準フレームの記録時刻
+    int64_t start_us_;                              // 基準フレームを返した時刻
+    Stats stats_;                                   // 統計
+    
+    /**
+     * @brief 開く処理の共通部分
+     */
+    void resetState(Source source, const Config& config);
+    
+    /**
+     * @brief パーティションから次のフレーム
+     */
+    esp_err_t nextFromPartition(ReplayFrame& frame);
+    
+    /**
+     * @brief UARTから次のフレーム
+     */
+    esp_err_t nextFromUart(ReplayFrame& frame);
+    
+    /**
+     * @brief 記録時刻まで待つ
+     */
+    void pace(uint32_t time_us);
+    
+    /**
+     * @brief 受信フレームのコールバック（FrameParserから呼び出される）
+     */
+    static void onFrame(const communication::Frame& frame, void* context);
+};
+
+} // namespace sensors
+
+#endif // SENSOR_REPLAY_HPP
@@ -0,0 +1,157 @@
+/*
+ * Sensor Scheduler
+ * 
+ * IMUデータレディ割り込み駆動のセンサータスクスケジューラ
+ * ISRからタスク通知でセンサータスクを起床させ、割り込みから読み取り開始までの遅延を計測する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SENSOR_SCHEDULER_HPP
+#define SENSOR_SCHEDULER_HPP
+
+#include "gpio_hal.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief 遅延ヒストグラム構造体
+ * 
+ * ビン i は [2^(i-1), 2^i) μs（ビン0は1μs未満）、最終ビンはそれ以上を全て含む
+ */
+struct LatencyHistogram {
+    static constexpr size_t BIN_COUNT = 16;
+
+    uint32_t bins[BIN_COUNT];   // 度数
+    uint32_t count;             // 総サンプル数
+    uint32_t min_us;            // 最小遅延（μs）
+    uint32_t max_us;            // 最大遅延（μs）
+    uint64_t sum_us;            // 遅延合計（μs、平均算出用）
+
+    /**
+     * @brief 遅延サンプル追加
+     * @param latency_us 遅延（μs）
+     */
+    void add(uint32_t latency_us) {
+        size_t bin = (latency_us == 0) ? 0 : static_cast<size_t>(32 - __builtin_clz(latency_us));
+        if (bin >= BIN_COUNT) {
+            bin = BIN_COUNT - 1;
+        }
+        bins[bin]++;
+        if (count == 0 || latency_us < min_us) {
+            min_us = latency_us;
+        }
+        if (latency_us > max_us) {
+            max_us = latency_us;
+        }
+        sum_us += latency_us;
+        count++;
+    }
+
+    /**
+     * @brief 平均遅延取得
+     * @return uint32_t 平均遅延（μs）
+     */
+    uint32_t meanUs() const { return count ? static_cast<uint32_t>(sum_us / count) : 0; }
+};
+
+/**
+ * @brief センサースケジューラクラス
+ * 
+ * 使用例（センサータスク内）:
+ *   scheduler.start(xTaskGetCurrentTaskHandle());
+ *   while (true) {
+ *       if (scheduler.waitForDataReady(pdMS_TO_TICKS(5))) {
+ *           sensor_manager.update();
+ *       }
+ *   }
+ */
+class SensorScheduler {
+public:
+    /**
+     * @brief コンストラクタ
+     * @param gpio GPIO HAL
+     * @param data_ready_pin IMUデータレディ割り込みピン
+     * @param edge 割り込みエッジ
+     */
+    SensorScheduler(std::shared_ptr<hal::GpioHal> gpio, gpio_num_t data_ready_pin, 
+                    hal::GpioHal::InterruptType edge = hal::GpioHal::InterruptType::POSEDGE);
+
+    /**
+     * @brief デストラクタ
+     */
+    ~SensorScheduler();
+
+    SensorScheduler(const SensorScheduler&) = delete;
+    SensorScheduler& operator=(const SensorScheduler&) = delete;
+
+    /**
+     * @brief 割り込み駆動開始
+     * @param sensor_task 通知先のセンサータスク
+     * @return esp_err_t 開始結果
+     */
+    esp_err_t start(TaskHandle_t sensor_task);
+
+    /**
+     * @brief 割り込み駆動停止
+     * @return esp_err_t 停止結果
+     */
+    esp_err_t stop();
+
+    /**
+     * @brief データレディ待ち（センサータスクから呼び出す）
+     * 
+     * 起床時に割り込みからの遅延をヒストグラムへ記録する
+     * @param timeout タイムアウト時間
+     * @return bool データレディで起床した場合true、タイムアウト時false
+     */
+    bool waitForDataReady(TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief 遅延ヒストグラム取得
+     * @return LatencyHistogram ヒストグラムのコピー
+     */
+    LatencyHistogram getLatencyHistogram() const;
+
+    /**
+     * @brief 遅延ヒストグラムリセット
+     */
+    void resetLatencyHistogram();
+
+    /**
+     * @brief 取りこぼした割り込み数取得
+     * 
+     * 前回の起床から次の起床までに複数回割り込みが発生した場合に加算される
+     * @return uint32_t 取りこぼし数
+     */
+    uint32_t getMissedCount() const { return missed_count_; }
+
+    /**
+     * @brief データレディ割り込みハンドラ（ISRコンテキスト）
+     * @param pin ピン番号
+     * @param level ピンレベル
+     * @param context スケジューラインスタンス
+     */
+    static void onDataReadyIsr(gpio_num_t pin, bool level, void* context);
+
+private:
+    std::shared_ptr<hal::GpioHal> gpio_;        // GPIO HAL
+    gpio_num_t pin_;                            // データレディピン
+    hal::GpioHal::InterruptType edge_;          // 割り込みエッジ
+    TaskHandle_t task_;                         // 通知先タスク
+    std::atomic<uint32_t> irq_timestamp_us_;    // 直近の割り込み時刻（esp_timer下位32bit）
+    LatencyHistogram histogram_;                // 遅延ヒストグラム（センサータスクのみ更新）
+    uint32_t missed_count_;                     // 取りこぼし割り込み数
+    bool running_;                              // 動作状態
+};
+
+} // namespace sensors
+
+#endif // SENSOR_SCHEDULER_HPP
@@ -0,0 +1,378 @@
+/*
+ * Sensor Suite
+ * 
+ * センサードライバのコンパイル時合成
+ * 具象ドライバ型の組（std::tuple）をテンプレート引数で受け取り、周期処理を仮想関数なしで展開する。
+ * ツール（CLI等）向けには仮想インターフェースのアダプタも用意する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SENSOR_SUITE_HPP
+#define SENSOR_SUITE_HPP
+
+#include "i2c_hal.hpp"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+namespace sensors {
+
+/**
+ * @brief I2Cバッチのスロットを使うドライバ（Bmp280・Bmm150）
+ */
+template<typename T>
+concept BatchedSensor = requires(T& sensor, hal::I2cHal::Transaction& slot, int64_t now_us) {
+    { sensor.prepare(slot, now_us) } -> std::same_as<bool>;
+    sensor.complete(slot, now_us);
+};
+
+/**
+ * @brief 転送の投入と完了待ちを分けられるドライバ（Pmw3901）
+ */
+template<typename T>
+concept SplitSensor = requires(T& sensor) {
+    { sensor.beginBurst() } -> std::same_as<esp_err_t>;
+    { sensor.finishBurst() } -> std::same_as<esp_err_t>;
+};
+
+/**
+ * @brief 単独の周期処理を持つドライバ（Vl53l0x）
+ */
+template<typename T>
+concept ServicedSensor = requires(T& sensor) {
+    { sensor.service() } -> std::same_as<esp_err_t>;
+};
+
+/**
+ * @brief SensorSuiteに組み込めるドライバ
+ */
+template<typename T>
+concept SuiteSensor = (BatchedSensor<T> || SplitSensor<T> || ServicedSensor<T>) && requires(const T& sensor) {
+    sensor.dump();
+};
+
+/**
+ * @brief ツール向けのセンサーインターフェース
+ * 
+ * CLI・試験ツールなど周期処理の外から扱うための仮想インターフェース。
+ * 制御周期の処理は SensorSuite::service() を使い、このインターフェースを経由しないこと
+ */
+class SensorInterface {
+public:
+    virtual ~SensorInterface() = default;
+    
+    /**
+     * @brief センサー名
+     */
+    virtual const char* name() const = 0;
+    
+    /**
+     * @brief 単独の周期処理
+     * @return esp_err_t 実行結果
+     */
+    virtual esp_err_t service() = 0;
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    virtual void dump() const = 0;
+};
+
+/**
+ * @brief 具象ドライバをSensorInterfaceに見せるアダプタ
+ * @tparam T ドライバ型
+ */
+template<SuiteSensor T>
+class SensorAdapter : public SensorInterface {
+public:
+    explicit SensorAdapter(T& sensor, const char* name = "sensor") : sensor_(sensor), name_(name) {}
+    
+    const char* name() const override { return name_; }
+    
+    esp_err_t service() override {
+        if constexpr (ServicedSensor<T>) {
+            return sensor_.service();
+        } else if constexpr (SplitSensor<T>) {
+            esp_err_t ret = sensor_.beginBurst();
+            return (ret == ESP_OK) ? sensor_.finishBurst() : ret;
+        } else {
+            return ESP_ERR_NOT_SUPPORTED;
+        }
+    }
+    
+    void dump() const override { sensor_.dump(); }
+    
+    /**
+     * @brief 名前の設定
+     */
+    void setName(const char* name) { name_ = name; }
+    
+private:
+    T& sensor_;             // ドライバ
+    const char* name_;      // センサー名
+};
+
+/**
+ * @brief センサードライバの合成クラス
+ * 
+ * 1周期の処理は次の順に展開される（全てコンパイル時に決まり、間接呼び出しはない）:
+ *   1. SplitSensor の転送を投入（SPI DMAをI2C転送と並行させる）
+ *   2. BatchedSensor の prepare() で埋まったスロットを executeBatch() 1回で実行し complete() に渡す
+ *   3. それ以外の ServicedSensor の service()
+ *   4. SplitSensor の完了待ち
+ * 
+ * 使用例（センサータスク内）:
+ *   SensorSuite suite(i2c, bmp280, bmm150, vl53l0x, pmw3901);
+ *   suite.setName(0, "baro");
+ *   while (true) {
+ *       scheduler.waitForDataReady(pdMS_TO_TICKS(5));
+ *       suite.service();
+ *       suite.get<Bmp280>().consume(baro_sample);
+ *   }
+ * 
+ * ドライバは呼び出し側が所有し、SensorSuiteより長く生存させること
+ * @tparam Sensors ドライバ型（重複不可）
+ */
+template<SuiteSensor... Sensors>
+class SensorSuite {
+public:
+    static constexpr size_t SIZE = sizeof...(Sensors);
+    static constexpr size_t BATCH_SLOTS = (static_cast<size_t>(BatchedSensor<Sensors>) + ... + 0);
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t passes;            // 周期処理の回数
+        uint32_t batches;           // executeBatch()の回数
+        uint32_t slots;             // 実行したスロット数
+        uint32_t errors;            // 失敗した周期処理の回数
+        uint32_t last_us;           // 直近の周期処理時間（μs）
+        uint32_t max_us;            // 最大の周期処理時間（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param i2c I2C HAL（BatchedSensorがない場合はnullptr可）
+     * @param sensors ドライバ（初期化済み）
+     */
+    explicit SensorSuite(std::shared_ptr<hal::I2cHal> i2c, Sensors&... sensors)
+        : i2c_(std::move(i2c))
+        , sensors_(sensors...)
+        , adapters_(SensorAdapter<Sensors>(sensors)...)
+        , interfaces_(makeInterfaces(std::index_sequence_for<Sensors...>{}))
+        , slots_{}
+        , owners_{}
+        , stats_{} {
+    }
+    
+    SensorSuite(const SensorSuite&) = delete;
+    SensorSuite& operator=(const SensorSuite&) = delete;
+    
+    /**
+     * @brief 1周期の処理
+     * @param now_us 現在時刻（μs）
+     * @return esp_err_t 全て成功した場合ESP_OK、それ以外は最初の失敗
+     */
+    esp_err_t service(int64_t now_us) {
+        esp_err_t result = ESP_OK;
+        auto record = [&result](esp_err_t ret) {
+            if (result == ESP_OK && ret != ESP_OK) {
+                result = ret;
+            }
+        };
+        
+        std::array<bool, SIZE> begun{};
+        forEachIndexed([&](auto& sensor, size_t index) {
+            using T = std::remove_reference_t<decltype(sensor)>;
+            if constexpr (SplitSensor<T> && !BatchedSensor<T>) {
+                esp_err_t ret = sensor.beginBurst();
+                begun[index] = (ret == ESP_OK);
+                record(ret);
+            }
+        });
+        
+        if constexpr (BATCH_SLOTS > 0) {
+            record(serviceBatch(now_us));
+        }
+        
+        forEachIndexed([&](auto& sensor, size_t) {
+            using T = std::remove_reference_t<decltype(sensor)>;
+            if constexpr (ServicedSensor<T> && !BatchedSensor<T> && !SplitSensor<T>) {
+                record(sensor.service());
+            }
+        });
+        
+        forEachIndexed([&](auto& sensor, size_t index) {
+            using T = std::remove_reference_t<decltype(sensor)>;
+            if constexpr (SplitSensor<T> && !BatchedSensor<T>) {
+                if (begun[index]) {
+                    record(sensor.finishBurst());
+                }
+            }
+        });
+        
+        const uint32_t elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - now_us);
+        stats_.last_us = elapsed_us;
+        if (elapsed_us > stats_.max_us) {
+            stats_.max_us = elapsed_us;
+        }
+        stats_.passes++;
+        if (result != ESP_OK) {
+            stats_.errors++;
+        }
+        return result;
+    }
+    
+    /**
+     * @brief 1周期の処理（現在時刻で実行）
+     */
+    esp_err_t service() { return service(esp_timer_get_time()); }
+    
+    /**
+     * @brief 全ドライバへの関数適用（引数は具象型の参照）
+     * @param function 適用する関数
+     */
+    template<typename Function>
+    void forEach(Function&& function) {
+        std::apply([&function](auto&... sensor) { (function(sensor), ...); }, sensors_);
+    }
+    
+    /**
+     * @brief ドライバ取得（添字）
+     */
+    template<size_t Index>
+    auto& get() { return std::get<Index>(sensors_); }
+    
+    /**
+     * @brief ドライバ取得（型）
+     */
+    template<typename T>
+    T& get() { return std::get<T&>(sensors_); }
+    
+    /**
+     * @brief ツール向けインターフェース取得
+     * @param index ドライバの添字
+     * @return SensorInterface* 範囲外はnullptr
+     */
+    SensorInterface* tooling(size_t index) { return (index < SIZE) ? interfaces_[index] : nullptr; }
+    
+    /**
+     * @brief ツール向けインターフェースの名前設定
+     * @param index ドライバの添字
+     * @param name センサー名（静的な文字列）
+     */
+    void setName(size_t index, const char* name) {
+        forEachAdapter([index, name](auto& adapter, size_t i) {
+            if (i == index) {
+                adapter.setName(name);
+            }
+        });
+    }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 全ドライバの状態のログ出力（CLI用）
+     */
+    void dump() const {
+        for (const SensorInterface* sensor : interfaces_) {
+            sensor->dump();
+        }
+    }
+    
+private:
+    std::shared_ptr<hal::I2cHal> i2c_;                      // I2C HAL
+    std::tuple<Sensors&...> sensors_;                       // ドライバ
+    std::tuple<SensorAdapter<Sensors>...> adapters_;        // ツール向けアダプタ
+    std::array<SensorInterface*, SIZE> interfaces_;         // アダプタへのポインタ（adapters_を指す）
+    std::array<hal::I2cHal::Transaction, (BATCH_SLOTS > 0) ? BATCH_SLOTS : 1> slots_;  // バッチのスロット（dataの容量は再利用）
+    std::array<uint8_t, (BATCH_SLOTS > 0) ? BATCH_SLOTS : 1> owners_;  // スロットを埋めたドライバの添字
+    Stats stats_;                                           // 統計情報
+    
+    template<typename Function>
+    void forEachIndexed(Function&& function) {
+        forEachIndexedImpl(function, std::index_sequence_for<Sensors...>{});
+    }
+    
+    template<typename Function, size_t... Index>
+    void forEachIndexedImpl(Function& function, std::index_sequence<Index...>) {
+        (function(std::get<Index>(sensors_), Index), ...);
+    }
+    
+    template<typename Function>
+    void forEachAdapter(Function&& function) {
+        forEachAdapterImpl(function, std::index_sequence_for<Sensors...>{});
+    }
+    
+    template<typename Function, size_t... Index>
+    void forEachAdapterImpl(Function& function, std::index_sequence<Index...>) {
+        (function(std::get<Index>(adapters_), Index), ...);
+    }
+    
+    template<size_t... Index>
+    std::array<SensorInterface*, SIZE> makeInterfaces(std::index_sequence<Index...>) {
+        return { static_cast<SensorInterface*>(&std::get<Index>(adapters_))... };
+    }
+    
+    /**
+     * @brief BatchedSensorのスロットを1回のexecuteBatch()で実行
+     */
+    esp_err_t serviceBatch(int64_t now_us) {
+        size_t count = 0;
+        forEachIndexed([&](auto& sensor, size_t index) {
+            using T = std::remove_reference_t<decltype(sensor)>;
+            if constexpr (BatchedSensor<T>) {
+                if (sensor.prepare(slots_[count], now_us)) {
+                    owners_[count] = static_cast<uint8_t>(index);
+                    count++;
+                }
+            }
+        });
+        if (count == 0) {
+            return ESP_OK;
+        }
+        
+        const esp_err_t ret = i2c_->executeBatch(slots_.data(), count);
+        const int64_t done_us = esp_timer_get_time();
+        stats_.batches++;
+        stats_.slots += count;
+        
+        // スロットは添字の昇順で埋まるため、同じ順に走査して持ち主に返す
+        size_t slot = 0;
+        forEachIndexed([&](auto& sensor, size_t index) {
+            using T = std::remove_reference_t<decltype(sensor)>;
+            if constexpr (BatchedSensor<T>) {
+                if (slot < count && owners_[slot] == index) {
+                    sensor.complete(slots_[slot], done_us);
+                    slot++;
+                }
+            }
+        });
+        return ret;
+    }
+};
+
+/**
+ * @brief 推論補助（SensorSuite suite(i2c, bmp280, bmm150)）
+ */
+template<typename... Sensors>
+SensorSuite(std::shared_ptr<hal::I2cHal>, Sensors&...) -> SensorSuite<Sensors...>;
+
+} // namespace sensors
+
+#endif // SENSOR_SUITE_HPP
@@ -0,0 +1,265 @@
+/*
+ * VL53L0X ToF
+ * 
+ * VL53L0X測距（ToF）センサーのドライバ
+ * 連続測定とGPIO1のデータレディ割り込みで測距し、結果はI2Cの非同期読み取りで取得する。
+ * センサータスクは測定完了をポーリングで待たず、割り込み時刻の付いた全サンプルを受け取る
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef VL53L0X_HPP
+#define VL53L0X_HPP
+
+#include "i2c_hal.hpp"
+#include "gpio_hal.hpp"
+#include "ring_buffer.hpp"
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace sensors {
+
+/**
+ * @brief VL53L0Xドライバクラス
+ * 
+ * initialize()で校正を含む初期化（ブロッキング、約50ms）、start()で連続測定を開始する。
+ * 以降はセンサータスクの周期毎にservice()を呼ぶ。service()はブロックせず、
+ * 割り込みがあれば結果の非同期読み取りを投入し、完了していればサンプルをキューへ積んで
+ * 割り込みをクリアする（クリアの1バイト書き込みのみ同期）。
+ * サンプルの時刻は割り込み（測定完了）時刻から測定時間の半分を引いた測定の中心時刻とする。
+ * 
+ * service()・pop()は同じタスクから呼び出すこと
+ */
+class Vl53l0x {
+public:
+    static constexpr uint8_t DEFAULT_ADDRESS = 0x29;    // 既定のI2Cアドレス
+    static constexpr uint8_t MODEL_ID = 0xEE;           // IDENTIFICATION_MODEL_ID
+    static constexpr size_t RESULT_SIZE = 12;           // 結果ブロックの読み取り長
+    static constexpr size_t QUEUE_SIZE = 8;             // サンプルキュー長（2のべき乗）
+    
+    /**
+     * @brief ドライバ設定構造体
+     */
+    struct Config {
+        uint32_t period_ms = 33;                        // 連続測定の間隔（0で間隔なしの連続測定）
+        float signal_rate_limit = 0.25f;                // 返り光量の下限（MCPS）
+        uint16_t min_range_mm = 20;                     // 採用する距離の下限
+        uint16_t max_range_mm = 2000;                   // 採用する距離の上限
+        uint32_t measurement_latency_us = 16500;        // 測定の中心から割り込みまで（既定の測定時間33msの半分）
+        uint32_t stall_timeout_ms = 200;                // 割り込みが途絶えたとみなす時間（割り込みを再クリア）
+        uint32_t scl_speed_hz = 400000;                 // I2Cクロック
+        TickType_t timeout = pdMS_TO_TICKS(5);          // 同期アクセスのタイムアウト
+    };
+    
+    /**
+     * @brief 測距サンプル
+     */
+    struct RangeSample {
+        float range_m;              // 距離（m）
+        uint16_t range_mm;          // 距離（mm）
+        uint16_t signal_rate;       // 返り光量（MCPS、9.7固定小数点）
+        uint16_t ambient_rate;      // 環境光（MCPS、9.7固定小数点）
+        uint8_t status;             // デバイスの測距ステータス（11: 正常）
+        bool valid;                 // ステータス正常かつ距離が範囲内
+        uint32_t sequence;          // 割り込みの通し番号（欠落の検出用）
+        int64_t timestamp_us;       // 測定の中心時刻（μs）
+    };
+    
+    /**
+     * @brief 統計情報構造体
+     */
+    struct Stats {
+        uint32_t interrupts;        // データレディ割り込み回数
+        uint32_t samples;           // キューへ積んだサンプル数
+        uint32_t invalid;           // ステータス異常・範囲外のサンプル数
+        uint32_t missed;            // 割り込みの間隔から推定した取りこぼし測定数
+        uint32_t errors;            // I2C転送失敗回数
+        uint32_t busy;              // 前回の読み取りが未完了で投入できなかった回数
+        uint32_t dropped;           // キュー満杯で破棄したサンプル数
+        uint32_t recoveries;        // 割り込み途絶からの復帰回数
+        uint32_t last_latency_us;   // 割り込みからサンプル取得まで（μs）
+        uint32_t max_latency_us;    // 最大の取得遅延（μs）
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param i2c I2C HAL
+     * @param gpio GPIO HAL（GPIO1割り込み用）
+     * @param interrupt_pin GPIO1を接続したピン
+     * @param address I2Cアドレス
+     */
+    Vl53l0x(std::shared_ptr<hal::I2cHal> i2c, std::shared_ptr<hal::GpioHal> gpio, 
+            gpio_num_t interrupt_pin, uint8_t address = DEFAULT_ADDRESS);
+    
+    /**
+     * @brief デストラクタ
+     */
+    ~Vl53l0x();
+    
+    Vl53l0x(const Vl53l0x&) = delete;
+    Vl53l0x& operator=(const Vl53l0x&) = delete;
+    
+    /**
+     * @brief 初期化（ID確認・SPAD設定・推奨レジスタ設定・基準校正）
+     * @param config ドライバ設定
+     * @return esp_err_t IDが一致しない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 初期化（既定設定）
+     */
+    esp_err_t initialize() { return initialize(Config{}); }
+    
+    /**
+     * @brief 連続測定とデータレディ割り込みの開始
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t start();
+    
+    /**
+     * @brief 連続測定の停止
+     * @return esp_err_t 実行結果
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief 周期処理（ブロックしない、センサータスクの周期毎に呼ぶ）
+     * @return esp_err_t 実行結果（転送失敗時はエラー、次の割り込みで再開する）
+     */
+    esp_err_t service();
+    
+    /**
+     * @brief サンプルの取り出し（古い順）
+     * @param sample サンプル格納先
+     * @return bool 取り出した場合true
+     */
+    bool pop(RangeSample& sample) { return queue_.pop(sample); }
+    
+    /**
+     * @brief 最新のサンプル
+     */
+    const RangeSample& getLatest() const { return latest_; }
+    
+    /**
+     * @brief 測定中か
+     */
+    bool isRunning() const { return running_; }
+    
+    /**
+     * @brief 統計情報取得
+     */
+    const Stats& getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    static constexpr uint8_t REG_SYSRANGE_START = 0x00;
+    static constexpr uint8_t REG_SYSTEM_SEQUENCE_CONFIG = 0x01;
+    static constexpr uint8_t REG_SYSTEM_INTERMEASUREMENT_PERIOD = 0x04;
+    static constexpr uint8_t REG_SYSTEM_INTERRUPT_CONFIG_GPIO = 0x0A;
+    static constexpr uint8_t REG_SYSTEM_INTERRUPT_CLEAR = 0x0B;
+    static constexpr uint8_t REG_RESULT_INTERRUPT_STATUS = 0x13;
+    static constexpr uint8_t REG_RESULT_RANGE_STATUS = 0x14;
+    static constexpr uint8_t REG_MSRC_CONFIG_CONTROL = 0x60;
+    static constexpr uint8_t REG_FINAL_RANGE_MIN_COUNT_RATE_RTN_LIMIT = 0x44;
+    static constexpr uint8_t REG_GPIO_HV_MUX_ACTIVE_HIGH = 0x84;
+    static constexpr uint8_t REG_VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV = 0x89;
+    static constexpr uint8_t REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_0 = 0xB0;
+    static constexpr uint8_t REG_OSC_CALIBRATE_VAL = 0xF8;
+    static constexpr uint8_t REG_IDENTIFICATION_MODEL_ID = 0xC0;
+    static constexpr uint8_t RANGE_STATUS_VALID = 11;
+    
+    std::shared_ptr<hal::I2cHal> i2c_;          // I2C HAL
+    std::shared_ptr<hal::GpioHal> gpio_;        // GPIO HAL
+    gpio_num_t pin_;                            // GPIO1を接続したピン
+    uint8_t address_;                           // I2Cアドレス
+    Config config_;                             // 設定
+    bool initialized_;                          // 初期化済み
+    bool running_;                              // 測定中
+    uint8_t stop_variable_;                     // 測定開始・停止時に書き戻す内部値
+    
+    // ISR → service()
+    std::atomic<uint32_t> irq_count_;           // 割り込み回数（ISRのみ更新）
+    std::atomic<uint32_t> irq_timestamp_us_;    // 最後の割り込み時刻（下位32bit）
+    
+    // 非同期読み取り（完了コールバック → service()）
+    std::atomic<bool> read_done_;               // 読み取り完了
+    esp_err_t read_result_;                     // 読み取り結果（read_done_の前に書く）
+    bool reading_;                              // 読み取り投入済み
+    uint8_t result_[RESULT_SIZE];               // 結果ブロック（完了コールバックまで書き換えない）
+    
+    uint32_t handled_count_;                    // 処理済みの割り込み回数
+    int64_t read_irq_us_;                       // 読み取り中のサンプルの割り込み時刻
+    int64_t last_irq_us_;                       // 前回処理した割り込み時刻（取りこぼし推定用、0で未処理）
+    int64_t last_activity_us_;                  // 最後に割り込みを処理した時刻（途絶検出用）
+    
+    common::RingBuffer<RangeSample, QUEUE_SIZE> queue_;     // サンプルキュー
+    RangeSample latest_;                                    // 最新のサンプル
+    Stats stats_;                                           // 統計情報
+    
+    /**
+     * @brief データレディ割り込みハンドラ（ISRコンテキスト）
+     */
+    static void onDataReadyIsr(gpio_num_t pin, bool level, void* context);
+    
+    /**
+     * @brief 非同期読み取り完了コールバック（ISRコンテキストの場合あり）
+     */
+    static bool onReadDone(esp_err_t result, void* user_arg);
+    
+    /**
+     * @brief 完了した読み取りの展開と割り込みクリア
+     */
+    esp_err_t finishRead();
+    
+    /**
+     * @brief 結果ブロックの展開とキューへの追加
+     */
+    void publish(int64_t irq_us);
+    
+    /**
+     * @brief SPAD設定（参照SPADの数と種別をNVMから読んで有効化）
+     */
+    esp_err_t configureSpads();
+    
+    /**
+     * @brief 基準校正（VHV・位相）の1回実行
+     */
+    esp_err_t performSingleRefCalibration(uint8_t vhv_init_byte);
+    
+    /**
+     * @brief 割り込み状態の待ち（初期化時のみ、タスク遅延でポーリング）
+     */
+    esp_err_t waitInterruptStatus(uint32_t timeout_ms);
+    
+    /**
+     * @brief レジスタ書き込み
+     */
+    esp_err_t writeRegister(uint8_t reg, uint8_t value);
+    
+    /**
+     * @brief レジスタ読み取り
+     */
+    esp_err_t readRegister(uint8_t reg, uint8_t& value);
+    
+    /**
+     * @brief レジスタ設定表の書き込み
+     */
+    esp_err_t writeTable(const uint8_t (*table)[2], size_t count);
+};
+
+} // namespace sensors
+
+#endif // VL53L0X_HPP
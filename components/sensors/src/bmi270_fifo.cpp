@@ -0,0 +1,334 @@
+/*
+ * BMI270 FIFO Reader Implementation
+ * 
+ * BMI270 IMUのFIFOバースト読み出し実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bmi270_fifo.hpp"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_sys.h"
+#include <cstring>
+
+namespace sensors {
+
+static const char* TAG = "sensors::Bmi270Fifo";
+
+namespace {
+
+// FIFOフレームヘッダー（ヘッダーモード）
+constexpr uint8_t FIFO_HEADER_ACC = 0x84;           // 加速度のみ
+constexpr uint8_t FIFO_HEADER_GYR = 0x88;           // 角速度のみ
+constexpr uint8_t FIFO_HEADER_GYR_ACC = 0x8C;       // 角速度 + 加速度
+constexpr uint8_t FIFO_HEADER_SKIP = 0x40;          // スキップフレーム
+constexpr uint8_t FIFO_HEADER_SENSORTIME = 0x44;    // sensortimeフレーム
+constexpr uint8_t FIFO_HEADER_INPUT_CFG = 0x48;     // 入力設定変更フレーム
+constexpr uint8_t FIFO_HEADER_OVER_READ = 0x80;     // FIFO空読み
+
+constexpr size_t AXIS_FRAME_SIZE = 6;               // 3軸 x 16bit
+constexpr size_t SENSORTIME_SIZE = 3;
+constexpr size_t INPUT_CFG_SIZE = 4;
+constexpr size_t SKIP_SIZE = 1;
+constexpr size_t SENSORTIME_FRAME_SIZE = 1 + SENSORTIME_SIZE;
+
+constexpr float GRAVITY = 9.80665f;
+constexpr float DEG_TO_RAD = 3.14159265358979f / 180.0f;
+
+inline int16_t toInt16(const uint8_t* p) {
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+} // namespace
+
+Bmi270Fifo::Bmi270Fifo(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t device)
+    : spi_(std::move(spi))
+    , device_(device)
+    , config_{}
+    , stats_{}
+    , tx_buffer_(nullptr)
+    , rx_buffer_(nullptr)
+    , buffer_size_(0)
+    , period_ticks_(0)
+    , accel_scale_(0.0f)
+    , gyro_scale_(0.0f)
+    , sensortime_ticks_(0)
+    , last_sensortime_raw_(0)
+    , sensortime_valid_(false)
+    , scheduler_(nullptr)
+    , bus_client_(0) {
+}
+
+Bmi270Fifo::~Bmi270Fifo() {
+    heap_caps_free(tx_buffer_);
+    heap_caps_free(rx_buffer_);
+}
+
+esp_err_t Bmi270Fifo::initialize(const Config& config) {
+    config_ = config;
+    
+    // バースト転送バッファをDMA対応メモリに確保（4バイト単位）
+    heap_caps_free(tx_buffer_);
+    heap_caps_free(rx_buffer_);
+    buffer_size_ = (config_.burst_buffer_size + SPI_READ_OFFSET + 3) & ~static_cast<size_t>(3);
+    tx_buffer_ = static_cast<uint8_t*>(heap_caps_calloc(1, buffer_size_, MALLOC_CAP_DMA));
+    rx_buffer_ = static_cast<uint8_t*>(heap_caps_calloc(1, buffer_size_, MALLOC_CAP_DMA));
+    if (tx_buffer_ == nullptr || rx_buffer_ == nullptr) {
+        ESP_LOGE(TAG, "DMAバッファ確保失敗 サイズ:%zu", buffer_size_);
+        return ESP_ERR_NO_MEM;
+    }
+    
+    uint8_t chip_id = 0;
+    esp_err_t ret = readRegisters(REG_CHIP_ID, &chip_id, 1);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "チップID読み取り失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (chip_id != CHIP_ID) {
+        ESP_LOGE(TAG, "チップID不一致 期待:0x%02X 実際:0x%02X", CHIP_ID, chip_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    const uint8_t odr = static_cast<uint8_t>(config_.odr);
+    const uint8_t accel_range = static_cast<uint8_t>(config_.accel_range);
+    const uint8_t gyro_range = static_cast<uint8_t>(config_.gyro_range);
+    
+    // 加速度・角速度・温度を有効化し、ODR/レンジ/FIFOを設定
+    const uint8_t settings[][2] = {
+        { REG_PWR_CTRL, 0x0E },                         // acc_en | gyr_en | temp_en
+        { REG_ACC_CONF, static_cast<uint8_t>(0xA0 | odr) },     // filter_perf | bwp=normal
+        { REG_ACC_RANGE, accel_range },
+        { REG_GYR_CONF, static_cast<uint8_t>(0xE0 | odr) },     // filter_perf | noise_perf | bwp=normal
+        { REG_GYR_RANGE, gyro_range },
+        { REG_FIFO_CONFIG_0, 0x02 },                    // fifo_time_en（空読み時にsensortime付加）
+        { REG_FIFO_CONFIG_1, 0xD0 },                    // fifo_gyr_en | fifo_acc_en | fifo_header_en
+    };
+    for (const auto& setting : settings) {
+        ret = writeRegister(setting[0], setting[1]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "レジスタ書き込み失敗 レジスタ:0x%02X エラー:%s", setting[0], esp_err_to_name(ret));
+            return ret;
+        }
+        esp_rom_delay_us(2);
+    }
+    
+    period_ticks_ = 256u >> (odr - static_cast<uint8_t>(Odr::HZ_100));    // sensortime 1LSB = 39.0625μs
+    accel_scale_ = static_cast<float>(2 << accel_range) * GRAVITY / 32768.0f;
+    gyro_scale_ = static_cast<float>(2000 >> gyro_range) * DEG_TO_RAD / 32768.0f;
+    sensortime_valid_ = false;
+    stats_ = {};
+    
+    ret = flush();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "BMI270 FIFO初期化完了 ODR:%dHz バッファ:%zuバイト", 
+             100 << (odr - static_cast<uint8_t>(Odr::HZ_100)), buffer_size_);
+    return ESP_OK;
+}
+
+esp_err_t Bmi270Fifo::flush() {
+    return writeRegister(REG_CMD, CMD_FIFO_FLUSH);
+}
+
+uint32_t Bmi270Fifo::getSamplePeriodUs() const {
+    return period_ticks_ * 625 / 16;
+}
+
+esp_err_t IRAM_ATTR Bmi270Fifo::drainInto(float* ax, float* ay, float* az, float* gx, float* gy, float* gz, 
+                                          uint64_t* t_us, size_t& count, size_t capacity, uint32_t& overflow) {
+    if (rx_buffer_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 共有バスではFIFO長の読み取りとバーストを1回の占有にまとめる（間に他デバイスを入れない）
+    if (scheduler_ != nullptr) {
+        esp_err_t ret = scheduler_->acquire(bus_client_);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    size_t read_length = 0;
+    esp_err_t ret = readFifo(read_length);
+    if (scheduler_ != nullptr) {
+        const size_t bytes = SPI_READ_OFFSET + 2 + (read_length > 0 ? read_length + SPI_READ_OFFSET : 0);
+        scheduler_->release(bus_client_, bytes);
+    }
+    if (ret != ESP_OK || read_length == 0) {
+        return ret;
+    }
+    
+    const uint8_t* p = rx_buffer_ + SPI_READ_OFFSET;
+    const uint8_t* const end = p + read_length;
+    const size_t first = count;
+    size_t frames = 0;
+    bool sensortime_found = false;
+    uint32_t sensortime_raw = 0;
+    bool done = false;
+    
+    while (!done && p < end) {
+        const uint8_t header = *p++;
+        const size_t remaining = static_cast<size_t>(end - p);
+        
+        switch (header) {
+            case FIFO_HEADER_GYR_ACC:
+                if (remaining < 2 * AXIS_FRAME_SIZE) {
+                    done = true;
+                    break;
+                }
+                // フレーム内の並びは角速度 → 加速度
+                if (count < capacity) {
+                    gx[count] = toInt16(&p[0]) * gyro_scale_;
+                    gy[count] = toInt16(&p[2]) * gyro_scale_;
+                    gz[count] = toInt16(&p[4]) * gyro_scale_;
+                    ax[count] = toInt16(&p[6]) * accel_scale_;
+                    ay[count] = toInt16(&p[8]) * accel_scale_;
+                    az[count] = toInt16(&p[10]) * accel_scale_;
+                    count++;
+                } else {
+                    overflow++;
+                }
+                frames++;
+                p += 2 * AXIS_FRAME_SIZE;
+                break;
+            
+            case FIFO_HEADER_ACC:
+            case FIFO_HEADER_GYR:
+                // 共通ODR設定では発生しない単独フレームは読み飛ばす
+                if (remaining < AXIS_FRAME_SIZE) {
+                    done = true;
+                    break;
+                }
+                p += AXIS_FRAME_SIZE;
+                break;
+            
+            case FIFO_HEADER_SKIP:
+                if (remaining < SKIP_SIZE) {
+                    done = true;
+                    break;
+                }
+                stats_.skipped_frames += p[0];
+                p += SKIP_SIZE;
+                break;
+            
+            case FIFO_HEADER_SENSORTIME:
+                if (remaining < SENSORTIME_SIZE) {
+                    done = true;
+                    break;
+                }
+                sensortime_raw = p[0] | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+                sensortime_found = true;
+                p += SENSORTIME_SIZE;
+                done = true;    // sensortimeはFIFO末尾
+                break;
+            
+            case FIFO_HEADER_INPUT_CFG:
+                if (remaining < INPUT_CFG_SIZE) {
+                    done = true;
+                    break;
+                }
+                p += INPUT_CFG_SIZE;
+                break;
+            
+            case FIFO_HEADER_OVER_READ:
+            default:
+                done = true;
+                break;
+        }
+    }
+    
+    stats_.frames += frames;
+    if (frames == 0) {
+        return ESP_OK;
+    }
+    
+    // 最終フレームの時刻を決定し、ODR周期で各サンプル時刻を逆算
+    uint64_t last_ticks;
+    if (sensortime_found) {
+        last_ticks = unwrapSensortime(sensortime_raw);
+    } else {
+        stats_.missing_sensortime++;
+        sensortime_ticks_ += static_cast<uint64_t>(frames) * period_ticks_;
+        last_ticks = sensortime_ticks_;
+    }
+    
+    const size_t stored = count - first;
+    for (size_t i = 0; i < stored; i++) {
+        const uint64_t ticks = last_ticks - static_cast<uint64_t>(frames - 1 - i) * period_ticks_;
+        t_us[first + i] = ticks * 625 / 16;
+    }
+    
+    return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR Bmi270Fifo::readFifo(size_t& read_length) {
+    read_length = 0;
+    uint8_t length_raw[2];
+    esp_err_t ret = readRegisters(REG_FIFO_LENGTH_0, length_raw, sizeof(length_raw));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    const size_t fifo_length = length_raw[0] | (static_cast<size_t>(length_raw[1] & 0x3F) << 8);
+    if (fifo_length == 0) {
+        return ESP_OK;
+    }
+    
+    // FIFO末尾を越えて読み、空読み時に付加されるsensortimeフレームまで1回で取得
+    size_t length = fifo_length + SENSORTIME_FRAME_SIZE;
+    if (length + SPI_READ_OFFSET > buffer_size_) {
+        length = buffer_size_ - SPI_READ_OFFSET;
+        stats_.truncated_bursts++;
+    }
+    
+    tx_buffer_[0] = REG_FIFO_DATA | 0x80;
+    ret = spi_->transmitPolling(device_, tx_buffer_, rx_buffer_, length + SPI_READ_OFFSET);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "FIFOバースト読み取り失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    stats_.bursts++;
+    read_length = length;
+    return ESP_OK;
+}
+
+uint64_t IRAM_ATTR Bmi270Fifo::unwrapSensortime(uint32_t raw) {
+    if (!sensortime_valid_) {
+        sensortime_ticks_ = raw;
+        sensortime_valid_ = true;
+    } else {
+        sensortime_ticks_ += (raw - last_sensortime_raw_) & SENSORTIME_MASK;
+    }
+    last_sensortime_raw_ = raw;
+    return sensortime_ticks_;
+}
+
+esp_err_t IRAM_ATTR Bmi270Fifo::readRegisters(uint8_t reg, uint8_t* data, size_t length) {
+    constexpr size_t MAX_LENGTH = 8;
+    if (length == 0 || length > MAX_LENGTH) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // BMI270のSPI読み取りはアドレスの後にダミーバイトが1つ入る
+    alignas(4) uint8_t tx[MAX_LENGTH + SPI_READ_OFFSET] = {};
+    alignas(4) uint8_t rx[MAX_LENGTH + SPI_READ_OFFSET];
+    tx[0] = reg | 0x80;
+    
+    esp_err_t ret = spi_->transmitPolling(device_, tx, rx, length + SPI_READ_OFFSET);
+    if (ret == ESP_OK) {
+        memcpy(data, &rx[SPI_READ_OFFSET], length);
+    }
+    return ret;
+}
+
+esp_err_t Bmi270Fifo::writeRegister(uint8_t reg, uint8_t value) {
+    return spi_->writeRegisterPolling(device_, reg, &value, 1);
+}
+
+} // namespace sensors
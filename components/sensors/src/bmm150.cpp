@@ -0,0 +1,245 @@
+/*
+ * BMM150 Magnetometer Implementation
+ * 
+ * BMM150地磁気センサーのドライバ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bmm150.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+namespace sensors {
+
+static const char* TAG = "sensors::Bmm150";
+
+namespace {
+
+constexpr uint8_t POWER_ON = 0x01;
+constexpr uint8_t SOFT_RESET = 0x82;
+constexpr uint8_t OP_MODE_NORMAL = 0x00;
+constexpr uint32_t STARTUP_DELAY_MS = 3;        // 電源投入・リセット後の起動時間
+
+constexpr uint8_t RATES_HZ[] = { 10, 2, 6, 8, 15, 20, 25, 30 };    // DataRateの値の順
+
+// 飽和時の生データ
+constexpr int16_t OVERFLOW_XY = -4096;
+constexpr int16_t OVERFLOW_Z = -16384;
+
+constexpr uint8_t DATA_READY = 0x01;            // RHALL_LSBのビット0
+
+inline int16_t toInt16(const uint8_t* p) {
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+} // namespace
+
+Bmm150::Bmm150(std::shared_ptr<hal::I2cHal> i2c, uint8_t address)
+    : i2c_(std::move(i2c))
+    , address_(address)
+    , config_()
+    , initialized_(false)
+    , trim_{}
+    , interval_us_(0)
+    , last_read_us_(0)
+    , transaction_{}
+    , latest_{}
+    , fresh_(false)
+    , stats_{} {
+}
+
+esp_err_t Bmm150::initialize(const Config& config) {
+    config_ = config;
+    initialized_ = false;
+    
+    esp_err_t ret = i2c_->addDevice(address_, config_.scl_speed_hz);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // サスペンド状態ではチップIDも読めないため先に電源を入れる
+    ret = i2c_->writeRegister8(address_, REG_POWER_CONTROL, POWER_ON, config_.timeout);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "電源投入失敗 アドレス:0x%02X エラー:%s", address_, esp_err_to_name(ret));
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(STARTUP_DELAY_MS));
+    
+    uint8_t chip_id = 0;
+    ret = i2c_->readRegister8(address_, REG_CHIP_ID, chip_id, config_.timeout);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (chip_id != CHIP_ID) {
+        ESP_LOGE(TAG, "ID不一致 期待:0x%02X 実際:0x%02X", CHIP_ID, chip_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    ret = i2c_->writeRegister8(address_, REG_POWER_CONTROL, SOFT_RESET | POWER_ON, config_.timeout);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(STARTUP_DELAY_MS));
+    
+    uint8_t trim_x1y1[2];
+    uint8_t trim_xyz[4];
+    uint8_t trim_xy1xy2[10];
+    ret = i2c_->readRegister(address_, REG_TRIM_X1, trim_x1y1, sizeof(trim_x1y1), config_.timeout);
+    if (ret == ESP_OK) {
+        ret = i2c_->readRegister(address_, REG_TRIM_Z4, trim_xyz, sizeof(trim_xyz), config_.timeout);
+    }
+    if (ret == ESP_OK) {
+        ret = i2c_->readRegister(address_, REG_TRIM_Z2, trim_xy1xy2, sizeof(trim_xy1xy2), config_.timeout);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "トリム値読み取り失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    trim_.x1 = static_cast<int8_t>(trim_x1y1[0]);
+    trim_.y1 = static_cast<int8_t>(trim_x1y1[1]);
+    trim_.z4 = toInt16(&trim_xyz[0]);
+    trim_.x2 = static_cast<int8_t>(trim_xyz[2]);
+    trim_.y2 = static_cast<int8_t>(trim_xyz[3]);
+    trim_.z2 = toInt16(&trim_xy1xy2[0]);
+    trim_.z1 = static_cast<uint16_t>(toInt16(&trim_xy1xy2[2]));
+    trim_.xyz1 = static_cast<uint16_t>(((trim_xy1xy2[5] & 0x7F) << 8) | trim_xy1xy2[4]);
+    trim_.z3 = toInt16(&trim_xy1xy2[6]);
+    trim_.xy2 = static_cast<int8_t>(trim_xy1xy2[8]);
+    trim_.xy1 = trim_xy1xy2[9];
+    
+    ret = i2c_->writeRegister8(address_, REG_REP_XY, config_.repetitions_xy, config_.timeout);
+    if (ret == ESP_OK) {
+        ret = i2c_->writeRegister8(address_, REG_REP_Z, config_.repetitions_z, config_.timeout);
+    }
+    if (ret == ESP_OK) {
+        const uint8_t op_mode = static_cast<uint8_t>((static_cast<uint8_t>(config_.data_rate) << 3) | OP_MODE_NORMAL);
+        ret = i2c_->writeRegister8(address_, REG_OP_MODE, op_mode, config_.timeout);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "測定設定失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    const uint8_t rate_hz = RATES_HZ[static_cast<uint8_t>(config_.data_rate) & 0x07];
+    interval_us_ = 1000000 / rate_hz;
+    last_read_us_ = esp_timer_get_time();
+    
+    transaction_.device_address = address_;
+    transaction_.use_register_address = true;
+    transaction_.timeout = config_.timeout;
+    transaction_.data.reserve(DATA_SIZE);
+    
+    latest_ = Sample{};
+    fresh_ = false;
+    stats_ = Stats{};
+    initialized_ = true;
+    ESP_LOGI(TAG, "BMM150初期化完了 アドレス:0x%02X %uHz 繰り返しXY:%u Z:%u", address_, rate_hz, 
+             1 + 2 * config_.repetitions_xy, 1 + config_.repetitions_z);
+    return ESP_OK;
+}
+
+bool Bmm150::prepare(hal::I2cHal::Transaction& slot, int64_t now_us) {
+    if (!initialized_ || now_us - last_read_us_ < interval_us_) {
+        return false;
+    }
+    slot.device_address = address_;
+    slot.register_address = REG_DATA_X_LSB;
+    slot.use_register_address = true;
+    slot.is_read = true;
+    slot.timeout = config_.timeout;
+    slot.result = ESP_OK;
+    slot.data.resize(DATA_SIZE);
+    return true;
+}
+
+void Bmm150::complete(const hal::I2cHal::Transaction& slot, int64_t now_us) {
+    stats_.reads++;
+    if (slot.result != ESP_OK || slot.data.size() < DATA_SIZE) {
+        stats_.errors++;
+        return;
+    }
+    
+    const uint8_t* data = slot.data.data();
+    if ((data[6] & DATA_READY) == 0) {
+        // 変換が終わっていない（次の周期で読み直す）
+        stats_.stale++;
+        return;
+    }
+    last_read_us_ = now_us;
+    
+    // X・Yは13bit、Zは15bit、RHALLは14bit（下位ビットは状態フラグ）
+    const int16_t raw_x = static_cast<int16_t>(toInt16(&data[0]) >> 3);
+    const int16_t raw_y = static_cast<int16_t>(toInt16(&data[2]) >> 3);
+    const int16_t raw_z = static_cast<int16_t>(toInt16(&data[4]) >> 1);
+    const uint16_t rhall = static_cast<uint16_t>(static_cast<uint16_t>(toInt16(&data[6])) >> 2);
+    if (raw_x == OVERFLOW_XY || raw_y == OVERFLOW_XY || raw_z == OVERFLOW_Z || rhall == 0) {
+        stats_.overflows++;
+        return;
+    }
+    
+    latest_.field_ut[0] = compensateXy(raw_x, rhall, trim_.x1, trim_.x2);
+    latest_.field_ut[1] = compensateXy(raw_y, rhall, trim_.y1, trim_.y2);
+    latest_.field_ut[2] = compensateZ(raw_z, rhall);
+    latest_.rhall = rhall;
+    latest_.timestamp_us = now_us;
+    fresh_ = true;
+    stats_.samples++;
+}
+
+esp_err_t Bmm150::service() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!prepare(transaction_, esp_timer_get_time())) {
+        return ESP_OK;
+    }
+    i2c_->executeBatch(&transaction_, 1);
+    complete(transaction_, esp_timer_get_time());
+    return transaction_.result;
+}
+
+bool Bmm150::consume(Sample& sample) {
+    if (!fresh_) {
+        return false;
+    }
+    sample = latest_;
+    fresh_ = false;
+    return true;
+}
+
+float Bmm150::compensateXy(int16_t raw, uint16_t rhall, int8_t t1, int8_t t2) const {
+    // 製造元APIの浮動小数点補償式
+    const float xyz1 = static_cast<float>(trim_.xyz1);
+    const float r = xyz1 * 16384.0f / static_cast<float>(rhall) - 16384.0f;
+    const float sensitivity = static_cast<float>(trim_.xy2) * (r * r / 268435456.0f)
+                            + r * static_cast<float>(trim_.xy1) / 16384.0f;
+    const float gain = (sensitivity + 256.0f) * (static_cast<float>(t2) + 160.0f);
+    return (static_cast<float>(raw) * gain / 8192.0f + static_cast<float>(t1) * 8.0f) / 16.0f;
+}
+
+float Bmm150::compensateZ(int16_t raw, uint16_t rhall) const {
+    if (trim_.z1 == 0 || trim_.z2 == 0 || trim_.xyz1 == 0) {
+        return 0.0f;
+    }
+    const float offset = static_cast<float>(raw) - static_cast<float>(trim_.z4);
+    const float hall = static_cast<float>(trim_.z3) * (static_cast<float>(rhall) - static_cast<float>(trim_.xyz1));
+    const float gain = static_cast<float>(trim_.z2) + static_cast<float>(trim_.z1) * static_cast<float>(rhall) / 32768.0f;
+    return (offset * 131072.0f - hall) / (gain * 4.0f) / 16.0f;
+}
+
+void Bmm150::dump() const {
+    ESP_LOGI(TAG, "最新 X:%.2fμT Y:%.2fμT Z:%.2fμT RHALL:%u", 
+             static_cast<double>(latest_.field_ut[0]), static_cast<double>(latest_.field_ut[1]), 
+             static_cast<double>(latest_.field_ut[2]), latest_.rhall);
+    ESP_LOGI(TAG, "読み取り %lu サンプル %lu 未更新 %lu 飽和 %lu 失敗 %lu", 
+             static_cast<unsigned long>(stats_.reads), static_cast<unsigned long>(stats_.samples), 
+             static_cast<unsigned long>(stats_.stale), static_cast<unsigned long>(stats_.overflows), 
+             static_cast<unsigned long>(stats_.errors));
+}
+
+} // namespace sensors
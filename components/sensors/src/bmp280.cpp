@@ -0,0 +1,290 @@
+/*
+ * BMP280 Barometer Implementation
+ * 
+ * BMP280気圧センサーのドライバ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bmp280.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <cmath>
+
+namespace sensors {
+
+static const char* TAG = "sensors::Bmp280";
+
+namespace {
+
+constexpr uint8_t MODE_FORCED = 0x01;
+constexpr uint8_t STATUS_IM_UPDATE = 0x01;      // NVMから校正値を転送中
+constexpr uint32_t RESET_DELAY_MS = 3;          // ソフトリセット後の起動時間（2ms）
+constexpr int RESET_POLL_COUNT = 10;
+
+// 変換時間（データシートの最大値、μs）
+constexpr uint32_t MEASURE_BASE_US = 1250;
+constexpr uint32_t MEASURE_PER_SAMPLE_US = 2300;
+constexpr uint32_t MEASURE_PRESSURE_SETUP_US = 575;
+
+constexpr float ALTITUDE_EXPONENT = 0.190295f;  // 1 / 5.255
+constexpr float ALTITUDE_SCALE_M = 44330.0f;
+
+inline uint16_t toUint16(const uint8_t* p) {
+    return static_cast<uint16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+inline int16_t toInt16(const uint8_t* p) {
+    return static_cast<int16_t>(toUint16(p));
+}
+
+inline int32_t toRaw20(const uint8_t* p) {
+    return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 12) | (static_cast<uint32_t>(p[1]) << 4) | (p[2] >> 4));
+}
+
+inline uint32_t samplesOf(Bmp280::Oversampling oversampling) {
+    return 1u << (static_cast<uint8_t>(oversampling) - 1);
+}
+
+} // namespace
+
+Bmp280::Bmp280(std::shared_ptr<hal::I2cHal> i2c, uint8_t address)
+    : i2c_(std::move(i2c))
+    , address_(address)
+    , config_()
+    , initialized_(false)
+    , coefficients_{}
+    , ctrl_meas_(0)
+    , pressure_offset_us_(0)
+    , state_(State::START)
+    , conversion_start_us_(0)
+    , transaction_{}
+    , latest_{}
+    , fresh_(false)
+    , stats_{} {
+}
+
+esp_err_t Bmp280::initialize(const Config& config) {
+    config_ = config;
+    initialized_ = false;
+    
+    esp_err_t ret = i2c_->addDevice(address_, config_.scl_speed_hz);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    uint8_t chip_id = 0;
+    ret = i2c_->readRegister8(address_, REG_CHIP_ID, chip_id, config_.timeout);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ID読み取り失敗 アドレス:0x%02X エラー:%s", address_, esp_err_to_name(ret));
+        return ret;
+    }
+    if (chip_id != CHIP_ID && chip_id != CHIP_ID_BME280) {
+        ESP_LOGE(TAG, "ID不一致 期待:0x%02X 実際:0x%02X", CHIP_ID, chip_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // リセット後はスリープモード（設定レジスタの書き込みが反映される）
+    ret = i2c_->writeRegister8(address_, REG_RESET, RESET_VALUE, config_.timeout);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "リセット失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(RESET_DELAY_MS));
+    uint8_t status = STATUS_IM_UPDATE;
+    for (int i = 0; i < RESET_POLL_COUNT && (status & STATUS_IM_UPDATE); i++) {
+        ret = i2c_->readRegister8(address_, REG_STATUS, status, config_.timeout);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if (status & STATUS_IM_UPDATE) {
+            vTaskDelay(1);
+        }
+    }
+    if (status & STATUS_IM_UPDATE) {
+        ESP_LOGE(TAG, "校正値の転送が終わりません");
+        return ESP_ERR_TIMEOUT;
+    }
+    
+    uint8_t calibration[CALIBRATION_SIZE];
+    ret = i2c_->readRegister(address_, REG_CALIBRATION, calibration, sizeof(calibration), config_.timeout);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "校正値読み取り失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    computeCoefficients(calibration);
+    
+    ret = i2c_->writeRegister8(address_, REG_CONFIG, static_cast<uint8_t>(static_cast<uint8_t>(config_.filter) << 2), 
+                               config_.timeout);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    ctrl_meas_ = static_cast<uint8_t>((static_cast<uint8_t>(config_.temperature) << 5) |
+                                      (static_cast<uint8_t>(config_.pressure) << 2) | MODE_FORCED);
+    
+    // 温度の変換の後に気圧の変換が続く
+    const uint32_t temperature_us = MEASURE_PER_SAMPLE_US * samplesOf(config_.temperature);
+    const uint32_t pressure_us = MEASURE_PER_SAMPLE_US * samplesOf(config_.pressure) + MEASURE_PRESSURE_SETUP_US;
+    pressure_offset_us_ = MEASURE_BASE_US + temperature_us + pressure_us / 2;
+    
+    transaction_.device_address = address_;
+    transaction_.use_register_address = true;
+    transaction_.timeout = config_.timeout;
+    transaction_.data.reserve(DATA_SIZE);
+    
+    state_ = State::START;
+    latest_ = Sample{};
+    fresh_ = false;
+    stats_ = Stats{};
+    stats_.conversion_us = MEASURE_BASE_US + temperature_us + pressure_us;
+    initialized_ = true;
+    ESP_LOGI(TAG, "BMP280初期化完了 アドレス:0x%02X 変換時間:%luμs", 
+             address_, static_cast<unsigned long>(stats_.conversion_us));
+    return ESP_OK;
+}
+
+bool Bmp280::prepare(hal::I2cHal::Transaction& slot, int64_t now_us) {
+    if (!initialized_) {
+        return false;
+    }
+    
+    if (state_ == State::CONVERTING) {
+        if (now_us - conversion_start_us_ < static_cast<int64_t>(stats_.conversion_us)) {
+            return false;
+        }
+        state_ = State::READ;
+    }
+    
+    slot.device_address = address_;
+    slot.use_register_address = true;
+    slot.timeout = config_.timeout;
+    slot.result = ESP_OK;
+    if (state_ == State::START) {
+        slot.register_address = REG_CTRL_MEAS;
+        slot.is_read = false;
+        slot.data.assign(1, ctrl_meas_);
+    } else {
+        slot.register_address = REG_PRESS_MSB;
+        slot.is_read = true;
+        slot.data.resize(DATA_SIZE);
+    }
+    return true;
+}
+
+void Bmp280::complete(const hal::I2cHal::Transaction& slot, int64_t now_us) {
+    if (slot.result != ESP_OK) {
+        // 変換を開始し直す（読み取り失敗時も次の変換で取り直す）
+        stats_.errors++;
+        state_ = State::START;
+        return;
+    }
+    
+    if (state_ == State::START) {
+        conversion_start_us_ = now_us;
+        stats_.conversions++;
+        state_ = State::CONVERTING;
+        return;
+    }
+    
+    if (state_ == State::READ && slot.data.size() >= DATA_SIZE) {
+        compensate(slot.data.data(), conversion_start_us_ + pressure_offset_us_);
+    }
+    state_ = State::START;
+}
+
+esp_err_t Bmp280::service() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!prepare(transaction_, esp_timer_get_time())) {
+        return ESP_OK;
+    }
+    i2c_->executeBatch(&transaction_, 1);
+    complete(transaction_, esp_timer_get_time());
+    return transaction_.result;
+}
+
+bool Bmp280::consume(Sample& sample) {
+    if (!fresh_) {
+        return false;
+    }
+    sample = latest_;
+    fresh_ = false;
+    return true;
+}
+
+void Bmp280::computeCoefficients(const uint8_t* calibration) {
+    const double t1 = toUint16(&calibration[0]);
+    const double t2 = toInt16(&calibration[2]);
+    const double t3 = toInt16(&calibration[4]);
+    const double p1 = toUint16(&calibration[6]);
+    const double p2 = toInt16(&calibration[8]);
+    const double p3 = toInt16(&calibration[10]);
+    const double p4 = toInt16(&calibration[12]);
+    const double p5 = toInt16(&calibration[14]);
+    const double p6 = toInt16(&calibration[16]);
+    const double p7 = toInt16(&calibration[18]);
+    const double p8 = toInt16(&calibration[20]);
+    const double p9 = toInt16(&calibration[22]);
+    
+    // データシートの浮動小数点補償式を定数の積にまとめ直す
+    coefficients_.t_offset = static_cast<float>(16.0 * t1);
+    coefficients_.t1 = static_cast<float>(t2 / 16384.0);
+    coefficients_.t2 = static_cast<float>(t3 / 17179869184.0);
+    coefficients_.p1_0 = static_cast<float>(p1);
+    coefficients_.p1_1 = static_cast<float>(p1 * p2 / 17179869184.0);
+    coefficients_.p1_2 = static_cast<float>(p1 * p3 / 9007199254740992.0);
+    coefficients_.p2_0 = static_cast<float>(p4 * 65536.0);
+    coefficients_.p2_1 = static_cast<float>(p5 / 2.0);
+    coefficients_.p2_2 = static_cast<float>(p6 / 131072.0);
+    coefficients_.p3_0 = static_cast<float>(p7 / 16.0);
+    coefficients_.p3_1 = static_cast<float>(p8 / 524288.0);
+    coefficients_.p3_2 = static_cast<float>(p9 / 34359738368.0);
+}
+
+void Bmp280::compensate(const uint8_t* data, int64_t timestamp_us) {
+    const Coefficients& c = coefficients_;
+    const float adc_p = static_cast<float>(toRaw20(&data[0]));
+    const float adc_t = static_cast<float>(toRaw20(&data[3]));
+    
+    const float dt = adc_t - c.t_offset;
+    const float t_fine = dt * c.t1 + dt * dt * c.t2;
+    
+    const float v = t_fine * 0.5f - 64000.0f;
+    const float var1 = c.p1_0 + v * c.p1_1 + v * v * c.p1_2;
+    if (var1 <= 0.0f) {
+        // 校正値異常（0除算になる）
+        stats_.errors++;
+        return;
+    }
+    const float var2 = c.p2_0 + v * c.p2_1 + v * v * c.p2_2;
+    float pressure = (1048576.0f - adc_p - var2 * (1.0f / 4096.0f)) * 6250.0f / var1;
+    pressure += c.p3_0 + pressure * c.p3_1 + pressure * pressure * c.p3_2;
+    
+    if (stats_.samples > 0) {
+        stats_.last_period_us = static_cast<uint32_t>(timestamp_us - latest_.timestamp_us);
+    }
+    latest_.pressure_pa = pressure;
+    latest_.temperature_c = t_fine * (1.0f / 5120.0f);
+    latest_.altitude_m = ALTITUDE_SCALE_M * (1.0f - std::pow(pressure / config_.sea_level_pa, ALTITUDE_EXPONENT));
+    latest_.timestamp_us = timestamp_us;
+    fresh_ = true;
+    stats_.samples++;
+}
+
+void Bmp280::dump() const {
+    ESP_LOGI(TAG, "最新 気圧:%.1fPa 温度:%.2f℃ 高度:%.2fm", 
+             static_cast<double>(latest_.pressure_pa), static_cast<double>(latest_.temperature_c), 
+             static_cast<double>(latest_.altitude_m));
+    ESP_LOGI(TAG, "変換 %lu サンプル %lu 失敗 %lu 変換時間 %luμs 間隔 %luμs", 
+             static_cast<unsigned long>(stats_.conversions), static_cast<unsigned long>(stats_.samples), 
+             static_cast<unsigned long>(stats_.errors), static_cast<unsigned long>(stats_.conversion_us), 
+             static_cast<unsigned long>(stats_.last_period_us));
+}
+
+} // namespace sensors
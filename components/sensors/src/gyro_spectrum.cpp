@@ -0,0 +1,363 @@
+/*
+ * Gyro Spectrum Analyzer Implementation
+ * 
+ * ジャイロ信号のリアルタイムスペクトル解析実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "gyro_spectrum.hpp"
+#include "dsp_fft.hpp"
+#include "synced_clock.hpp"
+#include "esp_cpu.h"
+#include "esp_log.h"
+#include <math.h>
+#include <string.h>
+
+namespace sensors {
+
+static const char* TAG = "sensors::GyroSpectrum";
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+
+int8_t toDecibel(float power) {
+    if (power <= 0.0f) {
+        return INT8_MIN;
+    }
+    float db = 10.0f * log10f(power);
+    if (db < INT8_MIN) {
+        return INT8_MIN;
+    }
+    if (db > INT8_MAX) {
+        return INT8_MAX;
+    }
+    return static_cast<int8_t>(lrintf(db));
+}
+
+} // namespace
+
+GyroSpectrum::GyroSpectrum()
+    : initialized_(false)
+    , last_time_us_(0)
+    , window_scale_(0.0f)
+    , history_head_(0)
+    , history_fill_(0)
+    , since_analysis_(0)
+    , frames_(0)
+    , telemetry_version_(0)
+    , last_cycles_(0)
+    , max_cycles_(0)
+    , task_(nullptr)
+    , running_(false) {}
+
+GyroSpectrum::~GyroSpectrum() {
+    stop();
+}
+
+esp_err_t GyroSpectrum::initialize(const Config& config) {
+    if (running_.load(std::memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!common::dsp::isPowerOfTwo(config.fft_size) || config.fft_size > MAX_FFT_SIZE ||
+        config.hop_size == 0 || config.hop_size > config.fft_size || config.sample_hz <= 0.0f) {
+        ESP_LOGE(TAG, "解析設定が不正です fft:%u hop:%u", 
+                 static_cast<unsigned>(config.fft_size), static_cast<unsigned>(config.hop_size));
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!common::dsp::fftInitialize(MAX_FFT_SIZE)) {
+        ESP_LOGE(TAG, "FFT初期化失敗");
+        return ESP_FAIL;
+    }
+    
+    config_ = config;
+    const size_t n = config_.fft_size;
+    
+    // ハン窓と、片側パワーを平均二乗へ換算する係数（パーセバルの定理、2/(N Σw^2)）
+    float sum_squares = 0.0f;
+    for (size_t i = 0; i < n; i++) {
+        window_[i] = 0.5f - 0.5f * cosf(2.0f * PI * static_cast<float>(i) / static_cast<float>(n));
+        sum_squares += window_[i] * window_[i];
+    }
+    window_scale_ = 2.0f / (static_cast<float>(n) * sum_squares);
+    
+    memset(history_, 0, sizeof(history_));
+    memset(power_, 0, sizeof(power_));
+    history_head_ = 0;
+    history_fill_ = 0;
+    since_analysis_ = 0;
+    frames_ = 0;
+    initialized_ = true;
+    
+    ESP_LOGI(TAG, "初期化完了 FFT:%u点 ホップ:%u 分解能:%.2fHz", static_cast<unsigned>(n), 
+             static_cast<unsigned>(config_.hop_size), config_.sample_hz / static_cast<float>(n));
+    return ESP_OK;
+}
+
+esp_err_t GyroSpectrum::start() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (running_.exchange(true, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    
+    BaseType_t created = xTaskCreatePinnedToCore(taskEntry, "gyro_fft", config_.stack_size, this, 
+                                                 config_.priority, &task_, config_.core);
+    if (created != pdPASS) {
+        running_.store(false, std::memory_order_release);
+        task_ = nullptr;
+        ESP_LOGE(TAG, "解析タスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+esp_err_t GyroSpectrum::stop() {
+    if (!running_.exchange(false, std::memory_order_acq_rel)) {
+        return ESP_OK;
+    }
+    // 解析タスクは1ポーリング周期以内にtask_を消して自分を削除する
+    for (int i = 0; i < 100 && task_ != nullptr; i++) {
+        vTaskDelay(pdMS_TO_TICKS(2));
+    }
+    return task_ == nullptr ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+void GyroSpectrum::push(const float* gx, const float* gy, const float* gz, size_t count, uint32_t last_time_us) {
+    for (size_t i = 0; i < count; i++) {
+        input_.push(Sample{gx[i], gy[i], gz[i]});
+    }
+    last_time_us_.store(last_time_us, std::memory_order_relaxed);
+}
+
+GyroSpectrum::Stats GyroSpectrum::getStats() const {
+    Stats stats;
+    uint32_t version = result_.getVersion();
+    stats.frames = version / 2;
+    stats.dropped_samples = input_.getDroppedCount();
+    stats.last_cycles = last_cycles_.load(std::memory_order_relaxed);
+    stats.max_cycles = max_cycles_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void GyroSpectrum::dump() const {
+    Result result;
+    if (!getResult(result)) {
+        ESP_LOGI(TAG, "解析結果なし");
+        return;
+    }
+    
+    static const char AXIS_NAMES[AXES] = {'X', 'Y', 'Z'};
+    ESP_LOGI(TAG, "解析%lu回目 分解能:%.2fHz", static_cast<unsigned long>(result.frame), result.bin_hz);
+    for (size_t axis = 0; axis < AXES; axis++) {
+        ESP_LOGI(TAG, "%c ピーク:%6.1fHz(%4ddB) %6.1fHz(%4ddB) %6.1fHz(%4ddB) 帯域:%4d %4d %4d %4ddB", 
+                 AXIS_NAMES[axis], 
+                 result.peak_hz[axis][0], toDecibel(result.peak_power[axis][0]), 
+                 result.peak_hz[axis][1], toDecibel(result.peak_power[axis][1]), 
+                 result.peak_hz[axis][2], toDecibel(result.peak_power[axis][2]), 
+                 toDecibel(result.band_energy[axis][0]), toDecibel(result.band_energy[axis][1]), 
+                 toDecibel(result.band_energy[axis][2]), toDecibel(result.band_energy[axis][3]));
+    }
+    Stats stats = getStats();
+    ESP_LOGI(TAG, "解析サイクル 前回:%lu 最大:%lu 破棄サンプル:%lu", 
+             static_cast<unsigned long>(stats.last_cycles), static_cast<unsigned long>(stats.max_cycles), 
+             static_cast<unsigned long>(stats.dropped_samples));
+}
+
+size_t GyroSpectrum::fillTelemetry(uint8_t* buffer, size_t capacity, void* context) {
+    using communication::GyroSpectrumMessage;
+    GyroSpectrum* self = static_cast<GyroSpectrum*>(context);
+    if (capacity < sizeof(GyroSpectrumMessage)) {
+        return 0;
+    }
+    
+    // 前回送信してから新しい解析結果がない場合は送らない
+    Result result;
+    uint32_t version = 0;
+    if (!self->result_.read(result, version) || version == self->telemetry_version_) {
+        return 0;
+    }
+    self->telemetry_version_ = version;
+    
+    GyroSpectrumMessage message;
+    message.time_us = common::SyncedClock::instance().stamp(result.time_us);
+    message.bin_hz_x100 = static_cast<uint16_t>(lrintf(result.bin_hz * 100.0f));
+    for (size_t axis = 0; axis < AXES; axis++) {
+        for (size_t p = 0; p < PEAKS; p++) {
+            message.peak_hz[axis][p] = static_cast<uint16_t>(lrintf(result.peak_hz[axis][p]));
+            message.peak_db[axis][p] = toDecibel(result.peak_power[axis][p]);
+        }
+        for (size_t b = 0; b < BANDS; b++) {
+            message.band_db[axis][b] = toDecibel(result.band_energy[axis][b]);
+        }
+    }
+    memcpy(buffer, &message, sizeof(message));
+    return sizeof(message);
+}
+
+void GyroSpectrum::taskEntry(void* arg) {
+    GyroSpectrum* self = static_cast<GyroSpectrum*>(arg);
+    
+    // ホップ長の半分を目安にポーリング（IMUタスクへの通知コストを避ける）
+    float hop_ms = 1000.0f * static_cast<float>(self->config_.hop_size) / self->config_.sample_hz;
+    TickType_t poll_ticks = pdMS_TO_TICKS(static_cast<uint32_t>(hop_ms * 0.5f));
+    if (poll_ticks == 0) {
+        poll_ticks = 1;
+    }
+    
+    while (self->running_.load(std::memory_order_acquire)) {
+        self->drainInput();
+        if (self->since_analysis_ >= self->config_.hop_size && self->history_fill_ >= self->config_.fft_size) {
+            self->since_analysis_ = 0;
+            self->analyze();
+            continue;
+        }
+        vTaskDelay(poll_ticks);
+    }
+    
+    self->task_ = nullptr;
+    vTaskDelete(nullptr);
+}
+
+void GyroSpectrum::drainInput() {
+    const size_t n = config_.fft_size;
+    Sample sample;
+    while (input_.pop(sample)) {
+        history_[0][history_head_] = sample.x;
+        history_[1][history_head_] = sample.y;
+        history_[2][history_head_] = sample.z;
+        history_head_ = history_head_ + 1 < n ? history_head_ + 1 : 0;
+        if (history_fill_ < n) {
+            history_fill_++;
+        }
+        since_analysis_++;
+        // ホップ長分溜まったら取り出しを中断して解析する（遅れても窓の間隔を保つ）
+        if (since_analysis_ >= config_.hop_size && history_fill_ >= n) {
+            break;
+        }
+    }
+}
+
+void GyroSpectrum::analyze() {
+    uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+    const size_t n = config_.fft_size;
+    const size_t half = n / 2;
+    
+    // 古い順に窓を掛け、X+jY と Z+j0 の2本の複素列に詰める
+    for (size_t i = 0; i < n; i++) {
+        size_t index = history_head_ + i < n ? history_head_ + i : history_head_ + i - n;
+        float w = window_[i];
+        work_xy_[2 * i] = history_[0][index] * w;
+        work_xy_[2 * i + 1] = history_[1][index] * w;
+        work_z_[2 * i] = history_[2][index] * w;
+        work_z_[2 * i + 1] = 0.0f;
+    }
+    common::dsp::fft(work_xy_, n);
+    common::dsp::fft(work_z_, n);
+    
+    // 共役対称性で分離：X[k] = (Z[k] + Z*[N-k]) / 2、Y[k] = (Z[k] - Z*[N-k]) / 2j
+    const float smoothing = frames_ == 0 ? 0.0f : config_.smoothing;
+    for (size_t k = 0; k <= half; k++) {
+        size_t mirror = k == 0 ? 0 : n - k;
+        float zr = work_xy_[2 * k];
+        float zi = work_xy_[2 * k + 1];
+        float mr = work_xy_[2 * mirror];
+        float mi = work_xy_[2 * mirror + 1];
+        float xr = 0.5f * (zr + mr);
+        float xi = 0.5f * (zi - mi);
+        float yr = 0.5f * (zi + mi);
+        float yi = -0.5f * (zr - mr);
+        float cr = work_z_[2 * k];
+        float ci = work_z_[2 * k + 1];
+        
+        // DC・ナイキストは片側化で2倍しない
+        float scale = (k == 0 || k == half) ? 0.5f * window_scale_ : window_scale_;
+        float p[AXES] = {(xr * xr + xi * xi) * scale, (yr * yr + yi * yi) * scale, (cr * cr + ci * ci) * scale};
+        for (size_t axis = 0; axis < AXES; axis++) {
+            power_[axis][k] = smoothing * power_[axis][k] + (1.0f - smoothing) * p[axis];
+        }
+    }
+    
+    frames_++;
+    Result result;
+    result.time_us = last_time_us_.load(std::memory_order_relaxed);
+    result.frame = frames_;
+    result.bin_hz = config_.sample_hz / static_cast<float>(n);
+    for (size_t axis = 0; axis < AXES; axis++) {
+        extract(axis, result);
+    }
+    result_.write(result);
+    
+    uint32_t cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+    last_cycles_.store(cycles, std::memory_order_relaxed);
+    if (cycles > max_cycles_.load(std::memory_order_relaxed)) {
+        max_cycles_.store(cycles, std::memory_order_relaxed);
+    }
+    
+    if (callback_) {
+        callback_(result);
+    }
+}
+
+void GyroSpectrum::extract(size_t axis, Result& result) const {
+    const size_t half = config_.fft_size / 2;
+    const float bin_hz = result.bin_hz;
+    const float* power = power_[axis];
+    
+    for (size_t p = 0; p < PEAKS; p++) {
+        result.peak_hz[axis][p] = 0.0f;
+        result.peak_power[axis][p] = 0.0f;
+    }
+    
+    // 探索範囲内の極大を大きい順にPEAKS個保持し、放物線補間で周波数を求める
+    float max_hz = config_.max_peak_hz > 0.0f ? config_.max_peak_hz : config_.sample_hz * 0.5f;
+    size_t first = static_cast<size_t>(ceilf(config_.min_peak_hz / bin_hz));
+    size_t last = static_cast<size_t>(max_hz / bin_hz);
+    first = first < 1 ? 1 : first;
+    last = last > half - 1 ? half - 1 : last;
+    for (size_t k = first; k <= last; k++) {
+        float value = power[k];
+        if (!(value > power[k - 1] && value >= power[k + 1])) {
+            continue;
+        }
+        if (value <= result.peak_power[axis][PEAKS - 1]) {
+            continue;
+        }
+        
+        float denominator = power[k - 1] - 2.0f * value + power[k + 1];
+        float delta = denominator != 0.0f ? 0.5f * (power[k - 1] - power[k + 1]) / denominator : 0.0f;
+        float hz = (static_cast<float>(k) + delta) * bin_hz;
+        
+        size_t slot = PEAKS - 1;
+        while (slot > 0 && value > result.peak_power[axis][slot - 1]) {
+            result.peak_power[axis][slot] = result.peak_power[axis][slot - 1];
+            result.peak_hz[axis][slot] = result.peak_hz[axis][slot - 1];
+            slot--;
+        }
+        result.peak_power[axis][slot] = value;
+        result.peak_hz[axis][slot] = hz;
+    }
+    
+    // 帯域エネルギー（low <= f < high のビンの和 = その帯域の平均二乗、最終帯域はナイキストを含む）
+    const float nyquist = config_.sample_hz * 0.5f;
+    for (size_t b = 0; b < BANDS; b++) {
+        float low = config_.band_edges_hz[b];
+        float high = config_.band_edges_hz[b + 1] > 0.0f ? config_.band_edges_hz[b + 1] : nyquist;
+        float energy = 0.0f;
+        for (size_t k = static_cast<size_t>(ceilf(low / bin_hz)); k <= half; k++) {
+            float hz = static_cast<float>(k) * bin_hz;
+            if (hz > high || (hz == high && high < nyquist)) {
+                break;
+            }
+            energy += power[k];
+        }
+        result.band_energy[axis][b] = energy;
+    }
+}
+
+} // namespace sensors
@@ -0,0 +1,214 @@
+/*
+ * IMU Calibrator Implementation
+ * 
+ * 起動時のジャイロバイアス・水平の逐次推定実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "imu_calibrator.hpp"
+#include "flash_guard.hpp"
+#include "esp_log.h"
+#include <cmath>
+
+namespace sensors {
+
+static const char* TAG = "sensors::ImuCalibrator";
+
+ImuCalibrator::ImuCalibrator()
+    : config_{}
+    , state_(State::IDLE)
+    , start_us_(0)
+    , has_start_(false)
+    , active_{}
+    , dirty_(false)
+    , stats_{} {}
+
+void ImuCalibrator::start(const Config& config) {
+    config_ = config;
+    state_ = State::COLLECTING;
+    has_start_ = false;
+    restart();
+    stats_.runs++;
+}
+
+void ImuCalibrator::restart() {
+    for (size_t i = 0; i < 3; i++) {
+        gyro_[i].reset();
+        accel_[i].reset();
+    }
+}
+
+ImuCalibrator::State ImuCalibrator::add(const float gyro[3], const float accel[3], uint64_t timestamp_us) {
+    if (state_ != State::COLLECTING) {
+        return state_;
+    }
+    stats_.offered++;
+    if (!has_start_) {
+        start_us_ = timestamp_us;
+        has_start_ = true;
+    }
+    const uint32_t elapsed_us = static_cast<uint32_t>(timestamp_us - start_us_);
+    
+    if (isMotion(gyro, accel)) {
+        // 動いている間のサンプルは平均を偏らせるため、静止してから数え直す
+        restart();
+        stats_.restarts++;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        gyro_[i].add(gyro[i]);
+        accel_[i].add(accel[i]);
+    }
+    
+    if (hasConverged()) {
+        adopt(elapsed_us);
+        state_ = State::CONVERGED;
+        stats_.converged++;
+    } else if (elapsed_us >= config_.max_duration_us) {
+        state_ = State::TIMED_OUT;
+        stats_.timeouts++;
+        ESP_LOGW(TAG, "収束せず打ち切り %lums やり直し %lu回（%s）", static_cast<unsigned long>(elapsed_us / 1000), 
+                 static_cast<unsigned long>(stats_.restarts), isCalibrated() ? "保存済みの補正値を使用" : "補正なし");
+    }
+    return state_;
+}
+
+bool ImuCalibrator::isMotion(const float gyro[3], const float accel[3]) const {
+    if (gyro_[0].count() == 0) {
+        return false;
+    }
+    for (size_t i = 0; i < 3; i++) {
+        if (fabsf(gyro[i] - gyro_[i].mean()) > config_.gyro_motion_rad_s ||
+            fabsf(accel[i] - accel_[i].mean()) > config_.accel_motion_mss) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ImuCalibrator::hasConverged() const {
+    const uint32_t n = gyro_[0].count();
+    if (n < config_.min_samples) {
+        return false;
+    }
+    // 標準誤差の二乗（分散 / n）で比べて平方根を省く
+    const float gyro_limit = config_.gyro_tolerance_rad_s * config_.gyro_tolerance_rad_s * static_cast<float>(n);
+    const float accel_limit = config_.accel_tolerance_mss * config_.accel_tolerance_mss * static_cast<float>(n);
+    for (size_t i = 0; i < 3; i++) {
+        if (gyro_[i].variance() > gyro_limit || accel_[i].variance() > accel_limit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ImuCalibrator::adopt(uint32_t duration_us) {
+    Calibration result = {};
+    result.magic = CALIBRATION_MAGIC;
+    for (size_t i = 0; i < 3; i++) {
+        result.gyro_bias[i] = gyro_[i].mean();
+        result.gravity[i] = accel_[i].mean();
+        result.gyro_noise = fmaxf(result.gyro_noise, gyro_[i].stddev());
+        result.accel_noise = fmaxf(result.accel_noise, accel_[i].stddev());
+    }
+    result.samples = gyro_[0].count();
+    result.duration_us = duration_us;
+    
+    const float gx = result.gravity[0];
+    const float gy = result.gravity[1];
+    const float gz = result.gravity[2];
+    const float norm = sqrtf(gx * gx + gy * gy + gz * gz);
+    const float tilt = norm > 0.0f ? acosf(fmaxf(fminf(gz / norm, 1.0f), -1.0f)) : 0.0f;
+    if (fabsf(norm - GRAVITY) <= config_.gravity_tolerance * GRAVITY && tilt <= config_.max_level_tilt_rad) {
+        result.level_roll = atan2f(gy, gz);
+        result.level_pitch = atan2f(-gx, sqrtf(gy * gy + gz * gz));
+        result.level_valid = 1;
+    } else if (isCalibrated() && active_.level_valid) {
+        // 傾いた台の上・重力の大きさが不正: 水平は保存済みのものを引き継ぐ
+        result.level_roll = active_.level_roll;
+        result.level_pitch = active_.level_pitch;
+        result.level_valid = 1;
+        stats_.level_rejected++;
+    } else {
+        stats_.level_rejected++;
+    }
+    
+    active_ = result;
+    dirty_ = true;
+    ESP_LOGI(TAG, "収束 %lums %luサンプル バイアス:(%.4f, %.4f, %.4f)rad/s 水平:(%.2f, %.2f)deg%s", 
+             static_cast<unsigned long>(duration_us / 1000), static_cast<unsigned long>(result.samples), 
+             static_cast<double>(result.gyro_bias[0]), static_cast<double>(result.gyro_bias[1]), 
+             static_cast<double>(result.gyro_bias[2]), static_cast<double>(result.level_roll * 57.2958f), 
+             static_cast<double>(result.level_pitch * 57.2958f), result.level_valid ? "" : "（不採用）");
+}
+
+esp_err_t ImuCalibrator::load(hal::NvsHal& nvs, const char* namespace_name, const char* key) {
+    Calibration stored;
+    esp_err_t ret = nvs.readStruct(namespace_name, key, stored);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (stored.magic != CALIBRATION_MAGIC) {
+        ESP_LOGW(TAG, "保存済み補正値の形式不一致");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    active_ = stored;
+    dirty_ = false;
+    ESP_LOGI(TAG, "補正値読み込み バイアス:(%.4f, %.4f, %.4f)rad/s", static_cast<double>(active_.gyro_bias[0]), 
+             static_cast<double>(active_.gyro_bias[1]), static_cast<double>(active_.gyro_bias[2]));
+    return ESP_OK;
+}
+
+esp_err_t ImuCalibrator::save(hal::NvsHal& nvs, const char* namespace_name, const char* key) {
+    if (!isCalibrated()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    common::FlashGuard::Scope guard(common::FlashGuard::instance());
+    if (!guard.allowed()) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    esp_err_t ret = nvs.writeStruct(namespace_name, key, active_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "補正値保存失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    dirty_ = false;
+    return ESP_OK;
+}
+
+const char* ImuCalibrator::stateName(State state) {
+    switch (state) {
+    case State::IDLE:
+        return "未開始";
+    case State::COLLECTING:
+        return "集計中";
+    case State::CONVERGED:
+        return "収束";
+    case State::TIMED_OUT:
+        return "打ち切り";
+    }
+    return "不明";
+}
+
+void ImuCalibrator::dump() const {
+    ESP_LOGI(TAG, "状態 %s 集計中 %luサンプル 補正値 %s 保存%s", stateName(state_), 
+             static_cast<unsigned long>(gyro_[0].count()), isCalibrated() ? "採用済み" : "なし", 
+             dirty_ ? "待ち" : "済み");
+    ESP_LOGI(TAG, "バイアス:(%.4f, %.4f, %.4f)rad/s 雑音 ジャイロ:%.4frad/s 加速度:%.3fm/s^2 %lums", 
+             static_cast<double>(active_.gyro_bias[0]), static_cast<double>(active_.gyro_bias[1]), 
+             static_cast<double>(active_.gyro_bias[2]), static_cast<double>(active_.gyro_noise), 
+             static_cast<double>(active_.accel_noise), static_cast<unsigned long>(active_.duration_us / 1000));
+    ESP_LOGI(TAG, "重力:(%.3f, %.3f, %.3f)m/s^2 水平:(%.2f, %.2f)deg %s", 
+             static_cast<double>(active_.gravity[0]), static_cast<double>(active_.gravity[1]), 
+             static_cast<double>(active_.gravity[2]), static_cast<double>(active_.level_roll * 57.2958f), 
+             static_cast<double>(active_.level_pitch * 57.2958f), active_.level_valid ? "採用" : "不採用");
+    ESP_LOGI(TAG, "開始 %lu 入力 %lu やり直し %lu 収束 %lu 打ち切り %lu 水平不採用 %lu", 
+             static_cast<unsigned long>(stats_.runs), static_cast<unsigned long>(stats_.offered), 
+             static_cast<unsigned long>(stats_.restarts), static_cast<unsigned long>(stats_.converged), 
+             static_cast<unsigned long>(stats_.timeouts), static_cast<unsigned long>(stats_.level_rejected));
+}
+
+} // namespace sensors
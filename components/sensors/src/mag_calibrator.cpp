@@ -0,0 +1,407 @@
+/*
+ * Mag Calibrator Implementation
+ * 
+ * 地磁気センサーのハードアイアン・ソフトアイアン補正の逐次推定実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "mag_calibrator.hpp"
+#include "flash_guard.hpp"
+#include "matrix.hpp"
+#include "esp_log.h"
+#include <cmath>
+#include <string>
+
+namespace sensors {
+
+static const char* TAG = "sensors::MagCalibrator";
+
+namespace {
+
+using Matrix3 = common::Matrix<3, 3, float>;
+using Vector3 = common::Matrix<3, 1, float>;
+
+constexpr int JACOBI_MAX_SWEEPS = 10;
+constexpr float JACOBI_EPSILON = 1.0e-9f;
+constexpr float MIN_COVARIANCE = 1.0e-9f;
+constexpr float MIN_SEED_DENOMINATOR = 1.0e-3f;
+
+/**
+ * @brief 3x3対称行列の固有値分解（巡回ヤコビ法）
+ * @param a 対称行列（破壊される）
+ * @param values 固有値
+ * @param vectors 固有ベクトル（列）
+ */
+void symmetricEigen3(Matrix3& a, float values[3], Matrix3& vectors) {
+    vectors = Matrix3::identity();
+    for (int sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++) {
+        const float off = a(0, 1) * a(0, 1) + a(0, 2) * a(0, 2) + a(1, 2) * a(1, 2);
+        if (off < JACOBI_EPSILON) {
+            break;
+        }
+        for (size_t p = 0; p < 2; p++) {
+            for (size_t q = p + 1; q < 3; q++) {
+                if (std::fabs(a(p, q)) < JACOBI_EPSILON) {
+                    continue;
+                }
+                // a(p, q)を0にする回転
+                const float theta = (a(q, q) - a(p, p)) / (2.0f * a(p, q));
+                const float t = std::copysign(1.0f, theta) / (std::fabs(theta) + std::sqrt(theta * theta + 1.0f));
+                const float c = 1.0f / std::sqrt(t * t + 1.0f);
+                const float s = t * c;
+                for (size_t k = 0; k < 3; k++) {
+                    const float akp = a(k, p);
+                    const float akq = a(k, q);
+                    a(k, p) = c * akp - s * akq;
+                    a(k, q) = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < 3; k++) {
+                    const float apk = a(p, k);
+                    const float aqk = a(q, k);
+                    a(p, k) = c * apk - s * aqk;
+                    a(q, k) = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < 3; k++) {
+                    const float vkp = vectors(k, p);
+                    const float vkq = vectors(k, q);
+                    vectors(k, p) = c * vkp - s * vkq;
+                    vectors(k, q) = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < 3; i++) {
+        values[i] = a(i, i);
+    }
+}
+
+} // namespace
+
+MagCalibrator::MagCalibrator()
+    : config_()
+    , theta_{}
+    , covariance_()
+    , last_accepted_{}
+    , has_last_(false)
+    , since_solve_(0)
+    , candidate_(identity())
+    , has_candidate_(false)
+    , candidate_error_sum_(0.0f)
+    , candidate_count_(0)
+    , active_(identity())
+    , saved_(identity())
+    , dirty_(false)
+    , stats_{} {
+    resetEstimate();
+}
+
+void MagCalibrator::initialize(const Config& config) {
+    config_ = config;
+    has_last_ = false;
+    since_solve_ = 0;
+    has_candidate_ = false;
+    stats_ = Stats{};
+    resetEstimate();
+}
+
+bool MagCalibrator::add(const float field_ut[3]) {
+    stats_.offered++;
+    
+    // 近いサンプルは情報が増えないうえ、同じ姿勢が続くと忘却で推定が偏る
+    if (has_last_) {
+        const float dx = field_ut[0] - last_accepted_[0];
+        const float dy = field_ut[1] - last_accepted_[1];
+        const float dz = field_ut[2] - last_accepted_[2];
+        if (dx * dx + dy * dy + dz * dz < config_.min_separation_ut * config_.min_separation_ut) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < 3; i++) {
+        last_accepted_[i] = field_ut[i];
+    }
+    has_last_ = true;
+    stats_.accepted++;
+    
+    // 候補の検証（解いた後のサンプルに対する半径の相対誤差）
+    bool adopted = false;
+    if (has_candidate_) {
+        const float d[3] = {
+            field_ut[0] - candidate_.offset[0],
+            field_ut[1] - candidate_.offset[1],
+            field_ut[2] - candidate_.offset[2],
+        };
+        float squared = 0.0f;
+        for (size_t i = 0; i < 3; i++) {
+            const float* row = &candidate_.soft_iron[i * 3];
+            const float value = row[0] * d[0] + row[1] * d[1] + row[2] * d[2];
+            squared += value * value;
+        }
+        const float error = std::sqrt(squared) / candidate_.field_ut - 1.0f;
+        candidate_error_sum_ += error * error;
+        candidate_count_++;
+        
+        if (candidate_count_ >= config_.solve_interval) {
+            const float rms = std::sqrt(candidate_error_sum_ / static_cast<float>(candidate_count_));
+            has_candidate_ = false;
+            if (rms <= config_.max_fit_error) {
+                candidate_.magic = CALIBRATION_MAGIC;
+                candidate_.fit_error = rms;
+                candidate_.samples = stats_.accepted;
+                const bool first = saved_.magic != CALIBRATION_MAGIC;
+                float change = 0.0f;
+                for (size_t i = 0; i < 3; i++) {
+                    change = std::fmax(change, std::fabs(candidate_.offset[i] - saved_.offset[i]));
+                }
+                active_ = candidate_;
+                stats_.adopted++;
+                adopted = true;
+                if (first || change >= config_.save_offset_change_ut) {
+                    dirty_ = true;
+                }
+            } else {
+                stats_.rejected++;
+            }
+        }
+    }
+    
+    update(field_ut);
+    since_solve_++;
+    
+    if (!has_candidate_ && stats_.accepted >= config_.min_samples && since_solve_ >= config_.solve_interval) {
+        since_solve_ = 0;
+        stats_.solves++;
+        if (solve(candidate_)) {
+            has_candidate_ = true;
+            candidate_error_sum_ = 0.0f;
+            candidate_count_ = 0;
+        } else {
+            stats_.rejected++;
+        }
+    }
+    return adopted;
+}
+
+void MagCalibrator::apply(const float field_ut[3], float corrected[3]) const {
+    const float d[3] = {
+        field_ut[0] - active_.offset[0],
+        field_ut[1] - active_.offset[1],
+        field_ut[2] - active_.offset[2],
+    };
+    for (size_t i = 0; i < 3; i++) {
+        const float* row = &active_.soft_iron[i * 3];
+        corrected[i] = row[0] * d[0] + row[1] * d[1] + row[2] * d[2];
+    }
+}
+
+esp_err_t MagCalibrator::load(hal::NvsHal& nvs, const char* namespace_name, const char* key) {
+    Calibration stored;
+    esp_err_t ret = nvs.readStruct(namespace_name, key, stored);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (stored.magic != CALIBRATION_MAGIC || !(stored.field_ut > 0.0f)) {
+        ESP_LOGW(TAG, "保存済み補正値の形式不一致");
+        return ESP_ERR_INVALID_VERSION;
+    }
+    active_ = stored;
+    saved_ = stored;
+    dirty_ = false;
+    has_candidate_ = false;
+    resetEstimate();
+    ESP_LOGI(TAG, "補正値読み込み オフセット:(%.1f, %.1f, %.1f)μT 磁場:%.1fμT", 
+             static_cast<double>(active_.offset[0]), static_cast<double>(active_.offset[1]), 
+             static_cast<double>(active_.offset[2]), static_cast<double>(active_.field_ut));
+    return ESP_OK;
+}
+
+esp_err_t MagCalibrator::save(hal::NvsHal& nvs, const char* namespace_name, const char* key) {
+    if (!isCalibrated()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    common::FlashGuard::Scope guard(common::FlashGuard::instance());
+    if (!guard.allowed()) {
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    esp_err_t ret = nvs.writeStruct(namespace_name, key, active_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "補正値保存失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    saved_ = active_;
+    dirty_ = false;
+    return ESP_OK;
+}
+
+void MagCalibrator::resetEstimate() {
+    // 原点中心・半径scale_utの球
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        theta_[i] = (i < 3) ? 1.0f : 0.0f;
+    }
+    
+    // 採用済みの補正値があれば、その楕円体を正規化単位の係数に直して初期値とする
+    if (isCalibrated()) {
+        const float inv_scale = 1.0f / config_.scale_ut;
+        const float radius = active_.field_ut * inv_scale;
+        Matrix3 s;
+        for (size_t i = 0; i < 9; i++) {
+            s(i / 3, i % 3) = active_.soft_iron[i];
+        }
+        Matrix3 m = s.transpose() * s;
+        m *= 1.0f / (radius * radius);
+        const Vector3 c(active_.offset[0] * inv_scale, active_.offset[1] * inv_scale, active_.offset[2] * inv_scale);
+        const Vector3 mc = m * c;
+        const float denominator = 1.0f - c.dot(mc);
+        if (std::fabs(denominator) > MIN_SEED_DENOMINATOR) {
+            const float inv = 1.0f / denominator;
+            theta_[0] = m(0, 0) * inv;
+            theta_[1] = m(1, 1) * inv;
+            theta_[2] = m(2, 2) * inv;
+            theta_[3] = m(0, 1) * inv;
+            theta_[4] = m(0, 2) * inv;
+            theta_[5] = m(1, 2) * inv;
+            theta_[6] = -mc(0, 0) * inv;
+            theta_[7] = -mc(1, 0) * inv;
+            theta_[8] = -mc(2, 0) * inv;
+        }
+    }
+    
+    float diagonal[PARAM_COUNT];
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        diagonal[i] = config_.initial_covariance;
+    }
+    covariance_.setDiagonal(diagonal);
+}
+
+void MagCalibrator::update(const float field_ut[3]) {
+    const float inv_scale = 1.0f / config_.scale_ut;
+    const float x = field_ut[0] * inv_scale;
+    const float y = field_ut[1] * inv_scale;
+    const float z = field_ut[2] * inv_scale;
+    const float phi[PARAM_COUNT] = {
+        x * x, y * y, z * z, 2.0f * x * y, 2.0f * x * z, 2.0f * y * z, 2.0f * x, 2.0f * y, 2.0f * z,
+    };
+    
+    // u = P phi, s = lambda + phi^T P phi
+    float u[PARAM_COUNT];
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        float sum = 0.0f;
+        for (size_t j = 0; j < PARAM_COUNT; j++) {
+            sum += covariance_(i, j) * phi[j];
+        }
+        u[i] = sum;
+    }
+    float s = config_.forgetting;
+    float prediction = 0.0f;
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        s += phi[i] * u[i];
+        prediction += phi[i] * theta_[i];
+    }
+    
+    const float gain = (1.0f - prediction) / s;
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        theta_[i] += u[i] * gain;
+    }
+    covariance_.rankOneUpdate(u, -1.0f / s);
+    
+    // 励起の少ない方向で共分散が発散しないよう、上限に達したら忘却を止める
+    float max_diagonal = 0.0f;
+    for (size_t i = 0; i < PARAM_COUNT; i++) {
+        max_diagonal = std::fmax(max_diagonal, covariance_.diagonal(i));
+    }
+    if (max_diagonal < config_.max_covariance) {
+        const float inv_forgetting = 1.0f / config_.forgetting;
+        float* p = covariance_.data();
+        for (size_t i = 0; i < covariance_.PACKED_SIZE; i++) {
+            p[i] *= inv_forgetting;
+        }
+    }
+    covariance_.clampDiagonal(MIN_COVARIANCE);
+}
+
+bool MagCalibrator::solve(Calibration& result) const {
+    Matrix3 a(theta_[0], theta_[3], theta_[4], 
+              theta_[3], theta_[1], theta_[5], 
+              theta_[4], theta_[5], theta_[2]);
+    const Vector3 v(theta_[6], theta_[7], theta_[8]);
+    
+    // 中心 c = -A^-1 v、(m - c)^T A (m - c) = 1 + c^T A c
+    Matrix3 a_inverse;
+    if (!a.invert(a_inverse, 1.0e-12f)) {
+        return false;
+    }
+    Vector3 center = a_inverse * v;
+    center *= -1.0f;
+    const float k = 1.0f + center.dot(a * center);
+    if (std::fabs(k) < 1.0e-9f) {
+        return false;
+    }
+    Matrix3 shape = a;
+    shape *= 1.0f / k;
+    
+    float eigenvalues[3];
+    Matrix3 eigenvectors;
+    symmetricEigen3(shape, eigenvalues, eigenvectors);
+    float min_radius = INFINITY;
+    float max_radius = 0.0f;
+    float radius_product = 1.0f;
+    for (size_t i = 0; i < 3; i++) {
+        if (!(eigenvalues[i] > 0.0f)) {
+            return false;
+        }
+        const float radius = 1.0f / std::sqrt(eigenvalues[i]);
+        min_radius = std::fmin(min_radius, radius);
+        max_radius = std::fmax(max_radius, radius);
+        radius_product *= radius;
+    }
+    const float radius = std::cbrt(radius_product);
+    const float field_ut = radius * config_.scale_ut;
+    if (max_radius > min_radius * config_.max_axis_ratio ||
+        field_ut < config_.min_field_ut || field_ut > config_.max_field_ut) {
+        return false;
+    }
+    
+    // S = Q diag(R sqrt(mu)) Q^T（楕円体を体積を保って半径Rの球へ写す）
+    result = identity();
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            float sum = 0.0f;
+            for (size_t n = 0; n < 3; n++) {
+                sum += eigenvectors(i, n) * radius * std::sqrt(eigenvalues[n]) * eigenvectors(j, n);
+            }
+            result.soft_iron[i * 3 + j] = sum;
+        }
+        result.offset[i] = center(i, 0) * config_.scale_ut;
+    }
+    result.field_ut = field_ut;
+    return true;
+}
+
+MagCalibrator::Calibration MagCalibrator::identity() {
+    Calibration calibration{};
+    calibration.soft_iron[0] = 1.0f;
+    calibration.soft_iron[4] = 1.0f;
+    calibration.soft_iron[8] = 1.0f;
+    return calibration;
+}
+
+void MagCalibrator::dump() const {
+    ESP_LOGI(TAG, "補正値 %s オフセット:(%.2f, %.2f, %.2f)μT 磁場:%.1fμT 誤差:%.3f 保存%s", 
+             isCalibrated() ? "採用済み" : "なし", 
+             static_cast<double>(active_.offset[0]), static_cast<double>(active_.offset[1]), 
+             static_cast<double>(active_.offset[2]), static_cast<double>(active_.field_ut), 
+             static_cast<double>(active_.fit_error), dirty_ ? "待ち" : "済み");
+    ESP_LOGI(TAG, "ソフトアイアン 対角:(%.3f, %.3f, %.3f) 非対角:(%.3f, %.3f, %.3f)", 
+             static_cast<double>(active_.soft_iron[0]), static_cast<double>(active_.soft_iron[4]), 
+             static_cast<double>(active_.soft_iron[8]), static_cast<double>(active_.soft_iron[1]), 
+             static_cast<double>(active_.soft_iron[2]), static_cast<double>(active_.soft_iron[5]));
+    ESP_LOGI(TAG, "入力 %lu 採用 %lu 求解 %lu 候補却下 %lu 候補採用 %lu 検証中 %s", 
+             static_cast<unsigned long>(stats_.offered), static_cast<unsigned long>(stats_.accepted), 
+             static_cast<unsigned long>(stats_.solves), static_cast<unsigned long>(stats_.rejected), 
+             static_cast<unsigned long>(stats_.adopted), has_candidate_ ? "あり" : "なし");
+}
+
+} // namespace sensors
@@ -0,0 +1,359 @@
+/*
+ * PMW3901 Optical Flow Implementation
+ * 
+ * PMW3901オプティカルフローセンサーのドライバ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "pmw3901.hpp"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include <cstring>
+
+namespace sensors {
+
+static const char* TAG = "sensors::Pmw3901";
+
+namespace {
+
+// 製造元推奨の性能設定（前半の後に100ms待ってから後半を書く）
+constexpr uint8_t PERFORMANCE_SETTINGS_1[][2] = {
+    { 0x7F, 0x00 }, { 0x61, 0xAD }, { 0x7F, 0x03 }, { 0x40, 0x00 }, { 0x7F, 0x05 }, { 0x41, 0xB3 },
+    { 0x43, 0xF1 }, { 0x45, 0x14 }, { 0x5B, 0x32 }, { 0x5F, 0x34 }, { 0x7B, 0x08 }, { 0x7F, 0x06 },
+    { 0x44, 0x1B }, { 0x40, 0xBF }, { 0x4E, 0x3F }, { 0x7F, 0x08 }, { 0x65, 0x20 }, { 0x6A, 0x18 },
+    { 0x7F, 0x09 }, { 0x4F, 0xAF }, { 0x5F, 0x40 }, { 0x48, 0x80 }, { 0x49, 0x80 }, { 0x57, 0x77 },
+    { 0x60, 0x78 }, { 0x61, 0x78 }, { 0x62, 0x08 }, { 0x63, 0x50 }, { 0x7F, 0x0A }, { 0x45, 0x60 },
+    { 0x7F, 0x00 }, { 0x4D, 0x11 }, { 0x55, 0x80 }, { 0x74, 0x1F }, { 0x75, 0x1F }, { 0x4A, 0x78 },
+    { 0x4B, 0x78 }, { 0x44, 0x08 }, { 0x45, 0x50 }, { 0x64, 0xFF }, { 0x65, 0x1F }, { 0x7F, 0x14 },
+    { 0x65, 0x60 }, { 0x66, 0x08 }, { 0x63, 0x78 }, { 0x7F, 0x15 }, { 0x48, 0x58 }, { 0x7F, 0x07 },
+    { 0x41, 0x0D }, { 0x43, 0x14 }, { 0x4B, 0x0E }, { 0x45, 0x0F }, { 0x44, 0x42 }, { 0x4C, 0x80 },
+    { 0x7F, 0x10 }, { 0x5B, 0x02 }, { 0x7F, 0x07 }, { 0x40, 0x41 }, { 0x70, 0x00 },
+};
+
+constexpr uint8_t PERFORMANCE_SETTINGS_2[][2] = {
+    { 0x32, 0x44 }, { 0x7F, 0x07 }, { 0x40, 0x40 }, { 0x7F, 0x06 }, { 0x62, 0xF0 }, { 0x63, 0x00 },
+    { 0x7F, 0x0D }, { 0x48, 0xC0 }, { 0x6F, 0xD5 }, { 0x7F, 0x00 }, { 0x5B, 0xA0 }, { 0x4E, 0xA8 },
+    { 0x5A, 0x50 }, { 0x40, 0x80 },
+};
+
+constexpr uint32_t SETTINGS_DELAY_MS = 100;     // 前半と後半の間
+constexpr uint32_t RESET_DELAY_MS = 5;          // パワーアップリセット後
+
+// モーションバーストのバイト位置
+constexpr size_t BURST_MOTION = 0;
+constexpr size_t BURST_DELTA_X = 2;
+constexpr size_t BURST_DELTA_Y = 4;
+constexpr size_t BURST_SQUAL = 6;
+constexpr size_t BURST_RAW_SUM = 7;
+constexpr size_t BURST_RAW_MAX = 8;
+constexpr size_t BURST_RAW_MIN = 9;
+constexpr size_t BURST_SHUTTER = 10;
+
+constexpr uint8_t MOTION_MOVED = 0x80;
+
+inline int16_t toInt16(const uint8_t* p) {
+    return static_cast<int16_t>(static_cast<uint16_t>(p[0]) | (static_cast<uint16_t>(p[1]) << 8));
+}
+
+} // namespace
+
+Pmw3901::Pmw3901(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t device)
+    : spi_(std::move(spi))
+    , device_(device)
+    , scheduler_(nullptr)
+    , bus_client_(0)
+    , config_()
+    , initialized_(false)
+    , transaction_(nullptr)
+    , burst_start_us_(0)
+    , motion_{}
+    , sum_x_(0)
+    , sum_y_(0)
+    , sum_reads_(0)
+    , sum_min_quality_(0xFF)
+    , sum_max_shutter_(0)
+    , window_start_us_(0)
+    , stats_{} {
+}
+
+Pmw3901::~Pmw3901() {
+    if (transaction_ != nullptr) {
+        hal::SpiHal::DmaTransaction* done = nullptr;
+        if (spi_->getTransactionResult(device_, done, config_.timeout) == ESP_OK) {
+            spi_->releaseTransaction(done);
+        }
+        unlockBus(1 + BURST_SIZE);
+    }
+}
+
+esp_err_t Pmw3901::initialize(const Config& config) {
+    config_ = config;
+    initialized_ = false;
+    
+    esp_err_t ret = writeRegister(REG_POWER_UP_RESET, POWER_UP_RESET);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "リセット失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(RESET_DELAY_MS));
+    
+    uint8_t product_id = 0;
+    uint8_t inverse_id = 0;
+    ret = readRegister(REG_PRODUCT_ID, product_id);
+    if (ret == ESP_OK) {
+        ret = readRegister(REG_INVERSE_PRODUCT_ID, inverse_id);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ID読み取り失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    if (product_id != PRODUCT_ID || inverse_id != INVERSE_PRODUCT_ID) {
+        ESP_LOGE(TAG, "ID不一致 期待:0x%02X/0x%02X 実際:0x%02X/0x%02X", 
+                 PRODUCT_ID, INVERSE_PRODUCT_ID, product_id, inverse_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // リセット前からの移動量を読み捨てる（Motion読み取りで0x03〜0x06がラッチされる）
+    for (uint8_t reg = REG_MOTION; reg <= REG_MOTION + 4; reg++) {
+        uint8_t discard;
+        ret = readRegister(reg, discard);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    ret = writeTable(PERFORMANCE_SETTINGS_1, sizeof(PERFORMANCE_SETTINGS_1) / sizeof(PERFORMANCE_SETTINGS_1[0]));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    vTaskDelay(pdMS_TO_TICKS(SETTINGS_DELAY_MS));
+    ret = writeTable(PERFORMANCE_SETTINGS_2, sizeof(PERFORMANCE_SETTINGS_2) / sizeof(PERFORMANCE_SETTINGS_2[0]));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    motion_ = Motion{};
+    sum_x_ = 0;
+    sum_y_ = 0;
+    sum_reads_ = 0;
+    sum_min_quality_ = 0xFF;
+    sum_max_shutter_ = 0;
+    window_start_us_ = esp_timer_get_time();
+    stats_ = Stats{};
+    initialized_ = true;
+    ESP_LOGI(TAG, "PMW3901初期化完了 %.5f rad/カウント", static_cast<double>(config_.radians_per_count));
+    return ESP_OK;
+}
+
+esp_err_t Pmw3901::beginBurst() {
+    if (!initialized_ || transaction_ != nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    hal::SpiHal::DmaTransaction* transaction = spi_->acquireTransaction();
+    if (transaction == nullptr) {
+        return ESP_ERR_NO_MEM;
+    }
+    memset(transaction->tx_buffer, 0, BURST_SIZE);
+    
+    // アドレスとデータの間はCSを保持したまま待つ（同じバスの他デバイスはその間待たされる）
+    esp_err_t ret = lockBus();
+    if (ret != ESP_OK) {
+        spi_->releaseTransaction(transaction);
+        stats_.errors++;
+        return ret;
+    }
+    burst_start_us_ = esp_timer_get_time();
+    const uint8_t address = REG_MOTION_BURST;
+    ret = spi_->transmitPolling(device_, &address, nullptr, 1, SPI_TRANS_CS_KEEP_ACTIVE);
+    if (ret == ESP_OK) {
+        esp_rom_delay_us(READ_DELAY_US);
+        ret = spi_->queueTransaction(device_, transaction, BURST_SIZE, BURST_SIZE, config_.timeout);
+    }
+    if (ret != ESP_OK) {
+        unlockBus(1);
+        spi_->releaseTransaction(transaction);
+        stats_.errors++;
+        return ret;
+    }
+    transaction_ = transaction;
+    return ESP_OK;
+}
+
+esp_err_t Pmw3901::finishBurst() {
+    if (transaction_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    hal::SpiHal::DmaTransaction* done = nullptr;
+    esp_err_t ret = spi_->getTransactionResult(device_, done, config_.timeout);
+    if (ret != ESP_OK) {
+        // 転送は投入済みのまま（次の呼び出しで回収する）
+        stats_.errors++;
+        return ret;
+    }
+    unlockBus(1 + BURST_SIZE);
+    
+    accumulate(done->rx_buffer, burst_start_us_);
+    spi_->releaseTransaction(done);
+    transaction_ = nullptr;
+    
+    uint32_t elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - burst_start_us_);
+    stats_.last_burst_us = elapsed_us;
+    if (elapsed_us > stats_.max_burst_us) {
+        stats_.max_burst_us = elapsed_us;
+    }
+    stats_.bursts++;
+    return ESP_OK;
+}
+
+esp_err_t Pmw3901::read() {
+    esp_err_t ret = beginBurst();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return finishBurst();
+}
+
+void Pmw3901::accumulate(const uint8_t* data, int64_t timestamp_us) {
+    int16_t x = toInt16(&data[BURST_DELTA_X]);
+    int16_t y = toInt16(&data[BURST_DELTA_Y]);
+    if (config_.swap_xy) {
+        int16_t swapped = x;
+        x = y;
+        y = swapped;
+    }
+    motion_.delta_x = config_.flip_x ? static_cast<int16_t>(-x) : x;
+    motion_.delta_y = config_.flip_y ? static_cast<int16_t>(-y) : y;
+    motion_.quality = data[BURST_SQUAL];
+    motion_.raw_sum = data[BURST_RAW_SUM];
+    motion_.raw_max = data[BURST_RAW_MAX];
+    motion_.raw_min = data[BURST_RAW_MIN];
+    motion_.shutter = static_cast<uint16_t>(((data[BURST_SHUTTER] & 0x1F) << 8) | data[BURST_SHUTTER + 1]);
+    motion_.moved = (data[BURST_MOTION] & MOTION_MOVED) != 0;
+    motion_.timestamp_us = timestamp_us;
+    
+    if (motion_.quality < config_.min_quality) {
+        stats_.low_quality++;
+    }
+    if (motion_.shutter > config_.max_shutter) {
+        stats_.long_shutter++;
+    }
+    
+    sum_x_ += motion_.delta_x;
+    sum_y_ += motion_.delta_y;
+    sum_reads_++;
+    if (motion_.quality < sum_min_quality_) {
+        sum_min_quality_ = motion_.quality;
+    }
+    if (motion_.shutter > sum_max_shutter_) {
+        sum_max_shutter_ = motion_.shutter;
+    }
+}
+
+bool Pmw3901::consume(FlowSample& sample) {
+    if (sum_reads_ == 0) {
+        return false;
+    }
+    
+    // 移動量は読み取り間の累積なので、区間は前回取り出した最後の読み取りから今回の最後の読み取りまで
+    int64_t dt_us = motion_.timestamp_us - window_start_us_;
+    sample.delta_x = sum_x_;
+    sample.delta_y = sum_y_;
+    sample.dt_us = dt_us > 0 ? static_cast<uint32_t>(dt_us) : 0;
+    sample.reads = sum_reads_;
+    sample.min_quality = sum_min_quality_;
+    sample.max_shutter = sum_max_shutter_;
+    sample.timestamp_us = motion_.timestamp_us;
+    sample.valid = sample.dt_us > 0 && sum_min_quality_ >= config_.min_quality
+                   && sum_max_shutter_ <= config_.max_shutter;
+    if (sample.dt_us > 0) {
+        const float scale = config_.radians_per_count * 1e6f / static_cast<float>(sample.dt_us);
+        sample.flow_x = static_cast<float>(sum_x_) * scale;
+        sample.flow_y = static_cast<float>(sum_y_) * scale;
+    } else {
+        sample.flow_x = 0.0f;
+        sample.flow_y = 0.0f;
+    }
+    
+    stats_.samples++;
+    if (!sample.valid) {
+        stats_.rejected++;
+    }
+    window_start_us_ = motion_.timestamp_us;
+    sum_x_ = 0;
+    sum_y_ = 0;
+    sum_reads_ = 0;
+    sum_min_quality_ = 0xFF;
+    sum_max_shutter_ = 0;
+    return true;
+}
+
+void Pmw3901::dump() const {
+    ESP_LOGI(TAG, "最新 dx:%d dy:%d SQUAL:%u シャッター:%u 生データ 和:%u 最大:%u 最小:%u", 
+             motion_.delta_x, motion_.delta_y, motion_.quality, motion_.shutter, 
+             motion_.raw_sum, motion_.raw_max, motion_.raw_min);
+    ESP_LOGI(TAG, "バースト %lu 失敗 %lu 低品質 %lu 長シャッター %lu フロー %lu 不採用 %lu", 
+             static_cast<unsigned long>(stats_.bursts), static_cast<unsigned long>(stats_.errors), 
+             static_cast<unsigned long>(stats_.low_quality), static_cast<unsigned long>(stats_.long_shutter), 
+             static_cast<unsigned long>(stats_.samples), static_cast<unsigned long>(stats_.rejected));
+    ESP_LOGI(TAG, "バースト所要 前回 %luμs 最大 %luμs", 
+             static_cast<unsigned long>(stats_.last_burst_us), static_cast<unsigned long>(stats_.max_burst_us));
+}
+
+esp_err_t Pmw3901::lockBus() {
+    if (scheduler_ != nullptr) {
+        return scheduler_->acquire(bus_client_);
+    }
+    return spi_->acquireBus(device_);
+}
+
+void Pmw3901::unlockBus(size_t bytes) {
+    if (scheduler_ != nullptr) {
+        scheduler_->release(bus_client_, bytes);
+    } else {
+        spi_->releaseBus(device_);
+    }
+}
+
+esp_err_t Pmw3901::readRegister(uint8_t reg, uint8_t& value) {
+    esp_err_t ret = lockBus();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    const uint8_t address = reg & 0x7F;
+    ret = spi_->transmitPolling(device_, &address, nullptr, 1, SPI_TRANS_CS_KEEP_ACTIVE);
+    if (ret == ESP_OK) {
+        esp_rom_delay_us(READ_DELAY_US);
+        ret = spi_->transmitPolling(device_, nullptr, &value, 1);
+    }
+    unlockBus(2);
+    esp_rom_delay_us(WRITE_DELAY_US);
+    return ret;
+}
+
+esp_err_t Pmw3901::writeRegister(uint8_t reg, uint8_t value) {
+    const uint8_t data[2] = { static_cast<uint8_t>(reg | 0x80), value };
+    esp_err_t ret = spi_->transmitPolling(device_, data, nullptr, sizeof(data));
+    esp_rom_delay_us(WRITE_DELAY_US);
+    return ret;
+}
+
+esp_err_t Pmw3901::writeTable(const uint8_t (*table)[2], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = writeRegister(table[i][0], table[i][1]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "レジスタ書き込み失敗 レジスタ:0x%02X エラー:%s", table[i][0], esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+} // namespace sensors
@@ -0,0 +1,63 @@
+/*
+ * Sensor Manager Implementation
+ * 
+ * センサー群の統合管理クラス実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "sensor_manager.hpp"
+#include "esp_attr.h"
+#include "esp_log.h"
+
+namespace sensors {
+
+static const char* TAG = "sensors::SensorManager";
+
+SensorManager::SensorManager(std::shared_ptr<hal::SpiHal> spi, spi_device_handle_t imu_device)
+    : imu_(std::move(spi), imu_device)
+    , imu_samples_{}
+    , calibrator_()
+    , initialized_(false) {
+}
+
+esp_err_t SensorManager::initialize(const Config& config) {
+    ESP_LOGI(TAG, "初期化開始");
+    
+    esp_err_t ret = imu_.initialize(config.imu);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "IMU初期化失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    imu_samples_.clear();
+    initialized_ = true;
+    
+    ESP_LOGI(TAG, "初期化完了");
+    return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR SensorManager::update() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    imu_samples_.clear();
+    
+    esp_err_t ret = imu_.drain(imu_samples_);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "IMU FIFO読み出し失敗: %s", esp_err_to_name(ret));
+    }
+    
+    // 集計は補正前の値で行い、収束したサンプルの分から補正して渡す
+    if (calibrator_.isCollecting()) {
+        calibrator_.add(imu_samples_);
+    }
+    calibrator_.apply(imu_samples_);
+    return ret;
+}
+
+} // namespace sensors
@@ -0,0 +1,292 @@
+/*
+ * Sensor Replay Implementation
+ * 
+ * 記録済みセンサー値のリプレイ入力実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "sensor_replay.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstring>
+
+namespace sensors {
+
+static const char* TAG = "sensors::SensorReplay";
+
+SensorReplay::SensorReplay()
+    : source_(Source::PARTITION)
+    , config_()
+    , open_(false)
+    , ended_(false)
+    , log_(nullptr)
+    , session_(0)
+    , sector_index_(0)
+    , block_()
+    , decoder_()
+    , block_valid_(false)
+    , uart_(nullptr)
+    , parser_(onFrame, this)
+    , rx_chunk_()
+    , rx_queue_()
+    , rx_end_(false)
+    , frame_{}
+    , imu_samples_{}
+    , paced_(false)
+    , first_time_us_(0)
+    , start_us_(0)
+    , stats_{} {}
+
+void SensorReplay::resetState(Source source, const Config& config) {
+    source_ = source;
+    config_ = config;
+    open_ = true;
+    ended_ = false;
+    sector_index_ = 0;
+    block_valid_ = false;
+    rx_end_ = false;
+    ReplayFrame discard;
+    while (rx_queue_.pop(discard)) {
+    }
+    parser_.reset();
+    frame_ = ReplayFrame{};
+    imu_samples_.clear();
+    paced_ = false;
+    stats_ = Stats{};
+}
+
+esp_err_t SensorReplay::openPartition(const storage::PartitionLog& log, const Config& config) {
+    if (!log.isOpen()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // セッション0は最新（通し番号最大）のレコードのセッション
+    uint32_t session = config.session;
+    bool found = false;
+    uint32_t latest_sequence = 0;
+    for (uint32_t sector = 0; sector < log.sectorCount(); sector++) {
+        storage::PartitionLogHeader header;
+        if (log.readHeader(sector, header) != ESP_OK) {
+            continue;
+        }
+        if (config.session == 0) {
+            if (!found || header.sequence > latest_sequence) {
+                latest_sequence = header.sequence;
+                session = header.session;
+            }
+            found = true;
+        } else if (header.session == config.session) {
+            found = true;
+        }
+    }
+    if (!found) {
+        ESP_LOGW(TAG, "セッション %lu のレコードなし", static_cast<unsigned long>(config.session));
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    block_.resize(storage::PartitionLog::PAYLOAD_SIZE);
+    resetState(Source::PARTITION, config);
+    log_ = &log;
+    session_ = session;
+    ESP_LOGI(TAG, "パーティションから再生: セッション %lu（%s）", static_cast<unsigned long>(session), 
+             config.pacing == Pacing::REAL_TIME ? "実時間" : "最大速度");
+    return ESP_OK;
+}
+
+esp_err_t SensorReplay::openUart(hal::UartHal& uart, const Config& config) {
+    if (!uart.isRunning()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    rx_chunk_.reserve(RX_CHUNK_SIZE);
+    resetState(Source::UART, config);
+    uart_ = &uart;
+    session_ = 0;
+    ESP_LOGI(TAG, "UARTから再生（%s）", config.pacing == Pacing::REAL_TIME ? "実時間" : "最大速度");
+    return ESP_OK;
+}
+
+void SensorReplay::close() {
+    open_ = false;
+    log_ = nullptr;
+    uart_ = nullptr;
+    block_valid_ = false;
+}
+
+esp_err_t SensorReplay::next(ReplayFrame& frame) {
+    if (!open_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (ended_) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t ret = source_ == Source::PARTITION ? nextFromPartition(frame) : nextFromUart(frame);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ended_ = true;
+        ESP_LOGI(TAG, "再生終了: %lu フレーム", static_cast<unsigned long>(stats_.frames));
+    }
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (config_.pacing == Pacing::REAL_TIME) {
+        pace(frame.time_us);
+    }
+    frame_ = frame;
+    stats_.frames++;
+    return ESP_OK;
+}
+
+esp_err_t SensorReplay::update() {
+    ReplayFrame frame;
+    esp_err_t ret = next(frame);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    imu_samples_.clear();
+    imu_samples_.push(frame.accel[0], frame.accel[1], frame.accel[2], 
+                      frame.gyro[0], frame.gyro[1], frame.gyro[2], frame.time_us);
+    return ESP_OK;
+}
+
+esp_err_t SensorReplay::nextFromPartition(ReplayFrame& frame) {
+    storage::BlackboxFrame source;
+    while (!block_valid_ || !decoder_.next(source)) {
+        // 書き込み位置の次（最古側）から一周すると通し番号順になる
+        block_valid_ = false;
+        uint32_t count = log_->sectorCount();
+        if (sector_index_ >= count) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        uint32_t sector = (log_->writeSector() + sector_index_) % count;
+        sector_index_++;
+        
+        storage::PartitionLogHeader header;
+        if (log_->readHeader(sector, header) != ESP_OK || header.session != session_) {
+            continue;
+        }
+        if (log_->readSector(sector, header, block_.data()) != ESP_OK
+            || !decoder_.begin(block_.data(), header.payload_size)) {
+            stats_.bad_records++;
+            continue;
+        }
+        block_valid_ = true;
+        stats_.blocks++;
+        stats_.dropped_frames += decoder_.header().dropped_frames;
+    }
+    dequantize(source, frame);
+    return ESP_OK;
+}
+
+esp_err_t SensorReplay::nextFromUart(ReplayFrame& frame) {
+    int64_t deadline_us = esp_timer_get_time() + static_cast<int64_t>(config_.uart_timeout_ms) * 1000;
+    while (!rx_queue_.pop(frame)) {
+        if (rx_end_) {
+            return ESP_ERR_NOT_FOUND;
+        }
+        int64_t remaining_us = deadline_us - esp_timer_get_time();
+        if (remaining_us <= 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        TickType_t wait = pdMS_TO_TICKS(remaining_us / 1000);
+        size_t length = uart_->read(rx_chunk_, RX_CHUNK_SIZE, wait > 0 ? wait : 1);
+        if (length > 0) {
+            parser_.push(rx_chunk_.data(), length);
+        }
+    }
+    return ESP_OK;
+}
+
+void SensorReplay::onFrame(const communication::Frame& frame, void* context) {
+    SensorReplay* self = static_cast<SensorReplay*>(context);
+    communication::ReplayFrameMessage message;
+    if (!frame.as(message)) {
+        return;
+    }
+    if (message.flags & communication::ReplayFrameMessage::FLAG_END) {
+        self->rx_end_ = true;
+        return;
+    }
+    ReplayFrame replay;
+    replay.time_us = message.time_us;
+    memcpy(replay.gyro, message.gyro, sizeof(replay.gyro));
+    memcpy(replay.accel, message.accel, sizeof(replay.accel));
+    memcpy(replay.setpoint, message.setpoint, sizeof(replay.setpoint));
+    replay.range = message.range;
+    memcpy(replay.flow, message.flow, sizeof(replay.flow));
+    replay.flags = message.flags & (ReplayFrame::FLAG_RANGE | ReplayFrame::FLAG_FLOW);
+    if (!self->rx_queue_.push(replay)) {
+        self->stats_.rx_overruns++;
+    }
+}
+
+void SensorReplay::pace(uint32_t time_us) {
+    int64_t now_us = esp_timer_get_time();
+    if (!paced_) {
+        paced_ = true;
+        first_time_us_ = time_us;
+        start_us_ = now_us;
+        return;
+    }
+    // 記録時刻は下位32bitなので差分は符号なしで取る（先頭から71分まで）
+    int64_t target_us = start_us_ + static_cast<int64_t>(time_us - first_time_us_);
+    int64_t wait_us = target_us - now_us;
+    if (wait_us < 0) {
+        uint32_t late_us = static_cast<uint32_t>(-wait_us);
+        stats_.late_frames++;
+        if (late_us > stats_.max_late_us) {
+            stats_.max_late_us = late_us;
+        }
+        return;
+    }
+    if (wait_us >= static_cast<int64_t>(config_.spin_threshold_us)) {
+        // 1tick手前まで眠り、残りは空回りで合わせる
+        TickType_t ticks = pdMS_TO_TICKS(wait_us / 1000);
+        if (ticks > 1) {
+            vTaskDelay(ticks - 1);
+        }
+    }
+    while (esp_timer_get_time() < target_us) {
+    }
+}
+
+void SensorReplay::dequantize(const storage::BlackboxFrame& source, ReplayFrame& frame) {
+    using storage::BlackboxFrame;
+    frame.time_us = source.time_us;
+    for (size_t i = 0; i < 3; i++) {
+        frame.gyro[i] = static_cast<float>(source.gyro[i]) * BlackboxFrame::GYRO_LSB;
+        frame.accel[i] = static_cast<float>(source.accel[i]) * BlackboxFrame::ACCEL_LSB;
+    }
+    for (size_t i = 0; i < 4; i++) {
+        frame.setpoint[i] = static_cast<float>(source.setpoint[i]) * BlackboxFrame::SETPOINT_LSB;
+    }
+    frame.range = 0.0f;
+    frame.flow[0] = 0.0f;
+    frame.flow[1] = 0.0f;
+    frame.flags = 0;
+}
+
+void SensorReplay::dump() const {
+    ESP_LOGI(TAG, "入力元: %s %s %s", source_ == Source::PARTITION ? "パーティション" : "UART", 
+             config_.pacing == Pacing::REAL_TIME ? "実時間" : "最大速度", 
+             !open_ ? "（閉）" : ended_ ? "（終了）" : "");
+    if (source_ == Source::PARTITION) {
+        ESP_LOGI(TAG, "セッション %lu: ブロック %lu 不正 %lu 記録時の欠落 %lu", 
+                 static_cast<unsigned long>(session_), static_cast<unsigned long>(stats_.blocks), 
+                 static_cast<unsigned long>(stats_.bad_records), static_cast<unsigned long>(stats_.dropped_frames));
+    } else {
+        const communication::FrameParser::Stats& rx = parser_.getStats();
+        ESP_LOGI(TAG, "受信 %lu CRCエラー %lu 欠番 %lu キュー溢れ %lu", 
+                 static_cast<unsigned long>(rx.frames), static_cast<unsigned long>(rx.crc_errors), 
+                 static_cast<unsigned long>(rx.sequence_gaps), static_cast<unsigned long>(stats_.rx_overruns));
+    }
+    ESP_LOGI(TAG, "フレーム %lu 遅れ %lu（最大 %lu us）", 
+             static_cast<unsigned long>(stats_.frames), static_cast<unsigned long>(stats_.late_frames), 
+             static_cast<unsigned long>(stats_.max_late_us));
+}
+
+} // namespace sensors
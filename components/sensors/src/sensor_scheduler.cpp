@@ -0,0 +1,119 @@
+/*
+ * Sensor Scheduler Implementation
+ * 
+ * IMUデータレディ割り込み駆動のセンサータスクスケジューラ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "sensor_scheduler.hpp"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+namespace sensors {
+
+static const char* TAG = "sensors::SensorScheduler";
+
+SensorScheduler::SensorScheduler(std::shared_ptr<hal::GpioHal> gpio, gpio_num_t data_ready_pin, 
+                                 hal::GpioHal::InterruptType edge)
+    : gpio_(std::move(gpio))
+    , pin_(data_ready_pin)
+    , edge_(edge)
+    , task_(nullptr)
+    , irq_timestamp_us_(0)
+    , histogram_{}
+    , missed_count_(0)
+    , running_(false) {
+}
+
+SensorScheduler::~SensorScheduler() {
+    stop();
+}
+
+esp_err_t SensorScheduler::start(TaskHandle_t sensor_task) {
+    if (sensor_task == nullptr) {
+        ESP_LOGE(TAG, "通知先タスクが指定されていません");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (running_) {
+        return ESP_OK;
+    }
+    
+    task_ = sensor_task;
+    
+    // 取り残された通知を破棄してから割り込みを有効化
+    ulTaskNotifyTake(pdTRUE, 0);
+    
+    // ISR内で直接通知する（遅延実行タスクを経由しない）
+    esp_err_t ret = gpio_->setInterruptIsr(pin_, edge_, onDataReadyIsr, this);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "データレディ割り込み設定失敗 ピン%d: %s", pin_, esp_err_to_name(ret));
+        task_ = nullptr;
+        return ret;
+    }
+    
+    running_ = true;
+    ESP_LOGI(TAG, "データレディ割り込み駆動開始 ピン%d", pin_);
+    return ESP_OK;
+}
+
+esp_err_t SensorScheduler::stop() {
+    if (!running_) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = gpio_->disableInterrupt(pin_);
+    running_ = false;
+    task_ = nullptr;
+    
+    ESP_LOGI(TAG, "データレディ割り込み駆動停止 ピン%d", pin_);
+    return ret;
+}
+
+bool IRAM_ATTR SensorScheduler::waitForDataReady(TickType_t timeout) {
+    uint32_t notifications = ulTaskNotifyTake(pdTRUE, timeout);
+    if (notifications == 0) {
+        return false;
+    }
+    
+    // 割り込み時刻から読み取り開始（起床）までの遅延を記録
+    const uint32_t now_us = static_cast<uint32_t>(esp_timer_get_time());
+    const uint32_t irq_us = irq_timestamp_us_.load(std::memory_order_acquire);
+    histogram_.add(now_us - irq_us);
+    
+    if (notifications > 1) {
+        missed_count_ += notifications - 1;
+    }
+    return true;
+}
+
+LatencyHistogram SensorScheduler::getLatencyHistogram() const {
+    return histogram_;
+}
+
+void SensorScheduler::resetLatencyHistogram() {
+    histogram_ = {};
+    missed_count_ = 0;
+}
+
+void IRAM_ATTR SensorScheduler::onDataReadyIsr(gpio_num_t pin, bool level, void* context) {
+    SensorScheduler* scheduler = static_cast<SensorScheduler*>(context);
+    scheduler->irq_timestamp_us_.store(static_cast<uint32_t>(esp_timer_get_time()), 
+                                       std::memory_order_release);
+    
+    TaskHandle_t task = scheduler->task_;
+    if (task == nullptr) {
+        return;
+    }
+    
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higher_priority_task_woken);
+    portYIELD_FROM_ISR(higher_priority_task_woken);
+}
+
+} // namespace sensors
@@ -0,0 +1,622 @@
+/*
+ * VL53L0X ToF Implementation
+ * 
+ * VL53L0X測距（ToF）センサーのドライバ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "vl53l0x.hpp"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+
+namespace sensors {
+
+static const char* TAG = "sensors::Vl53l0x";
+
+namespace {
+
+// 製造元APIの既定調整値（DefaultTuningSettings）
+constexpr uint8_t TUNING_SETTINGS[][2] = {
+    { 0xFF, 0x01 }, { 0x00, 0x00 }, { 0xFF, 0x00 }, { 0x09, 0x00 }, { 0x10, 0x00 }, { 0x11, 0x00 },
+    { 0x24, 0x01 }, { 0x25, 0xFF }, { 0x75, 0x00 }, { 0xFF, 0x01 }, { 0x4E, 0x2C }, { 0x48, 0x00 },
+    { 0x30, 0x20 }, { 0xFF, 0x00 }, { 0x30, 0x09 }, { 0x54, 0x00 }, { 0x31, 0x04 }, { 0x32, 0x03 },
+    { 0x40, 0x83 }, { 0x46, 0x25 }, { 0x60, 0x00 }, { 0x27, 0x00 }, { 0x50, 0x06 }, { 0x51, 0x00 },
+    { 0x52, 0x96 }, { 0x56, 0x08 }, { 0x57, 0x30 }, { 0x61, 0x00 }, { 0x62, 0x00 }, { 0x64, 0x00 },
+    { 0x65, 0x00 }, { 0x66, 0xA0 }, { 0xFF, 0x01 }, { 0x22, 0x32 }, { 0x47, 0x14 }, { 0x49, 0xFF },
+    { 0x4A, 0x00 }, { 0xFF, 0x00 }, { 0x7A, 0x0A }, { 0x7B, 0x00 }, { 0x78, 0x21 }, { 0xFF, 0x01 },
+    { 0x23, 0x34 }, { 0x42, 0x00 }, { 0x44, 0xFF }, { 0x45, 0x26 }, { 0x46, 0x05 }, { 0x40, 0x40 },
+    { 0x0E, 0x06 }, { 0x20, 0x1A }, { 0x43, 0x40 }, { 0xFF, 0x00 }, { 0x34, 0x03 }, { 0x35, 0x44 },
+    { 0xFF, 0x01 }, { 0x31, 0x04 }, { 0x4B, 0x09 }, { 0x4C, 0x05 }, { 0x4D, 0x04 }, { 0xFF, 0x00 },
+    { 0x44, 0x00 }, { 0x45, 0x20 }, { 0x47, 0x08 }, { 0x48, 0x28 }, { 0x67, 0x00 }, { 0x70, 0x04 },
+    { 0x71, 0x01 }, { 0x72, 0xFE }, { 0x76, 0x00 }, { 0x77, 0x00 }, { 0xFF, 0x01 }, { 0x0D, 0x01 },
+    { 0xFF, 0x00 }, { 0x80, 0x01 }, { 0x01, 0xF8 }, { 0xFF, 0x01 }, { 0x8E, 0x01 }, { 0x00, 0x01 },
+    { 0xFF, 0x00 }, { 0x80, 0x00 },
+};
+
+// 内部ページを開いてstop variable（0x91）を扱う前後の手順
+constexpr uint8_t OPEN_STOP_VARIABLE[][2] = {
+    { 0x80, 0x01 }, { 0xFF, 0x01 }, { 0x00, 0x00 },
+};
+constexpr uint8_t CLOSE_STOP_VARIABLE[][2] = {
+    { 0x00, 0x01 }, { 0xFF, 0x00 }, { 0x80, 0x00 },
+};
+
+// SPAD情報（NVM）の読み出し手順
+constexpr uint8_t OPEN_SPAD_INFO[][2] = {
+    { 0x80, 0x01 }, { 0xFF, 0x01 }, { 0x00, 0x00 }, { 0xFF, 0x06 },
+};
+constexpr uint8_t REQUEST_SPAD_INFO[][2] = {
+    { 0xFF, 0x07 }, { 0x81, 0x01 }, { 0x80, 0x01 }, { 0x94, 0x6B }, { 0x83, 0x00 },
+};
+constexpr uint8_t PREPARE_SPAD_MAP[][2] = {
+    { 0xFF, 0x01 }, { 0x4F, 0x00 }, { 0x4E, 0x2C }, { 0xFF, 0x00 }, { 0xB6, 0xB4 },
+};
+
+constexpr uint8_t SYSRANGE_STOP = 0x01;
+constexpr uint8_t SYSRANGE_SINGLE = 0x01;
+constexpr uint8_t SYSRANGE_BACK_TO_BACK = 0x02;
+constexpr uint8_t SYSRANGE_TIMED = 0x04;
+constexpr uint8_t INTERRUPT_NEW_SAMPLE_READY = 0x04;
+constexpr uint8_t SEQUENCE_ALL = 0xE8;             // DSS・プリレンジ・ファイナルレンジ
+constexpr uint8_t SEQUENCE_VHV = 0x01;
+constexpr uint8_t SEQUENCE_PHASE = 0x02;
+constexpr uint8_t CALIBRATION_VHV = 0x40;
+
+constexpr uint32_t SPAD_INFO_TIMEOUT_MS = 20;
+constexpr uint32_t CALIBRATION_TIMEOUT_MS = 50;
+constexpr size_t SPAD_MAP_SIZE = 6;
+constexpr uint16_t RANGE_OUT_OF_RANGE_MM = 8190;         // 測定範囲外の距離値
+
+// 結果ブロック（RESULT_RANGE_STATUSから）のバイト位置
+constexpr size_t RESULT_STATUS = 0;
+constexpr size_t RESULT_SIGNAL_RATE = 6;
+constexpr size_t RESULT_AMBIENT_RATE = 8;
+constexpr size_t RESULT_RANGE = 10;
+
+inline uint16_t toUint16(const uint8_t* p) {
+    return static_cast<uint16_t>((static_cast<uint16_t>(p[0]) << 8) | p[1]);
+}
+
+} // namespace
+
+Vl53l0x::Vl53l0x(std::shared_ptr<hal::I2cHal> i2c, std::shared_ptr<hal::GpioHal> gpio, 
+                 gpio_num_t interrupt_pin, uint8_t address)
+    : i2c_(std::move(i2c))
+    , gpio_(std::move(gpio))
+    , pin_(interrupt_pin)
+    , address_(address)
+    , config_()
+    , initialized_(false)
+    , running_(false)
+    , stop_variable_(0)
+    , irq_count_(0)
+    , irq_timestamp_us_(0)
+    , read_done_(false)
+    , read_result_(ESP_OK)
+    , reading_(false)
+    , result_{}
+    , handled_count_(0)
+    , read_irq_us_(0)
+    , last_irq_us_(0)
+    , last_activity_us_(0)
+    , latest_{}
+    , stats_{} {
+}
+
+Vl53l0x::~Vl53l0x() {
+    stop();
+}
+
+esp_err_t Vl53l0x::initialize(const Config& config) {
+    if (running_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    config_ = config;
+    initialized_ = false;
+    
+    esp_err_t ret = i2c_->addDevice(address_, config_.scl_speed_hz);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    uint8_t model_id = 0;
+    ret = readRegister(REG_IDENTIFICATION_MODEL_ID, model_id);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "ID読み取り失敗 アドレス:0x%02X エラー:%s", address_, esp_err_to_name(ret));
+        return ret;
+    }
+    if (model_id != MODEL_ID) {
+        ESP_LOGE(TAG, "ID不一致 期待:0x%02X 実際:0x%02X", MODEL_ID, model_id);
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // I/Oを2.8V動作に設定
+    uint8_t value = 0;
+    ret = readRegister(REG_VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV, value);
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_VHV_CONFIG_PAD_SCL_SDA_EXTSUP_HV, value | 0x01);
+    }
+    
+    // I2C標準モードとstop variableの取得
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x88, 0x00);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(OPEN_STOP_VARIABLE, sizeof(OPEN_STOP_VARIABLE) / sizeof(OPEN_STOP_VARIABLE[0]));
+    }
+    if (ret == ESP_OK) {
+        ret = readRegister(0x91, stop_variable_);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(CLOSE_STOP_VARIABLE, sizeof(CLOSE_STOP_VARIABLE) / sizeof(CLOSE_STOP_VARIABLE[0]));
+    }
+    
+    // MSRC・プリレンジの返り光量チェックを無効化し、ファイナルレンジの下限を設定
+    if (ret == ESP_OK) {
+        ret = readRegister(REG_MSRC_CONFIG_CONTROL, value);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_MSRC_CONFIG_CONTROL, value | 0x12);
+    }
+    if (ret == ESP_OK) {
+        const uint16_t limit = static_cast<uint16_t>(config_.signal_rate_limit * (1 << 7));
+        ret = i2c_->writeRegister16(address_, REG_FINAL_RANGE_MIN_COUNT_RATE_RTN_LIMIT, limit, true, 
+                                    config_.timeout);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_SEQUENCE_CONFIG, 0xFF);
+    }
+    if (ret == ESP_OK) {
+        ret = configureSpads();
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(TUNING_SETTINGS, sizeof(TUNING_SETTINGS) / sizeof(TUNING_SETTINGS[0]));
+    }
+    
+    // GPIO1: 新しい測定結果でアクティブLow
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_INTERRUPT_CONFIG_GPIO, INTERRUPT_NEW_SAMPLE_READY);
+    }
+    if (ret == ESP_OK) {
+        ret = readRegister(REG_GPIO_HV_MUX_ACTIVE_HIGH, value);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_GPIO_HV_MUX_ACTIVE_HIGH, static_cast<uint8_t>(value & ~0x10));
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    }
+    
+    // 基準校正（温度に依存するVHVと位相）
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_SEQUENCE_CONFIG, SEQUENCE_VHV);
+    }
+    if (ret == ESP_OK) {
+        ret = performSingleRefCalibration(CALIBRATION_VHV);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_SEQUENCE_CONFIG, SEQUENCE_PHASE);
+    }
+    if (ret == ESP_OK) {
+        ret = performSingleRefCalibration(0x00);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_SEQUENCE_CONFIG, SEQUENCE_ALL);
+    }
+    
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "初期化失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    latest_ = RangeSample{};
+    stats_ = Stats{};
+    initialized_ = true;
+    ESP_LOGI(TAG, "VL53L0X初期化完了 アドレス:0x%02X 測定間隔:%lums", 
+             address_, static_cast<unsigned long>(config_.period_ms));
+    return ESP_OK;
+}
+
+esp_err_t Vl53l0x::start() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (running_) {
+        return ESP_OK;
+    }
+    
+    esp_err_t ret = gpio_->setDirection(pin_, hal::GpioHal::Direction::INPUT);
+    if (ret == ESP_OK) {
+        ret = gpio_->setPull(pin_, hal::GpioHal::Pull::PULLUP);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "割り込みピン%d設定失敗: %s", pin_, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // 取り残された割り込みをクリアしてから立ち下がりエッジを待つ
+    ret = writeRegister(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    handled_count_ = irq_count_.load(std::memory_order_acquire);
+    read_done_.store(false, std::memory_order_relaxed);
+    reading_ = false;
+    last_irq_us_ = 0;
+    last_activity_us_ = esp_timer_get_time();
+    
+    // 測定完了時刻を正確に残すため、遅延実行タスクを経由せずISR内で時刻を記録する
+    ret = gpio_->setInterruptIsr(pin_, hal::GpioHal::InterruptType::NEGEDGE, onDataReadyIsr, this);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "データレディ割り込み設定失敗 ピン%d: %s", pin_, esp_err_to_name(ret));
+        return ret;
+    }
+    
+    ret = writeTable(OPEN_STOP_VARIABLE, sizeof(OPEN_STOP_VARIABLE) / sizeof(OPEN_STOP_VARIABLE[0]));
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x91, stop_variable_);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(CLOSE_STOP_VARIABLE, sizeof(CLOSE_STOP_VARIABLE) / sizeof(CLOSE_STOP_VARIABLE[0]));
+    }
+    
+    if (ret == ESP_OK && config_.period_ms > 0) {
+        // 測定間隔は内部発振器の校正値で換算する
+        uint32_t period = config_.period_ms;
+        uint16_t osc_calibrate = 0;
+        ret = i2c_->readRegister16(address_, REG_OSC_CALIBRATE_VAL, osc_calibrate, true, config_.timeout);
+        if (ret == ESP_OK && osc_calibrate != 0) {
+            period *= osc_calibrate;
+        }
+        if (ret == ESP_OK) {
+            const uint8_t data[4] = {
+                static_cast<uint8_t>(period >> 24), static_cast<uint8_t>(period >> 16),
+                static_cast<uint8_t>(period >> 8), static_cast<uint8_t>(period),
+            };
+            ret = i2c_->writeRegister(address_, REG_SYSTEM_INTERMEASUREMENT_PERIOD, data, sizeof(data), 
+                                      config_.timeout);
+        }
+        if (ret == ESP_OK) {
+            ret = writeRegister(REG_SYSRANGE_START, SYSRANGE_TIMED);
+        }
+    } else if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSRANGE_START, SYSRANGE_BACK_TO_BACK);
+    }
+    
+    if (ret != ESP_OK) {
+        gpio_->disableInterrupt(pin_);
+        ESP_LOGE(TAG, "連続測定開始失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    running_ = true;
+    ESP_LOGI(TAG, "連続測定開始 割り込みピン%d", pin_);
+    return ESP_OK;
+}
+
+esp_err_t Vl53l0x::stop() {
+    if (!running_) {
+        return ESP_OK;
+    }
+    running_ = false;
+    
+    esp_err_t ret = gpio_->disableInterrupt(pin_);
+    
+    // 完了コールバックが結果ブロックへ書き込み終わるまで待つ
+    if (reading_) {
+        i2c_->waitAllDone(config_.timeout);
+        reading_ = false;
+    }
+    
+    esp_err_t stop_ret = writeRegister(REG_SYSRANGE_START, SYSRANGE_STOP);
+    if (stop_ret == ESP_OK) {
+        stop_ret = writeRegister(0xFF, 0x01);
+    }
+    if (stop_ret == ESP_OK) {
+        stop_ret = writeRegister(0x00, 0x00);
+    }
+    if (stop_ret == ESP_OK) {
+        stop_ret = writeRegister(0x91, 0x00);
+    }
+    if (stop_ret == ESP_OK) {
+        stop_ret = writeRegister(0x00, 0x01);
+    }
+    if (stop_ret == ESP_OK) {
+        stop_ret = writeRegister(0xFF, 0x00);
+    }
+    
+    ESP_LOGI(TAG, "連続測定停止");
+    return (ret != ESP_OK) ? ret : stop_ret;
+}
+
+esp_err_t Vl53l0x::service() {
+    if (!running_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    // 前回投入した読み取りが完了していれば展開する（未完了なら次の周期へ）
+    esp_err_t ret = ESP_OK;
+    if (reading_) {
+        if (!read_done_.load(std::memory_order_acquire)) {
+            return ESP_OK;
+        }
+        ret = finishRead();
+    }
+    
+    const int64_t now_us = esp_timer_get_time();
+    const uint32_t count = irq_count_.load(std::memory_order_acquire);
+    if (count == handled_count_) {
+        // 割り込みが途絶えた（エッジの取りこぼし・センサーのリセット）場合はクリアし直す
+        if (now_us - last_activity_us_ > static_cast<int64_t>(config_.stall_timeout_ms) * 1000) {
+            last_activity_us_ = now_us;
+            stats_.recoveries++;
+            esp_err_t clear_ret = writeRegister(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+            if (clear_ret != ESP_OK) {
+                stats_.errors++;
+                return clear_ret;
+            }
+        }
+        return ret;
+    }
+    stats_.interrupts += count - handled_count_;
+    handled_count_ = count;
+    last_activity_us_ = now_us;
+    
+    // 下位32bitの割り込み時刻を現在時刻からの経過で64bitへ戻す
+    const uint32_t age_us = static_cast<uint32_t>(now_us) - irq_timestamp_us_.load(std::memory_order_acquire);
+    read_irq_us_ = now_us - static_cast<int64_t>(age_us);
+    
+    read_done_.store(false, std::memory_order_relaxed);
+    esp_err_t read_ret = i2c_->readRegisterAsync(address_, REG_RESULT_RANGE_STATUS, result_, RESULT_SIZE, 
+                                                 onReadDone, this);
+    if (read_ret == ESP_ERR_INVALID_STATE) {
+        // 同じデバイスの転送が残っている（次の割り込みで読む、この測定は取りこぼし）
+        stats_.busy++;
+        return ESP_OK;
+    }
+    if (read_ret != ESP_OK) {
+        stats_.errors++;
+        return read_ret;
+    }
+    reading_ = true;
+    
+    // レガシードライバ・非同期キュー無効時は同期読み取りのため戻った時点で完了している
+    if (read_done_.load(std::memory_order_acquire)) {
+        read_ret = finishRead();
+    }
+    return (ret != ESP_OK) ? ret : read_ret;
+}
+
+esp_err_t Vl53l0x::finishRead() {
+    reading_ = false;
+    const esp_err_t result = read_result_;
+    
+    // 結果を読み終えてから割り込みを解除する（GPIO1はクリアまでLowを保持）
+    esp_err_t ret = writeRegister(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    if (result != ESP_OK || ret != ESP_OK) {
+        stats_.errors++;
+        return (result != ESP_OK) ? result : ret;
+    }
+    
+    publish(read_irq_us_);
+    return ESP_OK;
+}
+
+void Vl53l0x::publish(int64_t irq_us) {
+    // 割り込みの間隔が測定間隔の1.5倍を超えた場合、間の測定を取りこぼしている
+    if (config_.period_ms > 0 && last_irq_us_ != 0) {
+        const int64_t period_us = static_cast<int64_t>(config_.period_ms) * 1000;
+        const int64_t gap_us = irq_us - last_irq_us_;
+        if (gap_us * 2 > period_us * 3) {
+            stats_.missed += static_cast<uint32_t>((gap_us + period_us / 2) / period_us - 1);
+        }
+    }
+    last_irq_us_ = irq_us;
+    
+    RangeSample sample;
+    sample.status = static_cast<uint8_t>((result_[RESULT_STATUS] >> 3) & 0x0F);
+    sample.range_mm = toUint16(&result_[RESULT_RANGE]);
+    sample.signal_rate = toUint16(&result_[RESULT_SIGNAL_RATE]);
+    sample.ambient_rate = toUint16(&result_[RESULT_AMBIENT_RATE]);
+    sample.range_m = static_cast<float>(sample.range_mm) * 0.001f;
+    sample.valid = sample.status == RANGE_STATUS_VALID
+                && sample.range_mm < RANGE_OUT_OF_RANGE_MM
+                && sample.range_mm >= config_.min_range_mm
+                && sample.range_mm <= config_.max_range_mm;
+    sample.sequence = handled_count_;
+    sample.timestamp_us = irq_us - static_cast<int64_t>(config_.measurement_latency_us);
+    
+    const uint32_t latency_us = static_cast<uint32_t>(esp_timer_get_time() - irq_us);
+    stats_.last_latency_us = latency_us;
+    if (latency_us > stats_.max_latency_us) {
+        stats_.max_latency_us = latency_us;
+    }
+    
+    if (!sample.valid) {
+        stats_.invalid++;
+    }
+    latest_ = sample;
+    if (queue_.push(sample)) {
+        stats_.samples++;
+    } else {
+        stats_.dropped++;
+    }
+}
+
+void IRAM_ATTR Vl53l0x::onDataReadyIsr(gpio_num_t pin, bool level, void* context) {
+    Vl53l0x* tof = static_cast<Vl53l0x*>(context);
+    tof->irq_timestamp_us_.store(static_cast<uint32_t>(esp_timer_get_time()), std::memory_order_relaxed);
+    tof->irq_count_.fetch_add(1, std::memory_order_release);
+}
+
+bool IRAM_ATTR Vl53l0x::onReadDone(esp_err_t result, void* user_arg) {
+    Vl53l0x* tof = static_cast<Vl53l0x*>(user_arg);
+    tof->read_result_ = result;
+    tof->read_done_.store(true, std::memory_order_release);
+    return false;
+}
+
+esp_err_t Vl53l0x::configureSpads() {
+    esp_err_t ret = writeTable(OPEN_SPAD_INFO, sizeof(OPEN_SPAD_INFO) / sizeof(OPEN_SPAD_INFO[0]));
+    uint8_t value = 0;
+    if (ret == ESP_OK) {
+        ret = readRegister(0x83, value);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x83, value | 0x04);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(REQUEST_SPAD_INFO, sizeof(REQUEST_SPAD_INFO) / sizeof(REQUEST_SPAD_INFO[0]));
+    }
+    
+    // NVMの読み出し完了待ち（初期化時のみ）
+    TickType_t start = xTaskGetTickCount();
+    while (ret == ESP_OK) {
+        ret = readRegister(0x83, value);
+        if (ret != ESP_OK || value != 0x00) {
+            break;
+        }
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(SPAD_INFO_TIMEOUT_MS)) {
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+        vTaskDelay(1);
+    }
+    
+    uint8_t info = 0;
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x83, 0x01);
+    }
+    if (ret == ESP_OK) {
+        ret = readRegister(0x92, info);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x81, 0x00);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(0xFF, 0x06);
+    }
+    if (ret == ESP_OK) {
+        ret = readRegister(0x83, value);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(0x83, static_cast<uint8_t>(value & ~0x04));
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(0xFF, 0x01);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(CLOSE_STOP_VARIABLE, sizeof(CLOSE_STOP_VARIABLE) / sizeof(CLOSE_STOP_VARIABLE[0]));
+    }
+    
+    uint8_t spad_map[SPAD_MAP_SIZE] = {};
+    if (ret == ESP_OK) {
+        ret = i2c_->readRegister(address_, REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_0, spad_map, sizeof(spad_map), 
+                                 config_.timeout);
+    }
+    if (ret == ESP_OK) {
+        ret = writeTable(PREPARE_SPAD_MAP, sizeof(PREPARE_SPAD_MAP) / sizeof(PREPARE_SPAD_MAP[0]));
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPAD情報の読み出し失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    
+    // NVMの数だけ、開口型なら12番目から順に有効化する
+    const uint8_t spad_count = info & 0x7F;
+    const bool aperture = (info & 0x80) != 0;
+    const uint8_t first_spad = aperture ? 12 : 0;
+    uint8_t enabled = 0;
+    for (uint8_t i = 0; i < SPAD_MAP_SIZE * 8; i++) {
+        const uint8_t bit = static_cast<uint8_t>(1 << (i % 8));
+        if (i < first_spad || enabled == spad_count) {
+            spad_map[i / 8] &= ~bit;
+        } else if (spad_map[i / 8] & bit) {
+            enabled++;
+        }
+    }
+    
+    ret = i2c_->writeRegister(address_, REG_GLOBAL_CONFIG_SPAD_ENABLES_REF_0, spad_map, sizeof(spad_map), 
+                              config_.timeout);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPAD設定失敗: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    ESP_LOGI(TAG, "参照SPAD %u個（%s）", spad_count, aperture ? "開口型" : "非開口型");
+    return ESP_OK;
+}
+
+esp_err_t Vl53l0x::performSingleRefCalibration(uint8_t vhv_init_byte) {
+    esp_err_t ret = writeRegister(REG_SYSRANGE_START, SYSRANGE_SINGLE | vhv_init_byte);
+    if (ret == ESP_OK) {
+        ret = waitInterruptStatus(CALIBRATION_TIMEOUT_MS);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSTEM_INTERRUPT_CLEAR, 0x01);
+    }
+    if (ret == ESP_OK) {
+        ret = writeRegister(REG_SYSRANGE_START, 0x00);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "基準校正失敗 0x%02X: %s", vhv_init_byte, esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+esp_err_t Vl53l0x::waitInterruptStatus(uint32_t timeout_ms) {
+    TickType_t start = xTaskGetTickCount();
+    while (true) {
+        uint8_t status = 0;
+        esp_err_t ret = readRegister(REG_RESULT_INTERRUPT_STATUS, status);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        if ((status & 0x07) != 0) {
+            return ESP_OK;
+        }
+        if (xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms)) {
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+void Vl53l0x::dump() const {
+    ESP_LOGI(TAG, "最新 距離:%umm ステータス:%u 有効:%d 光量:%u 環境光:%u 番号:%lu", 
+             latest_.range_mm, latest_.status, latest_.valid, latest_.signal_rate, latest_.ambient_rate, 
+             static_cast<unsigned long>(latest_.sequence));
+    ESP_LOGI(TAG, "割り込み %lu サンプル %lu 無効 %lu 取りこぼし %lu 失敗 %lu 転送中 %lu 破棄 %lu 復帰 %lu", 
+             static_cast<unsigned long>(stats_.interrupts), static_cast<unsigned long>(stats_.samples), 
+             static_cast<unsigned long>(stats_.invalid), static_cast<unsigned long>(stats_.missed), 
+             static_cast<unsigned long>(stats_.errors), static_cast<unsigned long>(stats_.busy), 
+             static_cast<unsigned long>(stats_.dropped), static_cast<unsigned long>(stats_.recoveries));
+    ESP_LOGI(TAG, "取得遅延 前回 %luμs 最大 %luμs", 
+             static_cast<unsigned long>(stats_.last_latency_us), static_cast<unsigned long>(stats_.max_latency_us));
+}
+
+esp_err_t Vl53l0x::readRegister(uint8_t reg, uint8_t& value) {
+    return i2c_->readRegister8(address_, reg, value, config_.timeout);
+}
+
+esp_err_t Vl53l0x::writeRegister(uint8_t reg, uint8_t value) {
+    return i2c_->writeRegister8(address_, reg, value, config_.timeout);
+}
+
+esp_err_t Vl53l0x::writeTable(const uint8_t (*table)[2], size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t ret = writeRegister(table[i][0], table[i][1]);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "レジスタ書き込み失敗 レジスタ:0x%02X エラー:%s", table[i][0], esp_err_to_name(ret));
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+} // namespace sensors
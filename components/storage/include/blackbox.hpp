@@ -0,0 +1,209 @@
+/*
+ * Blackbox
+ * 
+ * フライトブラックボックス記録（logsパーティション、生パーティションの追記ログ）
+ * 制御ループは毎周期のフレームをRAM上のブロックへ符号化するだけで、
+ * フラッシュへの書き込みはコア0の低優先度タスクがブロック単位でまとめて行う
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BLACKBOX_HPP
+#define BLACKBOX_HPP
+
+#include "blackbox_format.hpp"
+#include "esp_err.h"
+#include "partition_log.hpp"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief ブラックボックス記録クラス
+ * 
+ * RAM上に BUFFER_COUNT 個のブロックを持ち、制御タスクが1つを埋めている間に
+ * 書き込みタスクが埋まったブロックをPartitionLogへ書く（ダブルバッファ）。
+ * ブロックは埋める順・書く順とも巡回順で、空きブロックがない場合はフレームを捨てて数える
+ * （制御タスクは待たない）。欠落数は次のブロックのヘッダへ記録する。
+ * ブロックはフラッシュ1セクタ（4KB）で、先行消去済みのセクタへ1回で書くため書き込み時間が一定になる。
+ * 書き込みタスクは空き時間に先行消去を進める。書き込み失敗（上書きしない設定で満杯等）で記録を止める。
+ * 記録開始毎にセッション番号が増え、レコードヘッダに記録される（ダウンロード時の区切り）。
+ * ブロック番号はセッション毎に0から数えるため、各セッションの先頭ブロックは必ずスキーマを持つ
+ * （ホスト側は tools/blackbox_decode.py でCSV・Parquetへ復号する）。
+ * 
+ * 1kHz・1フレーム15〜20バイトで2MB（512セクタ）に2分前後。
+ * 自動サスペンドが無効なビルドではアーム中（common::FlashGuard の抑止中）にセクタを消去できないため、
+ * ディスアーム中に flight_erase_ahead セクタまで先行消去しておき、飛行中はそこへの追記だけを行う
+ * （飛行中に記録できるのは先行消去済みのセクタ分まで、使い切った後のフレームは欠落として数える）。
+ * initialize()・start()・stop()は同じ管理タスクから、record()は制御タスクから呼び出す
+ */
+class Blackbox {
+public:
+    static constexpr size_t BLOCK_SIZE = PartitionLog::SECTOR_SIZE;     // ブロックサイズ（書き込み単位）
+    static constexpr size_t BUFFER_COUNT = 2;                           // RAM上のブロック数
+    static constexpr uint32_t FLIGHT_BYTES_PER_SECOND = 17500;          // 1kHzでの記録量の目安（dump()の残り時間用）
+    
+    /**
+     * @brief 記録設定構造体
+     */
+    struct Config {
+        PartitionLog::Config log;                   // 追記ログ設定（パーティション・先行消去数）
+        uint32_t flight_erase_ahead = 256;          // アーム前に先行消去しておくセクタ数（飛行中の容量、1MBで約1分）
+        UBaseType_t task_priority = 2;              // 書き込みタスク優先度（低優先度）
+        BaseType_t task_core = 0;                   // 書き込みタスクのコア（制御ループと別）
+        uint32_t task_stack = 4096;                 // 書き込みタスクのスタック
+    };
+    
+    /**
+     * @brief 記録統計構造体
+     */
+    struct Stats {
+        uint32_t frames;                // 記録したフレーム数
+        uint32_t dropped_frames;        // バッファ枯渇で捨てたフレーム数
+        uint32_t blocks_written;        // 書き込んだブロック数
+        uint32_t bytes_written;         // 書き込んだバイト数
+        uint32_t payload_bytes;         // 符号化後のフレームのバイト数
+        uint32_t write_errors;          // 書き込み失敗回数
+        uint32_t last_write_us;         // 前回のブロック書き込み時間（μs）
+        uint32_t max_write_us;          // 最大のブロック書き込み時間（μs）
+    };
+    
+public:
+    Blackbox();
+    ~Blackbox();
+    
+    Blackbox(const Blackbox&) = delete;
+    Blackbox& operator=(const Blackbox&) = delete;
+    
+    /**
+     * @brief 初期化（パーティションの復元走査と書き込みタスクの作成）
+     * @param config 記録設定
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t initialize(const Config& config);
+    
+    /**
+     * @brief 既定設定での初期化
+     */
+    esp_err_t initialize() { return initialize(Config{}); }
+    
+    /**
+     * @brief 記録開始（新しいセッションを始める）
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t start();
+    
+    /**
+     * @brief 記録停止（書きかけのブロックを書き出す）
+     * @return esp_err_t 書き出し待ちがタイムアウトした場合ESP_ERR_TIMEOUT
+     */
+    esp_err_t stop();
+    
+    /**
+     * @brief フレームの記録（制御タスクから毎周期、待たない）
+     * @param frame フレーム
+     */
+    void record(const BlackboxFrame& frame);
+    
+    /**
+     * @brief 記録中か
+     */
+    bool isRecording() const { return recording_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 記録中のセッション番号（記録していない場合は前回のセッション）
+     */
+    uint32_t getSession() const { return log_.session(); }
+    
+    /**
+     * @brief 追記ログ取得（ダウンロード・消去用）
+     */
+    PartitionLog& getLog() { return log_; }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const;
+    
+    /**
+     * @brief 統計・容量のログ出力（CLI用）
+     */
+    void dump() const;
+    
+private:
+    /**
+     * @brief ブロックの状態
+     */
+    enum BufferState : uint8_t {
+        BUFFER_FREE = 0,        // 空き
+        BUFFER_FILLING,         // 制御タスクが符号化中
+        BUFFER_READY            // 書き込み待ち
+    };
+    
+    /**
+     * @brief RAM上のブロック
+     */
+    struct Buffer {
+        alignas(4) uint8_t data[BLOCK_SIZE];    // セクタ（先頭はレコードヘッダ、以降が符号化ブロック）
+        std::atomic<uint8_t> state;             // BufferState
+    };
+    
+    Config config_;                             // 設定
+    bool initialized_;                          // 初期化済み
+    TaskHandle_t task_;                         // 書き込みタスク
+    PartitionLog log_;                          // 追記ログ
+    bool session_open_;                         // セッション中（stop()まで）
+    
+    Buffer buffers_[BUFFER_COUNT];              // ブロック
+    BlackboxEncoder encoder_;                   // 符号化（制御タスクのみが触る）
+    int fill_index_;                            // 符号化中のブロック（-1でなし）
+    size_t next_fill_;                          // 次に埋めるブロック
+    size_t next_write_;                         // 次に書くブロック（書き込みタスクのみ）
+    uint32_t sequence_;                         // ブロック番号
+    uint32_t pending_dropped_;                  // 次のブロックに記録する欠落数
+    
+    std::atomic<bool> recording_;               // 記録中
+    std::atomic<bool> producer_busy_;           // record()実行中（stop()との排他）
+    
+    // 統計（書き手は1タスクずつ）
+    std::atomic<uint32_t> frames_;
+    std::atomic<uint32_t> dropped_frames_;
+    std::atomic<uint32_t> payload_bytes_;
+    std::atomic<uint32_t> blocks_written_;
+    std::atomic<uint32_t> bytes_written_;
+    std::atomic<uint32_t> write_errors_;
+    std::atomic<uint32_t> last_write_us_;
+    std::atomic<uint32_t> max_write_us_;
+    
+    /**
+     * @brief 次のブロックの確保と符号化開始（制御タスク）
+     * @return bool 空きブロックがない場合false
+     */
+    bool acquireBuffer();
+    
+    /**
+     * @brief 符号化中のブロックを確定して書き込みタスクへ渡す
+     */
+    void submitBuffer();
+    
+    /**
+     * @brief 書き込み待ちのブロックをすべて書く（書き込みタスク）
+     */
+    void writeReadyBuffers();
+    
+    /**
+     * @brief 書き込みタスク
+     */
+    static void writerTask(void* arg);
+};
+
+} // namespace storage
+
+#endif // BLACKBOX_HPP
@@ -0,0 +1,267 @@
+/*
+ * Blackbox Format
+ * 
+ * フライトブラックボックスのフレーム・ブロック形式と符号化/復号
+ * フィールドの定義（名前・分解能・予測方法）をブロックヘッダのスキーマに記録し、
+ * ブロック内ではフィールド毎の予測値との残差をジグザグ可変長整数で詰める
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BLACKBOX_FORMAT_HPP
+#define BLACKBOX_FORMAT_HPP
+
+#include "synced_clock.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief ブラックボックスのフレーム（1制御周期分、量子化済み）
+ * 
+ * 単位は量子化後の整数値。記録側で物理量から変換する（quantize()）
+ */
+struct BlackboxFrame {
+    static constexpr size_t FIELD_COUNT = 14;           // 時刻以外のフィールド数
+    static constexpr float GYRO_LSB = 0.001f;           // 角速度の分解能（rad/s、±32.7rad/s）
+    static constexpr float ACCEL_LSB = 0.01f;           // 加速度の分解能（m/s^2、±327m/s^2）
+    static constexpr float SETPOINT_LSB = 0.001f;       // 指令の分解能（正規化値、±32.7）
+    static constexpr float MOTOR_LSB = 0.0001f;         // デューティの分解能（0-6.5）
+    
+    uint32_t time_us;           // 時刻（μs、起動からの下位32bit）
+    int16_t gyro[3];            // 角速度 X, Y, Z
+    int16_t accel[3];           // 加速度 X, Y, Z
+    int16_t setpoint[4];        // 指令 ロール, ピッチ, ヨー, 推力
+    int16_t motor[4];           // モーター出力（MotorHal::Motorの順）
+    
+    /**
+     * @brief 物理量の量子化（範囲外は飽和）
+     * @param value 物理量
+     * @param lsb 分解能
+     */
+    static int16_t quantize(float value, float lsb) {
+        float scaled = value / lsb;
+        if (scaled >= 32767.0f) {
+            return 32767;
+        }
+        if (scaled <= -32768.0f) {
+            return -32768;
+        }
+        return static_cast<int16_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+    }
+};
+
+/**
+ * @brief フィールドの予測方法（残差 = 値 - 予測値 を符号化する）
+ * 
+ * ブロックの先頭フレームは常に予測値0（キーフレーム）、2フレーム目は LINEAR・AVERAGE_2 も PREVIOUS として扱う
+ */
+enum class BlackboxPredictor : uint8_t {
+    ZERO = 0,           // 予測なし（値そのもの）
+    PREVIOUS = 1,       // 前フレームの値
+    LINEAR = 2,         // 前2フレームからの直線外挿（2a - b、一定周期の時刻・滑らかな量）
+    AVERAGE_2 = 3       // 前2フレームの平均（floor((a + b) / 2)、雑音の多い量）
+};
+
+/**
+ * @brief スキーマのフィールド定義（ヘッダのスキーマ領域、リトルエンディアン）
+ */
+struct BlackboxFieldDef {
+    char name[11];              // フィールド名（NUL終端、CSVの列名）
+    uint8_t predictor;          // BlackboxPredictor
+    float lsb;                  // 分解能（物理量 = 値 × lsb）
+};
+
+static_assert(sizeof(BlackboxFieldDef) == 16, "フィールド定義の配置");
+
+/**
+ * @brief スキーマ領域の先頭（ブロックヘッダの直後、SCHEMA_PRESENT のブロックのみ）
+ */
+struct BlackboxSchemaHeader {
+    uint8_t field_count;        // フィールド数（時刻を除く）
+    uint8_t time_predictor;     // 時刻のBlackboxPredictor
+    uint8_t field_size;         // フィールド定義1つのバイト数（sizeof(BlackboxFieldDef)）
+    uint8_t reserved;           // 予約（0）
+};
+
+/**
+ * @brief ファームウェアのスキーマ（BlackboxFrameのフィールド順、マスクのビット番号と一致）
+ */
+struct BlackboxSchema {
+    static constexpr BlackboxPredictor TIME_PREDICTOR = BlackboxPredictor::LINEAR;
+    static constexpr BlackboxFieldDef FIELDS[BlackboxFrame::FIELD_COUNT] = {
+        {"gyro_x",      static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::GYRO_LSB},
+        {"gyro_y",      static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::GYRO_LSB},
+        {"gyro_z",      static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::GYRO_LSB},
+        {"accel_x",     static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::ACCEL_LSB},
+        {"accel_y",     static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::ACCEL_LSB},
+        {"accel_z",     static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::ACCEL_LSB},
+        {"sp_roll",     static_cast<uint8_t>(BlackboxPredictor::PREVIOUS),  BlackboxFrame::SETPOINT_LSB},
+        {"sp_pitch",    static_cast<uint8_t>(BlackboxPredictor::PREVIOUS),  BlackboxFrame::SETPOINT_LSB},
+        {"sp_yaw",      static_cast<uint8_t>(BlackboxPredictor::PREVIOUS),  BlackboxFrame::SETPOINT_LSB},
+        {"sp_thrust",   static_cast<uint8_t>(BlackboxPredictor::PREVIOUS),  BlackboxFrame::SETPOINT_LSB},
+        {"motor_fl",    static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::MOTOR_LSB},
+        {"motor_fr",    static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::MOTOR_LSB},
+        {"motor_rl",    static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::MOTOR_LSB},
+        {"motor_rr",    static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2), BlackboxFrame::MOTOR_LSB},
+    };
+    static constexpr size_t SECTION_SIZE = sizeof(BlackboxSchemaHeader) + sizeof(FIELDS);  // スキーマ領域のバイト数
+};
+
+/**
+ * @brief ブロックヘッダ（リトルエンディアン）
+ * 
+ * 各ブロックは BLOCK_SIZE バイト固定で、先頭フレームを予測なし（キーフレーム）として符号化するため、
+ * ブロック単体で復号できる（書き込み途中の電源断でも前のブロックは読める）。
+ * 版3ではセッションの先頭から SCHEMA_INTERVAL ブロック毎にヘッダの直後へスキーマを置く
+ * （header_size がスキーマを含む）。スキーマのないブロックは直前のスキーマ、なければ
+ * ファームウェアの BlackboxSchema で復号する。版1・2は全フィールド PREVIOUS・時刻 PREVIOUS
+ */
+struct BlackboxBlockHeader {
+    static constexpr uint32_t MAGIC = 0x31584242;   // "BBX1"
+    static constexpr uint16_t VERSION = 3;          // 形式の版（2で同期時刻、3でスキーマとフィールド毎の予測を追加）
+    static constexpr uint16_t VERSION_1_SIZE = 32;  // 版1のヘッダのバイト数（同期時刻なし）
+    static constexpr uint32_t SYNC_VALID = 0x01;    // flags: 同期時刻が有効
+    static constexpr uint32_t SCHEMA_PRESENT = 0x02;    // flags: ヘッダの直後にスキーマがある（版3）
+    static constexpr uint32_t SCHEMA_INTERVAL = 16; // スキーマを置くブロックの間隔
+    
+    uint32_t magic;             // MAGIC
+    uint16_t version;           // VERSION
+    uint16_t header_size;       // ヘッダのバイト数（ペイロードの開始位置）
+    uint32_t sequence;          // セッション内のブロック番号
+    uint32_t frame_count;       // ブロック内のフレーム数
+    uint32_t payload_size;      // ペイロードのバイト数（残りは0埋め）
+    uint32_t first_time_us;     // 先頭フレームの時刻
+    uint32_t last_time_us;      // 最終フレームの時刻
+    uint32_t dropped_frames;    // 前ブロックとの間で欠落したフレーム数（バッファ枯渇）
+    uint32_t flags;             // SYNC_VALID・SCHEMA_PRESENT（版1は0）
+    int32_t sync_drift_ppb;     // ブロック内の同期時刻の進み（ppb）
+    int64_t synced_first_time_us;   // 先頭フレームの同期時刻（μs、地上局の時刻）
+};
+
+static_assert(sizeof(BlackboxBlockHeader) == 48, "ブロックヘッダの配置");
+
+/**
+ * @brief ブロック符号化クラス
+ * 
+ * フレームの符号: [時刻の残差 zigzag varint][残差が0でないフィールドのマスク 2バイト][残差 zigzag varint...]
+ * 一定周期の時刻は直線予測で残差0（1バイト）になり、一定指令中の指令はマスクだけで済む。
+ * 雑音の多い角速度・加速度は前2フレームの平均からの残差で、前フレームとの差分より小さくなる
+ */
+class BlackboxEncoder {
+public:
+    static constexpr size_t MAX_FRAME_BYTES = 5 + 2 + BlackboxFrame::FIELD_COUNT * 3;  // 1フレームの最大符号長（フィールドの残差は3バイト以内）
+    
+    BlackboxEncoder();
+    
+    /**
+     * @brief ブロックの書き始め
+     * @param block ブロック領域（4バイト境界）
+     * @param size ブロックサイズ（バイト）
+     * @param sequence ブロック番号（SCHEMA_INTERVAL の倍数のブロックにスキーマを置く）
+     * @param dropped_frames 前ブロックとの間で欠落したフレーム数
+     */
+    void begin(uint8_t* block, size_t size, uint32_t sequence, uint32_t dropped_frames);
+    
+    /**
+     * @brief フレームの追加
+     * @param frame フレーム
+     * @return bool ブロックに空きがない場合false（フレームは追加されない）
+     */
+    bool append(const BlackboxFrame& frame);
+    
+    /**
+     * @brief ブロックの確定（ヘッダ記入と残りの0埋め）
+     * 
+     * フレームの時刻は起動からの時刻のまま差分符号化し、同期時刻はヘッダに1つだけ記録する
+     * （同期の更新で時刻差分が跳ばない）
+     * @param clock 時刻モデル（nullptr・未同期なら同期時刻なし）
+     * @return size_t ペイロードのバイト数
+     */
+    size_t finish(const common::ClockModel* clock = nullptr);
+    
+    /**
+     * @brief ブロック内のフレーム数
+     */
+    uint32_t frameCount() const { return frame_count_; }
+    
+private:
+    uint8_t* block_;                                // ブロック領域
+    size_t size_;                                   // ブロックサイズ
+    size_t position_;                               // 書き込み位置
+    uint32_t frame_count_;                          // フレーム数
+    BlackboxBlockHeader header_;                    // ヘッダ（finish()で書き込む）
+    uint32_t time_[2];                              // 前・前々フレームの時刻
+    int16_t previous_[2][BlackboxFrame::FIELD_COUNT];   // 前・前々フレームのフィールド
+};
+
+/**
+ * @brief ブロック復号クラス（ダウンロード・解析用）
+ * 
+ * スキーマはブロックをまたいで保持する（セッションの途中から読む場合は BlackboxSchema を使う）。
+ * 異なるフィールド数のスキーマは BlackboxFrame へ復号できないため begin() で断る（ホスト側の復号器は読める）
+ */
+class BlackboxDecoder {
+public:
+    BlackboxDecoder();
+    
+    /**
+     * @brief ブロックの読み始め
+     * @param block ブロック先頭
+     * @param size 読めるバイト数
+     * @return bool ヘッダ・スキーマが不正な場合false
+     */
+    bool begin(const uint8_t* block, size_t size);
+    
+    /**
+     * @brief 次のフレームの復号
+     * @param frame 格納先
+     * @return bool ブロックの終わり、または符号が壊れている場合false
+     */
+    bool next(BlackboxFrame& frame);
+    
+    /**
+     * @brief ブロックヘッダ取得
+     */
+    const BlackboxBlockHeader& header() const { return header_; }
+    
+    /**
+     * @brief 復号に使っているフィールド定義
+     * @param index フィールド番号（BlackboxFrame::FIELD_COUNT 未満）
+     */
+    const BlackboxFieldDef& field(size_t index) const { return fields_[index]; }
+    
+    /**
+     * @brief フレームの時刻を同期時刻へ変換（同期時刻のないブロックはそのまま返す）
+     * @param time_us フレームの時刻（このブロックのフレーム）
+     * @return int64_t 同期時刻（μs）
+     */
+    int64_t syncedTime(uint32_t time_us) const;
+    
+private:
+    const uint8_t* payload_;                        // ペイロード先頭
+    size_t payload_size_;                           // ペイロードのバイト数
+    size_t position_;                               // 読み出し位置
+    uint32_t frame_index_;                          // 復号したフレーム数
+    BlackboxBlockHeader header_;                    // ヘッダ
+    BlackboxFieldDef fields_[BlackboxFrame::FIELD_COUNT];   // フィールド定義（直前のスキーマ）
+    uint8_t time_predictor_;                        // 時刻の予測方法（直前のスキーマ）
+    uint32_t time_[2];                              // 前・前々フレームの時刻
+    int16_t previous_[2][BlackboxFrame::FIELD_COUNT];   // 前・前々フレームのフィールド
+    
+    bool readVarint(uint32_t& value);
+    
+    /**
+     * @brief ヘッダ直後のスキーマ読み込み
+     * @return bool スキーマが不正な場合false
+     */
+    bool readSchema(const uint8_t* block);
+};
+
+} // namespace storage
+
+#endif // BLACKBOX_FORMAT_HPP
@@ -0,0 +1,123 @@
+/*
+ * Mapped Log
+ * 
+ * メモリマップした追記ログ（logsパーティション）のその場読み出しと
+ * ブラックボックスの飛行後集計（振動・角速度・モーター出力のピーク）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef MAPPED_LOG_HPP
+#define MAPPED_LOG_HPP
+
+#include "partition_log.hpp"
+#include "partition_map.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief メモリマップ経由の追記ログ読み出しクラス
+ * 
+ * PartitionLogのレコードを古い順に、フラッシュ上のポインタとして返す（RAMへコピーしない）。
+ * PartitionLogを開いていなくても使え、記録中でも読める。書き込み位置付近のレコードが
+ * 消去と重なった場合はCRCが合わなくなるので飛ばす
+ */
+class MappedLogReader {
+public:
+    /**
+     * @brief レコード
+     */
+    struct Record {
+        const PartitionLogHeader* header;   // ヘッダ（フラッシュ上）
+        const uint8_t* payload;             // ペイロード（フラッシュ上、header->payload_size バイト）
+        uint32_t sector;                    // セクタ番号
+    };
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param map logsパーティション全体の割り当て
+     */
+    explicit MappedLogReader(const PartitionMap& map);
+    
+    /**
+     * @brief 最古のレコードへ戻る（ヘッダを一通り走査する）
+     * @return uint32_t 有効なレコード数
+     */
+    uint32_t rewind();
+    
+    /**
+     * @brief 次のレコード
+     * @param record 出力先
+     * @param session セッション番号（0で全セッション）
+     * @return bool 残りがない場合false
+     */
+    bool next(Record& record, uint32_t session = 0);
+    
+    /**
+     * @brief 最新のセッション番号（rewind()後に有効、レコードがない場合0）
+     */
+    uint32_t latestSession() const { return latest_session_; }
+    
+    /**
+     * @brief CRCが合わず飛ばしたレコード数（rewind()で0に戻る）
+     */
+    uint32_t skipped() const { return skipped_; }
+    
+private:
+    const PartitionMap& map_;               // 割り当て
+    uint32_t sector_count_;                 // セクタ数
+    uint32_t first_sector_;                 // 最古のレコードのセクタ
+    uint32_t position_;                     // 走査済みのセクタ数
+    uint32_t latest_session_;               // 最新のセッション番号
+    uint32_t skipped_;                      // 飛ばしたレコード数
+    
+    /**
+     * @brief セクタのヘッダ（不正な場合nullptr）
+     */
+    const PartitionLogHeader* header(uint32_t sector) const;
+};
+
+/**
+ * @brief ブラックボックスの集計結果
+ */
+struct BlackboxSummary {
+    uint32_t session;               // セッション番号
+    uint32_t blocks;                // ブロック数
+    uint32_t frames;                // フレーム数
+    uint32_t dropped_frames;        // 欠落したフレーム数
+    uint32_t corrupt_blocks;        // 復号できなかったブロック数
+    uint32_t duration_ms;           // 記録時間（ms）
+    float max_gyro[3];              // 角速度の絶対値の最大 X, Y, Z（rad/s）
+    float accel_rms[3];             // 振動（加速度の高域成分）の実効値 X, Y, Z（m/s^2）
+    float accel_peak[3];            // 振動の絶対値の最大 X, Y, Z（m/s^2）
+    float max_motor[4];             // モーター出力の最大
+    float mean_motor[4];            // モーター出力の平均
+};
+
+/**
+ * @brief ブラックボックスのセッションを集計
+ * 
+ * 各ブロックをフラッシュ上のままBlackboxDecoderで復号する。振動は加速度から
+ * 1次のローパス（機体の運動・重力）を引いた残りとする
+ * @param reader 読み出しクラス（内部でrewind()する）
+ * @param session セッション番号（0で最新のセッション）
+ * @param summary 出力先
+ * @return esp_err_t 該当するブロックがない場合ESP_ERR_NOT_FOUND
+ */
+esp_err_t summarizeBlackbox(MappedLogReader& reader, uint32_t session, BlackboxSummary& summary);
+
+/**
+ * @brief 集計結果のログ出力（CLI用）
+ */
+void dumpBlackboxSummary(const BlackboxSummary& summary);
+
+} // namespace storage
+
+#endif // MAPPED_LOG_HPP
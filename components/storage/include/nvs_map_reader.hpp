@@ -0,0 +1,112 @@
+/*
+ * NVS Map Reader
+ * 
+ * メモリマップしたNVSパーティション（params・backup）のその場読み出し
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef NVS_MAP_READER_HPP
+#define NVS_MAP_READER_HPP
+
+#include "partition_map.hpp"
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief NVSのメモリマップ読み出しクラス
+ * 
+ * NVSのページ・エントリ形式を直接たどり、値やBLOBをフラッシュ上のポインタとして返す。
+ * nvs_open()やハンドル・RAMのコピーが不要で、起動直後の確認やCLIでの参照に使う。
+ * 1チャンクに収まるBLOB（約4000バイトまで）のみ扱い、NVS暗号化時は使えない。
+ * 書き込みはnvs_*のAPIで行う（ここでは読むだけ）
+ */
+class NvsMapReader {
+public:
+    static constexpr size_t PAGE_SIZE = 4096;           // ページ（セクタ）
+    static constexpr size_t ENTRY_SIZE = 32;            // エントリ
+    static constexpr size_t ENTRY_COUNT = 126;          // 1ページのエントリ数
+    static constexpr size_t KEY_SIZE = 16;              // キーの最大長（終端含む）
+    
+public:
+    /**
+     * @brief コンストラクタ
+     * @param map NVSパーティション全体の割り当て
+     */
+    explicit NvsMapReader(const PartitionMap& map);
+    
+    /**
+     * @brief 符号なし32bit値の取得
+     * @param name_space 名前空間
+     * @param key キー
+     * @param value 出力先
+     * @return esp_err_t 見つからない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t getU32(const char* name_space, const char* key, uint32_t& value) const;
+    
+    /**
+     * @brief 符号付き32bit値の取得
+     */
+    esp_err_t getI32(const char* name_space, const char* key, int32_t& value) const;
+    
+    /**
+     * @brief BLOBの取得（フラッシュ上のポインタ）
+     * @param name_space 名前空間
+     * @param key キー
+     * @param data 出力先（割り当てを解除するまで有効）
+     * @param size 出力先（バイト数）
+     * @return esp_err_t 複数チャンクのBLOBはESP_ERR_NOT_SUPPORTED、データのCRC不一致はESP_ERR_INVALID_CRC
+     */
+    esp_err_t getBlob(const char* name_space, const char* key, const uint8_t*& data, size_t& size) const;
+    
+private:
+    static constexpr uint8_t CHUNK_ANY = 0xFF;          // チャンク番号を問わない（BLOB以外のエントリの値）
+    
+    /**
+     * @brief エントリ（nvs::Itemと同じ配置）
+     */
+    struct Item {
+        uint8_t ns_index;           // 名前空間番号（0は名前空間の定義）
+        uint8_t type;               // データ型
+        uint8_t span;               // 占めるエントリ数
+        uint8_t chunk_index;        // BLOBのチャンク番号
+        uint32_t crc;               // エントリのCRC32
+        char key[KEY_SIZE];         // キー
+        uint8_t data[8];            // 値、または可変長データの情報
+    };
+    static_assert(sizeof(Item) == ENTRY_SIZE, "NVSエントリの配置");
+    
+    const PartitionMap& map_;       // 割り当て
+    uint32_t page_count_;           // ページ数
+    
+    /**
+     * @brief 名前空間番号の検索
+     */
+    esp_err_t findNamespace(const char* name_space, uint8_t& index) const;
+    
+    /**
+     * @brief エントリの検索（複数見つかった場合は新しいページのもの）
+     * @param chunk_index チャンク番号（CHUNK_ANYで問わない）
+     */
+    const Item* findItem(uint8_t ns_index, uint8_t type, const char* key, uint8_t chunk_index) const;
+    
+    /**
+     * @brief 固定長の値の取得
+     */
+    esp_err_t getPrimitive(const char* name_space, const char* key, uint8_t type, void* value, size_t size) const;
+    
+    /**
+     * @brief エントリのCRC計算
+     */
+    static uint32_t itemCrc(const Item& item);
+};
+
+} // namespace storage
+
+#endif // NVS_MAP_READER_HPP
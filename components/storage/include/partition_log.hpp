@@ -0,0 +1,229 @@
+/*
+ * Partition Log
+ * 
+ * 生パーティション上の追記型ログ（ファイルシステムなし）
+ * 1セクタ = ヘッダ + ペイロード のレコードを巡回的に書き、
+ * 書き込み先は常に消去済みのセクタとなるよう先行して消去する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PARTITION_LOG_HPP
+#define PARTITION_LOG_HPP
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief セクタ先頭のレコードヘッダ（リトルエンディアン）
+ * 
+ * 消去済み（0xFF）・書き込み途中のセクタはmagicとheader_crcで区別する。
+ * ペイロードの途中で電源断した場合はpayload_crcが合わない
+ */
+struct PartitionLogHeader {
+    static constexpr uint32_t MAGIC = 0x31474C50;   // "PLG1"
+    
+    uint32_t magic;             // MAGIC
+    uint32_t sequence;          // 通し番号（パーティション全体で単調増加、最大のものが最新）
+    uint32_t session;           // セッション番号（記録開始毎に増える）
+    uint32_t payload_size;      // ペイロードのバイト数
+    uint32_t payload_crc;       // ペイロードのCRC32
+    uint32_t header_crc;        // ここまでのフィールドのCRC32
+    uint32_t reserved[2];       // 予約（0）
+};
+
+/**
+ * @brief 生パーティション追記ログクラス
+ * 
+ * SPIFFSのガベージコレクションのような予測できない待ちをなくすため、
+ * 書き込み（append）は消去済みセクタへの1回のesp_partition_writeだけにする。
+ * 消去はeraseAhead()で書き込み位置の先を erase_ahead セクタ分まで進めておき、
+ * 書き込みタスクが空いている間に呼び出す（消去中はフラッシュキャッシュが止まるため、
+ * 自動サスペンドが無効なビルドでは common::FlashGuard の抑止中は書き込み・消去を断る。
+ * realtime_append の設定では消去済みセクタへの追記だけは抑止中も行い、抑止中に書けるのは
+ * 抑止開始時に先行消去済みだったセクタ数までとなる）。
+ * 
+ * 起動時のopen()で全セクタのヘッダを読み、通し番号が最大のレコードの次から書き始める
+ * （電源断で途切れたレコードは読み出し時にCRCで捨てる）。
+ * append()・eraseAhead()は1つのタスクから呼び出すこと
+ */
+class PartitionLog {
+public:
+    static constexpr size_t SECTOR_SIZE = 4096;                                 // セクタ（消去単位）
+    static constexpr size_t HEADER_SIZE = sizeof(PartitionLogHeader);            // ヘッダのバイト数
+    static constexpr size_t PAYLOAD_SIZE = SECTOR_SIZE - HEADER_SIZE;            // ペイロードの最大バイト数
+    
+    /**
+     * @brief ログ設定構造体
+     */
+    struct Config {
+        const char* partition_label = "logs";       // パーティション名
+        uint32_t erase_ahead = 4;                   // 先行して消去しておくセクタ数
+        bool overwrite_oldest = true;               // 満杯時に最古のレコードを上書きする（falseで書き込みを止める）
+        bool realtime_append = false;               // 消去済みセクタへの追記は FlashGuard の抑止中も行う（消去は断る）
+    };
+    
+    /**
+     * @brief ログ統計構造体
+     */
+    struct Stats {
+        uint32_t appended;              // 書き込んだレコード数
+        uint32_t erased;                // 消去したセクタ数
+        uint32_t overwritten;           // 上書きで消えたレコード数
+        uint32_t recovered;             // 起動時に見つけた有効なレコード数
+        uint32_t torn;                  // 起動時に見つけた途切れたレコード数
+        uint32_t stalls;                // 消去済みセクタがなく書き込み前に消去した回数
+        uint32_t blocked;               // 制御中（FlashGuard）で断った書き込み・消去の回数
+        uint32_t last_write_us;         // 前回の書き込み時間（μs）
+        uint32_t max_write_us;          // 最大の書き込み時間（μs）
+        uint32_t max_erase_us;          // 最大のセクタ消去時間（μs）
+    };
+    
+public:
+    PartitionLog();
+    
+    PartitionLog(const PartitionLog&) = delete;
+    PartitionLog& operator=(const PartitionLog&) = delete;
+    
+    /**
+     * @brief パーティションを開き、書き込み位置を復元する
+     * @param config ログ設定
+     * @return esp_err_t パーティションがない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t open(const Config& config);
+    
+    /**
+     * @brief 既定設定で開く
+     */
+    esp_err_t open() { return open(Config{}); }
+    
+    /**
+     * @brief 開いているか
+     */
+    bool isOpen() const { return partition_ != nullptr; }
+    
+    /**
+     * @brief 新しいセッションの開始
+     * @return uint32_t セッション番号（以降のレコードに記録される）
+     */
+    uint32_t beginSession();
+    
+    /**
+     * @brief レコードの追記
+     * @param sector セクタ分のバッファ（先頭HEADER_SIZEバイトはヘッダ用、ペイロードはその後ろ）
+     * @param payload_size ペイロードのバイト数（PAYLOAD_SIZE以下）
+     * @return esp_err_t 満杯で上書きしない設定の場合ESP_ERR_NO_MEM、制御中で断った場合ESP_ERR_NOT_ALLOWED
+     */
+    esp_err_t append(uint8_t* sector, size_t payload_size);
+    
+    /**
+     * @brief 先行消去を1セクタ進める（書き込みタスクの空き時間に呼び出す）
+     * @return esp_err_t 満杯で上書きしない設定の場合ESP_ERR_NO_MEM、制御中で断った場合ESP_ERR_NOT_ALLOWED
+     */
+    esp_err_t eraseAhead();
+    
+    /**
+     * @brief 先行消去が目標に届いていないか
+     */
+    bool needsErase() const { return partition_ != nullptr && erased_ahead_ < config_.erase_ahead; }
+    
+    /**
+     * @brief 消去済みで書き込み待ちのセクタ数
+     */
+    uint32_t erasedAhead() const { return erased_ahead_; }
+    
+    /**
+     * @brief 全消去（書き込み位置・通し番号は先頭に戻る）
+     * @return esp_err_t 制御中で断った場合ESP_ERR_NOT_ALLOWED
+     */
+    esp_err_t eraseAll();
+    
+    /**
+     * @brief セクタのレコード読み出し（他タスクから呼び出し可）
+     * @param sector セクタ番号
+     * @param header ヘッダ格納先
+     * @param payload ペイロード格納先（PAYLOAD_SIZEバイト、nullptrでヘッダのみ）
+     * @return esp_err_t 空き・不正の場合ESP_ERR_NOT_FOUND、途切れている場合ESP_ERR_INVALID_CRC
+     */
+    esp_err_t readSector(uint32_t sector, PartitionLogHeader& header, uint8_t* payload) const;
+    
+    /**
+     * @brief セクタのヘッダ読み出し（ペイロードのCRCは確認しない、他タスクから呼び出し可）
+     * @param sector セクタ番号
+     * @param header ヘッダ格納先
+     * @return esp_err_t 空き・不正の場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t readHeader(uint32_t sector, PartitionLogHeader& header) const;
+    
+    /**
+     * @brief セクタ内の生データ読み出し（ダウンロード用、他タスクから呼び出し可）
+     * @param sector セクタ番号
+     * @param offset セクタ内のオフセット（ヘッダ先頭が0）
+     * @param buffer 格納先
+     * @param length バイト数
+     * @return esp_err_t エラーコード
+     */
+    esp_err_t read(uint32_t sector, size_t offset, void* buffer, size_t length) const;
+    
+    /**
+     * @brief セクタ数
+     */
+    uint32_t sectorCount() const { return sector_count_; }
+    
+    /**
+     * @brief 次に書くセクタ番号
+     */
+    uint32_t writeSector() const { return write_sector_.load(std::memory_order_acquire); }
+    
+    /**
+     * @brief 現在のセッション番号
+     */
+    uint32_t session() const { return session_.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief 統計取得
+     */
+    Stats getStats() const { return stats_; }
+    
+    /**
+     * @brief 状態・統計のログ出力（CLI用）
+     */
+    void dump() const;
+    
+    /**
+     * @brief ヘッダの検証（メモリマップ経由の読み出しでも使う）
+     */
+    static bool validHeader(const PartitionLogHeader& header);
+    
+private:
+    Config config_;                             // 設定
+    const esp_partition_t* partition_;          // パーティション
+    uint32_t sector_count_;                     // セクタ数
+    std::atomic<uint32_t> write_sector_;        // 次に書くセクタ
+    uint32_t erased_ahead_;                     // 書き込み位置から先の消去済みセクタ数
+    uint32_t next_sequence_;                    // 次の通し番号
+    std::atomic<uint32_t> session_;             // セッション番号
+    Stats stats_;                               // 統計
+    
+    /**
+     * @brief 起動時の走査（最新レコードの検索）
+     */
+    void recover();
+    
+    /**
+     * @brief ヘッダのCRC計算
+     */
+    static uint32_t headerCrc(const PartitionLogHeader& header);
+};
+
+} // namespace storage
+
+#endif // PARTITION_LOG_HPP
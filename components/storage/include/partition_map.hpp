@@ -0,0 +1,96 @@
+/*
+ * Partition Map
+ * 
+ * パーティションのメモリマップ（フラッシュキャッシュ経由の読み出し専用ビュー）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef PARTITION_MAP_HPP
+#define PARTITION_MAP_HPP
+
+#include "esp_err.h"
+#include "esp_partition.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace storage {
+
+/**
+ * @brief パーティションのメモリマップクラス
+ * 
+ * esp_partition_mmap()でパーティション（またはその一部）をデータ空間へ割り当て、
+ * ポインタで直接読めるようにする。RAMへのコピーがなく、読んだ分だけキャッシュに載る。
+ * MMUは64KB単位で仮想アドレス空間を消費するため、大きなパーティションは必要な範囲だけを割り当てる。
+ * 割り当て中もesp_partition_write()等の書き込みは使える（書き込み時にキャッシュは無効化される）
+ */
+class PartitionMap {
+public:
+    PartitionMap();
+    ~PartitionMap();
+    
+    PartitionMap(const PartitionMap&) = delete;
+    PartitionMap& operator=(const PartitionMap&) = delete;
+    
+    /**
+     * @brief 割り当て（前の割り当ては解除する）
+     * @param label パーティション名（"logs"・"storage"・"params"等）
+     * @param offset パーティション先頭からのオフセット
+     * @param size バイト数（0で末尾まで）
+     * @return esp_err_t パーティションがない場合ESP_ERR_NOT_FOUND
+     */
+    esp_err_t map(const char* label, size_t offset = 0, size_t size = 0);
+    
+    /**
+     * @brief 割り当て解除
+     */
+    void unmap();
+    
+    /**
+     * @brief 割り当て済みか
+     */
+    bool isMapped() const { return data_ != nullptr; }
+    
+    /**
+     * @brief 先頭アドレス
+     */
+    const uint8_t* data() const { return data_; }
+    
+    /**
+     * @brief 割り当てたバイト数
+     */
+    size_t size() const { return size_; }
+    
+    /**
+     * @brief 割り当てたパーティション
+     */
+    const esp_partition_t* partition() const { return partition_; }
+    
+    /**
+     * @brief 範囲を確認した型付き参照
+     * @tparam T 読み出す型（フラッシュ上の配置のまま）
+     * @param offset 割り当て先頭からのオフセット
+     * @param count 要素数
+     * @return const T* 範囲外の場合nullptr
+     */
+    template<typename T>
+    const T* at(size_t offset, size_t count = 1) const {
+        if (data_ == nullptr || offset > size_ || count * sizeof(T) > size_ - offset) {
+            return nullptr;
+        }
+        return reinterpret_cast<const T*>(data_ + offset);
+    }
+    
+private:
+    const esp_partition_t* partition_;          // パーティション
+    esp_partition_mmap_handle_t handle_;        // 割り当てハンドル
+    const uint8_t* data_;                       // 先頭アドレス
+    size_t size_;                               // バイト数
+};
+
+} // namespace storage
+
+#endif // PARTITION_MAP_HPP
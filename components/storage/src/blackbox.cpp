@@ -0,0 +1,305 @@
+/*
+ * Blackbox Implementation
+ * 
+ * フライトブラックボックス記録実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "blackbox.hpp"
+#include "flash_guard.hpp"
+#include "esp_log.h"
+#include <cstring>
+
+namespace storage {
+
+static const char* TAG = "storage::Blackbox";
+
+static constexpr TickType_t WRITER_POLL_TICKS = pdMS_TO_TICKS(100);  // 書き込みタスクの待ち
+static constexpr TickType_t STOP_TIMEOUT_TICKS = pdMS_TO_TICKS(2000); // stop()の書き出し待ち
+
+static_assert(sizeof(BlackboxBlockHeader) + BlackboxSchema::SECTION_SIZE + BlackboxEncoder::MAX_FRAME_BYTES 
+              <= PartitionLog::PAYLOAD_SIZE, 
+              "ブロックに1フレーム以上入ること");
+
+Blackbox::Blackbox()
+    : initialized_(false)
+    , task_(nullptr)
+    , session_open_(false)
+    , fill_index_(-1)
+    , next_fill_(0)
+    , next_write_(0)
+    , sequence_(0)
+    , pending_dropped_(0)
+    , recording_(false)
+    , producer_busy_(false)
+    , frames_(0)
+    , dropped_frames_(0)
+    , payload_bytes_(0)
+    , blocks_written_(0)
+    , bytes_written_(0)
+    , write_errors_(0)
+    , last_write_us_(0)
+    , max_write_us_(0) {
+    for (auto& buffer : buffers_) {
+        buffer.state.store(BUFFER_FREE, std::memory_order_relaxed);
+    }
+}
+
+Blackbox::~Blackbox() {
+    stop();
+    if (task_ != nullptr) {
+        vTaskDelete(task_);
+        task_ = nullptr;
+    }
+}
+
+esp_err_t Blackbox::initialize(const Config& config) {
+    if (initialized_) {
+        return ESP_OK;
+    }
+    config_ = config;
+    // 飛行中は消去できない（自動サスペンド無効時）ため、アーム前に飛行分を先行消去しておき追記だけ続ける
+    if (config_.log.erase_ahead < config_.flight_erase_ahead) {
+        config_.log.erase_ahead = config_.flight_erase_ahead;
+    }
+    config_.log.realtime_append = true;
+    
+    esp_err_t ret = log_.open(config_.log);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    BaseType_t created = xTaskCreatePinnedToCore(writerTask, "blackbox", config_.task_stack, this, 
+                                                 config_.task_priority, &task_, config_.task_core);
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "書き込みタスク作成失敗");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    initialized_ = true;
+    ESP_LOGI(TAG, "初期化完了 %s", config_.log.partition_label);
+    return ESP_OK;
+}
+
+esp_err_t Blackbox::start() {
+    if (!initialized_) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (recording_.load(std::memory_order_relaxed)) {
+        return ESP_OK;
+    }
+    if (session_open_) {
+        // 書き込み失敗で止まった前回のセッション
+        stop();
+    }
+    
+    fill_index_ = -1;
+    next_fill_ = 0;
+    next_write_ = 0;
+    sequence_ = 0;
+    pending_dropped_ = 0;
+    for (auto& buffer : buffers_) {
+        buffer.state.store(BUFFER_FREE, std::memory_order_relaxed);
+    }
+    frames_.store(0, std::memory_order_relaxed);
+    dropped_frames_.store(0, std::memory_order_relaxed);
+    payload_bytes_.store(0, std::memory_order_relaxed);
+    blocks_written_.store(0, std::memory_order_relaxed);
+    bytes_written_.store(0, std::memory_order_relaxed);
+    write_errors_.store(0, std::memory_order_relaxed);
+    last_write_us_.store(0, std::memory_order_relaxed);
+    max_write_us_.store(0, std::memory_order_relaxed);
+    
+    uint32_t session = log_.beginSession();
+    session_open_ = true;
+    recording_.store(true, std::memory_order_release);
+    ESP_LOGI(TAG, "記録開始 セッション %lu", static_cast<unsigned long>(session));
+    return ESP_OK;
+}
+
+esp_err_t Blackbox::stop() {
+    if (!session_open_) {
+        return ESP_OK;
+    }
+    
+    // record()の実行中を抜けるまで待ってから、書きかけのブロックを引き取る
+    recording_.store(false, std::memory_order_seq_cst);
+    while (producer_busy_.load(std::memory_order_seq_cst)) {
+        vTaskDelay(1);
+    }
+    if (fill_index_ >= 0) {
+        if (encoder_.frameCount() > 0) {
+            submitBuffer();
+        } else {
+            buffers_[fill_index_].state.store(BUFFER_FREE, std::memory_order_release);
+            fill_index_ = -1;
+        }
+    }
+    
+    // 書き込み待ちがなくなるまで待つ
+    TickType_t start = xTaskGetTickCount();
+    while (true) {
+        bool pending = false;
+        for (const auto& buffer : buffers_) {
+            pending |= buffer.state.load(std::memory_order_acquire) != BUFFER_FREE;
+        }
+        if (!pending) {
+            break;
+        }
+        if (xTaskGetTickCount() - start > STOP_TIMEOUT_TICKS) {
+            ESP_LOGE(TAG, "書き出し待ちタイムアウト");
+            return ESP_ERR_TIMEOUT;
+        }
+        xTaskNotifyGive(task_);
+        vTaskDelay(1);
+    }
+    
+    session_open_ = false;
+    ESP_LOGI(TAG, "記録停止 セッション %lu フレーム %lu 欠落 %lu %lu バイト", 
+             static_cast<unsigned long>(log_.session()), 
+             static_cast<unsigned long>(frames_.load(std::memory_order_relaxed)), 
+             static_cast<unsigned long>(dropped_frames_.load(std::memory_order_relaxed)), 
+             static_cast<unsigned long>(bytes_written_.load(std::memory_order_relaxed)));
+    return ESP_OK;
+}
+
+void Blackbox::record(const BlackboxFrame& frame) {
+    producer_busy_.store(true, std::memory_order_seq_cst);
+    if (!recording_.load(std::memory_order_seq_cst)) {
+        producer_busy_.store(false, std::memory_order_release);
+        return;
+    }
+    
+    bool stored = false;
+    if (fill_index_ >= 0 || acquireBuffer()) {
+        stored = encoder_.append(frame);
+        if (!stored) {
+            // ブロックが埋まった: 書き込みタスクへ渡して次のブロックへ
+            submitBuffer();
+            stored = acquireBuffer() && encoder_.append(frame);
+        }
+    }
+    
+    if (stored) {
+        frames_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        dropped_frames_.fetch_add(1, std::memory_order_relaxed);
+        pending_dropped_++;
+    }
+    producer_busy_.store(false, std::memory_order_release);
+}
+
+bool Blackbox::acquireBuffer() {
+    Buffer& buffer = buffers_[next_fill_];
+    if (buffer.state.load(std::memory_order_acquire) != BUFFER_FREE) {
+        return false;
+    }
+    buffer.state.store(BUFFER_FILLING, std::memory_order_relaxed);
+    fill_index_ = static_cast<int>(next_fill_);
+    next_fill_ = (next_fill_ + 1) % BUFFER_COUNT;
+    encoder_.begin(buffer.data + PartitionLog::HEADER_SIZE, PartitionLog::PAYLOAD_SIZE, sequence_++, pending_dropped_);
+    pending_dropped_ = 0;
+    return true;
+}
+
+void Blackbox::submitBuffer() {
+    // 同期時刻はブロック毎に1回だけ読む（シーケンスロック、待たない）
+    common::ClockModel clock;
+    const bool synced = common::SyncedClock::instance().snapshot(clock);
+    size_t payload = encoder_.finish(synced ? &clock : nullptr);
+    payload_bytes_.fetch_add(static_cast<uint32_t>(payload), std::memory_order_relaxed);
+    buffers_[fill_index_].state.store(BUFFER_READY, std::memory_order_release);
+    fill_index_ = -1;
+    xTaskNotifyGive(task_);
+}
+
+void Blackbox::writeReadyBuffers() {
+    while (true) {
+        Buffer& buffer = buffers_[next_write_];
+        if (buffer.state.load(std::memory_order_acquire) != BUFFER_READY) {
+            return;
+        }
+        
+        // レコードのペイロードはブロックヘッダ（スキーマ含む） + 符号化済みフレーム（未使用の末尾は書かない）
+        BlackboxBlockHeader header;
+        memcpy(&header, buffer.data + PartitionLog::HEADER_SIZE, sizeof(header));
+        size_t length = header.header_size + header.payload_size;
+        
+        esp_err_t ret = log_.append(buffer.data, length);
+        if (ret == ESP_ERR_NOT_ALLOWED) {
+            // 制御中（FlashGuard）に先行消去済みのセクタを使い切った: バッファは書き込み待ちのまま残し、
+            // 抑止の終了後に書く（以降のフレームはバッファ枯渇で欠落として数える）
+            return;
+        }
+        if (ret == ESP_OK) {
+            PartitionLog::Stats log_stats = log_.getStats();
+            blocks_written_.fetch_add(1, std::memory_order_relaxed);
+            bytes_written_.fetch_add(static_cast<uint32_t>(length), std::memory_order_relaxed);
+            last_write_us_.store(log_stats.last_write_us, std::memory_order_relaxed);
+            if (log_stats.last_write_us > max_write_us_.load(std::memory_order_relaxed)) {
+                max_write_us_.store(log_stats.last_write_us, std::memory_order_relaxed);
+            }
+        } else {
+            // 満杯等: 以降のフレームは記録しない（stop()でセッションを閉じる）
+            if (write_errors_.fetch_add(1, std::memory_order_relaxed) == 0) {
+                ESP_LOGE(TAG, "書き込み失敗 %s（記録停止）", esp_err_to_name(ret));
+            }
+            recording_.store(false, std::memory_order_relaxed);
+        }
+        
+        buffer.state.store(BUFFER_FREE, std::memory_order_release);
+        next_write_ = (next_write_ + 1) % BUFFER_COUNT;
+    }
+}
+
+void Blackbox::writerTask(void* arg) {
+    Blackbox* self = static_cast<Blackbox*>(arg);
+    while (true) {
+        // 先行消去が残っている間は待たずに進める（消去中に埋まったブロックは次の周回で書く）
+        ulTaskNotifyTake(pdTRUE, self->log_.needsErase() ? 0 : WRITER_POLL_TICKS);
+        self->writeReadyBuffers();
+        if (self->log_.needsErase() && self->log_.eraseAhead() != ESP_OK) {
+            // 上書きしない設定で満杯（記録中なら次のappend()が失敗して止まる）、または制御中
+            vTaskDelay(WRITER_POLL_TICKS);
+        }
+    }
+}
+
+Blackbox::Stats Blackbox::getStats() const {
+    Stats stats;
+    stats.frames = frames_.load(std::memory_order_relaxed);
+    stats.dropped_frames = dropped_frames_.load(std::memory_order_relaxed);
+    stats.blocks_written = blocks_written_.load(std::memory_order_relaxed);
+    stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    stats.payload_bytes = payload_bytes_.load(std::memory_order_relaxed);
+    stats.write_errors = write_errors_.load(std::memory_order_relaxed);
+    stats.last_write_us = last_write_us_.load(std::memory_order_relaxed);
+    stats.max_write_us = max_write_us_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Blackbox::dump() const {
+    Stats stats = getStats();
+    ESP_LOGI(TAG, "%s セッション %lu", isRecording() ? "記録中" : "停止中", static_cast<unsigned long>(log_.session()));
+    ESP_LOGI(TAG, "  フレーム %lu 欠落 %lu ブロック %lu（%lu バイト） 書き込み失敗 %lu", 
+             static_cast<unsigned long>(stats.frames), static_cast<unsigned long>(stats.dropped_frames), 
+             static_cast<unsigned long>(stats.blocks_written), static_cast<unsigned long>(stats.bytes_written), 
+             static_cast<unsigned long>(stats.write_errors));
+    if (stats.frames > 0 && stats.payload_bytes > 0) {
+        // 書き出し済みブロック分の概算
+        ESP_LOGI(TAG, "  平均 %.1f バイト/フレーム", static_cast<float>(stats.payload_bytes) / stats.frames);
+    }
+    ESP_LOGI(TAG, "  ブロック書き込み 前回 %luμs 最大 %luμs", 
+             static_cast<unsigned long>(stats.last_write_us), static_cast<unsigned long>(stats.max_write_us));
+    if (!common::FlashGuard::AUTO_SUSPEND) {
+        ESP_LOGI(TAG, "  飛行中の残り容量 %lu セクタ（約 %.0f 秒 @1kHz）", static_cast<unsigned long>(log_.erasedAhead()), 
+                 static_cast<double>(log_.erasedAhead()) * BLOCK_SIZE / FLIGHT_BYTES_PER_SECOND);
+    }
+    log_.dump();
+}
+
+} // namespace storage
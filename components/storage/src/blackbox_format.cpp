@@ -0,0 +1,331 @@
+/*
+ * Blackbox Format Implementation
+ * 
+ * フライトブラックボックスの符号化/復号実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "blackbox_format.hpp"
+#include <cstring>
+
+namespace storage {
+
+namespace {
+
+/**
+ * @brief フィールドの配列への展開（gyro, accel, setpoint, motor の順、マスクのビット番号と一致）
+ */
+inline void loadFields(const BlackboxFrame& frame, int16_t* fields) {
+    for (size_t i = 0; i < 3; i++) {
+        fields[i] = frame.gyro[i];
+        fields[3 + i] = frame.accel[i];
+    }
+    for (size_t i = 0; i < 4; i++) {
+        fields[6 + i] = frame.setpoint[i];
+        fields[10 + i] = frame.motor[i];
+    }
+}
+
+inline void storeFields(const int16_t* fields, BlackboxFrame& frame) {
+    for (size_t i = 0; i < 3; i++) {
+        frame.gyro[i] = fields[i];
+        frame.accel[i] = fields[3 + i];
+    }
+    for (size_t i = 0; i < 4; i++) {
+        frame.setpoint[i] = fields[6 + i];
+        frame.motor[i] = fields[10 + i];
+    }
+}
+
+inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+inline uint8_t* writeVarint(uint8_t* out, uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<uint8_t>(value);
+    return out;
+}
+
+/**
+ * @brief フィールドの予測値（history はブロック内の既出フレーム数、1フレーム分しかなければ PREVIOUS）
+ */
+inline int32_t predictField(uint8_t predictor, uint32_t history, int16_t previous, int16_t before) {
+    if (history == 0) {
+        return 0;
+    }
+    switch (static_cast<BlackboxPredictor>(predictor)) {
+    case BlackboxPredictor::ZERO:
+        return 0;
+    case BlackboxPredictor::LINEAR:
+        return history >= 2 ? 2 * static_cast<int32_t>(previous) - before : previous;
+    case BlackboxPredictor::AVERAGE_2:
+        // 算術右シフトで負の値も floor（ホスト側の復号器と一致させる）
+        return history >= 2 ? (static_cast<int32_t>(previous) + before) >> 1 : previous;
+    case BlackboxPredictor::PREVIOUS:
+    default:
+        return previous;
+    }
+}
+
+/**
+ * @brief 時刻の予測値（32bitで折り返す）
+ */
+inline uint32_t predictTime(uint8_t predictor, uint32_t history, uint32_t previous, uint32_t before) {
+    if (history == 0) {
+        return 0;
+    }
+    switch (static_cast<BlackboxPredictor>(predictor)) {
+    case BlackboxPredictor::ZERO:
+        return 0;
+    case BlackboxPredictor::LINEAR:
+        return history >= 2 ? 2 * previous - before : previous;
+    case BlackboxPredictor::AVERAGE_2:
+        return history >= 2 ? before + (previous - before) / 2 : previous;
+    case BlackboxPredictor::PREVIOUS:
+    default:
+        return previous;
+    }
+}
+
+} // namespace
+
+BlackboxEncoder::BlackboxEncoder()
+    : block_(nullptr)
+    , size_(0)
+    , position_(0)
+    , frame_count_(0)
+    , header_{}
+    , time_{}
+    , previous_{} {}
+
+void BlackboxEncoder::begin(uint8_t* block, size_t size, uint32_t sequence, uint32_t dropped_frames) {
+    block_ = block;
+    size_ = size;
+    frame_count_ = 0;
+    header_ = BlackboxBlockHeader{};
+    header_.magic = BlackboxBlockHeader::MAGIC;
+    header_.version = BlackboxBlockHeader::VERSION;
+    header_.header_size = sizeof(BlackboxBlockHeader);
+    header_.sequence = sequence;
+    header_.dropped_frames = dropped_frames;
+    if (sequence % BlackboxBlockHeader::SCHEMA_INTERVAL == 0) {
+        // セッション先頭（sequence 0）と以降 SCHEMA_INTERVAL 毎: 途中のブロックから読んでも列名・分解能がわかる
+        BlackboxSchemaHeader schema = {};
+        schema.field_count = static_cast<uint8_t>(BlackboxFrame::FIELD_COUNT);
+        schema.time_predictor = static_cast<uint8_t>(BlackboxSchema::TIME_PREDICTOR);
+        schema.field_size = static_cast<uint8_t>(sizeof(BlackboxFieldDef));
+        memcpy(block_ + sizeof(BlackboxBlockHeader), &schema, sizeof(schema));
+        memcpy(block_ + sizeof(BlackboxBlockHeader) + sizeof(schema), BlackboxSchema::FIELDS, 
+               sizeof(BlackboxSchema::FIELDS));
+        header_.flags |= BlackboxBlockHeader::SCHEMA_PRESENT;
+        header_.header_size = static_cast<uint16_t>(sizeof(BlackboxBlockHeader) + BlackboxSchema::SECTION_SIZE);
+    }
+    position_ = header_.header_size;
+    memset(time_, 0, sizeof(time_));
+    memset(previous_, 0, sizeof(previous_));
+}
+
+bool BlackboxEncoder::append(const BlackboxFrame& frame) {
+    if (block_ == nullptr || size_ - position_ < MAX_FRAME_BYTES) {
+        return false;
+    }
+    
+    int16_t fields[BlackboxFrame::FIELD_COUNT];
+    loadFields(frame, fields);
+    
+    const uint32_t time_prediction = predictTime(static_cast<uint8_t>(BlackboxSchema::TIME_PREDICTOR), frame_count_, 
+                                                 time_[0], time_[1]);
+    uint8_t* out = writeVarint(block_ + position_, zigzag(static_cast<int32_t>(frame.time_us - time_prediction)));
+    uint8_t* mask_position = out;
+    out += 2;
+    uint16_t mask = 0;
+    for (size_t i = 0; i < BlackboxFrame::FIELD_COUNT; i++) {
+        int32_t residual = fields[i] - predictField(BlackboxSchema::FIELDS[i].predictor, frame_count_, 
+                                                    previous_[0][i], previous_[1][i]);
+        if (residual != 0) {
+            mask |= static_cast<uint16_t>(1u << i);
+            out = writeVarint(out, zigzag(residual));
+        }
+        previous_[1][i] = previous_[0][i];
+        previous_[0][i] = fields[i];
+    }
+    mask_position[0] = static_cast<uint8_t>(mask);
+    mask_position[1] = static_cast<uint8_t>(mask >> 8);
+    
+    if (frame_count_ == 0) {
+        header_.first_time_us = frame.time_us;
+    }
+    header_.last_time_us = frame.time_us;
+    time_[1] = time_[0];
+    time_[0] = frame.time_us;
+    position_ = static_cast<size_t>(out - block_);
+    frame_count_++;
+    return true;
+}
+
+size_t BlackboxEncoder::finish(const common::ClockModel* clock) {
+    if (block_ == nullptr) {
+        return 0;
+    }
+    if (clock != nullptr && clock->valid && frame_count_ > 0) {
+        // 先頭フレームの時刻の上位ビットはモデルの基準時刻から補う
+        const int64_t first_us = clock->reference_us + 
+            static_cast<int32_t>(header_.first_time_us - static_cast<uint32_t>(clock->reference_us));
+        header_.flags |= BlackboxBlockHeader::SYNC_VALID;
+        header_.sync_drift_ppb = clock->drift_ppb;
+        header_.synced_first_time_us = clock->toSynced(first_us);
+    }
+    header_.frame_count = frame_count_;
+    header_.payload_size = static_cast<uint32_t>(position_ - header_.header_size);
+    memcpy(block_, &header_, sizeof(header_));
+    memset(block_ + position_, 0, size_ - position_);
+    return header_.payload_size;
+}
+
+BlackboxDecoder::BlackboxDecoder()
+    : payload_(nullptr)
+    , payload_size_(0)
+    , position_(0)
+    , frame_index_(0)
+    , header_{}
+    , fields_{}
+    , time_predictor_(static_cast<uint8_t>(BlackboxSchema::TIME_PREDICTOR))
+    , time_{}
+    , previous_{} {
+    memcpy(fields_, BlackboxSchema::FIELDS, sizeof(fields_));
+}
+
+bool BlackboxDecoder::begin(const uint8_t* block, size_t size) {
+    payload_ = nullptr;
+    if (block == nullptr || size < BlackboxBlockHeader::VERSION_1_SIZE) {
+        return false;
+    }
+    // 版1のヘッダは同期時刻のフィールドを0として読む
+    header_ = BlackboxBlockHeader{};
+    memcpy(&header_, block, BlackboxBlockHeader::VERSION_1_SIZE);
+    if (header_.magic != BlackboxBlockHeader::MAGIC || header_.version < 1 || header_.version > BlackboxBlockHeader::VERSION
+        || header_.header_size < BlackboxBlockHeader::VERSION_1_SIZE || header_.header_size + header_.payload_size > size) {
+        return false;
+    }
+    if (header_.version >= 2) {
+        if (header_.header_size < sizeof(BlackboxBlockHeader)) {
+            return false;
+        }
+        memcpy(&header_, block, sizeof(header_));
+    }
+    if (header_.version >= 3 && (header_.flags & BlackboxBlockHeader::SCHEMA_PRESENT) && !readSchema(block)) {
+        return false;
+    }
+    payload_ = block + header_.header_size;
+    payload_size_ = header_.payload_size;
+    position_ = 0;
+    frame_index_ = 0;
+    memset(time_, 0, sizeof(time_));
+    memset(previous_, 0, sizeof(previous_));
+    return true;
+}
+
+bool BlackboxDecoder::readSchema(const uint8_t* block) {
+    BlackboxSchemaHeader schema;
+    if (header_.header_size < sizeof(BlackboxBlockHeader) + sizeof(schema)) {
+        return false;
+    }
+    memcpy(&schema, block + sizeof(BlackboxBlockHeader), sizeof(schema));
+    if (schema.field_count != BlackboxFrame::FIELD_COUNT || schema.field_size != sizeof(BlackboxFieldDef)
+        || header_.header_size < sizeof(BlackboxBlockHeader) + BlackboxSchema::SECTION_SIZE
+        || schema.time_predictor > static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2)) {
+        return false;
+    }
+    BlackboxFieldDef fields[BlackboxFrame::FIELD_COUNT];
+    memcpy(fields, block + sizeof(BlackboxBlockHeader) + sizeof(schema), sizeof(fields));
+    for (const BlackboxFieldDef& field : fields) {
+        if (field.predictor > static_cast<uint8_t>(BlackboxPredictor::AVERAGE_2)) {
+            return false;
+        }
+    }
+    memcpy(fields_, fields, sizeof(fields_));
+    for (BlackboxFieldDef& field : fields_) {
+        field.name[sizeof(field.name) - 1] = '\0';
+    }
+    time_predictor_ = schema.time_predictor;
+    return true;
+}
+
+int64_t BlackboxDecoder::syncedTime(uint32_t time_us) const {
+    if ((header_.flags & BlackboxBlockHeader::SYNC_VALID) == 0) {
+        return time_us;
+    }
+    const int64_t elapsed = static_cast<uint32_t>(time_us - header_.first_time_us);
+    return header_.synced_first_time_us + elapsed + elapsed * header_.sync_drift_ppb / 1000000000;
+}
+
+bool BlackboxDecoder::readVarint(uint32_t& value) {
+    value = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        if (position_ >= payload_size_) {
+            return false;
+        }
+        uint8_t byte = payload_[position_++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BlackboxDecoder::next(BlackboxFrame& frame) {
+    if (payload_ == nullptr || frame_index_ >= header_.frame_count) {
+        return false;
+    }
+    
+    // 版1・2: 時刻は前フレームからの符号なし差分、フィールドは全て PREVIOUS
+    const bool legacy = header_.version < 3;
+    uint32_t time_code;
+    if (!readVarint(time_code) || payload_size_ - position_ < 2) {
+        return false;
+    }
+    uint16_t mask = static_cast<uint16_t>(payload_[position_] | (payload_[position_ + 1] << 8));
+    position_ += 2;
+    int16_t fields[BlackboxFrame::FIELD_COUNT];
+    for (size_t i = 0; i < BlackboxFrame::FIELD_COUNT; i++) {
+        const uint8_t predictor = legacy ? static_cast<uint8_t>(BlackboxPredictor::PREVIOUS) : fields_[i].predictor;
+        int32_t value = predictField(predictor, frame_index_, previous_[0][i], previous_[1][i]);
+        if (mask & (1u << i)) {
+            uint32_t encoded;
+            if (!readVarint(encoded)) {
+                return false;
+            }
+            value += unzigzag(encoded);
+        }
+        fields[i] = static_cast<int16_t>(value);
+        previous_[1][i] = previous_[0][i];
+        previous_[0][i] = fields[i];
+    }
+    
+    if (legacy) {
+        frame.time_us = time_[0] + time_code;
+    } else {
+        frame.time_us = predictTime(time_predictor_, frame_index_, time_[0], time_[1]) + 
+            static_cast<uint32_t>(unzigzag(time_code));
+    }
+    time_[1] = time_[0];
+    time_[0] = frame.time_us;
+    storeFields(fields, frame);
+    frame_index_++;
+    return true;
+}
+
+} // namespace storage
@@ -0,0 +1,178 @@
+/*
+ * Mapped Log Implementation
+ * 
+ * メモリマップした追記ログの読み出し・ブラックボックス集計実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "mapped_log.hpp"
+#include "blackbox_format.hpp"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include <cmath>
+
+namespace storage {
+
+static const char* TAG = "storage::MappedLog";
+
+// 振動を取り出すローパスの係数（1kHz記録で約5Hz）
+static constexpr float VIBRATION_LOWPASS_ALPHA = 0.03f;
+
+MappedLogReader::MappedLogReader(const PartitionMap& map)
+    : map_(map)
+    , sector_count_(static_cast<uint32_t>(map.size() / PartitionLog::SECTOR_SIZE))
+    , first_sector_(0)
+    , position_(0)
+    , latest_session_(0)
+    , skipped_(0) {}
+
+const PartitionLogHeader* MappedLogReader::header(uint32_t sector) const {
+    const PartitionLogHeader* header = map_.at<PartitionLogHeader>(sector * PartitionLog::SECTOR_SIZE);
+    if (header == nullptr || !PartitionLog::validHeader(*header)) {
+        return nullptr;
+    }
+    return header;
+}
+
+uint32_t MappedLogReader::rewind() {
+    uint32_t valid = 0;
+    uint32_t newest_sequence = 0;
+    first_sector_ = 0;
+    position_ = 0;
+    latest_session_ = 0;
+    skipped_ = 0;
+    
+    // 最新レコードの次のセクタが最古側（PartitionLog::recover()と同じ考え方）
+    for (uint32_t sector = 0; sector < sector_count_; sector++) {
+        const PartitionLogHeader* record = header(sector);
+        if (record == nullptr) {
+            continue;
+        }
+        if (valid == 0 || record->sequence > newest_sequence) {
+            newest_sequence = record->sequence;
+            first_sector_ = (sector + 1) % sector_count_;
+            latest_session_ = record->session;
+        }
+        valid++;
+    }
+    return valid;
+}
+
+bool MappedLogReader::next(Record& record, uint32_t session) {
+    while (position_ < sector_count_) {
+        uint32_t sector = (first_sector_ + position_) % sector_count_;
+        position_++;
+        const PartitionLogHeader* found = header(sector);
+        if (found == nullptr || (session != 0 && found->session != session)) {
+            continue;
+        }
+        const uint8_t* payload = map_.data() + sector * PartitionLog::SECTOR_SIZE + PartitionLog::HEADER_SIZE;
+        if (esp_rom_crc32_le(0, payload, found->payload_size) != found->payload_crc) {
+            skipped_++;
+            continue;
+        }
+        record.header = found;
+        record.payload = payload;
+        record.sector = sector;
+        return true;
+    }
+    return false;
+}
+
+esp_err_t summarizeBlackbox(MappedLogReader& reader, uint32_t session, BlackboxSummary& summary) {
+    summary = BlackboxSummary{};
+    if (reader.rewind() == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    summary.session = session != 0 ? session : reader.latestSession();
+    
+    float lowpass[3] = {};
+    double square_sum[3] = {};
+    double motor_sum[4] = {};
+    uint32_t first_time_us = 0;
+    uint32_t last_time_us = 0;
+    
+    MappedLogReader::Record record;
+    BlackboxDecoder decoder;
+    while (reader.next(record, summary.session)) {
+        if (!decoder.begin(record.payload, record.header->payload_size)) {
+            summary.corrupt_blocks++;
+            continue;
+        }
+        if (summary.blocks == 0) {
+            first_time_us = decoder.header().first_time_us;
+        }
+        summary.blocks++;
+        summary.dropped_frames += decoder.header().dropped_frames;
+        
+        BlackboxFrame frame;
+        uint32_t decoded = 0;
+        while (decoder.next(frame)) {
+            decoded++;
+            for (int axis = 0; axis < 3; axis++) {
+                float gyro = std::fabs(frame.gyro[axis] * BlackboxFrame::GYRO_LSB);
+                if (gyro > summary.max_gyro[axis]) {
+                    summary.max_gyro[axis] = gyro;
+                }
+                float accel = frame.accel[axis] * BlackboxFrame::ACCEL_LSB;
+                if (summary.frames == 0) {
+                    lowpass[axis] = accel;
+                }
+                lowpass[axis] += VIBRATION_LOWPASS_ALPHA * (accel - lowpass[axis]);
+                float vibration = accel - lowpass[axis];
+                square_sum[axis] += vibration * vibration;
+                if (std::fabs(vibration) > summary.accel_peak[axis]) {
+                    summary.accel_peak[axis] = std::fabs(vibration);
+                }
+            }
+            for (int i = 0; i < 4; i++) {
+                float motor = frame.motor[i] * BlackboxFrame::MOTOR_LSB;
+                if (motor > summary.max_motor[i]) {
+                    summary.max_motor[i] = motor;
+                }
+                motor_sum[i] += motor;
+            }
+            last_time_us = frame.time_us;
+            summary.frames++;
+        }
+        if (decoded != decoder.header().frame_count) {
+            summary.corrupt_blocks++;
+        }
+    }
+    summary.corrupt_blocks += reader.skipped();
+    
+    if (summary.blocks == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    summary.duration_ms = (last_time_us - first_time_us) / 1000;
+    if (summary.frames > 0) {
+        for (int axis = 0; axis < 3; axis++) {
+            summary.accel_rms[axis] = static_cast<float>(std::sqrt(square_sum[axis] / summary.frames));
+        }
+        for (int i = 0; i < 4; i++) {
+            summary.mean_motor[i] = static_cast<float>(motor_sum[i] / summary.frames);
+        }
+    }
+    return ESP_OK;
+}
+
+void dumpBlackboxSummary(const BlackboxSummary& summary) {
+    ESP_LOGI(TAG, "セッション %lu ブロック %lu フレーム %lu（欠落 %lu 破損ブロック %lu） %.1fs", 
+             static_cast<unsigned long>(summary.session), static_cast<unsigned long>(summary.blocks), 
+             static_cast<unsigned long>(summary.frames), static_cast<unsigned long>(summary.dropped_frames), 
+             static_cast<unsigned long>(summary.corrupt_blocks), summary.duration_ms / 1000.0f);
+    ESP_LOGI(TAG, "  角速度 最大 X %.2f Y %.2f Z %.2f rad/s", 
+             summary.max_gyro[0], summary.max_gyro[1], summary.max_gyro[2]);
+    ESP_LOGI(TAG, "  振動 実効値 X %.2f Y %.2f Z %.2f 最大 X %.2f Y %.2f Z %.2f m/s^2", 
+             summary.accel_rms[0], summary.accel_rms[1], summary.accel_rms[2], 
+             summary.accel_peak[0], summary.accel_peak[1], summary.accel_peak[2]);
+    ESP_LOGI(TAG, "  モーター 最大 %.3f %.3f %.3f %.3f 平均 %.3f %.3f %.3f %.3f", 
+             summary.max_motor[0], summary.max_motor[1], summary.max_motor[2], summary.max_motor[3], 
+             summary.mean_motor[0], summary.mean_motor[1], summary.mean_motor[2], summary.mean_motor[3]);
+}
+
+} // namespace storage
@@ -0,0 +1,169 @@
+/*
+ * NVS Map Reader Implementation
+ * 
+ * NVSパーティションのその場読み出し実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "nvs_map_reader.hpp"
+#include "esp_rom_crc.h"
+#include <cstddef>
+#include <cstring>
+
+namespace storage {
+
+// ページヘッダ（状態・通し番号）とエントリ状態ビットマップの配置
+static constexpr size_t PAGE_STATE_OFFSET = 0;
+static constexpr size_t PAGE_SEQUENCE_OFFSET = 4;
+static constexpr size_t PAGE_BITMAP_OFFSET = 32;
+static constexpr size_t PAGE_ENTRY_OFFSET = 64;
+
+// ページ状態（読めるのは使用中・満杯・整理中のページ）
+static constexpr uint32_t PAGE_ACTIVE = 0xFFFFFFFE;
+static constexpr uint32_t PAGE_FULL = 0xFFFFFFFC;
+static constexpr uint32_t PAGE_FREEING = 0xFFFFFFF8;
+
+// エントリ状態（2bit）
+static constexpr uint8_t ENTRY_WRITTEN = 0x2;
+
+// データ型（nvs::ItemType）
+static constexpr uint8_t TYPE_U8 = 0x01;
+static constexpr uint8_t TYPE_U32 = 0x04;
+static constexpr uint8_t TYPE_I32 = 0x14;
+static constexpr uint8_t TYPE_BLOB_DATA = 0x42;
+static constexpr uint8_t TYPE_BLOB_INDEX = 0x48;
+
+// 名前空間の定義エントリの名前空間番号
+static constexpr uint8_t NAMESPACE_INDEX = 0;
+
+static uint32_t readU32(const uint8_t* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+NvsMapReader::NvsMapReader(const PartitionMap& map)
+    : map_(map)
+    , page_count_(static_cast<uint32_t>(map.size() / PAGE_SIZE)) {}
+
+esp_err_t NvsMapReader::getU32(const char* name_space, const char* key, uint32_t& value) const {
+    return getPrimitive(name_space, key, TYPE_U32, &value, sizeof(value));
+}
+
+esp_err_t NvsMapReader::getI32(const char* name_space, const char* key, int32_t& value) const {
+    return getPrimitive(name_space, key, TYPE_I32, &value, sizeof(value));
+}
+
+esp_err_t NvsMapReader::getPrimitive(const char* name_space, const char* key, uint8_t type, void* value, size_t size) const {
+    uint8_t ns_index;
+    esp_err_t ret = findNamespace(name_space, ns_index);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    const Item* item = findItem(ns_index, type, key, CHUNK_ANY);
+    if (item == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    memcpy(value, item->data, size);
+    return ESP_OK;
+}
+
+esp_err_t NvsMapReader::getBlob(const char* name_space, const char* key, const uint8_t*& data, size_t& size) const {
+    uint8_t ns_index;
+    esp_err_t ret = findNamespace(name_space, ns_index);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // 索引エントリ: data = 全体のバイト数（32bit）, チャンク数, 先頭のチャンク番号
+    const Item* index = findItem(ns_index, TYPE_BLOB_INDEX, key, CHUNK_ANY);
+    if (index == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    uint32_t total_size = readU32(index->data);
+    uint8_t chunk_count = index->data[4];
+    uint8_t chunk_start = index->data[5];
+    if (chunk_count != 1) {
+        return chunk_count == 0 ? ESP_ERR_NOT_FOUND : ESP_ERR_NOT_SUPPORTED;
+    }
+    
+    // データエントリ: data = バイト数（16bit）, 予約, データのCRC32。データは続くエントリに連続して置かれる
+    const Item* chunk = findItem(ns_index, TYPE_BLOB_DATA, key, chunk_start);
+    if (chunk == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    uint16_t chunk_size = static_cast<uint16_t>(chunk->data[0] | (chunk->data[1] << 8));
+    if (chunk_size != total_size || chunk_size > (chunk->span - 1u) * ENTRY_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(chunk + 1);
+    if (esp_rom_crc32_le(0xFFFFFFFF, bytes, chunk_size) != readU32(chunk->data + 4)) {
+        return ESP_ERR_INVALID_CRC;
+    }
+    data = bytes;
+    size = chunk_size;
+    return ESP_OK;
+}
+
+esp_err_t NvsMapReader::findNamespace(const char* name_space, uint8_t& index) const {
+    const Item* item = findItem(NAMESPACE_INDEX, TYPE_U8, name_space, CHUNK_ANY);
+    if (item == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    index = item->data[0];
+    return ESP_OK;
+}
+
+const NvsMapReader::Item* NvsMapReader::findItem(uint8_t ns_index, uint8_t type, const char* key, uint8_t chunk_index) const {
+    const Item* found = nullptr;
+    uint32_t found_sequence = 0;
+    
+    for (uint32_t page = 0; page < page_count_; page++) {
+        const uint8_t* base = map_.at<uint8_t>(page * PAGE_SIZE, PAGE_SIZE);
+        if (base == nullptr) {
+            break;
+        }
+        uint32_t state = readU32(base + PAGE_STATE_OFFSET);
+        if (state != PAGE_ACTIVE && state != PAGE_FULL && state != PAGE_FREEING) {
+            continue;
+        }
+        uint32_t sequence = readU32(base + PAGE_SEQUENCE_OFFSET);
+        if (found != nullptr && sequence < found_sequence) {
+            continue;
+        }
+        
+        const uint8_t* bitmap = base + PAGE_BITMAP_OFFSET;
+        const Item* entries = reinterpret_cast<const Item*>(base + PAGE_ENTRY_OFFSET);
+        size_t i = 0;
+        while (i < ENTRY_COUNT) {
+            uint8_t entry_state = (bitmap[i / 4] >> ((i % 4) * 2)) & 0x3;
+            const Item& item = entries[i];
+            // 書き込み途中・消去済みのエントリは長さを信用できないので1つずつ進む
+            if (entry_state != ENTRY_WRITTEN || item.crc != itemCrc(item) || item.span == 0) {
+                i++;
+                continue;
+            }
+            if (item.ns_index == ns_index && item.type == type && item.chunk_index == chunk_index
+                && strncmp(item.key, key, KEY_SIZE) == 0 && i + item.span <= ENTRY_COUNT) {
+                found = &item;
+                found_sequence = sequence;
+            }
+            i += item.span;
+        }
+    }
+    return found;
+}
+
+uint32_t NvsMapReader::itemCrc(const Item& item) {
+    // nvs::Item::calculateCrc32()と同じ範囲（CRCフィールドを除く）
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&item);
+    uint32_t crc = esp_rom_crc32_le(0xFFFFFFFF, bytes, offsetof(Item, crc));
+    crc = esp_rom_crc32_le(crc, bytes + offsetof(Item, key), KEY_SIZE);
+    return esp_rom_crc32_le(crc, bytes + offsetof(Item, data), sizeof(item.data));
+}
+
+} // namespace storage
@@ -0,0 +1,295 @@
+/*
+ * Partition Log Implementation
+ * 
+ * 生パーティション上の追記型ログ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "partition_log.hpp"
+#include "flash_guard.hpp"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include <cstddef>
+#include <cstring>
+
+namespace storage {
+
+static const char* TAG = "storage::PartitionLog";
+
+static_assert(sizeof(PartitionLogHeader) == 32, "ヘッダは32バイト");
+static_assert(PartitionLog::SECTOR_SIZE % 16 == 0, "書き込みは16バイト単位（フラッシュ暗号化時）");
+
+PartitionLog::PartitionLog()
+    : partition_(nullptr)
+    , sector_count_(0)
+    , write_sector_(0)
+    , erased_ahead_(0)
+    , next_sequence_(0)
+    , session_(0)
+    , stats_{} {}
+
+esp_err_t PartitionLog::open(const Config& config) {
+    config_ = config;
+    partition_ = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, config_.partition_label);
+    if (partition_ == nullptr) {
+        ESP_LOGE(TAG, "パーティションなし %s", config_.partition_label);
+        return ESP_ERR_NOT_FOUND;
+    }
+    sector_count_ = static_cast<uint32_t>(partition_->size / SECTOR_SIZE);
+    if (sector_count_ < config_.erase_ahead + 2) {
+        partition_ = nullptr;
+        return ESP_ERR_INVALID_SIZE;
+    }
+    stats_ = Stats{};
+    recover();
+    return ESP_OK;
+}
+
+void PartitionLog::recover() {
+    int64_t start_us = esp_timer_get_time();
+    bool found = false;
+    uint32_t newest_sector = 0;
+    PartitionLogHeader newest{};
+    
+    for (uint32_t sector = 0; sector < sector_count_; sector++) {
+        PartitionLogHeader header;
+        if (esp_partition_read(partition_, sector * SECTOR_SIZE, &header, sizeof(header)) != ESP_OK
+            || !validHeader(header)) {
+            continue;
+        }
+        stats_.recovered++;
+        if (!found || header.sequence > newest.sequence) {
+            newest = header;
+            newest_sector = sector;
+            found = true;
+        }
+    }
+    
+    if (found) {
+        // 最新のレコードだけは書き込み途中の電源断があり得るのでペイロードまで確認する
+        PartitionLogHeader header;
+        if (readSector(newest_sector, header, nullptr) == ESP_ERR_INVALID_CRC) {
+            stats_.torn++;
+        }
+        write_sector_.store((newest_sector + 1) % sector_count_, std::memory_order_release);
+        next_sequence_ = newest.sequence + 1;
+        session_.store(newest.session, std::memory_order_relaxed);
+    } else {
+        write_sector_.store(0, std::memory_order_release);
+        next_sequence_ = 0;
+        session_.store(0, std::memory_order_relaxed);
+    }
+    // 書き込み位置より先が消去済みかは分からないため、先行消去をやり直す
+    erased_ahead_ = 0;
+    
+    ESP_LOGI(TAG, "復元 %s: レコード %lu 途切れ %lu 書き込み位置 %lu/%lu（%lldms）", config_.partition_label,  
+             static_cast<unsigned long>(stats_.recovered), static_cast<unsigned long>(stats_.torn),  
+             static_cast<unsigned long>(write_sector_.load(std::memory_order_relaxed)),  
+             static_cast<unsigned long>(sector_count_),  
+             static_cast<long long>((esp_timer_get_time() - start_us) / 1000));
+}
+
+uint32_t PartitionLog::beginSession() {
+    return session_.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+esp_err_t PartitionLog::append(uint8_t* sector, size_t payload_size) {
+    if (partition_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (payload_size > PAYLOAD_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    // 消去済みセクタへの書き込みは設定により制御中も許す（書き込み前の消去は eraseAhead() で抑止に従う）
+    common::FlashGuard::Scope guard(common::FlashGuard::instance(), config_.realtime_append && erased_ahead_ > 0);
+    if (!guard.allowed()) {
+        stats_.blocked++;
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    if (erased_ahead_ == 0) {
+        // 先行消去が間に合っていない（書き込みが待たされる）
+        stats_.stalls++;
+        esp_err_t ret = eraseAhead();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    
+    PartitionLogHeader header = {};
+    header.magic = PartitionLogHeader::MAGIC;
+    header.sequence = next_sequence_;
+    header.session = session_.load(std::memory_order_relaxed);
+    header.payload_size = static_cast<uint32_t>(payload_size);
+    header.payload_crc = esp_rom_crc32_le(0, sector + HEADER_SIZE, static_cast<uint32_t>(payload_size));
+    header.header_crc = headerCrc(header);
+    memcpy(sector, &header, sizeof(header));
+    
+    // 使っていない末尾は消去状態のまま残す（書き込み量を減らす）
+    size_t length = (HEADER_SIZE + payload_size + 15) & ~static_cast<size_t>(15);
+    uint32_t target = write_sector_.load(std::memory_order_relaxed);
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = esp_partition_write(partition_, target * SECTOR_SIZE, sector, length);
+    uint32_t elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    stats_.last_write_us = elapsed_us;
+    if (elapsed_us > stats_.max_write_us) {
+        stats_.max_write_us = elapsed_us;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "書き込み失敗 セクタ %lu: %s", static_cast<unsigned long>(target), esp_err_to_name(ret));
+        return ret;
+    }
+    
+    next_sequence_++;
+    erased_ahead_--;
+    write_sector_.store((target + 1) % sector_count_, std::memory_order_release);
+    stats_.appended++;
+    return ESP_OK;
+}
+
+esp_err_t PartitionLog::eraseAhead() {
+    if (partition_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (erased_ahead_ >= sector_count_ - 1) {
+        return ESP_OK;
+    }
+    common::FlashGuard::Scope guard(common::FlashGuard::instance());
+    if (!guard.allowed()) {
+        stats_.blocked++;
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    uint32_t target = (write_sector_.load(std::memory_order_relaxed) + erased_ahead_) % sector_count_;
+    
+    PartitionLogHeader header;
+    bool occupied = esp_partition_read(partition_, target * SECTOR_SIZE, &header, sizeof(header)) == ESP_OK
+                    && validHeader(header);
+    if (occupied && !config_.overwrite_oldest) {
+        return ESP_ERR_NO_MEM;
+    }
+    
+    int64_t start_us = esp_timer_get_time();
+    esp_err_t ret = esp_partition_erase_range(partition_, target * SECTOR_SIZE, SECTOR_SIZE);
+    uint32_t elapsed_us = static_cast<uint32_t>(esp_timer_get_time() - start_us);
+    if (elapsed_us > stats_.max_erase_us) {
+        stats_.max_erase_us = elapsed_us;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "消去失敗 セクタ %lu: %s", static_cast<unsigned long>(target), esp_err_to_name(ret));
+        return ret;
+    }
+    if (occupied) {
+        stats_.overwritten++;
+    }
+    stats_.erased++;
+    erased_ahead_++;
+    return ESP_OK;
+}
+
+esp_err_t PartitionLog::eraseAll() {
+    if (partition_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    common::FlashGuard::Scope guard(common::FlashGuard::instance());
+    if (!guard.allowed()) {
+        stats_.blocked++;
+        return ESP_ERR_NOT_ALLOWED;
+    }
+    esp_err_t ret = esp_partition_erase_range(partition_, 0, sector_count_ * SECTOR_SIZE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    write_sector_.store(0, std::memory_order_release);
+    erased_ahead_ = sector_count_ - 1;
+    next_sequence_ = 0;
+    session_.store(0, std::memory_order_relaxed);
+    return ESP_OK;
+}
+
+esp_err_t PartitionLog::readSector(uint32_t sector, PartitionLogHeader& header, uint8_t* payload) const {
+    if (partition_ == nullptr || sector >= sector_count_) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    size_t offset = sector * SECTOR_SIZE;
+    esp_err_t ret = esp_partition_read(partition_, offset, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    if (!validHeader(header)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    
+    // ペイロードの格納先がない場合はチャンク毎に読んでCRCのみ確認する
+    uint32_t crc = 0;
+    if (payload != nullptr) {
+        ret = esp_partition_read(partition_, offset + HEADER_SIZE, payload, header.payload_size);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        crc = esp_rom_crc32_le(0, payload, header.payload_size);
+    } else {
+        uint8_t chunk[256];
+        for (uint32_t done = 0; done < header.payload_size; done += sizeof(chunk)) {
+            uint32_t length = header.payload_size - done < sizeof(chunk) ? header.payload_size - done : sizeof(chunk);
+            ret = esp_partition_read(partition_, offset + HEADER_SIZE + done, chunk, length);
+            if (ret != ESP_OK) {
+                return ret;
+            }
+            crc = esp_rom_crc32_le(crc, chunk, length);
+        }
+    }
+    return crc == header.payload_crc ? ESP_OK : ESP_ERR_INVALID_CRC;
+}
+
+esp_err_t PartitionLog::readHeader(uint32_t sector, PartitionLogHeader& header) const {
+    if (partition_ == nullptr || sector >= sector_count_) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = esp_partition_read(partition_, sector * SECTOR_SIZE, &header, sizeof(header));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return validHeader(header) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t PartitionLog::read(uint32_t sector, size_t offset, void* buffer, size_t length) const {
+    if (partition_ == nullptr || sector >= sector_count_ || offset + length > SECTOR_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return esp_partition_read(partition_, sector * SECTOR_SIZE + offset, buffer, length);
+}
+
+bool PartitionLog::validHeader(const PartitionLogHeader& header) {
+    return header.magic == PartitionLogHeader::MAGIC && header.payload_size <= PAYLOAD_SIZE
+           && header.header_crc == headerCrc(header);
+}
+
+uint32_t PartitionLog::headerCrc(const PartitionLogHeader& header) {
+    return esp_rom_crc32_le(0, reinterpret_cast<const uint8_t*>(&header), offsetof(PartitionLogHeader, header_crc));
+}
+
+void PartitionLog::dump() const {
+    if (partition_ == nullptr) {
+        ESP_LOGI(TAG, "未初期化");
+        return;
+    }
+    // 統計は書き込みタスクが更新する（表示用）
+    Stats stats = stats_;
+    ESP_LOGI(TAG, "%s %luセクタ 書き込み位置 %lu 先行消去 %lu/%lu セッション %lu 通し番号 %lu", config_.partition_label,  
+             static_cast<unsigned long>(sector_count_), static_cast<unsigned long>(writeSector()),  
+             static_cast<unsigned long>(erased_ahead_), static_cast<unsigned long>(config_.erase_ahead),  
+             static_cast<unsigned long>(session()), static_cast<unsigned long>(next_sequence_));
+    ESP_LOGI(TAG, "  書き込み %lu 消去 %lu 上書き %lu 消去待ち %lu 起動時 有効 %lu 途切れ %lu",  
+             static_cast<unsigned long>(stats.appended), static_cast<unsigned long>(stats.erased),  
+             static_cast<unsigned long>(stats.overwritten), static_cast<unsigned long>(stats.stalls),  
+             static_cast<unsigned long>(stats.recovered), static_cast<unsigned long>(stats.torn));
+    ESP_LOGI(TAG, "  書き込み 前回 %luμs 最大 %luμs 消去 最大 %luμs 制御中で保留 %lu",  
+             static_cast<unsigned long>(stats.last_write_us), static_cast<unsigned long>(stats.max_write_us),  
+             static_cast<unsigned long>(stats.max_erase_us), static_cast<unsigned long>(stats.blocked));
+}
+
+} // namespace storage
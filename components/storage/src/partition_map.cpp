@@ -0,0 +1,64 @@
+/*
+ * Partition Map Implementation
+ * 
+ * パーティションのメモリマップ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "partition_map.hpp"
+#include "esp_log.h"
+
+namespace storage {
+
+static const char* TAG = "storage::PartitionMap";
+
+PartitionMap::PartitionMap()
+    : partition_(nullptr)
+    , handle_(0)
+    , data_(nullptr)
+    , size_(0) {}
+
+PartitionMap::~PartitionMap() {
+    unmap();
+}
+
+esp_err_t PartitionMap::map(const char* label, size_t offset, size_t size) {
+    unmap();
+    const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    if (partition == nullptr) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    if (offset >= partition->size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (size == 0 || size > partition->size - offset) {
+        size = partition->size - offset;
+    }
+    
+    const void* pointer = nullptr;
+    esp_err_t ret = esp_partition_mmap(partition, offset, size, ESP_PARTITION_MMAP_DATA, &pointer, &handle_);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "割り当て失敗 %s +0x%x %u バイト: %s", label, static_cast<unsigned>(offset), 
+                 static_cast<unsigned>(size), esp_err_to_name(ret));
+        return ret;
+    }
+    partition_ = partition;
+    data_ = static_cast<const uint8_t*>(pointer);
+    size_ = size;
+    return ESP_OK;
+}
+
+void PartitionMap::unmap() {
+    if (data_ != nullptr) {
+        esp_partition_munmap(handle_);
+        data_ = nullptr;
+        size_ = 0;
+        partition_ = nullptr;
+    }
+}
+
+} // namespace storage
@@ -37,6 +37,7 @@ extern "C" {
 #define STAMPFLY_VERSION_STRING  "1.0.0"
 
 // システム設定
+// 各タスクのコア・優先度は runtime::TaskTopology の既定の配置（0番）と同じ値。配置はパラメータ task_layout で切り替える
 #define MAIN_TASK_PRIORITY           (configMAX_PRIORITIES - 1)
 #define MAIN_TASK_STACK_SIZE         (8192)
 #define MAIN_TASK_CORE_ID           (1)
@@ -0,0 +1,177 @@
+/*
+ * Flight Loop
+ * 
+ * ファームウェアの推定・制御コンポーネントを実機と同じ周期で動かす閉ループ（ホストシミュレーション用）
+ * IMU（1600Hz）→ QuaternionEstimator・ErrorStateEkf → CascadedPid<3>（400Hz）→ Mixer → 機体モデル
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef FLIGHT_LOOP_HPP
+#define FLIGHT_LOOP_HPP
+
+#include "attitude_estimator.hpp"
+#include "cascaded_pid.hpp"
+#include "delayed_state_buffer.hpp"
+#include "error_state_ekf.hpp"
+#include "measurement_aligner.hpp"
+#include "mixer.hpp"
+#include "quad_model.hpp"
+#include "sensor_model.hpp"
+#include <cstdint>
+#include <deque>
+
+namespace sim {
+
+using QuadXMixer = control::Mixer<control::QuadXFrame>;
+
+/**
+ * @brief 目標値構造体
+ */
+struct Setpoint {
+    float roll = 0.0f;          // 目標ロール（rad）
+    float pitch = 0.0f;         // 目標ピッチ（rad）
+    float yaw = 0.0f;           // 目標ヨー（rad）
+    float altitude = 0.5f;      // 目標高度（m）
+};
+
+/**
+ * @brief 1制御周期の記録構造体（評価・CSV出力用）
+ */
+struct LoopRecord {
+    double time;                // 時刻（s）
+    float target[3];            // 目標角度（rad）
+    float angle[3];             // 真の角度（rad）
+    float estimate[3];          // 推定角度（rad）
+    float rate[3];              // 真の角速度（rad/s）
+    float altitude;             // 真の高度（m）
+    float altitude_estimate;    // 推定高度（m、EKF）
+    float altitude_target;      // 目標高度（m）
+    float position_error;       // 水平位置の推定誤差（m、出力予測器）
+    float duty[QuadModel::MOTOR_COUNT]; // モーターデューティ
+    uint8_t saturation;         // ミキサー飽和フラグ
+};
+
+/**
+ * @brief 閉ループクラス
+ * 
+ * 制御周期毎にIMUサンプルのブロックをまとめて推定器へ渡し、EKFは制御周期で予測する。
+ * 角度は姿勢推定器、角速度は最新のジャイロ値を制御器へ渡す（バイアス補正は推定値で行う）。
+ * ToF・フロー・モーションキャプチャは実機と同じく計測から遅れて届き、計測時刻付きで時刻合わせに積む。
+ * EKFは遅延状態バッファの融合地平（現在時刻 - 遅延）で予測・融合し、
+ * 高度は出力予測器で現在時刻まで伝播した推定値をPIDで追従し、ホバリングデューティを前置する。
+ * ミキサー出力は次の制御周期まで保持する（1周期の遅れ）
+ */
+class FlightLoop {
+public:
+    /**
+     * @brief ループ設定構造体
+     */
+    struct Config {
+        uint32_t imu_hz = 1600;             // IMUサンプリング周波数（Hz）
+        uint32_t control_hz = 400;          // 制御周波数（Hz、imu_hzの約数）
+        uint32_t tof_hz = 30;               // ToF更新周波数（Hz）
+        uint32_t flow_hz = 100;             // フロー更新周波数（Hz）
+        double tof_latency = 0.03;          // ToFの計測から到着までの遅延（s、測距時間と読み出し）
+        double flow_latency = 0.02;         // フローの計測から到着までの遅延（s）
+        uint32_t mocap_hz = 0;              // モーションキャプチャ更新周波数（Hz、0でなし）
+        double mocap_latency = 0.025;       // モーションキャプチャの撮像から到着までの遅延（s、Wi-Fi込み）
+        uint32_t physics_substeps = 4;      // IMU1サンプルあたりの物理刻み数
+        float hover_duty = 0.74f;           // ホバリングデューティの想定値（フィードフォワード）
+        float altitude_kp = 0.5f;           // 高度比例ゲイン（デューティ/m）
+        float altitude_ki = 0.3f;           // 高度積分ゲイン（デューティ/(m s)）
+        float altitude_kd = 0.25f;          // 高度の速度ゲイン（デューティ/(m/s)）
+        float altitude_integral_limit = 0.15f;  // 高度積分の上限（デューティ）
+        control::CascadedPid<3>::Config pid;    // 姿勢制御器設定（sample_hzはcontrol_hzで上書き）
+        QuadXMixer::Config mixer;               // ミキサー設定
+        estimation::AttitudeEstimator::Config estimator;   // 姿勢推定器設定
+        estimation::ErrorStateEkf::Config ekf;              // EKF設定
+        estimation::DelayedStateBuffer::Config delayed;     // 融合地平設定
+    };
+    
+public:
+    /**
+     * @brief 初期化（推定器は初期状態の真値から整列させる）
+     * @param config ループ設定
+     * @param model 機体モデル（初期状態設定済み）
+     * @param sensors センサモデル（reset済み）
+     */
+    void reset(const Config& config, QuadModel& model, SensorModel& sensors);
+    
+    /**
+     * @brief 1制御周期進める
+     * @param setpoint 目標値
+     * @param record 記録（nullptrで記録しない）
+     */
+    void step(const Setpoint& setpoint, LoopRecord* record);
+    
+    /**
+     * @brief 現在時刻（s）
+     */
+    double getTime() const { return time_; }
+    
+    /**
+     * @brief 制御周期（s）
+     */
+    double getControlPeriod() const { return 1.0 / static_cast<double>(config_.control_hz); }
+    
+    /**
+     * @brief 姿勢推定器取得
+     */
+    const estimation::AttitudeEstimator& getEstimator() const { return estimator_; }
+    
+    /**
+     * @brief EKF取得
+     */
+    const estimation::ErrorStateEkf& getEkf() const { return ekf_; }
+    
+    /**
+     * @brief 観測の時刻合わせ取得
+     */
+    const estimation::MeasurementAligner& getAligner() const { return aligner_; }
+    
+    /**
+     * @brief 遅延状態バッファ取得
+     */
+    const estimation::DelayedStateBuffer& getDelayedState() const { return delayed_; }
+    
+private:
+    static constexpr size_t MAX_BLOCK = 32;     // 1制御周期の最大IMUサンプル数
+    
+    /**
+     * @brief 到着待ちの観測
+     */
+    struct PendingMeasurement {
+        double arrival;                         // 到着時刻（s）
+        int64_t timestamp_us;                   // 計測時刻（μs）
+        float value[4];                         // 観測値
+    };
+    
+    Config config_;                             // ループ設定
+    QuadModel* model_ = nullptr;                // 機体モデル
+    SensorModel* sensors_ = nullptr;            // センサモデル
+    estimation::AttitudeEstimator estimator_;   // 姿勢推定器
+    estimation::ErrorStateEkf ekf_;             // EKF
+    estimation::MeasurementAligner aligner_;    // 観測の時刻合わせ
+    estimation::DelayedStateBuffer delayed_;    // 融合地平と出力予測器
+    control::CascadedPid<3> pid_;               // 姿勢制御器
+    QuadXMixer mixer_;                          // ミキサー
+    QuadXMixer::Output duty_ = {};              // 保持中のデューティ
+    double time_ = 0.0;                         // 時刻（s）
+    uint32_t samples_per_tick_ = 4;             // 1制御周期のIMUサンプル数
+    double next_tof_ = 0.0;                     // 次のToF更新時刻（s）
+    double next_flow_ = 0.0;                    // 次のフロー更新時刻（s）
+    double next_mocap_ = 0.0;                   // 次のモーションキャプチャ更新時刻（s）
+    std::deque<PendingMeasurement> pending_tof_;    // 到着待ちのToF
+    std::deque<PendingMeasurement> pending_flow_;   // 到着待ちのフロー
+    std::deque<PendingMeasurement> pending_mocap_;  // 到着待ちのモーションキャプチャ
+    float altitude_integral_ = 0.0f;            // 高度積分項（デューティ）
+    float block_[6][MAX_BLOCK];                 // IMUブロック（SoA: gx, gy, gz, ax, ay, az）
+};
+
+} // namespace sim
+
+#endif // FLIGHT_LOOP_HPP
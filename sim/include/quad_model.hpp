@@ -0,0 +1,174 @@
+/*
+ * Quadrotor Model
+ * 
+ * クアッドロータの剛体モデル（ホストシミュレーション用）
+ * 座標系はファームウェアと同じ（世界: X前・Y左・Z上、機体: X前・Y左・Z上）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef QUAD_MODEL_HPP
+#define QUAD_MODEL_HPP
+
+#include "mixer.hpp"
+#include <array>
+#include <cstddef>
+
+namespace sim {
+
+/**
+ * @brief 3次元ベクトル（倍精度）
+ */
+struct Vec3 {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    
+    Vec3 operator+(const Vec3& o) const { return {x + o.x, y + o.y, z + o.z}; }
+    Vec3 operator-(const Vec3& o) const { return {x - o.x, y - o.y, z - o.z}; }
+    Vec3 operator*(double s) const { return {x * s, y * s, z * s}; }
+    Vec3& operator+=(const Vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+    double dot(const Vec3& o) const { return x * o.x + y * o.y + z * o.z; }
+    Vec3 cross(const Vec3& o) const { return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x}; }
+};
+
+/**
+ * @brief クォータニオン（倍精度、機体→世界の回転）
+ */
+struct Quat {
+    double w = 1.0;
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    
+    /**
+     * @brief 機体座標のベクトルを世界座標へ回転
+     */
+    Vec3 rotate(const Vec3& v) const;
+    
+    /**
+     * @brief 世界座標のベクトルを機体座標へ回転
+     */
+    Vec3 rotateInverse(const Vec3& v) const;
+    
+    /**
+     * @brief オイラー角（ZYX、rad）から生成
+     */
+    static Quat fromEuler(double roll, double pitch, double yaw);
+    
+    /**
+     * @brief オイラー角（ZYX、rad）へ変換
+     */
+    void toEuler(double& roll, double& pitch, double& yaw) const;
+};
+
+/**
+ * @brief クアッドロータ剛体モデルクラス
+ * 
+ * 各モーターは1次遅れの回転数応答を持ち、推力は回転数の2乗（デューティで正規化）に比例する。
+ * 反トルクは推力に比例し、並進・回転には線形の空気抵抗を掛ける。
+ * モーター配置はcontrol::QuadXFrameから取り、ミキサーと同じ順・同じ回転方向を使う。
+ * 地面（z = 0）より下には沈まず、接地中は水平速度・角速度を減衰させる
+ */
+class QuadModel {
+public:
+    static constexpr size_t MOTOR_COUNT = control::QuadXFrame::MOTORS.size();   // モーター数
+    static constexpr double GRAVITY = 9.80665;                                  // 重力加速度（m/s^2）
+    
+    /**
+     * @brief 機体パラメータ構造体（StampFly相当の既定値）
+     */
+    struct Params {
+        double mass = 0.035;                    // 質量（kg）
+        double inertia_x = 9.2e-6;              // 慣性モーメントX（kg m^2）
+        double inertia_y = 13.3e-6;             // 慣性モーメントY
+        double inertia_z = 20.4e-6;             // 慣性モーメントZ
+        double arm = 0.0235;                    // 重心からモーターまでの前後・左右距離（m）
+        double max_thrust = 0.16;               // 1モーターの最大推力（N、デューティ1.0）
+        double torque_ratio = 0.006;            // 反トルク / 推力（m）
+        double motor_tau = 0.015;               // モーター回転数の時定数（s）
+        double linear_drag = 0.02;              // 並進抵抗係数（N/(m/s)）
+        double angular_drag = 2.0e-6;           // 回転抵抗係数（N m/(rad/s)）
+    };
+    
+    /**
+     * @brief 状態構造体
+     */
+    struct State {
+        Vec3 position;                          // 位置（世界、m）
+        Vec3 velocity;                          // 速度（世界、m/s）
+        Quat attitude;                          // 姿勢（機体→世界）
+        Vec3 rate;                              // 角速度（機体、rad/s）
+        std::array<double, MOTOR_COUNT> motor{};    // 正規化回転数（0.0-1.0）
+    };
+    
+public:
+    QuadModel() = default;
+    
+    /**
+     * @brief パラメータ設定
+     */
+    void setParams(const Params& params) { params_ = params; }
+    
+    /**
+     * @brief パラメータ取得
+     */
+    const Params& getParams() const { return params_; }
+    
+    /**
+     * @brief 状態設定（モーターは指定した回転数で定常とする）
+     */
+    void setState(const State& state) { state_ = state; }
+    
+    /**
+     * @brief 状態取得
+     */
+    const State& getState() const { return state_; }
+    
+    /**
+     * @brief ホバリングに必要なデューティ
+     */
+    double hoverDuty() const;
+    
+    /**
+     * @brief 外乱の設定（次に変更するまで加わり続ける）
+     * @param force 外力（世界、N）
+     * @param torque 外トルク（機体、N m）
+     */
+    void setDisturbance(const Vec3& force, const Vec3& torque) {
+        disturbance_force_ = force;
+        disturbance_torque_ = torque;
+    }
+    
+    /**
+     * @brief 1ステップ進める（半陰的オイラー、姿勢は指数写像で積分）
+     * @param duty モーターデューティ（ミキサー出力、0.0-1.0）
+     * @param dt 時間刻み（s）
+     */
+    void step(const std::array<float, MOTOR_COUNT>& duty, double dt);
+    
+    /**
+     * @brief 直前のステップの比力（機体、m/s^2、加速度センサの真値）
+     */
+    const Vec3& getSpecificForce() const { return specific_force_; }
+    
+    /**
+     * @brief 接地中か
+     */
+    bool isGrounded() const { return grounded_; }
+    
+private:
+    Params params_;                 // 機体パラメータ
+    State state_;                   // 状態
+    Vec3 disturbance_force_;        // 外力（世界）
+    Vec3 disturbance_torque_;       // 外トルク（機体）
+    Vec3 specific_force_ = {0.0, 0.0, GRAVITY};  // 比力（機体）
+    bool grounded_ = false;         // 接地中
+};
+
+} // namespace sim
+
+#endif // QUAD_MODEL_HPP
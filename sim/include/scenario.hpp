@@ -0,0 +1,144 @@
+/*
+ * Scenario
+ * 
+ * シミュレーションシナリオの定義・実行・評価（ホストシミュレーション用）
+ * ステップ応答・外乱・離陸・乱数条件の回帰用シナリオと合否の閾値を持つ
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SCENARIO_HPP
+#define SCENARIO_HPP
+
+#include "flight_loop.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace sim {
+
+/**
+ * @brief シミュレーション条件構造体（機体・センサ・ループ、--setで上書きする）
+ * 
+ * 姿勢制御器のゲインはStampFly相当の機体モデルで安定する値を既定値とする。
+ * CascadedPidの既定値（角速度P 0.6）は出力1あたりの角加速度が小さい機体向けで、
+ * このモデル（約2400 rad/s^2）では角速度ループが発振する
+ */
+struct Setup {
+    QuadModel::Params model;            // 機体パラメータ
+    SensorModel::Config sensors;        // センサノイズ
+    FlightLoop::Config loop;            // ループ・制御器・推定器設定
+    
+    Setup();
+};
+
+/**
+ * @brief 合否の閾値構造体（0の項目は判定しない）
+ */
+struct Limits {
+    float attitude_rms_deg = 0.0f;      // ロール・ピッチ追従誤差のRMS上限（度）
+    float overshoot_pct = 0.0f;         // ステップ応答のオーバーシュート上限（%）
+    float settle_s = 0.0f;              // ステップ応答の整定時間上限（s、推定角度の誤差がステップの20%以内）
+    float altitude_rms_m = 0.0f;        // 高度追従誤差のRMS上限（m）
+    float estimate_rms_deg = 0.0f;      // ロール・ピッチ推定誤差のRMS上限（度）
+    float final_error_deg = 0.0f;       // 終了時の角度誤差上限（度、ロール・ピッチの大きい方）
+    float position_estimate_rms_m = 0.0f;   // 水平位置推定誤差のRMS上限（m）
+};
+
+/**
+ * @brief シナリオ定義構造体
+ */
+struct ScenarioSpec {
+    const char* name;                   // 名前（--scenarioで指定）
+    const char* description;            // 説明
+    double duration = 5.0;              // 実行時間（s）
+    double initial_altitude = 0.5;      // 初期高度（m、0で接地状態から）
+    double initial_x = 0.0;             // 初期位置X（m、推定の原点との差）
+    double initial_y = 0.0;             // 初期位置Y（m）
+    double initial_yaw = 0.0;           // 初期ヨー角（rad、推定器は0で起動する）
+    uint32_t mocap_hz = 0;              // モーションキャプチャ更新周波数（Hz、0で条件の値のまま）
+    float altitude_target = 0.5f;       // 目標高度（m）
+    int step_axis = -1;                 // ステップ入力の軸（0: ロール、1: ピッチ、2: ヨー、-1: なし）
+    float step_value = 0.0f;            // ステップの大きさ（rad）
+    double step_start = 1.0;            // ステップ開始（s）
+    double step_end = 3.0;              // ステップ終了（s、目標を0へ戻す）
+    Vec3 disturbance_force;             // 外力（世界、N）
+    Vec3 disturbance_torque;            // 外トルク（機体、N m）
+    double disturbance_start = 0.0;     // 外乱開始（s）
+    double disturbance_end = 0.0;       // 外乱終了（s）
+    double evaluate_from = 0.5;         // RMS評価の開始時刻（s、初期過渡を除く）
+    bool randomize = false;             // 実行毎に条件を乱数で変える
+    Limits limits;                      // 合否の閾値
+};
+
+/**
+ * @brief 評価指標構造体
+ */
+struct Metrics {
+    float attitude_rms_deg;             // ロール・ピッチ追従誤差のRMS（度）
+    float max_tilt_deg;                 // 最大傾き（度）
+    float overshoot_pct;                // オーバーシュート（%、推定角度）
+    float settle_s;                     // 整定時間（s、整定しない場合は負）
+    float altitude_rms_m;               // 高度追従誤差のRMS（m）
+    float estimate_rms_deg;             // ロール・ピッチ推定誤差のRMS（度）
+    float altitude_estimate_rms_m;      // 高度推定誤差のRMS（m）
+    float position_estimate_rms_m;      // 水平位置推定誤差のRMS（m）
+    float final_error_deg;              // 終了時の角度誤差（度、ロール・ピッチの大きい方、ヨーは地磁気なしで漂流するため除く）
+    float saturation_pct;               // ミキサー飽和の割合（%）
+    bool crashed;                       // 墜落・発散（傾き80度超、非数、評価区間の接地）
+};
+
+/**
+ * @brief シナリオ実行結果構造体
+ */
+struct ScenarioResult {
+    const char* name;                   // シナリオ名
+    uint32_t seed;                      // 乱数シード
+    bool passed;                        // 合否
+    Metrics metrics;                    // 評価指標
+    double sim_time_s;                  // シミュレーション時間（s）
+    double wall_time_s;                 // 実行時間（s）
+};
+
+/**
+ * @brief 組み込みシナリオ一覧
+ * @param count シナリオ数
+ */
+const ScenarioSpec* scenarios(size_t& count);
+
+/**
+ * @brief 名前でシナリオを探す
+ * @return const ScenarioSpec* 見つからない場合nullptr
+ */
+const ScenarioSpec* findScenario(const char* name);
+
+/**
+ * @brief シナリオ実行
+ * @param spec シナリオ定義
+ * @param setup シミュレーション条件
+ * @param seed 乱数シード（センサノイズ・乱数条件）
+ * @param csv 制御周期毎の記録の出力先（nullptrで出力しない）
+ * @return ScenarioResult 実行結果
+ */
+ScenarioResult runScenario(const ScenarioSpec& spec, const Setup& setup, uint32_t seed, FILE* csv);
+
+/**
+ * @brief 名前で条件の1項目を上書き
+ * @param setup シミュレーション条件
+ * @param name 項目名（例: "roll.rate_kp"、"model.mass"）
+ * @param value 値
+ * @return bool 項目が見つかった場合true
+ */
+bool setParameter(Setup& setup, const char* name, double value);
+
+/**
+ * @brief 上書きできる項目の一覧を出力
+ */
+void printParameters(const Setup& setup, FILE* out);
+
+} // namespace sim
+
+#endif // SCENARIO_HPP
@@ -0,0 +1,104 @@
+/*
+ * Sensor Model
+ * 
+ * IMU・ToF・オプティカルフローの観測モデル（ホストシミュレーション用）
+ * 白色ノイズ・一定バイアス・モーター回転に同期した振動を真値に加える
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SENSOR_MODEL_HPP
+#define SENSOR_MODEL_HPP
+
+#include "quad_model.hpp"
+#include <cstdint>
+#include <random>
+
+namespace sim {
+
+/**
+ * @brief IMUサンプル構造体（ファームウェアと同じ単位: rad/s, m/s^2）
+ */
+struct ImuSample {
+    float gx, gy, gz;       // 角速度
+    float ax, ay, az;       // 加速度
+};
+
+/**
+ * @brief センサモデルクラス
+ */
+class SensorModel {
+public:
+    /**
+     * @brief ノイズ設定構造体（BMI270・VL53L3CX・PMW3901相当の既定値）
+     */
+    struct Config {
+        double gyro_noise = 0.004;          // ジャイロの標準偏差（rad/s、1サンプル）
+        double gyro_bias = 0.01;            // ジャイロバイアスの標準偏差（rad/s、実行毎に一定）
+        double accel_noise = 0.04;          // 加速度の標準偏差（m/s^2）
+        double accel_bias = 0.05;           // 加速度バイアスの標準偏差（m/s^2）
+        double vibration = 1.5;             // モーター振動の加速度振幅（m/s^2、最大回転時）
+        double vibration_gyro = 0.05;       // モーター振動の角速度振幅（rad/s、最大回転時）
+        double motor_max_hz = 500.0;        // 最大回転時のモーター回転周波数（Hz）
+        double tof_noise = 0.01;            // ToF距離の標準偏差（m）
+        double tof_max_range = 4.0;         // ToFの有効距離上限（m、超えると0を返す）
+        double flow_noise = 0.05;           // フローの標準偏差（rad/s）
+        double mocap_noise = 0.002;         // モーションキャプチャ位置の標準偏差（m）
+        double mocap_yaw_noise = 0.005;     // モーションキャプチャのヨー角の標準偏差（rad）
+    };
+    
+public:
+    /**
+     * @brief 初期化（バイアスを乱数で決める）
+     * @param config ノイズ設定
+     * @param seed 乱数シード
+     */
+    void reset(const Config& config, uint32_t seed);
+    
+    /**
+     * @brief IMUサンプル生成
+     * @param model 機体モデル（直前のステップの状態）
+     * @param dt サンプル間隔（s、振動の位相を進める）
+     */
+    ImuSample sampleImu(const QuadModel& model, double dt);
+    
+    /**
+     * @brief ToF距離（機体下向き、範囲外は0）
+     */
+    float sampleTof(const QuadModel& model);
+    
+    /**
+     * @brief 並進フロー（回転成分除去済み、機体X/Y、rad/s）
+     * @return bool 有効な値を出せた場合true（高度が低すぎる・傾きすぎの場合false）
+     */
+    bool sampleFlow(const QuadModel& model, float& flow_x, float& flow_y);
+    
+    /**
+     * @brief モーションキャプチャの姿勢（世界座標の位置とヨー角）
+     * @param position 位置 X, Y, Z（m）
+     * @param yaw ヨー角（rad）
+     */
+    void sampleMocap(const QuadModel& model, float position[3], float& yaw);
+    
+    /**
+     * @brief ジャイロバイアスの真値（rad/s）
+     */
+    const Vec3& getGyroBias() const { return gyro_bias_; }
+    
+private:
+    Config config_;                 // ノイズ設定
+    std::mt19937 rng_;              // 乱数生成器
+    std::normal_distribution<double> normal_{0.0, 1.0};    // 標準正規分布
+    Vec3 gyro_bias_;                // ジャイロバイアス
+    Vec3 accel_bias_;               // 加速度バイアス
+    double phase_[QuadModel::MOTOR_COUNT] = {};   // モーター振動の位相（rad）
+    
+    double gaussian(double sigma) { return sigma * normal_(rng_); }
+};
+
+} // namespace sim
+
+#endif // SENSOR_MODEL_HPP
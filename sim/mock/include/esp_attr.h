@@ -0,0 +1,21 @@
+/*
+ * ESP Attributes (Host Mock)
+ * 
+ * ホストビルド用のesp_attr.h置き換え（配置属性は無効）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SIM_MOCK_ESP_ATTR_H
+#define SIM_MOCK_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#endif // SIM_MOCK_ESP_ATTR_H
@@ -0,0 +1,47 @@
+/*
+ * ESP CPU (Host Mock)
+ * 
+ * ホストビルド用のesp_cpu.h置き換え
+ * サイクルカウンタはx86ではTSC、それ以外は単調時計（ns）で代用する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SIM_MOCK_ESP_CPU_H
+#define SIM_MOCK_ESP_CPU_H
+
+#include <stdint.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+static inline esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return (esp_cpu_cycle_count_t)__rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+static inline int esp_cpu_get_core_id(void) {
+    return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_MOCK_ESP_CPU_H
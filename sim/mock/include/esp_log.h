@@ -0,0 +1,32 @@
+/*
+ * ESP Log (Host Mock)
+ * 
+ * ホストビルド用のesp_log.h置き換え（標準エラー出力へ書き出す）
+ * ESP_LOGD/ESP_LOGVはSIM_LOG_VERBOSEを定義した場合のみ出力する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef SIM_MOCK_ESP_LOG_H
+#define SIM_MOCK_ESP_LOG_H
+
+#include <stdio.h>
+
+#define SIM_LOG(level, tag, format, ...) fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) SIM_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) SIM_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) SIM_LOG("I", tag, format, ##__VA_ARGS__)
+
+#ifdef SIM_LOG_VERBOSE
+#define ESP_LOGD(tag, format, ...) SIM_LOG("D", tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...) SIM_LOG("V", tag, format, ##__VA_ARGS__)
+#else
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOGV(tag, format, ...) do { } while (0)
+#endif
+
+#endif // SIM_MOCK_ESP_LOG_H
@@ -0,0 +1,197 @@
+/*
+ * Flight Loop Implementation
+ * 
+ * 推定・制御コンポーネントの閉ループ実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "flight_loop.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+namespace {
+
+constexpr float GROUND_ALTITUDE = 0.03f;        // 接地とみなす推定高度（m、高度積分を止める）
+
+} // namespace
+
+void FlightLoop::reset(const Config& config, QuadModel& model, SensorModel& sensors) {
+    config_ = config;
+    model_ = &model;
+    sensors_ = &sensors;
+    samples_per_tick_ = std::clamp<uint32_t>(config.imu_hz / config.control_hz, 1, MAX_BLOCK);
+    config_.control_hz = config.imu_hz / samples_per_tick_;
+    config_.pid.sample_hz = static_cast<float>(config_.control_hz);
+    
+    pid_.setConfig(config_.pid);
+    mixer_.setConfig(config_.mixer);
+    estimator_.setConfig(config_.estimator);
+    estimator_.reset();
+    ekf_.setConfig(config_.ekf);
+    
+    // 静止中の1サンプルで重力方向へ整列（実機の起動時と同じ、ヨーは0）
+    ImuSample first = sensors.sampleImu(model, 0.0);
+    estimator_.alignToGravity(first.ax, first.ay, first.az);
+    ekf_.reset(estimator_.getQuaternion(), static_cast<float>(model.getState().position.z));
+    aligner_.reset();
+    delayed_.setConfig(config_.delayed);
+    delayed_.reset(ekf_);
+    pending_tof_.clear();
+    pending_flow_.clear();
+    pending_mocap_.clear();
+    
+    // 初期状態のモーター回転数を保持する
+    const QuadModel::State& state = model.getState();
+    for (size_t i = 0; i < QuadModel::MOTOR_COUNT; i++) {
+        duty_[i] = static_cast<float>(state.motor[i]);
+    }
+    time_ = 0.0;
+    next_tof_ = 0.0;
+    next_flow_ = 0.0;
+    next_mocap_ = 0.0;
+    altitude_integral_ = 0.0f;
+}
+
+void FlightLoop::step(const Setpoint& setpoint, LoopRecord* record) {
+    const double imu_dt = 1.0 / static_cast<double>(config_.imu_hz);
+    const double physics_dt = imu_dt / static_cast<double>(config_.physics_substeps);
+    const float control_dt = static_cast<float>(getControlPeriod());
+    
+    // 機体を進めながらIMUサンプルを集める（実機のFIFO読み出し1回分）
+    for (uint32_t n = 0; n < samples_per_tick_; n++) {
+        for (uint32_t k = 0; k < config_.physics_substeps; k++) {
+            model_->step(duty_, physics_dt);
+        }
+        ImuSample sample = sensors_->sampleImu(*model_, imu_dt);
+        block_[0][n] = sample.gx;
+        block_[1][n] = sample.gy;
+        block_[2][n] = sample.gz;
+        block_[3][n] = sample.ax;
+        block_[4][n] = sample.ay;
+        block_[5][n] = sample.az;
+    }
+    time_ += imu_dt * static_cast<double>(samples_per_tick_);
+    
+    // 推定
+    estimator_.update(block_[0], block_[1], block_[2], block_[3], block_[4], block_[5], 
+                      samples_per_tick_, static_cast<float>(imu_dt));
+    float mean[6] = {};
+    for (size_t c = 0; c < 6; c++) {
+        for (uint32_t n = 0; n < samples_per_tick_; n++) {
+            mean[c] += block_[c][n];
+        }
+        mean[c] /= static_cast<float>(samples_per_tick_);
+    }
+    const int64_t now_us = static_cast<int64_t>(std::llround(time_ * 1e6));
+    if (config_.tof_hz > 0 && time_ >= next_tof_) {
+        next_tof_ = time_ + 1.0 / static_cast<double>(config_.tof_hz);
+        float range = sensors_->sampleTof(*model_);
+        if (range > 0.0f) {
+            pending_tof_.push_back({time_ + config_.tof_latency, now_us, {range, 0.0f, 0.0f, 0.0f}});
+        }
+    }
+    if (config_.flow_hz > 0 && time_ >= next_flow_) {
+        next_flow_ = time_ + 1.0 / static_cast<double>(config_.flow_hz);
+        float flow_x = 0.0f;
+        float flow_y = 0.0f;
+        if (sensors_->sampleFlow(*model_, flow_x, flow_y)) {
+            pending_flow_.push_back({time_ + config_.flow_latency, now_us, {flow_x, flow_y, 0.0f, 0.0f}});
+        }
+    }
+    if (config_.mocap_hz > 0 && time_ >= next_mocap_) {
+        next_mocap_ = time_ + 1.0 / static_cast<double>(config_.mocap_hz);
+        PendingMeasurement pose = {time_ + config_.mocap_latency, now_us, {}};
+        sensors_->sampleMocap(*model_, pose.value, pose.value[3]);
+        pending_mocap_.push_back(pose);
+    }
+    while (!pending_tof_.empty() && pending_tof_.front().arrival <= time_) {
+        aligner_.pushTof(pending_tof_.front().timestamp_us, pending_tof_.front().value[0]);
+        pending_tof_.pop_front();
+    }
+    while (!pending_flow_.empty() && pending_flow_.front().arrival <= time_) {
+        const PendingMeasurement& flow = pending_flow_.front();
+        aligner_.pushFlow(flow.timestamp_us, flow.value[0], flow.value[1]);
+        pending_flow_.pop_front();
+    }
+    while (!pending_mocap_.empty() && pending_mocap_.front().arrival <= time_) {
+        // 実機は MocapReceiver が時刻同期で撮像時刻へ戻した時刻で積む
+        const PendingMeasurement& pose = pending_mocap_.front();
+        aligner_.pushExternalPose(pose.timestamp_us, common::Vector3f(pose.value[0], pose.value[1], pose.value[2]), 
+                                  pose.value[3], true);
+        pending_mocap_.pop_front();
+    }
+    delayed_.update(ekf_, aligner_, mean[0], mean[1], mean[2], mean[3], mean[4], mean[5], control_dt, now_us);
+    
+    // 姿勢制御（角度は推定値、角速度は最新サンプルからバイアスを除いた値）
+    estimation::EulerAngles euler = estimator_.getEulerAngles();
+    float bx = 0.0f;
+    float by = 0.0f;
+    float bz = 0.0f;
+    estimator_.getGyroBias(bx, by, bz);
+    const uint32_t last = samples_per_tick_ - 1;
+    float angle_target[3] = {setpoint.roll, setpoint.pitch, setpoint.yaw};
+    float angle[3] = {euler.roll, euler.pitch, euler.yaw};
+    float rate[3] = {block_[0][last] - bx, block_[1][last] - by, block_[2][last] - bz};
+    // ヨーは ±π の折り返しを跨がないよう誤差を正規化してから目標に戻す
+    float yaw_error = std::remainder(angle_target[2] - angle[2], 2.0f * static_cast<float>(M_PI));
+    angle_target[2] = angle[2] + yaw_error;
+    float torque[3];
+    pid_.compute(angle_target, angle, rate, torque);
+    
+    // 高度制御（出力予測器の高度・上昇速度、傾き分の推力を補う）
+    float altitude = delayed_.getPosition()[2];
+    float climb = delayed_.getVelocity()[2];
+    float altitude_error = setpoint.altitude - altitude;
+    if (altitude > GROUND_ALTITUDE) {
+        altitude_integral_ = std::clamp(altitude_integral_ + config_.altitude_ki * altitude_error * control_dt, 
+                                        -config_.altitude_integral_limit, config_.altitude_integral_limit);
+    }
+    float collective = config_.hover_duty + config_.altitude_kp * altitude_error + altitude_integral_
+                     - config_.altitude_kd * climb;
+    const estimation::Quaternion& q = estimator_.getQuaternion();
+    float r22 = 1.0f - 2.0f * (q.x * q.x + q.y * q.y);
+    collective /= std::sqrt(std::max(r22, 0.5f));
+    const QuadXMixer::Config& mixer_config = mixer_.getConfig();
+    float thrust = (collective - mixer_config.output_min) / (mixer_config.output_max - mixer_config.output_min);
+    
+    control::MixerCommand command = {torque[0], torque[1], torque[2], std::clamp(thrust, 0.0f, 1.0f)};
+    uint8_t saturation = mixer_.mix(command, duty_);
+    
+    if (record != nullptr) {
+        const QuadModel::State& s = model_->getState();
+        double roll = 0.0;
+        double pitch = 0.0;
+        double yaw = 0.0;
+        s.attitude.toEuler(roll, pitch, yaw);
+        record->time = time_;
+        record->target[0] = setpoint.roll;
+        record->target[1] = setpoint.pitch;
+        record->target[2] = setpoint.yaw;
+        record->angle[0] = static_cast<float>(roll);
+        record->angle[1] = static_cast<float>(pitch);
+        record->angle[2] = static_cast<float>(yaw);
+        record->estimate[0] = euler.roll;
+        record->estimate[1] = euler.pitch;
+        record->estimate[2] = euler.yaw;
+        record->rate[0] = static_cast<float>(s.rate.x);
+        record->rate[1] = static_cast<float>(s.rate.y);
+        record->rate[2] = static_cast<float>(s.rate.z);
+        record->altitude = static_cast<float>(s.position.z);
+        record->altitude_estimate = altitude;
+        record->altitude_target = setpoint.altitude;
+        const common::Vector3f& position = delayed_.getPosition();
+        record->position_error = static_cast<float>(std::hypot(position[0] - s.position.x, position[1] - s.position.y));
+        for (size_t i = 0; i < QuadModel::MOTOR_COUNT; i++) {
+            record->duty[i] = duty_[i];
+        }
+        record->saturation = saturation;
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,139 @@
+/*
+ * Quadrotor Model Implementation
+ * 
+ * クアッドロータ剛体モデルの実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "quad_model.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim {
+
+Vec3 Quat::rotate(const Vec3& v) const {
+    // v' = v + 2w(u×v) + 2u×(u×v)
+    Vec3 u = {x, y, z};
+    Vec3 t = u.cross(v) * 2.0;
+    return v + t * w + u.cross(t);
+}
+
+Vec3 Quat::rotateInverse(const Vec3& v) const {
+    Quat conjugate = {w, -x, -y, -z};
+    return conjugate.rotate(v);
+}
+
+Quat Quat::fromEuler(double roll, double pitch, double yaw) {
+    double cr = std::cos(roll * 0.5);
+    double sr = std::sin(roll * 0.5);
+    double cp = std::cos(pitch * 0.5);
+    double sp = std::sin(pitch * 0.5);
+    double cy = std::cos(yaw * 0.5);
+    double sy = std::sin(yaw * 0.5);
+    return {
+        cr * cp * cy + sr * sp * sy,
+        sr * cp * cy - cr * sp * sy,
+        cr * sp * cy + sr * cp * sy,
+        cr * cp * sy - sr * sp * cy
+    };
+}
+
+void Quat::toEuler(double& roll, double& pitch, double& yaw) const {
+    roll = std::atan2(2.0 * (w * x + y * z), 1.0 - 2.0 * (x * x + y * y));
+    double sin_pitch = std::clamp(2.0 * (w * y - z * x), -1.0, 1.0);
+    pitch = std::asin(sin_pitch);
+    yaw = std::atan2(2.0 * (w * z + x * y), 1.0 - 2.0 * (y * y + z * z));
+}
+
+double QuadModel::hoverDuty() const {
+    double per_motor = params_.mass * GRAVITY / static_cast<double>(MOTOR_COUNT);
+    return std::sqrt(per_motor / params_.max_thrust);
+}
+
+void QuadModel::step(const std::array<float, MOTOR_COUNT>& duty, double dt) {
+    const Params& p = params_;
+    State& s = state_;
+    
+    // モーター（1次遅れ、厳密な離散化）
+    double motor_alpha = 1.0 - std::exp(-dt / p.motor_tau);
+    Vec3 torque = disturbance_torque_ - s.rate * p.angular_drag;
+    double thrust = 0.0;
+    for (size_t i = 0; i < MOTOR_COUNT; i++) {
+        double command = std::clamp(static_cast<double>(duty[i]), 0.0, 1.0);
+        s.motor[i] += motor_alpha * (command - s.motor[i]);
+        double motor_thrust = p.max_thrust * s.motor[i] * s.motor[i];
+        const control::MotorGeometry& m = control::QuadXFrame::MOTORS[i];
+        // τ = r × (0, 0, T)、反トルクはプロペラ回転と逆向き
+        torque.x += m.y * p.arm * motor_thrust;
+        torque.y -= m.x * p.arm * motor_thrust;
+        torque.z -= static_cast<double>(m.spin) * p.torque_ratio * motor_thrust;
+        thrust += motor_thrust;
+    }
+    
+    // 並進（機体Z軸方向の推力 + 抵抗 + 外力）
+    Vec3 thrust_world = s.attitude.rotate(Vec3{0.0, 0.0, thrust});
+    Vec3 force = thrust_world + disturbance_force_ - s.velocity * p.linear_drag;
+    Vec3 accel = force * (1.0 / p.mass);
+    accel.z -= GRAVITY;
+    
+    // 回転（オイラーの運動方程式）
+    Vec3 inertia = {p.inertia_x, p.inertia_y, p.inertia_z};
+    Vec3 momentum = {inertia.x * s.rate.x, inertia.y * s.rate.y, inertia.z * s.rate.z};
+    Vec3 gyroscopic = s.rate.cross(momentum);
+    Vec3 angular_accel = {
+        (torque.x - gyroscopic.x) / inertia.x,
+        (torque.y - gyroscopic.y) / inertia.y,
+        (torque.z - gyroscopic.z) / inertia.z
+    };
+    
+    // 接地（地面より下へは進まない、推力が重力を超えるまで静止）
+    grounded_ = s.position.z <= 0.0 && accel.z <= 0.0;
+    if (grounded_) {
+        accel = {0.0, 0.0, 0.0};
+        angular_accel = {0.0, 0.0, 0.0};
+        s.velocity = {0.0, 0.0, 0.0};
+        s.rate = {0.0, 0.0, 0.0};
+        s.position.z = 0.0;
+    }
+    
+    s.velocity += accel * dt;
+    s.position += s.velocity * dt;
+    s.rate += angular_accel * dt;
+    if (s.position.z < 0.0) {
+        s.position.z = 0.0;
+        s.velocity.z = std::max(0.0, s.velocity.z);
+    }
+    
+    // 姿勢（q ← q ⊗ exp(ω dt / 2)）
+    double angle = std::sqrt(s.rate.dot(s.rate)) * dt;
+    if (angle > 1e-12) {
+        Vec3 axis = s.rate * (1.0 / std::sqrt(s.rate.dot(s.rate)));
+        double half = 0.5 * angle;
+        double sh = std::sin(half);
+        Quat dq = {std::cos(half), axis.x * sh, axis.y * sh, axis.z * sh};
+        Quat q = s.attitude;
+        s.attitude = {
+            q.w * dq.w - q.x * dq.x - q.y * dq.y - q.z * dq.z,
+            q.w * dq.x + q.x * dq.w + q.y * dq.z - q.z * dq.y,
+            q.w * dq.y - q.x * dq.z + q.y * dq.w + q.z * dq.x,
+            q.w * dq.z + q.x * dq.y - q.y * dq.x + q.z * dq.w
+        };
+        double norm = std::sqrt(s.attitude.w * s.attitude.w + s.attitude.x * s.attitude.x
+                              + s.attitude.y * s.attitude.y + s.attitude.z * s.attitude.z);
+        s.attitude.w /= norm;
+        s.attitude.x /= norm;
+        s.attitude.y /= norm;
+        s.attitude.z /= norm;
+    }
+    
+    // 加速度センサの真値（重力を含まない加速度 - 重力、機体座標）
+    Vec3 accel_no_gravity = accel;
+    accel_no_gravity.z += GRAVITY;
+    specific_force_ = s.attitude.rotateInverse(accel_no_gravity);
+}
+
+} // namespace sim
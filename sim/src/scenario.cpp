@@ -0,0 +1,450 @@
+/*
+ * Scenario Implementation
+ * 
+ * シミュレーションシナリオの実行・評価実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "scenario.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace sim {
+
+namespace {
+
+constexpr float RAD_TO_DEG = 180.0f / static_cast<float>(M_PI);
+constexpr float CRASH_TILT = 80.0f / RAD_TO_DEG;        // 墜落とみなす傾き（rad）
+constexpr float CRASH_ALTITUDE = 0.02f;                 // 評価区間でこれ未満は墜落（m）
+constexpr float SETTLE_BAND = 0.2f;                     // 整定の誤差帯（ステップの大きさ比）
+
+/**
+ * @brief 組み込みシナリオ
+ */
+ScenarioSpec makeScenarios(size_t index) {
+    ScenarioSpec s;
+    switch (index) {
+    case 0:
+        s.name = "hover";
+        s.description = "0.5mでのホバリング（センサノイズ・振動のみ）";
+        s.limits.attitude_rms_deg = 3.0f;
+        s.limits.altitude_rms_m = 0.03f;
+        s.limits.estimate_rms_deg = 5.0f;
+        s.limits.final_error_deg = 8.0f;
+        break;
+    case 1:
+        s.name = "roll_step";
+        s.description = "ロール15度のステップ応答（1s〜1.6s）";
+        s.step_axis = 0;
+        s.step_value = 15.0f / RAD_TO_DEG;
+        s.step_end = 1.6;
+        s.limits.overshoot_pct = 25.0f;
+        s.limits.settle_s = 0.5f;
+        s.limits.altitude_rms_m = 0.1f;
+        s.limits.estimate_rms_deg = 5.0f;
+        s.limits.final_error_deg = 8.0f;
+        break;
+    case 2:
+        s.name = "pitch_step";
+        s.description = "ピッチ15度のステップ応答（1s〜1.6s）";
+        s.step_axis = 1;
+        s.step_value = 15.0f / RAD_TO_DEG;
+        s.step_end = 1.6;
+        s.limits.overshoot_pct = 25.0f;
+        s.limits.settle_s = 0.5f;
+        s.limits.altitude_rms_m = 0.1f;
+        s.limits.estimate_rms_deg = 5.0f;
+        s.limits.final_error_deg = 8.0f;
+        break;
+    case 3:
+        s.name = "yaw_step";
+        s.description = "ヨー45度のステップ応答（1s〜3s）";
+        s.step_axis = 2;
+        s.step_value = 45.0f / RAD_TO_DEG;
+        s.limits.attitude_rms_deg = 3.0f;
+        s.limits.overshoot_pct = 25.0f;
+        s.limits.settle_s = 1.0f;
+        s.limits.altitude_rms_m = 0.05f;
+        s.limits.final_error_deg = 5.0f;
+        break;
+    case 4:
+        s.name = "gust";
+        s.description = "1sから0.1sの横風（外力0.1N・外トルク）からの回復";
+        s.disturbance_force = {0.0, 0.1, 0.0};
+        s.disturbance_torque = {2.0e-4, -1.0e-4, 0.0};
+        s.disturbance_start = 1.0;
+        s.disturbance_end = 1.1;
+        s.limits.attitude_rms_deg = 4.0f;
+        s.limits.altitude_rms_m = 0.05f;
+        s.limits.final_error_deg = 5.0f;
+        break;
+    case 5:
+        s.name = "takeoff";
+        s.description = "接地状態から0.5mへの離陸";
+        s.initial_altitude = 0.0;
+        s.evaluate_from = 2.5;
+        s.limits.attitude_rms_deg = 3.0f;
+        s.limits.altitude_rms_m = 0.05f;
+        s.limits.final_error_deg = 5.0f;
+        break;
+    case 6:
+        s.name = "random";
+        s.description = "機体パラメータ・ステップ・外乱を乱数で変えた回帰（--runsで回数指定）";
+        s.randomize = true;
+        s.limits.final_error_deg = 8.0f;
+        break;
+    case 7:
+        s.name = "mocap";
+        s.description = "モーションキャプチャ（120Hz・遅延25ms）の外部姿勢を融合したホバリング（原点・ヨーのずれから）";
+        s.mocap_hz = 120;
+        s.initial_x = 1.5;
+        s.initial_y = -0.8;
+        s.initial_yaw = 0.6;
+        s.evaluate_from = 1.0;
+        s.limits.attitude_rms_deg = 3.0f;
+        s.limits.altitude_rms_m = 0.03f;
+        s.limits.final_error_deg = 8.0f;
+        s.limits.position_estimate_rms_m = 0.02f;
+        break;
+    default:
+        s.name = nullptr;
+        s.description = nullptr;
+        break;
+    }
+    return s;
+}
+
+constexpr size_t SCENARIO_COUNT = 8;
+
+/**
+ * @brief 乱数条件（機体パラメータ±、ステップ軸・大きさ、外乱）
+ */
+void randomize(ScenarioSpec& spec, Setup& setup, std::mt19937& rng) {
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    QuadModel::Params& m = setup.model;
+    m.mass *= 1.0 + 0.1 * unit(rng);
+    m.inertia_x *= 1.0 + 0.2 * unit(rng);
+    m.inertia_y *= 1.0 + 0.2 * unit(rng);
+    m.inertia_z *= 1.0 + 0.2 * unit(rng);
+    m.max_thrust *= 1.0 + 0.1 * unit(rng);
+    m.motor_tau *= 1.0 + 0.3 * unit(rng);
+    
+    spec.step_axis = static_cast<int>(rng() % 3);
+    double magnitude = spec.step_axis == 2 ? 0.8 : 0.3;
+    spec.step_value = static_cast<float>(magnitude * unit(rng));
+    spec.step_start = 1.0 + 0.5 * (unit(rng) + 1.0);
+    spec.step_end = spec.step_start + (spec.step_axis == 2 ? 2.0 : 0.6);
+    spec.disturbance_force = {0.05 * unit(rng), 0.05 * unit(rng), 0.0};
+    spec.disturbance_torque = {1.0e-4 * unit(rng), 1.0e-4 * unit(rng), 0.5e-4 * unit(rng)};
+    spec.disturbance_start = 0.5 + 3.0 * (unit(rng) + 1.0) * 0.5;
+    spec.disturbance_end = spec.disturbance_start + 0.05;
+    spec.duration = std::max(spec.duration, spec.step_end + 1.5);
+}
+
+using ParameterRef = std::variant<float*, double*>;
+
+/**
+ * @brief 上書きできる項目の一覧（名前と格納先）
+ */
+std::vector<std::pair<std::string, ParameterRef>> bindParameters(Setup& setup) {
+    std::vector<std::pair<std::string, ParameterRef>> list;
+    static const char* const AXIS_NAMES[3] = {"roll", "pitch", "yaw"};
+    for (size_t a = 0; a < 3; a++) {
+        auto& c = setup.loop.pid.axis[a];
+        std::string prefix = std::string(AXIS_NAMES[a]) + ".";
+        list.emplace_back(prefix + "angle_kp", &c.angle_kp);
+        list.emplace_back(prefix + "rate_limit", &c.rate_limit);
+        list.emplace_back(prefix + "rate_kp", &c.rate_kp);
+        list.emplace_back(prefix + "rate_ki", &c.rate_ki);
+        list.emplace_back(prefix + "rate_kd", &c.rate_kd);
+        list.emplace_back(prefix + "rate_ff", &c.rate_ff);
+        list.emplace_back(prefix + "integral_limit", &c.integral_limit);
+        list.emplace_back(prefix + "output_limit", &c.output_limit);
+        list.emplace_back(prefix + "d_cutoff_hz", &c.d_cutoff_hz);
+    }
+    FlightLoop::Config& l = setup.loop;
+    list.emplace_back("altitude.kp", &l.altitude_kp);
+    list.emplace_back("altitude.ki", &l.altitude_ki);
+    list.emplace_back("altitude.kd", &l.altitude_kd);
+    list.emplace_back("altitude.hover_duty", &l.hover_duty);
+    list.emplace_back("mixer.output_min", &l.mixer.output_min);
+    list.emplace_back("estimator.mahony_kp", &l.estimator.mahony_kp);
+    list.emplace_back("estimator.mahony_ki", &l.estimator.mahony_ki);
+    list.emplace_back("ekf.accel_noise", &l.ekf.accel_noise);
+    list.emplace_back("ekf.tof_noise", &l.ekf.tof_noise);
+    list.emplace_back("ekf.flow_noise", &l.ekf.flow_noise);
+    list.emplace_back("latency.tof", &l.tof_latency);
+    list.emplace_back("latency.flow", &l.flow_latency);
+    list.emplace_back("latency.mocap", &l.mocap_latency);
+    list.emplace_back("delayed.correction_tau", &l.delayed.correction_tau);
+    QuadModel::Params& m = setup.model;
+    list.emplace_back("model.mass", &m.mass);
+    list.emplace_back("model.inertia_x", &m.inertia_x);
+    list.emplace_back("model.inertia_y", &m.inertia_y);
+    list.emplace_back("model.inertia_z", &m.inertia_z);
+    list.emplace_back("model.max_thrust", &m.max_thrust);
+    list.emplace_back("model.motor_tau", &m.motor_tau);
+    SensorModel::Config& n = setup.sensors;
+    list.emplace_back("sensor.gyro_noise", &n.gyro_noise);
+    list.emplace_back("sensor.gyro_bias", &n.gyro_bias);
+    list.emplace_back("sensor.accel_noise", &n.accel_noise);
+    list.emplace_back("sensor.vibration", &n.vibration);
+    list.emplace_back("sensor.vibration_gyro", &n.vibration_gyro);
+    list.emplace_back("sensor.mocap_noise", &n.mocap_noise);
+    return list;
+}
+
+/**
+ * @brief 角度誤差（ヨーの折り返しを考慮、rad）
+ */
+inline float angleError(float target, float angle) {
+    return std::remainder(target - angle, 2.0f * static_cast<float>(M_PI));
+}
+
+} // namespace
+
+Setup::Setup() {
+    for (size_t a = 0; a < 2; a++) {
+        auto& c = loop.pid.axis[a];
+        c.rate_kp = 0.1f;
+        c.rate_ki = 0.2f;
+        c.rate_kd = 0.001f;
+    }
+    auto& yaw = loop.pid.axis[2];
+    yaw.angle_kp = 4.0f;
+    yaw.rate_kp = 0.2f;
+    yaw.rate_ki = 0.1f;
+    yaw.rate_kd = 0.0f;
+}
+
+const ScenarioSpec* scenarios(size_t& count) {
+    static ScenarioSpec table[SCENARIO_COUNT];
+    static bool initialized = false;
+    if (!initialized) {
+        for (size_t i = 0; i < SCENARIO_COUNT; i++) {
+            table[i] = makeScenarios(i);
+        }
+        initialized = true;
+    }
+    count = SCENARIO_COUNT;
+    return table;
+}
+
+const ScenarioSpec* findScenario(const char* name) {
+    size_t count = 0;
+    const ScenarioSpec* table = scenarios(count);
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(table[i].name, name) == 0) {
+            return &table[i];
+        }
+    }
+    return nullptr;
+}
+
+ScenarioResult runScenario(const ScenarioSpec& base_spec, const Setup& base_setup, uint32_t seed, FILE* csv) {
+    ScenarioSpec spec = base_spec;
+    Setup setup = base_setup;
+    std::mt19937 rng(seed);
+    if (spec.randomize) {
+        randomize(spec, setup, rng);
+    }
+    if (spec.mocap_hz > 0) {
+        setup.loop.mocap_hz = spec.mocap_hz;
+    }
+    
+    // 初期状態（空中開始はホバリング回転数で定常、接地開始は停止）
+    QuadModel model;
+    model.setParams(setup.model);
+    QuadModel::State state;
+    state.position = {spec.initial_x, spec.initial_y, spec.initial_altitude};
+    state.attitude = Quat::fromEuler(0.0, 0.0, spec.initial_yaw);
+    double initial_motor = spec.initial_altitude > 0.0 ? model.hoverDuty() : 0.0;
+    state.motor.fill(initial_motor);
+    model.setState(state);
+    SensorModel sensors;
+    sensors.reset(setup.sensors, static_cast<uint32_t>(rng()));
+    FlightLoop loop;
+    loop.reset(setup.loop, model, sensors);
+    
+    if (csv != nullptr) {
+        fprintf(csv, "time,target_roll,target_pitch,target_yaw,roll,pitch,yaw,est_roll,est_pitch,est_yaw,"
+                     "rate_x,rate_y,rate_z,altitude,est_altitude,target_altitude,duty0,duty1,duty2,duty3,saturation\n");
+    }
+    
+    double sum_attitude = 0.0;
+    double sum_estimate = 0.0;
+    double sum_altitude = 0.0;
+    double sum_altitude_estimate = 0.0;
+    double sum_position_estimate = 0.0;
+    size_t evaluated = 0;
+    size_t saturated = 0;
+    size_t ticks = 0;
+    float max_tilt = 0.0f;
+    float overshoot = 0.0f;
+    double last_unsettled = -1.0;
+    bool crashed = false;
+    LoopRecord record = {};
+    const double period = loop.getControlPeriod();
+    const float step_magnitude = std::fabs(spec.step_value);
+    
+    auto wall_start = std::chrono::steady_clock::now();
+    while (loop.getTime() < spec.duration && !crashed) {
+        double t = loop.getTime();
+        Setpoint setpoint;
+        setpoint.altitude = spec.altitude_target;
+        bool in_step = spec.step_axis >= 0 && t >= spec.step_start && t < spec.step_end;
+        if (in_step) {
+            float* axis[3] = {&setpoint.roll, &setpoint.pitch, &setpoint.yaw};
+            *axis[spec.step_axis] = spec.step_value;
+        }
+        bool disturbed = t >= spec.disturbance_start && t < spec.disturbance_end;
+        model.setDisturbance(disturbed ? spec.disturbance_force : Vec3{}, disturbed ? spec.disturbance_torque : Vec3{});
+        
+        loop.step(setpoint, &record);
+        ticks++;
+        if (csv != nullptr) {
+            fprintf(csv, "%.4f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.5f,%.4f,%.4f,%.4f,%.4f,%.4f,%.3f,"
+                         "%.4f,%.4f,%.4f,%.4f,%u\n", 
+                    record.time, record.target[0], record.target[1], record.target[2], 
+                    record.angle[0], record.angle[1], record.angle[2], 
+                    record.estimate[0], record.estimate[1], record.estimate[2], 
+                    record.rate[0], record.rate[1], record.rate[2], 
+                    record.altitude, record.altitude_estimate, record.altitude_target, 
+                    record.duty[0], record.duty[1], record.duty[2], record.duty[3], 
+                    static_cast<unsigned>(record.saturation));
+        }
+        
+        // 発散・墜落
+        float tilt = std::acos(std::clamp(std::cos(record.angle[0]) * std::cos(record.angle[1]), -1.0f, 1.0f));
+        max_tilt = std::max(max_tilt, tilt);
+        if (!std::isfinite(record.angle[0]) || !std::isfinite(record.altitude_estimate) || tilt > CRASH_TILT) {
+            crashed = true;
+            break;
+        }
+        if (record.saturation != 0) {
+            saturated++;
+        }
+        
+        // 評価区間の誤差
+        if (record.time >= spec.evaluate_from) {
+            if (spec.altitude_target > 0.1f && record.altitude < CRASH_ALTITUDE) {
+                crashed = true;
+                break;
+            }
+            for (size_t a = 0; a < 2; a++) {
+                float e = angleError(record.target[a], record.angle[a]);
+                float est = angleError(record.estimate[a], record.angle[a]);
+                sum_attitude += static_cast<double>(e * e);
+                sum_estimate += static_cast<double>(est * est);
+            }
+            float altitude_error = record.altitude_target - record.altitude;
+            float altitude_estimate_error = record.altitude_estimate - record.altitude;
+            sum_altitude += static_cast<double>(altitude_error * altitude_error);
+            sum_altitude_estimate += static_cast<double>(altitude_estimate_error * altitude_estimate_error);
+            sum_position_estimate += static_cast<double>(record.position_error * record.position_error);
+            evaluated++;
+        }
+        
+        // ステップ応答（目標を保持している区間、制御器が追従する推定角度で評価する）
+        // 傾きを保持すると加速度が重力方向を示さなくなり推定値は真値より小さく出るため、
+        // 真値との差は推定誤差・終了時の誤差として別に評価する
+        if (in_step && step_magnitude > 0.0f) {
+            size_t a = static_cast<size_t>(spec.step_axis);
+            float direction = spec.step_value > 0.0f ? 1.0f : -1.0f;
+            float beyond = angleError(record.estimate[a], record.target[a]) * direction;
+            overshoot = std::max(overshoot, beyond / step_magnitude);
+            if (std::fabs(angleError(record.target[a], record.estimate[a])) > SETTLE_BAND * step_magnitude) {
+                last_unsettled = record.time;
+            }
+        }
+    }
+    auto wall_end = std::chrono::steady_clock::now();
+    
+    ScenarioResult result = {};
+    result.name = spec.name;
+    result.seed = seed;
+    result.sim_time_s = loop.getTime();
+    result.wall_time_s = std::chrono::duration<double>(wall_end - wall_start).count();
+    Metrics& m = result.metrics;
+    double inv_2n = evaluated > 0 ? 1.0 / static_cast<double>(2 * evaluated) : 0.0;
+    double inv_n = evaluated > 0 ? 1.0 / static_cast<double>(evaluated) : 0.0;
+    m.attitude_rms_deg = static_cast<float>(std::sqrt(sum_attitude * inv_2n)) * RAD_TO_DEG;
+    m.estimate_rms_deg = static_cast<float>(std::sqrt(sum_estimate * inv_2n)) * RAD_TO_DEG;
+    m.altitude_rms_m = static_cast<float>(std::sqrt(sum_altitude * inv_n));
+    m.altitude_estimate_rms_m = static_cast<float>(std::sqrt(sum_altitude_estimate * inv_n));
+    m.position_estimate_rms_m = static_cast<float>(std::sqrt(sum_position_estimate * inv_n));
+    m.max_tilt_deg = max_tilt * RAD_TO_DEG;
+    m.overshoot_pct = overshoot * 100.0f;
+    m.settle_s = -1.0f;
+    if (spec.step_axis >= 0 && last_unsettled < spec.step_end - 2.0 * period) {
+        m.settle_s = static_cast<float>(std::max(0.0, last_unsettled + period - spec.step_start));
+    }
+    m.final_error_deg = 0.0f;
+    for (size_t a = 0; a < 2; a++) {
+        m.final_error_deg = std::max(m.final_error_deg, std::fabs(angleError(record.target[a], record.angle[a])) * RAD_TO_DEG);
+    }
+    m.saturation_pct = ticks > 0 ? 100.0f * static_cast<float>(saturated) / static_cast<float>(ticks) : 0.0f;
+    m.crashed = crashed;
+    
+    // 合否
+    const Limits& limits = spec.limits;
+    bool passed = !crashed;
+    if (limits.attitude_rms_deg > 0.0f && m.attitude_rms_deg > limits.attitude_rms_deg) {
+        passed = false;
+    }
+    if (spec.step_axis >= 0 && limits.overshoot_pct > 0.0f && m.overshoot_pct > limits.overshoot_pct) {
+        passed = false;
+    }
+    if (spec.step_axis >= 0 && limits.settle_s > 0.0f && (m.settle_s < 0.0f || m.settle_s > limits.settle_s)) {
+        passed = false;
+    }
+    if (limits.altitude_rms_m > 0.0f && m.altitude_rms_m > limits.altitude_rms_m) {
+        passed = false;
+    }
+    if (limits.estimate_rms_deg > 0.0f && m.estimate_rms_deg > limits.estimate_rms_deg) {
+        passed = false;
+    }
+    if (limits.final_error_deg > 0.0f && m.final_error_deg > limits.final_error_deg) {
+        passed = false;
+    }
+    if (limits.position_estimate_rms_m > 0.0f && m.position_estimate_rms_m > limits.position_estimate_rms_m) {
+        passed = false;
+    }
+    result.passed = passed;
+    return result;
+}
+
+bool setParameter(Setup& setup, const char* name, double value) {
+    for (auto& [key, ref] : bindParameters(setup)) {
+        if (key == name) {
+            if (std::holds_alternative<float*>(ref)) {
+                *std::get<float*>(ref) = static_cast<float>(value);
+            } else {
+                *std::get<double*>(ref) = value;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void printParameters(const Setup& setup, FILE* out) {
+    Setup copy = setup;
+    for (auto& [key, ref] : bindParameters(copy)) {
+        double value = std::holds_alternative<float*>(ref) ? static_cast<double>(*std::get<float*>(ref))
+                                                           : *std::get<double*>(ref);
+        fprintf(out, "  %-24s %g\n", key.c_str(), value);
+    }
+}
+
+} // namespace sim
@@ -0,0 +1,100 @@
+/*
+ * Sensor Model Implementation
+ * 
+ * IMU・ToF・オプティカルフローの観測モデルの実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "sensor_model.hpp"
+#include <cmath>
+
+namespace sim {
+
+void SensorModel::reset(const Config& config, uint32_t seed) {
+    config_ = config;
+    rng_.seed(seed);
+    normal_.reset();
+    gyro_bias_ = {gaussian(config.gyro_bias), gaussian(config.gyro_bias), gaussian(config.gyro_bias)};
+    accel_bias_ = {gaussian(config.accel_bias), gaussian(config.accel_bias), gaussian(config.accel_bias)};
+    std::uniform_real_distribution<double> uniform(0.0, 2.0 * M_PI);
+    for (double& phase : phase_) {
+        phase = uniform(rng_);
+    }
+}
+
+ImuSample SensorModel::sampleImu(const QuadModel& model, double dt) {
+    const QuadModel::State& s = model.getState();
+    const Vec3& f = model.getSpecificForce();
+    
+    // モーター毎の回転周波数で振動（振幅は回転数の2乗に比例）
+    double vib_x = 0.0;
+    double vib_y = 0.0;
+    double vib_z = 0.0;
+    for (size_t i = 0; i < QuadModel::MOTOR_COUNT; i++) {
+        double speed = s.motor[i];
+        phase_[i] = std::fmod(phase_[i] + 2.0 * M_PI * config_.motor_max_hz * speed * dt, 2.0 * M_PI);
+        double amplitude = speed * speed;
+        vib_x += amplitude * std::sin(phase_[i]);
+        vib_y += amplitude * std::cos(phase_[i]);
+        vib_z += amplitude * std::sin(2.0 * phase_[i]);
+    }
+    double scale = 1.0 / static_cast<double>(QuadModel::MOTOR_COUNT);
+    vib_x *= scale;
+    vib_y *= scale;
+    vib_z *= scale;
+    
+    ImuSample sample;
+    sample.gx = static_cast<float>(s.rate.x + gyro_bias_.x + config_.vibration_gyro * vib_x + gaussian(config_.gyro_noise));
+    sample.gy = static_cast<float>(s.rate.y + gyro_bias_.y + config_.vibration_gyro * vib_y + gaussian(config_.gyro_noise));
+    sample.gz = static_cast<float>(s.rate.z + gyro_bias_.z + gaussian(config_.gyro_noise));
+    sample.ax = static_cast<float>(f.x + accel_bias_.x + config_.vibration * vib_x + gaussian(config_.accel_noise));
+    sample.ay = static_cast<float>(f.y + accel_bias_.y + config_.vibration * vib_y + gaussian(config_.accel_noise));
+    sample.az = static_cast<float>(f.z + accel_bias_.z + config_.vibration * vib_z + gaussian(config_.accel_noise));
+    return sample;
+}
+
+float SensorModel::sampleTof(const QuadModel& model) {
+    const QuadModel::State& s = model.getState();
+    // 平坦な地面: 距離 = 高度 / 機体Z軸の鉛直成分
+    double r22 = s.attitude.rotate(Vec3{0.0, 0.0, 1.0}).z;
+    if (r22 <= 0.1) {
+        return 0.0f;
+    }
+    double range = s.position.z / r22 + gaussian(config_.tof_noise);
+    if (range <= 0.0 || range > config_.tof_max_range) {
+        return 0.0f;
+    }
+    return static_cast<float>(range);
+}
+
+bool SensorModel::sampleFlow(const QuadModel& model, float& flow_x, float& flow_y) {
+    const QuadModel::State& s = model.getState();
+    double r22 = s.attitude.rotate(Vec3{0.0, 0.0, 1.0}).z;
+    if (r22 <= 0.5 || s.position.z < 0.05) {
+        return false;
+    }
+    // 並進フロー = 機体XY方向の対地速度 / 機体Z軸方向の距離
+    Vec3 velocity_body = s.attitude.rotateInverse(s.velocity);
+    double distance = s.position.z / r22;
+    flow_x = static_cast<float>(velocity_body.x / distance + gaussian(config_.flow_noise));
+    flow_y = static_cast<float>(velocity_body.y / distance + gaussian(config_.flow_noise));
+    return true;
+}
+
+void SensorModel::sampleMocap(const QuadModel& model, float position[3], float& yaw) {
+    const QuadModel::State& s = model.getState();
+    position[0] = static_cast<float>(s.position.x + gaussian(config_.mocap_noise));
+    position[1] = static_cast<float>(s.position.y + gaussian(config_.mocap_noise));
+    position[2] = static_cast<float>(s.position.z + gaussian(config_.mocap_noise));
+    double roll = 0.0;
+    double pitch = 0.0;
+    double heading = 0.0;
+    s.attitude.toEuler(roll, pitch, heading);
+    yaw = static_cast<float>(heading + gaussian(config_.mocap_yaw_noise));
+}
+
+} // namespace sim
@@ -0,0 +1,167 @@
+/*
+ * Simulator Main
+ * 
+ * ホストシミュレーションのコマンドライン
+ * シナリオを指定回数（シード違い）実行し、1実行1行の "SIM" 行と "SIM_SUMMARY" 行を出力する。
+ * 不合格が1つでもあれば終了コード1（ctestの合否に使う）
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "scenario.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    fprintf(stderr, 
+            "使い方: %s [オプション]\n"
+            "  --scenario NAME   実行するシナリオ（all で全て、既定: all）\n"
+            "  --runs N          シナリオ毎の実行回数（シードを1ずつ変える、既定: 1）\n"
+            "  --seed S          最初の乱数シード（既定: 1）\n"
+            "  --duration T      実行時間の上書き（s）\n"
+            "  --set KEY=VALUE   条件の上書き（複数指定可、--params で一覧）\n"
+            "  --csv FILE        制御周期毎の記録をCSVで出力（1実行のみ）\n"
+            "  --quiet           SIM_SUMMARY 行のみ出力\n"
+            "  --list            シナリオ一覧\n"
+            "  --params          上書きできる項目と既定値の一覧\n", 
+            program);
+}
+
+void printResult(const sim::ScenarioResult& r) {
+    const sim::Metrics& m = r.metrics;
+    printf("SIM %-10s seed=%-6lu %s att_rms=%.2fdeg tilt=%.1fdeg overshoot=%.1f%% settle=%.3fs "
+           "alt_rms=%.3fm est_rms=%.2fdeg est_alt_rms=%.3fm est_pos_rms=%.3fm final=%.2fdeg sat=%.1f%%%s speed=%.0fx\n", 
+           r.name, static_cast<unsigned long>(r.seed), r.passed ? "PASS" : "FAIL", 
+           static_cast<double>(m.attitude_rms_deg), static_cast<double>(m.max_tilt_deg), 
+           static_cast<double>(m.overshoot_pct), static_cast<double>(m.settle_s), 
+           static_cast<double>(m.altitude_rms_m), static_cast<double>(m.estimate_rms_deg), 
+           static_cast<double>(m.altitude_estimate_rms_m), static_cast<double>(m.position_estimate_rms_m), 
+           static_cast<double>(m.final_error_deg), 
+           static_cast<double>(m.saturation_pct), m.crashed ? " CRASH" : "", 
+           r.wall_time_s > 0.0 ? r.sim_time_s / r.wall_time_s : 0.0);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* scenario_name = "all";
+    const char* csv_path = nullptr;
+    unsigned long runs = 1;
+    unsigned long seed = 1;
+    double duration = 0.0;
+    bool quiet = false;
+    sim::Setup setup;
+    
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (strcmp(arg, "--scenario") == 0 && value != nullptr) {
+            scenario_name = value;
+            i++;
+        } else if (strcmp(arg, "--runs") == 0 && value != nullptr) {
+            runs = strtoul(value, nullptr, 0);
+            i++;
+        } else if (strcmp(arg, "--seed") == 0 && value != nullptr) {
+            seed = strtoul(value, nullptr, 0);
+            i++;
+        } else if (strcmp(arg, "--duration") == 0 && value != nullptr) {
+            duration = strtod(value, nullptr);
+            i++;
+        } else if (strcmp(arg, "--csv") == 0 && value != nullptr) {
+            csv_path = value;
+            i++;
+        } else if (strcmp(arg, "--set") == 0 && value != nullptr) {
+            const char* equal = strchr(value, '=');
+            if (equal == nullptr) {
+                fprintf(stderr, "--set の形式は KEY=VALUE: %s\n", value);
+                return 2;
+            }
+            std::string key(value, static_cast<size_t>(equal - value));
+            if (!sim::setParameter(setup, key.c_str(), strtod(equal + 1, nullptr))) {
+                fprintf(stderr, "不明な項目: %s（--params で一覧）\n", key.c_str());
+                return 2;
+            }
+            i++;
+        } else if (strcmp(arg, "--quiet") == 0) {
+            quiet = true;
+        } else if (strcmp(arg, "--list") == 0) {
+            size_t count = 0;
+            const sim::ScenarioSpec* table = sim::scenarios(count);
+            for (size_t s = 0; s < count; s++) {
+                printf("  %-12s %s\n", table[s].name, table[s].description);
+            }
+            return 0;
+        } else if (strcmp(arg, "--params") == 0) {
+            sim::printParameters(setup, stdout);
+            return 0;
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    
+    std::vector<const sim::ScenarioSpec*> selected;
+    size_t count = 0;
+    const sim::ScenarioSpec* table = sim::scenarios(count);
+    if (strcmp(scenario_name, "all") == 0) {
+        for (size_t s = 0; s < count; s++) {
+            selected.push_back(&table[s]);
+        }
+    } else {
+        const sim::ScenarioSpec* spec = sim::findScenario(scenario_name);
+        if (spec == nullptr) {
+            fprintf(stderr, "不明なシナリオ: %s（--list で一覧）\n", scenario_name);
+            return 2;
+        }
+        selected.push_back(spec);
+    }
+    
+    FILE* csv = nullptr;
+    if (csv_path != nullptr) {
+        if (selected.size() != 1 || runs != 1) {
+            fprintf(stderr, "--csv は1シナリオ・1実行のみ\n");
+            return 2;
+        }
+        csv = fopen(csv_path, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "CSVを開けない: %s\n", csv_path);
+            return 2;
+        }
+    }
+    
+    unsigned long passed = 0;
+    unsigned long total = 0;
+    double sim_time = 0.0;
+    double wall_time = 0.0;
+    for (const sim::ScenarioSpec* base : selected) {
+        sim::ScenarioSpec spec = *base;
+        if (duration > 0.0) {
+            spec.duration = duration;
+        }
+        for (unsigned long r = 0; r < runs; r++) {
+            sim::ScenarioResult result = sim::runScenario(spec, setup, static_cast<uint32_t>(seed + r), csv);
+            if (!quiet || !result.passed) {
+                printResult(result);
+            }
+            total++;
+            passed += result.passed ? 1 : 0;
+            sim_time += result.sim_time_s;
+            wall_time += result.wall_time_s;
+        }
+    }
+    if (csv != nullptr) {
+        fclose(csv);
+    }
+    
+    printf("SIM_SUMMARY runs=%lu pass=%lu fail=%lu sim=%.1fs wall=%.2fs speed=%.0fx\n", 
+           total, passed, total - passed, sim_time, wall_time, wall_time > 0.0 ? sim_time / wall_time : 0.0);
+    return passed == total ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+"""
+Compare Profiles
+
+2つのビルド（サイズ優先・飛行用プロファイル等）のベンチマーク結果を並べ、
+計測毎の中央値（cycles_p50）の比とイメージ・セクションサイズの差を表にする。
+入力は pytest_bench.py が書き出す bench_results.json（同じ場所の *_build.json も読む）。
+
+使い方:
+    test_bench/compare_profiles.py size/bench_results.json flight/bench_results.json
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+
+def load(path):
+    results = json.loads(Path(path).read_text(encoding="utf-8"))
+    build_path = Path(path).with_name(Path(path).stem + "_build.json")
+    build = json.loads(build_path.read_text(encoding="utf-8")) if build_path.exists() else {}
+    return results, build
+
+
+def label(build, fallback):
+    if "flight_profile" not in build:
+        return fallback
+    return "flight" if build["flight_profile"] else "size"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ビルドプロファイル間のベンチマーク比較")
+    parser.add_argument("base", help="基準のbench_results.json（サイズ優先）")
+    parser.add_argument("other", help="比較するbench_results.json（飛行用プロファイル）")
+    args = parser.parse_args()
+
+    base, base_build = load(args.base)
+    other, other_build = load(args.other)
+    base_label = label(base_build, "base")
+    other_label = label(other_build, "other")
+
+    print("%-32s %10s %10s %8s" % ("計測", base_label, other_label, "速度比"))
+    ratios = []
+    for name in sorted(set(base) & set(other)):
+        a = base[name]["cycles_p50"]
+        b = other[name]["cycles_p50"]
+        ratio = a / b if b > 0 else 0.0
+        ratios.append(ratio)
+        print("%-32s %10d %10d %7.2fx" % (name, a, b, ratio))
+    if ratios:
+        product = 1.0
+        for ratio in ratios:
+            product *= ratio
+        print("%-32s %21s %7.2fx" % ("幾何平均", "", product ** (1.0 / len(ratios))))
+
+    base_sections = base_build.get("sections", {})
+    other_sections = other_build.get("sections", {})
+    rows = [("image", base_build.get("image_size"), other_build.get("image_size"))]
+    for section in sorted(set(base_sections) | set(other_sections)):
+        rows.append((section, base_sections.get(section), other_sections.get(section)))
+    if any(a is not None and b is not None for _, a, b in rows):
+        print()
+        print("%-32s %10s %10s %8s" % ("サイズ（バイト）", base_label, other_label, "差"))
+        for name, a, b in rows:
+            if a is None or b is None:
+                continue
+            print("%-32s %10d %10d %+8d" % (name, a, b, b - a))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,111 @@
+/*
+ * Bench
+ * 
+ * HAL・演算カーネルのベンチマーク計測（サイクル数・実時間）
+ * 結果は "BENCH {JSON}" の1行で出力し、pytest_bench.py が収集する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include "esp_cpu.h"
+#include "esp_timer.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace bench {
+
+static constexpr size_t MAX_ITERATIONS = 4096;      // 1計測の最大反復回数（サイクル記録領域）
+static constexpr size_t DEFAULT_WARMUP = 16;        // 計測前の空回し（キャッシュ・ドライバの初回処理）
+
+/**
+ * @brief 計測結果構造体
+ * 
+ * サイクル数は計測自体の負荷（空の計測の最小値）を差し引いた値。
+ * 割り込み・タスク切り替えを含むため、回帰の比較には p50 を使う
+ */
+struct Result {
+    const char* name;           // 計測対象
+    uint32_t iterations;        // 反復回数
+    uint32_t cycles_min;        // 最小サイクル数
+    uint32_t cycles_p50;        // 中央値
+    uint32_t cycles_p99;        // 99パーセンタイル
+    uint32_t cycles_max;        // 最大
+    float cycles_mean;          // 平均
+    float us_mean;              // 1回あたりの実時間（μs、ループ全体から）
+};
+
+/**
+ * @brief サイクル記録領域（MAX_ITERATIONS要素）
+ */
+uint32_t* cycleBuffer();
+
+/**
+ * @brief 計測自体の負荷（サイクル数、初回呼び出しで計測）
+ */
+uint32_t overheadCycles();
+
+/**
+ * @brief 記録したサイクル数の集計
+ * @param name 計測対象
+ * @param cycles サイクル数（並べ替える）
+ * @param count 反復回数
+ * @param elapsed_us ループ全体の実時間（μs）
+ */
+Result summarize(const char* name, uint32_t* cycles, size_t count, int64_t elapsed_us);
+
+/**
+ * @brief 結果の出力（"BENCH {JSON}" の1行）
+ */
+void report(const Result& result);
+
+/**
+ * @brief 1回毎にサイクル数を計測して集計する
+ * @param name 計測対象（JSONのキーになるため英数字と_のみ）
+ * @param iterations 反復回数（MAX_ITERATIONSまで）
+ * @param step 計測する処理（引数は反復番号）
+ * @param warmup 計測前の空回し回数
+ * @return Result 計測結果
+ */
+template<typename Step>
+Result measure(const char* name, size_t iterations, Step&& step, size_t warmup = DEFAULT_WARMUP) {
+    if (iterations == 0) {
+        iterations = 1;
+    }
+    if (iterations > MAX_ITERATIONS) {
+        iterations = MAX_ITERATIONS;
+    }
+    for (size_t i = 0; i < warmup; i++) {
+        step(i);
+    }
+    uint32_t* cycles = cycleBuffer();
+    uint32_t overhead = overheadCycles();
+    int64_t start_us = esp_timer_get_time();
+    for (size_t i = 0; i < iterations; i++) {
+        uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+        step(i);
+        uint32_t elapsed = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+        cycles[i] = elapsed > overhead ? elapsed - overhead : 0;
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    return summarize(name, cycles, iterations, elapsed_us);
+}
+
+/**
+ * @brief 計測して出力する
+ */
+template<typename Step>
+Result run(const char* name, size_t iterations, Step&& step, size_t warmup = DEFAULT_WARMUP) {
+    Result result = measure(name, iterations, static_cast<Step&&>(step), warmup);
+    report(result);
+    return result;
+}
+
+} // namespace bench
+
+#endif // BENCH_HPP
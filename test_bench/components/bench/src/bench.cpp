@@ -0,0 +1,74 @@
+/*
+ * Bench Implementation
+ * 
+ * HAL・演算カーネルのベンチマーク計測実装
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bench.hpp"
+#include "esp_clk_tree.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace bench {
+
+static uint32_t cycle_buffer[MAX_ITERATIONS];      // サイクル記録領域（計測は1タスクから）
+
+uint32_t* cycleBuffer() {
+    return cycle_buffer;
+}
+
+uint32_t overheadCycles() {
+    static uint32_t overhead = UINT32_MAX;
+    if (overhead == UINT32_MAX) {
+        // 空の計測の最小値（割り込みの影響を受けない値）
+        uint32_t minimum = UINT32_MAX;
+        for (size_t i = 0; i < 256; i++) {
+            uint32_t start_cycles = static_cast<uint32_t>(esp_cpu_get_cycle_count());
+            uint32_t elapsed = static_cast<uint32_t>(esp_cpu_get_cycle_count()) - start_cycles;
+            minimum = std::min(minimum, elapsed);
+        }
+        overhead = minimum;
+    }
+    return overhead;
+}
+
+Result summarize(const char* name, uint32_t* cycles, size_t count, int64_t elapsed_us) {
+    Result result = {};
+    result.name = name;
+    result.iterations = static_cast<uint32_t>(count);
+    if (count == 0) {
+        return result;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += cycles[i];
+    }
+    std::sort(cycles, cycles + count);
+    result.cycles_min = cycles[0];
+    result.cycles_p50 = cycles[count / 2];
+    result.cycles_p99 = cycles[std::min(count - 1, count * 99 / 100)];
+    result.cycles_max = cycles[count - 1];
+    result.cycles_mean = static_cast<float>(total) / static_cast<float>(count);
+    result.us_mean = static_cast<float>(elapsed_us) / static_cast<float>(count);
+    return result;
+}
+
+void report(const Result& result) {
+    uint32_t cpu_hz = 0;
+    esp_clk_tree_src_get_freq_hz(SOC_MOD_CLK_CPU, ESP_CLK_TREE_SRC_FREQ_PRECISION_CACHED, &cpu_hz);
+    // ログの接頭辞が付かないよう printf で出力する
+    printf("BENCH {\"name\":\"%s\",\"iterations\":%lu,\"cycles_min\":%lu,\"cycles_p50\":%lu,"
+           "\"cycles_p99\":%lu,\"cycles_max\":%lu,\"cycles_mean\":%.1f,\"us_mean\":%.3f,\"cpu_mhz\":%lu}\n", 
+           result.name, static_cast<unsigned long>(result.iterations), 
+           static_cast<unsigned long>(result.cycles_min), static_cast<unsigned long>(result.cycles_p50), 
+           static_cast<unsigned long>(result.cycles_p99), static_cast<unsigned long>(result.cycles_max), 
+           static_cast<double>(result.cycles_mean), static_cast<double>(result.us_mean), 
+           static_cast<unsigned long>(cpu_hz / 1000000));
+}
+
+} // namespace bench
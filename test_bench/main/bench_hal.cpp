@@ -0,0 +1,149 @@
+/*
+ * Bench HAL
+ * 
+ * HALの1回あたりのコスト計測（実機のバス・周辺回路を使用）
+ * I2C・SPIはStampFly搭載のBMP280・BMI270のチップIDを読む
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bench.hpp"
+#include "adc_hal.hpp"
+#include "i2c_hal.hpp"
+#include "pwm_hal.hpp"
+#include "spi_hal.hpp"
+#include "sdkconfig.h"
+#include "unity.h"
+
+namespace {
+
+constexpr size_t HAL_ITERATIONS = 1000;             // HALの反復回数（バス転送を含むため少なめ）
+
+} // namespace
+
+TEST_CASE("i2c_read_register", "[hal]") {
+    hal::I2cHal i2c(I2C_NUM_0);
+    hal::I2cHal::Config config = {};
+    config.port = I2C_NUM_0;
+    config.mode = hal::I2cHal::Mode::MASTER;
+    config.sda_pin = static_cast<gpio_num_t>(CONFIG_BENCH_I2C_SDA);
+    config.scl_pin = static_cast<gpio_num_t>(CONFIG_BENCH_I2C_SCL);
+    config.frequency = 400000;
+    config.sda_pullup_enable = true;
+    config.scl_pullup_enable = true;
+    config.use_static_cmd_link = true;
+    config.async_queue_depth = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c.setConfig(config));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c.initialize());
+    TEST_ASSERT_EQUAL(ESP_OK, i2c.start());
+#if HAL_I2C_USE_MASTER_DRIVER
+    TEST_ASSERT_EQUAL(ESP_OK, i2c.addDevice(CONFIG_BENCH_I2C_ADDRESS));
+#endif
+    
+    uint8_t value = 0;
+    esp_err_t ret = ESP_OK;
+    bench::run("i2c_read_register", HAL_ITERATIONS, [&](size_t) {
+        esp_err_t result = i2c.readRegister(CONFIG_BENCH_I2C_ADDRESS, CONFIG_BENCH_I2C_REGISTER, &value, 1);
+        if (result != ESP_OK) {
+            ret = result;
+        }
+    });
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    i2c.stop();
+}
+
+TEST_CASE("spi_transmit", "[hal]") {
+    hal::SpiHal spi(SPI2_HOST);
+    hal::SpiHal::Config config = {};
+    config.host = SPI2_HOST;
+    config.mosi_pin = static_cast<gpio_num_t>(CONFIG_BENCH_SPI_MOSI);
+    config.miso_pin = static_cast<gpio_num_t>(CONFIG_BENCH_SPI_MISO);
+    config.sclk_pin = static_cast<gpio_num_t>(CONFIG_BENCH_SPI_SCLK);
+    config.cs_pin = static_cast<gpio_num_t>(CONFIG_BENCH_SPI_CS);     // addDevice()のCSに使われる
+    config.max_transfer_size = 4096;
+    config.dma_channel = SPI_DMA_CH_AUTO;
+    config.queue_size = 7;
+    config.dma_pool_size = 4;
+    config.dma_buffer_size = 64;
+    TEST_ASSERT_EQUAL(ESP_OK, spi.setConfig(config));
+    TEST_ASSERT_EQUAL(ESP_OK, spi.initialize());
+    TEST_ASSERT_EQUAL(ESP_OK, spi.start());
+    
+    hal::SpiHal::DeviceConfig device_config = {};
+    device_config.frequency = 10000000;
+    device_config.mode = hal::SpiHal::SpiMode::MODE0;
+    device_config.use_polling = false;
+    spi_device_handle_t device = nullptr;
+    TEST_ASSERT_EQUAL(ESP_OK, spi.addDevice(device_config, device));
+    
+    // BMI270のチップID（0x00）読み取り: アドレス + ダミー + データ
+    hal::SpiHal::Transaction transaction = {};
+    transaction.tx_data = {0x80, 0x00, 0x00};
+    transaction.rx_data.resize(3);
+    transaction.length = 3 * 8;
+    esp_err_t ret = ESP_OK;
+    bench::run("spi_transmit", HAL_ITERATIONS, [&](size_t) {
+        esp_err_t result = spi.transmit(device, transaction);
+        if (result != ESP_OK) {
+            ret = result;
+        }
+    });
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    spi.removeDevice(device);
+    spi.stop();
+}
+
+TEST_CASE("adc_read", "[hal]") {
+    hal::AdcHal adc(hal::AdcHal::Unit::UNIT_1);
+    TEST_ASSERT_EQUAL(ESP_OK, adc.initialize());
+    hal::AdcHal::ChannelConfig channel_config = {};
+    channel_config.channel = static_cast<adc_channel_t>(CONFIG_BENCH_ADC_CHANNEL);
+    channel_config.attenuation = hal::AdcHal::Attenuation::DB_11;
+    channel_config.calibration_enable = true;
+    TEST_ASSERT_EQUAL(ESP_OK, adc.configureChannel(channel_config));
+    TEST_ASSERT_EQUAL(ESP_OK, adc.start());
+    
+    hal::AdcHal::ReadResult result = {};
+    esp_err_t ret = ESP_OK;
+    bench::run("adc_read", HAL_ITERATIONS, [&](size_t) {
+        esp_err_t read_result = adc.read(channel_config.channel, result);
+        if (read_result != ESP_OK) {
+            ret = read_result;
+        }
+    });
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    adc.stop();
+}
+
+TEST_CASE("pwm_set_duty", "[hal]") {
+    hal::PwmHal pwm;
+    TEST_ASSERT_EQUAL(ESP_OK, pwm.initialize());
+    hal::PwmHal::TimerConfig timer_config = {};
+    timer_config.timer_num = LEDC_TIMER_3;
+    timer_config.speed_mode = hal::PwmHal::SpeedMode::LOW_SPEED;
+    timer_config.resolution = hal::PwmHal::Resolution::BITS_10;
+    timer_config.frequency = 20000;
+    timer_config.clk_cfg = LEDC_AUTO_CLK;
+    TEST_ASSERT_EQUAL(ESP_OK, pwm.configureTimer(timer_config));
+    hal::PwmHal::ChannelConfig channel_config = {};
+    channel_config.channel = LEDC_CHANNEL_7;
+    channel_config.timer_sel = LEDC_TIMER_3;
+    channel_config.speed_mode = hal::PwmHal::SpeedMode::LOW_SPEED;
+    channel_config.gpio_num = static_cast<gpio_num_t>(CONFIG_BENCH_PWM_GPIO);
+    channel_config.duty = 0;
+    channel_config.hpoint = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, pwm.configureChannel(channel_config));
+    
+    esp_err_t ret = ESP_OK;
+    bench::run("pwm_set_duty", HAL_ITERATIONS, [&](size_t i) {
+        esp_err_t result = pwm.setDuty(LEDC_CHANNEL_7, hal::PwmHal::SpeedMode::LOW_SPEED, static_cast<uint32_t>(i & 0x3FF));
+        if (result != ESP_OK) {
+            ret = result;
+        }
+    });
+    TEST_ASSERT_EQUAL(ESP_OK, ret);
+    pwm.stopOutput(LEDC_CHANNEL_7, hal::PwmHal::SpeedMode::LOW_SPEED, 0);
+}
@@ -0,0 +1,26 @@
+/*
+ * Bench Main
+ * 
+ * ベンチマークアプリのエントリポイント
+ * Unityの全テストケース（[hal]・[math]）を実行し、終了を "BENCH_DONE" で知らせる
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "unity.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstdio>
+
+extern "C" void app_main(void) {
+    // 起動ログの出力が終わるまで待つ
+    vTaskDelay(pdMS_TO_TICKS(500));
+    printf("BENCH_PROFILE %s\n", STAMPFLY_FLIGHT_PROFILE ? "flight" : "size");
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+    printf("BENCH_DONE\n");
+}
@@ -0,0 +1,155 @@
+/*
+ * Bench Math
+ * 
+ * 制御ループの演算カーネルの1回あたりのコスト計測
+ * フィルタは1ブロック（制御1周期分）、推定器・制御器は1ステップを計測する
+ * 
+ * 作成者: Kouhei Ito
+ * ライセンス: MIT License
+ * 
+ * Copyright (c) 2025 Kouhei Ito
+ */
+
+#include "bench.hpp"
+#include "attitude_estimator.hpp"
+#include "cascaded_pid.hpp"
+#include "dsp_filters.hpp"
+#include "error_state_ekf.hpp"
+#include "mixer.hpp"
+#include "notch_bank.hpp"
+#include "unity.h"
+#include <cmath>
+
+namespace {
+
+constexpr size_t MATH_ITERATIONS = 4096;            // 演算の反復回数
+constexpr float SAMPLE_HZ = 1600.0f;                // IMUサンプリング周波数（Hz）
+constexpr size_t BLOCK = 16;                        // 1ブロックのサンプル数（IMU FIFOの1回分）
+
+/**
+ * @brief 計測入力（振動を含むジャイロ波形）
+ */
+void fillSignal(float* data, size_t length, size_t offset) {
+    for (size_t i = 0; i < length; i++) {
+        float t = static_cast<float>(offset + i) / SAMPLE_HZ;
+        data[i] = 0.2f * sinf(2.0f * static_cast<float>(M_PI) * 3.0f * t)
+                + 0.05f * sinf(2.0f * static_cast<float>(M_PI) * 230.0f * t);
+    }
+}
+
+} // namespace
+
+TEST_CASE("biquad_lowpass_x2_block", "[math]") {
+    common::BiquadCascade<2, 3> filter;
+    filter.setStage(0, common::BiquadCoefficients::lowpass(90.0f, SAMPLE_HZ));
+    filter.setStage(1, common::BiquadCoefficients::lowpass(90.0f, SAMPLE_HZ));
+    static float input[BLOCK];
+    static float output[BLOCK];
+    fillSignal(input, BLOCK, 0);
+    bench::run("biquad_lowpass_x2_block", MATH_ITERATIONS, [&](size_t i) {
+        filter.process(i % 3, input, output, BLOCK);
+    });
+    bench::run("biquad_lowpass_x2_block_reference", MATH_ITERATIONS, [&](size_t i) {
+        filter.processReference(i % 3, input, output, BLOCK);
+    });
+    TEST_ASSERT_FALSE(std::isnan(output[BLOCK - 1]));
+}
+
+TEST_CASE("fir16_block", "[math]") {
+    float taps[16];
+    for (size_t i = 0; i < 16; i++) {
+        taps[i] = 1.0f / 16.0f;
+    }
+    common::FirFilter<16, 3> filter(taps);
+    static float input[BLOCK];
+    static float output[BLOCK];
+    fillSignal(input, BLOCK, 0);
+    bench::run("fir16_block", MATH_ITERATIONS, [&](size_t i) {
+        filter.process(i % 3, input, output, BLOCK);
+    });
+    TEST_ASSERT_FALSE(std::isnan(output[BLOCK - 1]));
+}
+
+TEST_CASE("rpm_notch_bank", "[math]") {
+    common::RpmNotchBank<4, 2, 3> bank;
+    common::RpmNotchBank<4, 2, 3>::Config config;
+    config.sample_hz = SAMPLE_HZ;
+    bank.setConfig(config);
+    static float input[BLOCK];
+    static float output[BLOCK];
+    fillSignal(input, BLOCK, 0);
+    // 回転数が変化し続ける条件（係数の再計算を含む）
+    bench::run("rpm_notch_bank_update_process", MATH_ITERATIONS, [&](size_t i) {
+        for (size_t m = 0; m < 4; m++) {
+            bank.setFrequency(m, 180.0f + static_cast<float>((i + m * 7) % 64));
+        }
+        bank.update();
+        bank.process(i % 3, input, output, BLOCK);
+    });
+    TEST_ASSERT_FALSE(std::isnan(output[BLOCK - 1]));
+}
+
+TEST_CASE("attitude_estimator_update", "[math]") {
+    estimation::AttitudeEstimator estimator;
+    estimator.alignToGravity(0.0f, 0.0f, estimation::AttitudeEstimator::GRAVITY);
+    static float gx[BLOCK], gy[BLOCK], gz[BLOCK], ax[BLOCK], ay[BLOCK], az[BLOCK];
+    fillSignal(gx, BLOCK, 0);
+    fillSignal(gy, BLOCK, 5);
+    fillSignal(gz, BLOCK, 11);
+    for (size_t i = 0; i < BLOCK; i++) {
+        ax[i] = 0.1f * gy[i];
+        ay[i] = -0.1f * gx[i];
+        az[i] = estimation::AttitudeEstimator::GRAVITY;
+    }
+    const float dt = 1.0f / SAMPLE_HZ;
+    bench::run("attitude_estimator_update_1", MATH_ITERATIONS, [&](size_t i) {
+        size_t k = i % BLOCK;
+        estimator.update(&gx[k], &gy[k], &gz[k], &ax[k], &ay[k], &az[k], 1, dt);
+    });
+    bench::run("attitude_estimator_update_block", MATH_ITERATIONS, [&](size_t) {
+        estimator.update(gx, gy, gz, ax, ay, az, BLOCK, dt);
+    });
+    TEST_ASSERT_FALSE(std::isnan(estimator.getQuaternion().w));
+}
+
+TEST_CASE("error_state_ekf", "[math]") {
+    estimation::ErrorStateEkf ekf;
+    ekf.reset(estimation::Quaternion{1.0f, 0.0f, 0.0f, 0.0f}, 0.0f);
+    const float dt = 1.0f / 400.0f;
+    bench::run("ekf_predict", MATH_ITERATIONS, [&](size_t i) {
+        float wobble = 0.01f * static_cast<float>(i % 16);
+        ekf.predict(wobble, -wobble, 0.0f, 0.0f, 0.0f, estimation::AttitudeEstimator::GRAVITY, dt);
+    });
+    bench::run("ekf_fuse_tof", MATH_ITERATIONS, [&](size_t i) {
+        ekf.fuseTofRange(0.5f + 0.001f * static_cast<float>(i % 32));
+    });
+    TEST_ASSERT_FALSE(std::isnan(ekf.getQuaternion().w));
+}
+
+TEST_CASE("cascaded_pid_step", "[math]") {
+    control::CascadedPid<3> pid;
+    float angle_target[3] = {0.1f, -0.05f, 0.0f};
+    float angle[3] = {0.0f, 0.0f, 0.0f};
+    float rate[3] = {0.0f, 0.0f, 0.0f};
+    float output[3] = {};
+    bench::run("cascaded_pid_step", MATH_ITERATIONS, [&](size_t) {
+        pid.compute(angle_target, angle, rate, output);
+        // 出力を入力へ戻して毎回異なる値で計算させる
+        for (size_t a = 0; a < 3; a++) {
+            rate[a] += 0.001f * output[a];
+        }
+    });
+    TEST_ASSERT_FALSE(std::isnan(output[0]));
+}
+
+TEST_CASE("mixer_quad_x", "[math]") {
+    control::Mixer<control::QuadXFrame> mixer;
+    control::Mixer<control::QuadXFrame>::Output output = {};
+    bench::run("mixer_quad_x", MATH_ITERATIONS, [&](size_t i) {
+        // 飽和あり・なしを交互に通す
+        float scale = (i & 1) ? 0.2f : 1.5f;
+        control::MixerCommand command = {0.3f * scale, -0.2f * scale, 0.1f * scale, 0.5f};
+        mixer.mix(command, output);
+    });
+    TEST_ASSERT_FALSE(std::isnan(output[0]));
+}
@@ -0,0 +1,129 @@
+# StampFly ベンチマークの収集
+#
+# ベンチマークアプリの "BENCH {JSON}" 行を集めて bench_results.json に書き出し、
+# bench_baseline.json があれば中央値（cycles_p50）の回帰を検査する。
+#
+# 実行例:
+#   pytest test_bench --target esp32s3 --port /dev/ttyACM0
+#   BENCH_TOLERANCE=0.05 pytest test_bench --target esp32s3
+#
+# ビルドの情報（プロファイル・イメージサイズ・セクションサイズ）は bench_results_build.json に書き出す。
+# サイズ優先と飛行用プロファイルの比較は compare_profiles.py で行う（README参照）
+#
+# 作成者: Kouhei Ito
+# ライセンス: MIT License
+#
+# Copyright (c) 2025 Kouhei Ito
+import json
+import logging
+import os
+import struct
+from pathlib import Path
+from typing import Callable, Dict, Optional
+
+import pytest
+from pytest_embedded_idf.dut import IdfDut
+
+BENCH_PATTERN = r'BENCH (\{.*\})\r?\n'
+DONE_PATTERN = r'BENCH_DONE'
+UNITY_SUMMARY_PATTERN = r'(\d+) Tests (\d+) Failures (\d+) Ignored'
+
+BASELINE_FILE = Path(__file__).parent / 'bench_baseline.json'
+
+# 配置の比較に使うセクション（IRAM・DRAM・フラッシュ）
+SIZE_SECTIONS = ('.iram0.text', '.dram0.data', '.dram0.bss', '.flash.text', '.flash.rodata')
+
+
+def section_sizes(elf_path: Path) -> Dict[str, int]:
+    """ELF（32bitリトルエンディアン）のセクションサイズ"""
+    data = elf_path.read_bytes()
+    shoff, = struct.unpack_from('<I', data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+    headers = [struct.unpack_from('<10I', data, shoff + i * shentsize) for i in range(shnum)]
+    strtab = headers[shstrndx][4]
+    sizes = {}
+    for header in headers:
+        name_offset = strtab + header[0]
+        name = data[name_offset:data.index(b'\0', name_offset)].decode('ascii')
+        if name in SIZE_SECTIONS:
+            sizes[name] = header[5]
+    return sizes
+
+
+def build_info(dut: IdfDut) -> Dict[str, object]:
+    """ビルドディレクトリからプロファイル・イメージサイズ・セクションサイズを読む"""
+    build_dir = Path(dut.app.binary_path)
+    info: Dict[str, object] = {'build_dir': str(build_dir), 'flight_profile': False}
+    cache = build_dir / 'CMakeCache.txt'
+    if cache.exists():
+        for line in cache.read_text(encoding='utf-8', errors='replace').splitlines():
+            if line.startswith('STAMPFLY_FLIGHT_PROFILE:'):
+                info['flight_profile'] = line.split('=', 1)[1].strip().upper() in ('ON', '1', 'TRUE', 'YES')
+    elf: Optional[str] = getattr(dut.app, 'elf_file', None)
+    if elf and Path(elf).exists():
+        info['sections'] = section_sizes(Path(elf))
+        binary = Path(elf).with_suffix('.bin')
+        if binary.exists():
+            info['image_size'] = binary.stat().st_size
+    return info
+
+
+def collect_results(dut: IdfDut) -> Dict[str, dict]:
+    """BENCH_DONE までの計測結果を名前毎に集める"""
+    results: Dict[str, dict] = {}
+    failures = 0
+    while True:
+        match = dut.expect([BENCH_PATTERN, UNITY_SUMMARY_PATTERN, DONE_PATTERN], timeout=120)
+        if match.re.pattern == DONE_PATTERN:
+            break
+        if match.re.pattern == UNITY_SUMMARY_PATTERN:
+            failures = int(match.group(2))
+            continue
+        result = json.loads(match.group(1).decode('utf-8'))
+        results[result['name']] = result
+        logging.info('%s: p50 %d サイクル（%.3f us）', result['name'], result['cycles_p50'], result['us_mean'])
+    assert failures == 0, f'Unityのテストケースが{failures}件失敗しました'
+    return results
+
+
+def check_regressions(results: Dict[str, dict], tolerance: float) -> list:
+    """基準値より中央値が tolerance を超えて増えた計測の一覧"""
+    if not BASELINE_FILE.exists():
+        logging.info('基準値なし（%s）: 回帰の検査を省略', BASELINE_FILE)
+        return []
+    baseline = json.loads(BASELINE_FILE.read_text(encoding='utf-8'))
+    regressions = []
+    for name, result in results.items():
+        reference = baseline.get(name)
+        if reference is None:
+            continue
+        limit = reference['cycles_p50'] * (1.0 + tolerance)
+        if result['cycles_p50'] > limit:
+            regressions.append(f"{name}: {result['cycles_p50']} > {reference['cycles_p50']} (+{tolerance:.0%})")
+    return regressions
+
+
+@pytest.mark.esp32s3
+@pytest.mark.generic
+def test_bench(dut: IdfDut, record_property: Callable[[str, object], None]) -> None:
+    results = collect_results(dut)
+    assert results, '計測結果がありません'
+
+    # CIの収集用（JUnit XMLのプロパティとJSONファイル）
+    for name, result in results.items():
+        record_property(f'{name}_cycles_p50', result['cycles_p50'])
+        record_property(f'{name}_us_mean', result['us_mean'])
+    output = Path(os.environ.get('BENCH_RESULTS', Path(dut.logdir) / 'bench_results.json'))
+    output.write_text(json.dumps(results, indent=2, sort_keys=True), encoding='utf-8')
+    logging.info('計測結果: %s', output)
+    build = build_info(dut)
+    build_output = output.with_name(output.stem + '_build.json')
+    build_output.write_text(json.dumps(build, indent=2, sort_keys=True), encoding='utf-8')
+    record_property('flight_profile', build['flight_profile'])
+    if 'image_size' in build:
+        record_property('image_size', build['image_size'])
+    logging.info('ビルド情報: %s（飛行用プロファイル %s）', build_output, build['flight_profile'])
+
+    tolerance = float(os.environ.get('BENCH_TOLERANCE', '0.10'))
+    regressions = check_regressions(results, tolerance)
+    assert not regressions, '回帰: ' + ', '.join(regressions)
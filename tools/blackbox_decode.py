@@ -0,0 +1,352 @@
+#!/usr/bin/env python3
+"""
+Blackbox Decode
+
+logsパーティションのイメージからブラックボックスの記録を復号し、物理量のCSV（またはParquet）に書き出す。
+ブロックヘッダのスキーマ（フィールド名・分解能・予測方法）に従って復号するため、
+ファームウェアでフィールドや予測方法を変えてもこのスクリプトは変更不要。版1〜3のブロックを読める。
+
+各ブロックは先頭フレームが予測なし（キーフレーム）で単体で復号でき、CRCの合わないレコードは飛ばす。
+列は time_us（起動からの時刻、32bitの折り返しは展開する）、synced_us（同期時刻、未同期のブロックは空）、
+スキーマの各フィールド（値 × 分解能、--raw で整数のまま）。
+
+使い方:
+    parttool.py read_partition --partition-name logs --output logs.bin
+    tools/blackbox_decode.py logs.bin --list
+    tools/blackbox_decode.py logs.bin --output flight.csv
+    tools/blackbox_decode.py logs.bin --session 3 --output flight.parquet   （pyarrowが必要）
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import zlib
+
+# partition_log.hpp・blackbox_format.hpp と同じ形式
+SECTOR_SIZE = 4096
+LOG_HEADER = struct.Struct("<6I2I")
+LOG_MAGIC = 0x31474C50
+BLOCK_HEADER = struct.Struct("<IHH6I")
+BLOCK_HEADER_V2 = struct.Struct("<IHH6IIiq")
+BLOCK_MAGIC = 0x31584242
+SYNC_VALID = 0x01
+SCHEMA_PRESENT = 0x02
+SCHEMA_HEADER = struct.Struct("<BBBB")
+FIELD_DEF = struct.Struct("<11sBf")
+
+# BlackboxPredictor
+PREDICTOR_ZERO = 0
+PREDICTOR_PREVIOUS = 1
+PREDICTOR_LINEAR = 2
+PREDICTOR_AVERAGE_2 = 3
+
+
+class Schema:
+    """フィールド定義（名前・予測方法・分解能）と時刻の予測方法"""
+
+    def __init__(self, fields, time_predictor):
+        self.fields = fields
+        self.time_predictor = time_predictor
+
+    @property
+    def names(self):
+        return [name for name, _, _ in self.fields]
+
+
+# 版1・2の記録（スキーマなし、全フィールド PREVIOUS・時刻は符号なし差分）
+LEGACY_SCHEMA = Schema([
+    ("gyro_x", PREDICTOR_PREVIOUS, 0.001), ("gyro_y", PREDICTOR_PREVIOUS, 0.001),
+    ("gyro_z", PREDICTOR_PREVIOUS, 0.001),
+    ("accel_x", PREDICTOR_PREVIOUS, 0.01), ("accel_y", PREDICTOR_PREVIOUS, 0.01),
+    ("accel_z", PREDICTOR_PREVIOUS, 0.01),
+    ("sp_roll", PREDICTOR_PREVIOUS, 0.001), ("sp_pitch", PREDICTOR_PREVIOUS, 0.001),
+    ("sp_yaw", PREDICTOR_PREVIOUS, 0.001), ("sp_thrust", PREDICTOR_PREVIOUS, 0.001),
+    ("motor_fl", PREDICTOR_PREVIOUS, 0.0001), ("motor_fr", PREDICTOR_PREVIOUS, 0.0001),
+    ("motor_rl", PREDICTOR_PREVIOUS, 0.0001), ("motor_rr", PREDICTOR_PREVIOUS, 0.0001),
+], PREDICTOR_PREVIOUS)
+
+
+def f32(value):
+    """float32への丸め（機体側の float 演算と同じ値にする）"""
+    return struct.unpack("<f", struct.pack("<f", value))[0]
+
+
+def read_varint(data, position):
+    value = 0
+    shift = 0
+    while shift < 35:
+        if position >= len(data):
+            raise ValueError("varintが途切れている")
+        byte = data[position]
+        position += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, position
+        shift += 7
+    raise ValueError("varintが長すぎる")
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def predict(predictor, history, previous, before):
+    """予測値（history はブロック内の既出フレーム数、blackbox_format.cpp の predictField() と同じ）"""
+    if history == 0 or predictor == PREDICTOR_ZERO:
+        return 0
+    if predictor == PREDICTOR_LINEAR and history >= 2:
+        return 2 * previous - before
+    if predictor == PREDICTOR_AVERAGE_2 and history >= 2:
+        return (previous + before) >> 1
+    return previous
+
+
+def predict_time(predictor, history, previous, before):
+    """時刻の予測値（32bitで折り返す、predictTime() と同じ）"""
+    if predictor == PREDICTOR_AVERAGE_2 and history >= 2:
+        return (before + ((previous - before) & 0xFFFFFFFF) // 2) & 0xFFFFFFFF
+    return predict(predictor, history, previous, before) & 0xFFFFFFFF
+
+
+def to_int16(value):
+    return ((value + 0x8000) & 0xFFFF) - 0x8000
+
+
+def trunc_div(numerator, denominator):
+    """C++の整数除算（0方向への切り捨て）"""
+    quotient = abs(numerator) // denominator
+    return quotient if numerator >= 0 else -quotient
+
+
+def parse_header(block):
+    """ブロックヘッダを辞書で返す（不正な場合 None）"""
+    if len(block) < BLOCK_HEADER.size:
+        return None
+    (magic, version, header_size, sequence, frame_count, payload_size,
+     first_time_us, last_time_us, dropped_frames) = BLOCK_HEADER.unpack_from(block)
+    if magic != BLOCK_MAGIC or version < 1 or header_size < BLOCK_HEADER.size \
+            or header_size + payload_size > len(block):
+        return None
+    header = {
+        "version": version, "header_size": header_size, "sequence": sequence,
+        "frame_count": frame_count, "payload_size": payload_size, "first_time_us": first_time_us,
+        "last_time_us": last_time_us, "dropped_frames": dropped_frames,
+        "flags": 0, "sync_drift_ppb": 0, "synced_first_time_us": 0,
+    }
+    if version >= 2:
+        if header_size < BLOCK_HEADER_V2.size:
+            return None
+        header["flags"], header["sync_drift_ppb"], header["synced_first_time_us"] = \
+            BLOCK_HEADER_V2.unpack_from(block)[9:]
+    return header
+
+
+def parse_schema(block, header):
+    """ヘッダ直後のスキーマ（SCHEMA_PRESENT のない場合・不正な場合 None）"""
+    if header["version"] < 3 or not header["flags"] & SCHEMA_PRESENT:
+        return None
+    offset = BLOCK_HEADER_V2.size
+    if header["header_size"] < offset + SCHEMA_HEADER.size:
+        return None
+    field_count, time_predictor, field_size, _ = SCHEMA_HEADER.unpack_from(block, offset)
+    offset += SCHEMA_HEADER.size
+    if field_size < FIELD_DEF.size or header["header_size"] < offset + field_count * field_size:
+        return None
+    fields = []
+    for index in range(field_count):
+        name, predictor, lsb = FIELD_DEF.unpack_from(block, offset + index * field_size)
+        fields.append((name.split(b"\0", 1)[0].decode("ascii", "replace"), predictor, lsb))
+    return Schema(fields, time_predictor)
+
+
+def decode_block(block, schema=None):
+    """ブラックボックスの1ブロックを復号する
+
+    schema はスキーマのないブロックに使う直前のスキーマ（None で版1・2の既定）。
+    (header, schema, frames) を返し、frames は (time_us, [フィールドの整数値]) の列。
+    途中で符号が壊れている場合はそこまでのフレームを返す。ヘッダが不正な場合は header が None
+    """
+    header = parse_header(block)
+    if header is None:
+        return None, schema, []
+    if header["version"] < 3:
+        schema = LEGACY_SCHEMA
+    else:
+        schema = parse_schema(block, header) or schema or LEGACY_SCHEMA
+    legacy = header["version"] < 3
+    count = len(schema.fields)
+    payload = block[header["header_size"]:header["header_size"] + header["payload_size"]]
+    position = 0
+    times = [0, 0]
+    previous = [[0] * count, [0] * count]
+    frames = []
+    try:
+        for history in range(header["frame_count"]):
+            time_code, position = read_varint(payload, position)
+            mask = payload[position] | (payload[position + 1] << 8)
+            position += 2
+            fields = []
+            for i, (_, predictor, _) in enumerate(schema.fields):
+                value = predict(predictor, history, previous[0][i], previous[1][i])
+                if mask & (1 << i):
+                    encoded, position = read_varint(payload, position)
+                    value += unzigzag(encoded)
+                fields.append(to_int16(value))
+            previous = [fields, previous[0]]
+            if legacy:
+                time_us = (times[0] + time_code) & 0xFFFFFFFF
+            else:
+                time_us = (predict_time(schema.time_predictor, history, times[0], times[1])
+                           + unzigzag(time_code)) & 0xFFFFFFFF
+            times = [time_us, times[0]]
+            frames.append((time_us, fields))
+    except (ValueError, IndexError):
+        print("ブロック %d: 符号が壊れている（%d / %d フレーム）"
+              % (header["sequence"], len(frames), header["frame_count"]), file=sys.stderr)
+    return header, schema, frames
+
+
+def synced_time(header, time_us):
+    """フレームの同期時刻（BlackboxDecoder::syncedTime() と同じ、未同期のブロックは None）"""
+    if not header["flags"] & SYNC_VALID:
+        return None
+    elapsed = (time_us - header["first_time_us"]) & 0xFFFFFFFF
+    return header["synced_first_time_us"] + elapsed + trunc_div(elapsed * header["sync_drift_ppb"], 1000000000)
+
+
+def load_records(path):
+    """パーティションイメージから (sequence, session, payload) を通し番号順に読む（CRC不一致は飛ばす）"""
+    with open(path, "rb") as stream:
+        image = stream.read()
+    records = []
+    for offset in range(0, len(image) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        header = LOG_HEADER.unpack_from(image, offset)
+        magic, sequence, record_session, payload_size, payload_crc, header_crc = header[:6]
+        if magic != LOG_MAGIC or payload_size > SECTOR_SIZE - LOG_HEADER.size:
+            continue
+        if zlib.crc32(image[offset:offset + 20]) != header_crc:
+            continue
+        payload = image[offset + LOG_HEADER.size:offset + LOG_HEADER.size + payload_size]
+        if zlib.crc32(payload) != payload_crc:
+            continue
+        records.append((sequence, record_session, payload))
+    records.sort()
+    return records
+
+
+def decode_session(records, session):
+    """指定セッションの全フレームを復号する（time_us は32bitの折り返しを展開）
+
+    (schema, rows, dropped) を返し、rows は (time_us, synced_us, fields) の列
+    """
+    schema = None
+    rows = []
+    dropped = 0
+    base = 0
+    last = None
+    for _, record_session, payload in records:
+        if record_session != session:
+            continue
+        header, schema, frames = decode_block(payload, schema)
+        if header is None:
+            continue
+        dropped += header["dropped_frames"]
+        for time_us, fields in frames:
+            if last is not None and time_us < last:
+                base += 1 << 32
+            last = time_us
+            rows.append((base + time_us, synced_time(header, time_us), fields))
+    return schema, rows, dropped
+
+
+def list_sessions(records):
+    sessions = {}
+    for _, record_session, payload in records:
+        header = parse_header(payload)
+        if header is None:
+            continue
+        entry = sessions.setdefault(record_session, [0, 0, header["version"], header["first_time_us"], 0])
+        entry[0] += 1
+        entry[1] += header["frame_count"]
+        entry[4] = header["last_time_us"]
+    print("session blocks frames version duration_s")
+    for session, (blocks, frames, version, first, last) in sorted(sessions.items()):
+        print("%7d %6d %6d %7d %10.1f" % (session, blocks, frames, version, ((last - first) & 0xFFFFFFFF) * 1e-6))
+
+
+def scale_rows(schema, rows, raw):
+    """整数値を物理量へ（機体側の SensorReplay::dequantize() と同じく float32 で掛ける）"""
+    if raw:
+        return rows
+    lsbs = [f32(lsb) for _, _, lsb in schema.fields]
+    return [(time_us, synced, [f32(f32(v) * lsb) for v, lsb in zip(fields, lsbs)])
+            for time_us, synced, fields in rows]
+
+
+def write_csv(stream, schema, rows):
+    writer = csv.writer(stream)
+    writer.writerow(["time_us", "synced_us"] + schema.names)
+    for time_us, synced, fields in rows:
+        # float32は9桁で往復できる
+        writer.writerow([time_us, "" if synced is None else synced]
+                        + ["%.9g" % v if isinstance(v, float) else v for v in fields])
+
+
+def write_parquet(path, schema, rows, raw):
+    try:
+        import pyarrow
+        import pyarrow.parquet
+    except ImportError:
+        raise SystemExit("Parquetの出力にはpyarrowが必要: pip install pyarrow")
+    value_type = pyarrow.int16() if raw else pyarrow.float32()
+    columns = {
+        "time_us": pyarrow.array([r[0] for r in rows], pyarrow.uint64()),
+        "synced_us": pyarrow.array([r[1] for r in rows], pyarrow.int64()),
+    }
+    for index, name in enumerate(schema.names):
+        columns[name] = pyarrow.array([r[2][index] for r in rows], value_type)
+    pyarrow.parquet.write_table(pyarrow.table(columns), path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="ブラックボックス記録の復号")
+    parser.add_argument("input", help="logsパーティションのイメージ（.bin）")
+    parser.add_argument("--session", type=int, default=0, help="復号するセッション（既定: 最新）")
+    parser.add_argument("--list", action="store_true", help="セッションの一覧を表示して終わる")
+    parser.add_argument("--output", help="出力ファイル（.csv または .parquet、既定: 標準出力へCSV）")
+    parser.add_argument("--raw", action="store_true", help="分解能を掛けずに整数のまま出力する")
+    args = parser.parse_args()
+
+    records = load_records(args.input)
+    if not records:
+        raise SystemExit("レコードがない: %s" % args.input)
+    if args.list:
+        list_sessions(records)
+        return 0
+
+    session = args.session or records[-1][1]
+    schema, rows, dropped = decode_session(records, session)
+    if not rows:
+        raise SystemExit("セッション %d にフレームがない" % session)
+    print("セッション %d: %d フレーム（欠落 %d） %d フィールド"
+          % (session, len(rows), dropped, len(schema.fields)), file=sys.stderr)
+
+    rows = scale_rows(schema, rows, args.raw)
+    if args.output and args.output.endswith(".parquet"):
+        write_parquet(args.output, schema, rows, args.raw)
+    elif args.output:
+        with open(args.output, "w", newline="") as stream:
+            write_csv(stream, schema, rows)
+    else:
+        write_csv(sys.stdout, schema, rows)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+PC Profile
+
+PcSampler（runtime::PcSampler::dump()）のログからフラットプロファイルを作る。
+ログの "PCS <コア> <pc0> <pc1> ..." 行を集め、ELFとaddr2lineで関数名に変換し、
+割り込み処理の段を取り除いた先頭の関数を自己時間、サンプル中に現れた関数を
+包含時間として集計する。
+
+使い方:
+    idf.py monitor | tee flight.log        # 停止後に PcSampler::dump() を呼ぶ
+    tools/pc_profile.py flight.log --elf build/stampfly_espidf.elf
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import collections
+import re
+import subprocess
+import sys
+
+SAMPLE_PATTERN = re.compile(r"\bPCS ([0-9]+)((?: [0-9a-fA-F]{8})+)")
+BEGIN_PATTERN = re.compile(r"\bPCS_BEGIN ([0-9]+) ([0-9]+)")
+
+# サンプリング割り込み自身とディスパッチの段（先頭から取り除く）
+ISR_PATTERN = re.compile(
+    r"^(_xt_|xt_|_frxt_|_xtos_|gptimer_|shared_intr_isr|non_shared_intr_isr|"
+    r"intr_|esp_intr_|runtime::PcSampler::)"
+)
+
+UNKNOWN = "(不明)"
+
+
+def parse_log(stream, core_filter):
+    """ログからサンプル（PCのタプル）と周期を読む"""
+    samples = []
+    period_us = None
+    for line in stream:
+        begin = BEGIN_PATTERN.search(line)
+        if begin:
+            period_us = int(begin.group(1))
+            continue
+        match = SAMPLE_PATTERN.search(line)
+        if not match:
+            continue
+        core = int(match.group(1))
+        if core_filter is not None and core != core_filter:
+            continue
+        pcs = tuple(int(value, 16) for value in match.group(2).split())
+        samples.append((core, pcs))
+    return samples, period_us
+
+
+def symbolize(addresses, elf, addr2line):
+    """アドレスを (関数名, ファイル:行) に変換する（addr2lineを1回だけ起動）"""
+    addresses = sorted(addresses)
+    if not addresses:
+        return {}
+    command = [addr2line, "-f", "-C", "-e", elf] + ["0x%08x" % address for address in addresses]
+    try:
+        output = subprocess.run(command, check=True, capture_output=True, text=True).stdout.splitlines()
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit("addr2lineの実行に失敗しました: %s" % error)
+    symbols = {}
+    for index, address in enumerate(addresses):
+        function = output[index * 2] if index * 2 < len(output) else "??"
+        location = output[index * 2 + 1] if index * 2 + 1 < len(output) else "??:0"
+        if function == "??":
+            function = "0x%08x" % address
+        symbols[address] = (function, location)
+    return symbols
+
+
+def strip_isr(frames, symbols):
+    """先頭の割り込み処理の段を取り除いた関数名の列"""
+    names = [symbols[pc][0] for pc in frames if pc != 0]
+    while names and ISR_PATTERN.match(names[0]):
+        names.pop(0)
+    return names
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PcSamplerのログからフラットプロファイルを作る")
+    parser.add_argument("log", help="シリアルログ（- で標準入力）")
+    parser.add_argument("--elf", required=True, help="ファームウェアのELF（build/stampfly_espidf.elf）")
+    parser.add_argument("--addr2line", default="xtensa-esp32s3-elf-addr2line", help="addr2lineのコマンド")
+    parser.add_argument("--core", type=int, default=None, help="集計するコア（既定は両方）")
+    parser.add_argument("--top", type=int, default=30, help="表示する関数の数")
+    parser.add_argument("--lines", action="store_true", help="自己時間の多い行も表示する")
+    args = parser.parse_args()
+
+    if args.log == "-":
+        samples, period_us = parse_log(sys.stdin, args.core)
+    else:
+        with open(args.log, encoding="utf-8", errors="replace") as stream:
+            samples, period_us = parse_log(stream, args.core)
+    if not samples:
+        sys.exit("PCS行が見つかりません")
+
+    symbols = symbolize({pc for _, pcs in samples for pc in pcs if pc != 0}, args.elf, args.addr2line)
+
+    self_counts = collections.Counter()
+    total_counts = collections.Counter()
+    line_counts = collections.Counter()
+    per_core = collections.Counter()
+    for core, pcs in samples:
+        per_core[core] += 1
+        names = strip_isr(pcs, symbols)
+        if not names:
+            self_counts[UNKNOWN] += 1
+            total_counts[UNKNOWN] += 1
+            continue
+        self_counts[names[0]] += 1
+        for name in set(names):
+            total_counts[name] += 1
+        # 自己時間の行は取り除いた後の先頭の段のアドレス
+        for pc in pcs:
+            if pc != 0 and symbols[pc][0] == names[0]:
+                line_counts[(names[0], symbols[pc][1])] += 1
+                break
+
+    total = len(samples)
+    cores = " ".join("コア%d: %d" % (core, count) for core, count in sorted(per_core.items()))
+    period = " 周期 %d us（約 %.1f 秒分）" % (period_us, total * period_us / 1e6 / max(len(per_core), 1)) if period_us else ""
+    print("サンプル %d（%s）%s" % (total, cores, period))
+    print("包含時間は記録した段（最大%d段）の範囲で数える" % max(len(pcs) for _, pcs in samples))
+    print()
+    print("%7s %7s %7s  %s" % ("自己%", "自己", "包含%", "関数"))
+    for name, count in self_counts.most_common(args.top):
+        print("%6.2f%% %7d %6.2f%%  %s" % (count * 100.0 / total, count, total_counts[name] * 100.0 / total, name))
+
+    if args.lines:
+        print()
+        print("%7s %7s  %s" % ("自己%", "自己", "行"))
+        for (name, location), count in line_counts.most_common(args.top):
+            print("%6.2f%% %7d  %s（%s）" % (count * 100.0 / total, count, location, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Replay Stream
+
+記録済みセンサー値をUARTで機体へ流し、HILリプレイ（runtime::ReplayRunner::startUart()）の
+フレーム毎の出力を受け取る。入力はlogsパーティションのイメージ（ブラックボックス）か、
+ToF・フローを含められるCSV（time_us,gx,gy,gz,ax,ay,az,sp_roll,sp_pitch,sp_yaw,sp_thrust[,range][,flow_x,flow_y]）。
+ブラックボックスは機体側と同じ分解能で物理量へ戻し、float32に丸めてから送る
+（同じ記録をパーティションから再生した場合と入力のビット列が一致する）。
+
+機体からの ReplayOutputMessage を待ってから次を送る窓制御で、受信側のキューを溢れさせない。
+出力はCSVに保存でき、--compare で以前の出力とフレーム単位・ビット単位で比較する。
+
+使い方:
+    parttool.py read_partition --partition-name logs --output logs.bin
+    tools/replay_stream.py logs.bin --port /dev/ttyUSB0 --output before.csv
+    （推定器・制御器を変更して書き込み直す）
+    tools/replay_stream.py logs.bin --port /dev/ttyUSB0 --output after.csv --compare before.csv
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+from blackbox_decode import decode_session, f32, load_records
+
+# telemetry_protocol.hpp と同じフレーム形式
+FRAME_STX = 0xA5
+MSG_REPLAY_OUTPUT = 0x07
+MSG_REPLAY_FRAME = 0x42
+FLAG_RANGE = 0x01
+FLAG_FLOW = 0x02
+FLAG_END = 0x04
+REPLAY_FRAME = struct.Struct("<I3f3f4f f2f B")
+REPLAY_OUTPUT = struct.Struct("<I4f4fIII")
+
+OUTPUT_FIELDS = ["time_us", "qw", "qx", "qy", "qz", "m0", "m1", "m2", "m3",
+                 "estimate_cycles", "control_cycles", "output_hash"]
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_frame(message_id, sequence, payload):
+    body = bytes([len(payload), sequence & 0xFF, message_id]) + payload
+    crc = crc16(body)
+    return bytes([FRAME_STX]) + body + bytes([crc & 0xFF, crc >> 8])
+
+
+def load_partition(path, session):
+    """パーティションイメージから指定セッション（0で最新）のフレームを通し番号順に読む"""
+    records = load_records(path)
+    if not records:
+        raise SystemExit("レコードがない: %s" % path)
+    if session == 0:
+        session = records[-1][1]
+    schema, rows, _ = decode_session(records, session)
+    frames = []
+    if rows:
+        # 機体側の SensorReplay::dequantize() と同じく float32 で掛ける（分解能はスキーマから）
+        lsbs = [f32(lsb) for _, _, lsb in schema.fields]
+        for time_us, _, fields in rows:
+            values = [f32(f32(v) * lsb) for v, lsb in zip(fields, lsbs)]
+            frames.append((time_us & 0xFFFFFFFF, values[0:3], values[3:6], values[6:10], 0.0, [0.0, 0.0], 0))
+    print("セッション %d: %d フレーム" % (session, len(frames)), file=sys.stderr)
+    return frames
+
+
+def load_csv(path):
+    frames = []
+    with open(path, newline="") as stream:
+        for row in csv.DictReader(stream):
+            flags = 0
+            range_m = 0.0
+            flow = [0.0, 0.0]
+            if row.get("range") not in (None, ""):
+                range_m = float(row["range"])
+                flags |= FLAG_RANGE if range_m > 0.0 else 0
+            if row.get("flow_x") not in (None, "") and row.get("flow_y") not in (None, ""):
+                flow = [float(row["flow_x"]), float(row["flow_y"])]
+                flags |= FLAG_FLOW
+            frames.append((
+                int(row["time_us"]),
+                [float(row[k]) for k in ("gx", "gy", "gz")],
+                [float(row[k]) for k in ("ax", "ay", "az")],
+                [float(row[k]) for k in ("sp_roll", "sp_pitch", "sp_yaw", "sp_thrust")],
+                range_m, flow, flags))
+    return frames
+
+
+class OutputReader:
+    """ReplayOutputMessage の受信（STXで再同期、CRC不一致は捨てる）"""
+
+    def __init__(self, port):
+        self.port = port
+        self.buffer = bytearray()
+        self.crc_errors = 0
+
+    def poll(self):
+        self.buffer += self.port.read(self.port.in_waiting or 1)
+        messages = []
+        while True:
+            start = self.buffer.find(bytes([FRAME_STX]))
+            if start < 0:
+                self.buffer.clear()
+                break
+            del self.buffer[:start]
+            if len(self.buffer) < 4:
+                break
+            length = self.buffer[1]
+            total = 4 + length + 2
+            if len(self.buffer) < total:
+                break
+            frame = bytes(self.buffer[:total])
+            crc = frame[-2] | (frame[-1] << 8)
+            if crc16(frame[1:-2]) != crc:
+                self.crc_errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:total]
+            if frame[3] == MSG_REPLAY_OUTPUT and length == REPLAY_OUTPUT.size:
+                messages.append(REPLAY_OUTPUT.unpack(frame[4:-2]))
+        return messages
+
+
+def stream(port, frames, window, timeout):
+    reader = OutputReader(port)
+    outputs = []
+    sent = 0
+    last_progress = time.monotonic()
+    while len(outputs) < len(frames):
+        while sent < len(frames) and sent - len(outputs) < window:
+            time_us, gyro, accel, setpoint, range_m, flow, flags = frames[sent]
+            payload = REPLAY_FRAME.pack(time_us, *gyro, *accel, *setpoint, range_m, *flow, flags)
+            port.write(encode_frame(MSG_REPLAY_FRAME, sent, payload))
+            sent += 1
+        received = reader.poll()
+        if received:
+            outputs.extend(received)
+            last_progress = time.monotonic()
+        elif time.monotonic() - last_progress > timeout:
+            print("出力が返ってこない（%d / %d）" % (len(outputs), len(frames)), file=sys.stderr)
+            break
+    end = REPLAY_FRAME.pack(0, *([0.0] * 13), FLAG_END)
+    port.write(encode_frame(MSG_REPLAY_FRAME, sent, end))
+    if reader.crc_errors:
+        print("CRCエラー %d" % reader.crc_errors, file=sys.stderr)
+    return outputs
+
+
+def float_bits(value):
+    return struct.unpack("<I", struct.pack("<f", value))[0]
+
+
+def write_outputs(path, outputs):
+    with open(path, "w", newline="") as stream:
+        writer = csv.writer(stream)
+        writer.writerow(OUTPUT_FIELDS)
+        for output in outputs:
+            # floatはビット列が失われないよう repr（最短往復表現）で書く
+            writer.writerow([output[0]] + [repr(v) for v in output[1:9]] + list(output[9:11])
+                            + ["%08x" % output[11]])
+
+
+def read_outputs(path):
+    outputs = []
+    with open(path, newline="") as stream:
+        for row in csv.DictReader(stream):
+            outputs.append(row)
+    return outputs
+
+
+def compare(outputs, reference_path):
+    reference = read_outputs(reference_path)
+    count = min(len(outputs), len(reference))
+    first_mismatch = None
+    mismatches = 0
+    for index in range(count):
+        ours = outputs[index][1:9]
+        theirs = [float(reference[index][k]) for k in OUTPUT_FIELDS[1:9]]
+        if [float_bits(v) for v in ours] != [float_bits(f32(v)) for v in theirs]:
+            mismatches += 1
+            if first_mismatch is None:
+                first_mismatch = index
+    if first_mismatch is None and len(outputs) == len(reference):
+        print("一致: %d フレームの出力がビット単位で同じ" % count)
+        return True
+    if first_mismatch is not None:
+        print("不一致: %d / %d フレーム（最初は %d、time_us=%s）"
+              % (mismatches, count, first_mismatch, reference[first_mismatch]["time_us"]))
+    if len(outputs) != len(reference):
+        print("フレーム数が違う: %d / 比較対象 %d" % (len(outputs), len(reference)))
+    return False
+
+
+def summarize(outputs, reference_path):
+    if not outputs:
+        return
+    estimate = [o[9] for o in outputs]
+    control = [o[10] for o in outputs]
+    print("REPLAY frames=%d hash=%08x est_avg=%d est_max=%d ctl_avg=%d ctl_max=%d"
+          % (len(outputs), outputs[-1][11], sum(estimate) // len(estimate), max(estimate),
+             sum(control) // len(control), max(control)))
+    if reference_path:
+        reference = read_outputs(reference_path)
+        if reference:
+            ref_estimate = [int(r["estimate_cycles"]) for r in reference]
+            ref_control = [int(r["control_cycles"]) for r in reference]
+            print("比較対象 est_avg=%d est_max=%d ctl_avg=%d ctl_max=%d"
+                  % (sum(ref_estimate) // len(ref_estimate), max(ref_estimate),
+                     sum(ref_control) // len(ref_control), max(ref_control)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="記録済みセンサー値のUARTリプレイ")
+    parser.add_argument("input", help="logsパーティションのイメージ（.bin）またはCSV")
+    parser.add_argument("--port", required=True, help="シリアルポート")
+    parser.add_argument("--baud", type=int, default=921600, help="ボーレート（既定: 921600）")
+    parser.add_argument("--session", type=int, default=0, help="再生するセッション（既定: 最新）")
+    parser.add_argument("--window", type=int, default=16,
+                        help="出力を待たずに送るフレーム数（機体の受信キュー32未満、既定: 16）")
+    parser.add_argument("--timeout", type=float, default=3.0, help="出力が途絶えたら止めるまでの秒数")
+    parser.add_argument("--output", help="フレーム毎の出力を保存するCSV")
+    parser.add_argument("--compare", help="ビット単位で比較する以前の出力CSV")
+    args = parser.parse_args()
+
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("pyserialが必要: pip install pyserial")
+
+    if args.input.endswith(".csv"):
+        frames = load_csv(args.input)
+    else:
+        frames = load_partition(args.input, args.session)
+    if not frames:
+        raise SystemExit("フレームがない")
+
+    with serial.Serial(args.port, args.baud, timeout=0.01) as port:
+        port.reset_input_buffer()
+        outputs = stream(port, frames, max(1, min(args.window, 31)), args.timeout)
+
+    if args.output:
+        write_outputs(args.output, outputs)
+    summarize(outputs, args.compare)
+    ok = len(outputs) == len(frames)
+    if args.compare:
+        ok = compare(outputs, args.compare) and ok
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
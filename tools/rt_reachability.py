@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+RT Reachability
+
+制御経路（割り込み・制御タスク）から到達できるフラッシュ上のコード・定数を一覧にする。
+フラッシュの書き込み・消去やキャッシュミスで止まり得る箇所を、ビルド後のELFから洗い出すためのもの。
+
+rt_roots.txt の起点関数から逆アセンブル（objdump -d）の直接呼び出しと、l32rで読む
+リテラル（-mlongcallsの遠距離呼び出し・関数ポインタ・定数のアドレス）をたどり、
+.flash.* セクションにある関数と、IRAM側から参照されるフラッシュ上の定数を出力する。
+レジスタ経由の間接呼び出し（仮想関数・std::function等）は追えないため、含む関数を別に列挙する。
+ROM（ELFのセクション外）の関数は安全として扱う。
+
+使い方:
+    tools/rt_reachability.py build/stampfly_espidf.elf
+    tools/rt_reachability.py build/stampfly_espidf.elf --strict     # 到達があれば終了コード1
+
+ビルド時は CMakeLists.txt の後処理で自動実行される（結果は build/rt_reachability.txt、
+-DSTAMPFLY_RT_REPORT_STRICT=ON でフラッシュ上の関数への到達をビルドエラーにする）。
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import bisect
+import collections
+import fnmatch
+import re
+import struct
+import subprocess
+import sys
+from pathlib import Path
+
+DEFAULT_ROOTS = Path(__file__).with_name("rt_roots.txt")
+
+# 実行される（キャッシュ経由で読む）フラッシュ上のセクション
+FLASH_TEXT_PREFIX = ".flash.text"
+FLASH_DATA_PREFIXES = (".flash.rodata",)
+
+SYMBOL_PATTERN = re.compile(r"^([0-9a-f]{8}) (.{7}) (\S+)\s+([0-9a-f]{8}) (.+)$")
+FUNCTION_PATTERN = re.compile(r"^([0-9a-f]{8}) <(.+)>:$")
+INSTRUCTION_PATTERN = re.compile(r"^\s*([0-9a-f]+):\s+([a-z0-9._]+)\s*(.*)$")
+TARGET_PATTERN = re.compile(r"\b([0-9a-f]{8}) <")
+CALLX_PATTERN = re.compile(r"^callx(?:0|4|8|12)$")
+REGISTER_PATTERN = re.compile(r"^(a[0-9]+)")
+
+SHT_NOBITS = 8
+
+
+class Elf:
+    """ELF（32bitリトルエンディアン）のセクション内容"""
+
+    def __init__(self, path):
+        self.data = Path(path).read_bytes()
+        if self.data[:4] != b"\x7fELF":
+            sys.exit("ELFではありません: %s" % path)
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        headers = [struct.unpack_from("<10I", self.data, shoff + i * shentsize) for i in range(shnum)]
+        strtab = headers[shstrndx][4]
+        self.sections = []
+        for header in headers:
+            name_offset, section_type, _, address, offset, size = header[:6]
+            end = self.data.index(b"\0", strtab + name_offset)
+            name = self.data[strtab + name_offset:end].decode("ascii", "replace")
+            if address != 0 and size != 0:
+                self.sections.append((address, size, offset, section_type, name))
+        self.sections.sort()
+        self.starts = [section[0] for section in self.sections]
+
+    def section(self, address):
+        """アドレスを含むセクション名（なければNone: ROM等）"""
+        index = bisect.bisect_right(self.starts, address) - 1
+        if index < 0:
+            return None
+        start, size, _, _, name = self.sections[index]
+        return name if address < start + size else None
+
+    def word(self, address):
+        """アドレスの32bit値（内容のないセクション・範囲外はNone）"""
+        index = bisect.bisect_right(self.starts, address) - 1
+        if index < 0:
+            return None
+        start, size, offset, section_type, _ = self.sections[index]
+        if section_type == SHT_NOBITS or address + 4 > start + size:
+            return None
+        value, = struct.unpack_from("<I", self.data, offset + address - start)
+        return value
+
+
+def run(command):
+    try:
+        return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit("%sの実行に失敗しました: %s" % (command[0], error))
+
+
+def load_symbols(elf_path, objdump):
+    """関数名（開始アドレス毎）とデータシンボル（開始アドレス順）"""
+    functions = {}
+    objects = []
+    for line in run([objdump, "-t", "-C", elf_path]).splitlines():
+        match = SYMBOL_PATTERN.match(line)
+        if not match:
+            continue
+        address = int(match.group(1), 16)
+        flags = match.group(2)
+        size = int(match.group(4), 16)
+        name = match.group(5)
+        if "F" in flags:
+            functions.setdefault(address, name)
+        elif "O" in flags and size > 0:
+            objects.append((address, size, name))
+    objects.sort()
+    return functions, objects
+
+
+def load_code(elf_path, objdump, elf):
+    """関数毎の参照先（関数アドレス・定数アドレス）と間接呼び出しの有無"""
+    calls = collections.defaultdict(set)
+    data_refs = collections.defaultdict(set)
+    indirect = set()
+    names = {}
+    current = None
+    loaded = {}
+    output = run([objdump, "-d", "-C", "--no-show-raw-insn", elf_path])
+    for line in output.splitlines():
+        function = FUNCTION_PATTERN.match(line)
+        if function:
+            current = int(function.group(1), 16)
+            names.setdefault(current, function.group(2))
+            loaded = {}
+            continue
+        instruction = INSTRUCTION_PATTERN.match(line)
+        if not instruction or current is None:
+            continue
+        mnemonic = instruction.group(2)
+        operands = instruction.group(3)
+        if mnemonic == "l32r":
+            target = TARGET_PATTERN.search(operands)
+            register = REGISTER_PATTERN.match(operands)
+            value = elf.word(int(target.group(1), 16)) if target else None
+            if value is not None and register:
+                loaded[register.group(1)] = value
+                data_refs[current].add(value)
+            continue
+        if CALLX_PATTERN.match(mnemonic):
+            register = REGISTER_PATTERN.match(operands)
+            if register and register.group(1) in loaded:
+                calls[current].add(loaded[register.group(1)])
+            else:
+                indirect.add(current)
+            continue
+        for target in TARGET_PATTERN.findall(operands):
+            calls[current].add(int(target, 16))
+    return names, calls, data_refs, indirect
+
+
+def load_roots(path):
+    """起点のパターンと、たどらない（起きない前提の）経路のパターン"""
+    roots = []
+    cold = []
+    for line in Path(path).read_text(encoding="utf-8").splitlines():
+        line = line.split("#", 1)[0].strip()
+        if not line:
+            continue
+        if line.startswith("!"):
+            cold.append(line[1:].strip())
+        else:
+            roots.append(line)
+    return roots, cold
+
+
+def matches(name, patterns):
+    return any(fnmatch.fnmatchcase(name, pattern) for pattern in patterns)
+
+
+def object_name(objects, address):
+    index = bisect.bisect_right(objects, (address, 0xFFFFFFFF, "")) - 1
+    if index >= 0:
+        start, size, name = objects[index]
+        if start <= address < start + size:
+            return name if address == start else "%s+0x%x" % (name, address - start)
+    return "0x%08x" % address
+
+
+def main():
+    parser = argparse.ArgumentParser(description="制御経路から到達できるフラッシュ上のコード・定数の一覧")
+    parser.add_argument("elf", help="ファームウェアのELF")
+    parser.add_argument("--roots", default=str(DEFAULT_ROOTS), help="起点関数のパターン（既定: tools/rt_roots.txt）")
+    parser.add_argument("--objdump", default="xtensa-esp32s3-elf-objdump", help="objdumpのコマンド")
+    parser.add_argument("--output", help="結果の書き出し先（既定は標準出力のみ）")
+    parser.add_argument("--strict", action="store_true", help="フラッシュ上の関数に到達した場合に終了コード1")
+    parser.add_argument("--summary", action="store_true", help="標準出力には集計行のみ出す（ビルド時用）")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    functions, objects = load_symbols(args.elf, args.objdump)
+    names, calls, data_refs, indirect = load_code(args.elf, args.objdump, elf)
+    for address, name in functions.items():
+        names.setdefault(address, name)
+    roots, cold = load_roots(args.roots)
+
+    lines = []
+    queue = collections.deque()
+    parent = {}
+    for address, name in sorted(names.items()):
+        if matches(name, roots) and not matches(name, cold):
+            parent[address] = None
+            queue.append(address)
+    for pattern in roots:
+        if not any(fnmatch.fnmatchcase(names[address], pattern) for address in parent):
+            lines.append("起点なし（インライン展開・未リンク）: %s" % pattern)
+
+    # 幅優先で最短の経路を残す（ROM・データ・たどらない経路の先は追わない）
+    while queue:
+        address = queue.popleft()
+        for target in sorted(calls[address] | data_refs[address]):
+            if target in parent or target not in names:
+                continue
+            if matches(names[target], cold):
+                continue
+            parent[target] = address
+            queue.append(target)
+
+    def chain(address):
+        path = []
+        while address is not None:
+            path.append(names[address])
+            address = parent[address]
+        return " <- ".join(path)
+
+    reached = sorted(parent)
+    flash_functions = [address for address in reached
+                       if (elf.section(address) or "").startswith(FLASH_TEXT_PREFIX)]
+    flash_data = []
+    for address in reached:
+        if (elf.section(address) or "").startswith(FLASH_TEXT_PREFIX):
+            continue
+        for value in sorted(data_refs[address]):
+            section = elf.section(value) or ""
+            if value not in names and section.startswith(FLASH_DATA_PREFIXES):
+                flash_data.append((address, value, section))
+    indirect_functions = [address for address in reached if address in indirect]
+
+    lines.append("起点 %d 関数から %d 関数に到達" % (sum(1 for a in reached if parent[a] is None), len(reached)))
+    lines.append("")
+    lines.append("フラッシュ上の関数: %d" % len(flash_functions))
+    for address in flash_functions:
+        lines.append("  0x%08x %s" % (address, chain(address)))
+    lines.append("")
+    lines.append("IRAMの関数から参照するフラッシュ上の定数: %d" % len(flash_data))
+    for address, value, section in flash_data:
+        lines.append("  0x%08x %s %s <- %s" % (value, section, object_name(objects, value), chain(address)))
+    lines.append("")
+    lines.append("追えない間接呼び出しを含む関数: %d" % len(indirect_functions))
+    for address in indirect_functions:
+        lines.append("  %s" % names[address])
+    lines.append("")
+    lines.append("RT_REACH flash_functions=%d flash_data=%d indirect=%d" % (
+        len(flash_functions), len(flash_data), len(indirect_functions)))
+
+    text = "\n".join(lines) + "\n"
+    if args.output:
+        Path(args.output).write_text(text, encoding="utf-8")
+    print(lines[-1] if args.summary else text, end="\n" if args.summary else "")
+    return 1 if args.strict and flash_functions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Time Sync
+
+地上局側の時刻同期応答（communication::TimeSync の相手）。
+機体の TimeSyncRequestMessage を受けたら、受信時刻 t2 と送信時刻 t3 を入れた
+TimeSyncResponseMessage をすぐに返す。地上の時刻は UNIX 時刻（μs）で、
+動画・モーションキャプチャの記録と同じ時計を使えば機体のテレメトリ・ブラックボックスの
+同期時刻と直接並べられる。
+
+UDP（communication::UdpTelemetry、応答の送信元へテレメトリの送信先も切り替わる）と
+UART（TelemetryLink）のどちらでも動く。
+
+使い方:
+    tools/time_sync.py --udp 192.168.4.1
+    tools/time_sync.py --port /dev/ttyUSB0
+
+作成者: Kouhei Ito
+ライセンス: MIT License
+
+Copyright (c) 2025 Kouhei Ito
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+# telemetry_protocol.hpp と同じフレーム形式
+FRAME_STX = 0xA5
+MSG_TIME_SYNC_REQUEST = 0x08
+MSG_TIME_SYNC_RESPONSE = 0x43
+TIME_SYNC_REQUEST = struct.Struct("<Iq")
+TIME_SYNC_RESPONSE = struct.Struct("<Iqqq")
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE"""
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode_frame(message_id, sequence, payload):
+    body = bytes([len(payload), sequence & 0xFF, message_id]) + payload
+    crc = crc16(body)
+    return bytes([FRAME_STX]) + body + bytes([crc & 0xFF, crc >> 8])
+
+
+def now_us():
+    return time.time_ns() // 1000
+
+
+def split_frames(buffer):
+    """バッファから完結したフレームを取り出す（STXで再同期、CRC不一致は捨てる）"""
+    frames = []
+    while True:
+        start = buffer.find(bytes([FRAME_STX]))
+        if start < 0:
+            buffer.clear()
+            break
+        del buffer[:start]
+        if len(buffer) < 4:
+            break
+        total = 4 + buffer[1] + 2
+        if len(buffer) < total:
+            break
+        frame = bytes(buffer[:total])
+        if crc16(frame[1:-2]) != (frame[-2] | (frame[-1] << 8)):
+            del buffer[:1]
+            continue
+        del buffer[:total]
+        frames.append((frame[3], frame[4:-2]))
+    return frames
+
+
+class Responder:
+    """要求への応答（t2は受信直後、t3は送信直前に取る）"""
+
+    def __init__(self, verbose):
+        self.sequence = 0
+        self.answered = 0
+        self.verbose = verbose
+
+    def respond(self, frames, receive_us, send):
+        for message_id, payload in frames:
+            if message_id != MSG_TIME_SYNC_REQUEST or len(payload) != TIME_SYNC_REQUEST.size:
+                continue
+            exchange, request_us = TIME_SYNC_REQUEST.unpack(payload)
+            response = TIME_SYNC_RESPONSE.pack(exchange, request_us, receive_us, now_us())
+            send(encode_frame(MSG_TIME_SYNC_RESPONSE, self.sequence, response))
+            self.sequence += 1
+            self.answered += 1
+            if self.verbose:
+                print("交換 %d 機体 %d μs" % (exchange, request_us), file=sys.stderr)
+
+
+def run_udp(host, port, responder):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(("", port))
+    # 何か送ると機体のテレメトリ送信先がこちらへ切り替わる（follow_sender）
+    sock.sendto(b"\0", (host, port))
+    while True:
+        datagram, address = sock.recvfrom(2048)
+        receive_us = now_us()
+        responder.respond(split_frames(bytearray(datagram)), receive_us,
+                          lambda frame: sock.sendto(frame, address))
+
+
+def run_serial(path, baud, responder):
+    try:
+        import serial
+    except ImportError:
+        raise SystemExit("pyserialが必要: pip install pyserial")
+    buffer = bytearray()
+    with serial.Serial(path, baud, timeout=0.01) as port:
+        port.reset_input_buffer()
+        while True:
+            data = port.read(port.in_waiting or 1)
+            if not data:
+                continue
+            receive_us = now_us()
+            buffer += data
+            responder.respond(split_frames(buffer), receive_us, port.write)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="地上局側の時刻同期応答")
+    parser.add_argument("--udp", metavar="HOST", help="機体のアドレス（UDPテレメトリ）")
+    parser.add_argument("--udp-port", type=int, default=14560, help="UDPポート（既定: 14560）")
+    parser.add_argument("--port", help="シリアルポート（UARTテレメトリ）")
+    parser.add_argument("--baud", type=int, default=921600, help="ボーレート（既定: 921600）")
+    parser.add_argument("--verbose", action="store_true", help="交換毎に表示する")
+    args = parser.parse_args()
+    if (args.udp is None) == (args.port is None):
+        raise SystemExit("--udp か --port のどちらか一方を指定する")
+
+    responder = Responder(args.verbose)
+    try:
+        if args.udp is not None:
+            run_udp(args.udp, args.udp_port, responder)
+        else:
+            run_serial(args.port, args.baud, responder)
+    except KeyboardInterrupt:
+        print("応答 %d" % responder.answered, file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())